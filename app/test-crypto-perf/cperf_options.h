@@ -17,6 +17,7 @@
 #define CPERF_OPTYPE		("optype")
 #define CPERF_SESSIONLESS	("sessionless")
 #define CPERF_OUT_OF_PLACE	("out-of-place")
+#define CPERF_CPU_CRYPTO	("cpu-crypto")
 #define CPERF_TEST_FILE		("test-file")
 #define CPERF_TEST_NAME		("test-name")
 
@@ -63,6 +64,7 @@ struct cperf_options {
 
 	uint32_t sessionless:1;
 	uint32_t out_of_place:1;
+	uint32_t cpu_crypto:1;
 	uint32_t silent:1;
 	uint32_t csv:1;
 
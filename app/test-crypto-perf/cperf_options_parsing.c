@@ -405,6 +405,14 @@ parse_out_of_place(struct cperf_options *opts,
 	return 0;
 }
 
+static int
+parse_cpu_crypto(struct cperf_options *opts,
+		const char *arg __rte_unused)
+{
+	opts->cpu_crypto = 1;
+	return 0;
+}
+
 static int
 parse_test_file(struct cperf_options *opts,
 		const char *arg)
@@ -587,6 +595,7 @@ static struct option lgopts[] = {
 	{ CPERF_SILENT, no_argument, 0, 0 },
 	{ CPERF_SESSIONLESS, no_argument, 0, 0 },
 	{ CPERF_OUT_OF_PLACE, no_argument, 0, 0 },
+	{ CPERF_CPU_CRYPTO, no_argument, 0, 0 },
 	{ CPERF_TEST_FILE, required_argument, 0, 0 },
 	{ CPERF_TEST_NAME, required_argument, 0, 0 },
 
@@ -639,6 +648,7 @@ cperf_options_default(struct cperf_options *opts)
 	opts->test_name = NULL;
 	opts->sessionless = 0;
 	opts->out_of_place = 0;
+	opts->cpu_crypto = 0;
 	opts->csv = 0;
 
 	opts->cipher_algo = RTE_CRYPTO_CIPHER_AES_CBC;
@@ -669,6 +679,7 @@ cperf_opts_parse_long(int opt_idx, struct cperf_options *opts)
 		{ CPERF_OPTYPE,		parse_op_type },
 		{ CPERF_SESSIONLESS,	parse_sessionless },
 		{ CPERF_OUT_OF_PLACE,	parse_out_of_place },
+		{ CPERF_CPU_CRYPTO,	parse_cpu_crypto },
 		{ CPERF_TEST_FILE,	parse_test_file },
 		{ CPERF_TEST_NAME,	parse_test_name },
 		{ CPERF_CIPHER_ALGO,	parse_cipher_algo },
@@ -779,6 +790,14 @@ cperf_options_check(struct cperf_options *options)
 		return -EINVAL;
 	}
 
+	if (options->cpu_crypto && (options->test !=
+			CPERF_TEST_TYPE_THROUGHPUT || options->sessionless ||
+			options->out_of_place)) {
+		RTE_LOG(ERR, USER1, "CPU crypto comparison is only available "
+				"for in-place, session based throughput tests.\n");
+		return -EINVAL;
+	}
+
 	if (options->op_type == CPERF_CIPHER_THEN_AUTH) {
 		if (options->cipher_op != RTE_CRYPTO_CIPHER_OP_ENCRYPT &&
 				options->auth_op !=
@@ -902,6 +921,7 @@ cperf_options_dump(struct cperf_options *opts)
 	printf("# crypto operation: %s\n", cperf_op_type_strs[opts->op_type]);
 	printf("# sessionless: %s\n", opts->sessionless ? "yes" : "no");
 	printf("# out of place: %s\n", opts->out_of_place ? "yes" : "no");
+	printf("# cpu crypto: %s\n", opts->cpu_crypto ? "yes" : "no");
 
 	printf("#\n");
 
@@ -275,6 +275,87 @@ cperf_throughput_test_constructor(uint8_t dev_id, uint16_t qp_id,
 	return NULL;
 }
 
+/*
+ * Process total_ops buffers with the synchronous CPU crypto API in bursts of
+ * burst_size, building the vectors from the same mbufs the enqueue/dequeue
+ * pass uses, and return the number of successfully processed buffers.
+ */
+static uint64_t
+cperf_throughput_cpu_crypto(struct cperf_throughput_ctx *ctx,
+		uint16_t burst_size, uint64_t *tsc_duration)
+{
+	const struct cperf_options *options = ctx->options;
+	const struct cperf_test_vector *test_vector = ctx->test_vector;
+	uint32_t max_segs = options->segments_nb + 1;
+	struct rte_crypto_vec vecs[burst_size * max_segs];
+	struct rte_crypto_sgl sgl[burst_size];
+	void *iv[burst_size], *aad[burst_size], *digest[burst_size];
+	int32_t status[burst_size];
+	struct rte_crypto_sym_vec vec = {
+		.sgl = sgl,
+		.iv = iv,
+		.aad = aad,
+		.digest = digest,
+		.status = status,
+	};
+	union rte_crypto_sym_ofs ofs;
+	uint64_t ops_total = 0, ops_ok = 0, m_idx = 0, tsc_start;
+	uint32_t head, i, seg;
+	struct rte_mbuf *m;
+
+	head = (options->op_type == CPERF_AEAD) ?
+			RTE_ALIGN_CEIL(options->auth_aad_sz, 16) : 0;
+
+	ofs.raw = 0;
+	ofs.ofs.cipher.head = head;
+	ofs.ofs.cipher.tail = ctx->mbufs_in[0]->pkt_len - head -
+			options->test_buffer_size;
+	ofs.ofs.auth = ofs.ofs.cipher;
+
+	tsc_start = rte_rdtsc_precise();
+
+	while (ops_total < options->total_ops) {
+		vec.num = RTE_MIN((uint64_t)burst_size,
+				options->total_ops - ops_total);
+
+		for (i = 0; i < vec.num; i++) {
+			sgl[i].vec = &vecs[i * max_segs];
+
+			m = ctx->mbufs_in[m_idx + i];
+			for (seg = 0; m != NULL && seg < max_segs; seg++) {
+				sgl[i].vec[seg].base =
+						rte_pktmbuf_mtod(m, void *);
+				sgl[i].vec[seg].len = m->data_len;
+				m = m->next;
+			}
+			sgl[i].num = seg;
+
+			iv[i] = test_vector->iv.data;
+			aad[i] = test_vector->aad.data;
+
+			if (options->auth_op == RTE_CRYPTO_AUTH_OP_VERIFY) {
+				digest[i] = test_vector->digest.data;
+			} else {
+				m = rte_pktmbuf_lastseg(ctx->mbufs_in[m_idx + i]);
+				digest[i] = rte_pktmbuf_mtod_offset(m,
+						uint8_t *, m->data_len -
+						options->auth_digest_sz);
+			}
+		}
+
+		ops_ok += rte_cryptodev_sym_cpu_crypto_process(ctx->dev_id,
+				ctx->sess, ofs, &vec);
+		ops_total += vec.num;
+
+		m_idx += vec.num;
+		m_idx = m_idx + burst_size > options->pool_sz ? 0 : m_idx;
+	}
+
+	*tsc_duration = rte_rdtsc_precise() - tsc_start;
+
+	return ops_ok;
+}
+
 int
 cperf_throughput_test_runner(void *test_ctx)
 {
@@ -289,6 +370,7 @@ cperf_throughput_test_runner(void *test_ctx)
 	uint64_t i;
 
 	uint32_t lcore = rte_lcore_id();
+	int cpu_crypto = 0;
 
 #ifdef CPERF_LINEARIZATION_ENABLE
 	struct rte_cryptodev_info dev_info;
@@ -305,6 +387,18 @@ cperf_throughput_test_runner(void *test_ctx)
 
 	ctx->lcore_id = lcore;
 
+	if (ctx->options->cpu_crypto) {
+		struct rte_cryptodev_info info;
+
+		rte_cryptodev_info_get(ctx->dev_id, &info);
+		if (info.feature_flags & RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO)
+			cpu_crypto = 1;
+		else
+			RTE_LOG(WARNING, USER1, "Device %u does not support "
+					"CPU crypto, skipping comparison\n",
+					ctx->dev_id);
+	}
+
 	/* Warm up the host CPU before starting the test */
 	for (i = 0; i < ctx->options->total_ops; i++)
 		rte_cryptodev_enqueue_burst(ctx->dev_id, ctx->qp_id, NULL, 0);
@@ -450,15 +544,16 @@ cperf_throughput_test_runner(void *test_ctx)
 
 		if (!ctx->options->csv) {
 			if (!only_once)
-				printf("%12s%12s%12s%12s%12s%12s%12s%12s%12s%12s\n\n",
+				printf("%12s%12s%12s%12s%12s%12s%12s%12s%12s%12s%s\n\n",
 					"lcore id", "Buf Size", "Burst Size",
 					"Enqueued", "Dequeued", "Failed Enq",
 					"Failed Deq", "MOps", "Gbps",
-					"Cycles/Buf");
+					"Cycles/Buf", cpu_crypto ?
+					"        Mode" : "");
 			only_once = 1;
 
 			printf("%12u%12u%12u%12"PRIu64"%12"PRIu64"%12"PRIu64
-					"%12"PRIu64"%12.4f%12.4f%12.2f\n",
+					"%12"PRIu64"%12.4f%12.4f%12.2f%s\n",
 					ctx->lcore_id,
 					ctx->options->test_buffer_size,
 					test_burst_size,
@@ -468,17 +563,19 @@ cperf_throughput_test_runner(void *test_ctx)
 					ops_deqd_failed,
 					ops_per_second/1000000,
 					throughput_gbps,
-					cycles_per_packet);
+					cycles_per_packet,
+					cpu_crypto ? "     enq-deq" : "");
 		} else {
 			if (!only_once)
 				printf("# lcore id, Buffer Size(B),"
 					"Burst Size,Enqueued,Dequeued,Failed Enq,"
 					"Failed Deq,Ops(Millions),Throughput(Gbps),"
-					"Cycles/Buf\n\n");
+					"Cycles/Buf%s\n\n",
+					cpu_crypto ? ",Mode" : "");
 			only_once = 1;
 
 			printf("%10u;%10u;%u;%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";"
-					"%.f3;%.f3;%.f3\n",
+					"%.f3;%.f3;%.f3%s\n",
 					ctx->lcore_id,
 					ctx->options->test_buffer_size,
 					test_burst_size,
@@ -488,6 +585,54 @@ cperf_throughput_test_runner(void *test_ctx)
 					ops_deqd_failed,
 					ops_per_second/1000000,
 					throughput_gbps,
+					cycles_per_packet,
+					cpu_crypto ? ";enq-deq" : "");
+		}
+
+		if (cpu_crypto) {
+			/*
+			 * Run the same buffers through the synchronous API;
+			 * Dequeued holds the buffers processed successfully.
+			 */
+			ops_deqd_total = cperf_throughput_cpu_crypto(ctx,
+					test_burst_size, &tsc_duration);
+			ops_deqd_failed = ctx->options->total_ops -
+					ops_deqd_total;
+
+			ops_per_second = ((double)ctx->options->total_ops /
+					tsc_duration) * rte_get_tsc_hz();
+			throughput_gbps = ((ops_per_second *
+					ctx->options->test_buffer_size * 8) /
+					1000000000);
+			cycles_per_packet = ((double)tsc_duration /
+					ctx->options->total_ops);
+
+			if (!ctx->options->csv)
+				printf("%12u%12u%12u%12u%12"PRIu64"%12u"
+					"%12"PRIu64"%12.4f%12.4f%12.2f%12s\n",
+					ctx->lcore_id,
+					ctx->options->test_buffer_size,
+					test_burst_size,
+					ctx->options->total_ops,
+					ops_deqd_total,
+					0,
+					ops_deqd_failed,
+					ops_per_second/1000000,
+					throughput_gbps,
+					cycles_per_packet,
+					"cpu");
+			else
+				printf("%10u;%10u;%u;%u;%"PRIu64";%u;%"PRIu64";"
+					"%.f3;%.f3;%.f3;cpu\n",
+					ctx->lcore_id,
+					ctx->options->test_buffer_size,
+					test_burst_size,
+					ctx->options->total_ops,
+					ops_deqd_total,
+					0,
+					ops_deqd_failed,
+					ops_per_second/1000000,
+					throughput_gbps,
 					cycles_per_packet);
 		}
 
@@ -2356,6 +2356,83 @@ set_tx_pkt_split(const char *name)
 	printf("unknown value: \"%s\"\n", name);
 }
 
+#ifdef RTE_LIBRTE_GRO
+void
+setup_gro(const char *mode, portid_t port_id)
+{
+	if (!rte_eth_dev_is_valid_port(port_id)) {
+		printf("invalid port id %u\n", port_id);
+		return;
+	}
+	if (test_done == 0) {
+		printf("before changing GRO mode,"
+				" please stop forwarding first\n");
+		return;
+	}
+	if (strcmp(mode, "on") == 0)
+		ports[port_id].gro_enable = 1;
+	else if (strcmp(mode, "off") == 0)
+		ports[port_id].gro_enable = 0;
+}
+
+void
+setup_gro_flush_timeout(uint32_t timeout_us)
+{
+	if (test_done == 0) {
+		printf("before changing GRO flush timeout,"
+				" please stop forwarding first\n");
+		return;
+	}
+	gro_flush_timeout = timeout_us;
+	gro_flush_cycles = rte_get_tsc_hz() * timeout_us / US_PER_S;
+}
+
+void
+show_gro(portid_t port_id)
+{
+	if (!rte_eth_dev_is_valid_port(port_id)) {
+		printf("invalid port id %u\n", port_id);
+		return;
+	}
+	if (ports[port_id].gro_enable == 0) {
+		printf("GRO is not enabled on port %u\n", port_id);
+		return;
+	}
+	printf("GRO types: TCP/IPv4, VxLAN with inner TCP/IPv4\n");
+	printf("Max flows per lcore: %u\n", gro_param.max_flow_num);
+	printf("Max packets held per flow: %u\n",
+			gro_param.max_item_per_flow);
+	if (gro_flush_timeout == 0)
+		printf("Mode: merge within each RX burst\n");
+	else
+		printf("Mode: hold packets up to %u us\n", gro_flush_timeout);
+}
+#endif
+
+void
+setup_gso(const char *mode, portid_t port_id)
+{
+	if (!rte_eth_dev_is_valid_port(port_id)) {
+		printf("invalid port id %u\n", port_id);
+		return;
+	}
+	if (strcmp(mode, "on") == 0) {
+		if (test_done == 0) {
+			printf("before enabling GSO,"
+					" please stop forwarding first\n");
+			return;
+		}
+		ports[port_id].gso_enable = 1;
+	} else if (strcmp(mode, "off") == 0) {
+		if (test_done == 0) {
+			printf("before disabling GSO,"
+					" please stop forwarding first\n");
+			return;
+		}
+		ports[port_id].gso_enable = 0;
+	}
+}
+
 void
 show_tx_pkt_segments(void)
 {
@@ -104,6 +104,7 @@ struct testpmd_offload_info {
 	uint16_t tso_segsz;
 	uint16_t tunnel_tso_segsz;
 	uint32_t pkt_len;
+	uint8_t gso_enable;
 };
 
 /* simplified GRE header */
@@ -375,7 +376,12 @@ process_inner_cksums(void *l3_hdr, const struct testpmd_offload_info *info,
 		tcp_hdr->cksum = 0;
 		if (tso_segsz)
 			ol_flags |= PKT_TX_TCP_SEG;
-		else if (testpmd_ol_flags & TESTPMD_TX_OFFLOAD_TCP_CKSUM)
+		else if (info->gso_enable) {
+			/* the checksum of each segment is set by GSO */
+			ol_flags |= PKT_TX_TCP_SEG;
+			if (testpmd_ol_flags & TESTPMD_TX_OFFLOAD_TCP_CKSUM)
+				ol_flags |= PKT_TX_TCP_CKSUM;
+		} else if (testpmd_ol_flags & TESTPMD_TX_OFFLOAD_TCP_CKSUM)
 			ol_flags |= PKT_TX_TCP_CKSUM;
 		else {
 			tcp_hdr->cksum =
@@ -600,14 +606,42 @@ pkt_copy_split(const struct rte_mbuf *pkt)
 	return md[0];
 }
 
+#ifdef RTE_LIBRTE_GRO
+/*
+ * Merge the TCP segments received on a GRO enabled port. The packets are
+ * either merged within the burst, or held by the GRO context of the lcore
+ * until the flush timeout expires.
+ */
+static uint16_t
+pkt_burst_gro(struct rte_mbuf **pkts, uint16_t nb_rx)
+{
+	void *gro_ctx;
+
+	if (gro_flush_timeout == 0)
+		return rte_gro_reassemble_burst(pkts, nb_rx, &gro_param);
+
+	gro_ctx = current_fwd_lcore()->gro_ctx;
+	nb_rx = rte_gro_reassemble(pkts, nb_rx, gro_ctx);
+	if (rte_gro_get_pkt_count(gro_ctx) == 0)
+		return nb_rx;
+
+	return nb_rx + rte_gro_timeout_flush(gro_ctx, gro_flush_cycles,
+			gro_param.gro_types, &pkts[nb_rx],
+			MAX_PKT_BURST - nb_rx);
+}
+#endif
+
 /*
- * Receive a burst of packets, and for each packet:
+ * Receive a burst of packets, merge their TCP segments if GRO is enabled
+ * on the RX port, and for each packet:
  *  - parse packet, and try to recognize a supported packet type (1)
  *  - if it's not a supported packet type, don't touch the packet, else:
  *  - reprocess the checksum of all supported layers. This is done in SW
  *    or HW, depending on testpmd command line configuration
  *  - if TSO is enabled in testpmd command line, also flag the mbuf for TCP
  *    segmentation offload (this implies HW TCP checksum)
+ *  - if GSO is enabled on the output port, segment the large TCP/IPv4
+ *    packets in software (TCP/IPv4, and VxLAN or GRE with outer IPv4)
  * Then transmit packets on the output port.
  *
  * (1) Supported packets are:
@@ -628,6 +662,12 @@ static void
 pkt_burst_checksum_forward(struct fwd_stream *fs)
 {
 	struct rte_mbuf *pkts_burst[MAX_PKT_BURST];
+#ifdef RTE_LIBRTE_GSO
+	struct rte_mbuf *gso_segments[GSO_MAX_PKT_BURST];
+	struct rte_gso_ctx *gso_ctx;
+	int ret;
+#endif
+	struct rte_mbuf **tx_pkts_burst;
 	struct rte_port *txp;
 	struct rte_mbuf *m, *p;
 	struct ether_hdr *eth_hdr;
@@ -635,6 +675,7 @@ pkt_burst_checksum_forward(struct fwd_stream *fs)
 	uint16_t nb_rx;
 	uint16_t nb_tx;
 	uint16_t nb_prep;
+	uint16_t nb_segments = 0;
 	uint16_t i;
 	uint64_t rx_ol_flags, tx_ol_flags;
 	uint16_t testpmd_ol_flags;
@@ -656,13 +697,18 @@ pkt_burst_checksum_forward(struct fwd_stream *fs)
 	/* receive a burst of packet */
 	nb_rx = rte_eth_rx_burst(fs->rx_port, fs->rx_queue, pkts_burst,
 				 nb_pkt_per_burst);
+	fs->rx_packets += nb_rx;
+#ifdef RTE_LIBRTE_GRO
+	/* called on empty bursts too, to flush the held packets */
+	if (unlikely(ports[fs->rx_port].gro_enable))
+		nb_rx = pkt_burst_gro(pkts_burst, nb_rx);
+#endif
 	if (unlikely(nb_rx == 0))
 		return;
 
 #ifdef RTE_TEST_PMD_RECORD_BURST_STATS
 	fs->rx_burst_stats.pkt_burst_spread[nb_rx]++;
 #endif
-	fs->rx_packets += nb_rx;
 	rx_bad_ip_csum = 0;
 	rx_bad_l4_csum = 0;
 
@@ -734,6 +780,18 @@ pkt_burst_checksum_forward(struct fwd_stream *fs)
 			l3_hdr = (char *)l3_hdr + info.outer_l3_len + info.l2_len;
 		}
 
+		/* only flag the packets that GSO is able to segment */
+		info.gso_enable = txp->gso_enable &&
+			info.pkt_len > gso_max_segment_size &&
+			info.ethertype == _htons(ETHER_TYPE_IPv4) &&
+			info.l4_proto == IPPROTO_TCP &&
+			(!info.is_tunnel ||
+			 (info.outer_ethertype == _htons(ETHER_TYPE_IPv4) &&
+			  ((tx_ol_flags & PKT_TX_TUNNEL_MASK) ==
+			   PKT_TX_TUNNEL_VXLAN ||
+			   (tx_ol_flags & PKT_TX_TUNNEL_MASK) ==
+			   PKT_TX_TUNNEL_GRE)));
+
 		/* step 2: depending on user command line configuration,
 		 * recompute checksum either in software or flag the
 		 * mbuf to offload the calculation to the NIC. If TSO
@@ -755,7 +813,7 @@ pkt_burst_checksum_forward(struct fwd_stream *fs)
 		/* step 3: fill the mbuf meta data (flags and header lengths) */
 
 		if (info.is_tunnel == 1) {
-			if (info.tunnel_tso_segsz ||
+			if (info.tunnel_tso_segsz || info.gso_enable ||
 			    (testpmd_ol_flags &
 			    TESTPMD_TX_OFFLOAD_OUTER_IP_CKSUM) ||
 			    (tx_ol_flags & PKT_TX_OUTER_IPV6)) {
@@ -848,24 +906,51 @@ pkt_burst_checksum_forward(struct fwd_stream *fs)
 		}
 	}
 
+#ifdef RTE_LIBRTE_GSO
+	if (txp->gso_enable) {
+		gso_ctx = &(current_fwd_lcore()->gso_ctx);
+		gso_ctx->gso_size = gso_max_segment_size;
+		for (i = 0; i < nb_rx; i++) {
+			ret = rte_gso_segment(pkts_burst[i], gso_ctx,
+					&gso_segments[nb_segments],
+					GSO_MAX_PKT_BURST - nb_segments);
+			if (ret > 0)
+				nb_segments += ret;
+			else {
+				if (verbose_level > 0)
+					printf("Unable to segment packet: %s\n",
+						rte_strerror(-ret));
+				fs->fwd_dropped++;
+				rte_pktmbuf_free(pkts_burst[i]);
+			}
+		}
+		tx_pkts_burst = gso_segments;
+	} else
+#endif
+	{
+		tx_pkts_burst = pkts_burst;
+		nb_segments = nb_rx;
+	}
+
 	nb_prep = rte_eth_tx_prepare(fs->tx_port, fs->tx_queue,
-			pkts_burst, nb_rx);
-	if (nb_prep != nb_rx)
+			tx_pkts_burst, nb_segments);
+	if (nb_prep != nb_segments)
 		printf("Preparing packet burst to transmit failed: %s\n",
 				rte_strerror(rte_errno));
 
-	nb_tx = rte_eth_tx_burst(fs->tx_port, fs->tx_queue, pkts_burst,
+	nb_tx = rte_eth_tx_burst(fs->tx_port, fs->tx_queue, tx_pkts_burst,
 			nb_prep);
 
 	/*
 	 * Retry if necessary
 	 */
-	if (unlikely(nb_tx < nb_rx) && fs->retry_enabled) {
+	if (unlikely(nb_tx < nb_segments) && fs->retry_enabled) {
 		retry = 0;
-		while (nb_tx < nb_rx && retry++ < burst_tx_retry_num) {
+		while (nb_tx < nb_segments && retry++ < burst_tx_retry_num) {
 			rte_delay_us(burst_tx_delay_time);
 			nb_tx += rte_eth_tx_burst(fs->tx_port, fs->tx_queue,
-					&pkts_burst[nb_tx], nb_rx - nb_tx);
+					&tx_pkts_burst[nb_tx],
+					nb_segments - nb_tx);
 		}
 	}
 	fs->tx_packets += nb_tx;
@@ -873,13 +958,15 @@ pkt_burst_checksum_forward(struct fwd_stream *fs)
 	fs->rx_bad_l4_csum += rx_bad_l4_csum;
 
 #ifdef RTE_TEST_PMD_RECORD_BURST_STATS
-	fs->tx_burst_stats.pkt_burst_spread[nb_tx]++;
+	/* GSO bursts may exceed MAX_PKT_BURST */
+	if (nb_tx < MAX_PKT_BURST)
+		fs->tx_burst_stats.pkt_burst_spread[nb_tx]++;
 #endif
-	if (unlikely(nb_tx < nb_rx)) {
-		fs->fwd_dropped += (nb_rx - nb_tx);
+	if (unlikely(nb_tx < nb_segments)) {
+		fs->fwd_dropped += (nb_segments - nb_tx);
 		do {
-			rte_pktmbuf_free(pkts_burst[nb_tx]);
-		} while (++nb_tx < nb_rx);
+			rte_pktmbuf_free(tx_pkts_burst[nb_tx]);
+		} while (++nb_tx < nb_segments);
 	}
 #ifdef RTE_TEST_PMD_RECORD_CORE_CYCLES
 	end_tsc = rte_rdtsc();
@@ -193,6 +193,20 @@ uint8_t  tx_pkt_nb_segs = 1; /**< Number of segments in TXONLY packets */
 enum tx_pkt_split tx_pkt_split = TX_PKT_SPLIT_OFF;
 /**< Split policy for packets to TX. */
 
+#ifdef RTE_LIBRTE_GRO
+struct rte_gro_param gro_param = {
+	.gro_types = RTE_GRO_TCP_IPV4 | RTE_GRO_IPV4_VXLAN_TCP_IPV4,
+	.max_flow_num = GRO_DEFAULT_FLOW_NUM,
+	.max_item_per_flow = GRO_DEFAULT_ITEM_NUM_PER_FLOW,
+};
+/** 0 merges the packets of each burst, otherwise they are held up to it. */
+uint32_t gro_flush_timeout;
+uint64_t gro_flush_cycles;
+#endif
+
+/** Maximum size of the packets generated by GSO, excluding the CRC. */
+uint16_t gso_max_segment_size = ETHER_MAX_LEN - ETHER_CRC_LEN;
+
 uint16_t nb_pkt_per_burst = DEF_PKT_BURST; /**< Number of packets per burst. */
 uint16_t mb_mempool_cache = DEF_MBUF_CACHE; /**< Size of mbuf mempool cache. */
 
@@ -655,6 +669,25 @@ init_config(void)
 		if (mbp == NULL)
 			mbp = mbuf_pool_find(0);
 		fwd_lcores[lc_id]->mbp = mbp;
+#ifdef RTE_LIBRTE_GRO
+		gro_param.socket_id = rte_lcore_to_socket_id(
+				fwd_lcores_cpuids[lc_id]);
+		fwd_lcores[lc_id]->gro_ctx = rte_gro_ctx_create(&gro_param);
+		if (fwd_lcores[lc_id]->gro_ctx == NULL)
+			rte_exit(EXIT_FAILURE,
+					"rte_gro_ctx_create() failed\n");
+#endif
+#ifdef RTE_LIBRTE_GSO
+		/* GSO headers and payload references use the same pool */
+		fwd_lcores[lc_id]->gso_ctx.direct_pool = mbp;
+		fwd_lcores[lc_id]->gso_ctx.indirect_pool = mbp;
+		fwd_lcores[lc_id]->gso_ctx.gso_types =
+			DEV_TX_OFFLOAD_TCP_TSO |
+			DEV_TX_OFFLOAD_VXLAN_TNL_TSO |
+			DEV_TX_OFFLOAD_GRE_TNL_TSO;
+		fwd_lcores[lc_id]->gso_ctx.gso_size = gso_max_segment_size;
+		fwd_lcores[lc_id]->gso_ctx.flag = 0;
+#endif
 	}
 
 	/* Configuration of packet forwarding streams. */
@@ -1219,6 +1252,22 @@ stop_packet_forwarding(void)
 		fwd_lcores[lc_id]->stopped = 1;
 	printf("\nWaiting for lcores to finish...\n");
 	rte_eal_mp_wait_lcore();
+#ifdef RTE_LIBRTE_GRO
+	/* drop the packets still held by GRO */
+	for (lc_id = 0; lc_id < cur_fwd_config.nb_fwd_lcores; lc_id++) {
+		struct rte_mbuf *pkts[MAX_PKT_BURST];
+		uint16_t nb_pkts, k;
+
+		do {
+			nb_pkts = rte_gro_timeout_flush(
+					fwd_lcores[lc_id]->gro_ctx, 0,
+					gro_param.gro_types, pkts,
+					MAX_PKT_BURST);
+			for (k = 0; k < nb_pkts; k++)
+				rte_pktmbuf_free(pkts[k]);
+		} while (nb_pkts > 0);
+	}
+#endif
 	port_fwd_end = cur_fwd_config.fwd_eng->port_fwd_end;
 	if (port_fwd_end != NULL) {
 		for (i = 0; i < cur_fwd_config.nb_fwd_ports; i++) {
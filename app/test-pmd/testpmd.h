@@ -34,6 +34,13 @@
 #ifndef _TESTPMD_H_
 #define _TESTPMD_H_
 
+#ifdef RTE_LIBRTE_GRO
+#include <rte_gro.h>
+#endif
+#ifdef RTE_LIBRTE_GSO
+#include <rte_gso.h>
+#endif
+
 #define RTE_PORT_ALL            (~(portid_t)0x0)
 
 #define RTE_TEST_RX_DESC_MAX    2048
@@ -174,6 +181,8 @@ struct rte_port {
 	uint16_t                tx_ol_flags;/**< TX Offload Flags (TESTPMD_TX_OFFLOAD...). */
 	uint16_t                tso_segsz;  /**< Segmentation offload MSS for non-tunneled packets. */
 	uint16_t                tunnel_tso_segsz; /**< Segmentation offload MSS for tunneled pkts. */
+	uint8_t                 gro_enable; /**< Software merging of TCP packets in csum engine. */
+	uint8_t                 gso_enable; /**< Software segmentation of TCP packets in csum engine. */
 	uint16_t                tx_vlan_id;/**< The tag ID */
 	uint16_t                tx_vlan_id_outer;/**< The outer tag ID */
 	void                    *fwd_ctx;   /**< Forwarding mode context */
@@ -208,6 +217,12 @@ struct fwd_lcore {
 	lcoreid_t  cpuid_idx;    /**< index of logical core in CPU id table */
 	queueid_t  tx_queue;     /**< TX queue to send forwarded packets */
 	volatile char stopped;   /**< stop forwarding when set */
+#ifdef RTE_LIBRTE_GRO
+	void *gro_ctx;           /**< GRO context of this core */
+#endif
+#ifdef RTE_LIBRTE_GSO
+	struct rte_gso_ctx gso_ctx; /**< GSO context of this core */
+#endif
 };
 
 /*
@@ -407,6 +422,17 @@ enum tx_pkt_split {
 
 extern enum tx_pkt_split tx_pkt_split;
 
+#ifdef RTE_LIBRTE_GRO
+#define GRO_DEFAULT_FLOW_NUM 64
+#define GRO_DEFAULT_ITEM_NUM_PER_FLOW 32
+extern struct rte_gro_param gro_param; /**< GRO parameters of all ports */
+extern uint32_t gro_flush_timeout; /**< GRO flush timeout, in us */
+extern uint64_t gro_flush_cycles; /**< GRO flush timeout, in TSC cycles */
+#endif
+
+#define GSO_MAX_PKT_BURST 2048
+extern uint16_t gso_max_segment_size; /**< Max size of GSO output packets */
+
 extern uint16_t nb_pkt_per_burst;
 extern uint16_t mb_mempool_cache;
 extern int8_t rx_pthresh;
@@ -577,6 +603,10 @@ void set_verbose_level(uint16_t vb_level);
 void set_tx_pkt_segments(unsigned *seg_lengths, unsigned nb_segs);
 void show_tx_pkt_segments(void);
 void set_tx_pkt_split(const char *name);
+void setup_gro(const char *mode, portid_t port_id);
+void setup_gro_flush_timeout(uint32_t timeout_us);
+void show_gro(portid_t port_id);
+void setup_gso(const char *mode, portid_t port_id);
 void set_nb_pkt_per_burst(uint16_t pkt_burst);
 char *list_pkt_forwarding_modes(void);
 char *list_pkt_forwarding_retry_modes(void);
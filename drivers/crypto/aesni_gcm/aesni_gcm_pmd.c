@@ -116,6 +116,10 @@ aesni_gcm_set_session_parameters(struct aesni_gcm_session *sess,
 		return -EINVAL;
 	}
 
+	sess->digest_length = auth_xform->auth.digest_length;
+	sess->aad_length = auth_xform->auth.add_auth_data_length;
+	sess->gmac = auth_xform->auth.algo == RTE_CRYPTO_AUTH_AES_GMAC;
+
 	/* Check key length and calculate GCM pre-compute. */
 	switch (cipher_xform->cipher.key.length) {
 	case 16:
@@ -429,6 +433,105 @@ aesni_gcm_pmd_enqueue_burst(void *queue_pair,
 	return nb_enqueued;
 }
 
+/** Process one packet of a synchronous burst in place */
+static int32_t
+aesni_gcm_sgl_process(struct aesni_gcm_session *s, struct gcm_data *gdata,
+		const struct aesni_gcm_ops *ops, const struct rte_crypto_sgl *sgl,
+		union rte_crypto_sym_ofs ofs, uint8_t *iv, uint8_t *aad,
+		uint8_t *tag)
+{
+	uint32_t i, len, total_len, offset, part_len;
+	uint8_t *buf;
+
+	total_len = 0;
+	for (i = 0; i < sgl->num; i++)
+		total_len += sgl->vec[i].len;
+
+	if (ofs.ofs.cipher.head + ofs.ofs.cipher.tail > total_len)
+		return EINVAL;
+
+	len = total_len - ofs.ofs.cipher.head - ofs.ofs.cipher.tail;
+	offset = ofs.ofs.cipher.head;
+
+	/*
+	 * GCM working in 12B IV mode => 16B pre-counter block we need
+	 * to set BE LSB to 1, driver expects that 16B is allocated
+	 */
+	*(uint32_t *)&iv[12] = rte_bswap32(1);
+
+	ops->init(gdata, iv, aad, (uint64_t)s->aad_length);
+
+	for (i = 0; i < sgl->num && len != 0; i++) {
+		if (offset >= sgl->vec[i].len) {
+			offset -= sgl->vec[i].len;
+			continue;
+		}
+
+		buf = (uint8_t *)sgl->vec[i].base + offset;
+		part_len = RTE_MIN(sgl->vec[i].len - offset, len);
+		ops->update(gdata, buf, buf, (uint64_t)part_len);
+		len -= part_len;
+		offset = 0;
+	}
+
+	ops->finalize(gdata, tag, (uint64_t)s->digest_length);
+
+	return 0;
+}
+
+uint32_t
+aesni_gcm_pmd_cpu_crypto_process(struct rte_cryptodev *dev __rte_unused,
+		void *sess, union rte_crypto_sym_ofs ofs,
+		struct rte_crypto_sym_vec *vec)
+{
+	struct aesni_gcm_session *s = sess;
+	struct gcm_data gdata __rte_cache_aligned;
+	uint8_t tag[16];
+	uint32_t i, nb_ok = 0;
+	int32_t status;
+
+	if (s->digest_length != 16 && s->digest_length != 12 &&
+			s->digest_length != 8) {
+		for (i = 0; i < vec->num; i++)
+			vec->status[i] = EINVAL;
+		return 0;
+	}
+
+	/* GMAC needs the whole authenticated region as contiguous AAD */
+	if (s->gmac) {
+		for (i = 0; i < vec->num; i++)
+			vec->status[i] = ENOTSUP;
+		return 0;
+	}
+
+	/*
+	 * The per packet GCM state lives in a copy of the session key data
+	 * on the stack, so the session can be used by several lcores at once.
+	 */
+	gdata = s->gdata;
+
+	for (i = 0; i < vec->num; i++) {
+		if (s->op == AESNI_GCM_OP_AUTHENTICATED_ENCRYPTION) {
+			status = aesni_gcm_sgl_process(s, &gdata,
+					&aesni_gcm_enc[s->key], &vec->sgl[i],
+					ofs, vec->iv[i], vec->aad[i],
+					vec->digest[i]);
+		} else {
+			status = aesni_gcm_sgl_process(s, &gdata,
+					&aesni_gcm_dec[s->key], &vec->sgl[i],
+					ofs, vec->iv[i], vec->aad[i], tag);
+			if (status == 0 && memcmp(tag, vec->digest[i],
+					s->digest_length) != 0)
+				status = EBADMSG;
+		}
+
+		vec->status[i] = status;
+		nb_ok += (status == 0);
+	}
+
+	return nb_ok;
+}
+
 static int aesni_gcm_remove(struct rte_vdev_device *vdev);
 
 static int
@@ -466,7 +569,8 @@ aesni_gcm_create(const char *name,
 	dev->feature_flags = RTE_CRYPTODEV_FF_SYMMETRIC_CRYPTO |
 			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING |
 			RTE_CRYPTODEV_FF_CPU_AESNI |
-			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
+			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER |
+			RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO;
 
 	internals = dev->data->dev_private;
 
@@ -357,7 +357,9 @@ struct rte_cryptodev_ops aesni_gcm_pmd_ops = {
 
 		.session_get_size	= aesni_gcm_pmd_session_get_size,
 		.session_configure	= aesni_gcm_pmd_session_configure,
-		.session_clear		= aesni_gcm_pmd_session_clear
+		.session_clear		= aesni_gcm_pmd_session_clear,
+
+		.sym_cpu_process	= aesni_gcm_pmd_cpu_crypto_process
 };
 
 struct rte_cryptodev_ops *rte_aesni_gcm_pmd_ops = &aesni_gcm_pmd_ops;
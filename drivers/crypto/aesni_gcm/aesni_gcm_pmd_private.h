@@ -94,6 +94,12 @@ struct aesni_gcm_session {
 	/**< GCM operation type */
 	enum aesni_gcm_key key;
 	/**< GCM key type */
+	uint16_t digest_length;
+	/**< Digest length, used by synchronous CPU crypto processing */
+	uint16_t aad_length;
+	/**< AAD length, used by synchronous CPU crypto processing */
+	uint8_t gmac;
+	/**< AES-GMAC session, not supported by synchronous CPU crypto */
 	struct gcm_data gdata __rte_cache_aligned;
 	/**< GCM parameters */
 };
@@ -113,6 +119,21 @@ aesni_gcm_set_session_parameters(struct aesni_gcm_session *sess,
 		const struct rte_crypto_sym_xform *xform);
 
 
+/**
+ * Synchronously process a burst of packets with a GCM session
+ * @param	dev	crypto device
+ * @param	sess	aesni gcm session structure
+ * @param	ofs	cipher region offsets of each packet
+ * @param	vec	burst of packets
+ *
+ * @return
+ * - Number of successfully processed packets
+ */
+extern uint32_t
+aesni_gcm_pmd_cpu_crypto_process(struct rte_cryptodev *dev, void *sess,
+		union rte_crypto_sym_ofs ofs, struct rte_crypto_sym_vec *vec);
+
+
 /**
  * Device specific operations function pointer structure */
 extern struct rte_cryptodev_ops *rte_aesni_gcm_pmd_ops;
@@ -331,6 +331,20 @@ null_crypto_pmd_session_clear(struct rte_cryptodev *dev __rte_unused,
 		memset(sess, 0, sizeof(struct null_crypto_session));
 }
 
+/** Synchronous processing of a burst: the null algorithms leave data as is */
+static uint32_t
+null_crypto_pmd_sym_cpu_process(struct rte_cryptodev *dev __rte_unused,
+		void *sess __rte_unused, union rte_crypto_sym_ofs ofs __rte_unused,
+		struct rte_crypto_sym_vec *vec)
+{
+	uint32_t i;
+
+	for (i = 0; i < vec->num; i++)
+		vec->status[i] = 0;
+
+	return vec->num;
+}
+
 struct rte_cryptodev_ops pmd_ops = {
 		.dev_configure		= null_crypto_pmd_config,
 		.dev_start		= null_crypto_pmd_start,
@@ -350,7 +364,9 @@ struct rte_cryptodev_ops pmd_ops = {
 
 		.session_get_size	= null_crypto_pmd_session_get_size,
 		.session_configure	= null_crypto_pmd_session_configure,
-		.session_clear		= null_crypto_pmd_session_clear
+		.session_clear		= null_crypto_pmd_session_clear,
+
+		.sym_cpu_process	= null_crypto_pmd_sym_cpu_process
 };
 
 struct rte_cryptodev_ops *null_crypto_pmd_ops = &pmd_ops;
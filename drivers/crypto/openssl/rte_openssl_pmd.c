@@ -322,6 +322,8 @@ openssl_set_session_auth_parameters(struct openssl_session *sess,
 	/* Select auth generate/verify */
 	sess->auth.operation = xform->auth.op;
 	sess->auth.algo = xform->auth.algo;
+	sess->auth.digest_length = xform->auth.digest_length;
+	sess->auth.aad_length = xform->auth.add_auth_data_length;
 
 	/* Select auth algo */
 	switch (xform->auth.algo) {
@@ -853,7 +855,7 @@ process_openssl_auth_hmac(struct rte_mbuf *mbuf_src, uint8_t *dst, int offset,
 		__rte_unused uint8_t *iv, EVP_PKEY *pkey,
 		int srclen, EVP_MD_CTX *ctx, const EVP_MD *algo)
 {
-	size_t dstlen;
+	size_t dstlen = EVP_MD_size(algo);
 	struct rte_mbuf *m;
 	int l, n = srclen;
 	uint8_t *src;
@@ -1213,6 +1215,278 @@ process_op(const struct openssl_qp *qp, struct rte_crypto_op *op,
 	return retval;
 }
 
+/*
+ *------------------------------------------------------------------------------
+ * Synchronous CPU crypto processing
+ *------------------------------------------------------------------------------
+ */
+
+/** Total data length of a scatter-gather list */
+static inline uint32_t
+sgl_length(const struct rte_crypto_sgl *sgl)
+{
+	uint32_t i, len = 0;
+
+	for (i = 0; i < sgl->num; i++)
+		len += sgl->vec[i].len;
+
+	return len;
+}
+
+/**
+ * Cipher a region of a scatter-gather list in place, or only feed it to the
+ * context as AAD when *aad* is set.
+ */
+static int
+sgl_cipher_update(const struct rte_crypto_sgl *sgl, uint32_t offset,
+		uint32_t len, EVP_CIPHER_CTX *ctx, int aad)
+{
+	uint32_t i, part_len;
+	uint8_t *buf;
+	int outlen;
+
+	for (i = 0; i < sgl->num && len != 0; i++) {
+		if (offset >= sgl->vec[i].len) {
+			offset -= sgl->vec[i].len;
+			continue;
+		}
+
+		buf = (uint8_t *)sgl->vec[i].base + offset;
+		part_len = RTE_MIN(sgl->vec[i].len - offset, len);
+
+		if (aad) {
+			if (EVP_CipherUpdate(ctx, NULL, &outlen, buf,
+					part_len) <= 0)
+				return -1;
+		/* block modes need block aligned segments to work in place */
+		} else if (EVP_CipherUpdate(ctx, buf, &outlen, buf,
+				part_len) <= 0 ||
+				(uint32_t)outlen != part_len)
+			return -1;
+
+		len -= part_len;
+		offset = 0;
+	}
+
+	return len == 0 ? 0 : -1;
+}
+
+/** Hash a region of a scatter-gather list */
+static int
+sgl_auth_update(const struct rte_crypto_sgl *sgl, uint32_t offset,
+		uint32_t len, EVP_MD_CTX *ctx, int hmac)
+{
+	uint32_t i, part_len;
+	uint8_t *buf;
+	int ret;
+
+	for (i = 0; i < sgl->num && len != 0; i++) {
+		if (offset >= sgl->vec[i].len) {
+			offset -= sgl->vec[i].len;
+			continue;
+		}
+
+		buf = (uint8_t *)sgl->vec[i].base + offset;
+		part_len = RTE_MIN(sgl->vec[i].len - offset, len);
+
+		if (hmac)
+			ret = EVP_DigestSignUpdate(ctx, buf, part_len);
+		else
+			ret = EVP_DigestUpdate(ctx, buf, part_len);
+		if (ret <= 0)
+			return -1;
+
+		len -= part_len;
+		offset = 0;
+	}
+
+	return len == 0 ? 0 : -1;
+}
+
+/** Cipher the cipher region of one packet */
+static int32_t
+cpu_crypto_cipher(struct openssl_session *sess,
+		const struct rte_crypto_sgl *sgl, uint32_t offset, uint32_t len,
+		uint8_t *iv)
+{
+	uint8_t tail[EVP_MAX_BLOCK_LENGTH];
+	int enc, outlen;
+
+	if (sess->cipher.mode != OPENSSL_CIPHER_LIB)
+		return ENOTSUP;
+
+	enc = sess->cipher.direction == RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	if (EVP_CipherInit_ex(sess->cipher.ctx, sess->cipher.evp_algo, NULL,
+			sess->cipher.key.data, iv, enc) <= 0)
+		return EINVAL;
+
+	EVP_CIPHER_CTX_set_padding(sess->cipher.ctx, 0);
+
+	if (sgl_cipher_update(sgl, offset, len, sess->cipher.ctx, 0) != 0 ||
+			EVP_CipherFinal_ex(sess->cipher.ctx, tail, &outlen) <= 0)
+		return EINVAL;
+
+	return 0;
+}
+
+/** Generate or verify the digest of the auth region of one packet */
+static int32_t
+cpu_crypto_auth(struct openssl_session *sess,
+		const struct rte_crypto_sgl *sgl, uint32_t offset, uint32_t len,
+		uint8_t *digest)
+{
+	uint8_t md[EVP_MAX_MD_SIZE];
+	unsigned int mdlen;
+	size_t siglen = sizeof(md);
+	int ret;
+
+	if (sess->auth.mode == OPENSSL_AUTH_AS_HMAC) {
+		ret = EVP_DigestSignInit(sess->auth.hmac.ctx, NULL,
+				sess->auth.hmac.evp_algo, NULL,
+				sess->auth.hmac.pkey) > 0 &&
+			sgl_auth_update(sgl, offset, len,
+				sess->auth.hmac.ctx, 1) == 0 &&
+			EVP_DigestSignFinal(sess->auth.hmac.ctx, md,
+				&siglen) > 0;
+		mdlen = siglen;
+	} else {
+		ret = EVP_DigestInit_ex(sess->auth.auth.ctx,
+				sess->auth.auth.evp_algo, NULL) > 0 &&
+			sgl_auth_update(sgl, offset, len,
+				sess->auth.auth.ctx, 0) == 0 &&
+			EVP_DigestFinal_ex(sess->auth.auth.ctx, md,
+				&mdlen) > 0;
+	}
+
+	if (!ret || sess->auth.digest_length > mdlen)
+		return EINVAL;
+
+	if (sess->auth.operation == RTE_CRYPTO_AUTH_OP_GENERATE)
+		memcpy(digest, md, sess->auth.digest_length);
+	else if (memcmp(digest, md, sess->auth.digest_length) != 0)
+		return EBADMSG;
+
+	return 0;
+}
+
+/**
+ * Encrypt or decrypt one packet with AES-GCM, or generate or verify its
+ * AES-GMAC digest, in which case the region is only authenticated.
+ */
+static int32_t
+cpu_crypto_gcm(struct openssl_session *sess,
+		const struct rte_crypto_sgl *sgl, uint32_t offset, uint32_t len,
+		uint8_t *iv, uint8_t *aad, uint8_t *digest)
+{
+	EVP_CIPHER_CTX *ctx = sess->cipher.ctx;
+	uint8_t tail[EVP_MAX_BLOCK_LENGTH];
+	int enc, outlen;
+
+	enc = sess->cipher.direction == RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	if (EVP_CipherInit_ex(ctx, sess->cipher.evp_algo, NULL, NULL, NULL,
+			enc) <= 0 ||
+			EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, 12,
+				NULL) <= 0 ||
+			(!enc && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG,
+				sess->auth.digest_length, digest) <= 0) ||
+			EVP_CipherInit_ex(ctx, NULL, NULL,
+				sess->cipher.key.data, iv, enc) <= 0)
+		return EINVAL;
+
+	if (aad != NULL && sess->auth.aad_length > 0 &&
+			EVP_CipherUpdate(ctx, NULL, &outlen, aad,
+				sess->auth.aad_length) <= 0)
+		return EINVAL;
+
+	if (sess->auth.algo == RTE_CRYPTO_AUTH_AES_GMAC) {
+		if (sgl_cipher_update(sgl, offset, len, ctx, 1) != 0)
+			return EINVAL;
+	} else if (sgl_cipher_update(sgl, offset, len, ctx, 0) != 0)
+		return EINVAL;
+
+	if (EVP_CipherFinal_ex(ctx, tail, &outlen) <= 0)
+		return enc ? EINVAL : EBADMSG;
+
+	if (enc && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG,
+			sess->auth.digest_length, digest) <= 0)
+		return EINVAL;
+
+	return 0;
+}
+
+uint32_t
+openssl_cpu_crypto_process(struct rte_cryptodev *dev __rte_unused,
+		void *_sess, union rte_crypto_sym_ofs ofs,
+		struct rte_crypto_sym_vec *vec)
+{
+	struct openssl_session *sess = _sess;
+	uint32_t i, len, clen, alen, nb_ok = 0;
+	int32_t status;
+
+	for (i = 0; i < vec->num; i++) {
+		len = sgl_length(&vec->sgl[i]);
+		if (ofs.ofs.cipher.head + ofs.ofs.cipher.tail > len ||
+				ofs.ofs.auth.head + ofs.ofs.auth.tail > len) {
+			vec->status[i] = EINVAL;
+			continue;
+		}
+
+		clen = len - ofs.ofs.cipher.head - ofs.ofs.cipher.tail;
+		alen = len - ofs.ofs.auth.head - ofs.ofs.auth.tail;
+
+		switch (sess->chain_order) {
+		case OPENSSL_CHAIN_ONLY_CIPHER:
+			status = cpu_crypto_cipher(sess, &vec->sgl[i],
+					ofs.ofs.cipher.head, clen, vec->iv[i]);
+			break;
+		case OPENSSL_CHAIN_ONLY_AUTH:
+			status = cpu_crypto_auth(sess, &vec->sgl[i],
+					ofs.ofs.auth.head, alen,
+					vec->digest[i]);
+			break;
+		case OPENSSL_CHAIN_CIPHER_AUTH:
+			status = cpu_crypto_cipher(sess, &vec->sgl[i],
+					ofs.ofs.cipher.head, clen, vec->iv[i]);
+			if (status == 0)
+				status = cpu_crypto_auth(sess, &vec->sgl[i],
+						ofs.ofs.auth.head, alen,
+						vec->digest[i]);
+			break;
+		case OPENSSL_CHAIN_AUTH_CIPHER:
+			status = cpu_crypto_auth(sess, &vec->sgl[i],
+					ofs.ofs.auth.head, alen,
+					vec->digest[i]);
+			if (status == 0)
+				status = cpu_crypto_cipher(sess, &vec->sgl[i],
+						ofs.ofs.cipher.head, clen,
+						vec->iv[i]);
+			break;
+		case OPENSSL_CHAIN_COMBINED:
+			if (sess->auth.algo == RTE_CRYPTO_AUTH_AES_GMAC)
+				status = cpu_crypto_gcm(sess, &vec->sgl[i],
+						ofs.ofs.auth.head, alen,
+						vec->iv[i], NULL,
+						vec->digest[i]);
+			else
+				status = cpu_crypto_gcm(sess, &vec->sgl[i],
+						ofs.ofs.cipher.head, clen,
+						vec->iv[i], vec->aad[i],
+						vec->digest[i]);
+			break;
+		default:
+			status = ENOTSUP;
+			break;
+		}
+
+		vec->status[i] = status;
+		nb_ok += (status == 0);
+	}
+
+	return nb_ok;
+}
+
 /*
  *------------------------------------------------------------------------------
  * PMD Framework
@@ -1293,7 +1567,8 @@ cryptodev_openssl_create(const char *name,
 	dev->feature_flags = RTE_CRYPTODEV_FF_SYMMETRIC_CRYPTO |
 			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING |
 			RTE_CRYPTODEV_FF_CPU_AESNI |
-			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
+			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER |
+			RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO;
 
 	/* Set vector instructions mode supported */
 	internals = dev->data->dev_private;
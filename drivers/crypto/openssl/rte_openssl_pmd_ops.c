@@ -723,7 +723,9 @@ struct rte_cryptodev_ops openssl_pmd_ops = {
 
 		.session_get_size	= openssl_pmd_session_get_size,
 		.session_configure	= openssl_pmd_session_configure,
-		.session_clear		= openssl_pmd_session_clear
+		.session_clear		= openssl_pmd_session_clear,
+
+		.sym_cpu_process	= openssl_cpu_crypto_process
 };
 
 struct rte_cryptodev_ops *rte_openssl_pmd_ops = &openssl_pmd_ops;
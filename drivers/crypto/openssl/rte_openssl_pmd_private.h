@@ -139,6 +139,10 @@ struct openssl_session {
 		/**< auth operation mode */
 		enum rte_crypto_auth_algorithm algo;
 		/**< cipher algorithm */
+		uint16_t digest_length;
+		/**< digest length, used by synchronous CPU crypto */
+		uint16_t aad_length;
+		/**< AAD length, used by synchronous CPU crypto */
 
 		union {
 			struct {
@@ -170,6 +174,11 @@ openssl_set_session_parameters(struct openssl_session *sess,
 extern void
 openssl_reset_session(struct openssl_session *sess);
 
+/** Synchronously process a burst of packets with a session */
+extern uint32_t
+openssl_cpu_crypto_process(struct rte_cryptodev *dev, void *sess,
+		union rte_crypto_sym_ofs ofs, struct rte_crypto_sym_vec *vec);
+
 /** device specific operations function pointer structure */
 extern struct rte_cryptodev_ops *rte_openssl_pmd_ops;
 
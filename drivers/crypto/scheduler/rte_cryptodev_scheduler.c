@@ -33,6 +33,7 @@
 #include <rte_cryptodev.h>
 #include <rte_cryptodev_pmd.h>
 #include <rte_malloc.h>
+#include <rte_lcore.h>
 
 #include "rte_cryptodev_scheduler.h"
 #include "scheduler_pmd_private.h"
@@ -351,6 +352,13 @@ rte_cryptodev_scheduler_mode_set(uint8_t scheduler_id,
 			return -1;
 		}
 		break;
+	case CDEV_SCHED_MODE_MULTICORE:
+		if (rte_cryptodev_scheduler_load_user_scheduler(scheduler_id,
+				multicore_scheduler) < 0) {
+			CS_LOG_ERR("Failed to load scheduler");
+			return -1;
+		}
+		break;
 	default:
 		CS_LOG_ERR("Not yet supported");
 		return -ENOTSUP;
@@ -482,8 +490,10 @@ rte_cryptodev_scheduler_load_user_scheduler(uint8_t scheduler_id,
 	sched_ctx->ops.option_set = scheduler->ops->option_set;
 	sched_ctx->ops.option_get = scheduler->ops->option_get;
 
-	if (sched_ctx->private_ctx)
+	if (sched_ctx->private_ctx) {
 		rte_free(sched_ctx->private_ctx);
+		sched_ctx->private_ctx = NULL;
+	}
 
 	if (sched_ctx->ops.create_private_ctx) {
 		int ret = (*sched_ctx->ops.create_private_ctx)(dev);
@@ -531,6 +541,88 @@ rte_cryptodev_scheduler_slaves_get(uint8_t scheduler_id, uint8_t *slaves)
 	return (int)nb_slaves;
 }
 
+int
+rte_cryptodev_scheduler_worker_cores_set(uint8_t scheduler_id,
+		const unsigned int *lcores, uint32_t nb_lcores)
+{
+	struct rte_cryptodev *dev = rte_cryptodev_pmd_get_dev(scheduler_id);
+	struct scheduler_ctx *sched_ctx;
+	uint32_t i, j;
+
+	if (!dev) {
+		CS_LOG_ERR("Operation not supported");
+		return -ENOTSUP;
+	}
+
+	if (dev->dev_type != RTE_CRYPTODEV_SCHEDULER_PMD) {
+		CS_LOG_ERR("Operation not supported");
+		return -ENOTSUP;
+	}
+
+	if (dev->data->dev_started) {
+		CS_LOG_ERR("Illegal operation");
+		return -EBUSY;
+	}
+
+	if (nb_lcores > RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES ||
+			(nb_lcores && !lcores)) {
+		CS_LOG_ERR("Invalid worker lcores");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < nb_lcores; i++) {
+		if (lcores[i] >= RTE_MAX_LCORE ||
+				lcores[i] == rte_get_master_lcore() ||
+				!rte_lcore_is_enabled(lcores[i])) {
+			CS_LOG_ERR("Invalid worker lcore %u", lcores[i]);
+			return -EINVAL;
+		}
+
+		for (j = 0; j < i; j++) {
+			if (lcores[j] == lcores[i]) {
+				CS_LOG_ERR("Duplicated worker lcore %u",
+						lcores[i]);
+				return -EINVAL;
+			}
+		}
+	}
+
+	sched_ctx = dev->data->dev_private;
+
+	for (i = 0; i < nb_lcores; i++)
+		sched_ctx->wc_pool[i] = lcores[i];
+	sched_ctx->nb_wc = nb_lcores;
+
+	return 0;
+}
+
+int
+rte_cryptodev_scheduler_worker_cores_get(uint8_t scheduler_id,
+		unsigned int *lcores)
+{
+	struct rte_cryptodev *dev = rte_cryptodev_pmd_get_dev(scheduler_id);
+	struct scheduler_ctx *sched_ctx;
+	uint32_t i;
+
+	if (!dev) {
+		CS_LOG_ERR("Operation not supported");
+		return -ENOTSUP;
+	}
+
+	if (dev->dev_type != RTE_CRYPTODEV_SCHEDULER_PMD) {
+		CS_LOG_ERR("Operation not supported");
+		return -ENOTSUP;
+	}
+
+	sched_ctx = dev->data->dev_private;
+
+	if (lcores)
+		for (i = 0; i < sched_ctx->nb_wc; i++)
+			lcores[i] = sched_ctx->wc_pool[i];
+
+	return (int)sched_ctx->nb_wc;
+}
+
 int
 rte_cryptodev_scheduler_option_set(uint8_t scheduler_id,
 		enum rte_cryptodev_schedule_option_type option_type,
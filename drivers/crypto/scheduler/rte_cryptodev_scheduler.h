@@ -42,8 +42,8 @@
  * The RTE Cryptodev Scheduler Device allows the aggregation of multiple (slave)
  * Cryptodevs into a single logical crypto device, and the scheduling the
  * crypto operations to the slaves based on the mode of the specified mode of
- * operation specified and supported. This implementation supports 3 modes of
- * operation: round robin, packet-size based, and fail-over.
+ * operation specified and supported. This implementation supports 4 modes of
+ * operation: round robin, packet-size based, fail-over and multi-core.
  */
 
 #include <stdint.h>
@@ -64,6 +64,8 @@ extern "C" {
 #define SCHEDULER_MODE_NAME_PKT_SIZE_DISTR	packet-size-distr
 /** Fail-over scheduling mode string */
 #define SCHEDULER_MODE_NAME_FAIL_OVER		fail-over
+/** Multi-core scheduling mode string */
+#define SCHEDULER_MODE_NAME_MULTI_CORE		multi-core
 
 /**
  * Crypto scheduler PMD operation modes
@@ -78,6 +80,8 @@ enum rte_cryptodev_scheduler_mode {
 	CDEV_SCHED_MODE_PKT_SIZE_DISTR,
 	/** Fail-over mode */
 	CDEV_SCHED_MODE_FAILOVER,
+	/** Multi-core mode */
+	CDEV_SCHED_MODE_MULTICORE,
 
 	CDEV_SCHED_MODE_COUNT /**< number of modes */
 };
@@ -267,6 +271,50 @@ rte_cryptodev_scheduler_ordering_get(uint8_t scheduler_id);
 int
 rte_cryptodev_scheduler_slaves_get(uint8_t scheduler_id, uint8_t *slaves);
 
+/**
+ * Set the worker lcores of the multi-core mode
+ *
+ * Each worker lcore is launched when the scheduler is started and drives
+ * its share of the slaves: the slaves are assigned to the workers in a
+ * round-robin fashion, so there must be at least as many slaves as
+ * workers. The lcores must be enabled slave lcores, not used by the
+ * application while the scheduler is started.
+ *
+ * @param scheduler_id
+ *   The target scheduler device ID
+ * @param lcores
+ *   Array of worker lcore IDs
+ * @param nb_lcores
+ *   Number of worker lcores, up to RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES
+ *
+ * @return
+ *   - 0 if the worker lcores are set.
+ *   - -ENOTSUP if the operation is not supported.
+ *   - -EBUSY if device is started.
+ *   - -EINVAL if an lcore is invalid or there are too many lcores.
+ */
+int
+rte_cryptodev_scheduler_worker_cores_set(uint8_t scheduler_id,
+		const unsigned int *lcores, uint32_t nb_lcores);
+
+/**
+ * Get the worker lcores of the multi-core mode
+ *
+ * @param scheduler_id
+ *   The target scheduler device ID
+ * @param lcores
+ *   If not NULL, the function will write back the worker lcore IDs to
+ *   it. This parameter will either be an array of
+ *   RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES elements or NULL.
+ *
+ * @return
+ *   - non-negative number: the number of worker lcores
+ *   - -ENOTSUP if the operation is not supported.
+ */
+int
+rte_cryptodev_scheduler_worker_cores_get(uint8_t scheduler_id,
+		unsigned int *lcores);
+
 /**
  * Set the mode specific option
  *
@@ -327,6 +375,8 @@ extern struct rte_cryptodev_scheduler *roundrobin_scheduler;
 extern struct rte_cryptodev_scheduler *pkt_size_based_distr_scheduler;
 /** Fail-over mode scheduler */
 extern struct rte_cryptodev_scheduler *failover_scheduler;
+/** Multi-core mode scheduler */
+extern struct rte_cryptodev_scheduler *multicore_scheduler;
 
 #ifdef __cplusplus
 }
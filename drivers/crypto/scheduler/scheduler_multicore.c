@@ -0,0 +1,506 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_cryptodev.h>
+#include <rte_malloc.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+
+#include "rte_cryptodev_scheduler_operations.h"
+#include "scheduler_pmd_private.h"
+
+#define MC_SCHED_BUFFER_SIZE		32
+/** set by the worker once an op is processed, when reordering is enabled */
+#define CRYPTO_OP_STATUS_BIT_COMPLETE	0x80
+
+/**
+ * Per worker lcore and per queue pair context. The rings are the only
+ * fields shared with the lcore polling the scheduler queue pair.
+ */
+struct mc_worker_qp_ctx {
+	struct rte_ring *enq_ring;	/**< queue pair -> worker */
+	struct rte_ring *deq_ring;	/**< worker -> queue pair */
+
+	struct rte_crypto_op *pending[MC_SCHED_BUFFER_SIZE];
+	uint16_t nb_pending;
+	uint16_t pending_idx;
+
+	uint32_t last_enq_slave_idx;
+	uint32_t nb_inflight_cops[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+} __rte_cache_aligned;
+
+struct mc_scheduler_qp_ctx {
+	uint32_t nb_workers;
+	uint32_t last_enq_worker_idx;
+	uint32_t last_deq_worker_idx;
+
+	struct mc_worker_qp_ctx workers[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+};
+
+struct mc_scheduler_ctx {
+	volatile uint32_t stop_signal;
+
+	/** slaves driven by each worker, as indexes of the scheduler slaves */
+	uint8_t worker_slaves[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES]
+			[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	uint32_t nb_worker_slaves[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+};
+
+static uint16_t
+schedule_enqueue(void *qp, struct rte_crypto_op **ops, uint16_t nb_ops)
+{
+	struct mc_scheduler_qp_ctx *mc_qp_ctx =
+			((struct scheduler_qp_ctx *)qp)->private_qp_ctx;
+	uint32_t worker_idx = mc_qp_ctx->last_enq_worker_idx;
+	uint16_t processed_ops = 0;
+	uint32_t i;
+
+	if (unlikely(nb_ops == 0))
+		return 0;
+
+	for (i = 0; i < mc_qp_ctx->nb_workers && processed_ops < nb_ops;
+			i++) {
+		processed_ops += rte_ring_sp_enqueue_burst(
+				mc_qp_ctx->workers[worker_idx].enq_ring,
+				(void **)&ops[processed_ops],
+				nb_ops - processed_ops, NULL);
+
+		if (++worker_idx == mc_qp_ctx->nb_workers)
+			worker_idx = 0;
+	}
+
+	mc_qp_ctx->last_enq_worker_idx = worker_idx;
+
+	return processed_ops;
+}
+
+static uint16_t
+schedule_enqueue_ordering(void *qp, struct rte_crypto_op **ops,
+		uint16_t nb_ops)
+{
+	struct rte_ring *order_ring =
+			((struct scheduler_qp_ctx *)qp)->order_ring;
+	uint16_t nb_ops_to_enq = get_max_enqueue_order_count(order_ring,
+			nb_ops);
+	uint16_t nb_ops_enqd = schedule_enqueue(qp, ops,
+			nb_ops_to_enq);
+
+	scheduler_order_insert(order_ring, ops, nb_ops_enqd);
+
+	return nb_ops_enqd;
+}
+
+static uint16_t
+schedule_dequeue(void *qp, struct rte_crypto_op **ops, uint16_t nb_ops)
+{
+	struct mc_scheduler_qp_ctx *mc_qp_ctx =
+			((struct scheduler_qp_ctx *)qp)->private_qp_ctx;
+	uint32_t worker_idx = mc_qp_ctx->last_deq_worker_idx;
+	uint16_t processed_ops = 0;
+	uint32_t i;
+
+	for (i = 0; i < mc_qp_ctx->nb_workers && processed_ops < nb_ops;
+			i++) {
+		processed_ops += rte_ring_sc_dequeue_burst(
+				mc_qp_ctx->workers[worker_idx].deq_ring,
+				(void **)&ops[processed_ops],
+				nb_ops - processed_ops, NULL);
+
+		if (++worker_idx == mc_qp_ctx->nb_workers)
+			worker_idx = 0;
+	}
+
+	mc_qp_ctx->last_deq_worker_idx = worker_idx;
+
+	return processed_ops;
+}
+
+static uint16_t
+schedule_dequeue_ordering(void *qp, struct rte_crypto_op **ops,
+		uint16_t nb_ops)
+{
+	struct rte_ring *order_ring =
+			((struct scheduler_qp_ctx *)qp)->order_ring;
+	struct rte_crypto_op *op;
+	uint32_t nb_objs = rte_ring_count(order_ring);
+	uint32_t nb_ops_to_deq = 0;
+	uint32_t nb_ops_deqd = 0;
+
+	if (nb_objs > nb_ops)
+		nb_objs = nb_ops;
+
+	/* the workers only flag the processed ops, which stay in order */
+	while (nb_ops_to_deq < nb_objs) {
+		SCHEDULER_GET_RING_OBJ(order_ring, nb_ops_to_deq, op);
+		if (!(op->status & CRYPTO_OP_STATUS_BIT_COMPLETE))
+			break;
+		nb_ops_to_deq++;
+	}
+
+	if (nb_ops_to_deq) {
+		uint32_t i;
+
+		rte_smp_rmb();
+		nb_ops_deqd = rte_ring_sc_dequeue_bulk(order_ring,
+				(void **)ops, nb_ops_to_deq, NULL);
+		for (i = 0; i < nb_ops_deqd; i++)
+			ops[i]->status &= ~CRYPTO_OP_STATUS_BIT_COMPLETE;
+	}
+
+	return nb_ops_deqd;
+}
+
+static __rte_always_inline uint16_t
+mc_slave_enqueue(struct scheduler_slave *slave, uint8_t slave_idx,
+		uint16_t qp_id, struct rte_crypto_op **ops, uint16_t nb_ops)
+{
+	struct rte_cryptodev_sym_session *sessions[MC_SCHED_BUFFER_SIZE];
+	struct scheduler_session *sess;
+	uint16_t i, processed_ops;
+
+	for (i = 0; i < nb_ops; i++) {
+		sess = (struct scheduler_session *)
+				ops[i]->sym->session->_private;
+		sessions[i] = ops[i]->sym->session;
+		ops[i]->sym->session = sess->sessions[slave_idx];
+	}
+
+	processed_ops = rte_cryptodev_enqueue_burst(slave->dev_id, qp_id,
+			ops, nb_ops);
+
+	/* recover session if enqueue is failed */
+	if (unlikely(processed_ops < nb_ops))
+		for (i = processed_ops; i < nb_ops; i++)
+			ops[i]->sym->session = sessions[i];
+
+	return processed_ops;
+}
+
+/** Move the ops of one queue pair from and to the slaves of a worker */
+static __rte_always_inline void
+mc_worker_poll(struct scheduler_ctx *sched_ctx, struct mc_worker_qp_ctx *w,
+		const uint8_t *slave_idxs, uint32_t nb_slaves, uint16_t qp_id,
+		uint8_t reordering_enabled)
+{
+	struct rte_crypto_op *ops[MC_SCHED_BUFFER_SIZE];
+	uint16_t nb_ops, i;
+	uint32_t j, idx;
+
+	if (w->nb_pending == 0) {
+		w->nb_pending = rte_ring_sc_dequeue_burst(w->enq_ring,
+				(void **)w->pending, MC_SCHED_BUFFER_SIZE, NULL);
+		w->pending_idx = 0;
+	}
+
+	if (w->nb_pending) {
+		idx = slave_idxs[w->last_enq_slave_idx];
+		nb_ops = mc_slave_enqueue(&sched_ctx->slaves[idx], idx, qp_id,
+				&w->pending[w->pending_idx], w->nb_pending);
+		w->nb_inflight_cops[w->last_enq_slave_idx] += nb_ops;
+		w->pending_idx += nb_ops;
+		w->nb_pending -= nb_ops;
+
+		if (++w->last_enq_slave_idx == nb_slaves)
+			w->last_enq_slave_idx = 0;
+	}
+
+	for (j = 0; j < nb_slaves; j++) {
+		if (w->nb_inflight_cops[j] == 0)
+			continue;
+
+		idx = slave_idxs[j];
+		if (reordering_enabled) {
+			nb_ops = rte_cryptodev_dequeue_burst(
+					sched_ctx->slaves[idx].dev_id, qp_id,
+					ops, MC_SCHED_BUFFER_SIZE);
+			/* publish the results before the completion bits */
+			rte_smp_wmb();
+			for (i = 0; i < nb_ops; i++)
+				ops[i]->status |=
+					CRYPTO_OP_STATUS_BIT_COMPLETE;
+		} else {
+			/* never dequeue more than the ring can take */
+			nb_ops = RTE_MIN(rte_ring_free_count(w->deq_ring),
+					(unsigned int)MC_SCHED_BUFFER_SIZE);
+			nb_ops = rte_cryptodev_dequeue_burst(
+					sched_ctx->slaves[idx].dev_id, qp_id,
+					ops, nb_ops);
+			rte_ring_sp_enqueue_burst(w->deq_ring, (void **)ops,
+					nb_ops, NULL);
+		}
+
+		w->nb_inflight_cops[j] -= nb_ops;
+	}
+}
+
+static int
+mc_scheduler_worker(void *arg)
+{
+	struct rte_cryptodev *dev = arg;
+	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
+	struct mc_scheduler_ctx *mc_ctx = sched_ctx->private_ctx;
+	uint16_t nb_qps = dev->data->nb_queue_pairs;
+	uint8_t reordering_enabled = sched_ctx->reordering_enabled;
+	unsigned int lcore_id = rte_lcore_id();
+	uint32_t worker_idx;
+	uint16_t q;
+
+	for (worker_idx = 0; worker_idx < sched_ctx->nb_wc; worker_idx++)
+		if (sched_ctx->wc_pool[worker_idx] == lcore_id)
+			break;
+
+	if (worker_idx == sched_ctx->nb_wc) {
+		CS_LOG_ERR("lcore %u is not a worker", lcore_id);
+		return -1;
+	}
+
+	while (!mc_ctx->stop_signal) {
+		for (q = 0; q < nb_qps; q++) {
+			struct scheduler_qp_ctx *qp_ctx =
+					dev->data->queue_pairs[q];
+			struct mc_scheduler_qp_ctx *mc_qp_ctx =
+					qp_ctx->private_qp_ctx;
+
+			mc_worker_poll(sched_ctx,
+					&mc_qp_ctx->workers[worker_idx],
+					mc_ctx->worker_slaves[worker_idx],
+					mc_ctx->nb_worker_slaves[worker_idx],
+					q, reordering_enabled);
+		}
+	}
+
+	return 0;
+}
+
+static int
+slave_attach(__rte_unused struct rte_cryptodev *dev,
+		__rte_unused uint8_t slave_id)
+{
+	return 0;
+}
+
+static int
+slave_detach(__rte_unused struct rte_cryptodev *dev,
+		__rte_unused uint8_t slave_id)
+{
+	return 0;
+}
+
+static void
+mc_free_rings(struct rte_cryptodev *dev)
+{
+	uint16_t i;
+	uint32_t j;
+
+	for (i = 0; i < dev->data->nb_queue_pairs; i++) {
+		struct scheduler_qp_ctx *qp_ctx = dev->data->queue_pairs[i];
+		struct mc_scheduler_qp_ctx *mc_qp_ctx =
+				qp_ctx->private_qp_ctx;
+
+		if (!mc_qp_ctx)
+			continue;
+
+		for (j = 0; j < RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES; j++) {
+			struct mc_worker_qp_ctx *w = &mc_qp_ctx->workers[j];
+
+			rte_ring_free(w->enq_ring);
+			rte_ring_free(w->deq_ring);
+			w->enq_ring = NULL;
+			w->deq_ring = NULL;
+		}
+		mc_qp_ctx->nb_workers = 0;
+	}
+}
+
+static struct rte_ring *
+mc_create_ring(struct rte_cryptodev *dev, uint16_t qp_id, uint32_t worker_idx,
+		const char *dir, uint32_t size)
+{
+	char name[RTE_RING_NAMESIZE];
+
+	if (snprintf(name, sizeof(name), "MCS_%u_%u_%u_%s",
+			dev->data->dev_id, qp_id, worker_idx, dir) < 0)
+		return NULL;
+
+	return rte_ring_create(name, size, rte_socket_id(),
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+}
+
+static int
+scheduler_start(struct rte_cryptodev *dev)
+{
+	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
+	struct mc_scheduler_ctx *mc_ctx = sched_ctx->private_ctx;
+	uint32_t i, j;
+	uint16_t q;
+
+	if (sched_ctx->nb_wc == 0) {
+		CS_LOG_ERR("No worker lcore set");
+		return -EINVAL;
+	}
+
+	if (sched_ctx->nb_wc > sched_ctx->nb_slaves) {
+		CS_LOG_ERR("%u worker lcores for only %u slaves",
+				sched_ctx->nb_wc, sched_ctx->nb_slaves);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < sched_ctx->nb_wc; i++) {
+		if (rte_eal_get_lcore_state(sched_ctx->wc_pool[i]) != WAIT) {
+			CS_LOG_ERR("Worker lcore %u is busy",
+					sched_ctx->wc_pool[i]);
+			return -EBUSY;
+		}
+	}
+
+	if (sched_ctx->reordering_enabled) {
+		dev->enqueue_burst = &schedule_enqueue_ordering;
+		dev->dequeue_burst = &schedule_dequeue_ordering;
+	} else {
+		dev->enqueue_burst = &schedule_enqueue;
+		dev->dequeue_burst = &schedule_dequeue;
+	}
+
+	/* the slaves are shared out among the workers */
+	memset(mc_ctx->nb_worker_slaves, 0, sizeof(mc_ctx->nb_worker_slaves));
+	for (j = 0; j < sched_ctx->nb_slaves; j++) {
+		i = j % sched_ctx->nb_wc;
+		mc_ctx->worker_slaves[i][mc_ctx->nb_worker_slaves[i]++] = j;
+	}
+
+	for (q = 0; q < dev->data->nb_queue_pairs; q++) {
+		struct scheduler_qp_ctx *qp_ctx = dev->data->queue_pairs[q];
+		struct mc_scheduler_qp_ctx *mc_qp_ctx =
+				qp_ctx->private_qp_ctx;
+		uint32_t ring_size = rte_align32pow2(qp_ctx->max_nb_objs + 1);
+
+		memset(mc_qp_ctx, 0, sizeof(*mc_qp_ctx));
+		mc_qp_ctx->nb_workers = sched_ctx->nb_wc;
+
+		for (i = 0; i < sched_ctx->nb_wc; i++) {
+			struct mc_worker_qp_ctx *w = &mc_qp_ctx->workers[i];
+
+			w->enq_ring = mc_create_ring(dev, q, i, "E",
+					ring_size);
+			w->deq_ring = mc_create_ring(dev, q, i, "D",
+					ring_size);
+			if (!w->enq_ring || !w->deq_ring) {
+				CS_LOG_ERR("failed to create worker rings");
+				mc_free_rings(dev);
+				return -ENOMEM;
+			}
+		}
+	}
+
+	mc_ctx->stop_signal = 0;
+	rte_smp_wmb();
+
+	for (i = 0; i < sched_ctx->nb_wc; i++)
+		rte_eal_remote_launch(mc_scheduler_worker, dev,
+				sched_ctx->wc_pool[i]);
+
+	return 0;
+}
+
+static int
+scheduler_stop(struct rte_cryptodev *dev)
+{
+	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
+	struct mc_scheduler_ctx *mc_ctx = sched_ctx->private_ctx;
+	uint32_t i;
+
+	mc_ctx->stop_signal = 1;
+
+	for (i = 0; i < sched_ctx->nb_wc; i++)
+		rte_eal_wait_lcore(sched_ctx->wc_pool[i]);
+
+	mc_free_rings(dev);
+
+	return 0;
+}
+
+static int
+scheduler_config_qp(struct rte_cryptodev *dev, uint16_t qp_id)
+{
+	struct scheduler_qp_ctx *qp_ctx = dev->data->queue_pairs[qp_id];
+	struct mc_scheduler_qp_ctx *mc_qp_ctx;
+
+	mc_qp_ctx = rte_zmalloc_socket(NULL, sizeof(*mc_qp_ctx),
+			RTE_CACHE_LINE_SIZE, rte_socket_id());
+	if (!mc_qp_ctx) {
+		CS_LOG_ERR("failed allocate memory for private queue pair");
+		return -ENOMEM;
+	}
+
+	qp_ctx->private_qp_ctx = (void *)mc_qp_ctx;
+
+	return 0;
+}
+
+static int
+scheduler_create_private_ctx(struct rte_cryptodev *dev)
+{
+	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
+	struct mc_scheduler_ctx *mc_ctx;
+
+	mc_ctx = rte_zmalloc_socket(NULL, sizeof(*mc_ctx), 0,
+			rte_socket_id());
+	if (!mc_ctx) {
+		CS_LOG_ERR("failed allocate memory");
+		return -ENOMEM;
+	}
+
+	sched_ctx->private_ctx = (void *)mc_ctx;
+
+	return 0;
+}
+
+struct rte_cryptodev_scheduler_ops scheduler_mc_ops = {
+	slave_attach,
+	slave_detach,
+	scheduler_start,
+	scheduler_stop,
+	scheduler_config_qp,
+	scheduler_create_private_ctx,
+	NULL,	/* option_set */
+	NULL	/* option_get */
+};
+
+struct rte_cryptodev_scheduler mc_scheduler = {
+		.name = "multicore-scheduler",
+		.description = "scheduler which will run burst across "
+				"multiple cpu cores",
+		.mode = CDEV_SCHED_MODE_MULTICORE,
+		.ops = &scheduler_mc_ops
+};
+
+struct rte_cryptodev_scheduler *multicore_scheduler = &mc_scheduler;
@@ -48,12 +48,15 @@ struct scheduler_init_params {
 	uint32_t enable_ordering;
 	char slave_names[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES]
 			[RTE_CRYPTODEV_SCHEDULER_NAME_MAX_LEN];
+	unsigned int wc_pool[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	uint32_t nb_wc;
 };
 
 #define RTE_CRYPTODEV_VDEV_NAME			("name")
 #define RTE_CRYPTODEV_VDEV_SLAVE		("slave")
 #define RTE_CRYPTODEV_VDEV_MODE			("mode")
 #define RTE_CRYPTODEV_VDEV_ORDERING		("ordering")
+#define RTE_CRYPTODEV_VDEV_CORELIST		("corelist")
 #define RTE_CRYPTODEV_VDEV_MAX_NB_QP_ARG	("max_nb_queue_pairs")
 #define RTE_CRYPTODEV_VDEV_MAX_NB_SESS_ARG	("max_nb_sessions")
 #define RTE_CRYPTODEV_VDEV_SOCKET_ID		("socket_id")
@@ -63,6 +66,7 @@ const char *scheduler_valid_params[] = {
 	RTE_CRYPTODEV_VDEV_SLAVE,
 	RTE_CRYPTODEV_VDEV_MODE,
 	RTE_CRYPTODEV_VDEV_ORDERING,
+	RTE_CRYPTODEV_VDEV_CORELIST,
 	RTE_CRYPTODEV_VDEV_MAX_NB_QP_ARG,
 	RTE_CRYPTODEV_VDEV_MAX_NB_SESS_ARG,
 	RTE_CRYPTODEV_VDEV_SOCKET_ID
@@ -79,7 +83,9 @@ const struct scheduler_parse_map scheduler_mode_map[] = {
 	{RTE_STR(SCHEDULER_MODE_NAME_PKT_SIZE_DISTR),
 			CDEV_SCHED_MODE_PKT_SIZE_DISTR},
 	{RTE_STR(SCHEDULER_MODE_NAME_FAIL_OVER),
-			CDEV_SCHED_MODE_FAILOVER}
+			CDEV_SCHED_MODE_FAILOVER},
+	{RTE_STR(SCHEDULER_MODE_NAME_MULTI_CORE),
+			CDEV_SCHED_MODE_MULTICORE}
 };
 
 const struct scheduler_parse_map scheduler_ordering_map[] = {
@@ -136,6 +142,19 @@ cryptodev_scheduler_create(const char *name,
 		}
 	}
 
+	if (init_params->nb_wc) {
+		ret = rte_cryptodev_scheduler_worker_cores_set(
+				dev->data->dev_id, init_params->wc_pool,
+				init_params->nb_wc);
+		if (ret < 0) {
+			rte_cryptodev_pmd_release_device(dev);
+			return ret;
+		}
+
+		RTE_LOG(INFO, PMD, "  Number of worker lcores = %u\n",
+				init_params->nb_wc);
+	}
+
 	sched_ctx->reordering_enabled = init_params->enable_ordering;
 
 	for (i = 0; i < RTE_DIM(scheduler_ordering_map); i++) {
@@ -311,6 +330,38 @@ parse_mode_arg(const char *key __rte_unused,
 	return 0;
 }
 
+/** Parse worker lcores, separated by ':' as ',' separates the arguments */
+static int
+parse_corelist_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	struct scheduler_init_params *params = extra_args;
+	char *end;
+
+	params->nb_wc = 0;
+
+	while (*value != '\0') {
+		unsigned long lcore = strtoul(value, &end, 10);
+
+		if (end == value || lcore >= RTE_MAX_LCORE ||
+				(*end != '\0' && *end != ':')) {
+			CS_LOG_ERR("Invalid worker lcore list.\n");
+			return -EINVAL;
+		}
+
+		if (params->nb_wc >= RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES) {
+			CS_LOG_ERR("Too many worker lcores.\n");
+			return -ENOMEM;
+		}
+
+		params->wc_pool[params->nb_wc++] = (unsigned int)lcore;
+
+		value = (*end == ':') ? end + 1 : end;
+	}
+
+	return 0;
+}
+
 static int
 parse_ordering_arg(const char *key __rte_unused,
 		const char *value, void *extra_args)
@@ -391,6 +442,11 @@ scheduler_parse_init_params(struct scheduler_init_params *params,
 		if (ret < 0)
 			goto free_kvlist;
 
+		ret = rte_kvargs_process(kvlist, RTE_CRYPTODEV_VDEV_CORELIST,
+				&parse_corelist_arg, params);
+		if (ret < 0)
+			goto free_kvlist;
+
 		if (params->def_p.socket_id >= number_of_sockets()) {
 			CDEV_LOG_ERR("Invalid socket id specified to create "
 				"the virtual crypto device on");
@@ -416,7 +472,8 @@ cryptodev_scheduler_probe(struct rte_vdev_device *vdev)
 		.nb_slaves = 0,
 		.mode = CDEV_SCHED_MODE_NOT_SET,
 		.enable_ordering = 0,
-		.slave_names = { {0} }
+		.slave_names = { {0} },
+		.nb_wc = 0
 	};
 	const char *name;
 
@@ -453,4 +510,7 @@ RTE_PMD_REGISTER_PARAM_STRING(CRYPTODEV_NAME_SCHEDULER_PMD,
 	"max_nb_queue_pairs=<int> "
 	"max_nb_sessions=<int> "
 	"socket_id=<int> "
-	"slave=<name>");
+	"slave=<name> "
+	"mode=<name> "
+	"ordering=enable|disable "
+	"corelist=<lcore:lcore:...>");
@@ -157,7 +157,7 @@ static int
 scheduler_pmd_start(struct rte_cryptodev *dev)
 {
 	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
-	uint32_t i;
+	uint32_t i, nb_attached = 0, nb_started = 0;
 	int ret;
 
 	if (dev->data->dev_started)
@@ -189,24 +189,20 @@ scheduler_pmd_start(struct rte_cryptodev *dev)
 	}
 
 	RTE_FUNC_PTR_OR_ERR_RET(*sched_ctx->ops.slave_attach, -ENOTSUP);
+	RTE_FUNC_PTR_OR_ERR_RET(*sched_ctx->ops.scheduler_start, -ENOTSUP);
 
 	for (i = 0; i < sched_ctx->nb_slaves; i++) {
 		uint8_t slave_dev_id = sched_ctx->slaves[i].dev_id;
 
 		if ((*sched_ctx->ops.slave_attach)(dev, slave_dev_id) < 0) {
 			CS_LOG_ERR("Failed to attach slave");
-			return -ENOTSUP;
+			ret = -ENOTSUP;
+			goto error;
 		}
+		nb_attached++;
 	}
 
-	RTE_FUNC_PTR_OR_ERR_RET(*sched_ctx->ops.scheduler_start, -ENOTSUP);
-
-	if ((*sched_ctx->ops.scheduler_start)(dev) < 0) {
-		CS_LOG_ERR("Scheduler start failed");
-		return -1;
-	}
-
-	/* start all slaves */
+	/* start all slaves, before the scheduler may use them */
 	for (i = 0; i < sched_ctx->nb_slaves; i++) {
 		uint8_t slave_dev_id = sched_ctx->slaves[i].dev_id;
 		struct rte_cryptodev *slave_dev =
@@ -216,11 +212,37 @@ scheduler_pmd_start(struct rte_cryptodev *dev)
 		if (ret < 0) {
 			CS_LOG_ERR("Failed to start slave dev %u",
 					slave_dev_id);
-			return ret;
+			goto error;
 		}
+		nb_started++;
+	}
+
+	ret = (*sched_ctx->ops.scheduler_start)(dev);
+	if (ret < 0) {
+		CS_LOG_ERR("Scheduler start failed");
+		goto error;
 	}
 
 	return 0;
+
+error:
+	/* leave the slaves as they were before the start */
+	for (i = 0; i < nb_started; i++) {
+		uint8_t slave_dev_id = sched_ctx->slaves[i].dev_id;
+		struct rte_cryptodev *slave_dev =
+				rte_cryptodev_pmd_get_dev(slave_dev_id);
+
+		(*slave_dev->dev_ops->dev_stop)(slave_dev);
+	}
+
+	for (i = 0; i < nb_attached; i++) {
+		uint8_t slave_dev_id = sched_ctx->slaves[i].dev_id;
+
+		if (*sched_ctx->ops.slave_detach)
+			(*sched_ctx->ops.slave_detach)(dev, slave_dev_id);
+	}
+
+	return ret;
 }
 
 /** Stop device */
@@ -230,10 +252,10 @@ scheduler_pmd_stop(struct rte_cryptodev *dev)
 	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
 	uint32_t i;
 
-	if (!dev->data->dev_started)
-		return;
+	/* stop the scheduler first, it may still use the slaves */
+	if (*sched_ctx->ops.scheduler_stop)
+		(*sched_ctx->ops.scheduler_stop)(dev);
 
-	/* stop all slaves first */
 	for (i = 0; i < sched_ctx->nb_slaves; i++) {
 		uint8_t slave_dev_id = sched_ctx->slaves[i].dev_id;
 		struct rte_cryptodev *slave_dev =
@@ -242,9 +264,6 @@ scheduler_pmd_stop(struct rte_cryptodev *dev)
 		(*slave_dev->dev_ops->dev_stop)(slave_dev);
 	}
 
-	if (*sched_ctx->ops.scheduler_stop)
-		(*sched_ctx->ops.scheduler_stop)(dev);
-
 	for (i = 0; i < sched_ctx->nb_slaves; i++) {
 		uint8_t slave_dev_id = sched_ctx->slaves[i].dev_id;
 
@@ -89,6 +89,10 @@ struct scheduler_ctx {
 
 	char *init_slave_names[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
 	int nb_init_slaves;
+
+	unsigned int wc_pool[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	/**< worker lcores of the multi-core mode */
+	uint32_t nb_wc;
 } __rte_cache_aligned;
 
 struct scheduler_qp_ctx {
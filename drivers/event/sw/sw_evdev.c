@@ -37,6 +37,7 @@
 #include <rte_kvargs.h>
 #include <rte_ring.h>
 #include <rte_errno.h>
+#include <rte_service_component.h>
 
 #include "sw_evdev.h"
 #include "iq_ring.h"
@@ -630,6 +631,9 @@ sw_start(struct rte_eventdev *dev)
 	rte_smp_wmb();
 	sw->started = 1;
 
+	/* the service core can run the scheduler from now on */
+	rte_service_component_runstate_set(sw->service_id, 1);
+
 	return 0;
 }
 
@@ -637,6 +641,10 @@ static void
 sw_stop(struct rte_eventdev *dev)
 {
 	struct sw_evdev *sw = sw_pmd_priv(dev);
+
+	/* returns once the service core no longer runs the scheduler */
+	rte_service_component_runstate_set(sw->service_id, 0);
+
 	sw_xstats_uninit(sw);
 	sw->started = 0;
 	rte_smp_wmb();
@@ -695,6 +703,14 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int32_t
+sw_sched_service_func(void *args)
+{
+	struct rte_eventdev *dev = args;
+	sw_event_schedule(dev);
+	return 0;
+}
+
 static int
 sw_probe(struct rte_vdev_device *vdev)
 {
@@ -731,6 +747,7 @@ sw_probe(struct rte_vdev_device *vdev)
 	const char *params;
 	struct rte_eventdev *dev;
 	struct sw_evdev *sw;
+	struct rte_service_spec service;
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
@@ -806,6 +823,25 @@ sw_probe(struct rte_vdev_device *vdev)
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
 
+	/* register the scheduler to be run by a service core */
+	memset(&service, 0, sizeof(service));
+	snprintf(sw->service_name, sizeof(sw->service_name), "%s_service",
+		name);
+	snprintf(service.name, sizeof(service.name), "%s", sw->service_name);
+	service.socket_id = socket_id;
+	service.callback = sw_sched_service_func;
+	service.callback_userdata = (void *)dev;
+
+	if (rte_service_component_register(&service, &sw->service_id) < 0) {
+		SW_LOG_ERR("%s: Error registering service %s\n", name,
+			sw->service_name);
+		rte_event_pmd_vdev_uninit(name);
+		return -ENOEXEC;
+	}
+
+	/* the scheduler is not run until the device is started */
+	rte_service_component_runstate_set(sw->service_id, 0);
+
 	return 0;
 }
 
@@ -813,6 +849,7 @@ static int
 sw_remove(struct rte_vdev_device *vdev)
 {
 	const char *name;
+	struct rte_eventdev *dev;
 
 	name = rte_vdev_device_name(vdev);
 	if (name == NULL)
@@ -820,6 +857,10 @@ sw_remove(struct rte_vdev_device *vdev)
 
 	SW_LOG_INFO("Closing eventdev sw device %s\n", name);
 
+	dev = rte_event_pmd_get_named_dev(name);
+	if (dev != NULL && rte_eal_process_type() == RTE_PROC_PRIMARY)
+		rte_service_component_unregister(sw_pmd_priv(dev)->service_id);
+
 	return rte_event_pmd_vdev_uninit(name);
 }
 
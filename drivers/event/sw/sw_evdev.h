@@ -36,6 +36,7 @@
 #include <rte_eventdev.h>
 #include <rte_eventdev_pmd.h>
 #include <rte_atomic.h>
+#include <rte_service.h>
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
@@ -269,6 +270,10 @@ struct sw_evdev {
 	uint8_t started;
 	uint32_t credit_update_quanta;
 
+	/* service running the scheduler on a service core */
+	uint32_t service_id;
+	char service_name[RTE_SERVICE_NAME_MAX];
+
 	/* store num stats and offset of the stats for each port */
 	uint16_t xstats_count_per_port[SW_PORTS_MAX];
 	uint16_t xstats_offset_for_port[SW_PORTS_MAX];
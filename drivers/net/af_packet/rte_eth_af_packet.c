@@ -53,16 +53,22 @@
 #include <sys/mman.h>
 #include <unistd.h>
 #include <poll.h>
+#include <errno.h>
 
 #define ETH_AF_PACKET_IFACE_ARG		"iface"
 #define ETH_AF_PACKET_NUM_Q_ARG		"qpairs"
 #define ETH_AF_PACKET_BLOCKSIZE_ARG	"blocksz"
 #define ETH_AF_PACKET_FRAMESIZE_ARG	"framesz"
 #define ETH_AF_PACKET_FRAMECOUNT_ARG	"framecnt"
+#define ETH_AF_PACKET_TPACKETV3_ARG	"tpacketv3"
+#define ETH_AF_PACKET_BLOCKTMO_ARG	"blocktmo"
+#define ETH_AF_PACKET_ZEROCOPY_ARG	"zerocopy"
 
 #define DFLT_BLOCK_SIZE		(1 << 12)
 #define DFLT_FRAME_SIZE		(1 << 11)
 #define DFLT_FRAME_COUNT	(1 << 9)
+/* let the kernel pick the block retire timeout */
+#define DFLT_BLOCK_TMO		0
 
 #define RTE_PMD_AF_PACKET_MAX_RINGS 16
 
@@ -74,6 +80,15 @@ struct pkt_rx_queue {
 	unsigned int framecount;
 	unsigned int framenum;
 
+	/* TPACKET_V3: rd, framecount and framenum describe blocks */
+	struct tpacket3_hdr *ppd;	/* next frame of the current block */
+	unsigned int pkts_left;		/* frames left in the current block */
+	unsigned int buf_size;		/* mbuf data room, when copying */
+	/* zero copy: blocks are released when their last mbuf is freed */
+	int zerocopy;
+	struct rte_mbuf_ext_shared_info *shinfo;	/* one per block */
+	uint64_t *block_seq;	/* sequence number of the block last read */
+
 	struct rte_mempool *mb_pool;
 	uint8_t in_port;
 
@@ -104,6 +119,7 @@ struct pmd_internals {
 	struct ether_addr eth_addr;
 
 	struct tpacket_req req;
+	int tpacket_v3;
 
 	struct pkt_rx_queue rx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
 	struct pkt_tx_queue tx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
@@ -115,6 +131,9 @@ static const char *valid_arguments[] = {
 	ETH_AF_PACKET_BLOCKSIZE_ARG,
 	ETH_AF_PACKET_FRAMESIZE_ARG,
 	ETH_AF_PACKET_FRAMECOUNT_ARG,
+	ETH_AF_PACKET_TPACKETV3_ARG,
+	ETH_AF_PACKET_BLOCKTMO_ARG,
+	ETH_AF_PACKET_ZEROCOPY_ARG,
 	NULL
 };
 
@@ -185,6 +204,164 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_rx;
 }
 
+/*
+ * Hand a TPACKET_V3 block back to the kernel, once all of its frames
+ * have been read.
+ */
+static inline void
+af_packet_block_release(struct tpacket_block_desc *pbd)
+{
+	/* frames must have been read before the kernel reuses the block */
+	rte_smp_mb();
+	pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+}
+
+/* free callback of the external buffers pointing into a block */
+static void
+af_packet_block_free_cb(void *addr __rte_unused, void *opaque)
+{
+	af_packet_block_release(opaque);
+}
+
+/*
+ * Number of Rx blocks of a queue still referenced by zero copy mbufs. The
+ * frames of the block being read that are not received yet hold a
+ * reference but no mbuf, so they are not counted.
+ */
+static unsigned int
+af_packet_blocks_held(const struct pkt_rx_queue *pkt_q)
+{
+	unsigned int i, held = 0;
+	uint16_t refcnt;
+
+	if (!pkt_q->zerocopy || pkt_q->shinfo == NULL)
+		return 0;
+
+	for (i = 0; i < pkt_q->framecount; i++) {
+		refcnt = rte_mbuf_ext_refcnt_read(&pkt_q->shinfo[i]);
+		if (i == pkt_q->framenum)
+			refcnt -= pkt_q->pkts_left;
+		if (refcnt != 0)
+			held++;
+	}
+
+	return held;
+}
+
+/*
+ * TPACKET_V3 receive: the kernel fills whole blocks of variable-sized
+ * frames and retires them when they are full or when the block timeout
+ * expires, so the status is checked and the block released once per block
+ * rather than once per frame.
+ */
+static uint16_t
+eth_af_packet_rx_v3(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pkt_rx_queue *pkt_q = queue;
+	struct tpacket_block_desc *pbd;
+	struct tpacket3_hdr *ppd;
+	struct rte_mbuf *mbuf;
+	uint16_t num_rx = 0;
+	unsigned long num_rx_bytes = 0;
+	unsigned int blocknum = pkt_q->framenum;
+
+	pbd = (struct tpacket_block_desc *)pkt_q->rd[blocknum].iov_base;
+	while (num_rx < nb_pkts) {
+		/* open the next block */
+		if (pkt_q->pkts_left == 0) {
+			if ((pbd->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+				break;
+			/* in zero copy, the block may still be held by mbufs */
+			if (pkt_q->zerocopy) {
+				if (pbd->hdr.bh1.seq_num ==
+						pkt_q->block_seq[blocknum])
+					break;
+				pkt_q->block_seq[blocknum] =
+					pbd->hdr.bh1.seq_num;
+			}
+			rte_smp_rmb();
+
+			pkt_q->pkts_left = pbd->hdr.bh1.num_pkts;
+			pkt_q->ppd = (struct tpacket3_hdr *)((uint8_t *)pbd +
+					pbd->hdr.bh1.offset_to_first_pkt);
+			if (pkt_q->zerocopy)
+				rte_mbuf_ext_refcnt_set(
+					&pkt_q->shinfo[blocknum],
+					pkt_q->pkts_left);
+		}
+
+		if (pkt_q->pkts_left != 0) {
+			ppd = pkt_q->ppd;
+
+			mbuf = rte_pktmbuf_alloc(pkt_q->mb_pool);
+			if (unlikely(mbuf == NULL))
+				break;
+
+			if (pkt_q->zerocopy && unlikely(ppd->tp_mac +
+					ppd->tp_snaplen > UINT16_MAX)) {
+				rte_pktmbuf_free(mbuf);
+				mbuf = NULL;
+				pkt_q->err_pkts++;
+				if (rte_mbuf_ext_refcnt_update(
+					    &pkt_q->shinfo[blocknum], -1) == 0)
+					af_packet_block_release(pbd);
+			} else if (pkt_q->zerocopy) {
+				/* the frame header is reused as headroom */
+				rte_pktmbuf_attach_extbuf(mbuf, ppd, 0,
+					ppd->tp_mac + ppd->tp_snaplen,
+					&pkt_q->shinfo[blocknum]);
+				mbuf->data_off = ppd->tp_mac;
+				rte_pktmbuf_pkt_len(mbuf) =
+					rte_pktmbuf_data_len(mbuf) =
+					ppd->tp_snaplen;
+			} else if (unlikely(ppd->tp_snaplen >
+					    pkt_q->buf_size)) {
+				rte_pktmbuf_free(mbuf);
+				mbuf = NULL;
+				pkt_q->err_pkts++;
+			} else {
+				rte_pktmbuf_pkt_len(mbuf) =
+					rte_pktmbuf_data_len(mbuf) =
+					ppd->tp_snaplen;
+				memcpy(rte_pktmbuf_mtod(mbuf, void *),
+				       (uint8_t *)ppd + ppd->tp_mac,
+				       ppd->tp_snaplen);
+			}
+
+			if (mbuf != NULL) {
+				/* check for vlan info */
+				if (ppd->tp_status & TP_STATUS_VLAN_VALID) {
+					mbuf->vlan_tci = ppd->hv1.tp_vlan_tci;
+					mbuf->ol_flags |= (PKT_RX_VLAN_PKT |
+						PKT_RX_VLAN_STRIPPED);
+				}
+				mbuf->port = pkt_q->in_port;
+
+				bufs[num_rx++] = mbuf;
+				num_rx_bytes += mbuf->pkt_len;
+			}
+
+			pkt_q->ppd = (struct tpacket3_hdr *)((uint8_t *)ppd +
+					ppd->tp_next_offset);
+			pkt_q->pkts_left--;
+			if (pkt_q->pkts_left != 0)
+				continue;
+		}
+
+		/* the whole block has been read, move to the next one */
+		if (!pkt_q->zerocopy || pbd->hdr.bh1.num_pkts == 0)
+			af_packet_block_release(pbd);
+		if (++blocknum >= pkt_q->framecount)
+			blocknum = 0;
+		pbd = (struct tpacket_block_desc *)pkt_q->rd[blocknum].iov_base;
+	}
+
+	pkt_q->framenum = blocknum;
+	pkt_q->rx_pkts += num_rx;
+	pkt_q->rx_bytes += num_rx_bytes;
+	return num_rx;
+}
+
 /*
  * Callback to handle sending packets through a real NIC.
  */
@@ -410,7 +587,13 @@ eth_rx_queue_setup(struct rte_eth_dev *dev,
 	data_size = internals->req.tp_frame_size;
 	data_size -= TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
 
-	if (data_size > buf_size) {
+	/*
+	 * TPACKET_V3 frames are not bounded by the frame size: oversized
+	 * ones are dropped when copying, and never copied in zero copy.
+	 */
+	if (internals->tpacket_v3) {
+		pkt_q->buf_size = buf_size;
+	} else if (data_size > buf_size) {
 		RTE_LOG(ERR, PMD,
 			"%s: %d bytes will not fit in mbuf (%d bytes)\n",
 			dev->data->name, data_size, buf_size);
@@ -542,6 +725,112 @@ open_packet_iface(const char *key __rte_unused,
 
 static struct rte_vdev_driver pmd_af_packet_drv;
 
+/*
+ * Sets the options of an AF_PACKET socket used for transmitting
+ */
+static int
+set_tx_options(int sockfd, const char *name, const char *ifname)
+{
+	int discard, rc;
+#if defined(PACKET_QDISC_BYPASS)
+	int bypass;
+#endif
+
+	discard = 1;
+	rc = setsockopt(sockfd, SOL_PACKET, PACKET_LOSS,
+			&discard, sizeof(discard));
+	if (rc == -1) {
+		RTE_LOG(ERR, PMD,
+			"%s: could not set PACKET_LOSS on "
+		        "AF_PACKET socket for %s\n", name, ifname);
+		return -1;
+	}
+
+#if defined(PACKET_QDISC_BYPASS)
+	bypass = 1;
+	rc = setsockopt(sockfd, SOL_PACKET, PACKET_QDISC_BYPASS,
+			&bypass, sizeof(bypass));
+	if (rc == -1) {
+		RTE_LOG(ERR, PMD,
+			"%s: could not set PACKET_QDISC_BYPASS "
+		        "on AF_PACKET socket for %s\n", name,
+		        ifname);
+		return -1;
+	}
+#endif
+
+	return 0;
+}
+
+/*
+ * Opens the transmit socket of a queue whose receive ring is in TPACKET_V3
+ * mode: Tx keeps a TPACKET_V2 frame ring, on a socket which does not
+ * receive anything.
+ */
+static int
+open_tx_socket(const char *name, const char *ifname, struct tpacket_req *req,
+	       const struct sockaddr_ll *rx_sockaddr, uint8_t **map)
+{
+	struct sockaddr_ll sockaddr = *rx_sockaddr;
+	int sockfd, tpver, rc;
+
+	sockfd = socket(AF_PACKET, SOCK_RAW, 0);
+	if (sockfd == -1) {
+		RTE_LOG(ERR, PMD,
+		        "%s: could not open AF_PACKET Tx socket\n", name);
+		return -1;
+	}
+
+	tpver = TPACKET_V2;
+	rc = setsockopt(sockfd, SOL_PACKET, PACKET_VERSION,
+			&tpver, sizeof(tpver));
+	if (rc == -1) {
+		RTE_LOG(ERR, PMD,
+			"%s: could not set PACKET_VERSION on AF_PACKET "
+			"Tx socket for %s\n", name, ifname);
+		goto error;
+	}
+
+	if (set_tx_options(sockfd, name, ifname) < 0)
+		goto error;
+
+	rc = setsockopt(sockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
+	if (rc == -1) {
+		RTE_LOG(ERR, PMD,
+			"%s: could not set PACKET_TX_RING on AF_PACKET "
+			"socket for %s\n", name, ifname);
+		goto error;
+	}
+
+	*map = mmap(NULL, req->tp_block_size * req->tp_block_nr,
+		    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
+		    sockfd, 0);
+	if (*map == MAP_FAILED) {
+		RTE_LOG(ERR, PMD,
+			"%s: call to mmap failed on AF_PACKET Tx socket for %s\n",
+			name, ifname);
+		goto error;
+	}
+
+	/* no protocol: only the interface is bound */
+	sockaddr.sll_protocol = 0;
+	rc = bind(sockfd, (const struct sockaddr *)&sockaddr, sizeof(sockaddr));
+	if (rc == -1) {
+		RTE_LOG(ERR, PMD,
+			"%s: could not bind AF_PACKET Tx socket to %s\n",
+		        name, ifname);
+		munmap(*map, req->tp_block_size * req->tp_block_nr);
+		*map = MAP_FAILED;
+		goto error;
+	}
+
+	return sockfd;
+
+error:
+	close(sockfd);
+	return -1;
+}
+
 static int
 rte_pmd_init_internals(struct rte_vdev_device *dev,
                        const int sockfd,
@@ -550,6 +839,9 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
                        unsigned int blockcnt,
                        unsigned int framesize,
                        unsigned int framecnt,
+                       int tpacket_v3,
+                       unsigned int blocktmo,
+                       int zerocopy,
                        struct pmd_internals **internals,
                        struct rte_eth_dev **eth_dev,
                        struct rte_kvargs *kvlist)
@@ -563,17 +855,16 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	unsigned k_idx;
 	struct sockaddr_ll sockaddr;
 	struct tpacket_req *req;
+	struct tpacket_req3 req3;
 	struct pkt_rx_queue *rx_queue;
 	struct pkt_tx_queue *tx_queue;
-	int rc, tpver, discard;
+	int rc, tpver;
 	int qsockfd = -1;
 	unsigned int i, q, rdsize;
+	size_t ring_size;
 #if defined(PACKET_FANOUT)
 	int fanout_arg;
 #endif
-#if defined(PACKET_QDISC_BYPASS)
-	int bypass;
-#endif
 
 	for (k_idx = 0; k_idx < kvlist->count; k_idx++) {
 		pair = &kvlist->pairs[k_idx];
@@ -615,6 +906,16 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	req->tp_block_nr = blockcnt;
 	req->tp_frame_size = framesize;
 	req->tp_frame_nr = framecnt;
+	ring_size = (size_t)req->tp_block_size * req->tp_block_nr;
+
+	memset(&req3, 0, sizeof(req3));
+	req3.tp_block_size = blocksize;
+	req3.tp_block_nr = blockcnt;
+	req3.tp_frame_size = framesize;
+	req3.tp_frame_nr = framecnt;
+	req3.tp_retire_blk_tov = blocktmo;
+
+	(*internals)->tpacket_v3 = tpacket_v3;
 
 	ifnamelen = strlen(pair->value);
 	if (ifnamelen < sizeof(ifr.ifr_name)) {
@@ -668,7 +969,7 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			return -1;
 		}
 
-		tpver = TPACKET_V2;
+		tpver = tpacket_v3 ? TPACKET_V3 : TPACKET_V2;
 		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_VERSION,
 				&tpver, sizeof(tpver));
 		if (rc == -1) {
@@ -678,30 +979,16 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			goto error;
 		}
 
-		discard = 1;
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_LOSS,
-				&discard, sizeof(discard));
-		if (rc == -1) {
-			RTE_LOG(ERR, PMD,
-				"%s: could not set PACKET_LOSS on "
-			        "AF_PACKET socket for %s\n", name, pair->value);
+		if (!tpacket_v3 &&
+		    set_tx_options(qsockfd, name, pair->value) < 0)
 			goto error;
-		}
 
-#if defined(PACKET_QDISC_BYPASS)
-		bypass = 1;
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_QDISC_BYPASS,
-				&bypass, sizeof(bypass));
-		if (rc == -1) {
-			RTE_LOG(ERR, PMD,
-				"%s: could not set PACKET_QDISC_BYPASS "
-			        "on AF_PACKET socket for %s\n", name,
-			        pair->value);
-			goto error;
-		}
-#endif
-
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING, req, sizeof(*req));
+		if (tpacket_v3)
+			rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING,
+					&req3, sizeof(req3));
+		else
+			rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING,
+					req, sizeof(*req));
 		if (rc == -1) {
 			RTE_LOG(ERR, PMD,
 				"%s: could not set PACKET_RX_RING on AF_PACKET "
@@ -709,18 +996,23 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			goto error;
 		}
 
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
-		if (rc == -1) {
-			RTE_LOG(ERR, PMD,
-				"%s: could not set PACKET_TX_RING on AF_PACKET "
-				"socket for %s\n", name, pair->value);
-			goto error;
+		if (!tpacket_v3) {
+			rc = setsockopt(qsockfd, SOL_PACKET, PACKET_TX_RING,
+					req, sizeof(*req));
+			if (rc == -1) {
+				RTE_LOG(ERR, PMD,
+					"%s: could not set PACKET_TX_RING on "
+					"AF_PACKET socket for %s\n",
+					name, pair->value);
+				goto error;
+			}
 		}
 
 		rx_queue = &((*internals)->rx_queue[q]);
 		rx_queue->framecount = req->tp_frame_nr;
 
-		rx_queue->map = mmap(NULL, 2 * req->tp_block_size * req->tp_block_nr,
+		/* in TPACKET_V3 mode, the socket only has the Rx ring */
+		rx_queue->map = mmap(NULL, tpacket_v3 ? ring_size : 2 * ring_size,
 				    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
 				    qsockfd, 0);
 		if (rx_queue->map == MAP_FAILED) {
@@ -736,19 +1028,59 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 		rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
 		if (rx_queue->rd == NULL)
 			goto error;
-		for (i = 0; i < req->tp_frame_nr; ++i) {
-			rx_queue->rd[i].iov_base = rx_queue->map + (i * framesize);
-			rx_queue->rd[i].iov_len = req->tp_frame_size;
+		if (tpacket_v3) {
+			/* Rx descriptors are blocks */
+			rx_queue->framecount = req->tp_block_nr;
+			for (i = 0; i < req->tp_block_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+					(i * blocksize);
+				rx_queue->rd[i].iov_len = req->tp_block_size;
+			}
+		} else {
+			for (i = 0; i < req->tp_frame_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+					(i * framesize);
+				rx_queue->rd[i].iov_len = req->tp_frame_size;
+			}
 		}
 		rx_queue->sockfd = qsockfd;
 
+		if (zerocopy) {
+			rx_queue->zerocopy = 1;
+			rx_queue->shinfo = rte_zmalloc_socket(name,
+				req->tp_block_nr * sizeof(*rx_queue->shinfo),
+				0, numa_node);
+			rx_queue->block_seq = rte_zmalloc_socket(name,
+				req->tp_block_nr * sizeof(*rx_queue->block_seq),
+				0, numa_node);
+			if (rx_queue->shinfo == NULL ||
+			    rx_queue->block_seq == NULL)
+				goto error;
+			for (i = 0; i < req->tp_block_nr; ++i) {
+				rx_queue->shinfo[i].free_cb =
+					af_packet_block_free_cb;
+				rx_queue->shinfo[i].fcb_opaque =
+					rx_queue->rd[i].iov_base;
+				rte_mbuf_ext_refcnt_set(&rx_queue->shinfo[i],
+							0);
+			}
+		}
+
 		tx_queue = &((*internals)->tx_queue[q]);
 		tx_queue->framecount = req->tp_frame_nr;
 		tx_queue->frame_data_size = req->tp_frame_size;
 		tx_queue->frame_data_size -= TPACKET2_HDRLEN -
 			sizeof(struct sockaddr_ll);
 
-		tx_queue->map = rx_queue->map + req->tp_block_size * req->tp_block_nr;
+		if (tpacket_v3) {
+			tx_queue->sockfd = open_tx_socket(name, pair->value,
+					req, &sockaddr, &tx_queue->map);
+			if (tx_queue->sockfd == -1)
+				goto error;
+		} else {
+			tx_queue->map = rx_queue->map + ring_size;
+			tx_queue->sockfd = qsockfd;
+		}
 
 		tx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
 		if (tx_queue->rd == NULL)
@@ -757,7 +1089,6 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			tx_queue->rd[i].iov_base = tx_queue->map + (i * framesize);
 			tx_queue->rd[i].iov_len = req->tp_frame_size;
 		}
-		tx_queue->sockfd = qsockfd;
 
 		rc = bind(qsockfd, (const struct sockaddr*)&sockaddr, sizeof(sockaddr));
 		if (rc == -1) {
@@ -811,14 +1142,23 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	if (qsockfd != -1)
 		close(qsockfd);
 	for (q = 0; q < nb_queues; q++) {
-		munmap((*internals)->rx_queue[q].map,
-		       2 * req->tp_block_size * req->tp_block_nr);
+		if ((*internals)->rx_queue[q].map != MAP_FAILED)
+			munmap((*internals)->rx_queue[q].map,
+			       tpacket_v3 ? ring_size : 2 * ring_size);
+		if (tpacket_v3 && (*internals)->tx_queue[q].map != MAP_FAILED)
+			munmap((*internals)->tx_queue[q].map, ring_size);
 
 		rte_free((*internals)->rx_queue[q].rd);
 		rte_free((*internals)->tx_queue[q].rd);
+		rte_free((*internals)->rx_queue[q].shinfo);
+		rte_free((*internals)->rx_queue[q].block_seq);
 		if (((*internals)->rx_queue[q].sockfd != 0) &&
 			((*internals)->rx_queue[q].sockfd != qsockfd))
 			close((*internals)->rx_queue[q].sockfd);
+		if (((*internals)->tx_queue[q].sockfd > 0) &&
+			((*internals)->tx_queue[q].sockfd !=
+			 (*internals)->rx_queue[q].sockfd))
+			close((*internals)->tx_queue[q].sockfd);
 	}
 	free((*internals)->if_name);
 	rte_free(*internals);
@@ -841,7 +1181,10 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	unsigned int blocksize = DFLT_BLOCK_SIZE;
 	unsigned int framesize = DFLT_FRAME_SIZE;
 	unsigned int framecount = DFLT_FRAME_COUNT;
+	unsigned int blocktmo = DFLT_BLOCK_TMO;
 	unsigned int qpairs = 1;
+	int tpacket_v3 = 0;
+	int zerocopy = 0;
 
 	/* do some parameter checking */
 	if (*sockfd < 0)
@@ -893,6 +1236,25 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 			}
 			continue;
 		}
+		if (strstr(pair->key, ETH_AF_PACKET_TPACKETV3_ARG) != NULL) {
+			tpacket_v3 = atoi(pair->value);
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_BLOCKTMO_ARG) != NULL) {
+			blocktmo = atoi(pair->value);
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_ZEROCOPY_ARG) != NULL) {
+			zerocopy = atoi(pair->value);
+			continue;
+		}
+	}
+
+	if (zerocopy && !tpacket_v3) {
+		RTE_LOG(ERR, PMD,
+			"%s: AF_PACKET zero copy requires TPACKET_V3\n",
+		        name);
+		return -1;
 	}
 
 	if (framesize > blocksize) {
@@ -914,15 +1276,25 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	RTE_LOG(INFO, PMD, "%s:\tblock count %d\n", name, blockcount);
 	RTE_LOG(INFO, PMD, "%s:\tframe size %d\n", name, framesize);
 	RTE_LOG(INFO, PMD, "%s:\tframe count %d\n", name, framecount);
+	if (tpacket_v3) {
+		RTE_LOG(INFO, PMD, "%s:\tTPACKET_V3 Rx ring\n", name);
+		RTE_LOG(INFO, PMD, "%s:\tblock timeout %d\n", name,
+			blocktmo);
+		RTE_LOG(INFO, PMD, "%s:\tzero copy %d\n", name, zerocopy);
+	}
 
 	if (rte_pmd_init_internals(dev, *sockfd, qpairs,
 				   blocksize, blockcount,
 				   framesize, framecount,
+				   tpacket_v3, blocktmo, zerocopy,
 				   &internals, &eth_dev,
 				   kvlist) < 0)
 		return -1;
 
-	eth_dev->rx_pkt_burst = eth_af_packet_rx;
+	if (tpacket_v3)
+		eth_dev->rx_pkt_burst = eth_af_packet_rx_v3;
+	else
+		eth_dev->rx_pkt_burst = eth_af_packet_rx;
 	eth_dev->tx_pkt_burst = eth_af_packet_tx;
 
 	return 0;
@@ -972,6 +1344,7 @@ rte_pmd_af_packet_remove(struct rte_vdev_device *dev)
 {
 	struct rte_eth_dev *eth_dev = NULL;
 	struct pmd_internals *internals;
+	size_t ring_size;
 	unsigned q;
 
 	RTE_LOG(INFO, PMD, "Closing AF_PACKET ethdev on numa socket %u\n",
@@ -986,9 +1359,29 @@ rte_pmd_af_packet_remove(struct rte_vdev_device *dev)
 		return -1;
 
 	internals = eth_dev->data->dev_private;
+
+	/* zero copy mbufs may still point into the Rx rings */
+	for (q = 0; q < internals->nb_queues; q++) {
+		if (af_packet_blocks_held(&internals->rx_queue[q]) != 0) {
+			RTE_LOG(ERR, PMD,
+				"%s: Rx ring %u still in use by mbufs\n",
+				rte_vdev_device_name(dev), q);
+			return -EBUSY;
+		}
+	}
+
+	ring_size = (size_t)internals->req.tp_block_size *
+		internals->req.tp_block_nr;
 	for (q = 0; q < internals->nb_queues; q++) {
+		/* in TPACKET_V2 mode, the Tx ring follows the Rx one */
+		munmap(internals->rx_queue[q].map, internals->tpacket_v3 ?
+		       ring_size : 2 * ring_size);
+		if (internals->tpacket_v3)
+			munmap(internals->tx_queue[q].map, ring_size);
 		rte_free(internals->rx_queue[q].rd);
 		rte_free(internals->tx_queue[q].rd);
+		rte_free(internals->rx_queue[q].shinfo);
+		rte_free(internals->rx_queue[q].block_seq);
 	}
 	free(internals->if_name);
 
@@ -1012,4 +1405,7 @@ RTE_PMD_REGISTER_PARAM_STRING(net_af_packet,
 	"qpairs=<int> "
 	"blocksz=<int> "
 	"framesz=<int> "
-	"framecnt=<int>");
+	"framecnt=<int> "
+	"tpacketv3=<0|1> "
+	"blocktmo=<int> "
+	"zerocopy=<0|1>");
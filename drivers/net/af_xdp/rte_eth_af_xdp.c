@@ -0,0 +1,1355 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+#include <rte_ethdev_vdev.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_kvargs.h>
+#include <rte_vdev.h>
+
+#include <linux/if_ether.h>
+#include <linux/if_xdp.h>
+#include <linux/if_link.h>
+#include <linux/bpf.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef AF_XDP
+#define AF_XDP			44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP			283
+#endif
+
+#define ETH_AF_XDP_IFACE_ARG		"iface"
+#define ETH_AF_XDP_START_QUEUE_ARG	"start_queue"
+#define ETH_AF_XDP_QUEUE_COUNT_ARG	"queue_count"
+#define ETH_AF_XDP_SKB_MODE_ARG		"skb_mode"
+
+/* each UMEM frame holds exactly one mbuf, see af_xdp_umem_create() */
+#define ETH_AF_XDP_FRAME_SIZE		2048
+#define ETH_AF_XDP_NUM_BUFFERS		4096
+#define ETH_AF_XDP_RING_SIZE		1024
+#define ETH_AF_XDP_MBUF_CACHE_SIZE	256
+#define ETH_AF_XDP_BATCH_SIZE		32
+/* room the kernel leaves in front of the packets it writes to a frame */
+#define ETH_AF_XDP_PACKET_HEADROOM	256
+
+#define ETH_AF_XDP_MAX_QUEUE_PAIRS	16
+
+/* single producer / single consumer ring shared with the kernel */
+struct xsk_ring {
+	volatile uint32_t *producer;
+	volatile uint32_t *consumer;
+	volatile uint32_t *flags;	/* NULL without XDP_USE_NEED_WAKEUP */
+	void *desc;
+	uint32_t size;
+	uint32_t mask;
+	uint32_t cached_prod;
+	uint32_t cached_cons;
+
+	void *map;
+	size_t map_size;
+};
+
+/*
+ * The UMEM area is populated as an mbuf pool whose objects are laid out
+ * one per frame, so received frames are handed to the application as is
+ * and mbufs from the pool can be sent without copying them.
+ */
+struct xsk_umem {
+	const struct rte_memzone *mz;
+	struct rte_mempool *mb_pool;
+	uint8_t *buffer;
+	uint32_t headroom;	/* UMEM headroom given to the kernel */
+	uint32_t max_pkt_len;
+};
+
+struct pkt_rx_queue {
+	int xsk_fd;
+	struct xsk_umem umem;
+	struct xsk_ring rx;
+	struct xsk_ring fq;
+
+	uint8_t in_port;
+
+	volatile unsigned long rx_pkts;
+	volatile unsigned long rx_bytes;
+	volatile unsigned long rx_nombuf;
+	uint64_t imissed_offset;
+};
+
+struct pkt_tx_queue {
+	int xsk_fd;
+	struct xsk_umem *umem;
+	struct xsk_ring tx;
+	struct xsk_ring cq;
+
+	volatile unsigned long tx_pkts;
+	volatile unsigned long err_pkts;
+	volatile unsigned long tx_bytes;
+};
+
+struct pmd_internals {
+	unsigned int nb_queues;
+	unsigned int start_queue;
+
+	int if_index;
+	char if_name[IFNAMSIZ];
+	struct ether_addr eth_addr;
+
+	int map_fd;
+	int prog_fd;
+	uint32_t xdp_flags;
+
+	struct pkt_rx_queue rx_queue[ETH_AF_XDP_MAX_QUEUE_PAIRS];
+	struct pkt_tx_queue tx_queue[ETH_AF_XDP_MAX_QUEUE_PAIRS];
+};
+
+static const char *valid_arguments[] = {
+	ETH_AF_XDP_IFACE_ARG,
+	ETH_AF_XDP_START_QUEUE_ARG,
+	ETH_AF_XDP_QUEUE_COUNT_ARG,
+	ETH_AF_XDP_SKB_MODE_ARG,
+	NULL
+};
+
+static struct rte_eth_link pmd_link = {
+	.link_speed = ETH_SPEED_NUM_10G,
+	.link_duplex = ETH_LINK_FULL_DUPLEX,
+	.link_status = ETH_LINK_DOWN,
+	.link_autoneg = ETH_LINK_AUTONEG
+};
+
+static inline uint32_t
+xsk_ring_prod_reserve(struct xsk_ring *r, uint32_t nb, uint32_t *idx)
+{
+	uint32_t free_entries = r->size - (r->cached_prod - *r->consumer);
+
+	/* slots are only written once the kernel is done reading them */
+	rte_smp_rmb();
+	if (nb > free_entries)
+		nb = free_entries;
+	*idx = r->cached_prod;
+	r->cached_prod += nb;
+	return nb;
+}
+
+static inline void
+xsk_ring_prod_submit(struct xsk_ring *r)
+{
+	rte_smp_wmb();
+	*r->producer = r->cached_prod;
+}
+
+static inline uint32_t
+xsk_ring_cons_peek(struct xsk_ring *r, uint32_t nb, uint32_t *idx)
+{
+	uint32_t entries = *r->producer - r->cached_cons;
+
+	rte_smp_rmb();
+	if (nb > entries)
+		nb = entries;
+	*idx = r->cached_cons;
+	r->cached_cons += nb;
+	return nb;
+}
+
+static inline void
+xsk_ring_cons_release(struct xsk_ring *r)
+{
+	/* descriptors are read before their slots are given back */
+	rte_smp_rmb();
+	*r->consumer = r->cached_cons;
+}
+
+/* the kernel stopped processing the ring until it is kicked */
+static inline int
+xsk_ring_needs_wakeup(const struct xsk_ring *r)
+{
+#ifdef XDP_USE_NEED_WAKEUP
+	return r->flags != NULL && (*r->flags & XDP_RING_NEED_WAKEUP);
+#else
+	RTE_SET_USED(r);
+	return 0;
+#endif
+}
+
+static inline uint64_t *
+xsk_ring_addr(struct xsk_ring *r, uint32_t idx)
+{
+	return &((uint64_t *)r->desc)[idx & r->mask];
+}
+
+static inline struct xdp_desc *
+xsk_ring_xdp_desc(struct xsk_ring *r, uint32_t idx)
+{
+	return &((struct xdp_desc *)r->desc)[idx & r->mask];
+}
+
+static inline uint64_t
+xsk_mbuf_to_addr(const struct xsk_umem *umem, const struct rte_mbuf *mbuf)
+{
+	return (const uint8_t *)mbuf - umem->mb_pool->header_size -
+		umem->buffer;
+}
+
+static inline struct rte_mbuf *
+xsk_addr_to_mbuf(const struct xsk_umem *umem, uint64_t addr)
+{
+	addr &= ~(uint64_t)(ETH_AF_XDP_FRAME_SIZE - 1);
+	return (struct rte_mbuf *)(umem->buffer + addr +
+				   umem->mb_pool->header_size);
+}
+
+/*
+ * Give free frames back to the kernel, a batch at a time, until the
+ * fill ring is full or the UMEM pool runs dry.
+ */
+static void
+af_xdp_refill(struct pkt_rx_queue *rxq)
+{
+	struct xsk_umem *umem = &rxq->umem;
+	struct rte_mbuf *mbufs[ETH_AF_XDP_BATCH_SIZE];
+	uint32_t i, idx, n;
+
+	do {
+		n = xsk_ring_prod_reserve(&rxq->fq, ETH_AF_XDP_BATCH_SIZE,
+					  &idx);
+		if (n == 0)
+			return;
+
+		if (rte_pktmbuf_alloc_bulk(umem->mb_pool, mbufs, n) != 0) {
+			rxq->fq.cached_prod -= n;
+			rxq->rx_nombuf += n;
+			return;
+		}
+
+		for (i = 0; i < n; i++)
+			*xsk_ring_addr(&rxq->fq, idx + i) =
+				xsk_mbuf_to_addr(umem, mbufs[i]);
+
+		xsk_ring_prod_submit(&rxq->fq);
+	} while (n == ETH_AF_XDP_BATCH_SIZE);
+}
+
+static uint16_t
+eth_af_xdp_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pkt_rx_queue *rxq = queue;
+	struct xsk_umem *umem = &rxq->umem;
+	const struct xdp_desc *desc;
+	struct rte_mbuf *mbuf;
+	unsigned long rx_bytes = 0;
+	uint32_t i, idx, rcvd;
+
+	rcvd = xsk_ring_cons_peek(&rxq->rx, nb_pkts, &idx);
+	if (rcvd == 0) {
+		/* the driver sleeps until the fill ring is polled */
+		if (xsk_ring_needs_wakeup(&rxq->fq))
+			recvfrom(rxq->xsk_fd, NULL, 0, MSG_DONTWAIT, NULL,
+				 NULL);
+		return 0;
+	}
+
+	for (i = 0; i < rcvd; i++) {
+		desc = xsk_ring_xdp_desc(&rxq->rx, idx + i);
+		mbuf = xsk_addr_to_mbuf(umem, desc->addr);
+		mbuf->data_off = umem->buffer + desc->addr -
+			(uint8_t *)mbuf->buf_addr;
+		rte_pktmbuf_data_len(mbuf) = desc->len;
+		rte_pktmbuf_pkt_len(mbuf) = desc->len;
+		mbuf->port = rxq->in_port;
+		bufs[i] = mbuf;
+		rx_bytes += desc->len;
+	}
+
+	xsk_ring_cons_release(&rxq->rx);
+	af_xdp_refill(rxq);
+
+	rxq->rx_pkts += rcvd;
+	rxq->rx_bytes += rx_bytes;
+	return rcvd;
+}
+
+/* free the mbufs whose frames the kernel is done sending */
+static void
+af_xdp_tx_complete(struct pkt_tx_queue *txq)
+{
+	uint32_t i, idx, n;
+
+	n = xsk_ring_cons_peek(&txq->cq, ETH_AF_XDP_RING_SIZE, &idx);
+	if (n == 0)
+		return;
+
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free_seg(xsk_addr_to_mbuf(txq->umem,
+					*xsk_ring_addr(&txq->cq, idx + i)));
+
+	xsk_ring_cons_release(&txq->cq);
+}
+
+static uint16_t
+eth_af_xdp_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pkt_tx_queue *txq = queue;
+	struct xsk_umem *umem = txq->umem;
+	struct rte_mbuf *mbuf, *local, *seg;
+	struct xdp_desc *desc;
+	unsigned long tx_bytes = 0;
+	uint32_t i, idx, n, sent = 0;
+	uint8_t *pbuf;
+
+	af_xdp_tx_complete(txq);
+
+	n = xsk_ring_prod_reserve(&txq->tx, nb_pkts, &idx);
+	for (i = 0; i < n; i++) {
+		mbuf = bufs[i];
+
+		/* mbufs of this UMEM are sent in place */
+		if (mbuf->pool == umem->mb_pool && RTE_MBUF_DIRECT(mbuf) &&
+		    mbuf->nb_segs == 1 &&
+		    rte_mbuf_refcnt_read(mbuf) == 1) {
+			local = mbuf;
+		} else {
+			if (mbuf->pkt_len > umem->max_pkt_len) {
+				rte_pktmbuf_free(mbuf);
+				txq->err_pkts++;
+				continue;
+			}
+
+			local = rte_pktmbuf_alloc(umem->mb_pool);
+			if (local == NULL)
+				break;
+
+			pbuf = rte_pktmbuf_mtod(local, uint8_t *);
+			for (seg = mbuf; seg != NULL; seg = seg->next) {
+				rte_memcpy(pbuf, rte_pktmbuf_mtod(seg, void *),
+					   rte_pktmbuf_data_len(seg));
+				pbuf += rte_pktmbuf_data_len(seg);
+			}
+			rte_pktmbuf_data_len(local) = mbuf->pkt_len;
+			rte_pktmbuf_pkt_len(local) = mbuf->pkt_len;
+			rte_pktmbuf_free(mbuf);
+		}
+
+		desc = xsk_ring_xdp_desc(&txq->tx, idx + sent);
+		desc->addr = rte_pktmbuf_mtod(local, uint8_t *) - umem->buffer;
+		desc->len = local->pkt_len;
+		tx_bytes += local->pkt_len;
+		sent++;
+	}
+
+	/* hand back the slots left unused */
+	txq->tx.cached_prod -= n - sent;
+	if (sent != 0)
+		xsk_ring_prod_submit(&txq->tx);
+
+	/*
+	 * Kick the kernel when it asks for it, or on every burst when it
+	 * cannot tell, even when nothing was queued: a full Tx ring only
+	 * drains on transmit requests.
+	 */
+	if ((txq->tx.flags == NULL || xsk_ring_needs_wakeup(&txq->tx)) &&
+	    sendto(txq->xsk_fd, NULL, 0, MSG_DONTWAIT, NULL, 0) < 0 &&
+	    errno != EAGAIN && errno != EBUSY && errno != ENOBUFS)
+		RTE_LOG(DEBUG, PMD, "AF_XDP Tx kick failed: %s\n",
+			strerror(errno));
+
+	txq->tx_pkts += sent;
+	txq->tx_bytes += tx_bytes;
+	return i;
+}
+
+static int
+sys_bpf(enum bpf_cmd cmd, union bpf_attr *attr)
+{
+	return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+/*
+ * Create the XSKMAP holding one socket per queue, indexed by the Rx queue
+ * of the interface.
+ */
+static int
+af_xdp_map_create(unsigned int max_entries)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_type = BPF_MAP_TYPE_XSKMAP;
+	attr.key_size = sizeof(uint32_t);
+	attr.value_size = sizeof(int);
+	attr.max_entries = max_entries;
+
+	return sys_bpf(BPF_MAP_CREATE, &attr);
+}
+
+static int
+af_xdp_map_update(int map_fd, uint32_t key, int xsk_fd)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_fd = map_fd;
+	attr.key = (uintptr_t)&key;
+	attr.value = (uintptr_t)&xsk_fd;
+	attr.flags = BPF_ANY;
+
+	return sys_bpf(BPF_MAP_UPDATE_ELEM, &attr);
+}
+
+#define AF_XDP_INSN(c, d, s, o, i) \
+	{ .code = (c), .dst_reg = (d), .src_reg = (s), .off = (o), .imm = (i) }
+
+/*
+ * Load the XDP program redirecting the packets of each Rx queue to the
+ * socket found at the same index in the map, if any:
+ *
+ *	key = ctx->rx_queue_index;
+ *	if (bpf_map_lookup_elem(&xsks_map, &key) == NULL)
+ *		return XDP_PASS;
+ *	return bpf_redirect_map(&xsks_map, key, 0);
+ */
+static int
+af_xdp_prog_load(int map_fd)
+{
+	const struct bpf_insn insns[] = {
+		AF_XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_1,
+			    offsetof(struct xdp_md, rx_queue_index), 0),
+		AF_XDP_INSN(BPF_STX | BPF_MEM | BPF_W, BPF_REG_10, BPF_REG_2,
+			    -4, 0),
+		AF_XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_2, BPF_REG_10,
+			    0, 0),
+		AF_XDP_INSN(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_2, 0, 0, -4),
+		AF_XDP_INSN(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1,
+			    BPF_PSEUDO_MAP_FD, 0, map_fd),
+		AF_XDP_INSN(0, 0, 0, 0, 0),
+		AF_XDP_INSN(BPF_JMP | BPF_CALL, 0, 0, 0,
+			    BPF_FUNC_map_lookup_elem),
+		AF_XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_1, BPF_REG_0,
+			    0, 0),
+		AF_XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0,
+			    XDP_PASS),
+		/* no socket: jump to exit */
+		AF_XDP_INSN(BPF_JMP | BPF_JEQ | BPF_K, BPF_REG_1, 0, 5, 0),
+		AF_XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_10,
+			    -4, 0),
+		AF_XDP_INSN(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1,
+			    BPF_PSEUDO_MAP_FD, 0, map_fd),
+		AF_XDP_INSN(0, 0, 0, 0, 0),
+		AF_XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, 0),
+		AF_XDP_INSN(BPF_JMP | BPF_CALL, 0, 0, 0,
+			    BPF_FUNC_redirect_map),
+		AF_XDP_INSN(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+	};
+	static const char license[] = "Dual BSD/GPL";
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.prog_type = BPF_PROG_TYPE_XDP;
+	attr.insns = (uintptr_t)insns;
+	attr.insn_cnt = RTE_DIM(insns);
+	attr.license = (uintptr_t)license;
+
+	return sys_bpf(BPF_PROG_LOAD, &attr);
+}
+
+/*
+ * Attach an XDP program to an interface, or detach it when prog_fd is -1,
+ * with a RTM_SETLINK netlink request.
+ */
+static int
+af_xdp_link_set(int if_index, int prog_fd, uint32_t flags)
+{
+	struct {
+		struct nlmsghdr nh;
+		struct ifinfomsg ifinfo;
+		char attrbuf[64];
+	} req;
+	struct {
+		struct nlmsghdr nh;
+		struct nlmsgerr err;
+	} ack;
+	struct sockaddr_nl sa = { .nl_family = AF_NETLINK };
+	struct nlattr *nla, *nla_xdp;
+	int fd, ret = -1;
+
+	fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (fd < 0)
+		return -1;
+
+	memset(&req, 0, sizeof(req));
+	req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+	req.nh.nlmsg_type = RTM_SETLINK;
+	req.ifinfo.ifi_family = AF_UNSPEC;
+	req.ifinfo.ifi_index = if_index;
+
+	nla = (struct nlattr *)((char *)&req + NLMSG_ALIGN(req.nh.nlmsg_len));
+	nla->nla_type = NLA_F_NESTED | IFLA_XDP;
+	nla->nla_len = NLA_HDRLEN;
+
+	nla_xdp = (struct nlattr *)((char *)nla + nla->nla_len);
+	nla_xdp->nla_type = IFLA_XDP_FD;
+	nla_xdp->nla_len = NLA_HDRLEN + sizeof(int);
+	memcpy((char *)nla_xdp + NLA_HDRLEN, &prog_fd, sizeof(prog_fd));
+	nla->nla_len += NLA_ALIGN(nla_xdp->nla_len);
+
+	if (flags != 0) {
+		nla_xdp = (struct nlattr *)((char *)nla + nla->nla_len);
+		nla_xdp->nla_type = IFLA_XDP_FLAGS;
+		nla_xdp->nla_len = NLA_HDRLEN + sizeof(flags);
+		memcpy((char *)nla_xdp + NLA_HDRLEN, &flags, sizeof(flags));
+		nla->nla_len += NLA_ALIGN(nla_xdp->nla_len);
+	}
+	req.nh.nlmsg_len += NLA_ALIGN(nla->nla_len);
+
+	if (sendto(fd, &req, req.nh.nlmsg_len, 0,
+		   (struct sockaddr *)&sa, sizeof(sa)) < 0)
+		goto out;
+
+	if (recv(fd, &ack, sizeof(ack), 0) < (ssize_t)sizeof(ack) ||
+	    ack.nh.nlmsg_type != NLMSG_ERROR)
+		goto out;
+
+	if (ack.err.error != 0) {
+		errno = -ack.err.error;
+		goto out;
+	}
+	ret = 0;
+out:
+	close(fd);
+	return ret;
+}
+
+static void
+af_xdp_prog_detach(struct pmd_internals *internals)
+{
+	if (internals->prog_fd == -1)
+		return;
+
+	af_xdp_link_set(internals->if_index, -1, internals->xdp_flags);
+	close(internals->prog_fd);
+	internals->prog_fd = -1;
+}
+
+static int
+eth_dev_start(struct rte_eth_dev *dev)
+{
+	dev->data->dev_link.link_status = ETH_LINK_UP;
+	return 0;
+}
+
+/*
+ * This function gets called when the current port gets stopped.
+ * Sockets stay bound until the device is removed, so that it can be
+ * started again.
+ */
+static void
+eth_dev_stop(struct rte_eth_dev *dev)
+{
+	dev->data->dev_link.link_status = ETH_LINK_DOWN;
+}
+
+static int
+eth_dev_configure(struct rte_eth_dev *dev __rte_unused)
+{
+	return 0;
+}
+
+static void
+eth_dev_info(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	dev_info->if_index = internals->if_index;
+	dev_info->max_mac_addrs = 1;
+	dev_info->max_rx_pktlen = internals->rx_queue[0].umem.max_pkt_len;
+	dev_info->max_rx_queues = (uint16_t)internals->nb_queues;
+	dev_info->max_tx_queues = (uint16_t)internals->nb_queues;
+	dev_info->min_rx_bufsize = 0;
+}
+
+/* packets the kernel could not put on the Rx ring of a socket */
+static uint64_t
+af_xdp_rx_missed(const struct pkt_rx_queue *rxq)
+{
+	struct xdp_statistics xdp_stats;
+	socklen_t optlen = sizeof(xdp_stats);
+
+	memset(&xdp_stats, 0, sizeof(xdp_stats));
+	if (getsockopt(rxq->xsk_fd, SOL_XDP, XDP_STATISTICS, &xdp_stats,
+		       &optlen) < 0)
+		return 0;
+
+	return xdp_stats.rx_dropped + xdp_stats.rx_ring_full;
+}
+
+static void
+eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
+{
+	unsigned int i, imax;
+	unsigned long rx_total = 0, tx_total = 0, tx_err_total = 0;
+	unsigned long rx_bytes_total = 0, tx_bytes_total = 0;
+	unsigned long rx_nombuf_total = 0;
+	uint64_t imissed_total = 0;
+	const struct pmd_internals *internal = dev->data->dev_private;
+
+	imax = (internal->nb_queues < RTE_ETHDEV_QUEUE_STAT_CNTRS ?
+		internal->nb_queues : RTE_ETHDEV_QUEUE_STAT_CNTRS);
+	for (i = 0; i < imax; i++) {
+		igb_stats->q_ipackets[i] = internal->rx_queue[i].rx_pkts;
+		igb_stats->q_ibytes[i] = internal->rx_queue[i].rx_bytes;
+		rx_total += igb_stats->q_ipackets[i];
+		rx_bytes_total += igb_stats->q_ibytes[i];
+	}
+
+	for (i = 0; i < internal->nb_queues; i++) {
+		rx_nombuf_total += internal->rx_queue[i].rx_nombuf;
+		imissed_total += af_xdp_rx_missed(&internal->rx_queue[i]) -
+			internal->rx_queue[i].imissed_offset;
+	}
+
+	for (i = 0; i < imax; i++) {
+		igb_stats->q_opackets[i] = internal->tx_queue[i].tx_pkts;
+		igb_stats->q_errors[i] = internal->tx_queue[i].err_pkts;
+		igb_stats->q_obytes[i] = internal->tx_queue[i].tx_bytes;
+		tx_total += igb_stats->q_opackets[i];
+		tx_err_total += igb_stats->q_errors[i];
+		tx_bytes_total += igb_stats->q_obytes[i];
+	}
+
+	igb_stats->ipackets = rx_total;
+	igb_stats->ibytes = rx_bytes_total;
+	igb_stats->imissed = imissed_total;
+	igb_stats->rx_nombuf = rx_nombuf_total;
+	igb_stats->opackets = tx_total;
+	igb_stats->oerrors = tx_err_total;
+	igb_stats->obytes = tx_bytes_total;
+}
+
+static void
+eth_stats_reset(struct rte_eth_dev *dev)
+{
+	unsigned int i;
+	struct pmd_internals *internal = dev->data->dev_private;
+
+	for (i = 0; i < internal->nb_queues; i++) {
+		internal->rx_queue[i].rx_pkts = 0;
+		internal->rx_queue[i].rx_bytes = 0;
+		internal->rx_queue[i].rx_nombuf = 0;
+		internal->rx_queue[i].imissed_offset =
+			af_xdp_rx_missed(&internal->rx_queue[i]);
+	}
+
+	for (i = 0; i < internal->nb_queues; i++) {
+		internal->tx_queue[i].tx_pkts = 0;
+		internal->tx_queue[i].err_pkts = 0;
+		internal->tx_queue[i].tx_bytes = 0;
+	}
+}
+
+/*
+ * Detach the XDP program on close, the interface would otherwise keep
+ * redirecting its traffic to the sockets of an application gone.
+ */
+static void
+eth_dev_close(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	af_xdp_prog_detach(internals);
+}
+
+static void
+eth_queue_release(void *q __rte_unused)
+{
+}
+
+static int
+eth_link_update(struct rte_eth_dev *dev __rte_unused,
+		int wait_to_complete __rte_unused)
+{
+	return 0;
+}
+
+static int
+eth_rx_queue_setup(struct rte_eth_dev *dev,
+		   uint16_t rx_queue_id,
+		   uint16_t nb_rx_desc __rte_unused,
+		   unsigned int socket_id __rte_unused,
+		   const struct rte_eth_rxconf *rx_conf __rte_unused,
+		   struct rte_mempool *mb_pool __rte_unused)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct pkt_rx_queue *rxq = &internals->rx_queue[rx_queue_id];
+
+	/* received mbufs always come from the UMEM pool of the queue */
+	dev->data->rx_queues[rx_queue_id] = rxq;
+	rxq->in_port = dev->data->port_id;
+
+	return 0;
+}
+
+static int
+eth_tx_queue_setup(struct rte_eth_dev *dev,
+		   uint16_t tx_queue_id,
+		   uint16_t nb_tx_desc __rte_unused,
+		   unsigned int socket_id __rte_unused,
+		   const struct rte_eth_txconf *tx_conf __rte_unused)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	dev->data->tx_queues[tx_queue_id] = &internals->tx_queue[tx_queue_id];
+	return 0;
+}
+
+static int
+eth_dev_mtu_set(struct rte_eth_dev *dev, uint16_t mtu)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct ifreq ifr = { .ifr_mtu = mtu };
+	int ret;
+	int s;
+
+	if ((uint32_t)mtu + ETHER_HDR_LEN >
+	    internals->rx_queue[0].umem.max_pkt_len)
+		return -EINVAL;
+
+	s = socket(PF_INET, SOCK_DGRAM, 0);
+	if (s < 0)
+		return -EINVAL;
+
+	snprintf(ifr.ifr_name, IFNAMSIZ, "%s", internals->if_name);
+	ret = ioctl(s, SIOCSIFMTU, &ifr);
+	close(s);
+
+	if (ret < 0)
+		return -EINVAL;
+
+	return 0;
+}
+
+static void
+eth_dev_change_flags(char *if_name, uint32_t flags, uint32_t mask)
+{
+	struct ifreq ifr;
+	int s;
+
+	s = socket(PF_INET, SOCK_DGRAM, 0);
+	if (s < 0)
+		return;
+
+	snprintf(ifr.ifr_name, IFNAMSIZ, "%s", if_name);
+	if (ioctl(s, SIOCGIFFLAGS, &ifr) < 0)
+		goto out;
+	ifr.ifr_flags &= mask;
+	ifr.ifr_flags |= flags;
+	if (ioctl(s, SIOCSIFFLAGS, &ifr) < 0)
+		goto out;
+out:
+	close(s);
+}
+
+static void
+eth_dev_promiscuous_enable(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	eth_dev_change_flags(internals->if_name, IFF_PROMISC, ~0);
+}
+
+static void
+eth_dev_promiscuous_disable(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	eth_dev_change_flags(internals->if_name, 0, ~IFF_PROMISC);
+}
+
+static const struct eth_dev_ops ops = {
+	.dev_start = eth_dev_start,
+	.dev_stop = eth_dev_stop,
+	.dev_close = eth_dev_close,
+	.dev_configure = eth_dev_configure,
+	.dev_infos_get = eth_dev_info,
+	.mtu_set = eth_dev_mtu_set,
+	.promiscuous_enable = eth_dev_promiscuous_enable,
+	.promiscuous_disable = eth_dev_promiscuous_disable,
+	.rx_queue_setup = eth_rx_queue_setup,
+	.tx_queue_setup = eth_tx_queue_setup,
+	.rx_queue_release = eth_queue_release,
+	.tx_queue_release = eth_queue_release,
+	.link_update = eth_link_update,
+	.stats_get = eth_stats_get,
+	.stats_reset = eth_stats_reset,
+};
+
+/*
+ * Reserve the UMEM area of a queue pair and populate it as an mbuf pool,
+ * every object (header, mbuf and data room) filling exactly one frame.
+ */
+static int
+af_xdp_umem_create(struct xsk_umem *umem, const char *name, unsigned int q,
+		   int numa_node)
+{
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+	char pool_name[RTE_MEMPOOL_NAMESIZE];
+	struct rte_pktmbuf_pool_private mbp_priv;
+	struct rte_mempool_objsz objsz;
+	uint32_t elt_size = ETH_AF_XDP_FRAME_SIZE;
+	uint32_t data_off;
+	int ret;
+
+	do {
+		elt_size -= RTE_CACHE_LINE_SIZE;
+	} while (rte_mempool_calc_obj_size(elt_size, MEMPOOL_F_NO_SPREAD,
+					   &objsz) > ETH_AF_XDP_FRAME_SIZE);
+	if (objsz.total_size != ETH_AF_XDP_FRAME_SIZE)
+		return -1;
+
+	snprintf(mz_name, sizeof(mz_name), "umem_%s_%u", name, q);
+	umem->mz = rte_memzone_reserve_aligned(mz_name,
+			ETH_AF_XDP_NUM_BUFFERS * ETH_AF_XDP_FRAME_SIZE,
+			numa_node, 0, getpagesize());
+	if (umem->mz == NULL)
+		return -1;
+	umem->buffer = umem->mz->addr;
+
+	snprintf(pool_name, sizeof(pool_name), "%s_%u", name, q);
+	umem->mb_pool = rte_mempool_create_empty(pool_name,
+			ETH_AF_XDP_NUM_BUFFERS, elt_size,
+			ETH_AF_XDP_MBUF_CACHE_SIZE,
+			sizeof(struct rte_pktmbuf_pool_private),
+			numa_node, MEMPOOL_F_NO_SPREAD);
+	if (umem->mb_pool == NULL)
+		goto error;
+
+	if (rte_mempool_set_ops_byname(umem->mb_pool,
+				       RTE_MBUF_DEFAULT_MEMPOOL_OPS,
+				       NULL) != 0)
+		goto error;
+
+	mbp_priv.mbuf_data_room_size = elt_size - sizeof(struct rte_mbuf);
+	mbp_priv.mbuf_priv_size = 0;
+	rte_pktmbuf_pool_init(umem->mb_pool, &mbp_priv);
+
+	ret = rte_mempool_populate_phys(umem->mb_pool, umem->mz->addr,
+					umem->mz->phys_addr, umem->mz->len,
+					NULL, NULL);
+	if (ret != ETH_AF_XDP_NUM_BUFFERS)
+		goto error;
+
+	rte_mempool_obj_iter(umem->mb_pool, rte_pktmbuf_init, NULL);
+
+	/*
+	 * Have the kernel write packets where the mbuf data starts, past
+	 * its own headroom.
+	 */
+	data_off = objsz.header_size + sizeof(struct rte_mbuf) +
+		RTE_PKTMBUF_HEADROOM;
+	if (data_off < ETH_AF_XDP_PACKET_HEADROOM)
+		data_off = ETH_AF_XDP_PACKET_HEADROOM;
+	umem->headroom = data_off - ETH_AF_XDP_PACKET_HEADROOM;
+	umem->max_pkt_len = objsz.header_size + elt_size - data_off;
+
+	return 0;
+
+error:
+	rte_mempool_free(umem->mb_pool);
+	umem->mb_pool = NULL;
+	rte_memzone_free(umem->mz);
+	umem->mz = NULL;
+	return -1;
+}
+
+static void
+af_xdp_umem_destroy(struct xsk_umem *umem)
+{
+	rte_mempool_free(umem->mb_pool);
+	umem->mb_pool = NULL;
+	rte_memzone_free(umem->mz);
+	umem->mz = NULL;
+}
+
+static int
+xsk_ring_map(struct xsk_ring *r, int fd, const struct xdp_ring_offset *off,
+	     uint32_t size, size_t desc_size, off_t pgoff)
+{
+	r->map_size = off->desc + size * desc_size;
+	r->map = mmap(NULL, r->map_size, PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_POPULATE, fd, pgoff);
+	if (r->map == MAP_FAILED)
+		return -1;
+
+	r->producer = (uint32_t *)((uint8_t *)r->map + off->producer);
+	r->consumer = (uint32_t *)((uint8_t *)r->map + off->consumer);
+	r->flags = NULL;
+#ifdef XDP_USE_NEED_WAKEUP
+	if (off->flags != 0)
+		r->flags = (uint32_t *)((uint8_t *)r->map + off->flags);
+#endif
+	r->desc = (uint8_t *)r->map + off->desc;
+	r->size = size;
+	r->mask = size - 1;
+	r->cached_prod = *r->producer;
+	r->cached_cons = *r->consumer;
+
+	return 0;
+}
+
+#ifdef XDP_USE_NEED_WAKEUP
+/* ring offsets returned by kernels older than 5.4, without the flags */
+struct xdp_ring_offset_v1 {
+	__u64 producer;
+	__u64 consumer;
+	__u64 desc;
+};
+
+struct xdp_mmap_offsets_v1 {
+	struct xdp_ring_offset_v1 rx;
+	struct xdp_ring_offset_v1 tx;
+	struct xdp_ring_offset_v1 fr;
+	struct xdp_ring_offset_v1 cr;
+};
+
+static void
+xsk_ring_offset_from_v1(struct xdp_ring_offset *off,
+			const struct xdp_ring_offset_v1 *off_v1)
+{
+	off->producer = off_v1->producer;
+	off->consumer = off_v1->consumer;
+	off->desc = off_v1->desc;
+	off->flags = 0;
+}
+#endif
+
+/*
+ * Get the ring offsets, with the ring flags telling when the kernel needs
+ * to be kicked if the kernel has them (zero otherwise).
+ */
+static int
+xsk_mmap_offsets_get(int fd, struct xdp_mmap_offsets *off)
+{
+	socklen_t optlen = sizeof(*off);
+
+	if (getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, off, &optlen) < 0)
+		return -1;
+
+#ifdef XDP_USE_NEED_WAKEUP
+	if (optlen == sizeof(struct xdp_mmap_offsets_v1)) {
+		struct xdp_mmap_offsets_v1 off_v1;
+
+		memcpy(&off_v1, off, sizeof(off_v1));
+		xsk_ring_offset_from_v1(&off->rx, &off_v1.rx);
+		xsk_ring_offset_from_v1(&off->tx, &off_v1.tx);
+		xsk_ring_offset_from_v1(&off->fr, &off_v1.fr);
+		xsk_ring_offset_from_v1(&off->cr, &off_v1.cr);
+	}
+#endif
+
+	return 0;
+}
+
+static void
+xsk_ring_unmap(struct xsk_ring *r)
+{
+	if (r->map != MAP_FAILED)
+		munmap(r->map, r->map_size);
+	r->map = MAP_FAILED;
+}
+
+/*
+ * Open the AF_XDP socket of a queue pair on top of its UMEM, map its four
+ * rings and bind it to the interface queue.
+ */
+static int
+af_xdp_socket_create(struct pmd_internals *internals, unsigned int q)
+{
+	struct pkt_rx_queue *rxq = &internals->rx_queue[q];
+	struct pkt_tx_queue *txq = &internals->tx_queue[q];
+	struct xdp_umem_reg mr;
+	struct xdp_mmap_offsets off;
+	struct sockaddr_xdp sxdp;
+	int ring_size = ETH_AF_XDP_RING_SIZE;
+	int fd;
+
+	fd = socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+	rxq->xsk_fd = fd;
+	txq->xsk_fd = fd;
+
+	memset(&mr, 0, sizeof(mr));
+	mr.addr = (uintptr_t)rxq->umem.buffer;
+	mr.len = ETH_AF_XDP_NUM_BUFFERS * ETH_AF_XDP_FRAME_SIZE;
+	mr.chunk_size = ETH_AF_XDP_FRAME_SIZE;
+	mr.headroom = rxq->umem.headroom;
+	if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &mr, sizeof(mr)) < 0)
+		return -1;
+
+	if (setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &ring_size,
+		       sizeof(ring_size)) < 0 ||
+	    setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring_size,
+		       sizeof(ring_size)) < 0 ||
+	    setsockopt(fd, SOL_XDP, XDP_RX_RING, &ring_size,
+		       sizeof(ring_size)) < 0 ||
+	    setsockopt(fd, SOL_XDP, XDP_TX_RING, &ring_size,
+		       sizeof(ring_size)) < 0)
+		return -1;
+
+	if (xsk_mmap_offsets_get(fd, &off) < 0)
+		return -1;
+
+	if (xsk_ring_map(&rxq->rx, fd, &off.rx, ETH_AF_XDP_RING_SIZE,
+			 sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) < 0 ||
+	    xsk_ring_map(&rxq->fq, fd, &off.fr, ETH_AF_XDP_RING_SIZE,
+			 sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) < 0 ||
+	    xsk_ring_map(&txq->tx, fd, &off.tx, ETH_AF_XDP_RING_SIZE,
+			 sizeof(struct xdp_desc), XDP_PGOFF_TX_RING) < 0 ||
+	    xsk_ring_map(&txq->cq, fd, &off.cr, ETH_AF_XDP_RING_SIZE,
+			 sizeof(uint64_t),
+			 XDP_UMEM_PGOFF_COMPLETION_RING) < 0)
+		return -1;
+
+	/* frames must be available before the first packet comes in */
+	af_xdp_refill(rxq);
+
+	memset(&sxdp, 0, sizeof(sxdp));
+	sxdp.sxdp_family = AF_XDP;
+	sxdp.sxdp_ifindex = internals->if_index;
+	sxdp.sxdp_queue_id = internals->start_queue + q;
+#ifdef XDP_USE_NEED_WAKEUP
+	/* kick the kernel only when it asks for it, see eth_af_xdp_tx() */
+	if (txq->tx.flags != NULL)
+		sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP;
+#endif
+	if (bind(fd, (struct sockaddr *)&sxdp, sizeof(sxdp)) < 0)
+		return -1;
+
+	return af_xdp_map_update(internals->map_fd, sxdp.sxdp_queue_id, fd);
+}
+
+static void
+af_xdp_queues_release(struct pmd_internals *internals)
+{
+	unsigned int q;
+
+	for (q = 0; q < internals->nb_queues; q++) {
+		struct pkt_rx_queue *rxq = &internals->rx_queue[q];
+		struct pkt_tx_queue *txq = &internals->tx_queue[q];
+
+		xsk_ring_unmap(&rxq->rx);
+		xsk_ring_unmap(&rxq->fq);
+		xsk_ring_unmap(&txq->tx);
+		xsk_ring_unmap(&txq->cq);
+		if (rxq->xsk_fd != -1)
+			close(rxq->xsk_fd);
+		rxq->xsk_fd = -1;
+		txq->xsk_fd = -1;
+		af_xdp_umem_destroy(&rxq->umem);
+	}
+}
+
+static int
+set_iface(const char *key __rte_unused, const char *value, void *extra_args)
+{
+	char *if_name = extra_args;
+
+	if (strlen(value) >= IFNAMSIZ)
+		return -1;
+	snprintf(if_name, IFNAMSIZ, "%s", value);
+	return 0;
+}
+
+static int
+set_uint(const char *key __rte_unused, const char *value, void *extra_args)
+{
+	char *end;
+	unsigned long v;
+
+	errno = 0;
+	v = strtoul(value, &end, 0);
+	if (errno != 0 || *end != '\0' || v > UINT16_MAX)
+		return -1;
+	*(unsigned int *)extra_args = v;
+	return 0;
+}
+
+static int
+get_iface_info(struct pmd_internals *internals, const char *name)
+{
+	struct ifreq ifr;
+	int s;
+
+	internals->if_index = if_nametoindex(internals->if_name);
+	if (internals->if_index == 0) {
+		RTE_LOG(ERR, PMD, "%s: no such interface %s\n",
+			name, internals->if_name);
+		return -1;
+	}
+
+	s = socket(PF_INET, SOCK_DGRAM, 0);
+	if (s < 0)
+		return -1;
+
+	snprintf(ifr.ifr_name, IFNAMSIZ, "%s", internals->if_name);
+	if (ioctl(s, SIOCGIFHWADDR, &ifr) < 0) {
+		RTE_LOG(ERR, PMD, "%s: cannot get MAC address of %s\n",
+			name, internals->if_name);
+		close(s);
+		return -1;
+	}
+	close(s);
+	memcpy(&internals->eth_addr, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+
+	return 0;
+}
+
+static int
+rte_eth_from_xdp(struct rte_vdev_device *dev, const char *if_name,
+		 unsigned int start_queue, unsigned int nb_queues,
+		 int skb_mode)
+{
+	const char *name = rte_vdev_device_name(dev);
+	const unsigned int numa_node = dev->device.numa_node;
+	struct rte_eth_dev_data *data = NULL;
+	struct pmd_internals *internals;
+	struct rte_eth_dev *eth_dev = NULL;
+	unsigned int q;
+
+	RTE_LOG(INFO, PMD,
+		"%s: creating AF_XDP-backed ethdev on numa socket %u\n",
+		name, numa_node);
+
+	data = rte_zmalloc_socket(name, sizeof(*data), 0, numa_node);
+	if (data == NULL)
+		return -1;
+
+	internals = rte_zmalloc_socket(name, sizeof(*internals), 0, numa_node);
+	if (internals == NULL) {
+		rte_free(data);
+		return -1;
+	}
+
+	snprintf(internals->if_name, IFNAMSIZ, "%s", if_name);
+	internals->start_queue = start_queue;
+	internals->nb_queues = nb_queues;
+	internals->map_fd = -1;
+	internals->prog_fd = -1;
+	internals->xdp_flags = skb_mode ? XDP_FLAGS_SKB_MODE : 0;
+	for (q = 0; q < nb_queues; q++) {
+		internals->rx_queue[q].xsk_fd = -1;
+		internals->rx_queue[q].rx.map = MAP_FAILED;
+		internals->rx_queue[q].fq.map = MAP_FAILED;
+		internals->tx_queue[q].xsk_fd = -1;
+		internals->tx_queue[q].tx.map = MAP_FAILED;
+		internals->tx_queue[q].cq.map = MAP_FAILED;
+		internals->tx_queue[q].umem = &internals->rx_queue[q].umem;
+	}
+
+	if (get_iface_info(internals, name) < 0)
+		goto error;
+
+	internals->map_fd = af_xdp_map_create(start_queue + nb_queues);
+	if (internals->map_fd < 0) {
+		RTE_LOG(ERR, PMD, "%s: cannot create XSKMAP: %s\n",
+			name, strerror(errno));
+		goto error;
+	}
+
+	for (q = 0; q < nb_queues; q++) {
+		if (af_xdp_umem_create(&internals->rx_queue[q].umem, name, q,
+				       numa_node) < 0) {
+			RTE_LOG(ERR, PMD, "%s: cannot create UMEM %u\n",
+				name, q);
+			goto error;
+		}
+		if (af_xdp_socket_create(internals, q) < 0) {
+			RTE_LOG(ERR, PMD,
+				"%s: cannot bind AF_XDP socket to %s queue %u: %s\n",
+				name, if_name, start_queue + q,
+				strerror(errno));
+			goto error;
+		}
+	}
+
+	internals->prog_fd = af_xdp_prog_load(internals->map_fd);
+	if (internals->prog_fd < 0) {
+		RTE_LOG(ERR, PMD, "%s: cannot load XDP program: %s\n",
+			name, strerror(errno));
+		goto error;
+	}
+
+	if (af_xdp_link_set(internals->if_index, internals->prog_fd,
+			    internals->xdp_flags |
+			    XDP_FLAGS_UPDATE_IF_NOEXIST) < 0) {
+		RTE_LOG(ERR, PMD, "%s: cannot attach XDP program to %s: %s\n",
+			name, if_name, strerror(errno));
+		close(internals->prog_fd);
+		internals->prog_fd = -1;
+		goto error;
+	}
+
+	/* reserve an ethdev entry */
+	eth_dev = rte_eth_vdev_allocate(dev, 0);
+	if (eth_dev == NULL)
+		goto error;
+
+	rte_memcpy(data, eth_dev->data, sizeof(*data));
+	data->dev_private = internals;
+	data->nb_rx_queues = (uint16_t)nb_queues;
+	data->nb_tx_queues = (uint16_t)nb_queues;
+	data->dev_link = pmd_link;
+	data->mac_addrs = &internals->eth_addr;
+
+	eth_dev->data = data;
+	eth_dev->dev_ops = &ops;
+	eth_dev->data->dev_flags = RTE_ETH_DEV_DETACHABLE;
+	eth_dev->rx_pkt_burst = eth_af_xdp_rx;
+	eth_dev->tx_pkt_burst = eth_af_xdp_tx;
+
+	return 0;
+
+error:
+	af_xdp_prog_detach(internals);
+	af_xdp_queues_release(internals);
+	if (internals->map_fd != -1)
+		close(internals->map_fd);
+	rte_free(internals);
+	rte_free(data);
+	return -1;
+}
+
+static int
+rte_pmd_af_xdp_probe(struct rte_vdev_device *dev)
+{
+	const char *name = rte_vdev_device_name(dev);
+	char if_name[IFNAMSIZ] = "";
+	unsigned int start_queue = 0;
+	unsigned int queue_count = 1;
+	unsigned int skb_mode = 0;
+	struct rte_kvargs *kvlist;
+	int ret = -1;
+
+	RTE_LOG(INFO, PMD, "Initializing pmd_af_xdp for %s\n", name);
+
+	kvlist = rte_kvargs_parse(rte_vdev_device_args(dev), valid_arguments);
+	if (kvlist == NULL)
+		return -1;
+
+	if (rte_kvargs_count(kvlist, ETH_AF_XDP_IFACE_ARG) != 1) {
+		RTE_LOG(ERR, PMD,
+			"%s: no interface specified for AF_XDP ethdev\n", name);
+		goto exit;
+	}
+
+	if (rte_kvargs_process(kvlist, ETH_AF_XDP_IFACE_ARG,
+			       &set_iface, if_name) < 0 ||
+	    rte_kvargs_process(kvlist, ETH_AF_XDP_START_QUEUE_ARG,
+			       &set_uint, &start_queue) < 0 ||
+	    rte_kvargs_process(kvlist, ETH_AF_XDP_QUEUE_COUNT_ARG,
+			       &set_uint, &queue_count) < 0 ||
+	    rte_kvargs_process(kvlist, ETH_AF_XDP_SKB_MODE_ARG,
+			       &set_uint, &skb_mode) < 0) {
+		RTE_LOG(ERR, PMD, "%s: invalid AF_XDP parameters\n", name);
+		goto exit;
+	}
+
+	if (queue_count < 1 || queue_count > ETH_AF_XDP_MAX_QUEUE_PAIRS) {
+		RTE_LOG(ERR, PMD, "%s: invalid queue_count value\n", name);
+		goto exit;
+	}
+
+	if (dev->device.numa_node == SOCKET_ID_ANY)
+		dev->device.numa_node = rte_socket_id();
+
+	ret = rte_eth_from_xdp(dev, if_name, start_queue, queue_count,
+			       skb_mode);
+
+exit:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
+static int
+rte_pmd_af_xdp_remove(struct rte_vdev_device *dev)
+{
+	struct rte_eth_dev *eth_dev = NULL;
+	struct pmd_internals *internals;
+
+	RTE_LOG(INFO, PMD, "Closing AF_XDP ethdev on numa socket %u\n",
+			rte_socket_id());
+
+	if (dev == NULL)
+		return -1;
+
+	/* find the ethdev entry */
+	eth_dev = rte_eth_dev_allocated(rte_vdev_device_name(dev));
+	if (eth_dev == NULL)
+		return -1;
+
+	internals = eth_dev->data->dev_private;
+	af_xdp_prog_detach(internals);
+	af_xdp_queues_release(internals);
+	close(internals->map_fd);
+
+	rte_free(eth_dev->data->dev_private);
+	rte_free(eth_dev->data);
+
+	rte_eth_dev_release_port(eth_dev);
+
+	return 0;
+}
+
+static struct rte_vdev_driver pmd_af_xdp_drv = {
+	.probe = rte_pmd_af_xdp_probe,
+	.remove = rte_pmd_af_xdp_remove,
+};
+
+RTE_PMD_REGISTER_VDEV(net_af_xdp, pmd_af_xdp_drv);
+RTE_PMD_REGISTER_PARAM_STRING(net_af_xdp,
+	"iface=<string> "
+	"start_queue=<int> "
+	"queue_count=<int> "
+	"skb_mode=<0|1>");
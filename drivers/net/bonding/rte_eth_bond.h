@@ -116,6 +116,8 @@ extern "C" {
 /**< Layer 2+3 (Ethernet MAC + IP Addresses) transmit load balancing */
 #define BALANCE_XMIT_POLICY_LAYER34		(2)
 /**< Layer 3+4 (IP Addresses + UDP Ports) transmit load balancing */
+#define BALANCE_XMIT_POLICY_RSS			(3)
+/**< RSS hash computed on reception, or layer 3+4 if there is none */
 
 /**
  * Create a bonded rte_eth_dev device
@@ -740,6 +740,54 @@ link_speed_key(uint16_t speed) {
 	return key_speed;
 }
 
+/* Pass the slow frames received on the dedicated Rx queue of a slave to the
+ * state machines, as the Rx burst does without dedicated queues. */
+static void
+bond_mode_8023ad_dedicated_rx(struct bond_dev_private *internals,
+		uint8_t slave_id)
+{
+	const uint16_t ether_type_slow_be = rte_be_to_cpu_16(ETHER_TYPE_SLOW);
+	struct rte_mbuf *pkts[BOND_8023AD_DEDICATED_RX_BURST];
+	struct ether_hdr *hdr;
+	uint16_t i, nb_rx;
+
+	nb_rx = rte_eth_rx_burst(slave_id, internals->mode4.dedicated_queues.rx_qid,
+			pkts, RTE_DIM(pkts));
+
+	for (i = 0; i < nb_rx; i++) {
+		hdr = rte_pktmbuf_mtod(pkts[i], struct ether_hdr *);
+		if (hdr->ether_type == ether_type_slow_be &&
+				pkts[i]->vlan_tci == 0)
+			bond_mode_8023ad_handle_slow_pkt(internals, slave_id, pkts[i]);
+		else
+			rte_pktmbuf_free(pkts[i]);
+	}
+}
+
+/* Send the slow frames queued for a slave on its dedicated Tx queue */
+static void
+bond_mode_8023ad_dedicated_tx(struct bond_dev_private *internals,
+		uint8_t slave_id)
+{
+	struct port *port = &mode_8023ad_ports[slave_id];
+	struct rte_mbuf *pkts[BOND_MODE_8023AX_SLAVE_TX_PKTS + 1];
+	uint16_t nb_pkts, nb_tx;
+
+	nb_pkts = rte_ring_dequeue_burst(port->tx_ring, (void **)pkts,
+			RTE_DIM(pkts), NULL);
+	if (nb_pkts == 0)
+		return;
+
+	nb_tx = rte_eth_tx_burst(slave_id,
+			internals->mode4.dedicated_queues.tx_qid, pkts, nb_pkts);
+
+	if (unlikely(nb_tx < nb_pkts)) {
+		set_warning_flags(port, WRN_TX_QUEUE_FULL);
+		for ( ; nb_tx < nb_pkts; nb_tx++)
+			rte_pktmbuf_free(pkts[nb_tx]);
+	}
+}
+
 static void
 bond_mode_8023ad_periodic_cb(void *arg)
 {
@@ -750,14 +798,16 @@ bond_mode_8023ad_periodic_cb(void *arg)
 	struct ether_addr slave_addr;
 
 	void *pkt = NULL;
-	uint8_t i, slave_id;
+	uint8_t slaves[RTE_MAX_ETHPORTS];
+	uint8_t i, slave_count, slave_id;
 
+	slave_count = bond_active_slaves_get(internals, slaves);
 
 	/* Update link status on each port */
-	for (i = 0; i < internals->active_slave_count; i++) {
+	for (i = 0; i < slave_count; i++) {
 		uint16_t key;
 
-		slave_id = internals->active_slaves[i];
+		slave_id = slaves[i];
 		rte_eth_link_get(slave_id, &link_info);
 		rte_eth_macaddr_get(slave_id, &slave_addr);
 
@@ -786,10 +836,13 @@ bond_mode_8023ad_periodic_cb(void *arg)
 		}
 	}
 
-	for (i = 0; i < internals->active_slave_count; i++) {
-		slave_id = internals->active_slaves[i];
+	for (i = 0; i < slave_count; i++) {
+		slave_id = slaves[i];
 		port = &mode_8023ad_ports[slave_id];
 
+		if (internals->mode4.dedicated_queues.enabled)
+			bond_mode_8023ad_dedicated_rx(internals, slave_id);
+
 		if ((port->actor.key &
 				rte_cpu_to_be_16(BOND_LINK_FULL_DUPLEX_KEY)) == 0) {
 
@@ -829,6 +882,9 @@ bond_mode_8023ad_periodic_cb(void *arg)
 		tx_machine(internals, slave_id);
 		selection_logic(internals, slave_id);
 
+		if (internals->mode4.dedicated_queues.enabled)
+			bond_mode_8023ad_dedicated_tx(internals, slave_id);
+
 		SM_FLAG_CLR(port, BEGIN);
 		show_warnings(slave_id);
 	}
@@ -941,9 +997,9 @@ bond_mode_8023ad_deactivate_slave(struct rte_eth_dev *bond_dev,
 	struct port *port;
 	uint8_t i;
 
-	/* Given slave must be in active list */
+	/* Given slave must have been removed from the active list */
 	RTE_ASSERT(find_slave_by_id(internals->active_slaves,
-	internals->active_slave_count, slave_id) < internals->active_slave_count);
+	internals->active_slave_count, slave_id) == internals->active_slave_count);
 
 	/* Exclude slave from transmit policy. If this slave is an aggregator
 	 * make all aggregated slaves unselected to force selection logic
@@ -1480,12 +1536,21 @@ bond_mode_8023ad_ext_periodic_cb(void *arg)
 	struct mode8023ad_private *mode4 = &internals->mode4;
 	struct port *port;
 	void *pkt = NULL;
+	uint8_t slaves[RTE_MAX_ETHPORTS];
+	uint8_t slave_count;
 	uint16_t i, slave_id;
 
-	for (i = 0; i < internals->active_slave_count; i++) {
-		slave_id = internals->active_slaves[i];
+	slave_count = bond_active_slaves_get(internals, slaves);
+
+	for (i = 0; i < slave_count; i++) {
+		slave_id = slaves[i];
 		port = &mode_8023ad_ports[slave_id];
 
+		if (mode4->dedicated_queues.enabled) {
+			bond_mode_8023ad_dedicated_rx(internals, slave_id);
+			bond_mode_8023ad_dedicated_tx(internals, slave_id);
+		}
+
 		if (rte_ring_dequeue(port->rx_ring, &pkt) == 0) {
 			struct rte_mbuf *lacp_pkt = pkt;
 			struct lacpdu_header *lacp;
@@ -1504,3 +1569,152 @@ bond_mode_8023ad_ext_periodic_cb(void *arg)
 	rte_eal_alarm_set(internals->mode4.update_timeout_us,
 			bond_mode_8023ad_ext_periodic_cb, arg);
 }
+
+int
+bond_mode_8023ad_slave_queues_setup(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id)
+{
+	struct bond_dev_private *internals = bond_dev->data->dev_private;
+	struct port *port = &mode_8023ad_ports[slave_id];
+	char mem_name[RTE_ETH_NAME_MAX_LEN];
+	int socket_id = rte_eth_dev_socket_id(slave_id);
+	int errval;
+
+	if (port->slow_pool == NULL) {
+		snprintf(mem_name, RTE_DIM(mem_name), "slave_port%u_slow_pool",
+				slave_id);
+		port->slow_pool = rte_pktmbuf_pool_create(mem_name,
+				BOND_8023AD_DEDICATED_POOL_SIZE,
+				RTE_MEMPOOL_CACHE_MAX_SIZE >= 32 ?
+					32 : RTE_MEMPOOL_CACHE_MAX_SIZE,
+				0, RTE_MBUF_DEFAULT_BUF_SIZE, socket_id);
+		if (port->slow_pool == NULL) {
+			RTE_BOND_LOG(ERR, "Slave %u: failed to create pool '%s': %s",
+					slave_id, mem_name, rte_strerror(rte_errno));
+			return -ENOMEM;
+		}
+	}
+
+	errval = rte_eth_rx_queue_setup(slave_id,
+			internals->mode4.dedicated_queues.rx_qid,
+			BOND_8023AD_DEDICATED_RXQ_DESC, socket_id, NULL,
+			port->slow_pool);
+	if (errval != 0) {
+		RTE_BOND_LOG(ERR, "Slave %u: cannot set up slow Rx queue %u, err (%d)",
+				slave_id, internals->mode4.dedicated_queues.rx_qid,
+				errval);
+		return errval;
+	}
+
+	errval = rte_eth_tx_queue_setup(slave_id,
+			internals->mode4.dedicated_queues.tx_qid,
+			BOND_8023AD_DEDICATED_TXQ_DESC, socket_id, NULL);
+	if (errval != 0) {
+		RTE_BOND_LOG(ERR, "Slave %u: cannot set up slow Tx queue %u, err (%d)",
+				slave_id, internals->mode4.dedicated_queues.tx_qid,
+				errval);
+		return errval;
+	}
+
+	return 0;
+}
+
+void
+bond_mode_8023ad_slave_flow_set(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id)
+{
+	struct bond_dev_private *internals = bond_dev->data->dev_private;
+	struct rte_flow_error error = {
+		.type = RTE_FLOW_ERROR_TYPE_NONE,
+	};
+
+	const struct rte_flow_attr attr = {
+		.ingress = 1,
+	};
+	const struct rte_flow_item_eth eth_spec = {
+		.type = rte_cpu_to_be_16(ETHER_TYPE_SLOW),
+	};
+	const struct rte_flow_item_eth eth_mask = {
+		.type = 0xFFFF,
+	};
+	const struct rte_flow_item pattern[] = {
+		{
+			.type = RTE_FLOW_ITEM_TYPE_ETH,
+			.spec = &eth_spec,
+			.mask = &eth_mask,
+		},
+		{
+			.type = RTE_FLOW_ITEM_TYPE_END,
+		},
+	};
+	const struct rte_flow_action_queue queue = {
+		.index = internals->mode4.dedicated_queues.rx_qid,
+	};
+	const struct rte_flow_action actions[] = {
+		{
+			.type = RTE_FLOW_ACTION_TYPE_QUEUE,
+			.conf = &queue,
+		},
+		{
+			.type = RTE_FLOW_ACTION_TYPE_END,
+		},
+	};
+
+	bond_mode_8023ad_slave_flow_destroy(bond_dev, slave_id);
+
+	if (rte_flow_validate(slave_id, &attr, pattern, actions, &error) == 0)
+		internals->mode4.dedicated_queues.flow[slave_id] =
+			rte_flow_create(slave_id, &attr, pattern, actions, &error);
+
+	if (internals->mode4.dedicated_queues.flow[slave_id] == NULL)
+		RTE_BOND_LOG(INFO, "Slave %u: slow frames are not steered to "
+				"queue %u, filtering them in software: %s", slave_id,
+				queue.index, error.message ? error.message : "");
+}
+
+void
+bond_mode_8023ad_slave_flow_destroy(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id)
+{
+	struct bond_dev_private *internals = bond_dev->data->dev_private;
+	struct rte_flow **flow = &internals->mode4.dedicated_queues.flow[slave_id];
+	struct rte_flow_error error;
+
+	if (*flow == NULL)
+		return;
+
+	rte_flow_destroy(slave_id, *flow, &error);
+	*flow = NULL;
+}
+
+static int
+bond_8023ad_dedicated_queues_set(uint8_t port_id, uint8_t enabled)
+{
+	struct rte_eth_dev *bond_dev;
+	struct bond_dev_private *internals;
+
+	if (valid_bonded_port_id(port_id) != 0)
+		return -EINVAL;
+
+	bond_dev = &rte_eth_devices[port_id];
+	internals = bond_dev->data->dev_private;
+
+	/* Slave queues can only be changed when they are configured */
+	if (bond_dev->data->dev_started)
+		return -EBUSY;
+
+	internals->mode4.dedicated_queues.enabled = enabled;
+	return 0;
+}
+
+int
+rte_eth_bond_8023ad_dedicated_queues_enable(uint8_t port_id)
+{
+	return bond_8023ad_dedicated_queues_set(port_id, 1);
+}
+
+int
+rte_eth_bond_8023ad_dedicated_queues_disable(uint8_t port_id)
+{
+	return bond_8023ad_dedicated_queues_set(port_id, 0);
+}
@@ -302,4 +302,36 @@ int
 rte_eth_bond_8023ad_ext_slowtx(uint8_t port_id, uint8_t slave_id,
 		struct rte_mbuf *lacp_pkt);
 
+/**
+ * Enable the slave queues dedicated to the slow protocol frames (LACP and
+ * marker). Each slave is then configured with one Rx and one Tx queue more
+ * than the bonded device, used by the mode 4 periodic callback to exchange
+ * these frames instead of the Rx and Tx bursts of the bonded device. The
+ * slow frames received by slaves which cannot steer them to their
+ * dedicated Rx queue with a flow rule are still filtered by the Rx burst.
+ *
+ * The bonded device must be stopped.
+ *
+ * @param port_id	Bonding device id
+ *
+ * @return
+ *   0 on success, negative value otherwise.
+ */
+int
+rte_eth_bond_8023ad_dedicated_queues_enable(uint8_t port_id);
+
+/**
+ * Disable the slave queues dedicated to the slow protocol frames, which
+ * are then exchanged by the Rx and Tx bursts of the bonded device.
+ *
+ * The bonded device must be stopped.
+ *
+ * @param port_id	Bonding device id
+ *
+ * @return
+ *   0 on success, negative value otherwise.
+ */
+int
+rte_eth_bond_8023ad_dedicated_queues_disable(uint8_t port_id);
+
 #endif /* RTE_ETH_BOND_8023AD_H_ */
@@ -39,6 +39,7 @@
 #include <rte_ether.h>
 #include <rte_byteorder.h>
 #include <rte_atomic.h>
+#include <rte_flow.h>
 
 #include "rte_eth_bond_8023ad.h"
 
@@ -66,6 +67,15 @@
  */
 #define BOND_8023AD_WARNINGS_PERIOD_MS             1000
 
+/** Number of descriptors of the dedicated slow protocol Rx queue */
+#define BOND_8023AD_DEDICATED_RXQ_DESC              128
+/** Number of descriptors of the dedicated slow protocol Tx queue */
+#define BOND_8023AD_DEDICATED_TXQ_DESC              512
+/** Number of mbufs of the dedicated slow protocol Rx queue pool */
+#define BOND_8023AD_DEDICATED_POOL_SIZE             1023
+/** Maximum number of packets read at once on the dedicated Rx queue */
+#define BOND_8023AD_DEDICATED_RX_BURST                8
+
 
 
 /**
@@ -155,6 +165,9 @@ struct port {
 	/** Ring of slow protocol packets (LACP and MARKERS) to TX burst function */
 	struct rte_ring *tx_ring;
 
+	/** Memory pool of the dedicated slow protocol Rx queue */
+	struct rte_mempool *slow_pool;
+
 	/** Timer which is also used as mutex. If is 0 (not running) RX marker
 	 * packet might be responded. Otherwise shall be dropped. It is zeroed in
 	 * mode 4 callback function after expire. */
@@ -175,6 +188,19 @@ struct mode8023ad_private {
 	uint64_t update_timeout_us;
 	rte_eth_bond_8023ad_ext_slowrx_fn slowrx_cb;
 	uint8_t external_sm;
+
+	/** Slave queues dedicated to the slow protocol frames */
+	struct {
+		uint8_t enabled;
+		/**< Non-zero if slow frames use the dedicated queues */
+		uint16_t rx_qid;
+		/**< Slave Rx queue receiving the slow frames */
+		uint16_t tx_qid;
+		/**< Slave Tx queue sending the slow frames */
+		struct rte_flow *flow[RTE_MAX_ETHPORTS];
+		/**< Flow steering the slow frames of each slave to rx_qid, NULL
+		 * if the Rx burst has to filter them in software */
+	} dedicated_queues;
 };
 
 /**
@@ -295,4 +321,16 @@ bond_mode_8023ad_deactivate_slave(struct rte_eth_dev *dev, uint8_t slave_pos);
 void
 bond_mode_8023ad_mac_address_update(struct rte_eth_dev *bond_dev);
 
+int
+bond_mode_8023ad_slave_queues_setup(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id);
+
+void
+bond_mode_8023ad_slave_flow_set(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id);
+
+void
+bond_mode_8023ad_slave_flow_destroy(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id);
+
 #endif /* RTE_ETH_BOND_8023AD_H_ */
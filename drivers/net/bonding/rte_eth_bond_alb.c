@@ -50,11 +50,18 @@ simple_hash(uint8_t *hash_start, int hash_size)
 static uint8_t
 calculate_slave(struct bond_dev_private *internals)
 {
+	uint8_t slaves[RTE_MAX_ETHPORTS];
+	uint8_t slave_count;
 	uint8_t idx;
 
-	idx = (internals->mode6.last_slave + 1) % internals->active_slave_count;
+	/* The last active slave can go down while the data path runs */
+	slave_count = bond_active_slaves_get(internals, slaves);
+	if (slave_count < 1)
+		return internals->current_primary_port;
+
+	idx = (internals->mode6.last_slave + 1) % slave_count;
 	internals->mode6.last_slave = idx;
-	return internals->active_slaves[idx];
+	return slaves[idx];
 }
 
 int
@@ -94,6 +94,7 @@ activate_slave(struct rte_eth_dev *eth_dev, uint8_t port_id)
 
 	internals->active_slaves[internals->active_slave_count] = port_id;
 	internals->active_slave_count++;
+	bond_active_slaves_publish(internals);
 
 	if (internals->mode == BONDING_MODE_TLB)
 		bond_tlb_activate_slave(internals);
@@ -108,10 +109,9 @@ deactivate_slave(struct rte_eth_dev *eth_dev, uint8_t port_id)
 	struct bond_dev_private *internals = eth_dev->data->dev_private;
 	uint8_t active_count = internals->active_slave_count;
 
-	if (internals->mode == BONDING_MODE_8023AD) {
+	if (internals->mode == BONDING_MODE_8023AD)
 		bond_mode_8023ad_stop(eth_dev);
-		bond_mode_8023ad_deactivate_slave(eth_dev, port_id);
-	} else if (internals->mode == BONDING_MODE_TLB
+	else if (internals->mode == BONDING_MODE_TLB
 			|| internals->mode == BONDING_MODE_ALB)
 		bond_tlb_disable(internals);
 
@@ -130,6 +130,13 @@ deactivate_slave(struct rte_eth_dev *eth_dev, uint8_t port_id)
 
 	RTE_ASSERT(active_count < RTE_DIM(internals->active_slaves));
 	internals->active_slave_count = active_count;
+	bond_active_slaves_publish(internals);
+
+	/* Wait for the bursts still using the slave before tearing it down */
+	bond_ethdev_quiesce(eth_dev);
+
+	if (internals->mode == BONDING_MODE_8023AD)
+		bond_mode_8023ad_deactivate_slave(eth_dev, port_id);
 
 	if (eth_dev->data->dev_started) {
 		if (internals->mode == BONDING_MODE_8023AD) {
@@ -435,6 +442,9 @@ __eth_bond_slave_remove_lock_free(uint8_t bonded_port_id, uint8_t slave_port_id)
 			bond_ethdev_lsc_event_callback,
 			&rte_eth_devices[bonded_port_id].data->port_id);
 
+	/* Stop steering the slow frames to the dedicated queue of the slave */
+	bond_mode_8023ad_slave_flow_destroy(bonded_eth_dev, slave_port_id);
+
 	/* Restore original MAC address of slave device */
 	mac_address_set(&rte_eth_devices[slave_port_id],
 			&(internals->slaves[slave_idx].persisted_mac_addr));
@@ -670,15 +680,19 @@ rte_eth_bond_xmit_policy_set(uint8_t bonded_port_id, uint8_t policy)
 	switch (policy) {
 	case BALANCE_XMIT_POLICY_LAYER2:
 		internals->balance_xmit_policy = policy;
-		internals->xmit_hash = xmit_l2_hash;
+		internals->burst_xmit_hash = burst_xmit_l2_hash;
 		break;
 	case BALANCE_XMIT_POLICY_LAYER23:
 		internals->balance_xmit_policy = policy;
-		internals->xmit_hash = xmit_l23_hash;
+		internals->burst_xmit_hash = burst_xmit_l23_hash;
 		break;
 	case BALANCE_XMIT_POLICY_LAYER34:
 		internals->balance_xmit_policy = policy;
-		internals->xmit_hash = xmit_l34_hash;
+		internals->burst_xmit_hash = burst_xmit_l34_hash;
+		break;
+	case BALANCE_XMIT_POLICY_RSS:
+		internals->balance_xmit_policy = policy;
+		internals->burst_xmit_hash = burst_xmit_rss_hash;
 		break;
 
 	default:
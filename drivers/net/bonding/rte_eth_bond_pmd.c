@@ -56,6 +56,9 @@
 
 #define HASH_L4_PORTS(h) ((h)->src_port ^ (h)->dst_port)
 
+/* Distance, in packets, of the headers prefetched by the burst hashes */
+#define BOND_XMIT_HASH_PREFETCH_OFFSET 3
+
 /* Table for statistics in mode 5 TLB */
 static uint64_t tlb_last_obytets[RTE_MAX_ETHPORTS];
 
@@ -80,13 +83,15 @@ get_vlan_offset(struct ether_hdr *eth_hdr, uint16_t *proto)
 }
 
 static uint16_t
-bond_ethdev_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+bond_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	struct bond_dev_private *internals;
 
 	uint16_t num_rx_slave = 0;
 	uint16_t num_rx_total = 0;
 
+	uint8_t slaves[RTE_MAX_ETHPORTS];
+	uint8_t slave_count;
 	int i;
 
 	/* Cast to structure, containing bonded device's port id and queue id */
@@ -94,11 +99,12 @@ bond_ethdev_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	internals = bd_rx_q->dev_private;
 
+	slave_count = bond_active_slaves_get(internals, slaves);
 
-	for (i = 0; i < internals->active_slave_count && nb_pkts; i++) {
+	for (i = 0; i < slave_count && nb_pkts; i++) {
 		/* Offset of pointer to *bufs increases as packets are received
 		 * from other slaves */
-		num_rx_slave = rte_eth_rx_burst(internals->active_slaves[i],
+		num_rx_slave = rte_eth_rx_burst(slaves[i],
 				bd_rx_q->queue_id, bufs + num_rx_total, nb_pkts);
 		if (num_rx_slave) {
 			num_rx_total += num_rx_slave;
@@ -109,19 +115,44 @@ bond_ethdev_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_rx_total;
 }
 
+/* Return the slave used in active backup mode, or RTE_MAX_ETHPORTS if there
+ * is none. The primary port is updated after the active slaves, so it is
+ * replaced by the first active slave until it is consistent with them. */
+static inline uint8_t
+bond_active_backup_port(struct bond_dev_private *internals)
+{
+	uint8_t slaves[RTE_MAX_ETHPORTS];
+	uint8_t slave_count;
+	uint8_t primary;
+
+	slave_count = bond_active_slaves_get(internals, slaves);
+	if (slave_count < 1)
+		return RTE_MAX_ETHPORTS;
+
+	primary = internals->current_primary_port;
+	if (find_slave_by_id(slaves, slave_count, primary) == slave_count)
+		primary = slaves[0];
+
+	return primary;
+}
+
 static uint16_t
-bond_ethdev_rx_burst_active_backup(void *queue, struct rte_mbuf **bufs,
+bond_rx_burst_active_backup(void *queue, struct rte_mbuf **bufs,
 		uint16_t nb_pkts)
 {
 	struct bond_dev_private *internals;
+	uint8_t primary;
 
 	/* Cast to structure, containing bonded device's port id and queue id */
 	struct bond_rx_queue *bd_rx_q = (struct bond_rx_queue *)queue;
 
 	internals = bd_rx_q->dev_private;
 
-	return rte_eth_rx_burst(internals->current_primary_port,
-			bd_rx_q->queue_id, bufs, nb_pkts);
+	primary = bond_active_backup_port(internals);
+	if (primary == RTE_MAX_ETHPORTS)
+		return 0;
+
+	return rte_eth_rx_burst(primary, bd_rx_q->queue_id, bufs, nb_pkts);
 }
 
 static inline uint8_t
@@ -134,7 +165,7 @@ is_lacp_packets(uint16_t ethertype, uint8_t subtype, uint16_t vlan_tci)
 }
 
 static uint16_t
-bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
+bond_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 		uint16_t nb_pkts)
 {
 	/* Cast to structure, containing bonded device's port id and queue id */
@@ -150,6 +181,7 @@ bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 	uint8_t slave_count, idx;
 
 	uint8_t collecting;  /* current slave collecting status */
+	uint8_t steered;  /* slow frames are steered to a dedicated queue */
 	const uint8_t promisc = internals->promiscuous_en;
 	uint8_t i, j, k;
 	uint8_t subtype;
@@ -157,9 +189,7 @@ bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 	rte_eth_macaddr_get(internals->port_id, &bond_mac);
 	/* Copy slave list to protect against slave up/down changes during tx
 	 * bursting */
-	slave_count = internals->active_slave_count;
-	memcpy(slaves, internals->active_slaves,
-			sizeof(internals->active_slaves[0]) * slave_count);
+	slave_count = bond_active_slaves_get(internals, slaves);
 
 	idx = internals->active_slave;
 	if (idx >= slave_count) {
@@ -171,10 +201,20 @@ bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 		collecting = ACTOR_STATE(&mode_8023ad_ports[slaves[idx]],
 					 COLLECTING);
 
+		steered = internals->mode4.dedicated_queues.flow[slaves[idx]] !=
+				NULL;
+
 		/* Read packets from this slave */
 		num_rx_total += rte_eth_rx_burst(slaves[idx], bd_rx_q->queue_id,
 				&bufs[num_rx_total], nb_pkts - num_rx_total);
 
+		/* Nothing to filter if the slow frames can't be received here */
+		if (likely(steered && collecting && promisc)) {
+			if (unlikely(++idx == slave_count))
+				idx = 0;
+			continue;
+		}
+
 		for (k = j; k < 2 && k < num_rx_total; k++)
 			rte_prefetch0(rte_pktmbuf_mtod(bufs[k], void *));
 
@@ -189,7 +229,8 @@ bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 			/* Remove packet from array if it is slow packet or slave is not
 			 * in collecting state or bondign interface is not in promiscus
 			 * mode and packet address does not match. */
-			if (unlikely(is_lacp_packets(hdr->ether_type, subtype, bufs[j]->vlan_tci) ||
+			if (unlikely((!steered && is_lacp_packets(hdr->ether_type,
+					subtype, bufs[j]->vlan_tci)) ||
 				!collecting || (!promisc &&
 					!is_multicast_ether_addr(&hdr->d_addr) &&
 					!is_same_ether_addr(&bond_mac, &hdr->d_addr)))) {
@@ -377,16 +418,16 @@ mode6_debug(const char __attribute__((unused)) *info, struct ether_hdr *eth_h,
 #endif
 
 static uint16_t
-bond_ethdev_rx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+bond_rx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
-	struct bond_tx_queue *bd_tx_q = (struct bond_tx_queue *)queue;
-	struct bond_dev_private *internals = bd_tx_q->dev_private;
+	struct bond_rx_queue *bd_rx_q = (struct bond_rx_queue *)queue;
+	struct bond_dev_private *internals = bd_rx_q->dev_private;
 	struct ether_hdr *eth_h;
 	uint16_t ether_type, offset;
 	uint16_t nb_recv_pkts;
 	int i;
 
-	nb_recv_pkts = bond_ethdev_rx_burst(queue, bufs, nb_pkts);
+	nb_recv_pkts = bond_rx_burst(queue, bufs, nb_pkts);
 
 	for (i = 0; i < nb_recv_pkts; i++) {
 		eth_h = rte_pktmbuf_mtod(bufs[i], struct ether_hdr *);
@@ -409,7 +450,7 @@ bond_ethdev_rx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 }
 
 static uint16_t
-bond_ethdev_tx_burst_round_robin(void *queue, struct rte_mbuf **bufs,
+bond_tx_burst_round_robin(void *queue, struct rte_mbuf **bufs,
 		uint16_t nb_pkts)
 {
 	struct bond_dev_private *internals;
@@ -431,9 +472,7 @@ bond_ethdev_tx_burst_round_robin(void *queue, struct rte_mbuf **bufs,
 
 	/* Copy slave list to protect against slave up/down changes during tx
 	 * bursting */
-	num_of_slaves = internals->active_slave_count;
-	memcpy(slaves, internals->active_slaves,
-			sizeof(internals->active_slaves[0]) * num_of_slaves);
+	num_of_slaves = bond_active_slaves_get(internals, slaves);
 
 	if (num_of_slaves < 1)
 		return num_tx_total;
@@ -472,20 +511,21 @@ bond_ethdev_tx_burst_round_robin(void *queue, struct rte_mbuf **bufs,
 }
 
 static uint16_t
-bond_ethdev_tx_burst_active_backup(void *queue,
+bond_tx_burst_active_backup(void *queue,
 		struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	struct bond_dev_private *internals;
 	struct bond_tx_queue *bd_tx_q;
+	uint8_t primary;
 
 	bd_tx_q = (struct bond_tx_queue *)queue;
 	internals = bd_tx_q->dev_private;
 
-	if (internals->active_slave_count < 1)
+	primary = bond_active_backup_port(internals);
+	if (primary == RTE_MAX_ETHPORTS)
 		return 0;
 
-	return rte_eth_tx_burst(internals->current_primary_port, bd_tx_q->queue_id,
-			bufs, nb_pkts);
+	return rte_eth_tx_burst(primary, bd_tx_q->queue_id, bufs, nb_pkts);
 }
 
 static inline uint16_t
@@ -521,25 +561,12 @@ ipv6_hash(struct ipv6_hdr *ipv6_hdr)
 			(word_src_addr[3] ^ word_dst_addr[3]);
 }
 
-uint16_t
-xmit_l2_hash(const struct rte_mbuf *buf, uint8_t slave_count)
-{
-	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(buf, struct ether_hdr *);
-
-	uint32_t hash = ether_hash(eth_hdr);
-
-	return (hash ^= hash >> 8) % slave_count;
-}
-
-uint16_t
-xmit_l23_hash(const struct rte_mbuf *buf, uint8_t slave_count)
+static inline uint32_t
+l23_hash(struct ether_hdr *eth_hdr)
 {
-	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(buf, struct ether_hdr *);
 	uint16_t proto = eth_hdr->ether_type;
 	size_t vlan_offset = get_vlan_offset(eth_hdr, &proto);
-	uint32_t hash, l3hash = 0;
-
-	hash = ether_hash(eth_hdr);
+	uint32_t l3hash = 0;
 
 	if (rte_cpu_to_be_16(ETHER_TYPE_IPv4) == proto) {
 		struct ipv4_hdr *ipv4_hdr = (struct ipv4_hdr *)
@@ -552,23 +579,18 @@ xmit_l23_hash(const struct rte_mbuf *buf, uint8_t slave_count)
 		l3hash = ipv6_hash(ipv6_hdr);
 	}
 
-	hash = hash ^ l3hash;
-	hash ^= hash >> 16;
-	hash ^= hash >> 8;
-
-	return hash % slave_count;
+	return ether_hash(eth_hdr) ^ l3hash;
 }
 
-uint16_t
-xmit_l34_hash(const struct rte_mbuf *buf, uint8_t slave_count)
+static inline uint32_t
+l34_hash(struct ether_hdr *eth_hdr)
 {
-	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(buf, struct ether_hdr *);
 	uint16_t proto = eth_hdr->ether_type;
 	size_t vlan_offset = get_vlan_offset(eth_hdr, &proto);
 
 	struct udp_hdr *udp_hdr = NULL;
 	struct tcp_hdr *tcp_hdr = NULL;
-	uint32_t hash, l3hash = 0, l4hash = 0;
+	uint32_t l3hash = 0, l4hash = 0;
 
 	if (rte_cpu_to_be_16(ETHER_TYPE_IPv4) == proto) {
 		struct ipv4_hdr *ipv4_hdr = (struct ipv4_hdr *)
@@ -606,13 +628,104 @@ xmit_l34_hash(const struct rte_mbuf *buf, uint8_t slave_count)
 		}
 	}
 
-	hash = l3hash ^ l4hash;
+	return l3hash ^ l4hash;
+}
+
+static inline uint16_t
+hash_to_slave(uint32_t hash, uint8_t slave_count)
+{
 	hash ^= hash >> 16;
 	hash ^= hash >> 8;
 
 	return hash % slave_count;
 }
 
+/*
+ * The burst hash functions below select the output slave of each packet of
+ * a burst, prefetching the headers of the next packets while hashing the
+ * current one.
+ */
+void
+burst_xmit_l2_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	struct ether_hdr *eth_hdr;
+	uint32_t hash;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts && i < BOND_XMIT_HASH_PREFETCH_OFFSET; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(buf[i], void *));
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (i + BOND_XMIT_HASH_PREFETCH_OFFSET < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(buf[i +
+					BOND_XMIT_HASH_PREFETCH_OFFSET], void *));
+
+		eth_hdr = rte_pktmbuf_mtod(buf[i], struct ether_hdr *);
+		hash = ether_hash(eth_hdr);
+		slaves[i] = (hash ^= hash >> 8) % slave_count;
+	}
+}
+
+void
+burst_xmit_l23_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts && i < BOND_XMIT_HASH_PREFETCH_OFFSET; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(buf[i], void *));
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (i + BOND_XMIT_HASH_PREFETCH_OFFSET < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(buf[i +
+					BOND_XMIT_HASH_PREFETCH_OFFSET], void *));
+
+		slaves[i] = hash_to_slave(l23_hash(rte_pktmbuf_mtod(buf[i],
+				struct ether_hdr *)), slave_count);
+	}
+}
+
+void
+burst_xmit_l34_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts && i < BOND_XMIT_HASH_PREFETCH_OFFSET; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(buf[i], void *));
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (i + BOND_XMIT_HASH_PREFETCH_OFFSET < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(buf[i +
+					BOND_XMIT_HASH_PREFETCH_OFFSET], void *));
+
+		slaves[i] = hash_to_slave(l34_hash(rte_pktmbuf_mtod(buf[i],
+				struct ether_hdr *)), slave_count);
+	}
+}
+
+/*
+ * Use the RSS hash computed on reception when there is one, so that the
+ * packet headers do not have to be read, and the layer 3+4 hash otherwise.
+ */
+void
+burst_xmit_rss_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	uint32_t hash;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (likely(buf[i]->ol_flags & PKT_RX_RSS_HASH))
+			hash = buf[i]->hash.rss;
+		else
+			hash = l34_hash(rte_pktmbuf_mtod(buf[i],
+					struct ether_hdr *));
+		slaves[i] = hash_to_slave(hash, slave_count);
+	}
+}
+
 struct bwg_slave {
 	uint64_t bwg_left_int;
 	uint64_t bwg_left_remainder;
@@ -621,10 +734,13 @@ struct bwg_slave {
 
 void
 bond_tlb_activate_slave(struct bond_dev_private *internals) {
+	uint8_t slaves[RTE_MAX_ETHPORTS];
+	uint8_t slave_count;
 	int i;
 
-	for (i = 0; i < internals->active_slave_count; i++) {
-		tlb_last_obytets[internals->active_slaves[i]] = 0;
+	slave_count = bond_active_slaves_get(internals, slaves);
+	for (i = 0; i < slave_count; i++) {
+		tlb_last_obytets[slaves[i]] = 0;
 	}
 }
 
@@ -669,6 +785,7 @@ bond_ethdev_update_tlb_slave_cb(void *arg)
 	struct bond_dev_private *internals = arg;
 	struct rte_eth_stats slave_stats;
 	struct bwg_slave bwg_array[RTE_MAX_ETHPORTS];
+	uint8_t slaves[RTE_MAX_ETHPORTS];
 	uint8_t slave_count;
 	uint64_t tx_bytes;
 
@@ -681,8 +798,9 @@ bond_ethdev_update_tlb_slave_cb(void *arg)
 	if (internals->slave_update_idx >= REORDER_PERIOD_MS)
 		update_stats = 1;
 
-	for (i = 0; i < internals->active_slave_count; i++) {
-		slave_id = internals->active_slaves[i];
+	slave_count = bond_active_slaves_get(internals, slaves);
+	for (i = 0; i < slave_count; i++) {
+		slave_id = slaves[i];
 		rte_eth_stats_get(slave_id, &slave_stats);
 		tx_bytes = slave_stats.obytes - tlb_last_obytets[slave_id];
 		bandwidth_left(slave_id, tx_bytes,
@@ -697,7 +815,6 @@ bond_ethdev_update_tlb_slave_cb(void *arg)
 	if (update_stats == 1)
 		internals->slave_update_idx = 0;
 
-	slave_count = i;
 	qsort(bwg_array, slave_count, sizeof(bwg_array[0]), bandwidth_cmp);
 	for (i = 0; i < slave_count; i++)
 		internals->tlb_slaves_order[i] = bwg_array[i].slave;
@@ -707,7 +824,7 @@ bond_ethdev_update_tlb_slave_cb(void *arg)
 }
 
 static uint16_t
-bond_ethdev_tx_burst_tlb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+bond_tx_burst_tlb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	struct bond_tx_queue *bd_tx_q = (struct bond_tx_queue *)queue;
 	struct bond_dev_private *internals = bd_tx_q->dev_private;
@@ -717,16 +834,20 @@ bond_ethdev_tx_burst_tlb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	uint16_t num_tx_total = 0;
 	uint8_t i, j;
 
-	uint8_t num_of_slaves = internals->active_slave_count;
+	uint8_t num_of_slaves;
 	uint8_t slaves[RTE_MAX_ETHPORTS];
+	uint8_t active_slaves[RTE_MAX_ETHPORTS];
 
 	struct ether_hdr *ether_hdr;
 	struct ether_addr primary_slave_addr;
 	struct ether_addr active_slave_addr;
 
+	num_of_slaves = bond_active_slaves_get(internals, active_slaves);
 	if (num_of_slaves < 1)
 		return num_tx_total;
 
+	/* The order is rewritten by the update callback, it may still list
+	 * slaves which are no longer active */
 	memcpy(slaves, internals->tlb_slaves_order,
 				sizeof(internals->tlb_slaves_order[0]) * num_of_slaves);
 
@@ -739,6 +860,10 @@ bond_ethdev_tx_burst_tlb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	}
 
 	for (i = 0; i < num_of_slaves; i++) {
+		if (find_slave_by_id(active_slaves, num_of_slaves, slaves[i]) ==
+				num_of_slaves)
+			continue;
+
 		rte_eth_macaddr_get(slaves[i], &active_slave_addr);
 		for (j = num_tx_total; j < nb_pkts; j++) {
 			if (j + 3 < nb_pkts)
@@ -775,7 +900,7 @@ bond_tlb_enable(struct bond_dev_private *internals)
 }
 
 static uint16_t
-bond_ethdev_tx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+bond_tx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	struct bond_tx_queue *bd_tx_q = (struct bond_tx_queue *)queue;
 	struct bond_dev_private *internals = bd_tx_q->dev_private;
@@ -901,7 +1026,7 @@ bond_ethdev_tx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	/* Send non-ARP packets using tlb policy */
 	if (slave_bufs_pkts[RTE_MAX_ETHPORTS] > 0) {
-		num_send = bond_ethdev_tx_burst_tlb(queue,
+		num_send = bond_tx_burst_tlb(queue,
 				slave_bufs[RTE_MAX_ETHPORTS],
 				slave_bufs_pkts[RTE_MAX_ETHPORTS]);
 
@@ -917,7 +1042,7 @@ bond_ethdev_tx_burst_alb(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 }
 
 static uint16_t
-bond_ethdev_tx_burst_balance(void *queue, struct rte_mbuf **bufs,
+bond_tx_burst_balance(void *queue, struct rte_mbuf **bufs,
 		uint16_t nb_pkts)
 {
 	struct bond_dev_private *internals;
@@ -930,27 +1055,30 @@ bond_ethdev_tx_burst_balance(void *queue, struct rte_mbuf **bufs,
 
 	int i, op_slave_id;
 
-	struct rte_mbuf *slave_bufs[RTE_MAX_ETHPORTS][nb_pkts];
-	uint16_t slave_nb_pkts[RTE_MAX_ETHPORTS] = { 0 };
+	uint16_t bufs_slave_idx[nb_pkts];
 
 	bd_tx_q = (struct bond_tx_queue *)queue;
 	internals = bd_tx_q->dev_private;
 
 	/* Copy slave list to protect against slave up/down changes during tx
 	 * bursting */
-	num_of_slaves = internals->active_slave_count;
-	memcpy(slaves, internals->active_slaves,
-			sizeof(internals->active_slaves[0]) * num_of_slaves);
+	num_of_slaves = bond_active_slaves_get(internals, slaves);
 
 	if (num_of_slaves < 1)
 		return num_tx_total;
 
+	struct rte_mbuf *slave_bufs[num_of_slaves][nb_pkts];
+	uint16_t slave_nb_pkts[num_of_slaves];
+
+	memset(slave_nb_pkts, 0, sizeof(slave_nb_pkts));
+
+	/* Select the output slaves of the burst based on xmit policy */
+	internals->burst_xmit_hash(bufs, nb_pkts, num_of_slaves,
+			bufs_slave_idx);
+
 	/* Populate slaves mbuf with the packets which are to be sent on it  */
 	for (i = 0; i < nb_pkts; i++) {
-		/* Select output slave using hash based on xmit policy */
-		op_slave_id = internals->xmit_hash(bufs[i], num_of_slaves);
-
-		/* Populate slave mbuf arrays with mbufs for that slave */
+		op_slave_id = bufs_slave_idx[i];
 		slave_bufs[op_slave_id][slave_nb_pkts[op_slave_id]++] = bufs[i];
 	}
 
@@ -978,7 +1106,7 @@ bond_ethdev_tx_burst_balance(void *queue, struct rte_mbuf **bufs,
 }
 
 static uint16_t
-bond_ethdev_tx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
+bond_tx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 		uint16_t nb_pkts)
 {
 	struct bond_dev_private *internals;
@@ -994,33 +1122,38 @@ bond_ethdev_tx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 	uint16_t i, j, op_slave_idx;
 	const uint16_t buffs_size = nb_pkts + BOND_MODE_8023AX_SLAVE_TX_PKTS + 1;
 
-	/* Allocate additional packets in case 8023AD mode. */
-	struct rte_mbuf *slave_bufs[RTE_MAX_ETHPORTS][buffs_size];
 	void *slow_pkts[BOND_MODE_8023AX_SLAVE_TX_PKTS] = { NULL };
-
-	/* Total amount of packets in slave_bufs */
-	uint16_t slave_nb_pkts[RTE_MAX_ETHPORTS] = { 0 };
-	/* Slow packets placed in each slave */
-	uint8_t slave_slow_nb_pkts[RTE_MAX_ETHPORTS] = { 0 };
+	uint16_t bufs_slave_idx[nb_pkts];
+	uint8_t dedicated_queues;
 
 	bd_tx_q = (struct bond_tx_queue *)queue;
 	internals = bd_tx_q->dev_private;
+	dedicated_queues = internals->mode4.dedicated_queues.enabled;
 
 	/* Copy slave list to protect against slave up/down changes during tx
 	 * bursting */
-	num_of_slaves = internals->active_slave_count;
+	num_of_slaves = bond_active_slaves_get(internals, slaves);
 	if (num_of_slaves < 1)
 		return num_tx_total;
 
-	memcpy(slaves, internals->active_slaves, sizeof(slaves[0]) * num_of_slaves);
+	/* Allocate additional packets in case 8023AD mode. */
+	struct rte_mbuf *slave_bufs[num_of_slaves][buffs_size];
+	/* Total amount of packets in slave_bufs */
+	uint16_t slave_nb_pkts[num_of_slaves];
+	/* Slow packets placed in each slave */
+	uint8_t slave_slow_nb_pkts[num_of_slaves];
 
 	distributing_count = 0;
 	for (i = 0; i < num_of_slaves; i++) {
 		struct port *port = &mode_8023ad_ports[slaves[i]];
 
-		slave_slow_nb_pkts[i] = rte_ring_dequeue_burst(port->tx_ring,
-				slow_pkts, BOND_MODE_8023AX_SLAVE_TX_PKTS,
-				NULL);
+		/* Slow packets are sent by mode 4 on the dedicated queues */
+		if (dedicated_queues)
+			slave_slow_nb_pkts[i] = 0;
+		else
+			slave_slow_nb_pkts[i] = rte_ring_dequeue_burst(
+					port->tx_ring, slow_pkts,
+					BOND_MODE_8023AX_SLAVE_TX_PKTS, NULL);
 		slave_nb_pkts[i] = slave_slow_nb_pkts[i];
 
 		for (j = 0; j < slave_slow_nb_pkts[i]; j++)
@@ -1031,10 +1164,13 @@ bond_ethdev_tx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 	}
 
 	if (likely(distributing_count > 0)) {
+		/* Select the output slaves of the burst based on xmit policy */
+		internals->burst_xmit_hash(bufs, nb_pkts, distributing_count,
+				bufs_slave_idx);
+
 		/* Populate slaves mbuf with the packets which are to be sent on it */
 		for (i = 0; i < nb_pkts; i++) {
-			/* Select output slave using hash based on xmit policy */
-			op_slave_idx = internals->xmit_hash(bufs[i], distributing_count);
+			op_slave_idx = bufs_slave_idx[i];
 
 			/* Populate slave mbuf arrays with mbufs for that slave. Use only
 			 * slaves that are currently distributing. */
@@ -1071,7 +1207,7 @@ bond_ethdev_tx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 }
 
 static uint16_t
-bond_ethdev_tx_burst_broadcast(void *queue, struct rte_mbuf **bufs,
+bond_tx_burst_broadcast(void *queue, struct rte_mbuf **bufs,
 		uint16_t nb_pkts)
 {
 	struct bond_dev_private *internals;
@@ -1090,9 +1226,7 @@ bond_ethdev_tx_burst_broadcast(void *queue, struct rte_mbuf **bufs,
 
 	/* Copy slave list to protect against slave up/down changes during tx
 	 * bursting */
-	num_of_slaves = internals->active_slave_count;
-	memcpy(slaves, internals->active_slaves,
-			sizeof(internals->active_slaves[0]) * num_of_slaves);
+	num_of_slaves = bond_active_slaves_get(internals, slaves);
 
 	if (num_of_slaves < 1)
 		return 0;
@@ -1130,6 +1264,61 @@ bond_ethdev_tx_burst_broadcast(void *queue, struct rte_mbuf **bufs,
 	return max_nb_of_tx_pkts;
 }
 
+/*
+ * The bursts of the bonded device are wrapped to count them on their queue,
+ * see bond_ethdev_quiesce(). The burst functions above can call each other
+ * without being counted twice.
+ */
+#define BOND_BURST_FN(name, queue_type)					\
+static uint16_t								\
+bond_ethdev_##name(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts) \
+{									\
+	struct queue_type *bd_q = (struct queue_type *)queue;		\
+	uint16_t nb_burst;						\
+									\
+	bond_burst_begin(&bd_q->burst_seq);				\
+	nb_burst = bond_##name(queue, bufs, nb_pkts);			\
+	bond_burst_end(&bd_q->burst_seq);				\
+									\
+	return nb_burst;						\
+}
+
+BOND_BURST_FN(rx_burst, bond_rx_queue)
+BOND_BURST_FN(rx_burst_active_backup, bond_rx_queue)
+BOND_BURST_FN(rx_burst_8023ad, bond_rx_queue)
+BOND_BURST_FN(rx_burst_alb, bond_rx_queue)
+BOND_BURST_FN(tx_burst_round_robin, bond_tx_queue)
+BOND_BURST_FN(tx_burst_active_backup, bond_tx_queue)
+BOND_BURST_FN(tx_burst_tlb, bond_tx_queue)
+BOND_BURST_FN(tx_burst_alb, bond_tx_queue)
+BOND_BURST_FN(tx_burst_balance, bond_tx_queue)
+BOND_BURST_FN(tx_burst_8023ad, bond_tx_queue)
+BOND_BURST_FN(tx_burst_broadcast, bond_tx_queue)
+
+void
+bond_ethdev_quiesce(struct rte_eth_dev *bonded_eth_dev)
+{
+	struct rte_eth_dev_data *data = bonded_eth_dev->data;
+	struct bond_rx_queue *bd_rx_q;
+	struct bond_tx_queue *bd_tx_q;
+	uint16_t i;
+
+	/* Order the publication of the active slaves before the counters */
+	rte_smp_mb();
+
+	for (i = 0; i < data->nb_rx_queues; i++) {
+		bd_rx_q = data->rx_queues[i];
+		if (bd_rx_q != NULL)
+			bond_burst_wait(&bd_rx_q->burst_seq);
+	}
+
+	for (i = 0; i < data->nb_tx_queues; i++) {
+		bd_tx_q = data->tx_queues[i];
+		if (bd_tx_q != NULL)
+			bond_burst_wait(&bd_tx_q->burst_seq);
+	}
+}
+
 void
 link_properties_set(struct rte_eth_dev *bonded_eth_dev,
 		struct rte_eth_link *slave_dev_link)
@@ -1325,8 +1514,13 @@ int
 slave_configure(struct rte_eth_dev *bonded_eth_dev,
 		struct rte_eth_dev *slave_eth_dev)
 {
+	struct bond_dev_private *internals = bonded_eth_dev->data->dev_private;
 	struct bond_rx_queue *bd_rx_q;
 	struct bond_tx_queue *bd_tx_q;
+	uint16_t nb_rx_queues = bonded_eth_dev->data->nb_rx_queues;
+	uint16_t nb_tx_queues = bonded_eth_dev->data->nb_tx_queues;
+	const uint8_t dedicated_queues = internals->mode == BONDING_MODE_8023AD &&
+			internals->mode4.dedicated_queues.enabled;
 
 	int errval;
 	uint16_t q_id;
@@ -1334,6 +1528,12 @@ slave_configure(struct rte_eth_dev *bonded_eth_dev,
 	/* Stop slave */
 	rte_eth_dev_stop(slave_eth_dev->data->port_id);
 
+	/* Add the queues of the slow frames to the ones of the bonded device */
+	if (dedicated_queues) {
+		nb_rx_queues++;
+		nb_tx_queues++;
+	}
+
 	/* Enable interrupts on slave device if supported */
 	if (slave_eth_dev->data->dev_flags & RTE_ETH_DEV_INTR_LSC)
 		slave_eth_dev->data->dev_conf.intr_conf.lsc = 1;
@@ -1361,8 +1561,7 @@ slave_configure(struct rte_eth_dev *bonded_eth_dev,
 
 	/* Configure device */
 	errval = rte_eth_dev_configure(slave_eth_dev->data->port_id,
-			bonded_eth_dev->data->nb_rx_queues,
-			bonded_eth_dev->data->nb_tx_queues,
+			nb_rx_queues, nb_tx_queues,
 			&(slave_eth_dev->data->dev_conf));
 	if (errval != 0) {
 		RTE_BOND_LOG(ERR, "Cannot configure slave device: port %u , err (%d)",
@@ -1402,6 +1601,13 @@ slave_configure(struct rte_eth_dev *bonded_eth_dev,
 		}
 	}
 
+	if (dedicated_queues) {
+		errval = bond_mode_8023ad_slave_queues_setup(bonded_eth_dev,
+				slave_eth_dev->data->port_id);
+		if (errval != 0)
+			return errval;
+	}
+
 	/* Start device */
 	errval = rte_eth_dev_start(slave_eth_dev->data->port_id);
 	if (errval != 0) {
@@ -1410,12 +1616,13 @@ slave_configure(struct rte_eth_dev *bonded_eth_dev,
 		return -1;
 	}
 
+	if (dedicated_queues)
+		bond_mode_8023ad_slave_flow_set(bonded_eth_dev,
+				slave_eth_dev->data->port_id);
+
 	/* If RSS is enabled for bonding, synchronize RETA */
 	if (bonded_eth_dev->data->dev_conf.rxmode.mq_mode & ETH_MQ_RX_RSS) {
 		int i;
-		struct bond_dev_private *internals;
-
-		internals = bonded_eth_dev->data->dev_private;
 
 		for (i = 0; i < internals->slave_count; i++) {
 			if (internals->slaves[i].port_id == slave_eth_dev->data->port_id) {
@@ -1559,6 +1766,14 @@ bond_ethdev_start(struct rte_eth_dev *eth_dev)
 	if (internals->promiscuous_en)
 		bond_ethdev_promiscuous_enable(eth_dev);
 
+	/* Slow frames use the slave queues following those of the bonded device */
+	if (internals->mode4.dedicated_queues.enabled) {
+		internals->mode4.dedicated_queues.rx_qid =
+				eth_dev->data->nb_rx_queues;
+		internals->mode4.dedicated_queues.tx_qid =
+				eth_dev->data->nb_tx_queues;
+	}
+
 	/* Reconfigure each slave device if starting bonded device */
 	for (i = 0; i < internals->slave_count; i++) {
 		if (slave_configure(eth_dev,
@@ -1621,16 +1836,27 @@ void
 bond_ethdev_stop(struct rte_eth_dev *eth_dev)
 {
 	struct bond_dev_private *internals = eth_dev->data->dev_private;
+	uint8_t active_count = internals->active_slave_count;
 	uint8_t i;
 
+	/* Wait for the bursts to stop using the slaves before tearing them
+	 * down */
+	internals->active_slave_count = 0;
+	bond_active_slaves_publish(internals);
+	bond_ethdev_quiesce(eth_dev);
+
 	if (internals->mode == BONDING_MODE_8023AD) {
 		struct port *port;
 		void *pkt = NULL;
 
 		bond_mode_8023ad_stop(eth_dev);
 
+		for (i = 0; i < internals->slave_count; i++)
+			bond_mode_8023ad_slave_flow_destroy(eth_dev,
+					internals->slaves[i].port_id);
+
 		/* Discard all messages to/from mode 4 state machines */
-		for (i = 0; i < internals->active_slave_count; i++) {
+		for (i = 0; i < active_count; i++) {
 			port = &mode_8023ad_ports[internals->active_slaves[i]];
 
 			RTE_ASSERT(port->rx_ring != NULL);
@@ -1646,11 +1872,10 @@ bond_ethdev_stop(struct rte_eth_dev *eth_dev)
 	if (internals->mode == BONDING_MODE_TLB ||
 			internals->mode == BONDING_MODE_ALB) {
 		bond_tlb_disable(internals);
-		for (i = 0; i < internals->active_slave_count; i++)
+		for (i = 0; i < active_count; i++)
 			tlb_last_obytets[internals->active_slaves[i]] = 0;
 	}
 
-	internals->active_slave_count = 0;
 	internals->link_status_polling_enabled = 0;
 	for (i = 0; i < internals->slave_count; i++)
 		internals->slaves[i].last_link_status = 0;
@@ -2306,7 +2531,7 @@ bond_alloc(struct rte_vdev_device *dev, uint8_t mode)
 	internals->mode = BONDING_MODE_INVALID;
 	internals->current_primary_port = RTE_MAX_ETHPORTS + 1;
 	internals->balance_xmit_policy = BALANCE_XMIT_POLICY_LAYER2;
-	internals->xmit_hash = xmit_l2_hash;
+	internals->burst_xmit_hash = burst_xmit_l2_hash;
 	internals->user_defined_mac = 0;
 	internals->link_props_set = 0;
 
@@ -2752,7 +2977,7 @@ RTE_PMD_REGISTER_PARAM_STRING(net_bonding,
 	"slave=<ifc> "
 	"primary=<ifc> "
 	"mode=[0-6] "
-	"xmit_policy=[l2 | l23 | l34] "
+	"xmit_policy=[l2 | l23 | l34 | rss] "
 	"socket_id=<int> "
 	"mac=<mac addr> "
 	"lsc_poll_period_ms=<int> "
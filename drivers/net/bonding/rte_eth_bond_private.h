@@ -34,6 +34,9 @@
 #ifndef _RTE_ETH_BOND_PRIVATE_H_
 #define _RTE_ETH_BOND_PRIVATE_H_
 
+#include <string.h>
+
+#include <rte_atomic.h>
 #include <rte_ethdev.h>
 #include <rte_spinlock.h>
 #include <rte_bitmap.h>
@@ -55,6 +58,7 @@
 #define PMD_BOND_XMIT_POLICY_LAYER2_KVARG	("l2")
 #define PMD_BOND_XMIT_POLICY_LAYER23_KVARG	("l23")
 #define PMD_BOND_XMIT_POLICY_LAYER34_KVARG	("l34")
+#define PMD_BOND_XMIT_POLICY_RSS_KVARG		("rss")
 
 #define RTE_BOND_LOG(lvl, msg, ...)		\
 	RTE_LOG(lvl, PMD, "%s(%d) - " msg "\n", __func__, __LINE__, ##__VA_ARGS__)
@@ -77,6 +81,8 @@ struct bond_rx_queue {
 	/**< Copy of RX configuration structure for queue */
 	struct rte_mempool *mb_pool;
 	/**< Reference to mbuf pool to use for RX queue */
+	volatile uint32_t burst_seq;
+	/**< Burst sequence number, odd while a burst is in progress */
 };
 
 struct bond_tx_queue {
@@ -88,6 +94,8 @@ struct bond_tx_queue {
 	/**< Number of TX descriptors available for the queue */
 	struct rte_eth_txconf tx_conf;
 	/**< Copy of TX configuration structure for queue */
+	volatile uint32_t burst_seq;
+	/**< Burst sequence number, odd while a burst is in progress */
 };
 
 /** Bonded slave devices structure */
@@ -109,7 +117,17 @@ struct bond_slave_details {
 };
 
 
-typedef uint16_t (*xmit_hash_t)(const struct rte_mbuf *buf, uint8_t slave_count);
+/**
+ * Published copy of the active slave list, read by the data path without
+ * locking while the control path updates the other copy.
+ */
+struct bond_active_slave_list {
+	uint8_t count;				/**< Number of active slaves */
+	uint8_t slaves[RTE_MAX_ETHPORTS];	/**< Active slave list */
+};
+
+typedef void (*burst_xmit_hash_t)(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
 
 /** Link Bonding PMD device private configuration Structure */
 struct bond_dev_private {
@@ -124,9 +142,9 @@ struct bond_dev_private {
 	/**< Flag for whether primary port is user defined or not */
 
 	uint8_t balance_xmit_policy;
-	/**< Transmit policy - l2 / l23 / l34 for operation in balance mode */
-	xmit_hash_t xmit_hash;
-	/**< Transmit policy hash function */
+	/**< Transmit policy - l2 / l23 / l34 / rss for operation in balance mode */
+	burst_xmit_hash_t burst_xmit_hash;
+	/**< Transmit policy hash function, selecting the slaves of a burst */
 
 	uint8_t user_defined_mac;
 	/**< Flag for whether MAC address is user defined or not */
@@ -148,6 +166,11 @@ struct bond_dev_private {
 	uint8_t active_slave_count;		/**< Number of active slaves */
 	uint8_t active_slaves[RTE_MAX_ETHPORTS];	/**< Active slave list */
 
+	struct bond_active_slave_list active_list[2];
+	/**< Copies of the active slave list used by the data path */
+	volatile uint32_t active_list_gen;
+	/**< Generation of the active slave list, selecting the current copy */
+
 	uint8_t slave_count;			/**< Number of bonded slaves */
 	struct bond_slave_details slaves[RTE_MAX_ETHPORTS];
 	/**< Arary of bonded slaves details */
@@ -198,6 +221,78 @@ find_slave_by_id(uint8_t *slaves, uint8_t slaves_count, uint8_t slave_id) {
 	return pos;
 }
 
+/* Publish the active slave list to the data path. Readers keep using the
+ * previous copy until the new one is complete. A burst may still use the
+ * slaves of the previous list after it returns: bond_ethdev_quiesce() must
+ * be called before tearing down a slave removed from the list. */
+static inline void
+bond_active_slaves_publish(struct bond_dev_private *internals)
+{
+	uint32_t gen = internals->active_list_gen + 1;
+	struct bond_active_slave_list *list = &internals->active_list[gen & 1];
+
+	list->count = internals->active_slave_count;
+	memcpy(list->slaves, internals->active_slaves,
+			sizeof(list->slaves[0]) * list->count);
+
+	rte_smp_wmb();
+	internals->active_list_gen = gen;
+}
+
+/* Copy the active slave list published to the data path into slaves and
+ * return its size. The copy is retried if the list was updated while it was
+ * being read. */
+static inline uint8_t
+bond_active_slaves_get(struct bond_dev_private *internals, uint8_t *slaves)
+{
+	const struct bond_active_slave_list *list;
+	uint32_t gen;
+	uint8_t count;
+
+	do {
+		gen = internals->active_list_gen;
+		rte_smp_rmb();
+
+		list = &internals->active_list[gen & 1];
+		count = list->count;
+		memcpy(slaves, list->slaves, sizeof(slaves[0]) * count);
+
+		rte_smp_rmb();
+	} while (unlikely(gen != internals->active_list_gen));
+
+	return count;
+}
+
+/* Mark the start of a burst on a queue of the bonded device, before the
+ * active slaves are read. */
+static inline void
+bond_burst_begin(volatile uint32_t *burst_seq)
+{
+	*burst_seq = *burst_seq + 1;
+	rte_smp_mb();
+}
+
+/* Mark the end of a burst on a queue of the bonded device, once it is done
+ * with the slaves. */
+static inline void
+bond_burst_end(volatile uint32_t *burst_seq)
+{
+	rte_smp_mb();
+	*burst_seq = *burst_seq + 1;
+}
+
+/* Wait for the end of the burst in progress on a queue, if any. */
+static inline void
+bond_burst_wait(volatile uint32_t *burst_seq)
+{
+	uint32_t seq = *burst_seq;
+
+	if (seq & 1) {
+		while (*burst_seq == seq)
+			rte_pause();
+	}
+}
+
 int
 valid_port_id(uint8_t port_id);
 
@@ -250,14 +345,21 @@ void
 slave_add(struct bond_dev_private *internals,
 		struct rte_eth_dev *slave_eth_dev);
 
-uint16_t
-xmit_l2_hash(const struct rte_mbuf *buf, uint8_t slave_count);
+void
+burst_xmit_l2_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
 
-uint16_t
-xmit_l23_hash(const struct rte_mbuf *buf, uint8_t slave_count);
+void
+burst_xmit_l23_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
 
-uint16_t
-xmit_l34_hash(const struct rte_mbuf *buf, uint8_t slave_count);
+void
+burst_xmit_l34_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
+
+void
+burst_xmit_rss_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
 
 void
 bond_ethdev_primary_set(struct bond_dev_private *internals,
@@ -307,6 +409,9 @@ bond_tlb_activate_slave(struct bond_dev_private *internals);
 void
 bond_ethdev_stop(struct rte_eth_dev *eth_dev);
 
+void
+bond_ethdev_quiesce(struct rte_eth_dev *bonded_eth_dev);
+
 void
 bond_ethdev_close(struct rte_eth_dev *dev);
 
@@ -32,12 +32,19 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <net/if.h>
 
 #include <pcap.h>
 
+#include <rte_byteorder.h>
 #include <rte_cycles.h>
 #include <rte_ethdev.h>
 #include <rte_ethdev_vdev.h>
@@ -56,11 +63,20 @@
 #define ETH_PCAP_RX_IFACE_ARG "rx_iface"
 #define ETH_PCAP_TX_IFACE_ARG "tx_iface"
 #define ETH_PCAP_IFACE_ARG    "iface"
+#define ETH_PCAP_INFINITE_RX_ARG "infinite_rx"
+#define ETH_PCAP_RX_PACE_ARG  "rx_pace"
+#define ETH_PCAP_TX_BUF_SIZE_ARG "tx_buf_size"
 
 #define ETH_PCAP_ARG_MAXLEN	64
 
 #define RTE_PMD_PCAP_MAX_QUEUES 16
 
+/* Magic numbers of capture files with micro and nanosecond timestamps */
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+
+#define PCAP_REPLAY_TS_UNSET UINT64_MAX
+
 static char errbuf[PCAP_ERRBUF_SIZE];
 static unsigned char tx_pcap_data[RTE_ETH_PCAP_SNAPLEN];
 static struct timeval start_time;
@@ -73,8 +89,35 @@ struct queue_stat {
 	volatile unsigned long err_pkts;
 };
 
+/* Record header of a capture file, as stored in the file */
+struct pcap_file_rec {
+	uint32_t ts_sec;
+	uint32_t ts_frac;   /* microseconds or nanoseconds */
+	uint32_t caplen;
+	uint32_t len;
+};
+
+/*
+ * Capture file mapped in memory and replayed without libpcap, optionally
+ * in a loop and paced by the timestamps of the records.
+ */
+struct pcap_replay {
+	const uint8_t *data;    /* file mapping, NULL if not replayed */
+	size_t len;             /* file length */
+	size_t end;             /* end of the last complete record */
+	size_t off;             /* offset of the next record */
+	int swapped;            /* records are in the other byte order */
+	int nsec;               /* timestamps are in nanoseconds */
+	int infinite;           /* loop back to the first record at the end */
+	double cycles_per_ns;   /* pacing rate, 0 to disable pacing */
+	uint64_t base_cycles;   /* time at which base_ts is due, 0 if unset */
+	uint64_t base_ts;       /* record timestamp in ns, or TS_UNSET */
+	uint64_t last_ts;       /* timestamp of the last record received */
+};
+
 struct pcap_rx_queue {
 	pcap_t *pcap;
+	struct pcap_replay replay;
 	uint8_t in_port;
 	struct rte_mempool *mb_pool;
 	struct queue_stat rx_stat;
@@ -84,6 +127,9 @@ struct pcap_rx_queue {
 
 struct pcap_tx_queue {
 	pcap_dumper_t *dumper;
+	uint8_t *dump_buf;      /* records to write, NULL if unbuffered */
+	size_t dump_buf_len;    /* length of the records in dump_buf */
+	size_t dump_buf_size;
 	pcap_t *pcap;
 	struct queue_stat tx_stat;
 	char name[PATH_MAX];
@@ -95,13 +141,18 @@ struct pmd_internals {
 	struct pcap_tx_queue tx_queue[RTE_PMD_PCAP_MAX_QUEUES];
 	int if_index;
 	int single_iface;
+	size_t tx_buf_size;
 };
 
 struct pmd_devargs {
 	unsigned int num_of_queue;
+	int infinite_rx;
+	double rx_pace;
+	size_t tx_buf_size;
 	struct devargs_queue {
 		pcap_dumper_t *dumper;
 		pcap_t *pcap;
+		struct pcap_replay replay;
 		const char *name;
 		const char *type;
 	} queue[RTE_PMD_PCAP_MAX_QUEUES];
@@ -113,6 +164,9 @@ static const char *valid_arguments[] = {
 	ETH_PCAP_RX_IFACE_ARG,
 	ETH_PCAP_TX_IFACE_ARG,
 	ETH_PCAP_IFACE_ARG,
+	ETH_PCAP_INFINITE_RX_ARG,
+	ETH_PCAP_RX_PACE_ARG,
+	ETH_PCAP_TX_BUF_SIZE_ARG,
 	NULL
 };
 
@@ -180,6 +234,121 @@ eth_pcap_gather_data(unsigned char *data, struct rte_mbuf *mbuf)
 	}
 }
 
+/* Copy a captured packet into a newly allocated mbuf. */
+static struct rte_mbuf *
+eth_pcap_rx_mbuf(struct pcap_rx_queue *pcap_q, const u_char *packet,
+		uint32_t caplen)
+{
+	struct rte_mbuf *mbuf;
+	uint16_t buf_size;
+
+	mbuf = rte_pktmbuf_alloc(pcap_q->mb_pool);
+	if (unlikely(mbuf == NULL))
+		return NULL;
+
+	/* Now get the space available for data in the mbuf */
+	buf_size = rte_pktmbuf_data_room_size(pcap_q->mb_pool) -
+			RTE_PKTMBUF_HEADROOM;
+
+	if (caplen <= buf_size) {
+		/* pcap packet will fit in the mbuf, can copy it */
+		rte_memcpy(rte_pktmbuf_mtod(mbuf, void *), packet, caplen);
+		mbuf->data_len = (uint16_t)caplen;
+	} else {
+		/* Try read jumbo frame into multi mbufs. */
+		if (unlikely(eth_pcap_rx_jumbo(pcap_q->mb_pool, mbuf,
+					       packet, caplen) == -1)) {
+			rte_pktmbuf_free(mbuf);
+			return NULL;
+		}
+	}
+
+	mbuf->pkt_len = (uint16_t)caplen;
+	mbuf->port = pcap_q->in_port;
+
+	return mbuf;
+}
+
+/*
+ * Replay the records of a mapped capture file. When pacing is enabled, the
+ * burst stops at the first record which is not due yet, the time of the
+ * first record received being the reference.
+ */
+static uint16_t
+eth_pcap_rx_replay(struct pcap_rx_queue *pcap_q, struct rte_mbuf **bufs,
+		uint16_t nb_pkts)
+{
+	struct pcap_replay *replay = &pcap_q->replay;
+	struct pcap_file_rec rec;
+	struct rte_mbuf *mbuf;
+	uint64_t cycles = 0;
+	uint64_t ts;
+	int64_t delta;
+	uint16_t num_rx = 0;
+	uint32_t rx_bytes = 0;
+
+	if (replay->cycles_per_ns != 0)
+		cycles = rte_get_timer_cycles();
+
+	while (num_rx < nb_pkts) {
+		if (unlikely(replay->off + sizeof(rec) > replay->end)) {
+			/* End of file, loop back if it has any record */
+			if (!replay->infinite ||
+			    replay->off == sizeof(struct pcap_file_header))
+				break;
+			replay->off = sizeof(struct pcap_file_header);
+			replay->base_cycles += (replay->last_ts -
+				replay->base_ts) * replay->cycles_per_ns;
+			replay->base_ts = PCAP_REPLAY_TS_UNSET;
+			continue;
+		}
+
+		memcpy(&rec, replay->data + replay->off, sizeof(rec));
+		if (replay->swapped) {
+			rec.ts_sec = rte_bswap32(rec.ts_sec);
+			rec.ts_frac = rte_bswap32(rec.ts_frac);
+			rec.caplen = rte_bswap32(rec.caplen);
+		}
+		if (unlikely(rec.caplen > RTE_ETH_PCAP_SNAPSHOT_LEN ||
+			     replay->off + sizeof(rec) + rec.caplen >
+			     replay->end)) {
+			/* Truncated or corrupted record, end of file */
+			replay->end = replay->off;
+			continue;
+		}
+
+		if (replay->cycles_per_ns != 0) {
+			ts = (uint64_t)rec.ts_sec * NS_PER_S +
+				(replay->nsec ? rec.ts_frac :
+				 (uint64_t)rec.ts_frac * 1000);
+			if (replay->base_ts == PCAP_REPLAY_TS_UNSET)
+				replay->base_ts = ts;
+			if (replay->base_cycles == 0)
+				replay->base_cycles = cycles;
+			/* Timestamps going backwards are due immediately */
+			delta = ts - replay->base_ts;
+			if (delta > 0 && replay->base_cycles +
+			    (uint64_t)(delta * replay->cycles_per_ns) > cycles)
+				break;
+			replay->last_ts = ts;
+		}
+
+		mbuf = eth_pcap_rx_mbuf(pcap_q, replay->data + replay->off +
+					sizeof(rec), rec.caplen);
+		if (unlikely(mbuf == NULL))
+			break;
+
+		replay->off += sizeof(rec) + rec.caplen;
+		bufs[num_rx] = mbuf;
+		num_rx++;
+		rx_bytes += rec.caplen;
+	}
+	pcap_q->rx_stat.pkts += num_rx;
+	pcap_q->rx_stat.bytes += rx_bytes;
+
+	return num_rx;
+}
+
 static uint16_t
 eth_pcap_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
@@ -189,9 +358,11 @@ eth_pcap_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	struct rte_mbuf *mbuf;
 	struct pcap_rx_queue *pcap_q = queue;
 	uint16_t num_rx = 0;
-	uint16_t buf_size;
 	uint32_t rx_bytes = 0;
 
+	if (pcap_q->replay.data != NULL)
+		return eth_pcap_rx_replay(pcap_q, bufs, nb_pkts);
+
 	if (unlikely(pcap_q->pcap == NULL || nb_pkts == 0))
 		return 0;
 
@@ -204,32 +375,10 @@ eth_pcap_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		if (unlikely(packet == NULL))
 			break;
 
-		mbuf = rte_pktmbuf_alloc(pcap_q->mb_pool);
+		mbuf = eth_pcap_rx_mbuf(pcap_q, packet, header.caplen);
 		if (unlikely(mbuf == NULL))
 			break;
 
-		/* Now get the space available for data in the mbuf */
-		buf_size = rte_pktmbuf_data_room_size(pcap_q->mb_pool) -
-				RTE_PKTMBUF_HEADROOM;
-
-		if (header.caplen <= buf_size) {
-			/* pcap packet will fit in the mbuf, can copy it */
-			rte_memcpy(rte_pktmbuf_mtod(mbuf, void *), packet,
-					header.caplen);
-			mbuf->data_len = (uint16_t)header.caplen;
-		} else {
-			/* Try read jumbo frame into multi mbufs. */
-			if (unlikely(eth_pcap_rx_jumbo(pcap_q->mb_pool,
-						       mbuf,
-						       packet,
-						       header.caplen) == -1)) {
-				rte_pktmbuf_free(mbuf);
-				break;
-			}
-		}
-
-		mbuf->pkt_len = (uint16_t)header.caplen;
-		mbuf->port = pcap_q->in_port;
 		bufs[num_rx] = mbuf;
 		num_rx++;
 		rx_bytes += header.caplen;
@@ -251,6 +400,60 @@ calculate_timestamp(struct timeval *ts) {
 	timeradd(&start_time, &cur_time, ts);
 }
 
+/* Write the records buffered by a dumper to its file. */
+static void
+eth_pcap_dump_buf_write(struct pcap_tx_queue *dumper_q)
+{
+	int fd = fileno(pcap_dump_file(dumper_q->dumper));
+	const uint8_t *buf = dumper_q->dump_buf;
+	size_t len = dumper_q->dump_buf_len;
+	ssize_t n;
+
+	while (len > 0) {
+		n = write(fd, buf, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			RTE_LOG(ERR, PMD, "Couldn't write to %s: %s\n",
+				dumper_q->name, strerror(errno));
+			break;
+		}
+		buf += n;
+		len -= n;
+	}
+	dumper_q->dump_buf_len = 0;
+}
+
+/*
+ * Copy a packet record to the buffer of a dumper, which is written to the
+ * file when full.
+ */
+static void
+eth_pcap_dump_buf(struct pcap_tx_queue *dumper_q, const struct timeval *ts,
+		struct rte_mbuf *mbuf)
+{
+	struct pcap_file_rec rec;
+	uint8_t *buf;
+
+	if (dumper_q->dump_buf_len + sizeof(rec) + mbuf->pkt_len >
+	    dumper_q->dump_buf_size)
+		eth_pcap_dump_buf_write(dumper_q);
+
+	rec.ts_sec = ts->tv_sec;
+	rec.ts_frac = ts->tv_usec;
+	rec.caplen = mbuf->pkt_len;
+	rec.len = mbuf->pkt_len;
+	buf = dumper_q->dump_buf + dumper_q->dump_buf_len;
+	memcpy(buf, &rec, sizeof(rec));
+	buf += sizeof(rec);
+	for (; mbuf != NULL; mbuf = mbuf->next) {
+		rte_memcpy(buf, rte_pktmbuf_mtod(mbuf, void *),
+			   mbuf->data_len);
+		buf += mbuf->data_len;
+	}
+	dumper_q->dump_buf_len = buf - dumper_q->dump_buf;
+}
+
 /*
  * Callback to handle writing packets to a pcap file.
  */
@@ -267,31 +470,36 @@ eth_pcap_tx_dumper(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	if (dumper_q->dumper == NULL || nb_pkts == 0)
 		return 0;
 
+	/* All the packets of a burst are written at the same time */
+	calculate_timestamp(&header.ts);
+
 	/* writes the nb_pkts packets to the previously opened pcap file
 	 * dumper */
 	for (i = 0; i < nb_pkts; i++) {
 		mbuf = bufs[i];
-		calculate_timestamp(&header.ts);
 		header.len = mbuf->pkt_len;
 		header.caplen = header.len;
 
-		if (likely(mbuf->nb_segs == 1)) {
+		if (mbuf->pkt_len > ETHER_MAX_JUMBO_FRAME_LEN &&
+		    (mbuf->nb_segs > 1 || dumper_q->dump_buf != NULL)) {
+			RTE_LOG(ERR, PMD,
+				"Dropping PCAP packet. Size (%d) > max jumbo size (%d).\n",
+				mbuf->pkt_len,
+				ETHER_MAX_JUMBO_FRAME_LEN);
+
+			rte_pktmbuf_free(mbuf);
+			break;
+		}
+
+		if (dumper_q->dump_buf != NULL) {
+			eth_pcap_dump_buf(dumper_q, &header.ts, mbuf);
+		} else if (likely(mbuf->nb_segs == 1)) {
 			pcap_dump((u_char *)dumper_q->dumper, &header,
 				  rte_pktmbuf_mtod(mbuf, void*));
 		} else {
-			if (mbuf->pkt_len <= ETHER_MAX_JUMBO_FRAME_LEN) {
-				eth_pcap_gather_data(tx_pcap_data, mbuf);
-				pcap_dump((u_char *)dumper_q->dumper, &header,
-					  tx_pcap_data);
-			} else {
-				RTE_LOG(ERR, PMD,
-					"Dropping PCAP packet. Size (%d) > max jumbo size (%d).\n",
-					mbuf->pkt_len,
-					ETHER_MAX_JUMBO_FRAME_LEN);
-
-				rte_pktmbuf_free(mbuf);
-				break;
-			}
+			eth_pcap_gather_data(tx_pcap_data, mbuf);
+			pcap_dump((u_char *)dumper_q->dumper, &header,
+				  tx_pcap_data);
 		}
 
 		num_tx++;
@@ -302,9 +510,12 @@ eth_pcap_tx_dumper(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	/*
 	 * Since there's no place to hook a callback when the forwarding
 	 * process stops and to make sure the pcap file is actually written,
-	 * we flush the pcap dumper within each burst.
+	 * we flush the pcap dumper within each burst, unless it is buffered,
+	 * in which case its buffer is written when full and when the port
+	 * is stopped.
 	 */
-	pcap_dump_flush(dumper_q->dumper);
+	if (dumper_q->dump_buf == NULL)
+		pcap_dump_flush(dumper_q->dumper);
 	dumper_q->tx_stat.pkts += num_tx;
 	dumper_q->tx_stat.bytes += tx_bytes;
 	dumper_q->tx_stat.err_pkts += nb_pkts - num_tx;
@@ -419,9 +630,91 @@ open_single_tx_pcap(const char *pcap_filename, pcap_dumper_t **dumper)
 	return 0;
 }
 
+/*
+ * Map a capture file in memory to replay it. The file is loaded at once,
+ * so that the replay is not slowed down by disk accesses. Returns 1 if the
+ * file is not in the classic pcap format, which is left to libpcap.
+ */
+static int
+open_single_rx_replay(const char *pcap_filename, struct pcap_replay *replay)
+{
+	struct pcap_file_header hdr;
+	struct stat st;
+	void *data;
+	int fd;
+
+	fd = open(pcap_filename, O_RDONLY);
+	if (fd < 0) {
+		RTE_LOG(ERR, PMD, "Couldn't open %s: %s\n", pcap_filename,
+			strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(hdr) ||
+	    pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+		close(fd);
+		return 1;
+	}
+
+	if (hdr.magic == PCAP_MAGIC_USEC || hdr.magic == PCAP_MAGIC_NSEC) {
+		replay->swapped = 0;
+		replay->nsec = (hdr.magic == PCAP_MAGIC_NSEC);
+	} else if (hdr.magic == rte_bswap32(PCAP_MAGIC_USEC) ||
+		   hdr.magic == rte_bswap32(PCAP_MAGIC_NSEC)) {
+		replay->swapped = 1;
+		replay->nsec = (hdr.magic == rte_bswap32(PCAP_MAGIC_NSEC));
+	} else {
+		close(fd);
+		return 1;
+	}
+
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE,
+		    fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		RTE_LOG(ERR, PMD, "Couldn't map %s: %s\n", pcap_filename,
+			strerror(errno));
+		return -1;
+	}
+
+	replay->data = data;
+	replay->len = st.st_size;
+	replay->end = st.st_size;
+	replay->off = sizeof(hdr);
+	replay->base_cycles = 0;
+	replay->base_ts = PCAP_REPLAY_TS_UNSET;
+
+	return 0;
+}
+
+static void
+close_single_rx_replay(struct pcap_replay *replay)
+{
+	munmap((void *)(uintptr_t)replay->data, replay->len);
+	replay->data = NULL;
+}
+
+/*
+ * Open a pcap file for reading, mapped in memory if it is in the classic
+ * pcap format, through libpcap otherwise.
+ */
 static int
-open_single_rx_pcap(const char *pcap_filename, pcap_t **pcap)
+open_single_rx_pcap(const char *pcap_filename, pcap_t **pcap,
+		struct pcap_replay *replay)
 {
+	int ret;
+
+	*pcap = NULL;
+	ret = open_single_rx_replay(pcap_filename, replay);
+	if (ret <= 0)
+		return ret;
+
+	if (replay->infinite || replay->cycles_per_ns != 0) {
+		RTE_LOG(ERR, PMD, "%s is not a pcap file, it cannot be looped or paced\n",
+			pcap_filename);
+		return -1;
+	}
+
 	*pcap = pcap_open_offline(pcap_filename, errbuf);
 	if (*pcap == NULL) {
 		RTE_LOG(ERR, PMD, "Couldn't open %s: %s\n", pcap_filename,
@@ -466,17 +759,34 @@ eth_dev_start(struct rte_eth_dev *dev)
 			if (open_single_iface(tx->name, &tx->pcap) < 0)
 				return -1;
 		}
+
+		/* Records are written next to the file header */
+		if (tx->dumper != NULL && internals->tx_buf_size != 0 &&
+		    tx->dump_buf == NULL) {
+			tx->dump_buf = rte_malloc_socket("pcap_dump_buf",
+					internals->tx_buf_size, 0,
+					dev->data->numa_node);
+			if (tx->dump_buf == NULL) {
+				RTE_LOG(ERR, PMD, "Couldn't allocate dump buffer of %s\n",
+					tx->name);
+				return -1;
+			}
+			tx->dump_buf_size = internals->tx_buf_size;
+			tx->dump_buf_len = 0;
+			pcap_dump_flush(tx->dumper);
+		}
 	}
 
 	/* If not open already, open rx pcaps */
 	for (i = 0; i < dev->data->nb_rx_queues; i++) {
 		rx = &internals->rx_queue[i];
 
-		if (rx->pcap != NULL)
+		if (rx->pcap != NULL || rx->replay.data != NULL)
 			continue;
 
 		if (strcmp(rx->type, ETH_PCAP_RX_PCAP_ARG) == 0) {
-			if (open_single_rx_pcap(rx->name, &rx->pcap) < 0)
+			if (open_single_rx_pcap(rx->name, &rx->pcap,
+					&rx->replay) < 0)
 				return -1;
 		} else if (strcmp(rx->type, ETH_PCAP_RX_IFACE_ARG) == 0) {
 			if (open_single_iface(rx->name, &rx->pcap) < 0)
@@ -516,6 +826,12 @@ eth_dev_stop(struct rte_eth_dev *dev)
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
 		tx = &internals->tx_queue[i];
 
+		if (tx->dump_buf != NULL) {
+			eth_pcap_dump_buf_write(tx);
+			rte_free(tx->dump_buf);
+			tx->dump_buf = NULL;
+		}
+
 		if (tx->dumper != NULL) {
 			pcap_dump_close(tx->dumper);
 			tx->dumper = NULL;
@@ -534,6 +850,9 @@ eth_dev_stop(struct rte_eth_dev *dev)
 			pcap_close(rx->pcap);
 			rx->pcap = NULL;
 		}
+
+		if (rx->replay.data != NULL)
+			close_single_rx_replay(&rx->replay);
 	}
 
 status_down:
@@ -613,8 +932,19 @@ eth_stats_reset(struct rte_eth_dev *dev)
 }
 
 static void
-eth_dev_close(struct rte_eth_dev *dev __rte_unused)
+eth_dev_close(struct rte_eth_dev *dev)
 {
+	unsigned int i;
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct pcap_rx_queue *rx;
+
+	/* Rx files are mapped at probe time, even if never started */
+	for (i = 0; i < RTE_PMD_PCAP_MAX_QUEUES; i++) {
+		rx = &internals->rx_queue[i];
+
+		if (rx->replay.data != NULL)
+			close_single_rx_replay(&rx->replay);
+	}
 }
 
 static void
@@ -686,20 +1016,44 @@ open_rx_pcap(const char *key, const char *value, void *extra_args)
 	unsigned int i;
 	const char *pcap_filename = value;
 	struct pmd_devargs *rx = extra_args;
+	struct pcap_replay *replay;
 	pcap_t *pcap = NULL;
 
-	for (i = 0; i < rx->num_of_queue; i++) {
-		if (open_single_rx_pcap(pcap_filename, &pcap) < 0)
-			return -1;
+	/* each rx_pcap argument is the file of the next queue */
+	i = rx->num_of_queue;
+	if (i >= RTE_PMD_PCAP_MAX_QUEUES)
+		return 0;
 
-		rx->queue[i].pcap = pcap;
-		rx->queue[i].name = pcap_filename;
-		rx->queue[i].type = key;
-	}
+	replay = &rx->queue[i].replay;
+	replay->infinite = rx->infinite_rx;
+	if (rx->rx_pace != 0)
+		replay->cycles_per_ns = rte_get_timer_hz() /
+			(rx->rx_pace * NS_PER_S);
+	if (open_single_rx_pcap(pcap_filename, &pcap, replay) < 0)
+		return -1;
+
+	rx->queue[i].pcap = pcap;
+	rx->queue[i].name = pcap_filename;
+	rx->queue[i].type = key;
+	rx->num_of_queue++;
 
 	return 0;
 }
 
+/* Close the pcap files opened for the Rx queues by open_rx_pcap() */
+static void
+close_rx_pcaps(struct pmd_devargs *rx)
+{
+	unsigned int i;
+
+	for (i = 0; i < rx->num_of_queue; i++) {
+		if (rx->queue[i].pcap != NULL)
+			pcap_close(rx->queue[i].pcap);
+		if (rx->queue[i].replay.data != NULL)
+			close_single_rx_replay(&rx->queue[i].replay);
+	}
+}
+
 /*
  * Opens a pcap file for writing and stores a reference to it
  * for use it later on.
@@ -788,6 +1142,74 @@ open_tx_iface(const char *key, const char *value, void *extra_args)
 	return 0;
 }
 
+/*
+ * Parses the option looping the replay of the rx pcap files
+ */
+static int
+get_infinite_rx_arg(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	struct pmd_devargs *rx = extra_args;
+
+	if (strcmp(value, "0") == 0)
+		rx->infinite_rx = 0;
+	else if (strcmp(value, "1") == 0)
+		rx->infinite_rx = 1;
+	else
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Parses the rate multiplier of the rx pcap files timestamps, 1 to replay
+ * them at their original rate, 0 to not pace them.
+ */
+static int
+get_rx_pace_arg(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	struct pmd_devargs *rx = extra_args;
+	char *end;
+
+	errno = 0;
+	rx->rx_pace = strtod(value, &end);
+	if (errno != 0 || *end != '\0' || !(rx->rx_pace >= 0))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Parses the size of the buffer of the tx pcap files, 0 to write the
+ * packets at the end of each burst.
+ */
+static int
+get_tx_buf_size_arg(const char *key, const char *value,
+		void *extra_args)
+{
+	struct pmd_devargs *tx = extra_args;
+	unsigned long long size;
+	char *end;
+
+	errno = 0;
+	size = strtoull(value, &end, 0);
+	if (errno != 0 || *end != '\0' || size > SIZE_MAX)
+		return -1;
+
+	/* The buffer must be able to hold the largest packet */
+	if (size != 0 && size < sizeof(struct pcap_file_rec) +
+			ETHER_MAX_JUMBO_FRAME_LEN) {
+		RTE_LOG(ERR, PMD, "%s must be at least %zu\n", key,
+			sizeof(struct pcap_file_rec) +
+			ETHER_MAX_JUMBO_FRAME_LEN);
+		return -1;
+	}
+	tx->tx_buf_size = size;
+
+	return 0;
+}
+
 static struct rte_vdev_driver pmd_pcap_drv;
 
 static int
@@ -869,6 +1291,7 @@ eth_from_pcaps_common(struct rte_vdev_device *vdev,
 		struct devargs_queue *queue = &rx_queues->queue[i];
 
 		rx->pcap = queue->pcap;
+		rx->replay = queue->replay;
 		snprintf(rx->name, sizeof(rx->name), "%s", queue->name);
 		snprintf(rx->type, sizeof(rx->type), "%s", queue->type);
 	}
@@ -916,6 +1339,7 @@ eth_from_pcaps(struct rte_vdev_device *vdev,
 
 	/* store weather we are using a single interface for rx/tx or not */
 	internals->single_iface = single_iface;
+	internals->tx_buf_size = tx_queues->tx_buf_size;
 
 	eth_dev->rx_pkt_burst = eth_pcap_rx;
 
@@ -970,12 +1394,33 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 		goto create_eth;
 	}
 
+	/* Replay and dump options of the pcap files */
+	if (rte_kvargs_count(kvlist, ETH_PCAP_INFINITE_RX_ARG) == 1) {
+		ret = rte_kvargs_process(kvlist, ETH_PCAP_INFINITE_RX_ARG,
+				&get_infinite_rx_arg, &pcaps);
+		if (ret < 0)
+			goto free_kvlist;
+	}
+
+	if (rte_kvargs_count(kvlist, ETH_PCAP_RX_PACE_ARG) == 1) {
+		ret = rte_kvargs_process(kvlist, ETH_PCAP_RX_PACE_ARG,
+				&get_rx_pace_arg, &pcaps);
+		if (ret < 0)
+			goto free_kvlist;
+	}
+
+	if (rte_kvargs_count(kvlist, ETH_PCAP_TX_BUF_SIZE_ARG) == 1) {
+		ret = rte_kvargs_process(kvlist, ETH_PCAP_TX_BUF_SIZE_ARG,
+				&get_tx_buf_size_arg, &dumpers);
+		if (ret < 0)
+			goto free_kvlist;
+	}
+
 	/*
 	 * We check whether we want to open a RX stream from a real NIC or a
 	 * pcap file
 	 */
-	pcaps.num_of_queue = rte_kvargs_count(kvlist, ETH_PCAP_RX_PCAP_ARG);
-	if (pcaps.num_of_queue)
+	if (rte_kvargs_count(kvlist, ETH_PCAP_RX_PCAP_ARG))
 		is_rx_pcap = 1;
 	else
 		pcaps.num_of_queue = rte_kvargs_count(kvlist,
@@ -984,6 +1429,7 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 	if (pcaps.num_of_queue > RTE_PMD_PCAP_MAX_QUEUES)
 		pcaps.num_of_queue = RTE_PMD_PCAP_MAX_QUEUES;
 
+	/* open_rx_pcap() counts the queues as it opens their file */
 	if (is_rx_pcap)
 		ret = rte_kvargs_process(kvlist, ETH_PCAP_RX_PCAP_ARG,
 				&open_rx_pcap, &pcaps);
@@ -992,7 +1438,7 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 				&open_rx_iface, &pcaps);
 
 	if (ret < 0)
-		goto free_kvlist;
+		goto free_rx_pcaps;
 
 	/*
 	 * We check whether we want to open a TX stream to a real NIC or a
@@ -1016,12 +1462,16 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 				&open_tx_iface, &dumpers);
 
 	if (ret < 0)
-		goto free_kvlist;
+		goto free_rx_pcaps;
 
 create_eth:
 	ret = eth_from_pcaps(dev, &pcaps, pcaps.num_of_queue, &dumpers,
 		dumpers.num_of_queue, kvlist, single_iface, is_tx_pcap);
 
+free_rx_pcaps:
+	if (ret < 0 && is_rx_pcap)
+		close_rx_pcaps(&pcaps);
+
 free_kvlist:
 	rte_kvargs_free(kvlist);
 
@@ -1044,6 +1494,8 @@ pmd_pcap_remove(struct rte_vdev_device *dev)
 	if (eth_dev == NULL)
 		return -1;
 
+	eth_dev_close(eth_dev);
+
 	rte_free(eth_dev->data->dev_private);
 	rte_free(eth_dev->data);
 
@@ -1064,4 +1516,7 @@ RTE_PMD_REGISTER_PARAM_STRING(net_pcap,
 	ETH_PCAP_TX_PCAP_ARG "=<string> "
 	ETH_PCAP_RX_IFACE_ARG "=<ifc> "
 	ETH_PCAP_TX_IFACE_ARG "=<ifc> "
-	ETH_PCAP_IFACE_ARG "=<ifc>");
+	ETH_PCAP_IFACE_ARG "=<ifc> "
+	ETH_PCAP_INFINITE_RX_ARG "=<0|1> "
+	ETH_PCAP_RX_PACE_ARG "=<float> "
+	ETH_PCAP_TX_BUF_SIZE_ARG "=<int>");
@@ -137,8 +137,11 @@ tun_alloc(struct pmd_internals *pmd)
 	/*
 	 * Do not set IFF_NO_PI as packet information header will be needed
 	 * to check if a received packet has been truncated.
+	 * The virtio-net header that follows it carries checksum and
+	 * segmentation offloads, so that a whole TSO or GSO packet crosses
+	 * the kernel boundary in a single system call.
 	 */
-	ifr.ifr_flags = IFF_TAP;
+	ifr.ifr_flags = IFF_TAP | IFF_VNET_HDR;
 	snprintf(ifr.ifr_name, IFNAMSIZ, "%s", pmd->name);
 
 	RTE_LOG(DEBUG, PMD, "ifr_name '%s'\n", ifr.ifr_name);
@@ -270,6 +273,9 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 		/* IPv6 extensions are not supported */
 		return;
 	}
+	/* L4 status already given by the kernel */
+	if (mbuf->ol_flags & PKT_RX_L4_CKSUM_MASK)
+		return;
 	if (l4 == RTE_PTYPE_L4_UDP || l4 == RTE_PTYPE_L4_TCP) {
 		l4_hdr = rte_pktmbuf_mtod_offset(mbuf, void *, l2_len + l3_len);
 		/* Don't verify checksum for multi-segment packets. */
@@ -285,6 +291,201 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 	}
 }
 
+/* Translate the virtio-net header of a received packet to mbuf offloads */
+static int
+tap_rx_offload(struct rte_mbuf *mbuf, const struct virtio_net_hdr *hdr,
+	       const struct rte_net_hdr_lens *hdr_lens)
+{
+	uint32_t l4 = mbuf->packet_type & RTE_PTYPE_L4_MASK;
+	int l4_supported = (l4 == RTE_PTYPE_L4_TCP || l4 == RTE_PTYPE_L4_UDP);
+
+	if (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
+		if (l4_supported && hdr->csum_start <=
+		    hdr_lens->l2_len + hdr_lens->l3_len + hdr_lens->l4_len) {
+			/* checksum left to the application */
+			mbuf->ol_flags |= PKT_RX_L4_CKSUM_NONE;
+		} else {
+			uint16_t csum, off;
+
+			rte_raw_cksum_mbuf(mbuf, hdr->csum_start,
+				rte_pktmbuf_pkt_len(mbuf) - hdr->csum_start,
+				&csum);
+			if (likely(csum != 0xffff))
+				csum = ~csum;
+			off = hdr->csum_offset + hdr->csum_start;
+			if (rte_pktmbuf_data_len(mbuf) >=
+			    off + sizeof(uint16_t))
+				*rte_pktmbuf_mtod_offset(mbuf, uint16_t *,
+					off) = csum;
+		}
+	} else if ((hdr->flags & VIRTIO_NET_HDR_F_DATA_VALID) &&
+		   l4_supported) {
+		mbuf->ol_flags |= PKT_RX_L4_CKSUM_GOOD;
+	}
+
+	if (hdr->gso_type == VIRTIO_NET_HDR_GSO_NONE)
+		return 0;
+
+	if (hdr->gso_size == 0)
+		return -EINVAL;
+
+	switch (hdr->gso_type) {
+	case VIRTIO_NET_HDR_GSO_TCPV4:
+	case VIRTIO_NET_HDR_GSO_TCPV6:
+		mbuf->ol_flags |= PKT_RX_LRO | PKT_RX_L4_CKSUM_NONE;
+		mbuf->tso_segsz = hdr->gso_size;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Set the packet type and offloads of a received packet */
+static int
+tap_rx_pkt_finish(struct rx_queue *rxq, struct rte_mbuf *mbuf,
+		  const struct tap_pkt_hdr *hdr)
+{
+	struct rte_net_hdr_lens hdr_lens;
+
+	mbuf->packet_type = rte_net_get_ptype(mbuf, &hdr_lens,
+					      RTE_PTYPE_ALL_MASK);
+	if (unlikely(hdr->vnet.flags != 0 ||
+		     hdr->vnet.gso_type != VIRTIO_NET_HDR_GSO_NONE) &&
+	    tap_rx_offload(mbuf, &hdr->vnet, &hdr_lens) < 0)
+		return -1;
+	if (rxq->rxmode->hw_ip_checksum)
+		tap_verify_csum(mbuf);
+	return 0;
+}
+
+/* Give an mbuf to a slot of burst reads */
+static void
+tap_rx_slot_set(struct rx_slot *slot, struct rte_mbuf *mbuf)
+{
+	slot->mbuf = mbuf;
+	slot->iovecs[0].iov_base = &slot->hdr;
+	slot->iovecs[0].iov_len = sizeof(slot->hdr);
+	slot->iovecs[1].iov_base = rte_pktmbuf_mtod(mbuf, void *);
+	slot->iovecs[1].iov_len = mbuf->buf_len - rte_pktmbuf_headroom(mbuf);
+}
+
+/* Release the burst reads of an Rx queue */
+static void
+tap_rx_uring_release(struct rx_queue *rxq)
+{
+	unsigned int i;
+
+	for (i = 0; i != RTE_DIM(rxq->slots); i++) {
+		rte_pktmbuf_free(rxq->slots[i].mbuf);
+		rxq->slots[i].mbuf = NULL;
+	}
+	tap_uring_release(&rxq->uring);
+}
+
+/*
+ * Receive single segment packets, reading up to TAP_URING_BURST of them in
+ * a single system call. As many reads are submitted as packets came in last
+ * time plus one, so that a few packets do not cost many empty reads.
+ */
+static uint16_t
+tap_rx_burst_uring(struct rx_queue *rxq, struct rte_mbuf **bufs,
+		   uint16_t nb_pkts)
+{
+	int32_t res[TAP_URING_BURST];
+	unsigned long num_rx_bytes = 0;
+	uint16_t num_rx = 0;
+
+	while (num_rx < nb_pkts) {
+		unsigned int nb_reads = RTE_MIN(nb_pkts - num_rx,
+						rxq->nb_reads);
+		unsigned int nb_read = 0;
+		unsigned int i;
+		int ret;
+
+		for (i = 0; i != nb_reads; i++) {
+			res[i] = -EIO;
+			tap_uring_prep(&rxq->uring, 0, rxq->fd,
+				       rxq->slots[i].iovecs, 2, i);
+		}
+		ret = tap_uring_run(&rxq->uring, nb_reads, res);
+		if (unlikely(res[0] == -EOPNOTSUPP)) {
+			/* TAP without non-blocking io_uring reads */
+			RTE_LOG(INFO, PMD,
+				"reading one packet per system call\n");
+			tap_rx_uring_release(rxq);
+			break;
+		}
+
+		for (i = 0; i != nb_reads; i++) {
+			struct rx_slot *slot = &rxq->slots[i];
+			struct rte_mbuf *mbuf = slot->mbuf;
+			struct rte_mbuf *buf;
+			int len = res[i];
+
+			if (len < (int)sizeof(struct tap_pkt_hdr))
+				continue;
+			nb_read++;
+
+			/* Packet couldn't fit in the provided mbuf */
+			if (unlikely(slot->hdr.pi.flags & TUN_PKT_STRIP)) {
+				rxq->stats.ierrors++;
+				continue;
+			}
+			buf = rte_pktmbuf_alloc(rxq->mp);
+			if (unlikely(!buf)) {
+				/* Keep the mbuf for the next read */
+				rxq->stats.rx_nombuf++;
+				continue;
+			}
+			tap_rx_slot_set(slot, buf);
+
+			len -= sizeof(struct tap_pkt_hdr);
+			mbuf->pkt_len = len;
+			mbuf->data_len = len;
+			mbuf->port = rxq->in_port;
+			if (tap_rx_pkt_finish(rxq, mbuf, &slot->hdr) < 0) {
+				rxq->stats.ierrors++;
+				rte_pktmbuf_free(mbuf);
+				continue;
+			}
+			bufs[num_rx++] = mbuf;
+			num_rx_bytes += len;
+		}
+		rxq->nb_reads = (nb_read == nb_reads) ?
+			TAP_URING_BURST : nb_read + 1;
+		/* Stop once the queue is drained */
+		if (ret < 0 || nb_read < nb_reads)
+			break;
+	}
+	rxq->stats.ipackets += num_rx;
+	rxq->stats.ibytes += num_rx_bytes;
+
+	return num_rx;
+}
+
+/*
+ * The kernel raises SIGIO for every packet queued on a file descriptor with
+ * O_ASYNC, which costs more than reading the packet. Disable the Rx trigger
+ * while bursts come in full, and enable it again once the queue is empty.
+ */
+static void
+tap_rx_trigger_update(struct rx_queue *rxq, int busy)
+{
+	int flags;
+
+	if (busy == rxq->trigger_off)
+		return;
+	flags = fcntl(rxq->fd, F_GETFL);
+	if (flags == -1 ||
+	    fcntl(rxq->fd, F_SETFL,
+		  busy ? flags & ~O_ASYNC : flags | O_ASYNC) == -1)
+		return;
+	rxq->trigger_off = busy;
+	/* Look for packets queued before SIGIO was enabled */
+	if (!busy)
+		rxq->trigger_seen = 0;
+}
+
 /* Callback to handle the rx burst of packets to the correct interface and
  * file descriptor(s) in a multi-queue setup.
  */
@@ -296,11 +497,17 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	unsigned long num_rx_bytes = 0;
 	uint32_t trigger = tap_trigger;
 
-	if (trigger == rxq->trigger_seen)
+	if (trigger == rxq->trigger_seen && !rxq->trigger_off)
 		return 0;
 	if (trigger)
 		rxq->trigger_seen = trigger;
 	rte_compiler_barrier();
+	if (rxq->uring.fd >= 0) {
+		num_rx = tap_rx_burst_uring(rxq, bufs, nb_pkts);
+		/* Unless io_uring reads turned out not to be supported */
+		if (rxq->uring.fd >= 0)
+			goto trigger;
+	}
 	for (num_rx = 0; num_rx < nb_pkts; ) {
 		struct rte_mbuf *mbuf = rxq->pool;
 		struct rte_mbuf *seg = NULL;
@@ -309,18 +516,19 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		int len;
 
 		len = readv(rxq->fd, *rxq->iovecs,
-			    1 + (rxq->rxmode->enable_scatter ?
+			    1 + (rxq->rxmode->enable_scatter ||
+				 rxq->rxmode->enable_lro ?
 				 rxq->nb_rx_desc : 1));
-		if (len < (int)sizeof(struct tun_pi))
+		if (len < (int)sizeof(struct tap_pkt_hdr))
 			break;
 
 		/* Packet couldn't fit in the provided mbuf */
-		if (unlikely(rxq->pi.flags & TUN_PKT_STRIP)) {
+		if (unlikely(rxq->hdr.pi.flags & TUN_PKT_STRIP)) {
 			rxq->stats.ierrors++;
 			continue;
 		}
 
-		len -= sizeof(struct tun_pi);
+		len -= sizeof(struct tap_pkt_hdr);
 
 		mbuf->pkt_len = len;
 		mbuf->port = rxq->in_port;
@@ -363,10 +571,11 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			data_off = 0;
 		}
 		seg->next = NULL;
-		mbuf->packet_type = rte_net_get_ptype(mbuf, NULL,
-						      RTE_PTYPE_ALL_MASK);
-		if (rxq->rxmode->hw_ip_checksum)
-			tap_verify_csum(mbuf);
+		if (tap_rx_pkt_finish(rxq, mbuf, &rxq->hdr) < 0) {
+			rxq->stats.ierrors++;
+			rte_pktmbuf_free(mbuf);
+			continue;
+		}
 
 		/* account for the receive frame */
 		bufs[num_rx++] = mbuf;
@@ -375,58 +584,117 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 end:
 	rxq->stats.ipackets += num_rx;
 	rxq->stats.ibytes += num_rx_bytes;
+trigger:
+	if (trigger && (num_rx == 0 || num_rx == nb_pkts))
+		tap_rx_trigger_update(rxq, num_rx != 0);
 
 	return num_rx;
 }
 
+/*
+ * Fill the virtio-net header of a packet for the kernel to complete its L4
+ * checksum and segment it, if requested. The IP checksum and the L4
+ * pseudo-header checksum are written to hdrs, a copy of the packet headers,
+ * so that the mbuf data is not modified.
+ */
 static void
-tap_tx_offload(char *packet, uint64_t ol_flags, unsigned int l2_len,
-	       unsigned int l3_len)
+tap_tx_offload(char *hdrs, const struct rte_mbuf *mbuf,
+	       struct virtio_net_hdr *vnet)
 {
-	void *l3_hdr = packet + l2_len;
+	uint64_t ol_flags = mbuf->ol_flags;
+	void *l3_hdr = hdrs + mbuf->l2_len;
+	uint16_t *l4_cksum;
 
 	if (ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_IPV4)) {
 		struct ipv4_hdr *iph = l3_hdr;
 		uint16_t cksum;
 
 		iph->hdr_checksum = 0;
-		cksum = rte_raw_cksum(iph, l3_len);
+		cksum = rte_raw_cksum(iph, mbuf->l3_len);
 		iph->hdr_checksum = (cksum == 0xffff) ? cksum : ~cksum;
 	}
-	if (ol_flags & PKT_TX_L4_MASK) {
-		uint16_t l4_len;
-		uint32_t cksum;
-		uint16_t *l4_cksum;
-		void *l4_hdr;
-
-		l4_hdr = packet + l2_len + l3_len;
-		if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM)
-			l4_cksum = &((struct udp_hdr *)l4_hdr)->dgram_cksum;
-		else if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM)
-			l4_cksum = &((struct tcp_hdr *)l4_hdr)->cksum;
-		else
-			return;
-		*l4_cksum = 0;
-		if (ol_flags & PKT_TX_IPV4) {
-			struct ipv4_hdr *iph = l3_hdr;
 
-			l4_len = rte_be_to_cpu_16(iph->total_length) - l3_len;
-			cksum = rte_ipv4_phdr_cksum(l3_hdr, 0);
-		} else {
-			struct ipv6_hdr *ip6h = l3_hdr;
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		vnet->gso_type = (ol_flags & PKT_TX_IPV6) ?
+			VIRTIO_NET_HDR_GSO_TCPV6 :
+			VIRTIO_NET_HDR_GSO_TCPV4;
+		vnet->gso_size = mbuf->tso_segsz;
+		vnet->hdr_len = mbuf->l2_len + mbuf->l3_len + mbuf->l4_len;
+		vnet->csum_offset = offsetof(struct tcp_hdr, cksum);
+	} else if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM) {
+		vnet->csum_offset = offsetof(struct udp_hdr, dgram_cksum);
+	} else if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM) {
+		vnet->csum_offset = offsetof(struct tcp_hdr, cksum);
+	} else {
+		return;
+	}
+
+	vnet->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+	vnet->csum_start = mbuf->l2_len + mbuf->l3_len;
+	l4_cksum = (uint16_t *)(hdrs + vnet->csum_start + vnet->csum_offset);
+	if (ol_flags & PKT_TX_IPV4)
+		*l4_cksum = rte_ipv4_phdr_cksum(l3_hdr, 0);
+	else
+		*l4_cksum = rte_ipv6_phdr_cksum(l3_hdr, 0);
+}
 
-			/* payload_len does not include ext headers */
-			l4_len = rte_be_to_cpu_16(ip6h->payload_len) -
-				l3_len + sizeof(struct ipv6_hdr);
-			cksum = rte_ipv6_phdr_cksum(l3_hdr, 0);
+/* Length of the packet headers modified by tap_tx_offload() */
+static unsigned int
+tap_tx_offload_len(const struct rte_mbuf *mbuf)
+{
+	uint64_t ol_flags = mbuf->ol_flags;
+
+	if (ol_flags & PKT_TX_TCP_SEG)
+		return mbuf->l2_len + mbuf->l3_len + mbuf->l4_len;
+	if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM)
+		return mbuf->l2_len + mbuf->l3_len + sizeof(struct udp_hdr);
+	if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM)
+		return mbuf->l2_len + mbuf->l3_len + sizeof(struct tcp_hdr);
+	if (ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_IPV4))
+		return mbuf->l2_len + mbuf->l3_len;
+	return 0;
+}
+
+/*
+ * Write the packets prepared in the Tx slots, in a single system call when
+ * io_uring is available. Packets the kernel refuses are dropped.
+ */
+static uint16_t
+tap_tx_flush(struct tx_queue *txq, struct rte_mbuf **bufs, unsigned int nb,
+	     unsigned long *num_tx_bytes)
+{
+	int32_t res[TAP_URING_BURST];
+	uint16_t num_tx = 0;
+	unsigned int i;
+
+	if (txq->uring.fd >= 0) {
+		for (i = 0; i != nb; i++) {
+			res[i] = -EIO;
+			tap_uring_prep(&txq->uring, 1, txq->fd,
+				       txq->slots[i].iovecs,
+				       txq->slots[i].nb_iovecs, i);
+		}
+		tap_uring_run(&txq->uring, nb, res);
+		if (unlikely(res[0] == -EOPNOTSUPP)) {
+			/* TAP without non-blocking io_uring writes */
+			RTE_LOG(INFO, PMD,
+				"writing one packet per system call\n");
+			tap_uring_release(&txq->uring);
 		}
-		cksum += rte_raw_cksum(l4_hdr, l4_len);
-		cksum = ((cksum & 0xffff0000) >> 16) + (cksum & 0xffff);
-		cksum = (~cksum) & 0xffff;
-		if (cksum == 0)
-			cksum = 0xffff;
-		*l4_cksum = cksum;
 	}
+	if (txq->uring.fd < 0) {
+		for (i = 0; i != nb; i++)
+			res[i] = writev(txq->fd, txq->slots[i].iovecs,
+					txq->slots[i].nb_iovecs);
+	}
+	for (i = 0; i != nb; i++) {
+		if (res[i] > 0) {
+			num_tx++;
+			*num_tx_bytes += bufs[i]->pkt_len;
+		}
+		rte_pktmbuf_free(bufs[i]);
+	}
+	return num_tx;
 }
 
 /* Callback to handle sending packets from the tap interface
@@ -437,6 +705,8 @@ pmd_tx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	struct tx_queue *txq = queue;
 	uint16_t num_tx = 0;
 	unsigned long num_tx_bytes = 0;
+	unsigned int nb_slots = 0;
+	unsigned int nb_iovecs_used = 0;
 	uint32_t max_size;
 	int i;
 
@@ -445,54 +715,83 @@ pmd_tx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	max_size = *txq->mtu + (ETHER_HDR_LEN + ETHER_CRC_LEN + 4);
 	for (i = 0; i < nb_pkts; i++) {
-		struct rte_mbuf *mbuf = bufs[num_tx];
-		struct iovec iovecs[mbuf->nb_segs + 1];
-		struct tun_pi pi = { .flags = 0 };
-		struct rte_mbuf *seg = mbuf;
-		char m_copy[mbuf->data_len];
-		int n;
-		int j;
+		struct rte_mbuf *mbuf = bufs[i];
+		struct tx_slot *slot;
+		struct iovec *iovecs;
+		struct rte_mbuf *seg;
+		unsigned int hdrs_len = tap_tx_offload_len(mbuf);
+		unsigned int off;
+		int nb_iovecs;
 
 		/* stats.errs will be incremented */
-		if (rte_pktmbuf_pkt_len(mbuf) > max_size)
+		if (rte_pktmbuf_pkt_len(mbuf) >
+		    ((mbuf->ol_flags & PKT_TX_TCP_SEG) ?
+		     TAP_GSO_MAX_LEN : max_size))
 			break;
+		/* Headers must all be in the first segment */
+		if (hdrs_len != 0 &&
+		    (hdrs_len > TAP_TX_HDRS_MAX_LEN ||
+		     hdrs_len > rte_pktmbuf_data_len(mbuf)))
+			break;
+		if (mbuf->nb_segs + 2u > txq->nb_iovecs)
+			break;
+		if (mbuf->nb_segs + 2u > txq->nb_iovecs - nb_iovecs_used) {
+			num_tx += tap_tx_flush(txq, &bufs[i - nb_slots],
+					       nb_slots, &num_tx_bytes);
+			nb_slots = 0;
+			nb_iovecs_used = 0;
+		}
 
-		iovecs[0].iov_base = &pi;
-		iovecs[0].iov_len = sizeof(pi);
-		for (j = 1; j <= mbuf->nb_segs; j++) {
-			iovecs[j].iov_len = rte_pktmbuf_data_len(seg);
-			iovecs[j].iov_base =
-				rte_pktmbuf_mtod(seg, void *);
-			seg = seg->next;
+		slot = &txq->slots[nb_slots];
+		iovecs = &txq->iovecs[nb_iovecs_used];
+		memset(&slot->hdr, 0, sizeof(slot->hdr));
+		iovecs[0].iov_base = &slot->hdr;
+		iovecs[0].iov_len = sizeof(slot->hdr);
+		nb_iovecs = 1;
+		if (hdrs_len != 0) {
+			/* To change checksums, work on a copy of headers. */
+			rte_memcpy(slot->hdrs, rte_pktmbuf_mtod(mbuf, void *),
+				   hdrs_len);
+			tap_tx_offload(slot->hdrs, mbuf, &slot->hdr.vnet);
+			iovecs[1].iov_base = slot->hdrs;
+			iovecs[1].iov_len = hdrs_len;
+			nb_iovecs = 2;
 		}
-		if (mbuf->ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_IPV4) ||
-		    (mbuf->ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM ||
-		    (mbuf->ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM) {
-			/* Support only packets with all data in the same seg */
-			if (mbuf->nb_segs > 1)
-				break;
-			/* To change checksums, work on a copy of data. */
-			rte_memcpy(m_copy, rte_pktmbuf_mtod(mbuf, void *),
-				   rte_pktmbuf_data_len(mbuf));
-			tap_tx_offload(m_copy, mbuf->ol_flags,
-				       mbuf->l2_len, mbuf->l3_len);
-			iovecs[1].iov_base = m_copy;
+		off = hdrs_len;
+		for (seg = mbuf; seg != NULL; seg = seg->next) {
+			if (rte_pktmbuf_data_len(seg) > off) {
+				iovecs[nb_iovecs].iov_base =
+					rte_pktmbuf_mtod_offset(seg, void *,
+								off);
+				iovecs[nb_iovecs].iov_len =
+					rte_pktmbuf_data_len(seg) - off;
+				nb_iovecs++;
+			}
+			off = 0;
+		}
+		slot->iovecs = iovecs;
+		slot->nb_iovecs = nb_iovecs;
+		nb_iovecs_used += nb_iovecs;
+		nb_slots++;
+
+		/* copy the tx frames data */
+		if (nb_slots == TAP_URING_BURST) {
+			num_tx += tap_tx_flush(txq, &bufs[i + 1 - nb_slots],
+					       nb_slots, &num_tx_bytes);
+			nb_slots = 0;
+			nb_iovecs_used = 0;
 		}
-		/* copy the tx frame data */
-		n = writev(txq->fd, iovecs, mbuf->nb_segs + 1);
-		if (n <= 0)
-			break;
-
-		num_tx++;
-		num_tx_bytes += mbuf->pkt_len;
-		rte_pktmbuf_free(mbuf);
 	}
+	if (nb_slots != 0)
+		num_tx += tap_tx_flush(txq, &bufs[i - nb_slots], nb_slots,
+				       &num_tx_bytes);
 
 	txq->stats.opackets += num_tx;
 	txq->stats.errs += nb_pkts - num_tx;
 	txq->stats.obytes += num_tx_bytes;
 
-	return num_tx;
+	/* Packets refused by the kernel are dropped, not given back */
+	return i;
 }
 
 static const char *
@@ -657,11 +956,13 @@ tap_dev_info(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 	dev_info->speed_capa = tap_dev_speed_capa();
 	dev_info->rx_offload_capa = (DEV_RX_OFFLOAD_IPV4_CKSUM |
 				     DEV_RX_OFFLOAD_UDP_CKSUM |
-				     DEV_RX_OFFLOAD_TCP_CKSUM);
+				     DEV_RX_OFFLOAD_TCP_CKSUM |
+				     DEV_RX_OFFLOAD_TCP_LRO);
 	dev_info->tx_offload_capa =
 		(DEV_TX_OFFLOAD_IPV4_CKSUM |
 		 DEV_TX_OFFLOAD_UDP_CKSUM |
-		 DEV_TX_OFFLOAD_TCP_CKSUM);
+		 DEV_TX_OFFLOAD_TCP_CKSUM |
+		 DEV_TX_OFFLOAD_TCP_TSO);
 }
 
 static void
@@ -734,6 +1035,8 @@ tap_dev_close(struct rte_eth_dev *dev)
 			close(internals->rxq[i].fd);
 		internals->rxq[i].fd = -1;
 		internals->txq[i].fd = -1;
+		tap_uring_release(&internals->rxq[i].uring);
+		tap_uring_release(&internals->txq[i].uring);
 	}
 }
 
@@ -749,6 +1052,7 @@ tap_rx_queue_release(void *queue)
 		rte_free(rxq->iovecs);
 		rxq->pool = NULL;
 		rxq->iovecs = NULL;
+		tap_rx_uring_release(rxq);
 	}
 }
 
@@ -760,6 +1064,11 @@ tap_tx_queue_release(void *queue)
 	if (txq && (txq->fd > 0)) {
 		close(txq->fd);
 		txq->fd = -1;
+		tap_uring_release(&txq->uring);
+		rte_free(txq->slots);
+		rte_free(txq->iovecs);
+		txq->slots = NULL;
+		txq->iovecs = NULL;
 	}
 }
 
@@ -907,6 +1216,21 @@ tap_setup_queue(struct rte_eth_dev *dev,
 	return fd;
 }
 
+/*
+ * Have the kernel send TCP packets to the queues unsegmented when LRO is
+ * enabled, which requires accepting packets with partial checksums.
+ */
+static int
+tap_rx_offload_set(int fd, const struct rte_eth_rxmode *rxmode)
+{
+	unsigned long offload = 0;
+
+	if (rxmode->enable_lro)
+		offload = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+
+	return ioctl(fd, TUNSETOFFLOAD, offload);
+}
+
 static int
 tap_rx_queue_setup(struct rte_eth_dev *dev,
 		   uint16_t rx_queue_id,
@@ -933,8 +1257,10 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 		return -1;
 	}
 
+	tap_rx_uring_release(rxq);
 	rxq->mp = mp;
 	rxq->trigger_seen = 1; /* force initial burst */
+	rxq->trigger_off = 0;
 	rxq->in_port = dev->data->port_id;
 	rxq->nb_rx_desc = nb_desc;
 	iovecs = rte_zmalloc_socket(dev->data->name, sizeof(*iovecs), 0,
@@ -954,8 +1280,15 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 		goto error;
 	}
 
-	(*rxq->iovecs)[0].iov_len = sizeof(struct tun_pi);
-	(*rxq->iovecs)[0].iov_base = &rxq->pi;
+	if (tap_rx_offload_set(fd, rxq->rxmode) < 0) {
+		RTE_LOG(WARNING, PMD, "%s: Couldn't set offloads: %s\n",
+			dev->data->name, strerror(errno));
+		ret = -1;
+		goto error;
+	}
+
+	(*rxq->iovecs)[0].iov_len = sizeof(struct tap_pkt_hdr);
+	(*rxq->iovecs)[0].iov_base = &rxq->hdr;
 
 	for (i = 1; i <= nb_desc; i++) {
 		*tmp = rte_pktmbuf_alloc(rxq->mp);
@@ -973,6 +1306,27 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 		tmp = &(*tmp)->next;
 	}
 
+	/* Read a burst of packets at once when they fit in one mbuf */
+	if (!rxq->rxmode->enable_scatter && !rxq->rxmode->enable_lro) {
+		if (tap_uring_init(&rxq->uring) < 0)
+			RTE_LOG(INFO, PMD,
+				"%s: reading one packet per system call on queue %d: %s\n",
+				dev->data->name, rx_queue_id, strerror(errno));
+		for (i = 0; rxq->uring.fd >= 0 && i != TAP_URING_BURST; i++) {
+			struct rte_mbuf *mbuf = rte_pktmbuf_alloc(rxq->mp);
+
+			if (!mbuf) {
+				RTE_LOG(WARNING, PMD,
+					"%s: couldn't allocate memory for queue %d\n",
+					dev->data->name, rx_queue_id);
+				ret = -ENOMEM;
+				goto error;
+			}
+			tap_rx_slot_set(&rxq->slots[i], mbuf);
+		}
+		rxq->nb_reads = TAP_URING_BURST;
+	}
+
 	RTE_LOG(DEBUG, PMD, "  RX TAP device name %s, qid %d on fd %d\n",
 		internals->name, rx_queue_id, internals->rxq[rx_queue_id].fd);
 
@@ -983,6 +1337,7 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 	rxq->pool = NULL;
 	rte_free(rxq->iovecs);
 	rxq->iovecs = NULL;
+	tap_rx_uring_release(rxq);
 	return ret;
 }
 
@@ -990,24 +1345,57 @@ static int
 tap_tx_queue_setup(struct rte_eth_dev *dev,
 		   uint16_t tx_queue_id,
 		   uint16_t nb_tx_desc __rte_unused,
-		   unsigned int socket_id __rte_unused,
+		   unsigned int socket_id,
 		   const struct rte_eth_txconf *tx_conf __rte_unused)
 {
 	struct pmd_internals *internals = dev->data->dev_private;
+	struct tx_queue *txq = &internals->txq[tx_queue_id];
+	long iov_max = sysconf(_SC_IOV_MAX);
 	int ret;
 
 	if (tx_queue_id >= internals->nb_queues)
 		return -1;
 
-	dev->data->tx_queues[tx_queue_id] = &internals->txq[tx_queue_id];
+	tap_uring_release(&txq->uring);
+	rte_free(txq->iovecs);
+	rte_free(txq->slots);
+	txq->nb_iovecs = iov_max;
+	txq->iovecs = rte_zmalloc_socket(dev->data->name,
+					 sizeof(*txq->iovecs) * txq->nb_iovecs,
+					 0, socket_id);
+	txq->slots = rte_zmalloc_socket(dev->data->name,
+					sizeof(*txq->slots) * TAP_URING_BURST,
+					0, socket_id);
+	if (!txq->iovecs || !txq->slots) {
+		RTE_LOG(WARNING, PMD,
+			"%s: Couldn't allocate TX descriptors\n",
+			dev->data->name);
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	dev->data->tx_queues[tx_queue_id] = txq;
 	ret = tap_setup_queue(dev, internals, tx_queue_id);
 	if (ret == -1)
-		return -1;
+		goto error;
+
+	/* Write a burst of packets at once */
+	if (tap_uring_init(&txq->uring) < 0)
+		RTE_LOG(INFO, PMD,
+			"%s: writing one packet per system call on queue %d: %s\n",
+			dev->data->name, tx_queue_id, strerror(errno));
 
 	RTE_LOG(DEBUG, PMD, "  TX TAP device name %s, qid %d on fd %d\n",
 		internals->name, tx_queue_id, internals->txq[tx_queue_id].fd);
 
 	return 0;
+
+error:
+	rte_free(txq->iovecs);
+	rte_free(txq->slots);
+	txq->iovecs = NULL;
+	txq->slots = NULL;
+	return ret;
 }
 
 static int
@@ -1238,6 +1626,8 @@ eth_dev_tap_create(struct rte_vdev_device *vdev, char *tap_name,
 	for (i = 0; i < RTE_PMD_TAP_MAX_QUEUES; i++) {
 		pmd->rxq[i].fd = -1;
 		pmd->txq[i].fd = -1;
+		pmd->rxq[i].uring.fd = -1;
+		pmd->txq[i].uring.fd = -1;
 	}
 
 	if (fixed_mac_type) {
@@ -39,16 +39,48 @@
 #include <inttypes.h>
 
 #include <linux/if_tun.h>
+#include <linux/virtio_net.h>
 
 #include <rte_ethdev.h>
 #include <rte_ether.h>
 
+#include <tap_uring.h>
+
 #ifdef IFF_MULTI_QUEUE
 #define RTE_PMD_TAP_MAX_QUEUES	16
 #else
 #define RTE_PMD_TAP_MAX_QUEUES	1
 #endif
 
+/* Largest TSO packet accepted for transmission */
+#define TAP_GSO_MAX_LEN	(UINT16_MAX + ETHER_HDR_LEN + 4)
+/* Largest packet headers updated on transmission for offloads */
+#define TAP_TX_HDRS_MAX_LEN	256
+
+/*
+ * Header preceding every packet exchanged with the kernel: packet info,
+ * then virtio-net header carrying checksum and segmentation offloads.
+ */
+struct tap_pkt_hdr {
+	struct tun_pi pi;
+	struct virtio_net_hdr vnet;
+};
+
+/* Packet read in a burst through io_uring, into a single mbuf */
+struct rx_slot {
+	struct tap_pkt_hdr hdr;         /* packet headers for iovecs */
+	struct iovec iovecs[2];         /* packet headers, then mbuf data */
+	struct rte_mbuf *mbuf;          /* mbuf receiving the packet */
+};
+
+/* Packet prepared for writing as part of a burst */
+struct tx_slot {
+	struct tap_pkt_hdr hdr;         /* packet headers for iovecs */
+	char hdrs[TAP_TX_HDRS_MAX_LEN]; /* mbuf headers updated for offloads */
+	struct iovec *iovecs;           /* packet headers, then mbuf data */
+	int nb_iovecs;
+};
+
 struct pkt_stats {
 	uint64_t opackets;              /* Number of output packets */
 	uint64_t ipackets;              /* Number of input packets */
@@ -69,13 +101,21 @@ struct rx_queue {
 	struct rte_eth_rxmode *rxmode;  /* RX features */
 	struct rte_mbuf *pool;          /* mbufs pool for this queue */
 	struct iovec (*iovecs)[];       /* descriptors for this queue */
-	struct tun_pi pi;               /* packet info for iovecs */
+	struct tap_pkt_hdr hdr;         /* packet headers for iovecs */
+	int trigger_off;                /* 1 while SIGIO is disabled on fd */
+	uint16_t nb_reads;              /* reads submitted in a burst */
+	struct tap_uring uring;         /* burst reads, unless fd is -1 */
+	struct rx_slot slots[TAP_URING_BURST]; /* packets of burst reads */
 };
 
 struct tx_queue {
 	int fd;
 	uint16_t *mtu;                  /* Pointer to MTU from dev_data */
 	struct pkt_stats stats;         /* Stats for this TX queue */
+	struct tap_uring uring;         /* burst writes, unless fd is -1 */
+	struct tx_slot *slots;          /* packets of a burst write */
+	struct iovec *iovecs;           /* descriptors for the slots */
+	unsigned int nb_iovecs;         /* size of iovecs */
 };
 
 struct pmd_internals {
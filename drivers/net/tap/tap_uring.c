@@ -0,0 +1,255 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   Copyright 2017 Mellanox.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <rte_atomic.h>
+#include <rte_common.h>
+#include <rte_log.h>
+#include <tap_uring.h>
+
+#ifdef HAVE_IO_URING
+
+#include <linux/io_uring.h>
+
+#ifndef RWF_NOWAIT
+#define RWF_NOWAIT 0x00000008
+#endif
+
+/**
+ * Create an io_uring instance for the reads or writes of a queue.
+ *
+ * @param[out] r
+ *   The io_uring to initialize, its fd is -1 on failure.
+ *
+ * @return
+ *   0 on success, -1 otherwise (errno is set).
+ */
+int
+tap_uring_init(struct tap_uring *r)
+{
+	struct io_uring_params p;
+	int err;
+
+	memset(r, 0, sizeof(*r));
+	memset(&p, 0, sizeof(p));
+	r->fd = syscall(__NR_io_uring_setup, TAP_URING_BURST, &p);
+	if (r->fd < 0)
+		return -1;
+
+	r->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+	r->sq_map = mmap(NULL, r->sq_map_size, PROT_READ | PROT_WRITE,
+			 MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+	if (r->sq_map == MAP_FAILED)
+		goto error;
+	r->cq_map_size = p.cq_off.cqes +
+		p.cq_entries * sizeof(struct io_uring_cqe);
+	r->cq_map = mmap(NULL, r->cq_map_size, PROT_READ | PROT_WRITE,
+			 MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+	if (r->cq_map == MAP_FAILED)
+		goto error;
+	r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+	r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+		       MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if (r->sqes == MAP_FAILED)
+		goto error;
+
+	r->mask = p.sq_entries - 1;
+	r->sq_khead = (uint32_t *)((char *)r->sq_map + p.sq_off.head);
+	r->sq_ktail = (uint32_t *)((char *)r->sq_map + p.sq_off.tail);
+	r->sq_array = (uint32_t *)((char *)r->sq_map + p.sq_off.array);
+	r->sq_tail = *r->sq_ktail;
+	r->cq_mask = p.cq_entries - 1;
+	r->cq_khead = (uint32_t *)((char *)r->cq_map + p.cq_off.head);
+	r->cq_ktail = (uint32_t *)((char *)r->cq_map + p.cq_off.tail);
+	r->cqes = (char *)r->cq_map + p.cq_off.cqes;
+	return 0;
+
+error:
+	err = errno;
+	tap_uring_release(r);
+	errno = err;
+	return -1;
+}
+
+/**
+ * Destroy an io_uring instance, if any.
+ *
+ * @param[in, out] r
+ *   The io_uring to release, its fd is -1 afterwards.
+ */
+void
+tap_uring_release(struct tap_uring *r)
+{
+	if (r->sqes != NULL && r->sqes != MAP_FAILED)
+		munmap(r->sqes, r->sqes_size);
+	if (r->cq_map != NULL && r->cq_map != MAP_FAILED)
+		munmap(r->cq_map, r->cq_map_size);
+	if (r->sq_map != NULL && r->sq_map != MAP_FAILED)
+		munmap(r->sq_map, r->sq_map_size);
+	if (r->fd >= 0)
+		close(r->fd);
+	memset(r, 0, sizeof(*r));
+	r->fd = -1;
+}
+
+/**
+ * Queue the read or write of one packet, submitted by tap_uring_run().
+ * At most TAP_URING_BURST packets can be queued at once.
+ *
+ * @param[in, out] r
+ *   The io_uring to use.
+ * @param[in] write
+ *   Nonzero to write the packet, zero to read it.
+ * @param[in] fd
+ *   The TAP file descriptor.
+ * @param[in] iov
+ *   The packet buffers, which must stay valid until tap_uring_run() returns.
+ * @param[in] nb_iov
+ *   The number of packet buffers.
+ * @param[in] idx
+ *   Index of the packet in the burst, where tap_uring_run() stores its result.
+ */
+void
+tap_uring_prep(struct tap_uring *r, int write, int fd,
+	       const struct iovec *iov, unsigned int nb_iov,
+	       unsigned int idx)
+{
+	struct io_uring_sqe *sqe =
+		&((struct io_uring_sqe *)r->sqes)[r->sq_tail & r->mask];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)iov;
+	sqe->len = nb_iov;
+	/* io_uring waits for a packet to read otherwise */
+	sqe->rw_flags = RWF_NOWAIT;
+	sqe->user_data = idx;
+	r->sq_array[r->sq_tail & r->mask] = r->sq_tail & r->mask;
+	r->sq_tail++;
+}
+
+/**
+ * Submit the queued reads or writes in a single system call and wait for
+ * their completion. The TAP file descriptor being non-blocking, a read
+ * completes with -EAGAIN at once when no packet is pending.
+ *
+ * @param[in, out] r
+ *   The io_uring to use.
+ * @param[in] nb
+ *   The number of queued packets.
+ * @param[out] res
+ *   Results of the reads or writes, as returned by readv() and writev()
+ *   except that errors are negative errno values.
+ *
+ * @return
+ *   0 on success, -1 otherwise (errno is set), in which case the results of
+ *   the packets not completed are left untouched.
+ */
+int
+tap_uring_run(struct tap_uring *r, unsigned int nb, int32_t *res)
+{
+	const struct io_uring_cqe *cqes = r->cqes;
+	unsigned int done = 0;
+
+	/* entries must be written before the kernel sees them */
+	rte_smp_wmb();
+	*r->sq_ktail = r->sq_tail;
+	while (done < nb) {
+		uint32_t head;
+		uint32_t tail;
+
+		if (syscall(__NR_io_uring_enter, r->fd,
+			    r->sq_tail - *r->sq_khead, nb - done,
+			    IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+		    errno != EINTR && errno != EAGAIN) {
+			/* take back what the kernel did not consume */
+			r->sq_tail = *r->sq_khead;
+			*r->sq_ktail = r->sq_tail;
+			return -1;
+		}
+		head = *r->cq_khead;
+		tail = *r->cq_ktail;
+		rte_smp_rmb();
+		for (; head != tail; head++) {
+			const struct io_uring_cqe *cqe =
+				&cqes[head & r->cq_mask];
+
+			res[cqe->user_data] = cqe->res;
+			done++;
+		}
+		/* completions must be read before being released */
+		rte_smp_mb();
+		*r->cq_khead = head;
+	}
+	return 0;
+}
+
+#else /* HAVE_IO_URING */
+
+int
+tap_uring_init(struct tap_uring *r)
+{
+	memset(r, 0, sizeof(*r));
+	r->fd = -1;
+	errno = ENOTSUP;
+	return -1;
+}
+
+void
+tap_uring_release(struct tap_uring *r)
+{
+	r->fd = -1;
+}
+
+void
+tap_uring_prep(struct tap_uring *r __rte_unused, int write __rte_unused,
+	       int fd __rte_unused, const struct iovec *iov __rte_unused,
+	       unsigned int nb_iov __rte_unused, unsigned int idx __rte_unused)
+{
+}
+
+int
+tap_uring_run(struct tap_uring *r __rte_unused, unsigned int nb __rte_unused,
+	      int32_t *res __rte_unused)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+
+#endif /* HAVE_IO_URING */
@@ -0,0 +1,77 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   Copyright 2017 Mellanox.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _TAP_URING_H_
+#define _TAP_URING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <tap_autoconf.h>
+
+/* Largest number of packets read or written per system call */
+#define TAP_URING_BURST 32
+
+/*
+ * io_uring instance used to read or write a burst of packets on a TAP file
+ * descriptor in a single system call. Its fd is -1 when io_uring is not
+ * available, and packets are then read or written one at a time.
+ */
+struct tap_uring {
+	int fd;                         /* io_uring file descriptor */
+	uint32_t mask;                  /* ring size - 1 */
+	uint32_t sq_tail;               /* next submission entry */
+	volatile uint32_t *sq_khead;    /* submission entries consumed */
+	volatile uint32_t *sq_ktail;    /* submission entries produced */
+	uint32_t *sq_array;             /* submission entry indexes */
+	void *sqes;                     /* submission entries */
+	volatile uint32_t *cq_khead;    /* completion entries consumed */
+	volatile uint32_t *cq_ktail;    /* completion entries produced */
+	uint32_t cq_mask;               /* completion ring size - 1 */
+	void *cqes;                     /* completion entries */
+	void *sq_map;
+	size_t sq_map_size;
+	void *cq_map;
+	size_t cq_map_size;
+	size_t sqes_size;
+};
+
+int tap_uring_init(struct tap_uring *r);
+void tap_uring_release(struct tap_uring *r);
+void tap_uring_prep(struct tap_uring *r, int write, int fd,
+		    const struct iovec *iov, unsigned int nb_iov,
+		    unsigned int idx);
+int tap_uring_run(struct tap_uring *r, unsigned int nb, int32_t *res);
+
+#endif /* _TAP_URING_H_ */
@@ -42,6 +42,8 @@
 #include <rte_vdev.h>
 #include <rte_kvargs.h>
 #include <rte_vhost.h>
+#include <rte_vhost_async.h>
+#include <rte_ring.h>
 #include <rte_spinlock.h>
 
 #include "rte_eth_vhost.h"
@@ -52,13 +54,18 @@ enum {VIRTIO_RXQ, VIRTIO_TXQ, VIRTIO_QNUM};
 #define ETH_VHOST_QUEUES_ARG		"queues"
 #define ETH_VHOST_CLIENT_ARG		"client"
 #define ETH_VHOST_DEQUEUE_ZERO_COPY	"dequeue-zero-copy"
+#define ETH_VHOST_ASYNC_COPY_CPU	"async-copy-cpu"
 #define VHOST_MAX_PKT_BURST 32
+/* packets shorter than this are copied inline even in async mode */
+#define VHOST_ASYNC_THRESHOLD 256
+#define VHOST_ASYNC_RING_SIZE 4096
 
 static const char *valid_arguments[] = {
 	ETH_VHOST_IFACE_ARG,
 	ETH_VHOST_QUEUES_ARG,
 	ETH_VHOST_CLIENT_ARG,
 	ETH_VHOST_DEQUEUE_ZERO_COPY,
+	ETH_VHOST_ASYNC_COPY_CPU,
 	NULL
 };
 
@@ -107,6 +114,7 @@ struct vhost_queue {
 	struct rte_mempool *mb_pool;
 	uint8_t port;
 	uint16_t virtqueue_id;
+	int async;
 	struct vhost_stats stats;
 };
 
@@ -116,6 +124,7 @@ struct pmd_internal {
 	char *iface_name;
 	uint16_t max_queues;
 	rte_atomic32_t started;
+	struct rte_vhost_async_cpu_engine *async_engine;
 };
 
 struct internal_list {
@@ -434,7 +443,8 @@ static uint16_t
 eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
 	struct vhost_queue *r = q;
-	uint16_t i, nb_tx = 0;
+	struct rte_mbuf *cpl[VHOST_MAX_PKT_BURST];
+	uint16_t i, nb_tx = 0, nb_cpl;
 	uint16_t nb_send = nb_bufs;
 
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
@@ -445,14 +455,26 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
 		goto out;
 
+	/* Release the packets whose asynchronous copy is done */
+	if (r->async) {
+		nb_cpl = rte_vhost_poll_enqueue_completed(r->vid,
+				r->virtqueue_id, cpl, VHOST_MAX_PKT_BURST);
+		for (i = 0; i < nb_cpl; i++)
+			rte_pktmbuf_free(cpl[i]);
+	}
+
 	/* Enqueue packets to guest RX queue */
 	while (nb_send) {
 		uint16_t nb_pkts;
 		uint16_t num = (uint16_t)RTE_MIN(nb_send,
 						 VHOST_MAX_PKT_BURST);
 
-		nb_pkts = rte_vhost_enqueue_burst(r->vid, r->virtqueue_id,
-						  &bufs[nb_tx], num);
+		if (r->async)
+			nb_pkts = rte_vhost_submit_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num);
+		else
+			nb_pkts = rte_vhost_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num);
 
 		nb_tx += nb_pkts;
 		nb_send -= nb_pkts;
@@ -475,8 +497,11 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	for (i = nb_tx; i < nb_bufs; i++)
 		vhost_count_multicast_broadcast(r, bufs[i]);
 
-	for (i = 0; likely(i < nb_tx); i++)
-		rte_pktmbuf_free(bufs[i]);
+	/* In async mode, vhost owns the packets until they are completed */
+	if (!r->async) {
+		for (i = 0; likely(i < nb_tx); i++)
+			rte_pktmbuf_free(bufs[i]);
+	}
 out:
 	rte_atomic32_set(&r->while_queuing, 0);
 
@@ -549,6 +574,44 @@ update_queuing_status(struct rte_eth_dev *dev)
 	}
 }
 
+static void
+vhost_async_setup(struct pmd_internal *internal, struct vhost_queue *vq)
+{
+	if (internal->async_engine == NULL)
+		return;
+
+	if (rte_vhost_async_cpu_channel_register(vq->vid, vq->virtqueue_id,
+			VHOST_ASYNC_THRESHOLD, internal->async_engine) < 0) {
+		RTE_LOG(WARNING, PMD,
+			"Failed to set up async copy on vring %u\n",
+			vq->virtqueue_id);
+		return;
+	}
+
+	vq->async = 1;
+}
+
+/* Wait for the in-flight packets to be completed and release the channel */
+static void
+vhost_async_teardown(struct vhost_queue *vq)
+{
+	struct rte_mbuf *pkts[VHOST_MAX_PKT_BURST];
+	uint16_t i, n;
+
+	if (!vq->async)
+		return;
+
+	while (rte_vhost_async_get_inflight(vq->vid, vq->virtqueue_id) > 0) {
+		n = rte_vhost_poll_enqueue_completed(vq->vid, vq->virtqueue_id,
+				pkts, VHOST_MAX_PKT_BURST);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(pkts[i]);
+	}
+
+	rte_vhost_async_cpu_channel_unregister(vq->vid, vq->virtqueue_id);
+	vq->async = 0;
+}
+
 static int
 new_device(int vid)
 {
@@ -593,6 +656,7 @@ new_device(int vid)
 		vq->vid = vid;
 		vq->internal = internal;
 		vq->port = eth_dev->data->port_id;
+		vhost_async_setup(internal, vq);
 	}
 
 	for (i = 0; i < rte_vhost_get_vring_num(vid); i++)
@@ -647,6 +711,7 @@ destroy_device(int vid)
 		vq = eth_dev->data->tx_queues[i];
 		if (vq == NULL)
 			continue;
+		vhost_async_teardown(vq);
 		vq->vid = -1;
 	}
 
@@ -816,6 +881,8 @@ eth_dev_close(struct rte_eth_dev *dev)
 	for (i = 0; i < dev->data->nb_tx_queues; i++)
 		rte_free(dev->data->tx_queues[i]);
 
+	rte_vhost_async_cpu_engine_free(internal->async_engine);
+
 	rte_free(dev->data->mac_addrs);
 	free(internal->dev_name);
 	free(internal->iface_name);
@@ -996,7 +1063,8 @@ static struct rte_vdev_driver pmd_vhost_drv;
 
 static int
 eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
-	int16_t queues, const unsigned int numa_node, uint64_t flags)
+	int16_t queues, const unsigned int numa_node, uint64_t flags,
+	int async_cpu)
 {
 	const char *name = rte_vdev_device_name(dev);
 	struct rte_eth_dev_data *data = NULL;
@@ -1005,6 +1073,7 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	struct ether_addr *eth_addr = NULL;
 	struct rte_vhost_vring_state *vring_state = NULL;
 	struct internal_list *list = NULL;
+	char engine_name[RTE_RING_NAMESIZE];
 
 	RTE_LOG(INFO, PMD, "Creating VHOST-USER backend on numa socket %u\n",
 		numa_node);
@@ -1049,6 +1118,15 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	if (internal->iface_name == NULL)
 		goto error;
 
+	if (async_cpu >= 0) {
+		snprintf(engine_name, sizeof(engine_name), "vhost_async_%u",
+			eth_dev->data->port_id);
+		internal->async_engine = rte_vhost_async_cpu_engine_create(
+				engine_name, async_cpu, VHOST_ASYNC_RING_SIZE);
+		if (internal->async_engine == NULL)
+			goto error;
+	}
+
 	list->eth_dev = eth_dev;
 	pthread_mutex_lock(&internal_list_lock);
 	TAILQ_INSERT_TAIL(&internal_list, list, next);
@@ -1095,6 +1173,7 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 
 error:
 	if (internal) {
+		rte_vhost_async_cpu_engine_free(internal->async_engine);
 		free(internal->iface_name);
 		free(internal->dev_name);
 	}
@@ -1147,6 +1226,8 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 	uint64_t flags = 0;
 	int client_mode = 0;
 	int dequeue_zero_copy = 0;
+	uint16_t async_copy_cpu;
+	int async_cpu = -1;
 
 	RTE_LOG(INFO, PMD, "Initializing pmd_vhost for %s\n",
 		rte_vdev_device_name(dev));
@@ -1194,11 +1275,20 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 			flags |= RTE_VHOST_USER_DEQUEUE_ZERO_COPY;
 	}
 
+	if (rte_kvargs_count(kvlist, ETH_VHOST_ASYNC_COPY_CPU) == 1) {
+		ret = rte_kvargs_process(kvlist, ETH_VHOST_ASYNC_COPY_CPU,
+					 &open_int, &async_copy_cpu);
+		if (ret < 0)
+			goto out_free;
+
+		async_cpu = async_copy_cpu;
+	}
+
 	if (dev->device.numa_node == SOCKET_ID_ANY)
 		dev->device.numa_node = rte_socket_id();
 
 	eth_dev_vhost_create(dev, iface_name, queues, dev->device.numa_node,
-		flags);
+		flags, async_cpu);
 
 out_free:
 	rte_kvargs_free(kvlist);
@@ -1240,4 +1330,5 @@ RTE_PMD_REGISTER_VDEV(net_vhost, pmd_vhost_drv);
 RTE_PMD_REGISTER_ALIAS(net_vhost, eth_vhost);
 RTE_PMD_REGISTER_PARAM_STRING(net_vhost,
 	"iface=<ifc> "
-	"queues=<int>");
+	"queues=<int> "
+	"async-copy-cpu=<int>");
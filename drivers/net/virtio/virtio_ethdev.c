@@ -1238,10 +1238,26 @@ static void
 rx_func_get(struct rte_eth_dev *eth_dev)
 {
 	struct virtio_hw *hw = eth_dev->data->dev_private;
+	int in_order = vtpci_with_feature(hw, VIRTIO_F_IN_ORDER);
+
 	if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF))
-		eth_dev->rx_pkt_burst = &virtio_recv_mergeable_pkts;
+		eth_dev->rx_pkt_burst = in_order ?
+			&virtio_recv_mergeable_pkts_inorder :
+			&virtio_recv_mergeable_pkts;
+	else
+		eth_dev->rx_pkt_burst = in_order ?
+			&virtio_recv_pkts_inorder : &virtio_recv_pkts;
+}
+
+static void
+tx_func_get(struct rte_eth_dev *eth_dev)
+{
+	struct virtio_hw *hw = eth_dev->data->dev_private;
+
+	if (vtpci_with_feature(hw, VIRTIO_F_IN_ORDER))
+		eth_dev->tx_pkt_burst = &virtio_xmit_pkts_inorder;
 	else
-		eth_dev->rx_pkt_burst = &virtio_recv_pkts;
+		eth_dev->tx_pkt_burst = &virtio_xmit_pkts;
 }
 
 /* Only support 1:1 queue/interrupt mapping so far.
@@ -1367,6 +1383,7 @@ virtio_init_device(struct rte_eth_dev *eth_dev, uint64_t req_features)
 		eth_dev->data->dev_flags &= ~RTE_ETH_DEV_INTR_LSC;
 
 	rx_func_get(eth_dev);
+	tx_func_get(eth_dev);
 
 	/* Setting up rx_header size for the device */
 	if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF) ||
@@ -1548,6 +1565,7 @@ eth_virtio_dev_init(struct rte_eth_dev *eth_dev)
 			eth_dev->rx_pkt_burst = virtio_recv_pkts_vec;
 		} else {
 			rx_func_get(eth_dev);
+			tx_func_get(eth_dev);
 		}
 		return 0;
 	}
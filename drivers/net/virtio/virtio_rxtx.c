@@ -149,6 +149,53 @@ virtqueue_dequeue_burst_rx(struct virtqueue *vq, struct rte_mbuf **rx_pkts,
 	return i;
 }
 
+/*
+ * With VIRTIO_F_IN_ORDER the device uses the buffers in the same order
+ * they were made available, so the head of each chain is taken from the
+ * avail ring and only the length is read from the used ring.
+ */
+static uint16_t
+virtqueue_dequeue_burst_rx_inorder(struct virtqueue *vq,
+				   struct rte_mbuf **rx_pkts,
+				   uint32_t *len, uint16_t num)
+{
+	struct rte_mbuf *cookie;
+	uint16_t used_idx, desc_idx;
+	uint16_t i;
+
+	/*  Caller does the check */
+	for (i = 0; i < num ; i++) {
+		used_idx = (uint16_t)(vq->vq_used_cons_idx & (vq->vq_nentries - 1));
+		desc_idx = vq->vq_ring.avail->ring[used_idx];
+		len[i] = vq->vq_ring.used->ring[used_idx].len;
+		cookie = (struct rte_mbuf *)vq->vq_descx[desc_idx].cookie;
+
+		if (unlikely(cookie == NULL)) {
+			PMD_DRV_LOG(ERR, "vring descriptor with no mbuf cookie at %u",
+				vq->vq_used_cons_idx);
+			break;
+		}
+
+		rte_prefetch0(cookie);
+		rte_packet_prefetch(rte_pktmbuf_mtod(cookie, void *));
+		rx_pkts[i]  = cookie;
+		vq->vq_used_cons_idx++;
+		vq_ring_free_chain(vq, desc_idx);
+		vq->vq_descx[desc_idx].cookie = NULL;
+	}
+
+	return i;
+}
+
+static __rte_always_inline uint16_t
+virtqueue_dequeue_rx(struct virtqueue *vq, struct rte_mbuf **rx_pkts,
+		     uint32_t *len, uint16_t num, int in_order)
+{
+	if (in_order)
+		return virtqueue_dequeue_burst_rx_inorder(vq, rx_pkts, len, num);
+	return virtqueue_dequeue_burst_rx(vq, rx_pkts, len, num);
+}
+
 #ifndef DEFAULT_TX_FREE_THRESH
 #define DEFAULT_TX_FREE_THRESH 32
 #endif
@@ -177,6 +224,42 @@ virtio_xmit_cleanup(struct virtqueue *vq, uint16_t num)
 	}
 }
 
+/*
+ * Cleanup from completed transmits when VIRTIO_F_IN_ORDER is negotiated.
+ * The device may write back only the used entry of the last chain of a
+ * batch, so the used ring is never read here: the completed chains are
+ * the ones made available right after the last consumed one.
+ */
+static void
+virtio_xmit_cleanup_inorder(struct virtqueue *vq, uint16_t num)
+{
+	uint16_t i, used_idx, desc_idx;
+
+	for (i = 0; i < num; i++) {
+		struct vq_desc_extra *dxp;
+
+		used_idx = (uint16_t)(vq->vq_used_cons_idx & (vq->vq_nentries - 1));
+		desc_idx = vq->vq_ring.avail->ring[used_idx];
+		dxp = &vq->vq_descx[desc_idx];
+		vq->vq_used_cons_idx++;
+		vq_ring_free_chain(vq, desc_idx);
+
+		if (dxp->cookie != NULL) {
+			rte_pktmbuf_free(dxp->cookie);
+			dxp->cookie = NULL;
+		}
+	}
+}
+
+static __rte_always_inline void
+virtio_xmit_cleanup_common(struct virtqueue *vq, uint16_t num, int in_order)
+{
+	if (in_order)
+		virtio_xmit_cleanup_inorder(vq, num);
+	else
+		virtio_xmit_cleanup(vq, num);
+}
+
 
 static inline int
 virtqueue_enqueue_recv_refill(struct virtqueue *vq, struct rte_mbuf *cookie)
@@ -720,8 +803,9 @@ rx_offload_enabled(struct virtio_hw *hw)
 
 #define VIRTIO_MBUF_BURST_SZ 64
 #define DESC_PER_CACHELINE (RTE_CACHE_LINE_SIZE / sizeof(struct vring_desc))
-uint16_t
-virtio_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
+static __rte_always_inline uint16_t
+virtio_recv_pkts_common(void *rx_queue, struct rte_mbuf **rx_pkts,
+			uint16_t nb_pkts, int in_order)
 {
 	struct virtnet_rx *rxvq = rx_queue;
 	struct virtqueue *vq = rxvq->vq;
@@ -749,7 +833,7 @@ virtio_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
 	if (likely(num > DESC_PER_CACHELINE))
 		num = num - ((vq->vq_used_cons_idx + num) % DESC_PER_CACHELINE);
 
-	num = virtqueue_dequeue_burst_rx(vq, rcv_pkts, len, num);
+	num = virtqueue_dequeue_rx(vq, rcv_pkts, len, num, in_order);
 	PMD_RX_LOG(DEBUG, "used:%d dequeue:%d", nb_used, num);
 
 	nb_enqueued = 0;
@@ -830,9 +914,22 @@ virtio_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
 }
 
 uint16_t
-virtio_recv_mergeable_pkts(void *rx_queue,
+virtio_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
+{
+	return virtio_recv_pkts_common(rx_queue, rx_pkts, nb_pkts, 0);
+}
+
+uint16_t
+virtio_recv_pkts_inorder(void *rx_queue, struct rte_mbuf **rx_pkts,
+			 uint16_t nb_pkts)
+{
+	return virtio_recv_pkts_common(rx_queue, rx_pkts, nb_pkts, 1);
+}
+
+static __rte_always_inline uint16_t
+virtio_recv_mergeable_pkts_common(void *rx_queue,
 			struct rte_mbuf **rx_pkts,
-			uint16_t nb_pkts)
+			uint16_t nb_pkts, int in_order)
 {
 	struct virtnet_rx *rxvq = rx_queue;
 	struct virtqueue *vq = rxvq->vq;
@@ -874,7 +971,7 @@ virtio_recv_mergeable_pkts(void *rx_queue,
 		if (nb_rx == nb_pkts)
 			break;
 
-		num = virtqueue_dequeue_burst_rx(vq, rcv_pkts, len, 1);
+		num = virtqueue_dequeue_rx(vq, rcv_pkts, len, 1, in_order);
 		if (num != 1)
 			continue;
 
@@ -927,8 +1024,8 @@ virtio_recv_mergeable_pkts(void *rx_queue,
 				RTE_MIN(seg_res, RTE_DIM(rcv_pkts));
 			if (likely(VIRTQUEUE_NUSED(vq) >= rcv_cnt)) {
 				uint32_t rx_num =
-					virtqueue_dequeue_burst_rx(vq,
-					rcv_pkts, len, rcv_cnt);
+					virtqueue_dequeue_rx(vq,
+					rcv_pkts, len, rcv_cnt, in_order);
 				i += rx_num;
 				rcv_cnt = rx_num;
 			} else {
@@ -1003,7 +1100,24 @@ virtio_recv_mergeable_pkts(void *rx_queue,
 }
 
 uint16_t
-virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+virtio_recv_mergeable_pkts(void *rx_queue,
+			struct rte_mbuf **rx_pkts,
+			uint16_t nb_pkts)
+{
+	return virtio_recv_mergeable_pkts_common(rx_queue, rx_pkts, nb_pkts, 0);
+}
+
+uint16_t
+virtio_recv_mergeable_pkts_inorder(void *rx_queue,
+			struct rte_mbuf **rx_pkts,
+			uint16_t nb_pkts)
+{
+	return virtio_recv_mergeable_pkts_common(rx_queue, rx_pkts, nb_pkts, 1);
+}
+
+static __rte_always_inline uint16_t
+virtio_xmit_pkts_common(void *tx_queue, struct rte_mbuf **tx_pkts,
+			uint16_t nb_pkts, int in_order)
 {
 	struct virtnet_tx *txvq = tx_queue;
 	struct virtqueue *vq = txvq->vq;
@@ -1023,7 +1137,7 @@ virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 
 	virtio_rmb();
 	if (likely(nb_used > vq->vq_nentries - vq->vq_free_thresh))
-		virtio_xmit_cleanup(vq, nb_used);
+		virtio_xmit_cleanup_common(vq, nb_used, in_order);
 
 	for (nb_tx = 0; nb_tx < nb_pkts; nb_tx++) {
 		struct rte_mbuf *txm = tx_pkts[nb_tx];
@@ -1066,7 +1180,7 @@ virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 			virtio_rmb();
 			need = RTE_MIN(need, (int)nb_used);
 
-			virtio_xmit_cleanup(vq, need);
+			virtio_xmit_cleanup_common(vq, need, in_order);
 			need = slots - vq->vq_free_cnt;
 			if (unlikely(need > 0)) {
 				PMD_TX_LOG(ERR,
@@ -1095,3 +1209,16 @@ virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 
 	return nb_tx;
 }
+
+uint16_t
+virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	return virtio_xmit_pkts_common(tx_queue, tx_pkts, nb_pkts, 0);
+}
+
+uint16_t
+virtio_xmit_pkts_inorder(void *tx_queue, struct rte_mbuf **tx_pkts,
+			 uint16_t nb_pkts)
+{
+	return virtio_xmit_pkts_common(tx_queue, tx_pkts, nb_pkts, 1);
+}
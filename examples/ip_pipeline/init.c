@@ -1497,6 +1497,8 @@ void app_pipeline_params_get(struct app_params *app,
 				params->queue_id = txq_queue_id;
 				params->tx_burst_sz =
 					app->hwq_out_params[in->id].burst;
+				params->tx_flush_cycles = 0;
+				params->latency = NULL;
 			} else {
 				struct rte_port_ethdev_writer_nodrop_params
 					*params = &out->params.ethdev_nodrop;
@@ -1524,6 +1526,8 @@ void app_pipeline_params_get(struct app_params *app,
 						params->ring = app->swq[in->id];
 						params->tx_burst_sz =
 							app->swq_params[in->id].burst_write;
+						params->tx_flush_cycles = 0;
+						params->latency = NULL;
 					} else {
 						struct rte_port_ring_writer_nodrop_params
 							*params = &out->params.ring_nodrop;
@@ -1544,6 +1548,8 @@ void app_pipeline_params_get(struct app_params *app,
 						out->type = PIPELINE_PORT_OUT_RING_MULTI_WRITER;
 						params->ring = app->swq[in->id];
 						params->tx_burst_sz = swq_params->burst_write;
+						params->tx_flush_cycles = 0;
+						params->latency = NULL;
 					} else {
 						struct rte_port_ring_multi_writer_nodrop_params
 							*params = &out->params.ring_multi_nodrop;
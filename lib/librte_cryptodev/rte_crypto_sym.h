@@ -386,6 +386,53 @@ enum rte_crypto_sym_op_sess_type {
 	RTE_CRYPTO_SYM_OP_SESSIONLESS	/**< Session-less crypto operation */
 };
 
+/**
+ * Crypto virtual and IO address vector, describing one contiguous chunk of
+ * data used by the synchronous CPU crypto API.
+ */
+struct rte_crypto_vec {
+	void *base;	/**< virtual address of the data buffer */
+	uint32_t len;	/**< length of the data buffer */
+};
+
+/**
+ * Scatter-gather list of data buffers making up a single packet.
+ */
+struct rte_crypto_sgl {
+	struct rte_crypto_vec *vec;	/**< array of data buffers */
+	uint32_t num;			/**< number of entries in *vec* */
+};
+
+/**
+ * Burst of packets to be processed through the synchronous CPU crypto API,
+ * see rte_cryptodev_sym_cpu_crypto_process(). All arrays hold *num* entries,
+ * entry i of each array describing packet i of the burst.
+ */
+struct rte_crypto_sym_vec {
+	struct rte_crypto_sgl *sgl;	/**< data of each packet */
+	void **iv;			/**< IV of each packet */
+	void **aad;			/**< AAD of each packet (AEAD only) */
+	void **digest;
+	/**< digest of each packet, written on generate, read on verify */
+	int32_t *status;
+	/**< per packet status: zero on success, positive errno on failure */
+	uint32_t num;			/**< number of packets in the burst */
+};
+
+/**
+ * Offsets of the region to authenticate and of the region to cipher, given
+ * as bytes to skip from the head and from the tail of each packet.
+ */
+union rte_crypto_sym_ofs {
+	uint64_t raw;
+	struct {
+		struct {
+			uint16_t head;
+			uint16_t tail;
+		} auth, cipher;
+	} ofs;
+};
+
 
 struct rte_cryptodev_sym_session;
 
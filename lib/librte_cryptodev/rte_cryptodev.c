@@ -431,6 +431,8 @@ rte_cryptodev_get_feature_name(uint64_t flag)
 		return "CPU_NEON";
 	case RTE_CRYPTODEV_FF_CPU_ARM_CE:
 		return "CPU_ARM_CE";
+	case RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO:
+		return "SYM_CPU_CRYPTO";
 	default:
 		return NULL;
 	}
@@ -1446,6 +1448,42 @@ rte_cryptodev_queue_pair_detach_sym_session(uint16_t qp_id,
 
 	return 0;
 }
+
+static uint32_t
+sym_cpu_crypto_fail(struct rte_crypto_sym_vec *vec, int32_t err)
+{
+	uint32_t i;
+
+	for (i = 0; i < vec->num; i++)
+		vec->status[i] = err;
+
+	return 0;
+}
+
+uint32_t
+rte_cryptodev_sym_cpu_crypto_process(uint8_t dev_id,
+		struct rte_cryptodev_sym_session *sess,
+		union rte_crypto_sym_ofs ofs, struct rte_crypto_sym_vec *vec)
+{
+	struct rte_cryptodev *dev;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id)) {
+		CDEV_LOG_ERR("Invalid dev_id=%d", dev_id);
+		return sym_cpu_crypto_fail(vec, EINVAL);
+	}
+
+	dev = &rte_crypto_devices[dev_id];
+
+	if (sess == NULL || sess->dev_id != dev_id)
+		return sym_cpu_crypto_fail(vec, EINVAL);
+
+	if (dev->dev_ops->sym_cpu_process == NULL ||
+			!(dev->feature_flags & RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO))
+		return sym_cpu_crypto_fail(vec, ENOTSUP);
+
+	return dev->dev_ops->sym_cpu_process(dev, sess->_private, ofs, vec);
+}
+
 struct rte_cryptodev_sym_session *
 rte_cryptodev_sym_session_free(uint8_t dev_id,
 		struct rte_cryptodev_sym_session *sess)
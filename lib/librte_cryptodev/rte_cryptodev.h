@@ -305,6 +305,8 @@ rte_cryptodev_get_auth_algo_enum(enum rte_crypto_auth_algorithm *algo_enum,
 /**< Utilises CPU NEON instructions */
 #define	RTE_CRYPTODEV_FF_CPU_ARM_CE		(1ULL << 11)
 /**< Utilises ARM CPU Cryptographic Extensions */
+#define	RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO		(1ULL << 12)
+/**< Synchronous CPU crypto processing of sessions is supported */
 
 
 /**
@@ -953,6 +955,35 @@ int
 rte_cryptodev_queue_pair_detach_sym_session(uint16_t qp_id,
 		struct rte_cryptodev_sym_session *session);
 
+/**
+ * Synchronously process a burst of packets with a symmetric session on the
+ * calling lcore, without crypto operations or queue pairs.
+ *
+ * Only available on devices advertising RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO.
+ * Data is transformed in place; the same head/tail offsets apply to every
+ * packet of the burst. For verify sessions the digest referenced by
+ * *vec->digest* is compared, and a mismatch is reported as EBADMSG in the
+ * status of that packet.
+ *
+ * Unless the PMD documents otherwise, a session must not be used by
+ * several lcores at the same time with this function.
+ *
+ * @param	dev_id		The device identifier.
+ * @param	sess		Session previously created on *dev_id* by
+ *				*rte_cryptodev_sym_session_create*.
+ * @param	ofs		Start and stop offsets of the auth and cipher
+ *				regions of each packet.
+ * @param	vec		Burst of packets; *vec->status* is filled in
+ *				for every packet.
+ *
+ * @return
+ *  - The number of packets successfully processed.
+ */
+uint32_t
+rte_cryptodev_sym_cpu_crypto_process(uint8_t dev_id,
+		struct rte_cryptodev_sym_session *sess,
+		union rte_crypto_sym_ofs ofs, struct rte_crypto_sym_vec *vec);
+
 
 #ifdef __cplusplus
 }
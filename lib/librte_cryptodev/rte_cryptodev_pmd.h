@@ -401,6 +401,22 @@ typedef int (*cryptodev_sym_queue_pair_detach_session_t)(
 		  uint16_t qp_id,
 		  void *session_private);
 
+/**
+ * Synchronously process a burst of packets with a session on the calling
+ * lcore.
+ *
+ * @param	dev		Crypto device pointer
+ * @param	session_private	Pointer to cryptodev's private session structure
+ * @param	ofs		Start and stop offsets of auth and cipher regions
+ * @param	vec		Burst of packets, with a status entry per packet
+ *
+ * @return
+ *  - Returns number of successfully processed packets
+ */
+typedef uint32_t (*cryptodev_sym_cpu_crypto_process_t)(
+		struct rte_cryptodev *dev, void *session_private,
+		union rte_crypto_sym_ofs ofs, struct rte_crypto_sym_vec *vec);
+
 /** Crypto device operations function pointer table */
 struct rte_cryptodev_ops {
 	cryptodev_configure_t dev_configure;	/**< Configure device. */
@@ -438,6 +454,8 @@ struct rte_cryptodev_ops {
 	/**< Attach session to queue pair. */
 	cryptodev_sym_queue_pair_attach_session_t qp_detach_session;
 	/**< Detach session from queue pair. */
+	cryptodev_sym_cpu_crypto_process_t sym_cpu_process;
+	/**< Synchronous CPU crypto processing of a burst. */
 };
 
 
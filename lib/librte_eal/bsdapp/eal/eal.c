@@ -72,6 +72,7 @@
 #include <rte_common.h>
 #include <rte_version.h>
 #include <rte_atomic.h>
+#include <rte_service.h>
 #include <malloc_heap.h>
 
 #include "eal_private.h"
@@ -653,6 +654,13 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	/* set up the service cores before the devices register services */
+	if (rte_service_init() < 0) {
+		rte_eal_init_alert("Cannot init service cores\n");
+		rte_errno = ENOEXEC;
+		return -1;
+	}
+
 	/* Probe all the buses and devices/drivers on them */
 	if (rte_bus_probe()) {
 		rte_eal_init_alert("Cannot probe devices\n");
@@ -660,6 +668,14 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	/* run the registered services, when service cores are given */
+	ret = rte_service_start_with_defaults();
+	if (ret < 0 && ret != -ENOTSUP) {
+		rte_eal_init_alert("Cannot start service cores\n");
+		rte_errno = ENOEXEC;
+		return -1;
+	}
+
 	rte_eal_mcfg_complete();
 
 	return fctret;
@@ -192,3 +192,22 @@ rte_eal_hugepage_attach(void)
 		close(fd_hugepage);
 	return -1;
 }
+
+/* contigmem is mapped once at startup, there is no memory to grow into */
+struct rte_memseg *
+rte_eal_memory_grow(int socket_id __rte_unused, size_t len __rte_unused)
+{
+	return NULL;
+}
+
+int
+rte_eal_memory_shrink(const struct rte_memseg *ms __rte_unused,
+		size_t *len __rte_unused)
+{
+	return -1;
+}
+
+void
+rte_eal_memory_release(int socket_id __rte_unused)
+{
+}
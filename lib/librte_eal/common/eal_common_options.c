@@ -67,6 +67,7 @@ eal_short_options[] =
 	"m:" /* memory size */
 	"n:" /* memory channels */
 	"r:" /* memory ranks */
+	"s:" /* service coremask */
 	"v"  /* version */
 	"w:" /* pci-whitelist */
 	;
@@ -75,6 +76,7 @@ const struct option
 eal_long_options[] = {
 	{OPT_BASE_VIRTADDR,     1, NULL, OPT_BASE_VIRTADDR_NUM    },
 	{OPT_CREATE_UIO_DEV,    0, NULL, OPT_CREATE_UIO_DEV_NUM   },
+	{OPT_DYNAMIC_MEM,       0, NULL, OPT_DYNAMIC_MEM_NUM      },
 	{OPT_FILE_PREFIX,       1, NULL, OPT_FILE_PREFIX_NUM      },
 	{OPT_HELP,              0, NULL, OPT_HELP_NUM             },
 	{OPT_HUGE_DIR,          1, NULL, OPT_HUGE_DIR_NUM         },
@@ -150,6 +152,7 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 	internal_cfg->syslog_facility = LOG_DAEMON;
 
 	internal_cfg->xen_dom0_support = 0;
+	internal_cfg->dynamic_mem = 0;
 
 	/* if set to NONE, interrupt mode is determined automatically */
 	internal_cfg->vfio_intr_mode = RTE_INTR_MODE_NONE;
@@ -161,6 +164,8 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 #endif
 	internal_cfg->vmware_tsc_map = 0;
 	internal_cfg->create_uio_dev = 0;
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		internal_cfg->service_lcore[i] = 0;
 }
 
 static int
@@ -329,6 +334,54 @@ eal_parse_coremask(const char *coremask)
 	return 0;
 }
 
+static int
+eal_parse_service_coremask(const char *coremask,
+		struct internal_config *conf)
+{
+	int i, j, idx = 0;
+	unsigned int count = 0;
+	char c;
+	int val;
+
+	if (coremask == NULL)
+		return -1;
+	/* Remove all blank characters ahead and after .
+	 * Remove 0x/0X if exists.
+	 */
+	while (isblank(*coremask))
+		coremask++;
+	if (coremask[0] == '0' && ((coremask[1] == 'x')
+		|| (coremask[1] == 'X')))
+		coremask += 2;
+	i = strlen(coremask);
+	while ((i > 0) && isblank(coremask[i - 1]))
+		i--;
+	if (i == 0)
+		return -1;
+
+	for (i = i - 1; i >= 0 && idx < RTE_MAX_LCORE; i--) {
+		c = coremask[i];
+		if (isxdigit(c) == 0) {
+			/* invalid characters */
+			return -1;
+		}
+		val = xdigit2val(c);
+		for (j = 0; j < BITS_PER_HEX && idx < RTE_MAX_LCORE;
+				j++, idx++) {
+			conf->service_lcore[idx] = !!((1 << j) & val);
+			count += conf->service_lcore[idx];
+		}
+	}
+	for (; i >= 0; i--)
+		if (coremask[i] != '0')
+			return -1;
+	for (; idx < RTE_MAX_LCORE; idx++)
+		conf->service_lcore[idx] = 0;
+	if (count == 0)
+		return -1;
+	return 0;
+}
+
 static int
 eal_parse_corelist(const char *corelist)
 {
@@ -826,6 +879,13 @@ eal_parse_common_option(int opt, const char *optarg,
 		}
 		core_parsed = 1;
 		break;
+	/* service coremask */
+	case 's':
+		if (eal_parse_service_coremask(optarg, conf) < 0) {
+			RTE_LOG(ERR, EAL, "invalid service coremask\n");
+			return -1;
+		}
+		break;
 	/* size of memory */
 	case 'm':
 		conf->memory = atoi(optarg);
@@ -977,9 +1037,14 @@ eal_adjust_config(struct internal_config *internal_cfg)
 	if (internal_config.process_type == RTE_PROC_AUTO)
 		internal_config.process_type = eal_proc_type_detect();
 
-	/* default master lcore is the first one */
-	if (!master_lcore_parsed)
+	/* default master lcore is the first one not given to services */
+	if (!master_lcore_parsed) {
 		cfg->master_lcore = rte_get_next_lcore(-1, 0, 0);
+		while (cfg->master_lcore < RTE_MAX_LCORE &&
+				internal_cfg->service_lcore[cfg->master_lcore])
+			cfg->master_lcore =
+				rte_get_next_lcore(cfg->master_lcore, 0, 0);
+	}
 
 	/* if no memory amounts were requested, this will result in 0 and
 	 * will be overridden later, right after eal_hugepage_info_init() */
@@ -993,11 +1058,25 @@ int
 eal_check_common_options(struct internal_config *internal_cfg)
 {
 	struct rte_config *cfg = rte_eal_get_configuration();
+	unsigned int lcore_id;
 
-	if (cfg->lcore_role[cfg->master_lcore] != ROLE_RTE) {
+	if (cfg->master_lcore >= RTE_MAX_LCORE ||
+			cfg->lcore_role[cfg->master_lcore] != ROLE_RTE) {
 		RTE_LOG(ERR, EAL, "Master lcore is not enabled for DPDK\n");
 		return -1;
 	}
+	if (internal_cfg->service_lcore[cfg->master_lcore]) {
+		RTE_LOG(ERR, EAL, "Master lcore cannot be a service core\n");
+		return -1;
+	}
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (internal_cfg->service_lcore[lcore_id] &&
+				cfg->lcore_role[lcore_id] != ROLE_RTE) {
+			RTE_LOG(ERR, EAL, "Service lcore %u is not enabled "
+				"for DPDK\n", lcore_id);
+			return -1;
+		}
+	}
 
 	if (internal_cfg->process_type == RTE_PROC_INVALID) {
 		RTE_LOG(ERR, EAL, "Invalid process type specified\n");
@@ -1053,6 +1132,7 @@ eal_common_usage(void)
 	       "                      '( )' can be omitted for single element group,\n"
 	       "                      '@' can be omitted if cpus and lcores have the same value\n"
 	       "  --"OPT_MASTER_LCORE" ID   Core ID that is used as master\n"
+	       "  -s SERVICE COREMASK Hexadecimal bitmask of cores to be used as service cores\n"
 	       "  -n CHANNELS         Number of memory channels\n"
 	       "  -m MB               Memory to allocate (see also --"OPT_SOCKET_MEM")\n"
 	       "  -r RANKS            Force number of memory ranks (don't detect)\n"
@@ -256,6 +256,16 @@ int rte_eal_tailqs_init(void);
  */
 int rte_eal_intr_init(void);
 
+/**
+ * Init the service cores given on the command line.
+ *
+ * This function is private to EAL.
+ *
+ * @return
+ *  0 on success, negative on error
+ */
+int rte_service_init(void);
+
 /**
  * Init alarm mechanism. This is to allow a callback be called after
  * specific time.
@@ -327,6 +337,55 @@ int rte_eal_hugepage_init(void);
  */
 int rte_eal_hugepage_attach(void);
 
+/**
+ * Back more of the on-demand memory area of a socket with hugepages,
+ * add them to the memseg table and to the malloc heap of the socket.
+ *
+ * This function is private to the EAL. It is called with the heap lock
+ * of the socket held.
+ *
+ * @param socket_id
+ *   The socket whose area and heap grow.
+ * @param len
+ *   Minimum number of bytes to add, rounded up to the page size.
+ * @return
+ *   The memseg holding the end of the grown area, NULL on error.
+ */
+struct rte_memseg *rte_eal_memory_grow(int socket_id, size_t len);
+
+/**
+ * Give back the hugepages beyond a given length of the last memseg of an
+ * on-demand memory area.
+ *
+ * This function is private to the EAL. It is called with the heap lock
+ * of the memseg socket held, once the heap no longer uses the released
+ * part of the memseg. It only updates the memseg table, the hugepages are
+ * given back by rte_eal_memory_release() after the heap lock is dropped.
+ *
+ * @param ms
+ *   The memseg to shrink.
+ * @param len
+ *   New length of the memseg, multiple of the page size. A length of 0
+ *   removes the memseg, which is only possible for the last entry of the
+ *   memseg table; one page is kept otherwise and *len is updated.
+ * @return
+ *   0 on success, negative if the memseg cannot shrink.
+ */
+int rte_eal_memory_shrink(const struct rte_memseg *ms, size_t *len);
+
+/**
+ * Give the hugepages cut off by rte_eal_memory_shrink() back to the system
+ * and remove their DMA mapping.
+ *
+ * This function is private to the EAL. It is called without the heap lock,
+ * as punching holes in the hugepage file and unmapping the pages from the
+ * IOMMU take long.
+ *
+ * @param socket_id
+ *   The socket whose on-demand memory area shrank.
+ */
+void rte_eal_memory_release(int socket_id);
+
 /**
  * Returns true if the system is able to obtain
  * physical addresses. Return false if using DMA
@@ -34,16 +34,44 @@
 #ifndef _RTE_EAL_MEMCONFIG_H_
 #define _RTE_EAL_MEMCONFIG_H_
 
+#include <limits.h>
+
 #include <rte_tailq.h>
 #include <rte_memory.h>
 #include <rte_memzone.h>
 #include <rte_malloc_heap.h>
 #include <rte_rwlock.h>
+#include <rte_spinlock.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Virtual area of one socket whose hugepages are allocated on demand.
+ *
+ * The whole area is mapped from a single hugetlbfs file at startup, but
+ * only its first mapped_len bytes are backed by hugepages. The malloc
+ * heap of the socket grows and shrinks the backed part at its end. The
+ * hugepages cut off by a shrink are given back to the system later, out of
+ * the heap lock: until then they follow mapped_len, first the release_len
+ * bytes a growth may take back, then the releasing bytes being given back.
+ */
+struct rte_mem_area {
+	char filepath[PATH_MAX];  /**< Backing file in hugetlbfs. */
+	RTE_STD_C11
+	union {
+		void *addr;       /**< Start virtual address. */
+		uint64_t addr_64; /**< Makes sure addr is always 64 bits */
+	};
+	uint64_t len;             /**< Length of the reserved area. */
+	uint64_t mapped_len;      /**< Length backed by hugepages. */
+	uint64_t release_len;     /**< Length left to give back after it. */
+	uint64_t releasing;       /**< Length being given back after that. */
+	uint64_t hugepage_sz;     /**< The pagesize of the backing file. */
+	int32_t socket_id;        /**< NUMA socket ID. */
+} __attribute__((__packed__));
+
 /**
  * the structure for the memory configuration for the RTE.
  * Used by the rte_config structure. It is separated out, as for multi-process
@@ -82,6 +110,10 @@ struct rte_mem_config {
 	 * exact same address the primary process maps it.
 	 */
 	uint64_t mem_cfg_addr;
+
+	/* on-demand hugepage areas, one per socket, unused when len is 0 */
+	rte_spinlock_t memseg_lock; /**< protects memseg[] and mem_area[] */
+	struct rte_mem_area mem_area[RTE_MAX_NUMA_NODES];
 } __attribute__((__packed__));
 
 
@@ -0,0 +1,386 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SERVICE_H_
+#define _RTE_SERVICE_H_
+
+/**
+ * @file
+ *
+ * RTE Service API
+ *
+ * The service functionality provided by this header allows a DPDK component
+ * to indicate that it requires a function call in order for it to perform
+ * its processing, for example a software eventdev scheduler or the periodic
+ * callback of a bonded device.
+ *
+ * An example usage of this functionality would be a component that registers
+ * a service to perform a particular packet processing duty: for example the
+ * eventdev software PMD. At startup the application requests all services
+ * that have been registered, and the service cores (lcores dedicated to
+ * running services) are set up with the required services.
+ *
+ * Service cores are given to EAL with the -s coremask option, or added at
+ * runtime with rte_service_lcore_add(). A service core runs the services
+ * mapped to it in turn, as long as both the service core and the service
+ * itself are in the running state. Services which are not multi-thread safe
+ * are executed by one lcore at a time, whatever the number of lcores they
+ * are mapped to.
+ *
+ * The functions of this API are not multi-thread safe, they are meant to be
+ * called from the control path only.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length of a service name, including the terminating '\0'. */
+#define RTE_SERVICE_NAME_MAX 32
+
+/* Capabilities of a service.
+ *
+ * Use the *rte_service_probe_capability* function to check if a service is
+ * capable of a specific capability.
+ */
+/** When set, the service is capable of having multiple threads run it at the
+ *  same time.
+ */
+#define RTE_SERVICE_CAP_MT_SAFE (1 << 0)
+
+/**
+ * Statistics of a service, accumulated over all the lcores running it.
+ */
+struct rte_service_stats {
+	uint64_t calls;  /**< Number of times the service callback was called. */
+	uint64_t cycles; /**< TSC cycles spent in the service callback. */
+};
+
+/**
+ * Return the number of services registered.
+ *
+ * The number of services registered can be passed to
+ * *rte_service_get_name*, enabling the application to retrieve the
+ * name of each of the services.
+ *
+ * @return
+ *   The number of services registered.
+ */
+uint32_t rte_service_get_count(void);
+
+/**
+ * Return the id of a service by name.
+ *
+ * @param name
+ *   The name of the service to retrieve.
+ * @param[out] service_id
+ *   A pointer to a uint32_t, to be filled in with the id.
+ * @return
+ *   - 0: Success. The service_id pointer is filled in with the id.
+ *   - -EINVAL: Null *service_id* pointer or *name* parameter.
+ *   - -ENODEV: No such service registered.
+ */
+int32_t rte_service_get_by_name(const char *name, uint32_t *service_id);
+
+/**
+ * Return the name of the service.
+ *
+ * @param id
+ *   The id of the service.
+ * @return
+ *   A pointer to the name of the service, or NULL if the id is invalid.
+ */
+const char *rte_service_get_name(uint32_t id);
+
+/**
+ * Check if a service has a specific capability.
+ *
+ * @param id
+ *   The id of the service.
+ * @param capability
+ *   One of the RTE_SERVICE_CAP_* flags.
+ * @return
+ *   - 1: Capability supported by this service instance.
+ *   - 0: Capability not supported by this service instance.
+ *   - -EINVAL: Invalid service id.
+ */
+int32_t rte_service_probe_capability(uint32_t id, uint32_t capability);
+
+/**
+ * Enable or disable a service on a service core.
+ *
+ * A service may be mapped to several service cores, the service is then
+ * run by each of them in turn, or concurrently if it is multi-thread safe.
+ *
+ * @param service_id
+ *   The id of the service.
+ * @param lcore
+ *   The lcore id of the service core.
+ * @param enable
+ *   Non-zero to map the service to the lcore, zero to unmap it.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service id or lcore is not a service core.
+ */
+int32_t rte_service_map_lcore_set(uint32_t service_id, uint32_t lcore,
+		uint32_t enable);
+
+/**
+ * Retrieve the mapping of a service to a service core.
+ *
+ * @param service_id
+ *   The id of the service.
+ * @param lcore
+ *   The lcore id of the service core.
+ * @return
+ *   - 1: The service is mapped to the lcore.
+ *   - 0: The service is not mapped to the lcore.
+ *   - -EINVAL: Invalid service id or lcore is not a service core.
+ */
+int32_t rte_service_map_lcore_get(uint32_t service_id, uint32_t lcore);
+
+/**
+ * Set the runstate of a service.
+ *
+ * A service is only run by the service cores it is mapped to while its
+ * runstate is running.
+ *
+ * @param id
+ *   The id of the service.
+ * @param runstate
+ *   Non-zero to start the service, zero to stop it.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service id.
+ */
+int32_t rte_service_runstate_set(uint32_t id, uint32_t runstate);
+
+/**
+ * Get the runstate of a service.
+ *
+ * @param id
+ *   The id of the service.
+ * @return
+ *   - 1: The service is running.
+ *   - 0: The service is stopped.
+ *   - -EINVAL: Invalid service id.
+ */
+int32_t rte_service_runstate_get(uint32_t id);
+
+/**
+ * Run one iteration of a service on the calling lcore.
+ *
+ * This allows an application which does not dedicate a service core to
+ * call the service from its own processing loop. The service must be in the
+ * running state. A service which is not multi-thread safe is not run when
+ * it is already running on another lcore.
+ *
+ * @param id
+ *   The id of the service.
+ * @return
+ *   - 0: The service callback was run.
+ *   - -EINVAL: Invalid service id or the caller is not an EAL thread.
+ *   - -ENOEXEC: The service is not in the running state.
+ *   - -EBUSY: The service is already running on another lcore.
+ */
+int32_t rte_service_run_iter_on_app_lcore(uint32_t id);
+
+/**
+ * Start a service core.
+ *
+ * The service core starts running the services mapped to it. Services
+ * mapped later to the service core are picked up without restarting it.
+ *
+ * @param lcore_id
+ *   The lcore id of the service core.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The lcore is not a service core.
+ *   - -EALREADY: The service core is already running.
+ */
+int32_t rte_service_lcore_start(uint32_t lcore_id);
+
+/**
+ * Stop a service core.
+ *
+ * The function returns once the service core has completed the service
+ * callback it was running, the lcore can then be started again or given
+ * back to the application with *rte_service_lcore_del*.
+ *
+ * @param lcore_id
+ *   The lcore id of the service core.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The lcore is not a service core.
+ *   - -EALREADY: The service core is already stopped.
+ */
+int32_t rte_service_lcore_stop(uint32_t lcore_id);
+
+/**
+ * Add an lcore to the list of service cores.
+ *
+ * The lcore must be an EAL lcore, other than the master one, which is not
+ * running any function. Once added, the lcore is no longer part of the
+ * lcores returned by *rte_lcore_count* and *RTE_LCORE_FOREACH*.
+ *
+ * @param lcore
+ *   The lcore id to add.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The lcore is not enabled or is the master lcore.
+ *   - -EALREADY: The lcore is already a service core.
+ *   - -EBUSY: The lcore is running a function.
+ */
+int32_t rte_service_lcore_add(uint32_t lcore);
+
+/**
+ * Remove an lcore from the list of service cores.
+ *
+ * The lcore is given back to the application as a regular EAL lcore.
+ *
+ * @param lcore
+ *   The lcore id to remove.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The lcore is not a service core.
+ *   - -EBUSY: The service core is running, it must be stopped first.
+ */
+int32_t rte_service_lcore_del(uint32_t lcore);
+
+/**
+ * Return the number of service cores.
+ *
+ * @return
+ *   The number of service cores.
+ */
+int32_t rte_service_lcore_count(void);
+
+/**
+ * Return the number of services mapped to a service core.
+ *
+ * @param lcore
+ *   The lcore id of the service core.
+ * @return
+ *   - >= 0: The number of services mapped to the service core.
+ *   - -EINVAL: The lcore is not a service core.
+ */
+int32_t rte_service_lcore_count_services(uint32_t lcore);
+
+/**
+ * Retrieve the list of service cores.
+ *
+ * @param[out] array
+ *   An array of at least *n* items, filled with the lcore ids of the
+ *   service cores.
+ * @param n
+ *   The size of *array*.
+ * @return
+ *   - >= 0: The number of service cores written to *array*.
+ *   - -ENOMEM: *array* is too small to hold all the service cores.
+ */
+int32_t rte_service_lcore_list(uint32_t array[], uint32_t n);
+
+/**
+ * Stop all the service cores and unmap all the services from them.
+ *
+ * The lcores remain service cores.
+ *
+ * @return
+ *   - 0: Success.
+ */
+int32_t rte_service_lcore_reset_all(void);
+
+/**
+ * Map the registered services to the service cores and start running them.
+ *
+ * The services are spread over the service cores in a round-robin fashion.
+ * This function is called by EAL once the devices are probed, when service
+ * cores are given on the command line.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: No service core available.
+ */
+int32_t rte_service_start_with_defaults(void);
+
+/**
+ * Enable or disable the statistics of a service.
+ *
+ * The collection of statistics costs two reads of the TSC per call of the
+ * service callback.
+ *
+ * @param id
+ *   The id of the service.
+ * @param enable
+ *   Non-zero to enable the statistics, zero to disable them.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service id.
+ */
+int32_t rte_service_set_stats_enable(uint32_t id, int32_t enable);
+
+/**
+ * Retrieve the statistics of a service.
+ *
+ * @param id
+ *   The id of the service.
+ * @param[out] stats
+ *   A pointer to a structure filled with the statistics of the service.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service id or NULL *stats*.
+ */
+int32_t rte_service_stats_get(uint32_t id, struct rte_service_stats *stats);
+
+/**
+ * Dump the statistics and mappings of services and service cores.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ * @param id
+ *   The id of the service to dump, or UINT32_MAX to dump all the services
+ *   and service cores.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service id.
+ */
+int32_t rte_service_dump(FILE *f, uint32_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SERVICE_H_ */
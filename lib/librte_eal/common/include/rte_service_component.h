@@ -0,0 +1,141 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SERVICE_COMPONENT_H_
+#define _RTE_SERVICE_COMPONENT_H_
+
+/**
+ * @file
+ *
+ * RTE Service Component API
+ *
+ * This header is for DPDK components (libraries and PMDs) which register a
+ * service to get CPU time. Applications control the services through the
+ * API of rte_service.h.
+ */
+
+#include <stdint.h>
+
+#include <rte_service.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Signature of a service callback function.
+ *
+ * @param args
+ *   The *callback_userdata* of the service specification.
+ * @return
+ *   The value returned is ignored.
+ */
+typedef int32_t (*rte_service_func)(void *args);
+
+/**
+ * The specification of a service, given at registration time.
+ */
+struct rte_service_spec {
+	/** The name of the service, unique among the registered services. */
+	char name[RTE_SERVICE_NAME_MAX];
+	/** The callback called each time the service is run. */
+	rte_service_func callback;
+	/** The argument given to the callback. */
+	void *callback_userdata;
+	/** Flags made of the RTE_SERVICE_CAP_* capabilities. */
+	uint32_t capabilities;
+	/** NUMA socket the service is best run on, or SOCKET_ID_ANY. */
+	int socket_id;
+};
+
+/**
+ * Register a new service.
+ *
+ * The service starts in the stopped state, unmapped from any service core.
+ * The callback of a service is expected to return after a bounded amount
+ * of processing, so that the other services of the service core get to run.
+ *
+ * @param spec
+ *   The specification of the service, copied by the function.
+ * @param[out] service_id
+ *   A pointer to a uint32_t filled with the id of the service, if not NULL.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid *spec*, without name or callback.
+ *   - -EEXIST: A service with the same name is already registered.
+ *   - -ENOSPC: No more space to register a service.
+ */
+int32_t rte_service_component_register(const struct rte_service_spec *spec,
+		uint32_t *service_id);
+
+/**
+ * Unregister a service.
+ *
+ * The service is stopped and unmapped from all the service cores. The
+ * function returns once no service core is running the service callback
+ * anymore, the resources used by the callback can then be freed.
+ *
+ * @param id
+ *   The id of the service.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service id.
+ */
+int32_t rte_service_component_unregister(uint32_t id);
+
+/**
+ * Set the run state of a service on behalf of its component.
+ *
+ * A service is run only if both the application, with
+ * rte_service_runstate_set(), and its component mark it as running. A
+ * registered service is running for its component, which can stop it
+ * while it is not ready to be run, for instance while a device is stopped.
+ *
+ * When stopping the service, the function returns once no lcore is running
+ * the service callback anymore, as rte_service_component_unregister() does.
+ *
+ * @param id
+ *   The id of the service.
+ * @param runstate
+ *   1 to mark the service as running, 0 to stop it.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service id.
+ */
+int32_t rte_service_component_runstate_set(uint32_t id, uint32_t runstate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SERVICE_COMPONENT_H_ */
@@ -38,6 +38,7 @@
 
 #include <rte_memory.h>
 #include <rte_eal.h>
+#include <rte_eal_memconfig.h>
 #include <rte_launch.h>
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
@@ -45,6 +46,8 @@
 #include <rte_common.h>
 #include <rte_spinlock.h>
 
+#include "eal_private.h"
+#include "eal_internal_cfg.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
@@ -263,6 +266,30 @@ join_elem(struct malloc_elem *elem1, struct malloc_elem *elem2)
 	next->prev = elem1;
 }
 
+/*
+ * after the memseg of an end-of-memseg marker grew, turn the marker into a
+ * free element reaching up to a new marker at the end of the memseg
+ */
+void
+malloc_elem_grow_end(struct malloc_elem *end, struct malloc_elem *new_end)
+{
+	struct malloc_elem *prev = end->prev;
+
+	malloc_elem_init(end, prev->heap, prev->ms,
+			(uintptr_t)new_end - (uintptr_t)end);
+	end->prev = prev;
+	malloc_elem_mkend(new_end, end);
+
+	if (prev->state == ELEM_FREE) {
+		elem_free_list_remove(prev);
+		join_elem(prev, end);
+		/* the old marker is now inside free memory, keep it zeroed */
+		memset(end, 0, sizeof(*end));
+		end = prev;
+	}
+	malloc_elem_free_list_insert(end);
+}
+
 /*
  * free a malloc_elem block by adding it to the free list. If the
  * blocks either immediately before or immediately after newly freed block
@@ -271,6 +298,9 @@ join_elem(struct malloc_elem *elem1, struct malloc_elem *elem2)
 int
 malloc_elem_free(struct malloc_elem *elem)
 {
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct malloc_heap *heap;
+
 	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
 		return -1;
 
@@ -300,13 +330,120 @@ malloc_elem_free(struct malloc_elem *elem)
 	/* decrease heap's count of allocated elements */
 	elem->heap->alloc_count--;
 
+	heap = elem->heap;
+	if (internal_config.dynamic_mem) {
+		/* memory given back to the system needs no clearing */
+		if (malloc_elem_release_tail(elem) != 0)
+			sz = 0;
+		else
+			sz = RTE_MIN(sz, (uintptr_t)elem + elem->size -
+					(uintptr_t)ptr);
+	}
+
 	memset(ptr, 0, sz);
 
-	rte_spinlock_unlock(&(elem->heap->lock));
+	rte_spinlock_unlock(&heap->lock);
+
+	/* the element may be gone with the pages, its heap gives the socket */
+	if (internal_config.dynamic_mem)
+		rte_eal_memory_release(heap - mcfg->malloc_heaps);
+
+	return 0;
+}
+
+/*
+ * give the hugepages under a free element ending a memseg back to the
+ * system, when the memseg ends an on-demand memory area. The element and
+ * the end-of-memseg marker are kept in the first pages of the free space,
+ * unless the whole memseg goes away, in which case 1 is returned.
+ */
+static int
+elem_release_pages(struct malloc_elem *elem)
+{
+	struct malloc_elem *end = RTE_PTR_ADD(elem, elem->size);
+	const struct rte_memseg *ms = elem->ms;
+	struct malloc_heap *heap = elem->heap;
+	const size_t elem_size = elem->size;
+	size_t len;
+
+	/* the end-of-memseg marker is the only busy element with no size */
+	if (end->size != 0)
+		return 0;
+
+	if ((void *)elem == ms->addr)
+		len = 0;
+	else
+		len = RTE_ALIGN_CEIL((uintptr_t)elem - ms->addr_64 +
+				MALLOC_ELEM_OVERHEAD + MIN_DATA_SIZE +
+				MALLOC_ELEM_OVERHEAD, ms->hugepage_sz);
+	if (len >= ms->len)
+		return 0;
+
+	/* the pages go away, so the element must not be listed anymore */
+	elem_free_list_remove(elem);
+	if (rte_eal_memory_shrink(ms, &len) < 0) {
+		malloc_elem_free_list_insert(elem);
+		return 0;
+	}
+
+	if (len == 0) {
+		/* the whole memseg was removed */
+		heap->total_size -= elem_size;
+		return 1;
+	}
+
+	end = RTE_PTR_ADD(ms->addr, len - MALLOC_ELEM_OVERHEAD);
+	end = RTE_PTR_ALIGN_FLOOR(end, RTE_CACHE_LINE_SIZE);
+	heap->total_size -= elem_size - ((uintptr_t)end - (uintptr_t)elem);
+	elem->size = (uintptr_t)end - (uintptr_t)elem;
+	set_trailer(elem);
+	malloc_elem_mkend(end, elem);
+	malloc_elem_free_list_insert(elem);
 
 	return 0;
 }
 
+/*
+ * release the pages at the end of an on-demand memory area, going down
+ * through the memsegs of the area as long as they are entirely free.
+ */
+int
+malloc_elem_release_tail(struct malloc_elem *elem)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	const int socket_id = elem->ms->socket_id;
+	const struct rte_memseg *ms;
+	struct malloc_elem *end;
+	void *start = elem->ms->addr;
+	unsigned i;
+	int ret;
+
+	ret = elem_release_pages(elem);
+	if (ret == 0)
+		return 0;
+
+	for (;;) {
+		/* find the memseg now ending the area */
+		for (i = 0; i < RTE_MAX_MEMSEG; i++) {
+			ms = &mcfg->memseg[i];
+			if (ms->len == 0)
+				return ret;
+			if (ms->socket_id == socket_id &&
+					RTE_PTR_ADD(ms->addr, ms->len) == start)
+				break;
+		}
+		if (i == RTE_MAX_MEMSEG)
+			return ret;
+
+		start = ms->addr;
+		end = RTE_PTR_ADD(ms->addr, ms->len - MALLOC_ELEM_OVERHEAD);
+		end = RTE_PTR_ALIGN_FLOOR(end, RTE_CACHE_LINE_SIZE);
+		if (end->prev->state != ELEM_FREE ||
+				elem_release_pages(end->prev) == 0)
+			return ret;
+	}
+}
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
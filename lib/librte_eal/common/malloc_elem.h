@@ -170,6 +170,20 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size,
 int
 malloc_elem_free(struct malloc_elem *elem);
 
+/*
+ * after the memseg of an end-of-memseg marker grew, turn the marker into a
+ * free element reaching up to a new marker at the end of the memseg
+ */
+void
+malloc_elem_grow_end(struct malloc_elem *end, struct malloc_elem *new_end);
+
+/*
+ * give the hugepages under a free element ending an on-demand memory area
+ * back to the system. Return 1 if the element went away with its memseg.
+ */
+int
+malloc_elem_release_tail(struct malloc_elem *elem);
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
@@ -50,6 +50,8 @@
 #include <rte_memcpy.h>
 #include <rte_atomic.h>
 
+#include "eal_private.h"
+#include "eal_internal_cfg.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
@@ -96,7 +98,7 @@ check_hugepage_sz(unsigned flags, uint64_t hugepage_sz)
  * to prevent overflow. The rest of the zone is added to free list as a single
  * large free block
  */
-static void
+void
 malloc_heap_add_memseg(struct malloc_heap *heap, struct rte_memseg *ms)
 {
 	/* allocate the memory block headers, one at end, one at start */
@@ -113,6 +115,23 @@ malloc_heap_add_memseg(struct malloc_heap *heap, struct rte_memseg *ms)
 	heap->total_size += elem_size;
 }
 
+void
+malloc_heap_extend_memseg(struct malloc_heap *heap, struct rte_memseg *ms,
+		size_t old_len)
+{
+	/* move the end marker to the new end of the memseg */
+	struct malloc_elem *old_end = RTE_PTR_ADD(ms->addr,
+			old_len - MALLOC_ELEM_OVERHEAD);
+	struct malloc_elem *new_end = RTE_PTR_ADD(ms->addr,
+			ms->len - MALLOC_ELEM_OVERHEAD);
+	old_end = RTE_PTR_ALIGN_FLOOR(old_end, RTE_CACHE_LINE_SIZE);
+	new_end = RTE_PTR_ALIGN_FLOOR(new_end, RTE_CACHE_LINE_SIZE);
+
+	malloc_elem_grow_end(old_end, new_end);
+
+	heap->total_size += (uintptr_t)new_end - (uintptr_t)old_end;
+}
+
 /*
  * Iterates through the freelist for a heap to find a free element
  * which can store data of the required size and with the requested alignment.
@@ -151,11 +170,50 @@ find_suitable_element(struct malloc_heap *heap, size_t size,
  * scan fails. Once the new memseg is added, it re-scans and should return
  * the new element after releasing the lock.
  */
+/*
+ * Map more hugepages into a heap backed on demand, enough for an element
+ * of the given size and alignment. Pages that still cannot hold it, e.g.
+ * because they are not physically contiguous, are released at once.
+ */
+static struct malloc_elem *
+malloc_heap_grow(struct malloc_heap *heap, size_t size, unsigned flags,
+		size_t align, size_t bound)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	const int socket = heap - mcfg->malloc_heaps;
+	const struct rte_mem_area *area = &mcfg->mem_area[socket];
+	struct malloc_elem *elem, *end;
+	struct rte_memseg *ms;
+
+	if (area->len == 0)
+		return NULL;
+	if (!check_hugepage_sz(flags, area->hugepage_sz) &&
+			!(flags & RTE_MEMZONE_SIZE_HINT_ONLY))
+		return NULL;
+
+	ms = rte_eal_memory_grow(socket,
+			size + align + 3 * MALLOC_ELEM_OVERHEAD);
+	if (ms == NULL)
+		return NULL;
+
+	elem = find_suitable_element(heap, size, flags, align, bound);
+	if (elem != NULL)
+		return elem;
+
+	end = RTE_PTR_ADD(ms->addr, ms->len - MALLOC_ELEM_OVERHEAD);
+	end = RTE_PTR_ALIGN_FLOOR(end, RTE_CACHE_LINE_SIZE);
+	if (end->prev->state == ELEM_FREE)
+		malloc_elem_release_tail(end->prev);
+
+	return NULL;
+}
+
 void *
 malloc_heap_alloc(struct malloc_heap *heap,
 		const char *type __attribute__((unused)), size_t size, unsigned flags,
 		size_t align, size_t bound)
 {
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
 	struct malloc_elem *elem;
 
 	size = RTE_CACHE_LINE_ROUNDUP(size);
@@ -164,6 +222,8 @@ malloc_heap_alloc(struct malloc_heap *heap,
 	rte_spinlock_lock(&heap->lock);
 
 	elem = find_suitable_element(heap, size, flags, align, bound);
+	if (elem == NULL && internal_config.dynamic_mem)
+		elem = malloc_heap_grow(heap, size, flags, align, bound);
 	if (elem != NULL) {
 		elem = malloc_elem_alloc(elem, size, align, bound);
 		/* increase heap's count of allocated elements */
@@ -171,6 +231,10 @@ malloc_heap_alloc(struct malloc_heap *heap,
 	}
 	rte_spinlock_unlock(&heap->lock);
 
+	/* a failed growth may have given memory back */
+	if (internal_config.dynamic_mem)
+		rte_eal_memory_release(heap - mcfg->malloc_heaps);
+
 	return elem == NULL ? NULL : (void *)(&elem[1]);
 }
 
@@ -0,0 +1,684 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_memory.h>
+#include <rte_branch_prediction.h>
+#include <rte_service.h>
+#include <rte_service_component.h>
+
+#include "eal_private.h"
+#include "eal_internal_cfg.h"
+
+/* the services mapped to a service core are stored in a 64-bit mask */
+#define RTE_SERVICE_NUM_MAX 64
+
+#define SERVICE_F_REGISTERED    (1 << 0)
+#define SERVICE_F_STATS_ENABLED (1 << 1)
+
+#define RUNSTATE_STOPPED 0
+#define RUNSTATE_RUNNING 1
+
+/* no service being run by the lcore */
+#define SERVICE_NONE UINT32_MAX
+
+/* internal representation of a service */
+struct rte_service_spec_impl {
+	struct rte_service_spec spec;
+
+	/* lock taken by the lcore running a service which is not MT safe */
+	rte_atomic32_t execute_lock;
+
+	uint8_t internal_flags;
+	volatile uint8_t runstate;
+	volatile uint8_t comp_runstate; /* run state set by the component */
+
+	/* number of service cores the service is mapped to */
+	uint32_t num_mapped_cores;
+} __rte_cache_aligned;
+
+/* per-service statistics, kept per lcore to avoid sharing the counters */
+struct core_service_stats {
+	uint64_t calls;
+	uint64_t cycles;
+};
+
+/* the state of an lcore, used both by service cores and by application
+ * lcores running services with rte_service_run_iter_on_app_lcore()
+ */
+struct core_state {
+	uint64_t service_mask;    /* services mapped to the service core */
+	volatile uint8_t runstate;
+	uint8_t is_service_core;
+	volatile uint32_t cur_service; /* service being run, or SERVICE_NONE */
+	uint64_t loops;
+	struct core_service_stats stats[RTE_SERVICE_NUM_MAX];
+} __rte_cache_aligned;
+
+static struct rte_service_spec_impl rte_services[RTE_SERVICE_NUM_MAX];
+static uint32_t rte_service_count;
+
+static struct core_state lcore_states[RTE_MAX_LCORE];
+
+static inline int
+service_valid(uint32_t id)
+{
+	return id < RTE_SERVICE_NUM_MAX &&
+		(rte_services[id].internal_flags & SERVICE_F_REGISTERED);
+}
+
+static inline int
+service_lcore_valid(uint32_t lcore)
+{
+	return lcore < RTE_MAX_LCORE && lcore_states[lcore].is_service_core;
+}
+
+int32_t
+rte_service_init(void)
+{
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		lcore_states[i].cur_service = SERVICE_NONE;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!internal_config.service_lcore[i])
+			continue;
+		ret = rte_service_lcore_add(i);
+		if (ret < 0) {
+			RTE_LOG(ERR, EAL, "Cannot add lcore %u as service core\n",
+				i);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+uint32_t
+rte_service_get_count(void)
+{
+	return rte_service_count;
+}
+
+int32_t
+rte_service_get_by_name(const char *name, uint32_t *service_id)
+{
+	uint32_t i;
+
+	if (name == NULL || service_id == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (service_valid(i) &&
+				strcmp(name, rte_services[i].spec.name) == 0) {
+			*service_id = i;
+			return 0;
+		}
+	}
+
+	return -ENODEV;
+}
+
+const char *
+rte_service_get_name(uint32_t id)
+{
+	if (!service_valid(id))
+		return NULL;
+
+	return rte_services[id].spec.name;
+}
+
+int32_t
+rte_service_probe_capability(uint32_t id, uint32_t capability)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	return !!(rte_services[id].spec.capabilities & capability);
+}
+
+int32_t
+rte_service_component_register(const struct rte_service_spec *spec,
+		uint32_t *service_id)
+{
+	struct rte_service_spec_impl *s;
+	uint32_t id, i;
+
+	if (spec == NULL || spec->callback == NULL ||
+			strnlen(spec->name, RTE_SERVICE_NAME_MAX) == 0 ||
+			strnlen(spec->name, RTE_SERVICE_NAME_MAX) ==
+				RTE_SERVICE_NAME_MAX)
+		return -EINVAL;
+
+	if (rte_service_get_by_name(spec->name, &id) == 0)
+		return -EEXIST;
+
+	for (id = 0; id < RTE_SERVICE_NUM_MAX; id++) {
+		if (!service_valid(id))
+			break;
+	}
+	if (id == RTE_SERVICE_NUM_MAX)
+		return -ENOSPC;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		memset(&lcore_states[i].stats[id], 0,
+			sizeof(lcore_states[i].stats[id]));
+
+	s = &rte_services[id];
+	memset(s, 0, sizeof(*s));
+	s->spec = *spec;
+	s->runstate = RUNSTATE_STOPPED;
+	s->comp_runstate = RUNSTATE_RUNNING;
+	rte_atomic32_init(&s->execute_lock);
+	s->internal_flags |= SERVICE_F_REGISTERED;
+	rte_service_count++;
+
+	if (service_id != NULL)
+		*service_id = id;
+
+	return 0;
+}
+
+/* wait for the lcores which may not have seen a service stopped */
+static void
+service_quiesce(uint32_t id)
+{
+	uint32_t i;
+
+	/* pairs with the barrier of service_run(): any lcore which did not
+	 * see the stopped runstate is seen running the service here
+	 */
+	rte_smp_mb();
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		while (lcore_states[i].cur_service == id)
+			rte_pause();
+	}
+}
+
+int32_t
+rte_service_component_unregister(uint32_t id)
+{
+	struct rte_service_spec_impl *s;
+	uint64_t mask;
+	uint32_t i;
+
+	if (!service_valid(id))
+		return -EINVAL;
+
+	s = &rte_services[id];
+	s->runstate = RUNSTATE_STOPPED;
+
+	mask = ~(UINT64_C(1) << id);
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		lcore_states[i].service_mask &= mask;
+
+	service_quiesce(id);
+
+	s->internal_flags &= ~SERVICE_F_REGISTERED;
+	rte_service_count--;
+
+	return 0;
+}
+
+int32_t
+rte_service_component_runstate_set(uint32_t id, uint32_t runstate)
+{
+	struct rte_service_spec_impl *s;
+
+	if (!service_valid(id))
+		return -EINVAL;
+
+	s = &rte_services[id];
+	if (runstate) {
+		rte_smp_wmb();
+		s->comp_runstate = RUNSTATE_RUNNING;
+		return 0;
+	}
+
+	s->comp_runstate = RUNSTATE_STOPPED;
+	service_quiesce(id);
+
+	return 0;
+}
+
+/* run one iteration of a service on the lcore of state cs */
+static inline int32_t
+service_run(uint32_t id, struct core_state *cs)
+{
+	struct rte_service_spec_impl *s = &rte_services[id];
+	const int use_lock =
+		!(s->spec.capabilities & RTE_SERVICE_CAP_MT_SAFE);
+	uint64_t start;
+
+	cs->cur_service = id;
+	rte_smp_mb();
+
+	if (s->runstate != RUNSTATE_RUNNING ||
+			s->comp_runstate != RUNSTATE_RUNNING) {
+		cs->cur_service = SERVICE_NONE;
+		return -ENOEXEC;
+	}
+
+	if (use_lock && !rte_atomic32_test_and_set(&s->execute_lock)) {
+		cs->cur_service = SERVICE_NONE;
+		return -EBUSY;
+	}
+
+	if (s->internal_flags & SERVICE_F_STATS_ENABLED) {
+		start = rte_rdtsc();
+		s->spec.callback(s->spec.callback_userdata);
+		cs->stats[id].cycles += rte_rdtsc() - start;
+		cs->stats[id].calls++;
+	} else {
+		s->spec.callback(s->spec.callback_userdata);
+	}
+
+	if (use_lock)
+		rte_atomic32_clear(&s->execute_lock);
+
+	rte_smp_wmb();
+	cs->cur_service = SERVICE_NONE;
+
+	return 0;
+}
+
+static int32_t
+rte_service_runner_func(void *arg)
+{
+	struct core_state *cs = &lcore_states[rte_lcore_id()];
+	uint64_t service_mask;
+	uint32_t id;
+
+	RTE_SET_USED(arg);
+
+	while (cs->runstate == RUNSTATE_RUNNING) {
+		service_mask = cs->service_mask;
+		while (service_mask != 0) {
+			id = __builtin_ctzll(service_mask);
+			service_mask &= service_mask - 1;
+			service_run(id, cs);
+		}
+		cs->loops++;
+	}
+
+	return 0;
+}
+
+int32_t
+rte_service_run_iter_on_app_lcore(uint32_t id)
+{
+	uint32_t lcore = rte_lcore_id();
+
+	if (!service_valid(id) || lcore >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	return service_run(id, &lcore_states[lcore]);
+}
+
+int32_t
+rte_service_runstate_set(uint32_t id, uint32_t runstate)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	rte_services[id].runstate =
+		runstate ? RUNSTATE_RUNNING : RUNSTATE_STOPPED;
+	rte_smp_wmb();
+
+	return 0;
+}
+
+int32_t
+rte_service_runstate_get(uint32_t id)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	return rte_services[id].runstate == RUNSTATE_RUNNING;
+}
+
+int32_t
+rte_service_map_lcore_set(uint32_t service_id, uint32_t lcore,
+		uint32_t enable)
+{
+	struct core_state *cs;
+	uint64_t bit;
+
+	if (!service_valid(service_id) || !service_lcore_valid(lcore))
+		return -EINVAL;
+
+	cs = &lcore_states[lcore];
+	bit = UINT64_C(1) << service_id;
+
+	if (enable && !(cs->service_mask & bit)) {
+		cs->service_mask |= bit;
+		rte_services[service_id].num_mapped_cores++;
+	} else if (!enable && (cs->service_mask & bit)) {
+		cs->service_mask &= ~bit;
+		rte_services[service_id].num_mapped_cores--;
+	}
+
+	return 0;
+}
+
+int32_t
+rte_service_map_lcore_get(uint32_t service_id, uint32_t lcore)
+{
+	if (!service_valid(service_id) || !service_lcore_valid(lcore))
+		return -EINVAL;
+
+	return !!(lcore_states[lcore].service_mask &
+		(UINT64_C(1) << service_id));
+}
+
+int32_t
+rte_service_lcore_add(uint32_t lcore)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+	struct core_state *cs;
+
+	if (lcore >= RTE_MAX_LCORE)
+		return -EINVAL;
+	if (lcore_states[lcore].is_service_core)
+		return -EALREADY;
+	if (cfg->lcore_role[lcore] != ROLE_RTE || lcore == cfg->master_lcore)
+		return -EINVAL;
+	if (rte_eal_get_lcore_state(lcore) == RUNNING)
+		return -EBUSY;
+
+	/* a previous function may be finished but not yet waited for */
+	rte_eal_wait_lcore(lcore);
+
+	cs = &lcore_states[lcore];
+	cs->service_mask = 0;
+	cs->runstate = RUNSTATE_STOPPED;
+	cs->is_service_core = 1;
+
+	/* the lcore is no longer part of the application lcores */
+	cfg->lcore_role[lcore] = ROLE_SERVICE;
+	cfg->lcore_count--;
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_del(uint32_t lcore)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+	struct core_state *cs;
+	uint64_t service_mask;
+
+	if (!service_lcore_valid(lcore))
+		return -EINVAL;
+
+	cs = &lcore_states[lcore];
+	if (cs->runstate != RUNSTATE_STOPPED)
+		return -EBUSY;
+
+	service_mask = cs->service_mask;
+	while (service_mask != 0) {
+		rte_services[__builtin_ctzll(service_mask)].num_mapped_cores--;
+		service_mask &= service_mask - 1;
+	}
+	cs->service_mask = 0;
+	cs->is_service_core = 0;
+
+	cfg->lcore_role[lcore] = ROLE_RTE;
+	cfg->lcore_count++;
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_start(uint32_t lcore_id)
+{
+	struct core_state *cs;
+	int ret;
+
+	if (!service_lcore_valid(lcore_id))
+		return -EINVAL;
+
+	cs = &lcore_states[lcore_id];
+	if (cs->runstate == RUNSTATE_RUNNING)
+		return -EALREADY;
+
+	cs->runstate = RUNSTATE_RUNNING;
+	rte_smp_wmb();
+
+	ret = rte_eal_remote_launch(rte_service_runner_func, NULL, lcore_id);
+	if (ret < 0)
+		cs->runstate = RUNSTATE_STOPPED;
+
+	return ret;
+}
+
+int32_t
+rte_service_lcore_stop(uint32_t lcore_id)
+{
+	struct core_state *cs;
+
+	if (!service_lcore_valid(lcore_id))
+		return -EINVAL;
+
+	cs = &lcore_states[lcore_id];
+	if (cs->runstate == RUNSTATE_STOPPED)
+		return -EALREADY;
+
+	cs->runstate = RUNSTATE_STOPPED;
+	rte_smp_wmb();
+
+	rte_eal_wait_lcore(lcore_id);
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_count(void)
+{
+	int32_t count = 0;
+	uint32_t i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		count += lcore_states[i].is_service_core;
+
+	return count;
+}
+
+int32_t
+rte_service_lcore_count_services(uint32_t lcore)
+{
+	if (!service_lcore_valid(lcore))
+		return -EINVAL;
+
+	return __builtin_popcountll(lcore_states[lcore].service_mask);
+}
+
+int32_t
+rte_service_lcore_list(uint32_t array[], uint32_t n)
+{
+	uint32_t count = rte_service_lcore_count();
+	uint32_t i, idx = 0;
+
+	if (count > n)
+		return -ENOMEM;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (lcore_states[i].is_service_core)
+			array[idx++] = i;
+	}
+
+	return count;
+}
+
+int32_t
+rte_service_lcore_reset_all(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!lcore_states[i].is_service_core)
+			continue;
+		if (lcore_states[i].runstate == RUNSTATE_RUNNING)
+			rte_service_lcore_stop(i);
+		lcore_states[i].service_mask = 0;
+	}
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++)
+		rte_services[i].num_mapped_cores = 0;
+
+	return 0;
+}
+
+int32_t
+rte_service_start_with_defaults(void)
+{
+	uint32_t lcores[RTE_MAX_LCORE];
+	int32_t lcore_count;
+	uint32_t i, j = 0;
+	int ret;
+
+	lcore_count = rte_service_lcore_list(lcores, RTE_MAX_LCORE);
+	if (lcore_count <= 0)
+		return -ENOTSUP;
+
+	/* spread the services over the service cores */
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (!service_valid(i))
+			continue;
+		rte_service_map_lcore_set(i, lcores[j], 1);
+		rte_service_runstate_set(i, 1);
+		j = (j + 1) % lcore_count;
+	}
+
+	for (i = 0; i < (uint32_t)lcore_count; i++) {
+		ret = rte_service_lcore_start(lcores[i]);
+		if (ret < 0 && ret != -EALREADY)
+			return ret;
+	}
+
+	return 0;
+}
+
+int32_t
+rte_service_set_stats_enable(uint32_t id, int32_t enable)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	if (enable)
+		rte_services[id].internal_flags |= SERVICE_F_STATS_ENABLED;
+	else
+		rte_services[id].internal_flags &= ~SERVICE_F_STATS_ENABLED;
+
+	return 0;
+}
+
+int32_t
+rte_service_stats_get(uint32_t id, struct rte_service_stats *stats)
+{
+	uint32_t i;
+
+	if (!service_valid(id) || stats == NULL)
+		return -EINVAL;
+
+	stats->calls = 0;
+	stats->cycles = 0;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		stats->calls += lcore_states[i].stats[id].calls;
+		stats->cycles += lcore_states[i].stats[id].cycles;
+	}
+
+	return 0;
+}
+
+static void
+service_dump_one(FILE *f, uint32_t id)
+{
+	struct rte_service_spec_impl *s = &rte_services[id];
+	struct rte_service_stats stats = { 0 };
+
+	rte_service_stats_get(id, &stats);
+	fprintf(f, "  %s: %s, mapped to %u lcores\n", s->spec.name,
+		s->runstate == RUNSTATE_RUNNING ? "running" : "stopped",
+		s->num_mapped_cores);
+	if (!(s->internal_flags & SERVICE_F_STATS_ENABLED))
+		return;
+	fprintf(f, "    calls: %"PRIu64", cycles: %"PRIu64
+		", cycles per call: %"PRIu64"\n", stats.calls, stats.cycles,
+		stats.calls ? stats.cycles / stats.calls : 0);
+}
+
+int32_t
+rte_service_dump(FILE *f, uint32_t id)
+{
+	uint32_t i;
+
+	if (id != UINT32_MAX) {
+		if (!service_valid(id))
+			return -EINVAL;
+		service_dump_one(f, id);
+		return 0;
+	}
+
+	fprintf(f, "Services (%u):\n", rte_service_count);
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (service_valid(i))
+			service_dump_one(f, i);
+	}
+
+	fprintf(f, "Service cores (%d):\n", rte_service_lcore_count());
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!lcore_states[i].is_service_core)
+			continue;
+		fprintf(f, "  lcore %u: %s, %d services, loops: %"PRIu64"\n",
+			i, lcore_states[i].runstate == RUNSTATE_RUNNING ?
+				"running" : "stopped",
+			rte_service_lcore_count_services(i),
+			lcore_states[i].loops);
+	}
+
+	return 0;
+}
@@ -77,6 +77,7 @@
 #include <rte_common.h>
 #include <rte_version.h>
 #include <rte_atomic.h>
+#include <rte_service.h>
 #include <malloc_heap.h>
 
 #include "eal_private.h"
@@ -353,6 +354,7 @@ eal_usage(const char *prgname)
 	       "  --"OPT_HUGE_DIR"          Directory where hugetlbfs is mounted\n"
 	       "  --"OPT_FILE_PREFIX"       Prefix for hugepage filenames\n"
 	       "  --"OPT_BASE_VIRTADDR"     Base virtual address\n"
+	       "  --"OPT_DYNAMIC_MEM"       Map hugepages on demand instead of at startup\n"
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
 	       "  --"OPT_XEN_DOM0"          Support running on Xen dom0 without hugetlbfs\n"
@@ -611,6 +613,10 @@ eal_parse_args(int argc, char **argv)
 			internal_config.create_uio_dev = 1;
 			break;
 
+		case OPT_DYNAMIC_MEM_NUM:
+			internal_config.dynamic_mem = 1;
+			break;
+
 		default:
 			if (opt < OPT_LONG_MIN_NUM && isprint(opt)) {
 				RTE_LOG(ERR, EAL, "Option %c is not supported "
@@ -651,6 +657,18 @@ eal_parse_args(int argc, char **argv)
 		goto out;
 	}
 
+	/* --dynamic-mem needs hugetlbfs files to grow and shrink */
+	if (internal_config.dynamic_mem &&
+			(internal_config.no_hugetlbfs ||
+			 internal_config.xen_dom0_support)) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_DYNAMIC_MEM" cannot be "
+			"specified together with --"OPT_NO_HUGE" or --"
+			OPT_XEN_DOM0"\n");
+		eal_usage(prgname);
+		ret = -1;
+		goto out;
+	}
+
 	if (optind >= 0)
 		argv[optind-1] = prgname;
 	ret = optind-1;
@@ -672,6 +690,10 @@ eal_check_mem_on_local_socket(void)
 
 	socket_id = rte_lcore_to_socket_id(rte_config.master_lcore);
 
+	/* hugepages are only mapped on demand, check the reserved area */
+	if (rte_config.mem_config->mem_area[socket_id].len > 0)
+		return;
+
 	ms = rte_eal_get_physmem_layout();
 
 	for (i = 0; i < RTE_MAX_MEMSEG; i++)
@@ -932,6 +954,13 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	/* set up the service cores before the devices register services */
+	if (rte_service_init() < 0) {
+		rte_eal_init_alert("Cannot init service cores\n");
+		rte_errno = ENOEXEC;
+		return -1;
+	}
+
 	/* Probe all the buses and devices/drivers on them */
 	if (rte_bus_probe()) {
 		rte_eal_init_alert("Cannot probe devices\n");
@@ -939,6 +968,14 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	/* run the registered services, when service cores are given */
+	ret = rte_service_start_with_defaults();
+	if (ret < 0 && ret != -ENOTSUP) {
+		rte_eal_init_alert("Cannot start service cores\n");
+		rte_errno = ENOEXEC;
+		return -1;
+	}
+
 	rte_eal_mcfg_complete();
 
 	return fctret;
@@ -50,7 +50,9 @@
 #include <unistd.h>
 #include <limits.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
 #include <signal.h>
 #include <setjmp.h>
@@ -70,6 +72,8 @@
 #include "eal_internal_cfg.h"
 #include "eal_filesystem.h"
 #include "eal_hugepages.h"
+#include "eal_vfio.h"
+#include "malloc_heap.h"
 
 #define PFN_MASK_SIZE	8
 
@@ -925,6 +929,150 @@ huge_recover_sigbus(void)
 	}
 }
 
+/* per-process descriptors of the on-demand memory area files */
+static int mem_area_fd[RTE_MAX_NUMA_NODES];
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+/* bits of the NUMA node masks given to the memory policy syscalls */
+#define MEMPOLICY_MAXNODE (sizeof(unsigned long) * CHAR_BIT)
+
+/*
+ * Bind the hugepage allocations of the calling thread to a socket, saving
+ * the previous memory policy. Return -1 if the policy cannot be changed,
+ * e.g. on a kernel without NUMA support, in which case pages come from
+ * wherever the kernel takes them.
+ */
+static int
+mem_area_bind_socket(int socket_id, int *old_mode, unsigned long *old_mask)
+{
+	unsigned long mask;
+
+	if (socket_id >= (int)MEMPOLICY_MAXNODE)
+		return -1;
+	if (syscall(SYS_get_mempolicy, old_mode, old_mask,
+			MEMPOLICY_MAXNODE + 1, NULL, 0) < 0)
+		return -1;
+
+	mask = 1UL << socket_id;
+	if (syscall(SYS_set_mempolicy, MPOL_BIND, &mask,
+			MEMPOLICY_MAXNODE + 1) < 0)
+		return -1;
+
+	return 0;
+}
+
+static void
+mem_area_restore_policy(int mode, unsigned long *mask)
+{
+	syscall(SYS_set_mempolicy, mode, mask, MEMPOLICY_MAXNODE + 1);
+}
+
+/*
+ * Reserve the on-demand memory areas: one hugetlbfs file per socket, mapped
+ * over a virtual area as large as the memory the socket may use, without
+ * allocating any hugepage yet. Pages are allocated in the file as the
+ * malloc heaps grow, see rte_eal_memory_grow().
+ */
+static int
+mem_area_init(void)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct hugepage_info *hpi = &internal_config.hugepage_info[0];
+	uint64_t total_mem;
+	unsigned lcore_id;
+	int socket, fd;
+	void *addr;
+
+	if (internal_config.num_hugepage_sizes == 0 || hpi->hugedir == NULL) {
+		RTE_LOG(ERR, EAL, "No hugetlbfs mount point to map memory "
+			"from\n");
+		return -1;
+	}
+	if (internal_config.num_hugepage_sizes > 1)
+		RTE_LOG(INFO, EAL, "Mapping %u MB pages from %s on demand, "
+			"use --huge-dir for another page size\n",
+			(unsigned)(hpi->hugepage_sz / 0x100000), hpi->hugedir);
+
+	total_mem = hpi->hugepage_sz * hpi->num_pages[0];
+	if (internal_config.memory != 0)
+		total_mem = internal_config.memory;
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		struct rte_mem_area *area = &mcfg->mem_area[socket];
+		size_t len = 0;
+
+		if (internal_config.force_sockets) {
+			len = internal_config.socket_mem[socket];
+		} else {
+			/* every socket with a cpu may get memory */
+			for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+				if (lcore_config[lcore_id].detected &&
+						lcore_config[lcore_id].socket_id ==
+						(unsigned)socket)
+					len = total_mem;
+		}
+		len = RTE_ALIGN_CEIL(len, hpi->hugepage_sz);
+		if (len == 0)
+			continue;
+
+		eal_get_hugefile_path(area->filepath, sizeof(area->filepath),
+				hpi->hugedir, socket);
+		fd = open(area->filepath, O_CREAT | O_RDWR, 0600);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "%s(): open %s failed: %s\n",
+				__func__, area->filepath, strerror(errno));
+			return -1;
+		}
+		/* drop the pages left by a previous run, unless the file
+		 * is still used, then keep it from being removed by other
+		 * primaries
+		 */
+		if (flock(fd, LOCK_EX | LOCK_NB) == -1 ||
+				ftruncate(fd, 0) < 0 ||
+				flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			RTE_LOG(ERR, EAL, "%s(): Locking file %s failed: %s\n",
+				__func__, area->filepath, strerror(errno));
+			close(fd);
+			return -1;
+		}
+
+		addr = get_virtual_area(&len, hpi->hugepage_sz);
+		if (addr == NULL) {
+			close(fd);
+			return -1;
+		}
+		/* no hugepage is reserved for the mapping, they are
+		 * allocated in the file when the heap grows
+		 */
+		addr = mmap(addr, len, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_NORESERVE, fd, 0);
+		if (addr == MAP_FAILED) {
+			RTE_LOG(ERR, EAL, "%s(): mmap of %zu bytes failed: %s\n",
+				__func__, len, strerror(errno));
+			close(fd);
+			return -1;
+		}
+
+		if (internal_config.hugepage_unlink)
+			unlink(area->filepath);
+
+		mem_area_fd[socket] = fd;
+		area->addr = addr;
+		area->mapped_len = 0;
+		area->hugepage_sz = hpi->hugepage_sz;
+		area->socket_id = socket;
+		area->len = len;
+
+		RTE_LOG(DEBUG, EAL, "Reserved %zu MB on socket %d at %p\n",
+			len / 0x100000, socket, addr);
+	}
+
+	return 0;
+}
+
 /*
  * Prepare physical memory mapping: fill configuration structure with
  * these infos, return 0 on success.
@@ -985,6 +1133,10 @@ rte_eal_hugepage_init(void)
 #endif
 	}
 
+	/* hugepages are mapped on demand when the malloc heaps grow */
+	if (internal_config.dynamic_mem)
+		return mem_area_init();
+
 	/* calculate total number of hugepages available. at this point we haven't
 	 * yet started sorting them so they all are on socket 0 */
 	for (i = 0; i < (int) internal_config.num_hugepage_sizes; i++) {
@@ -1275,6 +1427,56 @@ getFileSize(int fd)
 	return st.st_size;
 }
 
+/*
+ * Map the on-demand memory areas of the primary process at the same
+ * addresses. Hugepages allocated in the area files by any process later on
+ * show up in every mapping, so only the memseg table needs to be shared.
+ */
+static int
+mem_area_attach(void)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	int socket, fd;
+	void *addr;
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		struct rte_mem_area *area = &mcfg->mem_area[socket];
+
+		if (area->len == 0)
+			continue;
+
+		fd = open(area->filepath, O_RDWR);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "Could not open %s\n", area->filepath);
+			return -1;
+		}
+		if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			RTE_LOG(ERR, EAL, "%s(): Locking file failed: %s\n",
+				__func__, strerror(errno));
+			close(fd);
+			return -1;
+		}
+
+		addr = mmap(area->addr, area->len, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_NORESERVE, fd, 0);
+		if (addr == MAP_FAILED || addr != area->addr) {
+			RTE_LOG(ERR, EAL, "Could not mmap %llu bytes of %s at "
+				"[%p] - please use '--base-virtaddr' option\n",
+				(unsigned long long)area->len, area->filepath,
+				area->addr);
+			if (addr != MAP_FAILED)
+				munmap(addr, area->len);
+			close(fd);
+			return -1;
+		}
+
+		mem_area_fd[socket] = fd;
+		internal_config.dynamic_mem = 1;
+	}
+
+	return 0;
+}
+
 /*
  * This creates the memory mappings in the secondary process to match that of
  * the server process. It goes through each memory segment in the DPDK runtime
@@ -1312,6 +1514,10 @@ rte_eal_hugepage_attach(void)
 #endif
 	}
 
+	for (s = 0; s < RTE_MAX_NUMA_NODES; s++)
+		if (mcfg->mem_area[s].len > 0)
+			return mem_area_attach();
+
 	fd_zero = open("/dev/zero", O_RDONLY);
 	if (fd_zero < 0) {
 		RTE_LOG(ERR, EAL, "Could not open /dev/zero\n");
@@ -1448,3 +1654,342 @@ rte_eal_using_phys_addrs(void)
 {
 	return phys_addrs_available;
 }
+
+/*
+ * Find the memseg ending at the given address, i.e. at the end of the
+ * mapped part of an on-demand memory area.
+ */
+static struct rte_memseg *
+mem_area_last_memseg(struct rte_mem_config *mcfg, const void *end)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_MAX_MEMSEG && mcfg->memseg[i].len > 0; i++)
+		if (RTE_PTR_ADD(mcfg->memseg[i].addr,
+				mcfg->memseg[i].len) == end)
+			return &mcfg->memseg[i];
+
+	return NULL;
+}
+
+/*
+ * Address of a hugepage for the devices, looked up page by page as the
+ * hugepages of an on-demand memory area are not physically sorted.
+ */
+static phys_addr_t
+mem_area_iova(void *va)
+{
+	if (phys_addrs_available)
+		return rte_mem_virt2phy(va);
+	return (uintptr_t)va;
+}
+
+/*
+ * Devices DMA to hugepages through the IOMMU when VFIO is used. Pages are
+ * mapped one by one, as a mapping cannot be partially removed later on.
+ */
+static int
+mem_area_dma_map(uint64_t vaddr, uint64_t iova, uint64_t len)
+{
+#ifdef VFIO_PRESENT
+	return vfio_dma_mem_map(vaddr, iova, len, 1);
+#else
+	RTE_SET_USED(vaddr);
+	RTE_SET_USED(iova);
+	RTE_SET_USED(len);
+	return 0;
+#endif
+}
+
+static void
+mem_area_dma_unmap(uint64_t vaddr, uint64_t len, uint64_t page_sz)
+{
+#ifdef VFIO_PRESENT
+	uint64_t off;
+
+	for (off = 0; off < len; off += page_sz)
+		vfio_dma_mem_map(vaddr + off,
+				mem_area_iova((void *)(uintptr_t)(vaddr + off)),
+				page_sz, 0);
+#else
+	RTE_SET_USED(vaddr);
+	RTE_SET_USED(len);
+	RTE_SET_USED(page_sz);
+#endif
+}
+
+/*
+ * Hand the memory added to a memseg during a growth to the heap, either as
+ * a new memseg or as the extension of an existing one.
+ */
+static void
+mem_area_heap_add(struct malloc_heap *heap, struct rte_memseg *ms,
+		size_t old_len)
+{
+	if (old_len == 0)
+		malloc_heap_add_memseg(heap, ms);
+	else
+		malloc_heap_extend_memseg(heap, ms, old_len);
+}
+
+struct rte_memseg *
+rte_eal_memory_grow(int socket_id, size_t len)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct rte_mem_area *area;
+	struct malloc_heap *heap;
+	struct rte_memseg *ms, *last = NULL;
+	unsigned long old_mask[1];
+	size_t old_len = 0, reuse, off;
+	uint64_t offset;
+	int old_mode, bound, ret;
+	unsigned i;
+	void *addr;
+
+	if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES)
+		return NULL;
+
+	area = &mcfg->mem_area[socket_id];
+	heap = &mcfg->malloc_heaps[socket_id];
+	if (area->len == 0)
+		return NULL;
+
+	len = RTE_ALIGN_CEIL(len, area->hugepage_sz);
+	if (area->mapped_len + len > area->len) {
+		RTE_LOG(DEBUG, EAL, "Cannot grow memory of socket %d by "
+			"%zu bytes, %llu of %llu bytes used\n", socket_id, len,
+			(unsigned long long)area->mapped_len,
+			(unsigned long long)area->len);
+		return NULL;
+	}
+
+	offset = area->mapped_len;
+	addr = RTE_PTR_ADD(area->addr, offset);
+
+	rte_spinlock_lock(&mcfg->memseg_lock);
+
+	/* the pages cut off by a shrink are still backed and DMA mapped until
+	 * they are released, take them back first; new pages cannot be
+	 * allocated where other pages are being released
+	 */
+	while (area->releasing != 0 && area->release_len < len) {
+		rte_spinlock_unlock(&mcfg->memseg_lock);
+		rte_pause();
+		rte_spinlock_lock(&mcfg->memseg_lock);
+	}
+	reuse = RTE_MIN(len, area->release_len);
+	area->release_len -= reuse;
+
+	if (reuse < len) {
+		/* nothing is left to release, the lock can be dropped */
+		rte_spinlock_unlock(&mcfg->memseg_lock);
+
+		/* allocate the hugepages in the file first, so that running
+		 * out of them is an error instead of a SIGBUS when touching
+		 * the memory
+		 */
+		bound = mem_area_bind_socket(socket_id, &old_mode,
+				old_mask) == 0;
+		ret = fallocate(mem_area_fd[socket_id], 0, offset + reuse,
+				len - reuse);
+		if (bound)
+			mem_area_restore_policy(old_mode, old_mask);
+
+		rte_spinlock_lock(&mcfg->memseg_lock);
+		if (ret < 0) {
+			area->release_len += reuse;
+			rte_spinlock_unlock(&mcfg->memseg_lock);
+			RTE_LOG(DEBUG, EAL, "Cannot allocate %zu bytes of "
+				"hugepages on socket %d: %s\n", len - reuse,
+				socket_id, strerror(errno));
+			return NULL;
+		}
+	}
+
+	ms = mem_area_last_memseg(mcfg, addr);
+	if (area->mapped_len == 0)
+		ms = NULL;
+	if (ms != NULL)
+		old_len = ms->len;
+
+	for (off = 0; off < len; off += area->hugepage_sz) {
+		void *va = RTE_PTR_ADD(addr, off);
+		phys_addr_t pa;
+
+		/* fault the page in */
+		*(volatile char *)va;
+
+		pa = mem_area_iova(va);
+		if (pa == RTE_BAD_PHYS_ADDR)
+			break;
+
+		/* pages taken back are still mapped */
+		if (off >= reuse && mem_area_dma_map((uintptr_t)va, pa,
+				area->hugepage_sz) < 0)
+			break;
+
+		if (ms != NULL && ms->phys_addr + ms->len == pa) {
+			/* physically contiguous to the previous page */
+			ms->len += area->hugepage_sz;
+			area->mapped_len += area->hugepage_sz;
+			last = ms;
+			continue;
+		}
+
+		/* start a new memseg */
+		for (i = 0; i < RTE_MAX_MEMSEG; i++)
+			if (mcfg->memseg[i].len == 0)
+				break;
+		if (i == RTE_MAX_MEMSEG) {
+			RTE_LOG(ERR, EAL, "Cannot grow memory, all %s=%d "
+				"memsegs are used\n",
+				RTE_STR(CONFIG_RTE_MAX_MEMSEG), RTE_MAX_MEMSEG);
+			if (off >= reuse)
+				mem_area_dma_unmap((uintptr_t)va,
+						area->hugepage_sz,
+						area->hugepage_sz);
+			break;
+		}
+
+		if (ms != NULL && ms->len != old_len)
+			mem_area_heap_add(heap, ms, old_len);
+
+		ms = &mcfg->memseg[i];
+		ms->phys_addr = pa;
+		ms->addr = va;
+		ms->hugepage_sz = area->hugepage_sz;
+		ms->socket_id = socket_id;
+		ms->nchannel = mcfg->nchannel;
+		ms->nrank = mcfg->nrank;
+		/* only publish complete entries to lockless readers */
+		rte_wmb();
+		ms->len = area->hugepage_sz;
+		area->mapped_len += area->hugepage_sz;
+		old_len = 0;
+		last = ms;
+	}
+
+	if (last != NULL)
+		mem_area_heap_add(heap, last, old_len);
+
+	/* the pages taken back but not used are left to release */
+	if (off < reuse)
+		area->release_len += reuse - off;
+
+	rte_spinlock_unlock(&mcfg->memseg_lock);
+
+	if (off < len) {
+		RTE_LOG(ERR, EAL, "Cannot map %zu of %zu bytes of memory "
+			"grown on socket %d\n", len - off, len, socket_id);
+		off = RTE_MAX(off, reuse);
+		if (off < len)
+			fallocate(mem_area_fd[socket_id],
+					FALLOC_FL_PUNCH_HOLE |
+					FALLOC_FL_KEEP_SIZE,
+					offset + off, len - off);
+	}
+
+	return last;
+}
+
+int
+rte_eal_memory_shrink(const struct rte_memseg *seg, size_t *len)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct rte_mem_area *area = NULL;
+	struct rte_memseg *ms;
+	uint64_t release;
+	unsigned idx;
+	int socket;
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		area = &mcfg->mem_area[socket];
+		if (area->len > 0 && seg->addr_64 >= area->addr_64 &&
+				seg->addr_64 < area->addr_64 + area->len)
+			break;
+	}
+	if (socket == RTE_MAX_NUMA_NODES)
+		return -1;
+
+	/* pages can only be taken back at the end of the area */
+	if (seg->addr_64 + seg->len != area->addr_64 + area->mapped_len)
+		return -1;
+
+	rte_spinlock_lock(&mcfg->memseg_lock);
+
+	idx = seg - mcfg->memseg;
+	ms = &mcfg->memseg[idx];
+
+	/* the memseg table must not have holes, keep a page otherwise */
+	if (*len == 0 && idx + 1 < RTE_MAX_MEMSEG &&
+			mcfg->memseg[idx + 1].len > 0)
+		*len = ms->hugepage_sz;
+	if (*len >= ms->len) {
+		rte_spinlock_unlock(&mcfg->memseg_lock);
+		return -1;
+	}
+
+	release = ms->len - *len;
+
+	/* the pages are given back by rte_eal_memory_release() */
+	area->mapped_len -= release;
+	area->release_len += release;
+	if (*len == 0) {
+		ms->len = 0;
+		rte_wmb();
+		memset(ms, 0, sizeof(*ms));
+	} else {
+		ms->len = *len;
+	}
+
+	rte_spinlock_unlock(&mcfg->memseg_lock);
+
+	return 0;
+}
+
+void
+rte_eal_memory_release(int socket_id)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct rte_mem_area *area;
+	uint64_t offset, len;
+
+	if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES)
+		return;
+
+	area = &mcfg->mem_area[socket_id];
+	if (area->len == 0)
+		return;
+
+	rte_spinlock_lock(&mcfg->memseg_lock);
+
+	/* a single thread releases the pages of an area at a time, it takes
+	 * the ones cut off while it was releasing the previous ones
+	 */
+	while (area->release_len != 0 && area->releasing == 0) {
+		offset = area->mapped_len;
+		len = area->release_len;
+		area->releasing = len;
+		area->release_len = 0;
+		rte_spinlock_unlock(&mcfg->memseg_lock);
+
+		mem_area_dma_unmap(area->addr_64 + offset, len,
+				area->hugepage_sz);
+
+		/* on failure the pages stay in the file and are reused on
+		 * growth
+		 */
+		if (fallocate(mem_area_fd[socket_id],
+				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				offset, len) < 0)
+			RTE_LOG(ERR, EAL, "Cannot release %llu bytes of "
+				"hugepages on socket %d: %s\n",
+				(unsigned long long)len, socket_id,
+				strerror(errno));
+
+		rte_spinlock_lock(&mcfg->memseg_lock);
+		area->releasing = 0;
+	}
+
+	rte_spinlock_unlock(&mcfg->memseg_lock);
+}
@@ -49,6 +49,9 @@
 /* per-process VFIO config */
 static struct vfio_config vfio_cfg;
 
+/* IOMMU type of the container, set once DMA mappings are set up */
+static const struct vfio_iommu_type *vfio_iommu_type;
+
 static int vfio_type1_dma_map(int);
 static int vfio_spapr_dma_map(int);
 static int vfio_noiommu_dma_map(int);
@@ -236,6 +239,8 @@ clear_group(int vfio_group_fd)
 		vfio_cfg.vfio_groups[i].fd = -1;
 		vfio_cfg.vfio_groups[i].devices = 0;
 		vfio_cfg.vfio_active_groups--;
+		if (vfio_cfg.vfio_active_groups == 0)
+			vfio_iommu_type = NULL;
 		return 0;
 	}
 
@@ -378,6 +383,7 @@ vfio_setup_device(const char *sysfs_base, const char *dev_addr,
 				clear_group(vfio_group_fd);
 				return -1;
 			}
+			vfio_iommu_type = t;
 		}
 	}
 
@@ -689,33 +695,67 @@ vfio_get_group_no(const char *sysfs_base,
 	return 1;
 }
 
+static int
+vfio_type1_dma_mem_map(int vfio_container_fd, uint64_t vaddr, uint64_t iova,
+		uint64_t len, int do_map)
+{
+	int ret;
+
+	if (do_map) {
+		struct vfio_iommu_type1_dma_map dma_map;
+
+		memset(&dma_map, 0, sizeof(dma_map));
+		dma_map.argsz = sizeof(struct vfio_iommu_type1_dma_map);
+		dma_map.vaddr = vaddr;
+		dma_map.size = len;
+		dma_map.iova = iova;
+		dma_map.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
+
+		ret = ioctl(vfio_container_fd, VFIO_IOMMU_MAP_DMA, &dma_map);
+	} else {
+		struct vfio_iommu_type1_dma_unmap dma_unmap;
+
+		memset(&dma_unmap, 0, sizeof(dma_unmap));
+		dma_unmap.argsz = sizeof(struct vfio_iommu_type1_dma_unmap);
+		dma_unmap.size = len;
+		dma_unmap.iova = iova;
+
+		ret = ioctl(vfio_container_fd, VFIO_IOMMU_UNMAP_DMA,
+				&dma_unmap);
+	}
+
+	if (ret) {
+		RTE_LOG(ERR, EAL, "  cannot %s DMA remapping, "
+				  "error %i (%s)\n", do_map ? "set up" : "remove",
+				  errno, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 vfio_type1_dma_map(int vfio_container_fd)
 {
 	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
+	uint64_t off, step;
 	int i, ret;
 
 	/* map all DPDK segments for DMA. use 1:1 PA to IOVA mapping */
 	for (i = 0; i < RTE_MAX_MEMSEG; i++) {
-		struct vfio_iommu_type1_dma_map dma_map;
-
 		if (ms[i].addr == NULL)
 			break;
 
-		memset(&dma_map, 0, sizeof(dma_map));
-		dma_map.argsz = sizeof(struct vfio_iommu_type1_dma_map);
-		dma_map.vaddr = ms[i].addr_64;
-		dma_map.size = ms[i].len;
-		dma_map.iova = ms[i].phys_addr;
-		dma_map.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
-
-		ret = ioctl(vfio_container_fd, VFIO_IOMMU_MAP_DMA, &dma_map);
+		/* hugepages mapped on demand may be unmapped one by one */
+		step = internal_config.dynamic_mem ?
+				ms[i].hugepage_sz : ms[i].len;
 
-		if (ret) {
-			RTE_LOG(ERR, EAL, "  cannot set up DMA remapping, "
-					  "error %i (%s)\n", errno,
-					  strerror(errno));
-			return -1;
+		for (off = 0; off < ms[i].len; off += step) {
+			ret = vfio_type1_dma_mem_map(vfio_container_fd,
+					ms[i].addr_64 + off,
+					ms[i].phys_addr + off, step, 1);
+			if (ret)
+				return -1;
 		}
 	}
 
@@ -816,4 +856,63 @@ vfio_noiommu_dma_map(int __rte_unused vfio_container_fd)
 	return 0;
 }
 
+/*
+ * Get the IOMMU type set by the primary process on the container shared
+ * with a secondary process. Until an IOMMU type is set, the container
+ * answers VFIO_IOMMU_GET_INFO with an error and VFIO_CHECK_EXTENSION for
+ * every available type; once set, both are handled by the IOMMU driver.
+ * The No-IOMMU driver has no info ioctl, but needs no DMA mapping either.
+ */
+static const struct vfio_iommu_type *
+vfio_get_container_iommu_type(int vfio_container_fd)
+{
+	struct vfio_iommu_type1_info info;
+	unsigned int idx;
+
+	memset(&info, 0, sizeof(info));
+	info.argsz = sizeof(info);
+	if (ioctl(vfio_container_fd, VFIO_IOMMU_GET_INFO, &info))
+		return NULL;
+
+	for (idx = 0; idx < RTE_DIM(iommu_types); idx++) {
+		const struct vfio_iommu_type *t = &iommu_types[idx];
+
+		if (ioctl(vfio_container_fd, VFIO_CHECK_EXTENSION,
+				t->type_id) == 1)
+			return t;
+	}
+	return NULL;
+}
+
+int
+vfio_dma_mem_map(uint64_t vaddr, uint64_t iova, uint64_t len, int do_map)
+{
+	const struct vfio_iommu_type *t = vfio_iommu_type;
+
+	/*
+	 * The IOMMU type is only known to the primary process, which sets it.
+	 * A secondary process maps its memory in the container it shares with
+	 * the primary, once the primary has set the IOMMU type.
+	 */
+	if (internal_config.process_type != RTE_PROC_PRIMARY &&
+			vfio_cfg.vfio_enabled)
+		t = vfio_get_container_iommu_type(vfio_cfg.vfio_container_fd);
+
+	/* memory is mapped along with the first device otherwise */
+	if (t == NULL)
+		return 0;
+
+	switch (t->type_id) {
+	case RTE_VFIO_TYPE1:
+		return vfio_type1_dma_mem_map(vfio_cfg.vfio_container_fd,
+				vaddr, iova, len, do_map);
+	case RTE_VFIO_NOIOMMU:
+		return 0;
+	default:
+		RTE_LOG(ERR, EAL, "  IOMMU type %s cannot map memory "
+			"at runtime\n", t->name);
+		return -1;
+	}
+}
+
 #endif
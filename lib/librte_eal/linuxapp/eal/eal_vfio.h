@@ -210,6 +210,11 @@ int pci_vfio_is_enabled(void);
 
 int vfio_mp_sync_setup(void);
 
+/* DMA map (or unmap if do_map is 0) memory added (or removed) after the
+ * IOMMU was set up. Returns 0 if no IOMMU is set up yet.
+ */
+int vfio_dma_mem_map(uint64_t vaddr, uint64_t iova, uint64_t len, int do_map);
+
 #define SOCKET_REQ_CONTAINER 0x100
 #define SOCKET_REQ_GROUP 0x200
 #define SOCKET_CLR_GROUP 0x300
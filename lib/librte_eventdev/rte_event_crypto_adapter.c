@@ -0,0 +1,1014 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <rte_common.h>
+#include <rte_dev.h>
+#include <rte_errno.h>
+#include <rte_cryptodev.h>
+#include <rte_cryptodev_pmd.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_spinlock.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_crypto_adapter.h"
+
+#define BATCH_SIZE 32
+#define DEFAULT_MAX_NB 128
+#define CRYPTO_ADAPTER_MAX_EV_ENQ_RETRIES 100
+
+struct crypto_queue_pair_info {
+	struct rte_crypto_op *op_buffer[BATCH_SIZE];
+	/* Crypto ops waiting to be enqueued to the queue pair */
+	uint16_t len;
+	/* Number of ops in op_buffer */
+	uint8_t qp_enabled;
+	/* Set to indicate queue pair is enabled */
+	uint8_t has_event;
+	/* Set if event holds a default response for the queue pair */
+	struct rte_event event;
+	/* Response used for completed ops without metadata */
+} __rte_cache_aligned;
+
+struct crypto_device_info {
+	struct rte_cryptodev *dev;
+	/* Pointer to cryptodev */
+	struct crypto_queue_pair_info *qpairs;
+	/* Per queue pair state, NULL until a queue pair is added */
+	uint16_t nb_qpairs;
+	/* Number of entries in qpairs */
+	uint16_t num_qpairs;
+	/* Number of queue pairs added to the adapter */
+	uint8_t internal_event_port;
+	/* Set if the queue pairs are handled by the eventdev PMD */
+	uint8_t dev_started;
+	/* Set if the PMD side of the adapter was started */
+};
+
+struct rte_event_crypto_adapter {
+	uint8_t eventdev_id;
+	/* Event device identifier */
+	uint8_t event_port_id;
+	/* Event port identifier */
+	uint8_t port_configured;
+	/* Set once the configuration callback has run */
+	uint8_t started;
+	/* Set if the adapter is started */
+	enum rte_event_crypto_adapter_mode mode;
+	/* Adapter mode */
+	uint32_t max_nb;
+	/* Max crypto ops processed in any run */
+	rte_spinlock_t lock;
+	/* Serializes the run function with the control path */
+	uint8_t nb_cdevs;
+	/* One more than the highest cryptodev id added */
+	uint8_t next_cdev_id;
+	/* Next crypto device to be polled for completions */
+	uint16_t ebuf_head;
+	/* Index of the first event not yet enqueued in ebuf */
+	uint16_t ebuf_count;
+	/* Number of events in ebuf */
+	uint32_t nb_qps;
+	/* Number of queue pairs added to the adapter */
+	struct rte_event ebuf[BATCH_SIZE];
+	/* Completions waiting to be enqueued to the event device */
+	struct rte_event_crypto_adapter_stats crypto_stats;
+	/* Statistics of the SW transfer */
+	rte_event_crypto_adapter_conf_cb conf_cb;
+	/* Configuration callback */
+	void *conf_arg;
+	/* Configuration callback argument */
+	uint8_t default_cb_arg;
+	/* Set if conf_arg was allocated by rte_event_crypto_adapter_create() */
+	int socket_id;
+	/* Socket identifier cached from eventdev */
+	struct crypto_device_info cdevs[RTE_CRYPTO_MAX_DEVS];
+	/* Per crypto device information */
+} __rte_cache_aligned;
+
+static struct rte_event_crypto_adapter **event_crypto_adapter;
+
+/* Macros to check for valid adapter */
+#define EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, retval) do { \
+	if (!eca_valid_id(id)) { \
+		RTE_EDEV_LOG_ERR("Invalid crypto adapter id = %d", id); \
+		return retval; \
+	} \
+} while (0)
+
+static inline int
+eca_valid_id(uint8_t id)
+{
+	return id < RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE;
+}
+
+static int
+eca_init(void)
+{
+	if (event_crypto_adapter != NULL)
+		return 0;
+
+	event_crypto_adapter = rte_zmalloc("rte_event_crypto_adapter_array",
+			RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE *
+			sizeof(*event_crypto_adapter), RTE_CACHE_LINE_SIZE);
+	if (event_crypto_adapter == NULL) {
+		RTE_EDEV_LOG_ERR("Failed to allocate crypto adapter array");
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static inline struct rte_event_crypto_adapter *
+eca_id_to_adapter(uint8_t id)
+{
+	return event_crypto_adapter ?
+		event_crypto_adapter[id] : NULL;
+}
+
+static int
+eca_default_config_cb(uint8_t id, uint8_t dev_id,
+		struct rte_event_crypto_adapter_conf *conf, void *arg)
+{
+	struct rte_event_dev_config dev_conf;
+	struct rte_eventdev *dev;
+	uint8_t port_id;
+	int started;
+	int ret;
+	struct rte_event_port_conf *port_conf = arg;
+
+	RTE_SET_USED(id);
+
+	dev = &rte_eventdevs[dev_id];
+	dev_conf = dev->data->dev_conf;
+
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(dev_id);
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(dev_id, &dev_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u", dev_id);
+		if (started) {
+			if (rte_event_dev_start(dev_id))
+				return -EIO;
+		}
+		return ret;
+	}
+
+	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u", port_id);
+		return ret;
+	}
+
+	conf->event_port_id = port_id;
+	conf->max_nb = DEFAULT_MAX_NB;
+	if (started)
+		ret = rte_event_dev_start(dev_id);
+
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
+				rte_event_crypto_adapter_conf_cb conf_cb,
+				enum rte_event_crypto_adapter_mode mode,
+				void *conf_arg)
+{
+	struct rte_event_crypto_adapter *adapter;
+	int socket_id;
+	int ret;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (conf_cb == NULL)
+		return -EINVAL;
+	if (mode != RTE_EVENT_CRYPTO_ADAPTER_OP_NEW &&
+	    mode != RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
+		return -EINVAL;
+
+	ret = eca_init();
+	if (ret)
+		return ret;
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter != NULL) {
+		RTE_EDEV_LOG_ERR("Crypto adapter id %u already exists!", id);
+		return -EEXIST;
+	}
+
+	socket_id = rte_event_dev_socket_id(dev_id);
+	adapter = rte_zmalloc_socket("rte_event_crypto_adapter",
+			sizeof(struct rte_event_crypto_adapter),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (adapter == NULL) {
+		RTE_EDEV_LOG_ERR("Failed to get mem for event crypto adapter!");
+		return -ENOMEM;
+	}
+
+	adapter->eventdev_id = dev_id;
+	adapter->socket_id = socket_id;
+	adapter->conf_cb = conf_cb;
+	adapter->conf_arg = conf_arg;
+	adapter->mode = mode;
+	rte_spinlock_init(&adapter->lock);
+
+	event_crypto_adapter[id] = adapter;
+
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_create(uint8_t id, uint8_t dev_id,
+				struct rte_event_port_conf *port_config,
+				enum rte_event_crypto_adapter_mode mode)
+{
+	struct rte_event_port_conf *pc;
+	int ret;
+
+	if (port_config == NULL)
+		return -EINVAL;
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	pc = rte_malloc(NULL, sizeof(*pc), 0);
+	if (pc == NULL)
+		return -ENOMEM;
+	*pc = *port_config;
+	ret = rte_event_crypto_adapter_create_ext(id, dev_id,
+						  eca_default_config_cb,
+						  mode,
+						  pc);
+	if (ret) {
+		rte_free(pc);
+		return ret;
+	}
+	event_crypto_adapter[id]->default_cb_arg = 1;
+
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_free(uint8_t id)
+{
+	struct rte_event_crypto_adapter *adapter;
+	uint16_t i;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	if (adapter->nb_qps) {
+		RTE_EDEV_LOG_ERR("%" PRIu32 " queue pairs not deleted",
+				adapter->nb_qps);
+		return -EBUSY;
+	}
+
+	if (adapter->default_cb_arg)
+		rte_free(adapter->conf_arg);
+	for (i = 0; i < adapter->nb_cdevs; i++)
+		rte_free(adapter->cdevs[i].qpairs);
+	rte_free(adapter);
+	event_crypto_adapter[id] = NULL;
+
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_caps_get(uint8_t dev_id, uint8_t cdev_id,
+				  uint32_t *caps)
+{
+	struct rte_eventdev *dev;
+	struct rte_cryptodev *cdev;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (!rte_cryptodev_pmd_is_valid_dev(cdev_id))
+		return -EINVAL;
+	if (caps == NULL)
+		return -EINVAL;
+
+	dev = &rte_eventdevs[dev_id];
+	cdev = rte_cryptodev_pmd_get_dev(cdev_id);
+
+	*caps = 0;
+	if (dev->dev_ops->crypto_adapter_caps_get == NULL)
+		return 0;
+
+	return (*dev->dev_ops->crypto_adapter_caps_get)(dev, cdev, caps);
+}
+
+/* Drop a crypto op that can't be handed to its destination */
+static inline void
+eca_op_drop(struct rte_crypto_op *op)
+{
+	if (op->type == RTE_CRYPTO_OP_TYPE_SYMMETRIC) {
+		rte_pktmbuf_free(op->sym->m_src);
+		if (op->sym->m_dst != NULL &&
+		    op->sym->m_dst != op->sym->m_src)
+			rte_pktmbuf_free(op->sym->m_dst);
+	}
+	rte_crypto_op_free(op);
+}
+
+static inline unsigned int
+eca_qp_flush(struct rte_event_crypto_adapter *adapter, uint8_t cdev_id,
+	     uint16_t qp_id, struct crypto_queue_pair_info *qp_info)
+{
+	uint16_t n;
+
+	if (qp_info->len == 0)
+		return 0;
+
+	n = rte_cryptodev_enqueue_burst(cdev_id, qp_id, qp_info->op_buffer,
+					qp_info->len);
+	adapter->crypto_stats.crypto_enq_count += n;
+	qp_info->len -= n;
+	if (qp_info->len && n)
+		memmove(qp_info->op_buffer, &qp_info->op_buffer[n],
+			qp_info->len * sizeof(qp_info->op_buffer[0]));
+
+	return n;
+}
+
+static unsigned int
+eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter)
+{
+	struct crypto_device_info *dev_info;
+	unsigned int nb = 0;
+	uint16_t qp;
+	uint8_t cdev_id;
+
+	for (cdev_id = 0; cdev_id < adapter->nb_cdevs; cdev_id++) {
+		dev_info = &adapter->cdevs[cdev_id];
+		if (dev_info->num_qpairs == 0 || dev_info->internal_event_port)
+			continue;
+		for (qp = 0; qp < dev_info->nb_qpairs; qp++)
+			nb += eca_qp_flush(adapter, cdev_id, qp,
+					   &dev_info->qpairs[qp]);
+	}
+
+	return nb;
+}
+
+/* Buffer the crypto ops of the events in their destination queue pairs */
+static unsigned int
+eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
+		     struct rte_event *ev, unsigned int cnt)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	union rte_event_crypto_metadata *m_data;
+	struct crypto_queue_pair_info *qp_info;
+	struct crypto_device_info *dev_info;
+	struct rte_crypto_op *op;
+	unsigned int i, n = 0;
+	uint16_t cdev_id, qp_id;
+
+	for (i = 0; i < cnt; i++) {
+		op = ev[i].event_ptr;
+		if (op == NULL)
+			continue;
+
+		m_data = op->opaque_data;
+		if (unlikely(m_data == NULL)) {
+			eca_op_drop(op);
+			stats->crypto_enq_fail++;
+			continue;
+		}
+
+		cdev_id = m_data->request_info.cdev_id;
+		qp_id = m_data->request_info.queue_pair_id;
+		dev_info = cdev_id < adapter->nb_cdevs ?
+			&adapter->cdevs[cdev_id] : NULL;
+		if (unlikely(dev_info == NULL ||
+			     dev_info->internal_event_port ||
+			     qp_id >= dev_info->nb_qpairs ||
+			     !dev_info->qpairs[qp_id].qp_enabled)) {
+			eca_op_drop(op);
+			stats->crypto_enq_fail++;
+			continue;
+		}
+
+		qp_info = &dev_info->qpairs[qp_id];
+		if (qp_info->len == BATCH_SIZE) {
+			n += eca_qp_flush(adapter, cdev_id, qp_id, qp_info);
+			if (qp_info->len == BATCH_SIZE) {
+				eca_op_drop(op);
+				stats->crypto_enq_fail++;
+				continue;
+			}
+		}
+		qp_info->op_buffer[qp_info->len++] = op;
+		if (qp_info->len == BATCH_SIZE)
+			n += eca_qp_flush(adapter, cdev_id, qp_id, qp_info);
+	}
+
+	return n;
+}
+
+static unsigned int
+eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
+			   unsigned int max_enq)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	struct rte_event ev[BATCH_SIZE];
+	unsigned int nb_enq = 0;
+	unsigned int nb_deq = 0;
+	uint16_t n;
+
+	if (adapter->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_NEW)
+		return 0;
+
+	while (nb_deq < max_enq) {
+		stats->event_poll_count++;
+		n = rte_event_dequeue_burst(adapter->eventdev_id,
+					    adapter->event_port_id,
+					    ev, BATCH_SIZE, 0);
+		if (n == 0)
+			break;
+
+		stats->event_deq_count += n;
+		nb_deq += n;
+		nb_enq += eca_enq_to_cryptodev(adapter, ev, n);
+	}
+
+	return nb_enq + eca_crypto_enq_flush(adapter);
+}
+
+/* Enqueue the pending completions to the event device */
+static unsigned int
+eca_ev_flush(struct rte_event_crypto_adapter *adapter)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	unsigned int nb = 0;
+	uint16_t retry = 0;
+	uint16_t n;
+
+	while (adapter->ebuf_head < adapter->ebuf_count) {
+		n = rte_event_enqueue_burst(adapter->eventdev_id,
+				adapter->event_port_id,
+				&adapter->ebuf[adapter->ebuf_head],
+				adapter->ebuf_count - adapter->ebuf_head);
+		adapter->ebuf_head += n;
+		nb += n;
+		if (n == 0) {
+			stats->event_enq_retry_count++;
+			if (++retry > CRYPTO_ADAPTER_MAX_EV_ENQ_RETRIES)
+				break;
+		}
+	}
+
+	stats->event_enq_count += nb;
+	if (adapter->ebuf_head == adapter->ebuf_count) {
+		adapter->ebuf_head = 0;
+		adapter->ebuf_count = 0;
+	}
+
+	return nb;
+}
+
+/* Turn completed crypto ops into events and enqueue them */
+static unsigned int
+eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
+		      struct crypto_queue_pair_info *qp_info,
+		      struct rte_crypto_op **ops, uint16_t num)
+{
+	union rte_event_crypto_metadata *m_data;
+	struct rte_event *ev = adapter->ebuf;
+	uint16_t i, nb_ev = 0;
+
+	for (i = 0; i < num; i++) {
+		m_data = ops[i]->opaque_data;
+		if (m_data != NULL)
+			ev[nb_ev].event = m_data->response_info.event;
+		else if (qp_info->has_event)
+			ev[nb_ev].event = qp_info->event.event;
+		else {
+			eca_op_drop(ops[i]);
+			adapter->crypto_stats.event_enq_fail_count++;
+			continue;
+		}
+		ev[nb_ev].event_type = RTE_EVENT_TYPE_CRYPTODEV;
+		ev[nb_ev].op = RTE_EVENT_OP_NEW;
+		ev[nb_ev].event_ptr = ops[i];
+		nb_ev++;
+	}
+
+	adapter->ebuf_head = 0;
+	adapter->ebuf_count = nb_ev;
+
+	return eca_ev_flush(adapter);
+}
+
+static unsigned int
+eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
+			   unsigned int max_deq)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	struct rte_crypto_op *ops[BATCH_SIZE];
+	struct crypto_device_info *dev_info;
+	unsigned int nb_enq = 0;
+	unsigned int nb_deq = 0;
+	uint8_t cdev_id;
+	uint16_t qp;
+	uint16_t n;
+	bool done;
+
+	/* completions are left in the crypto devices while the event device
+	 * doesn't accept the previous ones
+	 */
+	if (adapter->ebuf_count) {
+		nb_enq += eca_ev_flush(adapter);
+		if (adapter->ebuf_count)
+			return nb_enq;
+	}
+
+	do {
+		done = true;
+
+		for (cdev_id = adapter->next_cdev_id;
+		     cdev_id < adapter->nb_cdevs; cdev_id++) {
+			dev_info = &adapter->cdevs[cdev_id];
+			if (dev_info->num_qpairs == 0 ||
+			    dev_info->internal_event_port)
+				continue;
+
+			for (qp = 0; qp < dev_info->nb_qpairs; qp++) {
+				if (!dev_info->qpairs[qp].qp_enabled)
+					continue;
+
+				n = rte_cryptodev_dequeue_burst(cdev_id, qp,
+								ops,
+								BATCH_SIZE);
+				if (n == 0)
+					continue;
+
+				done = false;
+				stats->crypto_deq_count += n;
+				nb_deq += n;
+				nb_enq += eca_ops_enqueue_burst(adapter,
+						&dev_info->qpairs[qp], ops, n);
+
+				if (nb_deq >= max_deq || adapter->ebuf_count) {
+					adapter->next_cdev_id = cdev_id + 1;
+					if (adapter->next_cdev_id >=
+					    adapter->nb_cdevs)
+						adapter->next_cdev_id = 0;
+					return nb_enq;
+				}
+			}
+		}
+		adapter->next_cdev_id = 0;
+	} while (!done);
+
+	return nb_enq;
+}
+
+int
+rte_event_crypto_adapter_run(uint8_t id, unsigned int max_ops)
+{
+	struct rte_event_crypto_adapter *adapter;
+	unsigned int nb;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	if (!adapter->started)
+		return -EAGAIN;
+
+	if (!rte_spinlock_trylock(&adapter->lock))
+		return 0;
+
+	if (max_ops == 0)
+		max_ops = adapter->max_nb;
+	nb = eca_crypto_adapter_enq_run(adapter, max_ops);
+	nb += eca_crypto_adapter_deq_run(adapter, max_ops);
+
+	rte_spinlock_unlock(&adapter->lock);
+
+	return nb;
+}
+
+static int
+eca_init_port(struct rte_event_crypto_adapter *adapter, uint8_t id)
+{
+	struct rte_event_crypto_adapter_conf adapter_conf;
+	int ret;
+
+	if (adapter->port_configured)
+		return 0;
+
+	memset(&adapter_conf, 0, sizeof(adapter_conf));
+	ret = adapter->conf_cb(id, adapter->eventdev_id, &adapter_conf,
+			       adapter->conf_arg);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("configuration callback failed=%d", ret);
+		return ret;
+	}
+
+	adapter->event_port_id = adapter_conf.event_port_id;
+	adapter->max_nb = adapter_conf.max_nb ?
+		adapter_conf.max_nb : DEFAULT_MAX_NB;
+	adapter->port_configured = 1;
+
+	return 0;
+}
+
+static void
+eca_update_qp_info(struct rte_event_crypto_adapter *adapter,
+		   struct crypto_device_info *dev_info,
+		   int32_t queue_pair_id,
+		   const struct rte_event *event,
+		   uint8_t add)
+{
+	struct crypto_queue_pair_info *qp_info;
+	uint16_t i;
+
+	if (queue_pair_id == -1) {
+		for (i = 0; i < dev_info->nb_qpairs; i++)
+			eca_update_qp_info(adapter, dev_info, i, event, add);
+		return;
+	}
+
+	qp_info = &dev_info->qpairs[queue_pair_id];
+	if (add) {
+		if (!qp_info->qp_enabled) {
+			qp_info->qp_enabled = 1;
+			dev_info->num_qpairs++;
+			adapter->nb_qps++;
+		}
+		if (event != NULL) {
+			qp_info->event = *event;
+			qp_info->has_event = 1;
+		}
+	} else if (qp_info->qp_enabled) {
+		qp_info->qp_enabled = 0;
+		qp_info->has_event = 0;
+		dev_info->num_qpairs--;
+		adapter->nb_qps--;
+	}
+}
+
+int
+rte_event_crypto_adapter_queue_pair_add(uint8_t id,
+			uint8_t cdev_id,
+			int32_t queue_pair_id,
+			const struct rte_event *event)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct crypto_device_info *dev_info;
+	struct rte_eventdev *dev;
+	uint32_t cap;
+	int internal;
+	int ret;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	if (!rte_cryptodev_pmd_is_valid_dev(cdev_id)) {
+		RTE_EDEV_LOG_ERR("Invalid dev_id=%" PRIu8, cdev_id);
+		return -EINVAL;
+	}
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	dev = &rte_eventdevs[adapter->eventdev_id];
+	ret = rte_event_crypto_adapter_caps_get(adapter->eventdev_id,
+						cdev_id,
+						&cap);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("Failed to get adapter caps dev %" PRIu8
+			" cdev %" PRIu8, adapter->eventdev_id, cdev_id);
+		return ret;
+	}
+
+	if ((cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_QP_EV_BIND) &&
+	    (event == NULL)) {
+		RTE_EDEV_LOG_ERR("Conf value can not be NULL for dev_id=%u",
+				  cdev_id);
+		return -EINVAL;
+	}
+
+	dev_info = &adapter->cdevs[cdev_id];
+	dev_info->dev = rte_cryptodev_pmd_get_dev(cdev_id);
+
+	if (queue_pair_id != -1 &&
+	    (queue_pair_id < 0 || (uint16_t)queue_pair_id >=
+	     dev_info->dev->data->nb_queue_pairs)) {
+		RTE_EDEV_LOG_ERR("Invalid queue_pair_id %" PRIi32,
+				 queue_pair_id);
+		return -EINVAL;
+	}
+
+	internal = (adapter->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_NEW &&
+		    (cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_NEW)) ||
+		   (adapter->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD &&
+		    (cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_FWD));
+	if (internal)
+		RTE_FUNC_PTR_OR_ERR_RET(
+			*dev->dev_ops->crypto_adapter_queue_pair_add,
+			-ENOTSUP);
+
+	rte_spinlock_lock(&adapter->lock);
+
+	if (dev_info->qpairs == NULL) {
+		dev_info->qpairs =
+		    rte_zmalloc_socket("rte_event_crypto_adapter_qp",
+					dev_info->dev->data->nb_queue_pairs *
+					sizeof(struct crypto_queue_pair_info),
+					RTE_CACHE_LINE_SIZE,
+					adapter->socket_id);
+		if (dev_info->qpairs == NULL) {
+			ret = -ENOMEM;
+			goto unlock;
+		}
+		dev_info->nb_qpairs = dev_info->dev->data->nb_queue_pairs;
+		if (cdev_id >= adapter->nb_cdevs)
+			adapter->nb_cdevs = cdev_id + 1;
+	}
+
+	if (internal) {
+		ret = (*dev->dev_ops->crypto_adapter_queue_pair_add)(dev,
+				dev_info->dev,
+				queue_pair_id,
+				event);
+		if (ret == 0) {
+			dev_info->internal_event_port = 1;
+			eca_update_qp_info(adapter, dev_info, queue_pair_id,
+					   event, 1);
+		}
+	} else {
+		ret = eca_init_port(adapter, id);
+		if (ret == 0)
+			eca_update_qp_info(adapter, dev_info, queue_pair_id,
+					   event, 1);
+	}
+
+unlock:
+	rte_spinlock_unlock(&adapter->lock);
+
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
+					int32_t queue_pair_id)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct crypto_device_info *dev_info;
+	struct rte_eventdev *dev;
+	uint16_t i;
+	int ret = 0;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	if (!rte_cryptodev_pmd_is_valid_dev(cdev_id)) {
+		RTE_EDEV_LOG_ERR("Invalid dev_id=%" PRIu8, cdev_id);
+		return -EINVAL;
+	}
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	dev_info = &adapter->cdevs[cdev_id];
+	if (dev_info->qpairs == NULL)
+		return -EINVAL;
+
+	if (queue_pair_id != -1 &&
+	    (queue_pair_id < 0 ||
+	     (uint16_t)queue_pair_id >= dev_info->nb_qpairs)) {
+		RTE_EDEV_LOG_ERR("Invalid queue_pair_id %" PRIi32,
+				 queue_pair_id);
+		return -EINVAL;
+	}
+
+	dev = &rte_eventdevs[adapter->eventdev_id];
+
+	rte_spinlock_lock(&adapter->lock);
+
+	if (dev_info->internal_event_port) {
+		if (*dev->dev_ops->crypto_adapter_queue_pair_del == NULL) {
+			ret = -ENOTSUP;
+			goto unlock;
+		}
+		ret = (*dev->dev_ops->crypto_adapter_queue_pair_del)(dev,
+						dev_info->dev,
+						queue_pair_id);
+		if (ret == 0) {
+			eca_update_qp_info(adapter, dev_info, queue_pair_id,
+					   NULL, 0);
+			if (dev_info->num_qpairs == 0)
+				dev_info->internal_event_port = 0;
+		}
+		goto unlock;
+	}
+
+	for (i = 0; i < dev_info->nb_qpairs; i++) {
+		struct crypto_queue_pair_info *qp_info = &dev_info->qpairs[i];
+
+		if (queue_pair_id != -1 && i != queue_pair_id)
+			continue;
+		/* hand the buffered ops over before the queue pair goes */
+		eca_qp_flush(adapter, cdev_id, i, qp_info);
+		while (qp_info->len) {
+			eca_op_drop(qp_info->op_buffer[--qp_info->len]);
+			adapter->crypto_stats.crypto_enq_fail++;
+		}
+	}
+	eca_update_qp_info(adapter, dev_info, queue_pair_id, NULL, 0);
+
+unlock:
+	rte_spinlock_unlock(&adapter->lock);
+
+	return ret;
+}
+
+static int
+eca_adapter_ctrl(uint8_t id, int start)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct crypto_device_info *dev_info;
+	struct rte_eventdev *dev;
+	uint8_t i;
+	int ret = 0;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	dev = &rte_eventdevs[adapter->eventdev_id];
+
+	rte_spinlock_lock(&adapter->lock);
+
+	for (i = 0; i < adapter->nb_cdevs; i++) {
+		dev_info = &adapter->cdevs[i];
+		if (dev_info->num_qpairs == 0 ||
+		    !dev_info->internal_event_port)
+			continue;
+
+		if (start && !dev_info->dev_started) {
+			if (dev->dev_ops->crypto_adapter_start != NULL)
+				ret = (*dev->dev_ops->crypto_adapter_start)(dev,
+							dev_info->dev);
+			if (ret)
+				break;
+			dev_info->dev_started = 1;
+		} else if (!start && dev_info->dev_started) {
+			if (dev->dev_ops->crypto_adapter_stop != NULL)
+				(*dev->dev_ops->crypto_adapter_stop)(dev,
+							dev_info->dev);
+			dev_info->dev_started = 0;
+		}
+	}
+
+	if (ret == 0)
+		adapter->started = start;
+
+	rte_spinlock_unlock(&adapter->lock);
+
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_start(uint8_t id)
+{
+	return eca_adapter_ctrl(id, 1);
+}
+
+int
+rte_event_crypto_adapter_stop(uint8_t id)
+{
+	return eca_adapter_ctrl(id, 0);
+}
+
+int
+rte_event_crypto_adapter_stats_get(uint8_t id,
+				struct rte_event_crypto_adapter_stats *stats)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct rte_event_crypto_adapter_stats dev_stats_sum = { 0 };
+	struct rte_event_crypto_adapter_stats dev_stats;
+	struct rte_eventdev *dev;
+	struct crypto_device_info *dev_info;
+	uint32_t i;
+	int ret;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL || stats == NULL)
+		return -EINVAL;
+
+	dev = &rte_eventdevs[adapter->eventdev_id];
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i < adapter->nb_cdevs; i++) {
+		dev_info = &adapter->cdevs[i];
+		if (dev_info->internal_event_port == 0 ||
+			dev->dev_ops->crypto_adapter_stats_get == NULL)
+			continue;
+		ret = (*dev->dev_ops->crypto_adapter_stats_get)(dev,
+						dev_info->dev,
+						&dev_stats);
+		if (ret)
+			continue;
+
+		dev_stats_sum.crypto_deq_count += dev_stats.crypto_deq_count;
+		dev_stats_sum.event_enq_count +=
+			dev_stats.event_enq_count;
+	}
+
+	*stats = adapter->crypto_stats;
+	stats->crypto_deq_count += dev_stats_sum.crypto_deq_count;
+	stats->event_enq_count += dev_stats_sum.event_enq_count;
+
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_stats_reset(uint8_t id)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct crypto_device_info *dev_info;
+	struct rte_eventdev *dev;
+	uint32_t i;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	dev = &rte_eventdevs[adapter->eventdev_id];
+	for (i = 0; i < adapter->nb_cdevs; i++) {
+		dev_info = &adapter->cdevs[i];
+		if (dev_info->internal_event_port == 0 ||
+			dev->dev_ops->crypto_adapter_stats_reset == NULL)
+			continue;
+		(*dev->dev_ops->crypto_adapter_stats_reset)(dev,
+						dev_info->dev);
+	}
+
+	memset(&adapter->crypto_stats, 0, sizeof(adapter->crypto_stats));
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_event_port_get(uint8_t id, uint8_t *event_port_id)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL || event_port_id == NULL)
+		return -EINVAL;
+
+	if (!adapter->port_configured)
+		return -ESRCH;
+
+	*event_port_id = adapter->event_port_id;
+
+	return 0;
+}
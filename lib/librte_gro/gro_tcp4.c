@@ -0,0 +1,519 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <string.h>
+
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#include "gro_tcp4.h"
+
+#define TCP_ACK_FLAG 0x10
+
+#define VXLAN_FLAGS_VNI_VALID rte_cpu_to_be_32(0x08000000)
+
+#define IS_FRAGMENTED(frag_off) (((frag_off) & \
+		rte_cpu_to_be_16(IPV4_HDR_OFFSET_MASK | IPV4_HDR_MF_FLAG)) != 0)
+
+/* Max length of a merged packet, from its (outer) IPv4 header */
+#define GRO_TCP4_MAX_IP_LEN UINT16_MAX
+
+/* Parsed headers of a packet */
+struct gro_tcp4_info {
+	struct gro_tcp4_key key;
+	uint32_t sent_seq;
+	uint16_t ip_id;
+	uint16_t outer_ip_id;
+	uint16_t hdr_len;
+	uint16_t payload_len;
+	const struct tcp_hdr *tcp_hdr;
+};
+
+void
+gro_tcp4_tbl_init(struct gro_tcp4_tbl *tbl,
+		struct gro_tcp4_item *items,
+		uint32_t max_item_num,
+		struct gro_tcp4_flow *flows,
+		uint32_t max_flow_num,
+		uint8_t tunnel)
+{
+	uint32_t i;
+
+	tbl->items = items;
+	tbl->flows = flows;
+	tbl->item_num = 0;
+	tbl->max_item_num = max_item_num;
+	tbl->flow_num = 0;
+	tbl->max_flow_num = max_flow_num;
+	tbl->tunnel = tunnel;
+
+	for (i = 0; i < max_item_num; i++)
+		items[i].firstseg = NULL;
+	for (i = 0; i < max_flow_num; i++)
+		flows[i].start_index = GRO_TCP4_INVALID_INDEX;
+}
+
+struct gro_tcp4_tbl *
+gro_tcp4_tbl_create(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow,
+		uint8_t tunnel)
+{
+	struct gro_tcp4_tbl *tbl;
+	struct gro_tcp4_item *items;
+	struct gro_tcp4_flow *flows;
+	uint32_t max_item_num;
+
+	max_item_num = (uint32_t)max_flow_num * max_item_per_flow;
+	if (max_item_num == 0)
+		return NULL;
+
+	tbl = rte_zmalloc_socket(__func__, sizeof(*tbl),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	items = rte_zmalloc_socket(__func__, sizeof(*items) * max_item_num,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	flows = rte_zmalloc_socket(__func__, sizeof(*flows) * max_flow_num,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (tbl == NULL || items == NULL || flows == NULL) {
+		rte_free(tbl);
+		rte_free(items);
+		rte_free(flows);
+		return NULL;
+	}
+
+	gro_tcp4_tbl_init(tbl, items, max_item_num, flows, max_flow_num,
+			tunnel);
+
+	return tbl;
+}
+
+void
+gro_tcp4_tbl_destroy(struct gro_tcp4_tbl *tbl)
+{
+	uint32_t i;
+
+	if (tbl == NULL)
+		return;
+
+	for (i = 0; i < tbl->max_item_num; i++)
+		rte_pktmbuf_free(tbl->items[i].firstseg);
+
+	rte_free(tbl->items);
+	rte_free(tbl->flows);
+	rte_free(tbl);
+}
+
+/*
+ * Parse the headers of a packet. All the headers must be in the first
+ * segment. The header lengths of the mbuf are only set on success, so
+ * rejected packets are given back to the application unmodified.
+ */
+static int
+gro_tcp4_parse(struct rte_mbuf *pkt, uint8_t tunnel,
+		struct gro_tcp4_info *info)
+{
+	const struct ether_hdr *eth_hdr;
+	const struct ipv4_hdr *ipv4_hdr;
+	const struct udp_hdr *udp_hdr;
+	const struct vxlan_hdr *vxlan_hdr;
+	const struct tcp_hdr *tcp_hdr;
+	uint16_t off = 0, l2_len, l4_len;
+
+	/* IPv4 headers without options keep the parsing simple */
+	if (pkt->data_len < sizeof(*eth_hdr) + sizeof(*ipv4_hdr))
+		return -1;
+
+	eth_hdr = rte_pktmbuf_mtod(pkt, const struct ether_hdr *);
+	ipv4_hdr = (const struct ipv4_hdr *)(eth_hdr + 1);
+	if (eth_hdr->ether_type != rte_cpu_to_be_16(ETHER_TYPE_IPv4) ||
+			ipv4_hdr->version_ihl != 0x45 ||
+			IS_FRAGMENTED(ipv4_hdr->fragment_offset))
+		return -1;
+
+	memset(&info->key, 0, sizeof(info->key));
+
+	if (tunnel) {
+		off = sizeof(*eth_hdr) + sizeof(*ipv4_hdr) +
+			ETHER_VXLAN_HLEN + sizeof(*eth_hdr);
+		if (ipv4_hdr->next_proto_id != IPPROTO_UDP ||
+				pkt->data_len < off + sizeof(*ipv4_hdr))
+			return -1;
+		udp_hdr = (const struct udp_hdr *)(ipv4_hdr + 1);
+		vxlan_hdr = (const struct vxlan_hdr *)(udp_hdr + 1);
+		if (udp_hdr->dst_port !=
+				rte_cpu_to_be_16(GRO_VXLAN_UDP_PORT) ||
+				(vxlan_hdr->vx_flags & VXLAN_FLAGS_VNI_VALID) ==
+				0)
+			return -1;
+
+		ether_addr_copy(&eth_hdr->s_addr, &info->key.outer_eth_saddr);
+		ether_addr_copy(&eth_hdr->d_addr, &info->key.outer_eth_daddr);
+		info->key.outer_ip_src_addr = ipv4_hdr->src_addr;
+		info->key.outer_ip_dst_addr = ipv4_hdr->dst_addr;
+		info->key.outer_src_port = udp_hdr->src_port;
+		info->key.outer_dst_port = udp_hdr->dst_port;
+		info->key.vxlan_vni = vxlan_hdr->vx_vni;
+		info->outer_ip_id = rte_be_to_cpu_16(ipv4_hdr->packet_id);
+
+		/* inner headers */
+		eth_hdr = (const struct ether_hdr *)(vxlan_hdr + 1);
+		ipv4_hdr = (const struct ipv4_hdr *)(eth_hdr + 1);
+		if (eth_hdr->ether_type != rte_cpu_to_be_16(ETHER_TYPE_IPv4) ||
+				ipv4_hdr->version_ihl != 0x45 ||
+				IS_FRAGMENTED(ipv4_hdr->fragment_offset))
+			return -1;
+		l2_len = ETHER_VXLAN_HLEN + sizeof(*eth_hdr);
+	} else {
+		off = sizeof(*eth_hdr);
+		info->outer_ip_id = 0;
+		l2_len = sizeof(*eth_hdr);
+	}
+
+	if (ipv4_hdr->next_proto_id != IPPROTO_TCP)
+		return -1;
+
+	/* off: offset of the (inner) IPv4 header, then of the TCP header */
+	off += sizeof(*ipv4_hdr);
+	if (pkt->data_len < off + sizeof(*tcp_hdr))
+		return -1;
+	tcp_hdr = (const struct tcp_hdr *)(ipv4_hdr + 1);
+	l4_len = (tcp_hdr->data_off & 0xf0) >> 2;
+	if (l4_len < sizeof(*tcp_hdr) || pkt->data_len < off + l4_len)
+		return -1;
+
+	/* Only pure ACK segments with payload are merged */
+	info->hdr_len = off + l4_len;
+	if (tcp_hdr->tcp_flags != TCP_ACK_FLAG ||
+			pkt->pkt_len <= info->hdr_len ||
+			rte_be_to_cpu_16(ipv4_hdr->total_length) !=
+			pkt->pkt_len - (off - sizeof(*ipv4_hdr)))
+		return -1;
+
+	ether_addr_copy(&eth_hdr->s_addr, &info->key.eth_saddr);
+	ether_addr_copy(&eth_hdr->d_addr, &info->key.eth_daddr);
+	info->key.ip_src_addr = ipv4_hdr->src_addr;
+	info->key.ip_dst_addr = ipv4_hdr->dst_addr;
+	info->key.recv_ack = tcp_hdr->recv_ack;
+	info->key.src_port = tcp_hdr->src_port;
+	info->key.dst_port = tcp_hdr->dst_port;
+
+	info->sent_seq = rte_be_to_cpu_32(tcp_hdr->sent_seq);
+	info->ip_id = rte_be_to_cpu_16(ipv4_hdr->packet_id);
+	info->payload_len = pkt->pkt_len - info->hdr_len;
+	info->tcp_hdr = tcp_hdr;
+
+	/* The packet is accepted: only now set its header lengths */
+	if (tunnel) {
+		pkt->outer_l2_len = sizeof(*eth_hdr);
+		pkt->outer_l3_len = sizeof(*ipv4_hdr);
+	}
+	pkt->l2_len = l2_len;
+	pkt->l3_len = sizeof(*ipv4_hdr);
+	pkt->l4_len = l4_len;
+
+	return 0;
+}
+
+/*
+ * Check whether a packet directly follows (1) or precedes (-1) an item,
+ * or is not its neighbor (0).
+ */
+static inline int
+gro_tcp4_check_neighbor(const struct gro_tcp4_item *item,
+		const struct gro_tcp4_info *info, uint8_t tunnel)
+{
+	const struct tcp_hdr *item_tcp_hdr;
+	uint16_t item_payload_len, l4_len;
+
+	if (item->hdr_len != info->hdr_len)
+		return 0;
+
+	/* TCP options must be identical */
+	l4_len = item->firstseg->l4_len;
+	item_tcp_hdr = rte_pktmbuf_mtod_offset(item->firstseg,
+			const struct tcp_hdr *, item->hdr_len - l4_len);
+	if (l4_len > sizeof(struct tcp_hdr) &&
+			memcmp(item_tcp_hdr + 1, info->tcp_hdr + 1,
+				l4_len - sizeof(struct tcp_hdr)) != 0)
+		return 0;
+
+	item_payload_len = item->firstseg->pkt_len - item->hdr_len;
+
+	if (info->sent_seq == item->sent_seq + item_payload_len &&
+			info->ip_id == (uint16_t)(item->ip_id +
+				item->nb_merged) &&
+			(!tunnel || info->outer_ip_id ==
+			 (uint16_t)(item->outer_ip_id + item->nb_merged)))
+		return 1;
+
+	if (info->sent_seq + info->payload_len == item->sent_seq &&
+			(uint16_t)(info->ip_id + 1) == item->ip_id &&
+			(!tunnel || (uint16_t)(info->outer_ip_id + 1) ==
+			 item->outer_ip_id))
+		return -1;
+
+	return 0;
+}
+
+static inline uint32_t
+gro_tcp4_find_free_item(const struct gro_tcp4_tbl *tbl)
+{
+	uint32_t i;
+
+	for (i = 0; i < tbl->max_item_num; i++)
+		if (tbl->items[i].firstseg == NULL)
+			return i;
+	return GRO_TCP4_INVALID_INDEX;
+}
+
+static inline uint32_t
+gro_tcp4_find_free_flow(const struct gro_tcp4_tbl *tbl)
+{
+	uint32_t i;
+
+	for (i = 0; i < tbl->max_flow_num; i++)
+		if (tbl->flows[i].start_index == GRO_TCP4_INVALID_INDEX)
+			return i;
+	return GRO_TCP4_INVALID_INDEX;
+}
+
+static inline uint32_t
+gro_tcp4_insert_item(struct gro_tcp4_tbl *tbl, struct rte_mbuf *pkt,
+		const struct gro_tcp4_info *info, uint64_t start_time)
+{
+	struct gro_tcp4_item *item;
+	uint32_t item_idx;
+
+	item_idx = gro_tcp4_find_free_item(tbl);
+	if (item_idx == GRO_TCP4_INVALID_INDEX)
+		return GRO_TCP4_INVALID_INDEX;
+
+	item = &tbl->items[item_idx];
+	item->firstseg = pkt;
+	item->lastseg = rte_pktmbuf_lastseg(pkt);
+	item->start_time = start_time;
+	item->next_pkt_idx = GRO_TCP4_INVALID_INDEX;
+	item->sent_seq = info->sent_seq;
+	item->ip_id = info->ip_id;
+	item->outer_ip_id = info->outer_ip_id;
+	item->hdr_len = info->hdr_len;
+	item->nb_merged = 1;
+	tbl->item_num++;
+
+	return item_idx;
+}
+
+/* Chain the payload of pkt after the one of item */
+static inline void
+gro_tcp4_merge_append(struct gro_tcp4_item *item, struct rte_mbuf *pkt)
+{
+	rte_pktmbuf_adj(pkt, item->hdr_len);
+	item->lastseg->next = pkt;
+	item->lastseg = rte_pktmbuf_lastseg(pkt);
+	item->firstseg->nb_segs += pkt->nb_segs;
+	item->firstseg->pkt_len += pkt->pkt_len;
+	item->nb_merged++;
+}
+
+/* Chain the payload of item after the headers and payload of pkt */
+static inline void
+gro_tcp4_merge_prepend(struct gro_tcp4_item *item, struct rte_mbuf *pkt,
+		const struct gro_tcp4_info *info)
+{
+	struct rte_mbuf *first = item->firstseg;
+
+	rte_pktmbuf_adj(first, item->hdr_len);
+	rte_pktmbuf_lastseg(pkt)->next = first;
+	pkt->nb_segs += first->nb_segs;
+	pkt->pkt_len += first->pkt_len;
+	item->firstseg = pkt;
+	item->sent_seq = info->sent_seq;
+	item->ip_id = info->ip_id;
+	item->outer_ip_id = info->outer_ip_id;
+	item->nb_merged++;
+}
+
+int32_t
+gro_tcp4_reassemble(struct rte_mbuf *pkt,
+		struct gro_tcp4_tbl *tbl,
+		uint64_t start_time)
+{
+	struct gro_tcp4_info info;
+	struct gro_tcp4_item *item;
+	uint32_t i, flow_idx, item_idx, prev_idx;
+	int cmp;
+
+	if (pkt->ol_flags & (PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_BAD))
+		return -1;
+
+	if (gro_tcp4_parse(pkt, tbl->tunnel, &info) < 0)
+		return -1;
+
+	/* look for the flow of the packet */
+	flow_idx = GRO_TCP4_INVALID_INDEX;
+	for (i = 0; i < tbl->max_flow_num && tbl->flow_num > 0; i++) {
+		if (tbl->flows[i].start_index != GRO_TCP4_INVALID_INDEX &&
+				memcmp(&tbl->flows[i].key, &info.key,
+					sizeof(info.key)) == 0) {
+			flow_idx = i;
+			break;
+		}
+	}
+
+	if (flow_idx == GRO_TCP4_INVALID_INDEX) {
+		flow_idx = gro_tcp4_find_free_flow(tbl);
+		if (flow_idx == GRO_TCP4_INVALID_INDEX)
+			return -1;
+		item_idx = gro_tcp4_insert_item(tbl, pkt, &info, start_time);
+		if (item_idx == GRO_TCP4_INVALID_INDEX)
+			return -1;
+		tbl->flows[flow_idx].key = info.key;
+		tbl->flows[flow_idx].start_index = item_idx;
+		tbl->flow_num++;
+		return 0;
+	}
+
+	/* look for a neighbor of the packet in the flow */
+	prev_idx = GRO_TCP4_INVALID_INDEX;
+	for (i = tbl->flows[flow_idx].start_index;
+			i != GRO_TCP4_INVALID_INDEX;
+			i = tbl->items[i].next_pkt_idx) {
+		item = &tbl->items[i];
+		cmp = gro_tcp4_check_neighbor(item, &info, tbl->tunnel);
+		if (cmp == 0) {
+			prev_idx = i;
+			continue;
+		}
+		if (item->firstseg->pkt_len + info.payload_len -
+				(tbl->tunnel ? item->firstseg->outer_l2_len :
+				 item->firstseg->l2_len) > GRO_TCP4_MAX_IP_LEN)
+			return -1;
+		if (cmp > 0)
+			gro_tcp4_merge_append(item, pkt);
+		else
+			gro_tcp4_merge_prepend(item, pkt, &info);
+		return 1;
+	}
+
+	/* no neighbor: hold the packet as a new item of the flow */
+	item_idx = gro_tcp4_insert_item(tbl, pkt, &info, start_time);
+	if (item_idx == GRO_TCP4_INVALID_INDEX)
+		return -1;
+	tbl->items[prev_idx].next_pkt_idx = item_idx;
+
+	return 0;
+}
+
+/* Fix the lengths and IPv4 checksums of a merged packet */
+static inline void
+gro_tcp4_update_header(struct gro_tcp4_item *item, uint8_t tunnel)
+{
+	struct rte_mbuf *pkt = item->firstseg;
+	struct ipv4_hdr *ipv4_hdr;
+	struct udp_hdr *udp_hdr;
+	uint16_t l3_offset = 0;
+
+	if (tunnel) {
+		ipv4_hdr = rte_pktmbuf_mtod_offset(pkt, struct ipv4_hdr *,
+				pkt->outer_l2_len);
+		ipv4_hdr->total_length = rte_cpu_to_be_16(pkt->pkt_len -
+				pkt->outer_l2_len);
+		ipv4_hdr->hdr_checksum = 0;
+		ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+
+		/* the UDP checksum of the merged packet is not computed */
+		udp_hdr = (struct udp_hdr *)(ipv4_hdr + 1);
+		udp_hdr->dgram_len = rte_cpu_to_be_16(pkt->pkt_len -
+				pkt->outer_l2_len - pkt->outer_l3_len);
+		udp_hdr->dgram_cksum = 0;
+
+		l3_offset = pkt->outer_l2_len + pkt->outer_l3_len;
+	}
+
+	l3_offset += pkt->l2_len;
+	ipv4_hdr = rte_pktmbuf_mtod_offset(pkt, struct ipv4_hdr *, l3_offset);
+	ipv4_hdr->total_length = rte_cpu_to_be_16(pkt->pkt_len - l3_offset);
+	ipv4_hdr->hdr_checksum = 0;
+	ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+}
+
+uint16_t
+gro_tcp4_tbl_timeout_flush(struct gro_tcp4_tbl *tbl,
+		uint64_t flush_timestamp,
+		struct rte_mbuf **out,
+		uint16_t nb_out)
+{
+	struct gro_tcp4_flow *flow;
+	struct gro_tcp4_item *item;
+	uint32_t i, j, next, prev;
+	uint16_t k = 0;
+
+	for (i = 0; i < tbl->max_flow_num && tbl->flow_num > 0; i++) {
+		flow = &tbl->flows[i];
+		if (flow->start_index == GRO_TCP4_INVALID_INDEX)
+			continue;
+		prev = GRO_TCP4_INVALID_INDEX;
+		for (j = flow->start_index; j != GRO_TCP4_INVALID_INDEX;
+				j = next) {
+			item = &tbl->items[j];
+			next = item->next_pkt_idx;
+			if (item->start_time > flush_timestamp) {
+				prev = j;
+				continue;
+			}
+			if (k == nb_out)
+				break;
+
+			if (item->nb_merged > 1)
+				gro_tcp4_update_header(item, tbl->tunnel);
+			out[k++] = item->firstseg;
+			item->firstseg = NULL;
+			tbl->item_num--;
+
+			if (prev == GRO_TCP4_INVALID_INDEX)
+				flow->start_index = next;
+			else
+				tbl->items[prev].next_pkt_idx = next;
+		}
+		if (flow->start_index == GRO_TCP4_INVALID_INDEX)
+			tbl->flow_num--;
+		if (k == nb_out)
+			break;
+	}
+
+	return k;
+}
@@ -0,0 +1,149 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _GRO_TCP4_H_
+#define _GRO_TCP4_H_
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+
+#define GRO_TCP4_INVALID_INDEX UINT32_MAX
+
+/* UDP destination port identifying VxLAN packets */
+#define GRO_VXLAN_UDP_PORT 4789
+
+/*
+ * Flow key of a TCP/IPv4 packet. The outer fields are only used for
+ * VxLAN-encapsulated packets and are zero otherwise.
+ */
+struct gro_tcp4_key {
+	struct ether_addr outer_eth_saddr;
+	struct ether_addr outer_eth_daddr;
+	uint32_t outer_ip_src_addr;
+	uint32_t outer_ip_dst_addr;
+	uint32_t vxlan_vni;
+	uint16_t outer_src_port;
+	uint16_t outer_dst_port;
+	struct ether_addr eth_saddr;
+	struct ether_addr eth_daddr;
+	uint32_t ip_src_addr;
+	uint32_t ip_dst_addr;
+	uint32_t recv_ack;
+	uint16_t src_port;
+	uint16_t dst_port;
+};
+
+struct gro_tcp4_flow {
+	struct gro_tcp4_key key;
+	/* index of the first item of the flow, or GRO_TCP4_INVALID_INDEX */
+	uint32_t start_index;
+};
+
+/* A packet held in a table, possibly made of several merged packets */
+struct gro_tcp4_item {
+	struct rte_mbuf *firstseg;
+	struct rte_mbuf *lastseg;
+	/* time at which the oldest merged packet was inserted */
+	uint64_t start_time;
+	/* index of the next item of the same flow */
+	uint32_t next_pkt_idx;
+	/* TCP sequence number of the first merged packet */
+	uint32_t sent_seq;
+	/* IPv4 IDs of the first merged packet */
+	uint16_t ip_id;
+	uint16_t outer_ip_id;
+	/* length of all the packet headers */
+	uint16_t hdr_len;
+	/* number of merged packets */
+	uint16_t nb_merged;
+};
+
+struct gro_tcp4_tbl {
+	struct gro_tcp4_item *items;
+	struct gro_tcp4_flow *flows;
+	uint32_t item_num;
+	uint32_t max_item_num;
+	uint32_t flow_num;
+	uint32_t max_flow_num;
+	/* table of VxLAN-encapsulated packets */
+	uint8_t tunnel;
+};
+
+/*
+ * Initialize a table on caller provided item and flow arrays.
+ */
+void gro_tcp4_tbl_init(struct gro_tcp4_tbl *tbl,
+		struct gro_tcp4_item *items,
+		uint32_t max_item_num,
+		struct gro_tcp4_flow *flows,
+		uint32_t max_flow_num,
+		uint8_t tunnel);
+
+/*
+ * Allocate and initialize a table.
+ */
+struct gro_tcp4_tbl *gro_tcp4_tbl_create(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow,
+		uint8_t tunnel);
+
+/*
+ * Free a table allocated by gro_tcp4_tbl_create() and the packets it holds.
+ */
+void gro_tcp4_tbl_destroy(struct gro_tcp4_tbl *tbl);
+
+/*
+ * Merge a packet with a packet held by the table, or hold it.
+ *
+ * Return 1 if the packet is merged, 0 if it is held by the table as a new
+ * item and -1 if it cannot be processed (unsupported packet, full table).
+ */
+int32_t gro_tcp4_reassemble(struct rte_mbuf *pkt,
+		struct gro_tcp4_tbl *tbl,
+		uint64_t start_time);
+
+/*
+ * Remove from the table the packets inserted at or before flush_timestamp,
+ * fix their headers and store them in out.
+ *
+ * Return the number of packets stored in out.
+ */
+uint16_t gro_tcp4_tbl_timeout_flush(struct gro_tcp4_tbl *tbl,
+		uint64_t flush_timestamp,
+		struct rte_mbuf **out,
+		uint16_t nb_out);
+
+#endif /* _GRO_TCP4_H_ */
@@ -0,0 +1,234 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+
+#include "rte_gro.h"
+#include "gro_tcp4.h"
+
+#define GRO_SUPPORTED_TYPES (RTE_GRO_TCP_IPV4 | RTE_GRO_IPV4_VXLAN_TCP_IPV4)
+
+/* GRO context of the heavyweight mode */
+struct gro_ctx {
+	/* GRO types with a table */
+	uint64_t gro_types;
+	/* tables, indexed by RTE_GRO_*_INDEX */
+	struct gro_tcp4_tbl *tbls[RTE_GRO_TYPE_SUPPORT_NUM];
+};
+
+/*
+ * Try the packet against each table, VxLAN first as a VxLAN packet is
+ * also a UDP/IPv4 one.
+ */
+static inline int32_t
+gro_reassemble_pkt(struct rte_mbuf *pkt,
+		struct gro_tcp4_tbl *vxlan_tbl,
+		struct gro_tcp4_tbl *tcp4_tbl,
+		uint64_t start_time)
+{
+	int32_t ret = -1;
+
+	if (vxlan_tbl != NULL)
+		ret = gro_tcp4_reassemble(pkt, vxlan_tbl, start_time);
+	if (ret < 0 && tcp4_tbl != NULL)
+		ret = gro_tcp4_reassemble(pkt, tcp4_tbl, start_time);
+
+	return ret;
+}
+
+uint16_t
+rte_gro_reassemble_burst(struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		const struct rte_gro_param *param)
+{
+	struct gro_tcp4_item items[RTE_GRO_TYPE_SUPPORT_NUM]
+		[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_tcp4_flow flows[RTE_GRO_TYPE_SUPPORT_NUM]
+		[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_tcp4_tbl tbls[RTE_GRO_TYPE_SUPPORT_NUM];
+	struct gro_tcp4_tbl *tcp4_tbl = NULL, *vxlan_tbl = NULL;
+	uint32_t item_num, flow_num;
+	uint16_t i, nb_out = 0;
+
+	if (nb_pkts < 2 || (param->gro_types & GRO_SUPPORTED_TYPES) == 0)
+		return nb_pkts;
+
+	item_num = RTE_MIN((uint32_t)nb_pkts, RTE_GRO_MAX_BURST_ITEM_NUM);
+	item_num = RTE_MIN(item_num,
+			(uint32_t)param->max_flow_num * param->max_item_per_flow);
+	flow_num = RTE_MIN(item_num, (uint32_t)param->max_flow_num);
+	if (item_num == 0)
+		return nb_pkts;
+
+	if (param->gro_types & RTE_GRO_TCP_IPV4) {
+		tcp4_tbl = &tbls[RTE_GRO_TCP_IPV4_INDEX];
+		gro_tcp4_tbl_init(tcp4_tbl, items[RTE_GRO_TCP_IPV4_INDEX],
+				item_num, flows[RTE_GRO_TCP_IPV4_INDEX],
+				flow_num, 0);
+	}
+	if (param->gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4) {
+		vxlan_tbl = &tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX];
+		gro_tcp4_tbl_init(vxlan_tbl,
+				items[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX],
+				item_num,
+				flows[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX],
+				flow_num, 1);
+	}
+
+	/* unprocessed packets are kept in place, in front of the array */
+	for (i = 0; i < nb_pkts; i++) {
+		if (gro_reassemble_pkt(pkts[i], vxlan_tbl, tcp4_tbl, 0) < 0)
+			pkts[nb_out++] = pkts[i];
+	}
+
+	/* then the held packets */
+	if (tcp4_tbl != NULL)
+		nb_out += gro_tcp4_tbl_timeout_flush(tcp4_tbl, UINT64_MAX,
+				&pkts[nb_out], nb_pkts - nb_out);
+	if (vxlan_tbl != NULL)
+		nb_out += gro_tcp4_tbl_timeout_flush(vxlan_tbl, UINT64_MAX,
+				&pkts[nb_out], nb_pkts - nb_out);
+
+	return nb_out;
+}
+
+void *
+rte_gro_ctx_create(const struct rte_gro_param *param)
+{
+	struct gro_ctx *gro_ctx;
+	uint32_t i;
+
+	if (param == NULL || (param->gro_types & GRO_SUPPORTED_TYPES) == 0)
+		return NULL;
+
+	gro_ctx = rte_zmalloc_socket(__func__, sizeof(*gro_ctx),
+			RTE_CACHE_LINE_SIZE, param->socket_id);
+	if (gro_ctx == NULL)
+		return NULL;
+
+	for (i = 0; i < RTE_GRO_TYPE_SUPPORT_NUM; i++) {
+		if ((param->gro_types & (1ULL << i)) == 0)
+			continue;
+		gro_ctx->tbls[i] = gro_tcp4_tbl_create(param->socket_id,
+				param->max_flow_num,
+				param->max_item_per_flow,
+				i == RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX);
+		if (gro_ctx->tbls[i] == NULL) {
+			rte_gro_ctx_destroy(gro_ctx);
+			return NULL;
+		}
+		gro_ctx->gro_types |= 1ULL << i;
+	}
+
+	return gro_ctx;
+}
+
+void
+rte_gro_ctx_destroy(void *ctx)
+{
+	struct gro_ctx *gro_ctx = ctx;
+	uint32_t i;
+
+	if (gro_ctx == NULL)
+		return;
+
+	for (i = 0; i < RTE_GRO_TYPE_SUPPORT_NUM; i++)
+		gro_tcp4_tbl_destroy(gro_ctx->tbls[i]);
+	rte_free(gro_ctx);
+}
+
+uint16_t
+rte_gro_reassemble(struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		void *ctx)
+{
+	struct gro_ctx *gro_ctx = ctx;
+	uint64_t now;
+	uint16_t i, nb_out = 0;
+
+	now = rte_rdtsc();
+	for (i = 0; i < nb_pkts; i++) {
+		if (gro_reassemble_pkt(pkts[i],
+				gro_ctx->tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX],
+				gro_ctx->tbls[RTE_GRO_TCP_IPV4_INDEX], now) < 0)
+			pkts[nb_out++] = pkts[i];
+	}
+
+	return nb_out;
+}
+
+uint16_t
+rte_gro_timeout_flush(void *ctx,
+		uint64_t timeout_cycles,
+		uint64_t gro_types,
+		struct rte_mbuf **out,
+		uint16_t max_nb_out)
+{
+	struct gro_ctx *gro_ctx = ctx;
+	uint64_t flush_timestamp, now;
+	uint16_t nb_out = 0;
+	uint32_t i;
+
+	now = rte_rdtsc();
+	flush_timestamp = (timeout_cycles > now) ? 0 : now - timeout_cycles;
+	if (timeout_cycles == 0)
+		flush_timestamp = UINT64_MAX;
+
+	gro_types &= gro_ctx->gro_types;
+	for (i = 0; i < RTE_GRO_TYPE_SUPPORT_NUM && nb_out < max_nb_out; i++) {
+		if ((gro_types & (1ULL << i)) == 0)
+			continue;
+		nb_out += gro_tcp4_tbl_timeout_flush(gro_ctx->tbls[i],
+				flush_timestamp, &out[nb_out],
+				max_nb_out - nb_out);
+	}
+
+	return nb_out;
+}
+
+uint64_t
+rte_gro_get_pkt_count(void *ctx)
+{
+	struct gro_ctx *gro_ctx = ctx;
+	uint64_t count = 0;
+	uint32_t i;
+
+	for (i = 0; i < RTE_GRO_TYPE_SUPPORT_NUM; i++) {
+		if (gro_ctx->tbls[i] != NULL)
+			count += gro_ctx->tbls[i]->item_num;
+	}
+
+	return count;
+}
@@ -0,0 +1,201 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _RTE_GRO_H_
+#define _RTE_GRO_H_
+
+/**
+ * @file
+ * Interface to GRO library
+ *
+ * Generic Receive Offload (GRO) merges in software the received TCP
+ * segments of a same flow into larger packets, so that the upper layers
+ * process fewer packets. The supported packet types are TCP/IPv4 and
+ * VxLAN-encapsulated TCP/IPv4 (outer IPv4, UDP destination port 4789).
+ * Merged packets are mbuf chains: the payload is never copied.
+ *
+ * Two modes are provided:
+ *
+ *  - lightweight mode: rte_gro_reassemble_burst() merges the packets of
+ *    a single burst and returns all of them at once;
+ *
+ *  - heavyweight mode: rte_gro_reassemble() keeps the packets that can be
+ *    merged in a GRO context across bursts, and rte_gro_timeout_flush()
+ *    releases the ones that have been held for longer than a timeout.
+ *
+ * A packet is only merged when its TCP flags are ACK only, it carries
+ * payload, its IPv4 header has no options and is not fragmented, and its
+ * checksums were not reported as bad by the NIC. The lengths and IPv4
+ * header checksums of the merged packets are updated, the TCP checksum is
+ * not.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <rte_mbuf.h>
+
+/** Maximum number of packets merged by rte_gro_reassemble_burst(). */
+#define RTE_GRO_MAX_BURST_ITEM_NUM 128U
+
+#define RTE_GRO_TYPE_MAX_NUM 64
+/**< the max number of supported GRO types */
+#define RTE_GRO_TYPE_SUPPORT_NUM 2
+/**< the number of currently supported GRO types */
+
+#define RTE_GRO_TCP_IPV4_INDEX 0
+#define RTE_GRO_TCP_IPV4 (1ULL << RTE_GRO_TCP_IPV4_INDEX)
+/**< TCP/IPv4 GRO flag */
+#define RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX 1
+#define RTE_GRO_IPV4_VXLAN_TCP_IPV4 (1ULL << RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX)
+/**< VxLAN-encapsulated TCP/IPv4 GRO flag */
+
+/**
+ * GRO parameters.
+ */
+struct rte_gro_param {
+	uint64_t gro_types;
+	/**< Desired GRO types (RTE_GRO_*) */
+	uint16_t max_flow_num;
+	/**< Max number of flows of each GRO type */
+	uint16_t max_item_per_flow;
+	/**< Max number of packets held per flow */
+	uint16_t socket_id;
+	/**< Socket to allocate the GRO context from */
+};
+
+/**
+ * Merge the packets of a burst (lightweight mode).
+ *
+ * The packets that were not processed by GRO are put first in the pkts
+ * array, in their original order, followed by the merged packets, ordered
+ * by flow. The packets merged into other
+ * ones are not returned anymore: they are now part of the mbuf chains of
+ * the merged packets.
+ *
+ * @param pkts
+ *   Array of received packets, rewritten with the output packets.
+ * @param nb_pkts
+ *   Number of received packets.
+ * @param param
+ *   GRO parameters. The number of packets held at the same time is
+ *   limited by max_flow_num * max_item_per_flow and by
+ *   RTE_GRO_MAX_BURST_ITEM_NUM.
+ * @return
+ *   The number of packets in the pkts array after merging.
+ */
+uint16_t rte_gro_reassemble_burst(struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		const struct rte_gro_param *param);
+
+/**
+ * Create a GRO context for the heavyweight mode. A context is not thread
+ * safe and is typically owned by a single lcore.
+ *
+ * @param param
+ *   GRO parameters.
+ * @return
+ *   The GRO context on success, NULL otherwise.
+ */
+void *rte_gro_ctx_create(const struct rte_gro_param *param);
+
+/**
+ * Destroy a GRO context. The packets still held by the context are freed.
+ *
+ * @param ctx
+ *   GRO context.
+ */
+void rte_gro_ctx_destroy(void *ctx);
+
+/**
+ * Merge packets into the packets held by a GRO context (heavyweight mode).
+ *
+ * The packets that can be merged are kept by the context: they are either
+ * merged with a packet already held or held until they are released by
+ * rte_gro_timeout_flush(). The other packets are returned in the pkts
+ * array.
+ *
+ * @param pkts
+ *   Array of received packets, rewritten with the unprocessed packets.
+ * @param nb_pkts
+ *   Number of received packets.
+ * @param ctx
+ *   GRO context.
+ * @return
+ *   The number of unprocessed packets returned in the pkts array.
+ */
+uint16_t rte_gro_reassemble(struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		void *ctx);
+
+/**
+ * Release the packets held by a GRO context for at least timeout_cycles
+ * TSC cycles. A timeout of 0 releases all the held packets.
+ *
+ * @param ctx
+ *   GRO context.
+ * @param timeout_cycles
+ *   Timeout, in TSC cycles.
+ * @param gro_types
+ *   GRO types (RTE_GRO_*) of the packets to release.
+ * @param out
+ *   Array to store the released packets.
+ * @param max_nb_out
+ *   Size of the out array.
+ * @return
+ *   The number of packets released.
+ */
+uint16_t rte_gro_timeout_flush(void *ctx,
+		uint64_t timeout_cycles,
+		uint64_t gro_types,
+		struct rte_mbuf **out,
+		uint16_t max_nb_out);
+
+/**
+ * Get the number of packets held by a GRO context.
+ *
+ * @param ctx
+ *   GRO context.
+ * @return
+ *   The number of held packets.
+ */
+uint64_t rte_gro_get_pkt_count(void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_GRO_H_ */
@@ -0,0 +1,233 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_memcpy.h>
+#include <rte_mempool.h>
+#include <rte_byteorder.h>
+
+#include "gso_common.h"
+
+static inline void
+gso_free_pkts(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+int
+gso_do_segment(struct rte_mbuf *pkt,
+		uint16_t hdr_len,
+		uint16_t pyld_unit_size,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out,
+		uint16_t nb_pkts_out)
+{
+	struct rte_mbuf *pkt_in, *hdr_seg, *pyld_seg, *prev_seg;
+	uint32_t pyld_left, seg_left, in_off, len;
+	uint16_t nb_segs = 0;
+	int ret;
+
+	pkt_in = pkt;
+	in_off = hdr_len;
+	pyld_left = pkt->pkt_len - hdr_len;
+
+	while (pyld_left > 0) {
+		if (unlikely(nb_segs >= nb_pkts_out)) {
+			ret = -EINVAL;
+			goto error;
+		}
+
+		/* Direct mbuf holding a copy of the packet headers */
+		hdr_seg = rte_pktmbuf_alloc(direct_pool);
+		if (unlikely(hdr_seg == NULL)) {
+			ret = -ENOMEM;
+			goto error;
+		}
+		pkts_out[nb_segs++] = hdr_seg;
+
+		rte_memcpy(rte_pktmbuf_mtod(hdr_seg, char *),
+				rte_pktmbuf_mtod(pkt, char *), hdr_len);
+		hdr_seg->data_len = hdr_len;
+		hdr_seg->pkt_len = hdr_len;
+		hdr_seg->port = pkt->port;
+		hdr_seg->vlan_tci = pkt->vlan_tci;
+		hdr_seg->vlan_tci_outer = pkt->vlan_tci_outer;
+		hdr_seg->hash = pkt->hash;
+		hdr_seg->packet_type = pkt->packet_type;
+		hdr_seg->tx_offload = pkt->tx_offload;
+		hdr_seg->ol_flags = pkt->ol_flags & ~PKT_TX_TCP_SEG;
+
+		/* Indirect mbufs pointing to the payload of the input packet */
+		seg_left = RTE_MIN((uint32_t)pyld_unit_size, pyld_left);
+		pyld_left -= seg_left;
+		prev_seg = hdr_seg;
+		while (seg_left > 0) {
+			while (in_off >= pkt_in->data_len) {
+				in_off -= pkt_in->data_len;
+				pkt_in = pkt_in->next;
+			}
+			len = RTE_MIN(seg_left, pkt_in->data_len - in_off);
+
+			pyld_seg = rte_pktmbuf_alloc(indirect_pool);
+			if (unlikely(pyld_seg == NULL)) {
+				ret = -ENOMEM;
+				goto error;
+			}
+			rte_pktmbuf_attach(pyld_seg, pkt_in);
+			pyld_seg->data_off += in_off;
+			pyld_seg->data_len = len;
+			pyld_seg->pkt_len = len;
+
+			prev_seg->next = pyld_seg;
+			prev_seg = pyld_seg;
+			hdr_seg->nb_segs++;
+			hdr_seg->pkt_len += len;
+
+			in_off += len;
+			seg_left -= len;
+		}
+	}
+
+	return nb_segs;
+
+error:
+	gso_free_pkts(pkts_out, nb_segs);
+	return ret;
+}
+
+/* TCP checksum of a segment, walking over its mbuf chain. */
+static uint16_t
+gso_tcp4_cksum(const struct rte_mbuf *seg, const struct ipv4_hdr *ipv4_hdr,
+		uint16_t l4_offset)
+{
+	struct ipv4_psd_header {
+		uint32_t src_addr;
+		uint32_t dst_addr;
+		uint8_t  zero;
+		uint8_t  proto;
+		uint16_t len;
+	} __attribute__((__packed__)) psd_hdr;
+	const struct rte_mbuf *m;
+	uint32_t sum, tmp, done, off, len;
+
+	psd_hdr.src_addr = ipv4_hdr->src_addr;
+	psd_hdr.dst_addr = ipv4_hdr->dst_addr;
+	psd_hdr.zero = 0;
+	psd_hdr.proto = IPPROTO_TCP;
+	psd_hdr.len = rte_cpu_to_be_16(seg->pkt_len - l4_offset);
+	sum = __rte_raw_cksum(&psd_hdr, sizeof(psd_hdr), 0);
+
+	done = 0;
+	off = l4_offset;
+	for (m = seg; m != NULL; m = m->next) {
+		len = m->data_len - off;
+		tmp = __rte_raw_cksum_reduce(__rte_raw_cksum(
+			rte_pktmbuf_mtod_offset(m, const char *, off), len, 0));
+		/* data starting at an odd offset is byte swapped in the sum */
+		if (done & 1)
+			tmp = rte_bswap16((uint16_t)tmp);
+		sum += tmp;
+		done += len;
+		off = 0;
+	}
+
+	sum = __rte_raw_cksum_reduce(sum);
+	sum = (~sum) & 0xffff;
+	if (sum == 0)
+		sum = 0xffff;
+
+	return (uint16_t)sum;
+}
+
+void
+gso_update_tcp4_segments(struct rte_mbuf **segs, uint16_t nb_segs,
+		uint16_t l3_offset, uint16_t l3_len, uint16_t l4_len,
+		uint16_t ipid_delta)
+{
+	struct ipv4_hdr *ipv4_hdr;
+	struct tcp_hdr *tcp_hdr;
+	uint32_t sent_seq;
+	uint16_t id, l4_offset, hdr_len, i;
+	uint8_t tcp_flags;
+	int sw_ip_cksum, sw_tcp_cksum;
+
+	l4_offset = l3_offset + l3_len;
+	hdr_len = l4_offset + l4_len;
+
+	ipv4_hdr = rte_pktmbuf_mtod_offset(segs[0], struct ipv4_hdr *,
+			l3_offset);
+	tcp_hdr = (struct tcp_hdr *)((char *)ipv4_hdr + l3_len);
+	id = rte_be_to_cpu_16(ipv4_hdr->packet_id);
+	sent_seq = rte_be_to_cpu_32(tcp_hdr->sent_seq);
+	tcp_flags = tcp_hdr->tcp_flags;
+
+	sw_ip_cksum = !(segs[0]->ol_flags & PKT_TX_IP_CKSUM);
+	sw_tcp_cksum = (segs[0]->ol_flags & PKT_TX_L4_MASK) !=
+		PKT_TX_TCP_CKSUM;
+
+	for (i = 0; i < nb_segs; i++) {
+		ipv4_hdr = rte_pktmbuf_mtod_offset(segs[i], struct ipv4_hdr *,
+				l3_offset);
+		tcp_hdr = (struct tcp_hdr *)((char *)ipv4_hdr + l3_len);
+
+		gso_update_ipv4_header(segs[i], l3_offset, l3_len, id,
+				sw_ip_cksum);
+		id += ipid_delta;
+
+		tcp_hdr->sent_seq = rte_cpu_to_be_32(sent_seq);
+		sent_seq += segs[i]->pkt_len - hdr_len;
+
+		/* FIN and PSH only on the last segment, CWR only on the first */
+		tcp_hdr->tcp_flags = tcp_flags;
+		if (i < nb_segs - 1)
+			tcp_hdr->tcp_flags &= ~(TCP_HDR_FIN_MASK |
+					TCP_HDR_PSH_MASK);
+		if (i > 0)
+			tcp_hdr->tcp_flags &= ~TCP_HDR_CWR_MASK;
+
+		tcp_hdr->cksum = 0;
+		if (sw_tcp_cksum)
+			tcp_hdr->cksum = gso_tcp4_cksum(segs[i], ipv4_hdr,
+					l4_offset);
+		else
+			tcp_hdr->cksum = rte_ipv4_phdr_cksum(ipv4_hdr,
+					segs[i]->ol_flags);
+	}
+}
@@ -0,0 +1,107 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _GSO_COMMON_H_
+#define _GSO_COMMON_H_
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#define TCP_HDR_PSH_MASK ((uint8_t)0x08)
+#define TCP_HDR_FIN_MASK ((uint8_t)0x01)
+#define TCP_HDR_CWR_MASK ((uint8_t)0x80)
+
+#define IS_FRAGMENTED(frag_off) (((frag_off) & \
+		rte_cpu_to_be_16(IPV4_HDR_OFFSET_MASK | IPV4_HDR_MF_FLAG)) != 0)
+
+/**
+ * Split the payload of a packet into output packets of at most
+ * pyld_unit_size payload bytes each. Every output packet starts with a
+ * direct mbuf holding a copy of the first hdr_len bytes of the input
+ * packet, followed by indirect mbufs attached to the input packet
+ * segments. Only the mbuf metadata of the output packets is set: the
+ * copied headers are left untouched.
+ *
+ * @return
+ *   The number of output packets on success, a negative errno value
+ *   otherwise, in which case the output packets already built are freed.
+ */
+int gso_do_segment(struct rte_mbuf *pkt,
+		uint16_t hdr_len,
+		uint16_t pyld_unit_size,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out,
+		uint16_t nb_pkts_out);
+
+/**
+ * Fix the IPv4 and TCP headers of the packets built by gso_do_segment()
+ * from a TCP/IPv4 packet, whose IPv4 header is at l3_offset: IP total
+ * length and ID, TCP sequence number and flags, and the checksums that are
+ * not offloaded to the NIC according to the packet ol_flags.
+ */
+void gso_update_tcp4_segments(struct rte_mbuf **segs, uint16_t nb_segs,
+		uint16_t l3_offset, uint16_t l3_len, uint16_t l4_len,
+		uint16_t ipid_delta);
+
+/** Compute the checksum of an IPv4 header, including its options. */
+static inline uint16_t
+gso_ipv4_cksum(const struct ipv4_hdr *ipv4_hdr, uint16_t l3_len)
+{
+	uint16_t cksum;
+
+	cksum = rte_raw_cksum(ipv4_hdr, l3_len);
+	return (cksum == 0xffff) ? cksum : ~cksum;
+}
+
+/** Fix the total length, ID and checksum of an IPv4 header. */
+static inline void
+gso_update_ipv4_header(struct rte_mbuf *seg, uint16_t l3_offset,
+		uint16_t l3_len, uint16_t id, int sw_cksum)
+{
+	struct ipv4_hdr *ipv4_hdr;
+
+	ipv4_hdr = rte_pktmbuf_mtod_offset(seg, struct ipv4_hdr *, l3_offset);
+	ipv4_hdr->total_length = rte_cpu_to_be_16(seg->pkt_len - l3_offset);
+	ipv4_hdr->packet_id = rte_cpu_to_be_16(id);
+	ipv4_hdr->hdr_checksum = 0;
+	if (sw_cksum)
+		ipv4_hdr->hdr_checksum = gso_ipv4_cksum(ipv4_hdr, l3_len);
+}
+
+#endif /* _GSO_COMMON_H_ */
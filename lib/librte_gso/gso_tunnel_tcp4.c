@@ -0,0 +1,116 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <errno.h>
+
+#include <rte_gre.h>
+
+#include "gso_common.h"
+#include "gso_tunnel_tcp4.h"
+
+int
+gso_tunnel_tcp4_segment(struct rte_mbuf *pkt,
+		uint16_t gso_size,
+		uint16_t ipid_delta,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out,
+		uint16_t nb_pkts_out)
+{
+	struct ipv4_hdr *outer_ipv4_hdr, *ipv4_hdr;
+	struct udp_hdr *udp_hdr;
+	struct gre_hdr *gre_hdr;
+	uint16_t outer_l3_offset, tunnel_offset, l3_offset, hdr_len;
+	uint16_t outer_id, i;
+	int vxlan, sw_outer_ip_cksum, ret;
+
+	outer_l3_offset = pkt->outer_l2_len;
+	tunnel_offset = outer_l3_offset + pkt->outer_l3_len;
+	l3_offset = tunnel_offset + pkt->l2_len;
+	hdr_len = l3_offset + pkt->l3_len + pkt->l4_len;
+	if (unlikely(hdr_len >= gso_size || hdr_len > pkt->data_len))
+		return -EINVAL;
+
+	vxlan = (pkt->ol_flags & PKT_TX_TUNNEL_MASK) == PKT_TX_TUNNEL_VXLAN;
+	if (!vxlan) {
+		/*
+		 * The GRE checksum and sequence number would have to be
+		 * recomputed for each output packet.
+		 */
+		gre_hdr = rte_pktmbuf_mtod_offset(pkt, struct gre_hdr *,
+				tunnel_offset);
+		if (unlikely(gre_hdr->c || gre_hdr->s))
+			return -ENOTSUP;
+	}
+
+	/* Leave IP fragments and packets without payload untouched */
+	outer_ipv4_hdr = rte_pktmbuf_mtod_offset(pkt, struct ipv4_hdr *,
+			outer_l3_offset);
+	ipv4_hdr = rte_pktmbuf_mtod_offset(pkt, struct ipv4_hdr *,
+			l3_offset);
+	if (unlikely(ipv4_hdr->next_proto_id != IPPROTO_TCP ||
+			IS_FRAGMENTED(outer_ipv4_hdr->fragment_offset) ||
+			IS_FRAGMENTED(ipv4_hdr->fragment_offset) ||
+			pkt->pkt_len <= hdr_len)) {
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	ret = gso_do_segment(pkt, hdr_len, gso_size - hdr_len,
+			direct_pool, indirect_pool, pkts_out, nb_pkts_out);
+	if (ret <= 0)
+		return ret;
+
+	/* Inner headers first, as the outer lengths depend on them */
+	gso_update_tcp4_segments(pkts_out, ret, l3_offset, pkt->l3_len,
+			pkt->l4_len, ipid_delta);
+
+	outer_id = rte_be_to_cpu_16(outer_ipv4_hdr->packet_id);
+	sw_outer_ip_cksum = !(pkt->ol_flags & PKT_TX_OUTER_IP_CKSUM);
+	for (i = 0; i < ret; i++) {
+		if (vxlan) {
+			udp_hdr = rte_pktmbuf_mtod_offset(pkts_out[i],
+					struct udp_hdr *, tunnel_offset);
+			udp_hdr->dgram_len = rte_cpu_to_be_16(
+					pkts_out[i]->pkt_len - tunnel_offset);
+			udp_hdr->dgram_cksum = 0;
+		}
+		gso_update_ipv4_header(pkts_out[i], outer_l3_offset,
+				pkt->outer_l3_len, outer_id,
+				sw_outer_ip_cksum);
+		outer_id += ipid_delta;
+	}
+
+	return ret;
+}
@@ -0,0 +1,102 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <errno.h>
+
+#include <rte_ethdev.h>
+
+#include "rte_gso.h"
+#include "gso_common.h"
+#include "gso_tcp4.h"
+#include "gso_tunnel_tcp4.h"
+
+#define IS_IPV4_TCP(flag) (((flag) & (PKT_TX_TCP_SEG | PKT_TX_IPV4 | \
+		PKT_TX_TUNNEL_MASK)) == (PKT_TX_TCP_SEG | PKT_TX_IPV4))
+
+#define IS_IPV4_TUNNEL_TCP4(flag, tunnel) (((flag) & (PKT_TX_TCP_SEG | \
+		PKT_TX_IPV4 | PKT_TX_OUTER_IPV4 | PKT_TX_TUNNEL_MASK)) == \
+		(PKT_TX_TCP_SEG | PKT_TX_IPV4 | PKT_TX_OUTER_IPV4 | (tunnel)))
+
+#define GSO_SUPPORTED_TYPES (DEV_TX_OFFLOAD_TCP_TSO | \
+		DEV_TX_OFFLOAD_VXLAN_TNL_TSO | DEV_TX_OFFLOAD_GRE_TNL_TSO)
+
+int
+rte_gso_segment(struct rte_mbuf *pkt,
+		const struct rte_gso_ctx *ctx,
+		struct rte_mbuf **pkts_out,
+		uint16_t nb_pkts_out)
+{
+	uint64_t ol_flags;
+	uint16_t ipid_delta;
+	int ret;
+
+	if (pkt == NULL || ctx == NULL || pkts_out == NULL ||
+			nb_pkts_out == 0 ||
+			ctx->direct_pool == NULL || ctx->indirect_pool == NULL ||
+			ctx->gso_size < RTE_GSO_SEG_SIZE_MIN ||
+			(ctx->gso_types & GSO_SUPPORTED_TYPES) == 0)
+		return -EINVAL;
+
+	ol_flags = pkt->ol_flags;
+	if (pkt->pkt_len <= ctx->gso_size || !(ol_flags & PKT_TX_TCP_SEG)) {
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	ipid_delta = (ctx->flag & RTE_GSO_FLAG_IPID_FIXED) ? 0 : 1;
+
+	if ((IS_IPV4_TUNNEL_TCP4(ol_flags, PKT_TX_TUNNEL_VXLAN) &&
+			(ctx->gso_types & DEV_TX_OFFLOAD_VXLAN_TNL_TSO)) ||
+			(IS_IPV4_TUNNEL_TCP4(ol_flags, PKT_TX_TUNNEL_GRE) &&
+			(ctx->gso_types & DEV_TX_OFFLOAD_GRE_TNL_TSO)))
+		ret = gso_tunnel_tcp4_segment(pkt, ctx->gso_size, ipid_delta,
+				ctx->direct_pool, ctx->indirect_pool,
+				pkts_out, nb_pkts_out);
+	else if (IS_IPV4_TCP(ol_flags) &&
+			(ctx->gso_types & DEV_TX_OFFLOAD_TCP_TSO))
+		ret = gso_tcp4_segment(pkt, ctx->gso_size, ipid_delta,
+				ctx->direct_pool, ctx->indirect_pool,
+				pkts_out, nb_pkts_out);
+	else {
+		/* Unsupported packet type: let the NIC deal with it */
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	/* The output packets keep references to the input payload */
+	if (ret > 0 && pkts_out[0] != pkt)
+		rte_pktmbuf_free(pkt);
+
+	return ret;
+}
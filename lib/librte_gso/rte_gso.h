@@ -0,0 +1,147 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _RTE_GSO_H_
+#define _RTE_GSO_H_
+
+/**
+ * @file
+ * Interface to GSO library
+ *
+ * Generic Segmentation Offload (GSO) segments in software the large TCP
+ * packets that the application would otherwise hand over to the NIC for
+ * TCP segmentation offload (TSO). The supported packet types are:
+ *
+ *  - TCP/IPv4;
+ *  - VxLAN-encapsulated TCP/IPv4 (outer IPv4);
+ *  - GRE-encapsulated TCP/IPv4 (outer IPv4).
+ *
+ * The payload of the input packet is never copied: each output packet is
+ * made of a direct mbuf holding a copy of the packet headers, chained to
+ * indirect mbufs attached to the payload of the input packet. The IP ID,
+ * TCP sequence number, lengths and checksums of every output packet are
+ * fixed in the copied headers.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+
+/** Minimum GSO segment size: at least one byte of TCP payload. */
+#define RTE_GSO_SEG_SIZE_MIN (sizeof(struct ether_hdr) + \
+		sizeof(struct ipv4_hdr) + sizeof(struct tcp_hdr) + 1)
+
+/**
+ * GSO flag: use a fixed IP ID for all the output packets instead of
+ * incrementing it for each of them.
+ */
+#define RTE_GSO_FLAG_IPID_FIXED (1ULL << 0)
+
+/**
+ * GSO context. It is typically set up once per lcore and reused for
+ * every packet segmented by this lcore.
+ */
+struct rte_gso_ctx {
+	/** Mempool to allocate the direct mbufs holding the packet headers */
+	struct rte_mempool *direct_pool;
+	/** Mempool to allocate the indirect mbufs holding the payload */
+	struct rte_mempool *indirect_pool;
+	/** GSO flags (RTE_GSO_FLAG_*) */
+	uint64_t flag;
+	/**
+	 * Packet types to segment, as a combination of DEV_TX_OFFLOAD_TCP_TSO,
+	 * DEV_TX_OFFLOAD_VXLAN_TNL_TSO and DEV_TX_OFFLOAD_GRE_TNL_TSO.
+	 */
+	uint32_t gso_types;
+	/**
+	 * Maximum size of an output packet, including the packet headers
+	 * and excluding the Ethernet FCS.
+	 */
+	uint16_t gso_size;
+};
+
+/**
+ * Segment a packet.
+ *
+ * The packet is segmented when its ol_flags request TCP segmentation
+ * (PKT_TX_TCP_SEG), its type is enabled in the GSO context and its length
+ * is larger than the GSO segment size. The header lengths (l2_len, l3_len,
+ * l4_len and, for tunnel packets, outer_l2_len and outer_l3_len) and the
+ * PKT_TX_IPV4, PKT_TX_OUTER_IPV4 and PKT_TX_TUNNEL_* flags must be set,
+ * and all the packet headers must be in the first mbuf segment. For tunnel
+ * packets, l2_len covers the tunnel header and the inner Ethernet header.
+ *
+ * The checksums are computed in software, except the ones that are still
+ * requested from the NIC by PKT_TX_IP_CKSUM, PKT_TX_OUTER_IP_CKSUM or
+ * PKT_TX_TCP_CKSUM in the ol_flags of the input packet, which are kept
+ * in the ol_flags of the output packets. The PKT_TX_TCP_SEG flag is
+ * cleared in the output packets.
+ *
+ * When the packet is segmented, the input packet is released (its
+ * payload stays referenced by the output packets until they are freed).
+ * When the packet does not need segmentation, it is returned unchanged as
+ * the only output packet.
+ *
+ * @param pkt
+ *   The packet mbuf to segment.
+ * @param ctx
+ *   GSO context.
+ * @param pkts_out
+ *   Array to store the output packets.
+ * @param nb_pkts_out
+ *   Size of the pkts_out array.
+ * @return
+ *   - The number of output packets (at least 1) on success.
+ *   - -EINVAL for invalid parameters, including a pkts_out array too small
+ *     to hold all the output packets.
+ *   - -ENOMEM when mbufs could not be allocated.
+ *   - -ENOTSUP for a GRE header with checksum or sequence number.
+ *   On error, the input packet is left untouched.
+ */
+int rte_gso_segment(struct rte_mbuf *pkt,
+		const struct rte_gso_ctx *ctx,
+		struct rte_mbuf **pkts_out,
+		uint16_t nb_pkts_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_GSO_H_ */
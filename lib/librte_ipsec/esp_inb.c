@@ -0,0 +1,257 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_byteorder.h>
+#include <rte_mbuf.h>
+#include <rte_crypto.h>
+
+#include "sa.h"
+#include "ipsec_sqn.h"
+
+/*
+ * Check an ESP packet against the SA and fill its symmetric operation.
+ */
+static inline int
+inb_cop_prepare(struct rte_crypto_op *cop, const struct rte_ipsec_sa *sa,
+	struct rte_mbuf *mb)
+{
+	struct rte_crypto_sym_op *sop;
+	struct ipsec_cop_priv *priv;
+	struct rte_mbuf *ml;
+	struct esp_hdr *esp;
+	uint8_t *ph, *iv, np;
+	uint32_t hlen, plen;
+	int ipv4, l3;
+
+	l3 = ipsec_l3_len(mb, &ipv4);
+	if (unlikely(l3 < 0))
+		return -EINVAL;
+	hlen = l3;
+
+	/* headers and IV must be contiguous */
+	if (unlikely(mb->data_len < hlen + sizeof(*esp) + sa->iv_len))
+		return -EINVAL;
+
+	ph = rte_pktmbuf_mtod(mb, uint8_t *);
+	np = ipv4 ? ((struct ipv4_hdr *)ph)->next_proto_id :
+		((struct ipv6_hdr *)ph)->proto;
+	esp = (struct esp_hdr *)(ph + hlen);
+	if (unlikely(np != IPPROTO_ESP || esp->spi != sa->spi))
+		return -EINVAL;
+
+	if (unlikely(mb->pkt_len < hlen + sizeof(*esp) + sa->iv_len +
+			sa->icv_len + sizeof(struct esp_tail)))
+		return -EINVAL;
+	plen = mb->pkt_len - hlen - sizeof(*esp) - sa->iv_len - sa->icv_len;
+	if (unlikely((plen & (sa->pad_align - 1)) != 0))
+		return -EINVAL;
+
+	ml = rte_pktmbuf_lastseg(mb);
+	if (unlikely(ml->data_len < sa->icv_len))
+		return -EINVAL;
+
+	if (unlikely(replay_check(sa, rte_be_to_cpu_32(esp->seq)) != 0))
+		return -EACCES;
+
+	sop = cop->sym;
+	priv = ipsec_cop_priv(cop);
+
+	rte_crypto_op_attach_sym_session(cop, sa->session);
+	sop->m_src = mb;
+	sop->m_dst = NULL;
+
+	sop->cipher.data.offset = hlen + sizeof(*esp) + sa->iv_len;
+	sop->cipher.data.length = plen;
+
+	iv = (uint8_t *)(esp + 1);
+	switch (sa->algo_type) {
+	case IPSEC_ALGO_NULL:
+		sop->cipher.iv.data = NULL;
+		sop->cipher.iv.phys_addr = 0;
+		sop->cipher.iv.length = 0;
+		break;
+	case IPSEC_ALGO_AES_CBC:
+		sop->cipher.iv.data = iv;
+		sop->cipher.iv.phys_addr = rte_pktmbuf_mtophys_offset(mb,
+			hlen + sizeof(*esp));
+		sop->cipher.iv.length = sa->iv_len;
+		break;
+	case IPSEC_ALGO_AES_CTR:
+		priv->iv.ctr.nonce = sa->salt;
+		memcpy(&priv->iv.ctr.iv, iv, sizeof(priv->iv.ctr.iv));
+		priv->iv.ctr.cnt = rte_cpu_to_be_32(1);
+		sop->cipher.iv.data = (uint8_t *)&priv->iv.ctr;
+		sop->cipher.iv.phys_addr = ipsec_cop_priv_phys(cop,
+			&priv->iv.ctr);
+		sop->cipher.iv.length = sizeof(priv->iv.ctr);
+		break;
+	case IPSEC_ALGO_AES_GCM:
+		priv->iv.gcm.salt = sa->salt;
+		memcpy(&priv->iv.gcm.iv, iv, sizeof(priv->iv.gcm.iv));
+		sop->cipher.iv.data = (uint8_t *)&priv->iv.gcm;
+		sop->cipher.iv.phys_addr = ipsec_cop_priv_phys(cop,
+			&priv->iv.gcm);
+		sop->cipher.iv.length = sizeof(priv->iv.gcm);
+
+		memcpy(priv->aad, esp, sizeof(priv->aad));
+		sop->auth.aad.data = priv->aad;
+		sop->auth.aad.phys_addr = ipsec_cop_priv_phys(cop, priv->aad);
+		sop->auth.aad.length = sizeof(priv->aad);
+		break;
+	}
+
+	sop->auth.data.offset = hlen;
+	sop->auth.data.length = sizeof(*esp) + sa->iv_len + plen;
+
+	sop->auth.digest.data = rte_pktmbuf_mtod_offset(ml, uint8_t *,
+		ml->data_len - sa->icv_len);
+	sop->auth.digest.phys_addr = rte_pktmbuf_mtophys_offset(ml,
+		ml->data_len - sa->icv_len);
+	sop->auth.digest.length = sa->icv_len;
+
+	return 0;
+}
+
+/*
+ * Record the sequence number of an authenticated packet, check its padding
+ * and remove its ESP encapsulation.
+ */
+static inline int
+inb_pkt_process(struct rte_ipsec_sa *sa, struct rte_mbuf *mb)
+{
+	struct rte_mbuf *ml;
+	struct esp_hdr *esp;
+	struct esp_tail *espt;
+	uint8_t *ph, *pd;
+	uint32_t i, hlen, plen, tlen, ins;
+	int ipv4, l3;
+
+	/* headers were checked at prepare time */
+	l3 = ipsec_l3_len(mb, &ipv4);
+	hlen = l3;
+	ph = rte_pktmbuf_mtod(mb, uint8_t *);
+	esp = (struct esp_hdr *)(ph + hlen);
+
+	if (unlikely(replay_update(sa, rte_be_to_cpu_32(esp->seq)) != 0))
+		return -EACCES;
+
+	ml = rte_pktmbuf_lastseg(mb);
+	if (unlikely(ml->data_len < sa->icv_len + sizeof(*espt)))
+		return -EINVAL;
+	espt = rte_pktmbuf_mtod_offset(ml, struct esp_tail *,
+		ml->data_len - sa->icv_len - sizeof(*espt));
+
+	/* the padding must be in the last segment */
+	plen = mb->pkt_len - hlen - sizeof(*esp) - sa->iv_len - sa->icv_len;
+	tlen = espt->pad_len + sizeof(*espt) + sa->icv_len;
+	if (unlikely(espt->pad_len + sizeof(*espt) > plen ||
+			ml->data_len < tlen))
+		return -EINVAL;
+
+	/* default sequential padding */
+	pd = (uint8_t *)espt - espt->pad_len;
+	for (i = 0; i != espt->pad_len; i++) {
+		if (unlikely(pd[i] != i + 1))
+			return -EINVAL;
+	}
+
+	ins = sizeof(*esp) + sa->iv_len;
+	if (sa->mode == RTE_IPSEC_SA_MODE_TRANSPORT) {
+		memmove(ph + ins, ph, hlen);
+		ipsec_l3_update(ph + ins, ipv4, espt->next_proto,
+			mb->pkt_len - ins - tlen);
+		rte_pktmbuf_adj(mb, ins);
+	} else
+		rte_pktmbuf_adj(mb, hlen + ins);
+
+	rte_pktmbuf_trim(mb, tlen);
+
+	return 0;
+}
+
+uint16_t
+esp_inb_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+	struct rte_crypto_op *cop[], uint16_t num)
+{
+	uint16_t i, k, n;
+	uint8_t bad[num];
+	int rc;
+
+	for (i = 0, k = 0; i != num; i++) {
+		rc = inb_cop_prepare(cop[k], sa, mb[i]);
+		bad[i] = (rc != 0);
+		if (unlikely(rc != 0))
+			rte_errno = -rc;
+		else
+			k++;
+	}
+
+	n = num - k;
+	if (unlikely(n != 0))
+		ipsec_move_bad_mbufs(mb, num, bad, n);
+
+	return k;
+}
+
+uint16_t
+esp_inb_process(struct rte_ipsec_sa *sa, struct rte_crypto_op *cop[],
+	struct rte_mbuf *mb[], uint16_t num)
+{
+	uint16_t i, k, n;
+	uint8_t bad[num];
+	int rc;
+
+	for (i = 0, k = 0; i != num; i++) {
+		mb[i] = cop[i]->sym->m_src;
+		if (unlikely(cop[i]->status != RTE_CRYPTO_OP_STATUS_SUCCESS))
+			rc = -EBADMSG;
+		else
+			rc = inb_pkt_process(sa, mb[i]);
+		bad[i] = (rc != 0);
+		if (unlikely(rc != 0))
+			rte_errno = -rc;
+		else
+			k++;
+	}
+
+	n = num - k;
+	if (unlikely(n != 0))
+		ipsec_move_bad_mbufs(mb, num, bad, n);
+
+	return k;
+}
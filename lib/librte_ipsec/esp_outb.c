@@ -0,0 +1,270 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_byteorder.h>
+#include <rte_memcpy.h>
+#include <rte_mbuf.h>
+#include <rte_crypto.h>
+
+#include "sa.h"
+
+/* location of the ICV and lengths of an encapsulated packet */
+struct outb_pkt {
+	uint8_t *icv;
+	phys_addr_t icv_phys;
+	uint32_t hlen; /* offset of the ESP header */
+	uint32_t clen; /* padded payload, with the ESP trailer */
+};
+
+/*
+ * Encapsulate a packet in ESP: insert the (outer IP and) ESP header and the
+ * IV, append the padding, the ESP trailer and the room for the ICV.
+ * Nothing is modified when an error is returned.
+ */
+static inline int
+outb_pkt_prepare(const struct rte_ipsec_sa *sa, struct rte_mbuf *mb,
+	uint64_t sqn, struct outb_pkt *op)
+{
+	struct rte_mbuf *ml;
+	struct esp_hdr *esp;
+	struct esp_tail *espt;
+	uint8_t *ph, *pt, np;
+	uint32_t i, l3len, hlen, plen, clen, pdlen, ins, tlen, len;
+	int ipv4, l3;
+
+	if (sa->mode == RTE_IPSEC_SA_MODE_TUNNEL) {
+		if (ipsec_l3_len(mb, &ipv4) < 0)
+			return -EINVAL;
+		np = ipv4 ? IPPROTO_IPIP : IPPROTO_IPV6;
+		l3len = 0;
+		hlen = sa->hdr_len;
+		ipv4 = sa->hdr_ipv4;
+	} else {
+		l3 = ipsec_l3_len(mb, &ipv4);
+		if (l3 < 0 || (uint32_t)l3 > mb->data_len)
+			return -EINVAL;
+		ph = rte_pktmbuf_mtod(mb, uint8_t *);
+		np = ipv4 ? ((struct ipv4_hdr *)ph)->next_proto_id :
+			((struct ipv6_hdr *)ph)->proto;
+		l3len = l3;
+		hlen = l3;
+	}
+
+	/* payload padded so that the ESP trailer ends on pad_align */
+	plen = mb->pkt_len - l3len;
+	clen = RTE_ALIGN_CEIL(plen + sizeof(*espt), sa->pad_align);
+	pdlen = clen - plen;
+
+	ins = hlen - l3len + sizeof(*esp) + sa->iv_len;
+	tlen = pdlen + sa->icv_len;
+	len = mb->pkt_len + ins + tlen;
+
+	ml = rte_pktmbuf_lastseg(mb);
+	if (unlikely(rte_pktmbuf_headroom(mb) < ins ||
+			rte_pktmbuf_tailroom(ml) < tlen))
+		return -ENOSPC;
+	if (unlikely(len - (ipv4 ? 0 : sizeof(struct ipv6_hdr)) >
+			UINT16_MAX))
+		return -EMSGSIZE;
+
+	/* headers */
+	ph = (uint8_t *)rte_pktmbuf_prepend(mb, ins);
+	if (sa->mode == RTE_IPSEC_SA_MODE_TUNNEL)
+		rte_memcpy(ph, sa->hdr, hlen);
+	else
+		memmove(ph, ph + ins, l3len);
+	ipsec_l3_update(ph, ipv4, IPPROTO_ESP, len);
+
+	esp = (struct esp_hdr *)(ph + hlen);
+	esp->spi = sa->spi;
+	esp->seq = rte_cpu_to_be_32((uint32_t)sqn);
+
+	/* the IV of CTR and GCM must be unique, the sequence number is */
+	if (sa->algo_type == IPSEC_ALGO_AES_CTR ||
+			sa->algo_type == IPSEC_ALGO_AES_GCM)
+		*(uint64_t *)(esp + 1) = rte_cpu_to_be_64(sqn);
+	else
+		memset(esp + 1, 0, sa->iv_len);
+
+	/* trailer, with the default sequential padding */
+	pt = (uint8_t *)rte_pktmbuf_append(mb, tlen);
+	pdlen -= sizeof(*espt);
+	for (i = 0; i != pdlen; i++)
+		pt[i] = i + 1;
+	espt = (struct esp_tail *)(pt + pdlen);
+	espt->pad_len = pdlen;
+	espt->next_proto = np;
+
+	op->icv = (uint8_t *)(espt + 1);
+	op->icv_phys = rte_pktmbuf_mtophys_offset(ml,
+		ml->data_len - sa->icv_len);
+	op->hlen = hlen;
+	op->clen = clen;
+
+	return 0;
+}
+
+/* fill the symmetric operation of an encapsulated packet */
+static inline void
+outb_cop_prepare(struct rte_crypto_op *cop, const struct rte_ipsec_sa *sa,
+	struct rte_mbuf *mb, uint64_t sqn, const struct outb_pkt *op)
+{
+	struct rte_crypto_sym_op *sop;
+	struct ipsec_cop_priv *priv;
+	struct esp_hdr *esp;
+
+	sop = cop->sym;
+	priv = ipsec_cop_priv(cop);
+
+	rte_crypto_op_attach_sym_session(cop, sa->session);
+	sop->m_src = mb;
+	sop->m_dst = NULL;
+
+	/*
+	 * NULL and AES-CBC: the zeroed IV field of the packet is encrypted
+	 * with the cipher data, so that its ciphertext, the encryption of
+	 * a unique counter block, becomes the IV sent to the peer.
+	 */
+	sop->cipher.data.offset = op->hlen + sizeof(*esp) + sa->iv_len -
+		sa->ctp_len;
+	sop->cipher.data.length = op->clen + sa->ctp_len;
+
+	switch (sa->algo_type) {
+	case IPSEC_ALGO_NULL:
+		sop->cipher.iv.data = NULL;
+		sop->cipher.iv.phys_addr = 0;
+		sop->cipher.iv.length = 0;
+		break;
+	case IPSEC_ALGO_AES_CBC:
+	case IPSEC_ALGO_AES_CTR:
+		priv->iv.ctr.nonce = sa->salt;
+		priv->iv.ctr.iv = rte_cpu_to_be_64(sqn);
+		priv->iv.ctr.cnt = rte_cpu_to_be_32(1);
+		sop->cipher.iv.data = (uint8_t *)&priv->iv.ctr;
+		sop->cipher.iv.phys_addr = ipsec_cop_priv_phys(cop,
+			&priv->iv.ctr);
+		sop->cipher.iv.length = sizeof(priv->iv.ctr);
+		break;
+	case IPSEC_ALGO_AES_GCM:
+		priv->iv.gcm.salt = sa->salt;
+		priv->iv.gcm.iv = rte_cpu_to_be_64(sqn);
+		sop->cipher.iv.data = (uint8_t *)&priv->iv.gcm;
+		sop->cipher.iv.phys_addr = ipsec_cop_priv_phys(cop,
+			&priv->iv.gcm);
+		sop->cipher.iv.length = sizeof(priv->iv.gcm);
+
+		esp = rte_pktmbuf_mtod_offset(mb, struct esp_hdr *, op->hlen);
+		memcpy(priv->aad, esp, sizeof(priv->aad));
+		sop->auth.aad.data = priv->aad;
+		sop->auth.aad.phys_addr = ipsec_cop_priv_phys(cop, priv->aad);
+		sop->auth.aad.length = sizeof(priv->aad);
+		break;
+	}
+
+	/* the ICV covers the ESP header, the IV and the cipher data */
+	sop->auth.data.offset = op->hlen;
+	sop->auth.data.length = sizeof(*esp) + sa->iv_len + op->clen;
+
+	sop->auth.digest.data = op->icv;
+	sop->auth.digest.phys_addr = op->icv_phys;
+	sop->auth.digest.length = sa->icv_len;
+}
+
+uint16_t
+esp_outb_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+	struct rte_crypto_op *cop[], uint16_t num)
+{
+	struct outb_pkt op;
+	uint64_t sqn;
+	uint16_t i, k, n;
+	uint8_t bad[num];
+	int rc;
+
+	sqn = sa->sqn;
+
+	for (i = 0, k = 0; i != num; i++) {
+		bad[i] = 1;
+
+		/* no sequence number rollover */
+		if (unlikely(sqn == IPSEC_SQN_MAX)) {
+			rte_errno = ERANGE;
+			continue;
+		}
+
+		rc = outb_pkt_prepare(sa, mb[i], sqn + 1, &op);
+		if (unlikely(rc != 0)) {
+			rte_errno = -rc;
+			continue;
+		}
+
+		sqn++;
+		outb_cop_prepare(cop[k], sa, mb[i], sqn, &op);
+		bad[i] = 0;
+		k++;
+	}
+
+	sa->sqn = sqn;
+
+	n = num - k;
+	if (unlikely(n != 0))
+		ipsec_move_bad_mbufs(mb, num, bad, n);
+
+	return k;
+}
+
+uint16_t
+esp_outb_process(struct rte_ipsec_sa *sa __rte_unused,
+	struct rte_crypto_op *cop[], struct rte_mbuf *mb[], uint16_t num)
+{
+	uint16_t i, k, n;
+	uint8_t bad[num];
+
+	for (i = 0, k = 0; i != num; i++) {
+		mb[i] = cop[i]->sym->m_src;
+		bad[i] = (cop[i]->status != RTE_CRYPTO_OP_STATUS_SUCCESS);
+		k += !bad[i];
+	}
+
+	n = num - k;
+	if (unlikely(n != 0)) {
+		rte_errno = EBADMSG;
+		ipsec_move_bad_mbufs(mb, num, bad, n);
+	}
+
+	return k;
+}
@@ -0,0 +1,130 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _IPSEC_SQN_H_
+#define _IPSEC_SQN_H_
+
+/*
+ * Anti-replay window (RFC 4303, section 3.4.3).
+ *
+ * The window is a bitmap of 64-bit buckets indexed by the sequence number,
+ * used as a ring: the bucket of a sequence number is (sqn / 64) modulo the
+ * number of buckets. One more bucket than needed for the window size is
+ * allocated so that, when the window slides, the buckets that leave it can
+ * be cleared as a whole without losing the bits of the ones still in it.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <rte_common.h>
+
+#include "sa.h"
+
+#define WINDOW_BUCKET_BITS	6 /* uint64_t */
+#define WINDOW_BUCKET_SIZE	(1 << WINDOW_BUCKET_BITS)
+#define WINDOW_BIT_LOC_MASK	(WINDOW_BUCKET_SIZE - 1)
+
+/* number of buckets for a window size, a power of two */
+static inline uint32_t
+replay_num_bucket(uint32_t wsz)
+{
+	return rte_align32pow2(RTE_ALIGN_CEIL(wsz, WINDOW_BUCKET_SIZE) /
+		WINDOW_BUCKET_SIZE + 1);
+}
+
+/* check a sequence number against the window, before authentication */
+static inline int
+replay_check(const struct rte_ipsec_sa *sa, uint64_t sqn)
+{
+	uint32_t bit, bucket;
+
+	/* sequence number 0 is never sent */
+	if (unlikely(sqn == 0))
+		return -EINVAL;
+
+	/* anti-replay disabled */
+	if (sa->replay.win_sz == 0)
+		return 0;
+
+	/* right of the window */
+	if (sqn > sa->sqn)
+		return 0;
+
+	/* left of the window */
+	if (sqn + sa->replay.win_sz <= sa->sqn)
+		return -EINVAL;
+
+	/* in the window: already received? */
+	bit = sqn & WINDOW_BIT_LOC_MASK;
+	bucket = (sqn >> WINDOW_BUCKET_BITS) & sa->replay.bucket_index_mask;
+
+	return (sa->window[bucket] & ((uint64_t)1 << bit)) ? -EINVAL : 0;
+}
+
+/* record an authenticated sequence number in the window */
+static inline int
+replay_update(struct rte_ipsec_sa *sa, uint64_t sqn)
+{
+	uint64_t bucket, last_bucket;
+	uint32_t bit, i, n;
+
+	/* the window may have moved since the packet was checked */
+	if (replay_check(sa, sqn) != 0)
+		return -EINVAL;
+
+	if (sa->replay.win_sz == 0) {
+		sa->sqn = RTE_MAX(sa->sqn, sqn);
+		return 0;
+	}
+
+	bucket = sqn >> WINDOW_BUCKET_BITS;
+
+	/* slide the window, clearing the buckets that enter it */
+	if (sqn > sa->sqn) {
+		last_bucket = sa->sqn >> WINDOW_BUCKET_BITS;
+		n = RTE_MIN(bucket - last_bucket,
+			(uint64_t)sa->replay.nb_bucket);
+		for (i = 0; i != n; i++)
+			sa->window[(last_bucket + i + 1) &
+				sa->replay.bucket_index_mask] = 0;
+		sa->sqn = sqn;
+	}
+
+	bit = sqn & WINDOW_BIT_LOC_MASK;
+	sa->window[bucket & sa->replay.bucket_index_mask] |=
+		(uint64_t)1 << bit;
+
+	return 0;
+}
+
+#endif /* _IPSEC_SQN_H_ */
@@ -0,0 +1,270 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_IPSEC_H_
+#define _RTE_IPSEC_H_
+
+/**
+ * @file
+ * Interface to IPsec library
+ *
+ * The IPsec library processes the ESP packets of a Security Association
+ * (SA) around the symmetric crypto operations of a cryptodev: it owns the
+ * SA state (sequence number and anti-replay window), prepares the crypto
+ * operations for a burst of packets, and once they are processed by the
+ * crypto device, completes the ESP encapsulation or decapsulation of the
+ * burst. Both transport and tunnel (IPv4 or IPv6 outer header) modes are
+ * supported.
+ *
+ * A typical outbound (or inbound) data path is:
+ *
+ *  - rte_ipsec_crypto_prepare() on a burst of packets of one SA;
+ *  - rte_cryptodev_enqueue_burst() of the prepared crypto operations;
+ *  - rte_cryptodev_dequeue_burst() of the processed crypto operations;
+ *  - rte_ipsec_process() on the dequeued crypto operations of the SA.
+ *
+ * The packets must start with their IP header (no L2 header) and the ESP
+ * trailer of the inbound packets must be in their last mbuf segment.
+ * IPv6 extension headers are not supported in transport mode, neither are
+ * the extended (64-bit) sequence numbers.
+ *
+ * The SA is not protected against concurrent accesses: all the packets of
+ * a given SA must be prepared and processed by the same lcore, or the
+ * application must serialize the calls.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <rte_mbuf.h>
+#include <rte_crypto.h>
+#include <rte_cryptodev.h>
+
+/**
+ * Size of the private data of the crypto operations used with the IPsec
+ * library, to pass as priv_size to rte_crypto_op_pool_create(). It holds
+ * the IV and the AAD of the operation.
+ */
+#define RTE_IPSEC_CRYPTO_PRIV_SIZE 32
+
+/** Maximum length of the outer IP header of a tunnel SA */
+#define RTE_IPSEC_TUN_HDR_MAX_LEN 64
+
+/** Maximum size of the anti-replay window, in packets */
+#define RTE_IPSEC_REPLAY_WIN_MAX_SZ 4096
+
+/**
+ * SA direction.
+ */
+enum rte_ipsec_sa_direction {
+	RTE_IPSEC_SA_DIR_INBOUND,  /**< decrypt and decapsulate */
+	RTE_IPSEC_SA_DIR_OUTBOUND, /**< encapsulate and encrypt */
+};
+
+/**
+ * SA mode.
+ */
+enum rte_ipsec_sa_mode {
+	RTE_IPSEC_SA_MODE_TRANSPORT, /**< ESP header inserted after IP header */
+	RTE_IPSEC_SA_MODE_TUNNEL,    /**< whole packet encapsulated */
+};
+
+/**
+ * SA parameters.
+ *
+ * The supported algorithms are the NULL, AES-CBC and AES-CTR ciphers
+ * chained with the NULL, SHA1-HMAC or SHA256-HMAC authentication, and
+ * AES-GCM. The crypto transform describes the operation of the SA
+ * direction: cipher encrypt then auth generate for an outbound SA, auth
+ * verify then cipher decrypt for an inbound SA. For AES-GCM, both
+ * transforms use RTE_CRYPTO_CIPHER_AES_GCM and RTE_CRYPTO_AUTH_AES_GCM,
+ * with an AAD length of 8.
+ */
+struct rte_ipsec_sa_prm {
+	/** Security Parameters Index, in CPU order */
+	uint32_t spi;
+	/**
+	 * Salt (nonce) of AES-CTR and AES-GCM, as it is put in the IV.
+	 * AES-CBC also uses it to generate the IVs.
+	 */
+	uint32_t salt;
+	/** SA direction */
+	enum rte_ipsec_sa_direction dir;
+	/** SA mode */
+	enum rte_ipsec_sa_mode mode;
+	/**
+	 * Anti-replay window size in packets, for an inbound SA.
+	 * 0 disables the anti-replay check.
+	 */
+	uint32_t replay_win_sz;
+	/**
+	 * Tunnel mode parameters of an outbound SA. An inbound SA removes
+	 * the outer IP header found in the packet.
+	 */
+	struct {
+		/**
+		 * Template of the outer IPv4 or IPv6 header. Its length and
+		 * checksum fields are set for each packet and its next
+		 * protocol is set to ESP.
+		 */
+		const void *hdr;
+		/** Length of the outer header */
+		uint8_t hdr_len;
+	} tun;
+	/** Crypto transform chain of the session */
+	const struct rte_crypto_sym_xform *xform;
+	/** Crypto session created from the transform chain */
+	struct rte_cryptodev_sym_session *session;
+};
+
+/** IPsec SA, opaque to the application */
+struct rte_ipsec_sa;
+
+/**
+ * Get the size of the memory needed by an SA.
+ *
+ * @param prm
+ *   SA parameters.
+ * @return
+ *   - The size in bytes of the SA on success.
+ *   - -EINVAL for invalid parameters.
+ *   - -ENOTSUP for an unsupported algorithm.
+ */
+int rte_ipsec_sa_size(const struct rte_ipsec_sa_prm *prm);
+
+/**
+ * Initialize an SA in memory provided by the application.
+ *
+ * The memory must be at least rte_ipsec_sa_size() bytes and be aligned
+ * on a cache line. The outbound sequence number and the inbound
+ * anti-replay window start at zero.
+ *
+ * @param sa
+ *   SA to initialize.
+ * @param prm
+ *   SA parameters.
+ * @param size
+ *   Size of the memory pointed by sa.
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL for invalid parameters or a memory size too small.
+ *   - -ENOTSUP for an unsupported algorithm.
+ */
+int rte_ipsec_sa_init(struct rte_ipsec_sa *sa,
+		const struct rte_ipsec_sa_prm *prm, uint32_t size);
+
+/**
+ * Get the sequence number of an SA: the last sequence number used by an
+ * outbound SA, or the highest sequence number authenticated by an inbound
+ * SA.
+ *
+ * @param sa
+ *   SA.
+ * @return
+ *   The sequence number.
+ */
+uint64_t rte_ipsec_sa_sqn(const struct rte_ipsec_sa *sa);
+
+/**
+ * Prepare the crypto operations for a burst of packets of an SA.
+ *
+ * For an outbound SA, a sequence number is assigned to each packet, which
+ * is encapsulated in ESP: the ESP header (and in tunnel mode the outer IP
+ * header) is prepended, the padding, ESP trailer and room for the ICV are
+ * appended. For an inbound SA, the SPI, the length and the sequence number
+ * of each packet are checked against the SA and its anti-replay window.
+ *
+ * The crypto operations must be allocated from a pool created with a
+ * private data size of at least RTE_IPSEC_CRYPTO_PRIV_SIZE; the session of
+ * the SA is attached to them.
+ *
+ * The packets that cannot be processed are moved, in their original
+ * order, at the end of the mb array and rte_errno is set; their content
+ * is left unchanged.
+ *
+ * @param sa
+ *   SA of the packets.
+ * @param mb
+ *   Array of packets.
+ * @param cop
+ *   Array of crypto operations, filled in the order of the successfully
+ *   prepared packets.
+ * @param num
+ *   Number of packets and crypto operations.
+ * @return
+ *   The number of prepared packets and crypto operations, at the start of
+ *   the mb and cop arrays.
+ */
+uint16_t rte_ipsec_crypto_prepare(struct rte_ipsec_sa *sa,
+		struct rte_mbuf *mb[], struct rte_crypto_op *cop[],
+		uint16_t num);
+
+/**
+ * Complete the processing of a burst of packets of an SA once their crypto
+ * operations are dequeued from the crypto device.
+ *
+ * For an outbound SA, the status of the crypto operations is checked. For
+ * an inbound SA, the anti-replay window is updated with the authenticated
+ * packets, then the padding is checked and the ESP header, trailer and ICV
+ * are removed: in tunnel mode the output is the inner IP packet, in
+ * transport mode the IP header is restored with the next protocol of the
+ * ESP trailer.
+ *
+ * The packets whose crypto operation failed or that cannot be processed
+ * are stored, in their original order, at the end of the mb array and
+ * rte_errno is set. The crypto operations are not freed.
+ *
+ * @param sa
+ *   SA of the packets.
+ * @param cop
+ *   Array of crypto operations, prepared by rte_ipsec_crypto_prepare()
+ *   for this SA.
+ * @param mb
+ *   Array to store the packets of the crypto operations.
+ * @param num
+ *   Number of crypto operations.
+ * @return
+ *   The number of successfully processed packets, at the start of the mb
+ *   array.
+ */
+uint16_t rte_ipsec_process(struct rte_ipsec_sa *sa,
+		struct rte_crypto_op *cop[], struct rte_mbuf *mb[],
+		uint16_t num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_IPSEC_H_ */
@@ -0,0 +1,304 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_ip.h>
+
+#include "sa.h"
+#include "ipsec_sqn.h"
+
+/* crypto parameters of an SA, extracted from its transform chain */
+struct crypto_prm {
+	uint8_t algo_type;
+	uint16_t iv_len;
+	uint16_t icv_len;
+	uint16_t pad_align;
+};
+
+static int
+fill_crypto_prm(const struct rte_ipsec_sa_prm *prm, struct crypto_prm *cp)
+{
+	const struct rte_crypto_sym_xform *xf;
+	const struct rte_crypto_cipher_xform *cxf = NULL;
+	const struct rte_crypto_auth_xform *axf = NULL;
+	enum rte_crypto_cipher_operation cop;
+	enum rte_crypto_auth_operation aop;
+	int cipher_first = 0;
+
+	for (xf = prm->xform; xf != NULL; xf = xf->next) {
+		if (xf->type == RTE_CRYPTO_SYM_XFORM_CIPHER && cxf == NULL) {
+			cxf = &xf->cipher;
+			cipher_first = (axf == NULL);
+		} else if (xf->type == RTE_CRYPTO_SYM_XFORM_AUTH &&
+				axf == NULL)
+			axf = &xf->auth;
+		else
+			return -EINVAL;
+	}
+
+	if (cxf == NULL || axf == NULL)
+		return -EINVAL;
+
+	if (prm->dir == RTE_IPSEC_SA_DIR_OUTBOUND) {
+		cop = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+		aop = RTE_CRYPTO_AUTH_OP_GENERATE;
+	} else {
+		cop = RTE_CRYPTO_CIPHER_OP_DECRYPT;
+		aop = RTE_CRYPTO_AUTH_OP_VERIFY;
+	}
+	if (cxf->op != cop || axf->op != aop)
+		return -EINVAL;
+
+	switch (cxf->algo) {
+	case RTE_CRYPTO_CIPHER_NULL:
+		cp->algo_type = IPSEC_ALGO_NULL;
+		cp->iv_len = 0;
+		cp->pad_align = IPSEC_PAD_ALIGN;
+		break;
+	case RTE_CRYPTO_CIPHER_AES_CBC:
+		cp->algo_type = IPSEC_ALGO_AES_CBC;
+		cp->iv_len = IPSEC_AES_CBC_BLOCK;
+		cp->pad_align = IPSEC_AES_CBC_BLOCK;
+		break;
+	case RTE_CRYPTO_CIPHER_AES_CTR:
+		cp->algo_type = IPSEC_ALGO_AES_CTR;
+		cp->iv_len = IPSEC_AES_CTR_IV_LEN;
+		cp->pad_align = IPSEC_PAD_ALIGN;
+		break;
+	case RTE_CRYPTO_CIPHER_AES_GCM:
+		cp->algo_type = IPSEC_ALGO_AES_GCM;
+		cp->iv_len = IPSEC_AES_CTR_IV_LEN;
+		cp->pad_align = IPSEC_PAD_ALIGN;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	switch (axf->algo) {
+	case RTE_CRYPTO_AUTH_NULL:
+	case RTE_CRYPTO_AUTH_SHA1_HMAC:
+	case RTE_CRYPTO_AUTH_SHA256_HMAC:
+		if (cp->algo_type == IPSEC_ALGO_AES_GCM)
+			return -EINVAL;
+		/* encrypt-then-MAC */
+		if (cipher_first != (prm->dir == RTE_IPSEC_SA_DIR_OUTBOUND))
+			return -EINVAL;
+		break;
+	case RTE_CRYPTO_AUTH_AES_GCM:
+		if (cp->algo_type != IPSEC_ALGO_AES_GCM ||
+				axf->add_auth_data_length !=
+				IPSEC_AES_GCM_AAD_LEN)
+			return -EINVAL;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	if (axf->digest_length > UINT8_MAX)
+		return -EINVAL;
+	cp->icv_len = axf->digest_length;
+
+	return 0;
+}
+
+static int
+check_tun_hdr(const struct rte_ipsec_sa_prm *prm)
+{
+	const struct ipv4_hdr *ip4;
+
+	if (prm->tun.hdr == NULL ||
+			prm->tun.hdr_len > RTE_IPSEC_TUN_HDR_MAX_LEN)
+		return -EINVAL;
+
+	ip4 = prm->tun.hdr;
+	switch (ip4->version_ihl >> 4) {
+	case IPSEC_IPV4_VERSION:
+		if (prm->tun.hdr_len != (ip4->version_ihl & IPV4_HDR_IHL_MASK) *
+				IPV4_IHL_MULTIPLIER ||
+				prm->tun.hdr_len < sizeof(struct ipv4_hdr))
+			return -EINVAL;
+		return 1;
+	case IPSEC_IPV6_VERSION:
+		if (prm->tun.hdr_len != sizeof(struct ipv6_hdr))
+			return -EINVAL;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+static int
+check_prm(const struct rte_ipsec_sa_prm *prm, struct crypto_prm *cp)
+{
+	int rc;
+
+	if (prm == NULL || prm->xform == NULL || prm->session == NULL)
+		return -EINVAL;
+
+	if (prm->dir != RTE_IPSEC_SA_DIR_INBOUND &&
+			prm->dir != RTE_IPSEC_SA_DIR_OUTBOUND)
+		return -EINVAL;
+
+	if (prm->mode != RTE_IPSEC_SA_MODE_TRANSPORT &&
+			prm->mode != RTE_IPSEC_SA_MODE_TUNNEL)
+		return -EINVAL;
+
+	if (prm->dir == RTE_IPSEC_SA_DIR_INBOUND &&
+			prm->replay_win_sz > RTE_IPSEC_REPLAY_WIN_MAX_SZ)
+		return -EINVAL;
+
+	if (prm->dir == RTE_IPSEC_SA_DIR_OUTBOUND &&
+			prm->mode == RTE_IPSEC_SA_MODE_TUNNEL) {
+		rc = check_tun_hdr(prm);
+		if (rc < 0)
+			return rc;
+	}
+
+	return fill_crypto_prm(prm, cp);
+}
+
+static uint32_t
+sa_size(const struct rte_ipsec_sa_prm *prm)
+{
+	uint32_t nb_bucket = 0;
+
+	if (prm->dir == RTE_IPSEC_SA_DIR_INBOUND && prm->replay_win_sz != 0)
+		nb_bucket = replay_num_bucket(prm->replay_win_sz);
+
+	return sizeof(struct rte_ipsec_sa) + nb_bucket * sizeof(uint64_t);
+}
+
+int
+rte_ipsec_sa_size(const struct rte_ipsec_sa_prm *prm)
+{
+	struct crypto_prm cp;
+	int rc;
+
+	rc = check_prm(prm, &cp);
+	if (rc != 0)
+		return rc;
+
+	return sa_size(prm);
+}
+
+int
+rte_ipsec_sa_init(struct rte_ipsec_sa *sa, const struct rte_ipsec_sa_prm *prm,
+	uint32_t size)
+{
+	struct crypto_prm cp;
+	uint32_t sz;
+	int rc;
+
+	if (sa == NULL)
+		return -EINVAL;
+
+	rc = check_prm(prm, &cp);
+	if (rc != 0)
+		return rc;
+
+	sz = sa_size(prm);
+	if (size < sz)
+		return -EINVAL;
+
+	memset(sa, 0, sz);
+
+	sa->session = prm->session;
+	sa->spi = rte_cpu_to_be_32(prm->spi);
+	sa->salt = prm->salt;
+	sa->dir = prm->dir;
+	sa->mode = prm->mode;
+	sa->algo_type = cp.algo_type;
+	sa->iv_len = cp.iv_len;
+	sa->icv_len = cp.icv_len;
+	sa->pad_align = cp.pad_align;
+
+	/*
+	 * NULL and AES-CBC encrypt the IV field of the packet as the first
+	 * block of the cipher data, see esp_outb_prepare().
+	 */
+	if (cp.algo_type == IPSEC_ALGO_NULL ||
+			cp.algo_type == IPSEC_ALGO_AES_CBC)
+		sa->ctp_len = cp.iv_len;
+
+	if (prm->dir == RTE_IPSEC_SA_DIR_OUTBOUND) {
+		if (prm->mode == RTE_IPSEC_SA_MODE_TUNNEL) {
+			sa->hdr_ipv4 = check_tun_hdr(prm);
+			sa->hdr_len = prm->tun.hdr_len;
+			memcpy(sa->hdr, prm->tun.hdr, prm->tun.hdr_len);
+		}
+		sa->prepare = esp_outb_prepare;
+		sa->process = esp_outb_process;
+	} else {
+		if (prm->replay_win_sz != 0) {
+			sa->replay.win_sz = prm->replay_win_sz;
+			sa->replay.nb_bucket =
+				replay_num_bucket(prm->replay_win_sz);
+			sa->replay.bucket_index_mask =
+				sa->replay.nb_bucket - 1;
+		}
+		sa->prepare = esp_inb_prepare;
+		sa->process = esp_inb_process;
+	}
+
+	return 0;
+}
+
+uint64_t
+rte_ipsec_sa_sqn(const struct rte_ipsec_sa *sa)
+{
+	return sa->sqn;
+}
+
+uint16_t
+rte_ipsec_crypto_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+	struct rte_crypto_op *cop[], uint16_t num)
+{
+	if (unlikely(num == 0))
+		return 0;
+
+	return sa->prepare(sa, mb, cop, num);
+}
+
+uint16_t
+rte_ipsec_process(struct rte_ipsec_sa *sa, struct rte_crypto_op *cop[],
+	struct rte_mbuf *mb[], uint16_t num)
+{
+	if (unlikely(num == 0))
+		return 0;
+
+	return sa->process(sa, cop, mb, num);
+}
@@ -0,0 +1,221 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _SA_H_
+#define _SA_H_
+
+#include <stdint.h>
+#include <errno.h>
+#include <rte_mbuf.h>
+#include <rte_crypto.h>
+#include <rte_ip.h>
+#include <rte_esp.h>
+
+#include "rte_ipsec.h"
+
+#define IPSEC_IPV4_VERSION 4
+#define IPSEC_IPV6_VERSION 6
+
+/* ESP padding alignment when the cipher has no block constraint */
+#define IPSEC_PAD_ALIGN 4
+
+/* AES-CBC block and IV size */
+#define IPSEC_AES_CBC_BLOCK 16
+/* explicit IV size of AES-CTR and AES-GCM */
+#define IPSEC_AES_CTR_IV_LEN 8
+/* AAD of AES-GCM: SPI and sequence number */
+#define IPSEC_AES_GCM_AAD_LEN sizeof(struct esp_hdr)
+
+/* largest sequence number without extended sequence numbers */
+#define IPSEC_SQN_MAX UINT32_MAX
+
+/* algorithm families, each with its own IV and data layout */
+enum ipsec_algo_type {
+	IPSEC_ALGO_NULL,
+	IPSEC_ALGO_AES_CBC,
+	IPSEC_ALGO_AES_CTR,
+	IPSEC_ALGO_AES_GCM,
+};
+
+/* AES-CTR counter block, see RFC 3686 */
+struct aesctr_cnt_blk {
+	uint32_t nonce;
+	uint64_t iv;
+	uint32_t cnt;
+} __attribute__((__packed__));
+
+/* AES-GCM nonce, see RFC 4106 */
+struct aead_gcm_iv {
+	uint32_t salt;
+	uint64_t iv;
+} __attribute__((__packed__));
+
+/* layout of the private data of the crypto operations */
+struct ipsec_cop_priv {
+	union {
+		struct aesctr_cnt_blk ctr;
+		struct aead_gcm_iv gcm;
+	} iv;
+	uint8_t aad[IPSEC_AES_GCM_AAD_LEN];
+};
+
+typedef uint16_t (*ipsec_prepare_t)(struct rte_ipsec_sa *sa,
+	struct rte_mbuf *mb[], struct rte_crypto_op *cop[], uint16_t num);
+
+typedef uint16_t (*ipsec_process_t)(struct rte_ipsec_sa *sa,
+	struct rte_crypto_op *cop[], struct rte_mbuf *mb[], uint16_t num);
+
+struct rte_ipsec_sa {
+	/* burst functions selected for the SA direction and mode */
+	ipsec_prepare_t prepare;
+	ipsec_process_t process;
+	struct rte_cryptodev_sym_session *session;
+	uint32_t spi;       /* network order */
+	uint32_t salt;
+	uint8_t dir;        /* enum rte_ipsec_sa_direction */
+	uint8_t mode;       /* enum rte_ipsec_sa_mode */
+	uint8_t algo_type;  /* enum ipsec_algo_type */
+	uint8_t hdr_ipv4;   /* tunnel outer header is IPv4 */
+	uint16_t iv_len;    /* explicit IV in the packet */
+	uint16_t ctp_len;   /* IV part of the cipher data (NULL/CBC only) */
+	uint16_t icv_len;
+	uint16_t pad_align;
+	uint8_t hdr_len;    /* tunnel outer header */
+	/* outbound: last sequence number, inbound: highest authenticated */
+	uint64_t sqn;
+	/* anti-replay window, inbound only */
+	struct {
+		uint32_t win_sz;
+		uint32_t nb_bucket;
+		uint32_t bucket_index_mask;
+	} replay;
+	uint8_t hdr[RTE_IPSEC_TUN_HDR_MAX_LEN];
+	/* replay window bitmap, nb_bucket 64-bit buckets */
+	uint64_t window[0];
+} __rte_cache_aligned;
+
+/*
+ * Length of the IP header a packet starts with, or -EINVAL when the packet
+ * does not start with an IP header. IPv6 extension headers are not parsed.
+ */
+static inline int
+ipsec_l3_len(const struct rte_mbuf *mb, int *ipv4)
+{
+	const struct ipv4_hdr *ip4;
+
+	ip4 = rte_pktmbuf_mtod(mb, const struct ipv4_hdr *);
+	switch (ip4->version_ihl >> 4) {
+	case IPSEC_IPV4_VERSION:
+		*ipv4 = 1;
+		return (ip4->version_ihl & IPV4_HDR_IHL_MASK) *
+			IPV4_IHL_MULTIPLIER;
+	case IPSEC_IPV6_VERSION:
+		*ipv4 = 0;
+		return sizeof(struct ipv6_hdr);
+	default:
+		*ipv4 = 0;
+		return -EINVAL;
+	}
+}
+
+/* set the next protocol and the length of an IP header */
+static inline void
+ipsec_l3_update(void *l3, int ipv4, uint8_t proto, uint32_t len)
+{
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+	uint16_t cksum;
+
+	if (ipv4) {
+		ip4 = l3;
+		ip4->next_proto_id = proto;
+		ip4->total_length = rte_cpu_to_be_16(len);
+		ip4->hdr_checksum = 0;
+		/* the header may have options */
+		cksum = rte_raw_cksum(ip4, (ip4->version_ihl &
+			IPV4_HDR_IHL_MASK) * IPV4_IHL_MULTIPLIER);
+		ip4->hdr_checksum = (cksum == 0xffff) ? cksum : ~cksum;
+	} else {
+		ip6 = l3;
+		ip6->proto = proto;
+		ip6->payload_len = rte_cpu_to_be_16(len -
+			sizeof(struct ipv6_hdr));
+	}
+}
+
+/* private data of a crypto operation (after its symmetric operation) */
+static inline struct ipsec_cop_priv *
+ipsec_cop_priv(struct rte_crypto_op *cop)
+{
+	return (struct ipsec_cop_priv *)(cop->sym + 1);
+}
+
+/* physical address of a field of the private data of a crypto operation */
+static inline phys_addr_t
+ipsec_cop_priv_phys(const struct rte_crypto_op *cop, const void *p)
+{
+	return cop->phys_addr + ((uintptr_t)p - (uintptr_t)cop);
+}
+
+/*
+ * Move the bad packets, flagged in the bad array, at the end of the mb
+ * array while keeping the order of the good and of the bad packets.
+ */
+static inline void
+ipsec_move_bad_mbufs(struct rte_mbuf *mb[], uint16_t num,
+	const uint8_t bad[], uint16_t nb_bad)
+{
+	struct rte_mbuf *drb[nb_bad];
+	uint16_t i, j, k;
+
+	for (i = 0, j = 0, k = 0; i != num; i++) {
+		if (bad[i])
+			drb[k++] = mb[i];
+		else
+			mb[j++] = mb[i];
+	}
+
+	for (i = 0; i != nb_bad; i++)
+		mb[j + i] = drb[i];
+}
+
+uint16_t esp_outb_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+	struct rte_crypto_op *cop[], uint16_t num);
+uint16_t esp_outb_process(struct rte_ipsec_sa *sa, struct rte_crypto_op *cop[],
+	struct rte_mbuf *mb[], uint16_t num);
+uint16_t esp_inb_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+	struct rte_crypto_op *cop[], uint16_t num);
+uint16_t esp_inb_process(struct rte_ipsec_sa *sa, struct rte_crypto_op *cop[],
+	struct rte_mbuf *mb[], uint16_t num);
+
+#endif /* _SA_H_ */
@@ -0,0 +1,242 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+
+#include <net_crc_sse.h>
+
+#include "net_crc.h"
+
+/** VPCLMULQDQ CRC computation context structure */
+struct crc_vpclmulqdq_ctx {
+	__m512i fold_4x512;  /**< fold 4 x 64 bytes forward */
+	__m512i fold_3x512;  /**< fold 3 x 64 bytes forward */
+	__m512i fold_2x512;  /**< fold 2 x 64 bytes forward */
+	__m512i fold_1x512;  /**< fold 64 bytes forward */
+	__m512i fold_lanes;  /**< fold lanes 0-2 onto lane 3 */
+};
+
+static struct crc_vpclmulqdq_ctx crc32_eth_vpclmulqdq __rte_aligned(64);
+static struct crc_vpclmulqdq_ctx crc16_ccitt_vpclmulqdq __rte_aligned(64);
+static struct crc_vpclmulqdq_ctx crc32c_vpclmulqdq __rte_aligned(64);
+
+/**
+ * Precomputed constants, as (x^(D-32) mod P, x^(D+32) mod P) pairs,
+ * bit-reflected, for folding distances D of 2048, 1536, 1024, 512, 384,
+ * 256 and 128 bits. The 16-bit CRC is computed as a 32-bit one, so its
+ * exponents are lowered by 16.
+ */
+#define CRC_VPCLMULQDQ_NB_K 14
+
+static const uint64_t crc16_ccitt_k[CRC_VPCLMULQDQ_NB_K] = {
+	0x19208, 0x2df8, 0x156c6, 0x1959a, 0x160be, 0x1bed8,
+	0x14ff2, 0x19a3c, 0xe3a, 0x4d7a, 0x5b44, 0x7762,
+	0x189ae, 0x8e10,
+};
+
+static const uint64_t crc32_eth_k[CRC_VPCLMULQDQ_NB_K] = {
+	0x1322d1430, 0x11542778a, 0x12e958ac4, 0x1821d8bc0,
+	0x14a7fe880, 0x1e88ef372, 0x1c6e41596, 0x154442bd4,
+	0x174359406, 0x3db1ecdc, 0x15a546366, 0xf1da05aa,
+	0xccaa009e, 0x1751997d0,
+};
+
+static const uint64_t crc32c_k[CRC_VPCLMULQDQ_NB_K] = {
+	0xb9e02b86, 0xdcb17aa4, 0xab7aff2a, 0xa87ab8a8,
+	0xd3b6092, 0x6992cea2, 0x9e4addf8, 0x740eef02,
+	0x1d82c63da, 0x1c291d04, 0xba4fc28e, 0x1384aa63a,
+	0x14cd00bd6, 0xf20c0dfe,
+};
+
+static __rte_always_inline __m512i
+crc_k_broadcast(const uint64_t *k)
+{
+	return _mm512_set_epi64(k[1], k[0], k[1], k[0],
+		k[1], k[0], k[1], k[0]);
+}
+
+static void
+crc_vpclmulqdq_init(struct crc_vpclmulqdq_ctx *ctx, const uint64_t *k)
+{
+	ctx->fold_4x512 = crc_k_broadcast(&k[0]);
+	ctx->fold_3x512 = crc_k_broadcast(&k[2]);
+	ctx->fold_2x512 = crc_k_broadcast(&k[4]);
+	ctx->fold_1x512 = crc_k_broadcast(&k[6]);
+	/* lane 0 is 48 bytes before lane 3, lane 1 32 and lane 2 16 */
+	ctx->fold_lanes = _mm512_set_epi64(0, 0, k[13], k[12],
+		k[11], k[10], k[9], k[8]);
+}
+
+/**
+ * Performs one folding round on four 128-bit lanes at once
+ *
+ * @param data_block
+ *   64 byte data block
+ * @param precomp
+ *   Precomputed constants, for each lane
+ * @param fold
+ *   Current 64 byte folded data
+ *
+ * @return
+ *   New 64 byte folded data
+ */
+static __rte_always_inline __m512i
+crcr32_folding_round_512(__m512i data_block,
+		__m512i precomp,
+		__m512i fold)
+{
+	__m512i tmp0 = _mm512_clmulepi64_epi128(fold, precomp, 0x01);
+	__m512i tmp1 = _mm512_clmulepi64_epi128(fold, precomp, 0x10);
+
+	/* tmp0 ^ tmp1 ^ data_block */
+	return _mm512_ternarylogic_epi64(tmp0, tmp1, data_block, 0x96);
+}
+
+static __rte_always_inline uint32_t
+crc32_eth_calc_vpclmulqdq(
+	const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc,
+	const struct crc_vpclmulqdq_ctx *params,
+	const struct crc_pclmulqdq_ctx *params128)
+{
+	__m512i fold0, fold1, fold2, fold3;
+	__m128i fold;
+	uint32_t n;
+
+	/* short buffers are not worth the 512-bit setup */
+	if (data_len < 256)
+		return crc32_eth_calc_pclmulqdq(data, data_len, crc,
+			params128);
+
+	/* Apply CRC initial value to the first 64 bytes */
+	fold0 = _mm512_inserti32x4(_mm512_setzero_si512(),
+		_mm_cvtsi32_si128(crc), 0);
+	fold0 = _mm512_xor_si512(fold0,
+		_mm512_loadu_si512((const void *)data));
+	fold1 = _mm512_loadu_si512((const void *)&data[64]);
+	fold2 = _mm512_loadu_si512((const void *)&data[128]);
+	fold3 = _mm512_loadu_si512((const void *)&data[192]);
+
+	/* Main folding loop: four independent 64 byte accumulators */
+	for (n = 256; (n + 256) <= data_len; n += 256) {
+		fold0 = crcr32_folding_round_512(
+			_mm512_loadu_si512((const void *)&data[n]),
+			params->fold_4x512, fold0);
+		fold1 = crcr32_folding_round_512(
+			_mm512_loadu_si512((const void *)&data[n + 64]),
+			params->fold_4x512, fold1);
+		fold2 = crcr32_folding_round_512(
+			_mm512_loadu_si512((const void *)&data[n + 128]),
+			params->fold_4x512, fold2);
+		fold3 = crcr32_folding_round_512(
+			_mm512_loadu_si512((const void *)&data[n + 192]),
+			params->fold_4x512, fold3);
+	}
+
+	/* Fold the accumulators into the last one */
+	fold3 = crcr32_folding_round_512(fold3, params->fold_3x512, fold0);
+	fold3 = crcr32_folding_round_512(fold3, params->fold_2x512, fold1);
+	fold3 = crcr32_folding_round_512(fold3, params->fold_1x512, fold2);
+
+	for (; (n + 64) <= data_len; n += 64)
+		fold3 = crcr32_folding_round_512(
+			_mm512_loadu_si512((const void *)&data[n]),
+			params->fold_1x512, fold3);
+
+	/* Fold the 128-bit lanes into the last one */
+	fold0 = _mm512_xor_si512(
+		_mm512_clmulepi64_epi128(fold3, params->fold_lanes, 0x01),
+		_mm512_clmulepi64_epi128(fold3, params->fold_lanes, 0x10));
+	fold = _mm_xor_si128(_mm512_extracti32x4_epi32(fold3, 3),
+		_mm512_extracti32x4_epi32(fold0, 0));
+	fold = _mm_xor_si128(fold, _mm512_extracti32x4_epi32(fold0, 1));
+	fold = _mm_xor_si128(fold, _mm512_extracti32x4_epi32(fold0, 2));
+
+	/* Remaining 16 byte blocks and partial block, then reduction */
+	fold = crcr32_fold_remaining(data, data_len, n, fold,
+		params128->rk1_rk2);
+	fold = crcr32_reduce_128_to_64(fold, params128->rk5_rk6);
+
+	return crcr32_reduce_64_to_32(fold, params128->rk7_rk8);
+}
+
+void
+rte_net_crc_avx512_init(void)
+{
+	rte_net_crc_sse42_init();
+
+	crc_vpclmulqdq_init(&crc16_ccitt_vpclmulqdq, crc16_ccitt_k);
+	crc_vpclmulqdq_init(&crc32_eth_vpclmulqdq, crc32_eth_k);
+	crc_vpclmulqdq_init(&crc32c_vpclmulqdq, crc32c_k);
+}
+
+uint32_t
+rte_crc16_ccitt_avx512_handler(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc)
+{
+	return crc32_eth_calc_vpclmulqdq(data,
+		data_len,
+		crc,
+		&crc16_ccitt_vpclmulqdq,
+		&crc16_ccitt_pclmulqdq);
+}
+
+uint32_t
+rte_crc32_eth_avx512_handler(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc)
+{
+	return crc32_eth_calc_vpclmulqdq(data,
+		data_len,
+		crc,
+		&crc32_eth_vpclmulqdq,
+		&crc32_eth_pclmulqdq);
+}
+
+uint32_t
+rte_crc32c_avx512_handler(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc)
+{
+	return crc32_eth_calc_vpclmulqdq(data,
+		data_len,
+		crc,
+		&crc32c_vpclmulqdq,
+		&crc32c_pclmulqdq);
+}
@@ -0,0 +1,372 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _NET_CRC_NEON_H_
+#define _NET_CRC_NEON_H_
+
+#include <rte_branch_prediction.h>
+#include <rte_vect.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** PMULL CRC computation context structure */
+struct crc_pmull_ctx {
+	uint64x2_t rk1_rk2;
+	uint64x2_t rk5_rk6;
+	uint64x2_t rk7_rk8;
+};
+
+static struct crc_pmull_ctx crc32_eth_pmull __rte_aligned(16);
+static struct crc_pmull_ctx crc16_ccitt_pmull __rte_aligned(16);
+static struct crc_pmull_ctx crc32c_pmull __rte_aligned(16);
+
+/**
+ * Carry-less multiplications of 64-bit halves, named after the halves of
+ * the first and second operands, as PCLMULQDQ with immediate 0x00, 0x01
+ * and 0x10
+ */
+static __rte_always_inline uint64x2_t
+crc_vmull_lo_lo(uint64x2_t a, uint64x2_t b)
+{
+	return vreinterpretq_u64_p128(vmull_p64(
+		vgetq_lane_p64(vreinterpretq_p64_u64(a), 0),
+		vgetq_lane_p64(vreinterpretq_p64_u64(b), 0)));
+}
+
+static __rte_always_inline uint64x2_t
+crc_vmull_hi_lo(uint64x2_t a, uint64x2_t b)
+{
+	return vreinterpretq_u64_p128(vmull_p64(
+		vgetq_lane_p64(vreinterpretq_p64_u64(a), 1),
+		vgetq_lane_p64(vreinterpretq_p64_u64(b), 0)));
+}
+
+static __rte_always_inline uint64x2_t
+crc_vmull_lo_hi(uint64x2_t a, uint64x2_t b)
+{
+	return vreinterpretq_u64_p128(vmull_p64(
+		vgetq_lane_p64(vreinterpretq_p64_u64(a), 0),
+		vgetq_lane_p64(vreinterpretq_p64_u64(b), 1)));
+}
+
+/**
+ * @brief Performs one folding round
+ *
+ * Logically function operates as follows:
+ *     DATA = READ_NEXT_16BYTES();
+ *     F1 = LSB8(FOLD)
+ *     F2 = MSB8(FOLD)
+ *     T1 = CLMUL(F1, RK1)
+ *     T2 = CLMUL(F2, RK2)
+ *     FOLD = XOR(T1, T2, DATA)
+ *
+ * @param data_block
+ *   16 byte data block
+ * @param precomp
+ *   Precomputed rk1 and rk2 constants
+ * @param fold
+ *   Current 16 byte folded data
+ *
+ * @return
+ *   New 16 byte folded data
+ */
+static __rte_always_inline uint64x2_t
+crcr32_folding_round(uint64x2_t data_block,
+		uint64x2_t precomp,
+		uint64x2_t fold)
+{
+	uint64x2_t tmp0 = crc_vmull_hi_lo(fold, precomp);
+	uint64x2_t tmp1 = crc_vmull_lo_hi(fold, precomp);
+
+	return veorq_u64(tmp1, veorq_u64(data_block, tmp0));
+}
+
+/**
+ * Performs reduction from 128 bits to 64 bits
+ *
+ * @param data128
+ *   128 bits data to be reduced
+ * @param precomp
+ *   precomputed constants rk5, rk6
+ *
+ * @return
+ *  64 bits reduced data
+ */
+static __rte_always_inline uint64x2_t
+crcr32_reduce_128_to_64(uint64x2_t data128, uint64x2_t precomp)
+{
+	const uint8x16_t zero = vdupq_n_u8(0);
+	uint64x2_t tmp0, tmp1, tmp2;
+
+	/* 64b fold */
+	tmp0 = crc_vmull_lo_lo(data128, precomp);
+	tmp1 = vreinterpretq_u64_u8(vextq_u8(vreinterpretq_u8_u64(data128),
+		zero, 8));
+	tmp0 = veorq_u64(tmp0, tmp1);
+
+	/* 32b fold */
+	tmp2 = vreinterpretq_u64_u8(vextq_u8(zero,
+		vreinterpretq_u8_u64(tmp0), 12));
+	tmp1 = crc_vmull_lo_hi(tmp2, precomp);
+
+	return veorq_u64(tmp1, tmp0);
+}
+
+/**
+ * Performs Barret's reduction from 64 bits to 32 bits
+ *
+ * @param data64
+ *   64 bits data to be reduced
+ * @param precomp
+ *   rk7 precomputed constant
+ *
+ * @return
+ *   reduced 32 bits data
+ */
+static __rte_always_inline uint32_t
+crcr32_reduce_64_to_32(uint64x2_t data64, uint64x2_t precomp)
+{
+	static const uint32_t mask1[4] __rte_aligned(16) = {
+		0xffffffff, 0xffffffff, 0x00000000, 0x00000000
+	};
+
+	static const uint32_t mask2[4] __rte_aligned(16) = {
+		0x00000000, 0xffffffff, 0xffffffff, 0xffffffff
+	};
+	uint64x2_t tmp0, tmp1, tmp2;
+
+	tmp0 = vandq_u64(data64, vreinterpretq_u64_u32(vld1q_u32(mask2)));
+
+	tmp1 = crc_vmull_lo_lo(tmp0, precomp);
+	tmp1 = veorq_u64(tmp1, tmp0);
+	tmp1 = vandq_u64(tmp1, vreinterpretq_u64_u32(vld1q_u32(mask1)));
+
+	tmp2 = crc_vmull_lo_hi(tmp1, precomp);
+	tmp2 = veorq_u64(tmp2, tmp1);
+	tmp2 = veorq_u64(tmp2, tmp0);
+
+	return vgetq_lane_u32(vreinterpretq_u32_u64(tmp2), 2);
+}
+
+static const uint8_t crc_xmm_shift_tab[48] __rte_aligned(16) = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/**
+ * Shifts left 128 bit register by specified number of bytes
+ *
+ * @param reg
+ *   128 bit value
+ * @param num
+ *   number of bytes to shift left reg by (0-16)
+ *
+ * @return
+ *   reg << (num * 8)
+ */
+static __rte_always_inline uint64x2_t
+vshift_bytes_left(uint64x2_t reg, const unsigned int num)
+{
+	/* out of range indexes give zero bytes, as with _mm_shuffle_epi8 */
+	return vreinterpretq_u64_u8(vqtbl1q_u8(vreinterpretq_u8_u64(reg),
+		vld1q_u8(crc_xmm_shift_tab + 16 - num)));
+}
+
+static __rte_always_inline uint32_t
+crc32_eth_calc_pmull(
+	const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc,
+	const struct crc_pmull_ctx *params)
+{
+	uint64x2_t temp, fold, k;
+	uint32_t n;
+
+	/* Get CRC init value */
+	temp = vreinterpretq_u64_u32(vsetq_lane_u32(crc, vdupq_n_u32(0), 0));
+
+	/**
+	 * Folding all data into single 16 byte data block
+	 * Assumes: fold holds first 16 bytes of data
+	 */
+
+	if (unlikely(data_len < 32)) {
+		if (unlikely(data_len == 16)) {
+			/* 16 bytes */
+			fold = vreinterpretq_u64_u8(vld1q_u8(data));
+			fold = veorq_u64(fold, temp);
+			goto reduction_128_64;
+		}
+
+		if (unlikely(data_len < 16)) {
+			/* 0 to 15 bytes */
+			uint8_t buffer[16] __rte_aligned(16);
+
+			memset(buffer, 0, sizeof(buffer));
+			memcpy(buffer, data, data_len);
+
+			fold = vreinterpretq_u64_u8(vld1q_u8(buffer));
+			fold = veorq_u64(fold, temp);
+			if (unlikely(data_len < 4)) {
+				fold = vshift_bytes_left(fold, 8 - data_len);
+				goto barret_reduction;
+			}
+			fold = vshift_bytes_left(fold, 16 - data_len);
+			goto reduction_128_64;
+		}
+		/* 17 to 31 bytes are folded as the longer buffers */
+	}
+
+	/** At least 17 bytes in the buffer */
+	/** Apply CRC initial value */
+	fold = vreinterpretq_u64_u8(vld1q_u8(data));
+	fold = veorq_u64(fold, temp);
+
+	/** Main folding loop - the last 16 bytes is processed separately */
+	k = params->rk1_rk2;
+	for (n = 16; (n + 16) <= data_len; n += 16) {
+		temp = vreinterpretq_u64_u8(vld1q_u8(&data[n]));
+		fold = crcr32_folding_round(temp, k, fold);
+	}
+
+	if (likely(n < data_len)) {
+		static const uint8_t shf_table[32] __rte_aligned(16) = {
+			0x00, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+			0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+			0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+			0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+		};
+		uint8x16_t last16, idx, a, b, sel;
+
+		last16 = vld1q_u8(&data[data_len - 16]);
+
+		idx = vld1q_u8(&shf_table[data_len & 15]);
+		a = vqtbl1q_u8(vreinterpretq_u8_u64(fold), idx);
+
+		idx = veorq_u8(idx, vdupq_n_u8(0x80));
+		b = vqtbl1q_u8(vreinterpretq_u8_u64(fold), idx);
+		/* take the last bytes where the index has its top bit set */
+		sel = vcltq_s8(vreinterpretq_s8_u8(idx), vdupq_n_s8(0));
+		b = vbslq_u8(sel, last16, b);
+
+		/* k = rk1 & rk2 */
+		temp = crc_vmull_hi_lo(vreinterpretq_u64_u8(a), k);
+		fold = crc_vmull_lo_hi(vreinterpretq_u64_u8(a), k);
+
+		fold = veorq_u64(fold, temp);
+		fold = veorq_u64(fold, vreinterpretq_u64_u8(b));
+	}
+
+	/** Reduction 128 -> 32 Assumes: fold holds 128bit folded data */
+reduction_128_64:
+	k = params->rk5_rk6;
+	fold = crcr32_reduce_128_to_64(fold, k);
+
+barret_reduction:
+	k = params->rk7_rk8;
+	n = crcr32_reduce_64_to_32(fold, k);
+
+	return n;
+}
+
+static inline void
+crc_pmull_ctx_init(struct crc_pmull_ctx *ctx, uint64_t k1, uint64_t k2,
+	uint64_t k5, uint64_t k6, uint64_t q, uint64_t p)
+{
+	ctx->rk1_rk2 = vcombine_u64(vcreate_u64(k1), vcreate_u64(k2));
+	ctx->rk5_rk6 = vcombine_u64(vcreate_u64(k5), vcreate_u64(k6));
+	ctx->rk7_rk8 = vcombine_u64(vcreate_u64(q), vcreate_u64(p));
+}
+
+static inline void
+rte_net_crc_neon_init(void)
+{
+	/* Initialize CRC16 data */
+	crc_pmull_ctx_init(&crc16_ccitt_pmull, 0x189aeLLU, 0x8e10LLU,
+		0x189aeLLU, 0x114aaLLU, 0x11c581910LLU, 0x10811LLU);
+
+	/* Initialize CRC32 data */
+	crc_pmull_ctx_init(&crc32_eth_pmull, 0xccaa009eLLU, 0x1751997d0LLU,
+		0xccaa009eLLU, 0x163cd6124LLU, 0x1f7011640LLU,
+		0x1db710641LLU);
+
+	/* Initialize CRC32C data */
+	crc_pmull_ctx_init(&crc32c_pmull, 0x14cd00bd6LLU, 0xf20c0dfeLLU,
+		0x14cd00bd6LLU, 0xdd45aab8LLU, 0xdea713f0LLU,
+		0x105ec76f1LLU);
+}
+
+static inline uint32_t
+rte_crc16_ccitt_neon_handler(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc)
+{
+	return crc32_eth_calc_pmull(data,
+		data_len,
+		crc,
+		&crc16_ccitt_pmull);
+}
+
+static inline uint32_t
+rte_crc32_eth_neon_handler(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc)
+{
+	return crc32_eth_calc_pmull(data,
+		data_len,
+		crc,
+		&crc32_eth_pmull);
+}
+
+static inline uint32_t
+rte_crc32c_neon_handler(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc)
+{
+	return crc32_eth_calc_pmull(data,
+		data_len,
+		crc,
+		&crc32c_pmull);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NET_CRC_NEON_H_ */
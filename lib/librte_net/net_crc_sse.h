@@ -50,8 +50,9 @@ struct crc_pclmulqdq_ctx {
 	__m128i rk7_rk8;
 };
 
-struct crc_pclmulqdq_ctx crc32_eth_pclmulqdq __rte_aligned(16);
-struct crc_pclmulqdq_ctx crc16_ccitt_pclmulqdq __rte_aligned(16);
+static struct crc_pclmulqdq_ctx crc32_eth_pclmulqdq __rte_aligned(16);
+static struct crc_pclmulqdq_ctx crc16_ccitt_pclmulqdq __rte_aligned(16);
+static struct crc_pclmulqdq_ctx crc32c_pclmulqdq __rte_aligned(16);
 /**
  * @brief Performs one folding round
  *
@@ -179,6 +180,76 @@ xmm_shift_left(__m128i reg, const unsigned int num)
 	return _mm_shuffle_epi8(reg, _mm_loadu_si128(p));
 }
 
+/**
+ * Folds the data following the first n bytes, and the final partial
+ * block if any, into a 16 byte folded data
+ *
+ * @param data
+ *   Pointer to the data, at least 16 bytes long
+ * @param data_len
+ *   Data length
+ * @param n
+ *   Number of bytes already folded, at least 16
+ * @param fold
+ *   Current 16 byte folded data
+ * @param k
+ *   Precomputed rk1 and rk2 constants
+ *
+ * @return
+ *   16 byte folded data of the whole buffer
+ */
+static __rte_always_inline __m128i
+crcr32_fold_remaining(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t n,
+	__m128i fold,
+	__m128i k)
+{
+	__m128i temp;
+
+	/** Main folding loop - the last 16 bytes is processed separately */
+	for (; (n + 16) <= data_len; n += 16) {
+		temp = _mm_loadu_si128((const __m128i *)&data[n]);
+		fold = crcr32_folding_round(temp, k, fold);
+	}
+
+	if (likely(n < data_len)) {
+
+		const uint32_t mask3[4] __rte_aligned(16) = {
+			0x80808080, 0x80808080, 0x80808080, 0x80808080
+		};
+
+		const uint8_t shf_table[32] __rte_aligned(16) = {
+			0x00, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+			0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+			0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+			0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+		};
+
+		__m128i last16, a, b;
+
+		last16 = _mm_loadu_si128((const __m128i *)&data[data_len - 16]);
+
+		temp = _mm_loadu_si128((const __m128i *)
+			&shf_table[data_len & 15]);
+		a = _mm_shuffle_epi8(fold, temp);
+
+		temp = _mm_xor_si128(temp,
+			_mm_load_si128((const __m128i *)mask3));
+		b = _mm_shuffle_epi8(fold, temp);
+		b = _mm_blendv_epi8(b, last16, temp);
+
+		/* k = rk1 & rk2 */
+		temp = _mm_clmulepi64_si128(a, k, 0x01);
+		fold = _mm_clmulepi64_si128(a, k, 0x10);
+
+		fold = _mm_xor_si128(fold, temp);
+		fold = _mm_xor_si128(fold, b);
+	}
+
+	return fold;
+}
+
 static __rte_always_inline uint32_t
 crc32_eth_calc_pclmulqdq(
 	const uint8_t *data,
@@ -221,60 +292,16 @@ crc32_eth_calc_pclmulqdq(
 			fold = xmm_shift_left(fold, 16 - data_len);
 			goto reduction_128_64;
 		}
-		/* 17 to 31 bytes */
-		fold = _mm_loadu_si128((const __m128i *)data);
-		fold = _mm_xor_si128(fold, temp);
-		n = 16;
-		k = params->rk1_rk2;
-		goto partial_bytes;
+		/* 17 to 31 bytes are folded as the longer buffers */
 	}
 
-	/** At least 32 bytes in the buffer */
+	/** At least 17 bytes in the buffer */
 	/** Apply CRC initial value */
 	fold = _mm_loadu_si128((const __m128i *)data);
 	fold = _mm_xor_si128(fold, temp);
 
-	/** Main folding loop - the last 16 bytes is processed separately */
-	k = params->rk1_rk2;
-	for (n = 16; (n + 16) <= data_len; n += 16) {
-		temp = _mm_loadu_si128((const __m128i *)&data[n]);
-		fold = crcr32_folding_round(temp, k, fold);
-	}
-
-partial_bytes:
-	if (likely(n < data_len)) {
-
-		const uint32_t mask3[4] __rte_aligned(16) = {
-			0x80808080, 0x80808080, 0x80808080, 0x80808080
-		};
-
-		const uint8_t shf_table[32] __rte_aligned(16) = {
-			0x00, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
-			0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
-			0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
-			0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
-		};
-
-		__m128i last16, a, b;
-
-		last16 = _mm_loadu_si128((const __m128i *)&data[data_len - 16]);
-
-		temp = _mm_loadu_si128((const __m128i *)
-			&shf_table[data_len & 15]);
-		a = _mm_shuffle_epi8(fold, temp);
-
-		temp = _mm_xor_si128(temp,
-			_mm_load_si128((const __m128i *)mask3));
-		b = _mm_shuffle_epi8(fold, temp);
-		b = _mm_blendv_epi8(b, last16, temp);
-
-		/* k = rk1 & rk2 */
-		temp = _mm_clmulepi64_si128(a, k, 0x01);
-		fold = _mm_clmulepi64_si128(a, k, 0x10);
-
-		fold = _mm_xor_si128(fold, temp);
-		fold = _mm_xor_si128(fold, b);
-	}
+	fold = crcr32_fold_remaining(data, data_len, 16, fold,
+		params->rk1_rk2);
 
 	/** Reduction 128 -> 32 Assumes: fold holds 128bit folded data */
 reduction_128_64:
@@ -327,6 +354,22 @@ rte_net_crc_sse42_init(void)
 	crc32_eth_pclmulqdq.rk7_rk8 =
 		_mm_setr_epi64(_mm_cvtsi64_m64(q), _mm_cvtsi64_m64(p));
 
+	/** Initialize CRC32C data */
+	k1 = 0x14cd00bd6LLU;
+	k2 = 0xf20c0dfeLLU;
+	k5 = 0x14cd00bd6LLU;
+	k6 = 0xdd45aab8LLU;
+	q =  0xdea713f0LLU;
+	p =  0x105ec76f1LLU;
+
+	/** Save the params in context structure */
+	crc32c_pclmulqdq.rk1_rk2 =
+		_mm_setr_epi64(_mm_cvtsi64_m64(k1), _mm_cvtsi64_m64(k2));
+	crc32c_pclmulqdq.rk5_rk6 =
+		_mm_setr_epi64(_mm_cvtsi64_m64(k5), _mm_cvtsi64_m64(k6));
+	crc32c_pclmulqdq.rk7_rk8 =
+		_mm_setr_epi64(_mm_cvtsi64_m64(q), _mm_cvtsi64_m64(p));
+
 	/**
 	 * Reset the register as following calculation may
 	 * use other data types such as float, double, etc.
@@ -337,25 +380,37 @@ rte_net_crc_sse42_init(void)
 
 static inline uint32_t
 rte_crc16_ccitt_sse42_handler(const uint8_t *data,
-	uint32_t data_len)
+	uint32_t data_len,
+	uint32_t crc)
 {
-	/** return 16-bit CRC value */
-	return (uint16_t)~crc32_eth_calc_pclmulqdq(data,
+	return crc32_eth_calc_pclmulqdq(data,
 		data_len,
-		0xffff,
+		crc,
 		&crc16_ccitt_pclmulqdq);
 }
 
 static inline uint32_t
 rte_crc32_eth_sse42_handler(const uint8_t *data,
-	uint32_t data_len)
+	uint32_t data_len,
+	uint32_t crc)
 {
-	return ~crc32_eth_calc_pclmulqdq(data,
+	return crc32_eth_calc_pclmulqdq(data,
 		data_len,
-		0xffffffffUL,
+		crc,
 		&crc32_eth_pclmulqdq);
 }
 
+static inline uint32_t
+rte_crc32c_sse42_handler(const uint8_t *data,
+	uint32_t data_len,
+	uint32_t crc)
+{
+	return crc32_eth_calc_pclmulqdq(data,
+		data_len,
+		crc,
+		&crc32c_pclmulqdq);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #include <rte_mbuf.h>
 #include <rte_mbuf_ptype.h>
@@ -42,8 +43,19 @@
 #include <rte_udp.h>
 #include <rte_sctp.h>
 #include <rte_gre.h>
+#include <rte_prefetch.h>
 #include <rte_net.h>
 
+#if defined(RTE_MACHINE_CPUFLAG_SSE2) || defined(RTE_MACHINE_CPUFLAG_AVX2)
+#include <rte_vect.h>
+#endif
+
+/* IANA assigned UDP destination port for VXLAN */
+#define NET_VXLAN_PORT 4789
+
+/* number of packets prefetched ahead by the burst functions */
+#define NET_BURST_PREFETCH 4
+
 /* get l3 packet type from ip6 next protocol */
 static uint32_t
 ptype_l3_ip6(uint8_t ip6_proto)
@@ -363,8 +375,26 @@ uint32_t rte_net_get_ptype(const struct rte_mbuf *m,
 	}
 
 	if ((pkt_type & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_UDP) {
+		const struct udp_hdr *uh;
+		struct udp_hdr uh_copy;
+
 		hdr_lens->l4_len = sizeof(struct udp_hdr);
-		return pkt_type;
+
+		if ((layers & RTE_PTYPE_TUNNEL_MASK) == 0)
+			return pkt_type;
+
+		uh = rte_pktmbuf_read(m, off, sizeof(*uh), &uh_copy);
+		if (unlikely(uh == NULL) || uh->dst_port !=
+				rte_cpu_to_be_16(NET_VXLAN_PORT))
+			return pkt_type;
+		if (unlikely(rte_pktmbuf_pkt_len(m) <
+				off + ETHER_VXLAN_HLEN + sizeof(*eh)))
+			return pkt_type;
+
+		pkt_type |= RTE_PTYPE_TUNNEL_VXLAN;
+		off += ETHER_VXLAN_HLEN;
+		hdr_lens->tunnel_len = sizeof(struct vxlan_hdr);
+		proto = rte_cpu_to_be_16(ETHER_TYPE_TEB);
 	} else if ((pkt_type & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_TCP) {
 		const struct tcp_hdr *th;
 		struct tcp_hdr th_copy;
@@ -515,3 +545,454 @@ uint32_t rte_net_get_ptype(const struct rte_mbuf *m,
 
 	return pkt_type;
 }
+
+/* parse the common case of a non-tunneled TCP or UDP packet whose headers
+ * are all in the first segment; return 0 if the full parser is needed */
+static inline uint32_t
+ptype_fast(const struct rte_mbuf *m, struct rte_net_hdr_lens *hdr_lens,
+	uint32_t layers)
+{
+	const uint8_t *data = rte_pktmbuf_mtod(m, const uint8_t *);
+	uint32_t data_len = rte_pktmbuf_data_len(m);
+	const struct ether_hdr *eh = (const struct ether_hdr *)data;
+	uint32_t pkt_type = RTE_PTYPE_L2_ETHER;
+	uint32_t off = sizeof(*eh);
+	uint16_t proto;
+	uint8_t l4_proto;
+
+	if ((layers & (RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK |
+			RTE_PTYPE_L4_MASK)) != (RTE_PTYPE_L2_MASK |
+			RTE_PTYPE_L3_MASK | RTE_PTYPE_L4_MASK))
+		return 0;
+	if (unlikely(data_len < off))
+		return 0;
+
+	proto = eh->ether_type;
+	if (proto == rte_cpu_to_be_16(ETHER_TYPE_VLAN)) {
+		const struct vlan_hdr *vh;
+
+		if (unlikely(data_len < off + sizeof(*vh)))
+			return 0;
+		vh = (const struct vlan_hdr *)(data + off);
+		pkt_type = RTE_PTYPE_L2_ETHER_VLAN;
+		proto = vh->eth_proto;
+		off += sizeof(*vh);
+	}
+	hdr_lens->l2_len = off;
+
+	if (proto == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+		const struct ipv4_hdr *ip4h;
+		uint32_t l3_ptype;
+
+		if (unlikely(data_len < off + sizeof(*ip4h)))
+			return 0;
+		ip4h = (const struct ipv4_hdr *)(data + off);
+		l3_ptype = ptype_l3_ip(ip4h->version_ihl);
+		if (unlikely(l3_ptype == 0 || (ip4h->fragment_offset &
+				rte_cpu_to_be_16(IPV4_HDR_OFFSET_MASK |
+					IPV4_HDR_MF_FLAG))))
+			return 0;
+		pkt_type |= l3_ptype;
+		hdr_lens->l3_len = ip4_hlen(ip4h);
+		l4_proto = ip4h->next_proto_id;
+	} else if (proto == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
+		const struct ipv6_hdr *ip6h;
+
+		if (unlikely(data_len < off + sizeof(*ip6h)))
+			return 0;
+		ip6h = (const struct ipv6_hdr *)(data + off);
+		pkt_type |= RTE_PTYPE_L3_IPV6;
+		hdr_lens->l3_len = sizeof(*ip6h);
+		l4_proto = ip6h->proto;
+	} else {
+		return 0;
+	}
+	off += hdr_lens->l3_len;
+
+	if (l4_proto == IPPROTO_TCP) {
+		const struct tcp_hdr *th;
+
+		if (unlikely(data_len < off + sizeof(*th)))
+			return 0;
+		th = (const struct tcp_hdr *)(data + off);
+		hdr_lens->l4_len = (th->data_off & 0xf0) >> 2;
+		return pkt_type | RTE_PTYPE_L4_TCP;
+	} else if (l4_proto == IPPROTO_UDP) {
+		const struct udp_hdr *uh;
+
+		if (unlikely(data_len < off + sizeof(*uh)))
+			return 0;
+		uh = (const struct udp_hdr *)(data + off);
+		if ((layers & RTE_PTYPE_TUNNEL_MASK) && uh->dst_port ==
+				rte_cpu_to_be_16(NET_VXLAN_PORT))
+			return 0;
+		hdr_lens->l4_len = sizeof(*uh);
+		return pkt_type | RTE_PTYPE_L4_UDP;
+	}
+
+	return 0;
+}
+
+/* store the parsed header lengths in the mbuf, as expected by the TX
+ * offloads: for tunnels l2_len covers outer L4, tunnel and inner L2 */
+static inline void
+net_set_hdr_lens(struct rte_mbuf *m, uint32_t pkt_type,
+	const struct rte_net_hdr_lens *hdr_lens)
+{
+	if (pkt_type & RTE_PTYPE_TUNNEL_MASK) {
+		m->outer_l2_len = hdr_lens->l2_len;
+		m->outer_l3_len = hdr_lens->l3_len;
+		m->l2_len = hdr_lens->l4_len + hdr_lens->tunnel_len +
+			hdr_lens->inner_l2_len;
+		m->l3_len = hdr_lens->inner_l3_len;
+		m->l4_len = hdr_lens->inner_l4_len;
+	} else {
+		m->outer_l2_len = 0;
+		m->outer_l3_len = 0;
+		m->l2_len = hdr_lens->l2_len;
+		m->l3_len = hdr_lens->l3_len;
+		m->l4_len = hdr_lens->l4_len;
+	}
+}
+
+/* parse a burst of packets, set their packet type and header lengths */
+void
+rte_net_get_ptype_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+	uint32_t layers)
+{
+	struct rte_net_hdr_lens hdr_lens;
+	struct rte_mbuf *m;
+	uint32_t pkt_type;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts && i < NET_BURST_PREFETCH; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[i], void *));
+
+	for (i = 0; i < nb_pkts; i++) {
+		m = pkts[i];
+		if (i + NET_BURST_PREFETCH < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(
+				pkts[i + NET_BURST_PREFETCH], void *));
+
+		memset(&hdr_lens, 0, sizeof(hdr_lens));
+		pkt_type = ptype_fast(m, &hdr_lens, layers);
+		if (pkt_type == 0)
+			pkt_type = rte_net_get_ptype(m, &hdr_lens, layers);
+
+		m->packet_type = pkt_type;
+		net_set_hdr_lens(m, pkt_type, &hdr_lens);
+	}
+}
+
+/* fold a 64-bit one's complement accumulator to 16 bits */
+static inline uint16_t
+net_sum_fold(uint64_t sum)
+{
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+/* each 32-bit lane of a vector accumulator gains at most 2 * 0xffff per
+ * iteration, and up to four lanes are added together in the reduction:
+ * spill the accumulators before they can wrap */
+#define NET_SUM_SIMD_MAX_ITER 4096
+
+/* add the 16-bit words of a buffer to a one's complement accumulator,
+ * using the same word order as __rte_raw_cksum() */
+static __rte_always_inline uint64_t
+net_sum(const uint8_t *p, uint32_t len, uint64_t sum)
+{
+	uint32_t w;
+	uint16_t hw;
+
+#ifdef RTE_MACHINE_CPUFLAG_AVX2
+	while (len >= 64) {
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i acc0 = zero, acc1 = zero;
+		uint32_t lanes[4];
+		uint32_t i, n;
+
+		n = RTE_MIN(len / 64, (uint32_t)NET_SUM_SIMD_MAX_ITER);
+		for (i = 0; i < n; i++) {
+			__m256i v0 = _mm256_loadu_si256((const __m256i *)p);
+			__m256i v1 = _mm256_loadu_si256(
+				(const __m256i *)(p + 32));
+
+			acc0 = _mm256_add_epi32(acc0,
+				_mm256_unpacklo_epi16(v0, zero));
+			acc1 = _mm256_add_epi32(acc1,
+				_mm256_unpacklo_epi16(v1, zero));
+			acc0 = _mm256_add_epi32(acc0,
+				_mm256_unpackhi_epi16(v0, zero));
+			acc1 = _mm256_add_epi32(acc1,
+				_mm256_unpackhi_epi16(v1, zero));
+			p += 64;
+		}
+		len -= n * 64;
+
+		acc0 = _mm256_add_epi32(acc0, acc1);
+		_mm_storeu_si128((__m128i *)lanes, _mm_add_epi32(
+			_mm256_castsi256_si128(acc0),
+			_mm256_extracti128_si256(acc0, 1)));
+		sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+#endif
+
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+	while (len >= 32) {
+		const __m128i zero = _mm_setzero_si128();
+		__m128i acc0 = zero, acc1 = zero;
+		uint32_t lanes[4];
+		uint32_t i, n;
+
+		n = RTE_MIN(len / 32, (uint32_t)NET_SUM_SIMD_MAX_ITER);
+		for (i = 0; i < n; i++) {
+			__m128i v0 = _mm_loadu_si128((const __m128i *)p);
+			__m128i v1 = _mm_loadu_si128(
+				(const __m128i *)(p + 16));
+
+			acc0 = _mm_add_epi32(acc0,
+				_mm_unpacklo_epi16(v0, zero));
+			acc1 = _mm_add_epi32(acc1,
+				_mm_unpacklo_epi16(v1, zero));
+			acc0 = _mm_add_epi32(acc0,
+				_mm_unpackhi_epi16(v0, zero));
+			acc1 = _mm_add_epi32(acc1,
+				_mm_unpackhi_epi16(v1, zero));
+			p += 32;
+		}
+		len -= n * 32;
+
+		_mm_storeu_si128((__m128i *)lanes, _mm_add_epi32(acc0, acc1));
+		sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+#endif
+
+	/* a 32-bit word is congruent to the sum of its halves modulo
+	 * 0xffff, so the scalar path can consume 4 bytes at a time */
+	for (; len >= 4; len -= 4, p += 4) {
+		memcpy(&w, p, sizeof(w));
+		sum += w;
+	}
+	if (len >= 2) {
+		memcpy(&hw, p, sizeof(hw));
+		sum += hw;
+		len -= 2;
+		p += 2;
+	}
+	if (len == 1)
+		sum += *p;
+
+	return sum;
+}
+
+/* one's complement sum of len bytes of packet data starting at off,
+ * return -1 if the packet is too short */
+static int
+net_sum_mbuf(const struct rte_mbuf *m, uint32_t off, uint32_t len,
+	uint64_t *sum)
+{
+	uint32_t done = 0;
+	uint32_t seglen;
+	uint16_t seg_sum;
+
+	/* most packets are in a single segment */
+	if (likely(off + len <= rte_pktmbuf_data_len(m))) {
+		*sum += net_sum(rte_pktmbuf_mtod_offset(m, const uint8_t *,
+			off), len, 0);
+		return 0;
+	}
+
+	if (off + len > rte_pktmbuf_pkt_len(m))
+		return -1;
+
+	while (off >= rte_pktmbuf_data_len(m)) {
+		off -= rte_pktmbuf_data_len(m);
+		m = m->next;
+	}
+
+	while (len > 0) {
+		seglen = RTE_MIN((uint32_t)rte_pktmbuf_data_len(m) - off, len);
+		seg_sum = net_sum_fold(net_sum(
+			rte_pktmbuf_mtod_offset(m, const uint8_t *, off),
+			seglen, 0));
+		/* a segment starting at an odd offset has its bytes
+		 * swapped relative to the 16-bit words of the packet */
+		if (done & 1)
+			seg_sum = rte_bswap16(seg_sum);
+		*sum += seg_sum;
+		done += seglen;
+		len -= seglen;
+		off = 0;
+		m = m->next;
+	}
+
+	return 0;
+}
+
+/* check the IPv4 header checksum at l3_off */
+static inline int
+net_ipv4_cksum_ok(const struct rte_mbuf *m, uint32_t l3_off, uint32_t l3_len)
+{
+	uint64_t sum = 0;
+
+	if (net_sum_mbuf(m, l3_off, l3_len, &sum) < 0)
+		return 0;
+	return net_sum_fold(sum) == 0xffff;
+}
+
+/* verify the TCP or UDP checksum of a packet, including its pseudo
+ * header, and return the matching PKT_RX_L4_CKSUM_* flag */
+static uint64_t
+net_l4_cksum_verify(const struct rte_mbuf *m, uint32_t l3_off,
+	uint32_t l3_len, int ipv4, uint8_t l4_proto)
+{
+	uint32_t l4_off = l3_off + l3_len;
+	uint32_t l4_len;
+	uint64_t sum;
+
+	if (ipv4) {
+		const struct ipv4_hdr *ip4h;
+		struct ipv4_hdr ip4h_copy;
+
+		ip4h = rte_pktmbuf_read(m, l3_off, sizeof(*ip4h), &ip4h_copy);
+		if (unlikely(ip4h == NULL ||
+				rte_be_to_cpu_16(ip4h->total_length) < l3_len))
+			return PKT_RX_L4_CKSUM_BAD;
+		l4_len = rte_be_to_cpu_16(ip4h->total_length) - l3_len;
+		sum = (uint64_t)ip4h->src_addr + ip4h->dst_addr +
+			rte_cpu_to_be_16((uint16_t)l4_len) +
+			rte_cpu_to_be_16((uint16_t)l4_proto);
+	} else {
+		const struct ipv6_hdr *ip6h;
+		struct ipv6_hdr ip6h_copy;
+
+		ip6h = rte_pktmbuf_read(m, l3_off, sizeof(*ip6h), &ip6h_copy);
+		if (unlikely(ip6h == NULL ||
+				rte_be_to_cpu_16(ip6h->payload_len) +
+				sizeof(*ip6h) < l3_len))
+			return PKT_RX_L4_CKSUM_BAD;
+		/* extension headers are part of the payload length */
+		l4_len = rte_be_to_cpu_16(ip6h->payload_len) +
+			sizeof(*ip6h) - l3_len;
+		sum = net_sum(ip6h->src_addr, sizeof(ip6h->src_addr) +
+			sizeof(ip6h->dst_addr), 0);
+		sum += (uint64_t)rte_cpu_to_be_32(l4_len) +
+			rte_cpu_to_be_32((uint32_t)l4_proto);
+	}
+
+	if (l4_proto == IPPROTO_UDP) {
+		const struct udp_hdr *uh;
+		struct udp_hdr uh_copy;
+
+		uh = rte_pktmbuf_read(m, l4_off, sizeof(*uh), &uh_copy);
+		if (unlikely(uh == NULL))
+			return PKT_RX_L4_CKSUM_BAD;
+		/* a null UDP checksum means none for IPv4, and is
+		 * forbidden for IPv6 */
+		if (uh->dgram_cksum == 0)
+			return ipv4 ? PKT_RX_L4_CKSUM_UNKNOWN :
+				PKT_RX_L4_CKSUM_BAD;
+	}
+
+	if (net_sum_mbuf(m, l4_off, l4_len, &sum) < 0)
+		return PKT_RX_L4_CKSUM_BAD;
+
+	return net_sum_fold(sum) == 0xffff ? PKT_RX_L4_CKSUM_GOOD :
+		PKT_RX_L4_CKSUM_BAD;
+}
+
+/* compute the checksum flags of a packet from its packet type and
+ * header lengths */
+static uint64_t
+net_cksum_verify(const struct rte_mbuf *m)
+{
+	uint32_t pkt_type = m->packet_type;
+	uint64_t flags = 0;
+	uint32_t l3_off;
+	uint32_t l3_type;
+	uint32_t l4_type;
+	int ipv4, ipv6;
+
+	if (pkt_type & RTE_PTYPE_TUNNEL_MASK) {
+		if (RTE_ETH_IS_IPV4_HDR(pkt_type) &&
+				!net_ipv4_cksum_ok(m, m->outer_l2_len,
+					m->outer_l3_len))
+			flags |= PKT_RX_EIP_CKSUM_BAD;
+
+		l3_off = m->outer_l2_len + m->outer_l3_len + m->l2_len;
+		l3_type = pkt_type & RTE_PTYPE_INNER_L3_MASK;
+		ipv4 = l3_type == RTE_PTYPE_INNER_L3_IPV4 ||
+			l3_type == RTE_PTYPE_INNER_L3_IPV4_EXT ||
+			l3_type == RTE_PTYPE_INNER_L3_IPV4_EXT_UNKNOWN;
+		ipv6 = l3_type == RTE_PTYPE_INNER_L3_IPV6 ||
+			l3_type == RTE_PTYPE_INNER_L3_IPV6_EXT ||
+			l3_type == RTE_PTYPE_INNER_L3_IPV6_EXT_UNKNOWN;
+		l4_type = pkt_type & RTE_PTYPE_INNER_L4_MASK;
+		if (l4_type == RTE_PTYPE_INNER_L4_TCP)
+			l4_type = RTE_PTYPE_L4_TCP;
+		else if (l4_type == RTE_PTYPE_INNER_L4_UDP)
+			l4_type = RTE_PTYPE_L4_UDP;
+		else
+			l4_type = 0;
+	} else {
+		l3_off = m->l2_len;
+		ipv4 = RTE_ETH_IS_IPV4_HDR(pkt_type) != 0;
+		ipv6 = RTE_ETH_IS_IPV6_HDR(pkt_type) != 0;
+		l4_type = pkt_type & RTE_PTYPE_L4_MASK;
+	}
+
+	if (ipv4) {
+		if (net_ipv4_cksum_ok(m, l3_off, m->l3_len))
+			flags |= PKT_RX_IP_CKSUM_GOOD;
+		else
+			flags |= PKT_RX_IP_CKSUM_BAD;
+	} else if (!ipv6) {
+		return flags;
+	}
+
+	if (l4_type == RTE_PTYPE_L4_TCP)
+		flags |= net_l4_cksum_verify(m, l3_off, m->l3_len, ipv4,
+			IPPROTO_TCP);
+	else if (l4_type == RTE_PTYPE_L4_UDP)
+		flags |= net_l4_cksum_verify(m, l3_off, m->l3_len, ipv4,
+			IPPROTO_UDP);
+
+	return flags;
+}
+
+/* verify in software the checksums of a burst of received packets */
+uint16_t
+rte_net_rx_cksum_verify_burst(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	struct rte_mbuf *m;
+	uint64_t flags;
+	uint16_t nb_bad = 0;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts && i < NET_BURST_PREFETCH; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[i], void *));
+
+	for (i = 0; i < nb_pkts; i++) {
+		m = pkts[i];
+		if (i + NET_BURST_PREFETCH < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(
+				pkts[i + NET_BURST_PREFETCH], void *));
+
+		flags = net_cksum_verify(m);
+		m->ol_flags &= ~(PKT_RX_IP_CKSUM_MASK | PKT_RX_L4_CKSUM_MASK |
+			PKT_RX_EIP_CKSUM_BAD);
+		m->ol_flags |= flags;
+
+		if ((flags & PKT_RX_IP_CKSUM_MASK) == PKT_RX_IP_CKSUM_BAD ||
+				(flags & PKT_RX_L4_CKSUM_MASK) ==
+					PKT_RX_L4_CKSUM_BAD ||
+				(flags & PKT_RX_EIP_CKSUM_BAD))
+			nb_bad++;
+	}
+
+	return nb_bad;
+}
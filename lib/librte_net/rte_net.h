@@ -73,7 +73,10 @@ struct rte_net_hdr_lens {
  *   L2: Ether, Vlan, QinQ
  *   L3: IPv4, IPv6
  *   L4: TCP, UDP, SCTP
- *   Tunnels: IPv4, IPv6, Gre, Nvgre
+ *   Tunnels: IPv4, IPv6, Gre, Nvgre, Vxlan
+ *
+ * Vxlan is recognized from the IANA assigned UDP destination port (4789)
+ * when the tunnel layer is requested.
  *
  * @param m
  *   The packet mbuf to be parsed.
@@ -91,6 +94,57 @@ struct rte_net_hdr_lens {
 uint32_t rte_net_get_ptype(const struct rte_mbuf *m,
 	struct rte_net_hdr_lens *hdr_lens, uint32_t layers);
 
+/**
+ * Parse a burst of Ethernet packets to get their packet types.
+ *
+ * This function does the same job as rte_net_get_ptype() for each packet
+ * of the burst, prefetching the data of the next packets while parsing
+ * the current one. Plain TCP and UDP packets over IPv4 or IPv6, with an
+ * optional VLAN tag and headers in the first segment, are handled by a
+ * fast path; the other packets go through rte_net_get_ptype().
+ *
+ * The packet type is stored in m->packet_type, and the header lengths in
+ * the mbuf length fields, following the TX offload conventions:
+ * - for non tunneled packets, l2_len, l3_len and l4_len are set and
+ *   outer_l2_len, outer_l3_len are reset,
+ * - for tunneled packets, outer_l2_len and outer_l3_len are the lengths
+ *   of the outer headers, l2_len is the length of the outer L4, tunnel
+ *   and inner L2 headers, l3_len and l4_len are the lengths of the inner
+ *   L3 and L4 headers.
+ *
+ * @param pkts
+ *   The array of packet mbufs to be parsed.
+ * @param nb_pkts
+ *   The number of packets in the array.
+ * @param layers
+ *   List of layers to parse, see rte_net_get_ptype().
+ */
+void rte_net_get_ptype_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+	uint32_t layers);
+
+/**
+ * Verify in software the checksums of a burst of received packets.
+ *
+ * The packet type and header lengths of the mbufs must have been set,
+ * for instance by rte_net_get_ptype_burst(). For each packet, the IPv4
+ * header checksum and the TCP or UDP checksum (including the pseudo
+ * header) are computed, and the result is stored in the ol_flags of the
+ * mbuf using PKT_RX_IP_CKSUM_GOOD/BAD and PKT_RX_L4_CKSUM_GOOD/BAD. For
+ * tunneled packets, the inner headers are checked and a bad outer IPv4
+ * header checksum sets PKT_RX_EIP_CKSUM_BAD. Layers that are not checked
+ * (unknown protocols, fragments, UDP over IPv4 without checksum) are
+ * reported as unknown. Multi-segment packets are supported.
+ *
+ * @param pkts
+ *   The array of packet mbufs to be checked.
+ * @param nb_pkts
+ *   The number of packets in the array.
+ * @return
+ *   The number of packets having at least one bad checksum.
+ */
+uint16_t rte_net_rx_cksum_verify_burst(struct rte_mbuf **pkts,
+	uint16_t nb_pkts);
+
 /**
  * Prepare pseudo header checksum
  *
@@ -37,42 +37,82 @@
 
 #include <rte_cpuflags.h>
 #include <rte_common.h>
+#include <rte_mbuf.h>
 #include <rte_net_crc.h>
 
+#include "net_crc.h"
+
 #if defined(RTE_ARCH_X86_64)				\
 	&& defined(RTE_MACHINE_CPUFLAG_SSE4_2)		\
 	&& defined(RTE_MACHINE_CPUFLAG_PCLMULQDQ)
 #define X86_64_SSE42_PCLMULQDQ     1
+#elif defined(RTE_ARCH_ARM64) && defined(RTE_MACHINE_CPUFLAG_PMULL)
+#define ARM64_NEON_PMULL           1
 #endif
 
 #ifdef X86_64_SSE42_PCLMULQDQ
 #include <net_crc_sse.h>
+#elif defined(ARM64_NEON_PMULL)
+#include <net_crc_neon.h>
 #endif
 
 /* crc tables */
 static uint32_t crc32_eth_lut[CRC_LUT_SIZE];
 static uint32_t crc16_ccitt_lut[CRC_LUT_SIZE];
+static uint32_t crc32c_lut[CRC_LUT_SIZE];
+
+static uint32_t
+rte_crc16_ccitt_handler(const uint8_t *data, uint32_t data_len, uint32_t crc);
 
 static uint32_t
-rte_crc16_ccitt_handler(const uint8_t *data, uint32_t data_len);
+rte_crc32_eth_handler(const uint8_t *data, uint32_t data_len, uint32_t crc);
 
 static uint32_t
-rte_crc32_eth_handler(const uint8_t *data, uint32_t data_len);
+rte_crc32c_handler(const uint8_t *data, uint32_t data_len, uint32_t crc);
 
+/* update a running (not inverted) crc value with a buffer */
 typedef uint32_t
-(*rte_net_crc_handler)(const uint8_t *data, uint32_t data_len);
+(*rte_net_crc_handler)(const uint8_t *data, uint32_t data_len, uint32_t crc);
+
+/* initial value and final mask of each crc type */
+static const struct {
+	uint32_t init;
+	uint32_t xor_out;
+} crc_params[] = {
+	[RTE_NET_CRC16_CCITT] = { 0xffff, 0xffff },
+	[RTE_NET_CRC32_ETH] = { 0xffffffffUL, 0xffffffffUL },
+	[RTE_NET_CRC32C] = { 0xffffffffUL, 0xffffffffUL },
+};
 
 static rte_net_crc_handler *handlers;
 
 static rte_net_crc_handler handlers_scalar[] = {
 	[RTE_NET_CRC16_CCITT] = rte_crc16_ccitt_handler,
 	[RTE_NET_CRC32_ETH] = rte_crc32_eth_handler,
+	[RTE_NET_CRC32C] = rte_crc32c_handler,
 };
 
 #ifdef X86_64_SSE42_PCLMULQDQ
 static rte_net_crc_handler handlers_sse42[] = {
 	[RTE_NET_CRC16_CCITT] = rte_crc16_ccitt_sse42_handler,
 	[RTE_NET_CRC32_ETH] = rte_crc32_eth_sse42_handler,
+	[RTE_NET_CRC32C] = rte_crc32c_sse42_handler,
+};
+#endif
+
+#ifdef CC_AVX512_VPCLMULQDQ_SUPPORT
+static rte_net_crc_handler handlers_avx512[] = {
+	[RTE_NET_CRC16_CCITT] = rte_crc16_ccitt_avx512_handler,
+	[RTE_NET_CRC32_ETH] = rte_crc32_eth_avx512_handler,
+	[RTE_NET_CRC32C] = rte_crc32c_avx512_handler,
+};
+#endif
+
+#ifdef ARM64_NEON_PMULL
+static rte_net_crc_handler handlers_neon[] = {
+	[RTE_NET_CRC16_CCITT] = rte_crc16_ccitt_neon_handler,
+	[RTE_NET_CRC32_ETH] = rte_crc32_eth_neon_handler,
+	[RTE_NET_CRC32C] = rte_crc32c_neon_handler,
 };
 #endif
 
@@ -136,39 +176,82 @@ rte_net_crc_scalar_init(void)
 
 	/* 16-bit CRC init */
 	crc32_eth_init_lut(CRC16_CCITT_POLYNOMIAL << 16, crc16_ccitt_lut);
+
+	/* 32-bit Castagnoli crc init */
+	crc32_eth_init_lut(CRC32C_POLYNOMIAL, crc32c_lut);
 }
 
 static inline uint32_t
-rte_crc16_ccitt_handler(const uint8_t *data, uint32_t data_len)
+rte_crc16_ccitt_handler(const uint8_t *data, uint32_t data_len, uint32_t crc)
 {
-	/* return 16-bit CRC value */
-	return (uint16_t)~crc32_eth_calc_lut(data,
+	return crc32_eth_calc_lut(data,
 		data_len,
-		0xffff,
+		crc,
 		crc16_ccitt_lut);
 }
 
 static inline uint32_t
-rte_crc32_eth_handler(const uint8_t *data, uint32_t data_len)
+rte_crc32_eth_handler(const uint8_t *data, uint32_t data_len, uint32_t crc)
 {
-	/* return 32-bit CRC value */
-	return ~crc32_eth_calc_lut(data,
+	return crc32_eth_calc_lut(data,
 		data_len,
-		0xffffffffUL,
+		crc,
 		crc32_eth_lut);
 }
 
+static inline uint32_t
+rte_crc32c_handler(const uint8_t *data, uint32_t data_len, uint32_t crc)
+{
+	return crc32_eth_calc_lut(data,
+		data_len,
+		crc,
+		crc32c_lut);
+}
+
+#ifdef CC_AVX512_VPCLMULQDQ_SUPPORT
+static int
+rte_net_crc_avx512_supported(void)
+{
+	return rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0 &&
+		rte_cpu_get_flag_enabled(RTE_CPUFLAG_VPCLMULQDQ) > 0;
+}
+#endif
+
+#ifdef ARM64_NEON_PMULL
+static int
+rte_net_crc_neon_supported(void)
+{
+	return rte_cpu_get_flag_enabled(RTE_CPUFLAG_PMULL) > 0;
+}
+#endif
+
 void
 rte_net_crc_set_alg(enum rte_net_crc_alg alg)
 {
 	switch (alg) {
+	case RTE_NET_CRC_AVX512:
+#ifdef CC_AVX512_VPCLMULQDQ_SUPPORT
+		if (rte_net_crc_avx512_supported()) {
+			handlers = handlers_avx512;
+			break;
+		}
+#endif
+		/* fall-through - use SSE4.2 if AVX-512 is not available */
 	case RTE_NET_CRC_SSE42:
 #ifdef X86_64_SSE42_PCLMULQDQ
 		handlers = handlers_sse42;
 #else
-		alg = RTE_NET_CRC_SCALAR;
+		handlers = handlers_scalar;
 #endif
 		break;
+	case RTE_NET_CRC_NEON:
+#ifdef ARM64_NEON_PMULL
+		if (rte_net_crc_neon_supported()) {
+			handlers = handlers_neon;
+			break;
+		}
+#endif
+		/* fall-through - use scalar if NEON is not available */
 	case RTE_NET_CRC_SCALAR:
 	default:
 		handlers = handlers_scalar;
@@ -185,9 +268,43 @@ rte_net_crc_calc(const void *data,
 	rte_net_crc_handler f_handle;
 
 	f_handle = handlers[type];
-	ret = f_handle(data, data_len);
+	ret = f_handle(data, data_len, crc_params[type].init);
 
-	return ret;
+	return ret ^ crc_params[type].xor_out;
+}
+
+uint32_t
+rte_net_crc_calc_mbuf(const struct rte_mbuf *m,
+	uint32_t off,
+	uint32_t data_len,
+	enum rte_net_crc_type type)
+{
+	rte_net_crc_handler f_handle;
+	uint32_t crc, seg_len;
+
+	if ((uint64_t)off + data_len > rte_pktmbuf_pkt_len(m))
+		return 0;
+
+	while (data_len > 0 && off >= rte_pktmbuf_data_len(m)) {
+		off -= rte_pktmbuf_data_len(m);
+		m = m->next;
+	}
+
+	f_handle = handlers[type];
+	crc = crc_params[type].init;
+
+	while (data_len > 0) {
+		seg_len = RTE_MIN((uint32_t)rte_pktmbuf_data_len(m) - off,
+			data_len);
+		if (seg_len > 0)
+			crc = f_handle(rte_pktmbuf_mtod_offset(m,
+				const uint8_t *, off), seg_len, crc);
+		data_len -= seg_len;
+		off = 0;
+		m = m->next;
+	}
+
+	return crc ^ crc_params[type].xor_out;
 }
 
 /* Select highest available crc algorithm as default one */
@@ -199,8 +316,22 @@ rte_net_crc_init(void)
 	rte_net_crc_scalar_init();
 
 #ifdef X86_64_SSE42_PCLMULQDQ
-		alg = RTE_NET_CRC_SSE42;
-		rte_net_crc_sse42_init();
+	alg = RTE_NET_CRC_SSE42;
+	rte_net_crc_sse42_init();
+#endif
+
+#ifdef CC_AVX512_VPCLMULQDQ_SUPPORT
+	if (rte_net_crc_avx512_supported()) {
+		alg = RTE_NET_CRC_AVX512;
+		rte_net_crc_avx512_init();
+	}
+#endif
+
+#ifdef ARM64_NEON_PMULL
+	if (rte_net_crc_neon_supported()) {
+		alg = RTE_NET_CRC_NEON;
+		rte_net_crc_neon_init();
+	}
 #endif
 
 	rte_net_crc_set_alg(alg);
@@ -40,9 +40,12 @@
 extern "C" {
 #endif
 
+struct rte_mbuf;
+
 /** CRC polynomials */
 #define CRC32_ETH_POLYNOMIAL 0x04c11db7UL
 #define CRC16_CCITT_POLYNOMIAL 0x1021U
+#define CRC32C_POLYNOMIAL 0x1edc6f41UL
 
 #define CRC_LUT_SIZE 256
 
@@ -50,6 +53,7 @@ extern "C" {
 enum rte_net_crc_type {
 	RTE_NET_CRC16_CCITT = 0,
 	RTE_NET_CRC32_ETH,
+	RTE_NET_CRC32C, /**< Castagnoli, as used by iSCSI and SCTP */
 	RTE_NET_CRC_REQS
 };
 
@@ -57,6 +61,8 @@ enum rte_net_crc_type {
 enum rte_net_crc_alg {
 	RTE_NET_CRC_SCALAR = 0,
 	RTE_NET_CRC_SSE42,
+	RTE_NET_CRC_NEON,
+	RTE_NET_CRC_AVX512,
 };
 
 /**
@@ -64,10 +70,16 @@ enum rte_net_crc_alg {
  * x86 64-bit sse4.2 intrinsic version, etc.) and internal data
  * structure.
  *
+ * The highest algorithm supported by the build and the CPU is selected
+ * at initialization. If the requested one is not available, the next
+ * lower one of the same architecture is used.
+ *
  * @param alg
  *   This parameter is used to select the CRC implementation version.
  *   - RTE_NET_CRC_SCALAR
  *   - RTE_NET_CRC_SSE42 (Use 64-bit SSE4.2 intrinsic)
+ *   - RTE_NET_CRC_NEON (Use ARMv8 NEON and PMULL intrinsic)
+ *   - RTE_NET_CRC_AVX512 (Use AVX-512 VPCLMULQDQ intrinsic)
  */
 void
 rte_net_crc_set_alg(enum rte_net_crc_alg alg);
@@ -90,6 +102,27 @@ rte_net_crc_calc(const void *data,
 	uint32_t data_len,
 	enum rte_net_crc_type type);
 
+/**
+ * CRC compute API for packet data spread over several segments
+ *
+ * @param m
+ *   Pointer to the packet mbuf
+ * @param off
+ *   Offset of the data in the packet
+ * @param data_len
+ *   Data length for CRC computation
+ * @param type
+ *   CRC type (enum rte_net_crc_type)
+ *
+ * @return
+ *   CRC value, or 0 if the packet is shorter than off + data_len
+ */
+uint32_t
+rte_net_crc_calc_mbuf(const struct rte_mbuf *m,
+	uint32_t off,
+	uint32_t data_len,
+	enum rte_net_crc_type type);
+
 #ifdef __cplusplus
 }
 #endif
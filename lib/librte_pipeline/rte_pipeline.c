@@ -35,6 +35,7 @@
 #include <stdio.h>
 
 #include <rte_common.h>
+#include <rte_atomic.h>
 #include <rte_memory.h>
 #include <rte_memzone.h>
 #include <rte_cycles.h>
@@ -122,6 +123,13 @@ struct rte_table {
 
 	/* Handle to the low-level table object */
 	void *h_table;
+	void *arg_create;
+
+	/* Handle to the low-level shadow table object (NULL if none). The
+	 * create parameters of each copy are swapped along with the handles.
+	 */
+	void *h_table_shadow;
+	void *arg_create_shadow;
 
 	/* Statistics */
 	uint64_t n_pkts_dropped_by_lkp_hit_ah;
@@ -152,6 +160,9 @@ struct rte_pipeline {
 	uint64_t enabled_port_in_mask;
 	struct rte_port_in *port_in_next;
 
+	/* Tables with pending shadow table swap */
+	volatile uint64_t table_swap_mask;
+
 	/* Pipeline run structures */
 	struct rte_mbuf *pkts[RTE_PORT_IN_BURST_SIZE_MAX];
 	struct rte_pipeline_table_entry *entries[RTE_PORT_IN_BURST_SIZE_MAX];
@@ -255,6 +266,7 @@ rte_pipeline_create(struct rte_pipeline_params *params)
 	p->num_tables = 0;
 	p->enabled_port_in_mask = 0;
 	p->port_in_next = NULL;
+	p->table_swap_mask = 0;
 	p->pkts_mask = 0;
 	p->n_pkts_ah_drop = 0;
 
@@ -411,6 +423,9 @@ rte_pipeline_table_create(struct rte_pipeline *p,
 
 	/* Initialize table internal data structure */
 	table->h_table = h_table;
+	table->arg_create = params->arg_create;
+	table->h_table_shadow = NULL;
+	table->arg_create_shadow = NULL;
 	table->table_next_id = 0;
 	table->table_next_id_valid = 0;
 
@@ -420,9 +435,13 @@ rte_pipeline_table_create(struct rte_pipeline *p,
 void
 rte_pipeline_table_free(struct rte_table *table)
 {
-	if (table->ops.f_free != NULL)
+	if (table->ops.f_free != NULL) {
 		table->ops.f_free(table->h_table);
 
+		if (table->h_table_shadow != NULL)
+			table->ops.f_free(table->h_table_shadow);
+	}
+
 	rte_free(table->default_entry);
 }
 
@@ -609,45 +628,54 @@ rte_pipeline_table_entry_delete(struct rte_pipeline *p,
 	return (table->ops.f_delete)(table->h_table, key, key_found, entry);
 }
 
-int rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
+static int
+rte_pipeline_table_bulk_check(struct rte_pipeline *p,
 	uint32_t table_id,
 	void **keys,
-	struct rte_pipeline_table_entry **entries,
 	uint32_t n_keys,
 	int *key_found,
-	struct rte_pipeline_table_entry **entries_ptr)
+	const char *caller)
 {
-	struct rte_table *table;
-	uint32_t i;
-
-	/* Check input arguments */
 	if (p == NULL) {
 		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter is NULL\n",
-			__func__);
+			caller);
 		return -EINVAL;
 	}
 
-	if (keys == NULL) {
-		RTE_LOG(ERR, PIPELINE, "%s: keys parameter is NULL\n", __func__);
+	if ((keys == NULL) && n_keys) {
+		RTE_LOG(ERR, PIPELINE, "%s: keys parameter is NULL\n", caller);
 		return -EINVAL;
 	}
 
-	if (entries == NULL) {
-		RTE_LOG(ERR, PIPELINE, "%s: entries parameter is NULL\n",
-			__func__);
+	if ((key_found == NULL) && n_keys) {
+		RTE_LOG(ERR, PIPELINE, "%s: key_found parameter is NULL\n",
+			caller);
 		return -EINVAL;
 	}
 
 	if (table_id >= p->num_tables) {
 		RTE_LOG(ERR, PIPELINE,
-			"%s: table_id %d out of range\n", __func__, table_id);
+			"%s: table_id %d out of range\n", caller, table_id);
 		return -EINVAL;
 	}
 
-	table = &p->tables[table_id];
+	return 0;
+}
 
-	if (table->ops.f_add_bulk == NULL) {
-		RTE_LOG(ERR, PIPELINE, "%s: f_add_bulk function pointer NULL\n",
+static int
+rte_pipeline_table_bulk_add(struct rte_table *table,
+	void *h_table,
+	void **keys,
+	struct rte_pipeline_table_entry **entries,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries_ptr)
+{
+	uint32_t i;
+
+	if ((table->ops.f_add_bulk == NULL) && (table->ops.f_add == NULL)) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: f_add_bulk and f_add function pointers NULL\n",
 			__func__);
 		return -EINVAL;
 	}
@@ -671,8 +699,87 @@ int rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
 		}
 	}
 
-	return (table->ops.f_add_bulk)(table->h_table, keys, (void **) entries,
-		n_keys, key_found, (void **) entries_ptr);
+	if (table->ops.f_add_bulk != NULL)
+		return (table->ops.f_add_bulk)(h_table, keys, (void **) entries,
+			n_keys, key_found, (void **) entries_ptr);
+
+	/* No bulk operation provided by the table: add the entries one by one */
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = (table->ops.f_add)(h_table, keys[i],
+			(void *) entries[i], &key_found[i],
+			(void **) &entries_ptr[i]);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_pipeline_table_bulk_delete(struct rte_table *table,
+	void *h_table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries)
+{
+	uint32_t i;
+
+	if (table->ops.f_delete_bulk != NULL)
+		return (table->ops.f_delete_bulk)(h_table, keys, n_keys,
+			key_found, (void **) entries);
+
+	if (table->ops.f_delete == NULL) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: f_delete_bulk and f_delete function pointers NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	/* No bulk operation provided by the table: delete the entries one by
+	 * one
+	 */
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = (table->ops.f_delete)(h_table, keys[i], &key_found[i],
+			(entries != NULL) ? entries[i] : NULL);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+int rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	struct rte_pipeline_table_entry **entries,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries_ptr)
+{
+	struct rte_table *table;
+	int status;
+
+	/* Check input arguments */
+	status = rte_pipeline_table_bulk_check(p, table_id, keys, n_keys,
+		key_found, __func__);
+	if (status)
+		return status;
+
+	if ((entries == NULL) || (entries_ptr == NULL)) {
+		RTE_LOG(ERR, PIPELINE, "%s: entries parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	return rte_pipeline_table_bulk_add(table, table->h_table, keys,
+		entries, n_keys, key_found, entries_ptr);
 }
 
 int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
@@ -683,16 +790,65 @@ int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
 	struct rte_pipeline_table_entry **entries)
 {
 	struct rte_table *table;
+	int status;
 
 	/* Check input arguments */
+	status = rte_pipeline_table_bulk_check(p, table_id, keys, n_keys,
+		key_found, __func__);
+	if (status)
+		return status;
+
+	table = &p->tables[table_id];
+
+	return rte_pipeline_table_bulk_delete(table, table->h_table, keys,
+		n_keys, key_found, entries);
+}
+
+/*
+ * Shadow table
+ *
+ */
+static int
+rte_pipeline_table_shadow_check(struct rte_pipeline *p,
+	uint32_t table_id,
+	const char *caller)
+{
 	if (p == NULL) {
-		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
-			__func__);
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter is NULL\n",
+			caller);
 		return -EINVAL;
 	}
 
-	if (keys == NULL) {
-		RTE_LOG(ERR, PIPELINE, "%s: key parameter is NULL\n",
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", caller, table_id);
+		return -EINVAL;
+	}
+
+	if (p->tables[table_id].h_table_shadow == NULL) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table %d has no shadow copy\n", caller, table_id);
+		return -EINVAL;
+	}
+
+	/* The shadow copy is owned by the data path until the swap is done */
+	if (p->table_swap_mask & (1LLU << table_id))
+		return -EBUSY;
+
+	return 0;
+}
+
+int
+rte_pipeline_table_shadow_create(struct rte_pipeline *p,
+	uint32_t table_id,
+	void *arg_create)
+{
+	struct rte_table *table;
+	void *h_table;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter is NULL\n",
 			__func__);
 		return -EINVAL;
 	}
@@ -705,14 +861,199 @@ int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
 
 	table = &p->tables[table_id];
 
-	if (table->ops.f_delete_bulk == NULL) {
+	if (table->h_table_shadow != NULL) {
 		RTE_LOG(ERR, PIPELINE,
-			"%s: f_delete function pointer NULL\n", __func__);
+			"%s: table %d already has a shadow copy\n",
+			__func__, table_id);
+		return -EEXIST;
+	}
+
+	/* Named tables (e.g. LPM, ACL) reject or share a table with the same
+	 * name, so the shadow copy needs its own parameters
+	 */
+	if ((arg_create != NULL) && (arg_create == table->arg_create)) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table %d shadow copy uses the active copy "
+			"parameters\n", __func__, table_id);
 		return -EINVAL;
 	}
 
-	return (table->ops.f_delete_bulk)(table->h_table, keys, n_keys, key_found,
-			(void **) entries);
+	/* Create the shadow table */
+	h_table = table->ops.f_create(arg_create, p->socket_id,
+		table->entry_size);
+	if (h_table == NULL) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: Shadow table creation failed\n", __func__);
+		return -ENOMEM;
+	}
+
+	table->arg_create_shadow = arg_create;
+	table->h_table_shadow = h_table;
+
+	return 0;
+}
+
+int
+rte_pipeline_table_shadow_reset(struct rte_pipeline *p,
+	uint32_t table_id)
+{
+	struct rte_table *table;
+	void *h_table;
+	int status;
+
+	/* Check input arguments */
+	status = rte_pipeline_table_shadow_check(p, table_id, __func__);
+	if (status)
+		return status;
+
+	table = &p->tables[table_id];
+
+	if (table->ops.f_free == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: f_free function pointer NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	/* Free the old shadow table before creating the new one, so that
+	 * memory for more than two copies is never needed
+	 */
+	table->ops.f_free(table->h_table_shadow);
+	table->h_table_shadow = NULL;
+
+	h_table = table->ops.f_create(table->arg_create_shadow, p->socket_id,
+		table->entry_size);
+	if (h_table == NULL) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: Shadow table creation failed\n", __func__);
+		return -ENOMEM;
+	}
+
+	table->h_table_shadow = h_table;
+
+	return 0;
+}
+
+int
+rte_pipeline_table_shadow_entry_add_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	struct rte_pipeline_table_entry **entries,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries_ptr)
+{
+	struct rte_table *table;
+	int status;
+
+	/* Check input arguments */
+	status = rte_pipeline_table_bulk_check(p, table_id, keys, n_keys,
+		key_found, __func__);
+	if (status)
+		return status;
+
+	if ((entries == NULL) || (entries_ptr == NULL)) {
+		RTE_LOG(ERR, PIPELINE, "%s: entries parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	status = rte_pipeline_table_shadow_check(p, table_id, __func__);
+	if (status)
+		return status;
+
+	table = &p->tables[table_id];
+
+	return rte_pipeline_table_bulk_add(table, table->h_table_shadow, keys,
+		entries, n_keys, key_found, entries_ptr);
+}
+
+int
+rte_pipeline_table_shadow_entry_delete_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries)
+{
+	struct rte_table *table;
+	int status;
+
+	/* Check input arguments */
+	status = rte_pipeline_table_bulk_check(p, table_id, keys, n_keys,
+		key_found, __func__);
+	if (status)
+		return status;
+
+	status = rte_pipeline_table_shadow_check(p, table_id, __func__);
+	if (status)
+		return status;
+
+	table = &p->tables[table_id];
+
+	return rte_pipeline_table_bulk_delete(table, table->h_table_shadow,
+		keys, n_keys, key_found, entries);
+}
+
+int
+rte_pipeline_table_shadow_swap(struct rte_pipeline *p,
+	uint32_t table_id)
+{
+	int status;
+
+	/* Check input arguments */
+	status = rte_pipeline_table_shadow_check(p, table_id, __func__);
+	if (status)
+		return status;
+
+	/* Make the shadow table contents visible before posting the request */
+	rte_smp_wmb();
+	__sync_fetch_and_or(&p->table_swap_mask, 1LLU << table_id);
+
+	return 0;
+}
+
+int
+rte_pipeline_table_shadow_swap_pending(struct rte_pipeline *p,
+	uint32_t table_id)
+{
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	return (p->table_swap_mask & (1LLU << table_id)) ? 1 : 0;
+}
+
+static void
+rte_pipeline_table_swap_run(struct rte_pipeline *p)
+{
+	uint64_t swap_mask = p->table_swap_mask;
+	uint64_t mask;
+
+	/* Make sure the shadow table contents are read after the request */
+	rte_smp_rmb();
+
+	for (mask = swap_mask; mask; mask &= mask - 1) {
+		struct rte_table *table = &p->tables[__builtin_ctzll(mask)];
+		void *h_table = table->h_table;
+		void *arg_create = table->arg_create;
+
+		table->h_table = table->h_table_shadow;
+		table->h_table_shadow = h_table;
+		table->arg_create = table->arg_create_shadow;
+		table->arg_create_shadow = arg_create;
+	}
+
+	/* Hand the previously active tables over to the control plane */
+	rte_smp_wmb();
+	__sync_fetch_and_and(&p->table_swap_mask, ~swap_mask);
 }
 
 /*
@@ -1343,9 +1684,14 @@ rte_pipeline_action_handler_drop(struct rte_pipeline *p, uint64_t pkts_mask)
 int
 rte_pipeline_run(struct rte_pipeline *p)
 {
-	struct rte_port_in *port_in = p->port_in_next;
+	struct rte_port_in *port_in;
 	uint32_t n_pkts, table_id;
 
+	/* Shadow table swap (at burst boundary) */
+	if (unlikely(p->table_swap_mask))
+		rte_pipeline_table_swap_run(p);
+
+	port_in = p->port_in_next;
 	if (port_in == NULL)
 		return 0;
 
@@ -81,6 +81,15 @@ extern "C" {
  * the same CPU core, but it is not allowed (for thread safety reasons) to have
  * multiple CPU cores running the same pipeline instance.
  *
+ * <B>Shadow tables.</B> The table entry add and delete functions update the
+ * table that is used by the data path, so they have to be called from the
+ * CPU core that runs the pipeline (or synchronized with it by the
+ * application). Alternatively, a table can be given a shadow copy: the shadow
+ * copy can be populated or bulk updated by any other single control thread
+ * while the pipeline keeps running, and is then swapped with the active copy
+ * at the start of the next pipeline run (i.e. at a burst boundary), so the
+ * data path never sees a partially updated table.
+ *
  ***/
 
 #include <stdint.h>
@@ -476,6 +485,9 @@ int rte_pipeline_table_entry_delete(struct rte_pipeline *p,
 /**
  * Pipeline table entry add bulk
  *
+ * When the table does not provide a bulk add operation, the entries are added
+ * one at a time through its single entry add operation.
+ *
  * @param p
  *   Handle to pipeline instance
  * @param table_id
@@ -510,6 +522,9 @@ int rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
 /**
  * Pipeline table entry delete bulk
  *
+ * When the table does not provide a bulk delete operation, the entries are
+ * deleted one at a time through its single entry delete operation.
+ *
  * @param p
  *   Handle to pipeline instance
  * @param table_id
@@ -537,6 +552,166 @@ int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
 	int *key_found,
 	struct rte_pipeline_table_entry **entries);
 
+/**
+ * Pipeline table shadow copy create
+ *
+ * Creates a second low-level table object (the shadow copy) for table
+ * *table_id*, using the same table operations and the *arg_create* parameters.
+ * The shadow copy is initially empty. The table default entry and statistics
+ * are shared by the two copies.
+ *
+ * The two copies exist at the same time, so *arg_create* has to be distinct
+ * from the parameters used to create the table, and for the table types that
+ * have a name (ACL, LPM, LPM IPv6, cuckoo hash) it has to set a different
+ * name: the creation of an LPM table fails when the name is already in use,
+ * and ACL tables with the same name would share their ACL contexts.
+ *
+ * After a swap, the previously active copy becomes the shadow copy and the
+ * shadow reset operation recreates it with the table create parameters, so
+ * both the table create parameters and *arg_create* have to remain valid for
+ * as long as the shadow copy exists.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param arg_create
+ *   Opaque parameter to be passed to the table create operation, distinct
+ *   from the one of the table create operation
+ * @return
+ *   0 on success, error code otherwise
+ */
+int rte_pipeline_table_shadow_create(struct rte_pipeline *p,
+	uint32_t table_id,
+	void *arg_create);
+
+/**
+ * Pipeline table shadow copy reset
+ *
+ * Replaces the shadow copy of table *table_id* with a new, empty table. This
+ * is typically used before a full table reload.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @return
+ *   0 on success, -EBUSY when a swap of this table is still pending, other
+ *   error code otherwise
+ */
+int rte_pipeline_table_shadow_reset(struct rte_pipeline *p,
+	uint32_t table_id);
+
+/**
+ * Pipeline table shadow copy entry add bulk
+ *
+ * Same as rte_pipeline_table_entry_add_bulk(), but the entries are added to
+ * the shadow copy of the table, which is not visible to the data path until
+ * the next swap. The returned entry pointers point to entries of the shadow
+ * copy.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param keys
+ *   Array containing table entry keys
+ * @param entries
+ *   Array containing new contents for every table entry identified by key
+ * @param n_keys
+ *   Number of keys to add
+ * @param key_found
+ *   On successful invocation, key_found for every item in the array is set to
+ *   TRUE (value different than 0) if key was already present in the shadow
+ *   copy before the add operation and to FALSE (value 0) if not
+ * @param entries_ptr
+ *   On successful invocation, array *entries_ptr stores pointer to every
+ *   shadow copy entry associated with key
+ * @return
+ *   0 on success, -EBUSY when a swap of this table is still pending, other
+ *   error code otherwise
+ */
+int rte_pipeline_table_shadow_entry_add_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	struct rte_pipeline_table_entry **entries,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries_ptr);
+
+/**
+ * Pipeline table shadow copy entry delete bulk
+ *
+ * Same as rte_pipeline_table_entry_delete_bulk(), but the entries are deleted
+ * from the shadow copy of the table.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param keys
+ *   Array containing table entry keys
+ * @param n_keys
+ *   Number of keys to delete
+ * @param key_found
+ *   On successful invocation, key_found for every item in the array is set to
+ *   TRUE (value different than 0) if key was found in the shadow copy before
+ *   the delete operation and to FALSE (value 0) if not
+ * @param entries
+ *   If entries pointer is NULL, this pointer is ignored for every entry found.
+ *   Else, after successful invocation, if specific key is found in the shadow
+ *   copy and entry points to a valid buffer, the table entry contents (as it
+ *   was before the delete was performed) is copied to this buffer.
+ * @return
+ *   0 on success, -EBUSY when a swap of this table is still pending, other
+ *   error code otherwise
+ */
+int rte_pipeline_table_shadow_entry_delete_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries);
+
+/**
+ * Pipeline table shadow copy swap
+ *
+ * Requests the shadow copy of table *table_id* to become the active copy. The
+ * request is non-blocking: the swap is performed by the CPU core running the
+ * pipeline at the start of its next rte_pipeline_run() call, so the packets
+ * of any given burst are always looked up in the same copy of the table. Once
+ * the swap is completed (see rte_pipeline_table_shadow_swap_pending()), the
+ * previously active copy becomes the shadow copy and can be updated again.
+ *
+ * The two copies are not synchronized by the swap: to apply an incremental
+ * update to both copies, the update has to be applied to the shadow copy
+ * once again after the swap.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @return
+ *   0 on success, -EBUSY when a swap of this table is already pending, other
+ *   error code otherwise
+ */
+int rte_pipeline_table_shadow_swap(struct rte_pipeline *p,
+	uint32_t table_id);
+
+/**
+ * Pipeline table shadow copy swap pending
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @return
+ *   1 when a swap of this table was requested and not yet performed by the
+ *   pipeline, 0 when no swap is pending, error code otherwise
+ */
+int rte_pipeline_table_shadow_swap_pending(struct rte_pipeline *p,
+	uint32_t table_id);
+
 /**
  * Read pipeline table stats.
  *
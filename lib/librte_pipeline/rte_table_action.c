@@ -0,0 +1,1316 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_prefetch.h>
+#include <rte_log.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#include "rte_table_action.h"
+
+#define ACTION_DATA_ALIGN                                  8
+
+/*
+ * RTE_TABLE_ACTION_FWD
+ */
+static int
+fwd_apply(struct rte_pipeline_table_entry *entry,
+	struct rte_table_action_fwd_params *p)
+{
+	if (p->action >= RTE_PIPELINE_ACTIONS)
+		return -EINVAL;
+
+	entry->action = p->action;
+	entry->port_id = p->id;
+
+	return 0;
+}
+
+/*
+ * RTE_TABLE_ACTION_MTR
+ */
+static int
+mtr_cfg_check(struct rte_table_action_mtr_config *mtr)
+{
+	if ((mtr->n_tc != 1) && (mtr->n_tc != RTE_TABLE_ACTION_TC_MAX))
+		return -ENOTSUP;
+
+	if (mtr->color_offset & 0x3)
+		return -EINVAL;
+
+	return 0;
+}
+
+struct mtr_trtcm_data {
+	struct rte_meter_trtcm trtcm;
+	uint64_t stats[e_RTE_METER_COLORS];
+	uint64_t n_drop;
+	uint8_t policer[e_RTE_METER_COLORS];
+	uint8_t color_drop_mask;
+};
+
+static size_t
+mtr_data_size(struct rte_table_action_mtr_config *mtr)
+{
+	return mtr->n_tc * sizeof(struct mtr_trtcm_data);
+}
+
+struct dscp_table_entry_data {
+	uint32_t tc_id;
+	enum rte_meter_color color;
+};
+
+struct dscp_table_data {
+	struct dscp_table_entry_data entry[RTE_TABLE_ACTION_DSCP_TABLE_SIZE];
+};
+
+static int
+mtr_apply_check(struct rte_table_action_mtr_params *p,
+	struct rte_table_action_mtr_config *cfg)
+{
+	uint32_t i, j;
+
+	if ((p->tc_mask & ((1LLU << cfg->n_tc) - 1)) == 0)
+		return -EINVAL;
+
+	for (i = 0; i < cfg->n_tc; i++) {
+		if ((p->tc_mask & (1LLU << i)) == 0)
+			continue;
+
+		for (j = 0; j < e_RTE_METER_COLORS; j++)
+			if (p->mtr[i].policer[j] >=
+				e_RTE_TABLE_ACTION_POLICER_ACTIONS)
+				return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+mtr_apply(struct mtr_trtcm_data *data,
+	struct rte_table_action_mtr_params *p,
+	struct rte_table_action_mtr_config *cfg)
+{
+	uint32_t i;
+	int status;
+
+	status = mtr_apply_check(p, cfg);
+	if (status)
+		return status;
+
+	for (i = 0; i < cfg->n_tc; i++) {
+		struct mtr_trtcm_data *d = &data[i];
+		struct rte_table_action_mtr_tc_params *tc = &p->mtr[i];
+		uint32_t j;
+
+		if ((p->tc_mask & (1LLU << i)) == 0)
+			continue;
+
+		status = rte_meter_trtcm_config(&d->trtcm, &tc->meter);
+		if (status)
+			return status;
+
+		d->color_drop_mask = 0;
+		for (j = 0; j < e_RTE_METER_COLORS; j++) {
+			enum rte_table_action_policer action = tc->policer[j];
+
+			if (action == e_RTE_TABLE_ACTION_POLICER_DROP) {
+				d->policer[j] = j;
+				d->color_drop_mask |= 1 << j;
+			} else
+				d->policer[j] = action;
+
+			d->stats[j] = 0;
+		}
+		d->n_drop = 0;
+	}
+
+	return 0;
+}
+
+static __rte_always_inline uint64_t
+pkt_work_mtr(struct rte_mbuf *mbuf,
+	struct mtr_trtcm_data *data,
+	struct dscp_table_data *dscp_table,
+	uint32_t color_offset,
+	uint64_t time,
+	uint32_t dscp,
+	uint16_t total_length)
+{
+	uint32_t *pkt_color = RTE_MBUF_METADATA_UINT32_PTR(mbuf, color_offset);
+	struct dscp_table_entry_data *dscp_entry = &dscp_table->entry[dscp];
+	struct mtr_trtcm_data *d = &data[dscp_entry->tc_id];
+	enum rte_meter_color color_in, color_meter, color_policer;
+	uint64_t drop;
+
+	color_in = dscp_entry->color;
+
+	/* Meter */
+	color_meter = rte_meter_trtcm_color_aware_check(&d->trtcm,
+		time,
+		total_length,
+		color_in);
+
+	/* Policer */
+	color_policer = (enum rte_meter_color) d->policer[color_meter];
+	drop = (d->color_drop_mask >> color_meter) & 1;
+
+	/* Stats */
+	d->stats[color_policer] += drop ^ 1;
+	d->n_drop += drop;
+
+	*pkt_color = color_policer;
+
+	return drop;
+}
+
+/*
+ * RTE_TABLE_ACTION_ENCAP
+ */
+static int
+encap_valid(enum rte_table_action_encap_type encap)
+{
+	switch (encap) {
+	case RTE_TABLE_ACTION_ENCAP_ETHER:
+	case RTE_TABLE_ACTION_ENCAP_VLAN:
+	case RTE_TABLE_ACTION_ENCAP_QINQ:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static int
+encap_cfg_check(struct rte_table_action_encap_config *encap)
+{
+	if ((encap->encap_mask == 0) ||
+		(encap->encap_mask >> (RTE_TABLE_ACTION_ENCAP_QINQ + 1)))
+		return -ENOTSUP;
+
+	return 0;
+}
+
+#define ENCAP_HDR_SIZE_MAX                                          \
+	(sizeof(struct ether_hdr) + 2 * sizeof(struct vlan_hdr))
+
+struct encap_data {
+	uint8_t hdr[ENCAP_HDR_SIZE_MAX];
+	uint16_t size;
+} __attribute__((__packed__));
+
+static size_t
+encap_data_size(struct rte_table_action_encap_config *encap __rte_unused)
+{
+	return sizeof(struct encap_data);
+}
+
+static int
+encap_apply_check(struct rte_table_action_encap_params *p,
+	struct rte_table_action_encap_config *cfg)
+{
+	if (!encap_valid(p->type) ||
+		((cfg->encap_mask & (1LLU << p->type)) == 0))
+		return -EINVAL;
+
+	return 0;
+}
+
+static inline uint16_t
+vlan_tci(struct rte_table_action_vlan_hdr *vlan)
+{
+	return rte_cpu_to_be_16(((uint16_t)(vlan->pcp & 0x7) << 13) |
+		((uint16_t)(vlan->dei & 0x1) << 12) |
+		(vlan->vid & 0xFFF));
+}
+
+static void
+encap_ether_hdr_set(struct ether_hdr *hdr,
+	struct rte_table_action_ether_hdr *ether,
+	uint16_t ether_type)
+{
+	ether_addr_copy(&ether->da, &hdr->d_addr);
+	ether_addr_copy(&ether->sa, &hdr->s_addr);
+	hdr->ether_type = rte_cpu_to_be_16(ether_type);
+}
+
+static int
+encap_apply(struct encap_data *data,
+	struct rte_table_action_encap_params *p,
+	struct rte_table_action_encap_config *cfg,
+	struct rte_table_action_common_config *common_cfg)
+{
+	uint16_t ether_type = (common_cfg->ip_version) ?
+		ETHER_TYPE_IPv4 : ETHER_TYPE_IPv6;
+	struct ether_hdr *ether = (struct ether_hdr *) data->hdr;
+	struct vlan_hdr *vlan0 = (struct vlan_hdr *) &ether[1];
+	struct vlan_hdr *vlan1 = &vlan0[1];
+	int status;
+
+	status = encap_apply_check(p, cfg);
+	if (status)
+		return status;
+
+	memset(data, 0, sizeof(*data));
+
+	switch (p->type) {
+	case RTE_TABLE_ACTION_ENCAP_ETHER:
+		encap_ether_hdr_set(ether, &p->ether.ether, ether_type);
+		data->size = sizeof(struct ether_hdr);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_VLAN:
+		encap_ether_hdr_set(ether, &p->vlan.ether, ETHER_TYPE_VLAN);
+		vlan0->vlan_tci = vlan_tci(&p->vlan.vlan);
+		vlan0->eth_proto = rte_cpu_to_be_16(ether_type);
+		data->size = sizeof(struct ether_hdr) + sizeof(struct vlan_hdr);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_QINQ:
+		encap_ether_hdr_set(ether, &p->qinq.ether, ETHER_TYPE_QINQ);
+		vlan0->vlan_tci = vlan_tci(&p->qinq.svlan);
+		vlan0->eth_proto = rte_cpu_to_be_16(ETHER_TYPE_VLAN);
+		vlan1->vlan_tci = vlan_tci(&p->qinq.cvlan);
+		vlan1->eth_proto = rte_cpu_to_be_16(ether_type);
+		data->size = sizeof(struct ether_hdr) +
+			2 * sizeof(struct vlan_hdr);
+		return 0;
+
+	default:
+		return -EINVAL;
+	}
+}
+
+static __rte_always_inline void
+pkt_work_encap(struct rte_mbuf *mbuf,
+	struct encap_data *data,
+	void *ip)
+{
+	uint8_t *dst = (uint8_t *) ip - data->size;
+	int32_t delta = dst - rte_pktmbuf_mtod(mbuf, uint8_t *);
+
+	rte_memcpy(dst, data->hdr, data->size);
+
+	mbuf->data_off += delta;
+	mbuf->data_len -= delta;
+	mbuf->pkt_len -= delta;
+}
+
+/*
+ * RTE_TABLE_ACTION_NAT
+ */
+static int
+nat_cfg_check(struct rte_table_action_nat_config *nat,
+	struct rte_table_action_common_config *common)
+{
+	if (common->ip_version == 0)
+		return -ENOTSUP;
+
+	if ((nat->proto != IPPROTO_TCP) && (nat->proto != IPPROTO_UDP))
+		return -ENOTSUP;
+
+	return 0;
+}
+
+struct nat_ipv4_data {
+	uint32_t addr;
+	uint16_t port;
+} __attribute__((__packed__));
+
+static size_t
+nat_data_size(struct rte_table_action_nat_config *nat __rte_unused)
+{
+	return sizeof(struct nat_ipv4_data);
+}
+
+static int
+nat_apply(struct nat_ipv4_data *data,
+	struct rte_table_action_nat_params *p)
+{
+	data->addr = rte_cpu_to_be_32(p->ipv4);
+	data->port = rte_cpu_to_be_16(p->port);
+
+	return 0;
+}
+
+/*
+ * Incremental update of the one's complement checksum as per RFC 1624:
+ * HC' = ~(~HC + ~m + m'). All the input values are in network byte order.
+ */
+static inline uint16_t
+cksum_update16(uint16_t cksum, uint16_t old, uint16_t new)
+{
+	uint32_t sum;
+
+	sum = (uint16_t) ~cksum;
+	sum += (uint16_t) ~old;
+	sum += new;
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+
+	return (uint16_t) ~sum;
+}
+
+static inline uint16_t
+cksum_update32(uint16_t cksum, uint32_t old, uint32_t new)
+{
+	uint32_t sum;
+
+	sum = (uint16_t) ~cksum;
+	sum += (uint16_t) ~(old >> 16);
+	sum += (uint16_t) ~(old & 0xFFFF);
+	sum += new >> 16;
+	sum += new & 0xFFFF;
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+
+	return (uint16_t) ~sum;
+}
+
+static inline uint16_t
+nat_l4_cksum(uint16_t cksum,
+	uint32_t ip_addr_old,
+	uint32_t ip_addr_new,
+	uint16_t port_old,
+	uint16_t port_new)
+{
+	cksum = cksum_update32(cksum, ip_addr_old, ip_addr_new);
+
+	return cksum_update16(cksum, port_old, port_new);
+}
+
+static __rte_always_inline void
+pkt_work_nat(struct ipv4_hdr *ip,
+	struct nat_ipv4_data *data,
+	struct rte_table_action_nat_config *cfg)
+{
+	uint32_t ip_addr_old;
+
+	if (cfg->source_nat) {
+		ip_addr_old = ip->src_addr;
+		ip->src_addr = data->addr;
+	} else {
+		ip_addr_old = ip->dst_addr;
+		ip->dst_addr = data->addr;
+	}
+
+	ip->hdr_checksum = cksum_update32(ip->hdr_checksum,
+		ip_addr_old, data->addr);
+
+	if (cfg->proto == IPPROTO_TCP) {
+		struct tcp_hdr *tcp = (struct tcp_hdr *) &ip[1];
+		uint16_t port_old;
+
+		if (cfg->source_nat) {
+			port_old = tcp->src_port;
+			tcp->src_port = data->port;
+		} else {
+			port_old = tcp->dst_port;
+			tcp->dst_port = data->port;
+		}
+
+		tcp->cksum = nat_l4_cksum(tcp->cksum,
+			ip_addr_old, data->addr,
+			port_old, data->port);
+	} else {
+		struct udp_hdr *udp = (struct udp_hdr *) &ip[1];
+		uint16_t port_old;
+
+		if (cfg->source_nat) {
+			port_old = udp->src_port;
+			udp->src_port = data->port;
+		} else {
+			port_old = udp->dst_port;
+			udp->dst_port = data->port;
+		}
+
+		/* UDP checksum of zero means no checksum */
+		if (udp->dgram_cksum) {
+			uint16_t cksum = nat_l4_cksum(udp->dgram_cksum,
+				ip_addr_old, data->addr,
+				port_old, data->port);
+
+			udp->dgram_cksum = (cksum) ? cksum : 0xFFFF;
+		}
+	}
+}
+
+/*
+ * RTE_TABLE_ACTION_TTL
+ */
+struct ttl_data {
+	uint32_t decrement;
+	uint32_t reserved;
+	uint64_t n_packets;
+} __attribute__((__packed__));
+
+static size_t
+ttl_data_size(struct rte_table_action_ttl_config *ttl __rte_unused)
+{
+	return sizeof(struct ttl_data);
+}
+
+static int
+ttl_apply(struct ttl_data *data,
+	struct rte_table_action_ttl_params *p)
+{
+	data->decrement = (p->decrement) ? 1 : 0;
+	data->reserved = 0;
+	data->n_packets = 0;
+
+	return 0;
+}
+
+static __rte_always_inline uint64_t
+pkt_ipv4_work_ttl(struct ipv4_hdr *ip,
+	struct ttl_data *data,
+	struct rte_table_action_ttl_config *cfg)
+{
+	uint8_t ttl = ip->time_to_live;
+	uint16_t ttl_proto_old, ttl_proto_new;
+	uint64_t zero;
+
+	/* TTL and protocol fields share the same 16-bit checksum word */
+	ttl_proto_old = rte_cpu_to_be_16(((uint16_t) ttl << 8) |
+		ip->next_proto_id);
+	ttl -= (ttl) ? data->decrement : 0;
+	zero = (ttl == 0);
+	ttl_proto_new = rte_cpu_to_be_16(((uint16_t) ttl << 8) |
+		ip->next_proto_id);
+
+	ip->time_to_live = ttl;
+	ip->hdr_checksum = cksum_update16(ip->hdr_checksum,
+		ttl_proto_old, ttl_proto_new);
+
+	data->n_packets += zero & cfg->n_packets_enabled;
+
+	return zero & cfg->drop;
+}
+
+static __rte_always_inline uint64_t
+pkt_ipv6_work_ttl(struct ipv6_hdr *ip,
+	struct ttl_data *data,
+	struct rte_table_action_ttl_config *cfg)
+{
+	uint8_t hl = ip->hop_limits;
+	uint64_t zero;
+
+	hl -= (hl) ? data->decrement : 0;
+	zero = (hl == 0);
+
+	ip->hop_limits = hl;
+
+	data->n_packets += zero & cfg->n_packets_enabled;
+
+	return zero & cfg->drop;
+}
+
+/*
+ * RTE_TABLE_ACTION_STATS
+ */
+static int
+stats_cfg_check(struct rte_table_action_stats_config *stats)
+{
+	if ((stats->n_packets_enabled == 0) && (stats->n_bytes_enabled == 0))
+		return -EINVAL;
+
+	return 0;
+}
+
+struct stats_data {
+	uint64_t n_packets;
+	uint64_t n_bytes;
+} __attribute__((__packed__));
+
+static size_t
+stats_data_size(struct rte_table_action_stats_config *stats __rte_unused)
+{
+	return sizeof(struct stats_data);
+}
+
+static int
+stats_apply(struct stats_data *data,
+	struct rte_table_action_stats_params *p)
+{
+	data->n_packets = p->n_packets;
+	data->n_bytes = p->n_bytes;
+
+	return 0;
+}
+
+static __rte_always_inline void
+pkt_work_stats(struct stats_data *data,
+	uint16_t total_length)
+{
+	data->n_packets++;
+	data->n_bytes += total_length;
+}
+
+/*
+ * Action profile
+ */
+static int
+action_valid(enum rte_table_action_type action)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_FWD:
+	case RTE_TABLE_ACTION_MTR:
+	case RTE_TABLE_ACTION_ENCAP:
+	case RTE_TABLE_ACTION_NAT:
+	case RTE_TABLE_ACTION_TTL:
+	case RTE_TABLE_ACTION_STATS:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+struct ap_config {
+	uint64_t action_mask;
+	struct rte_table_action_common_config common;
+	struct rte_table_action_mtr_config mtr;
+	struct rte_table_action_encap_config encap;
+	struct rte_table_action_nat_config nat;
+	struct rte_table_action_ttl_config ttl;
+	struct rte_table_action_stats_config stats;
+};
+
+static size_t
+action_cfg_size(enum rte_table_action_type action)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_MTR:
+		return sizeof(struct rte_table_action_mtr_config);
+	case RTE_TABLE_ACTION_ENCAP:
+		return sizeof(struct rte_table_action_encap_config);
+	case RTE_TABLE_ACTION_NAT:
+		return sizeof(struct rte_table_action_nat_config);
+	case RTE_TABLE_ACTION_TTL:
+		return sizeof(struct rte_table_action_ttl_config);
+	case RTE_TABLE_ACTION_STATS:
+		return sizeof(struct rte_table_action_stats_config);
+	default:
+		return 0;
+	}
+}
+
+static void *
+action_cfg_get(struct ap_config *ap_config,
+	enum rte_table_action_type type)
+{
+	switch (type) {
+	case RTE_TABLE_ACTION_MTR:
+		return &ap_config->mtr;
+	case RTE_TABLE_ACTION_ENCAP:
+		return &ap_config->encap;
+	case RTE_TABLE_ACTION_NAT:
+		return &ap_config->nat;
+	case RTE_TABLE_ACTION_TTL:
+		return &ap_config->ttl;
+	case RTE_TABLE_ACTION_STATS:
+		return &ap_config->stats;
+	default:
+		return NULL;
+	}
+}
+
+static void
+action_cfg_set(struct ap_config *ap_config,
+	enum rte_table_action_type type,
+	void *action_cfg)
+{
+	void *dst = action_cfg_get(ap_config, type);
+
+	if (dst)
+		memcpy(dst, action_cfg, action_cfg_size(type));
+
+	ap_config->action_mask |= 1LLU << type;
+}
+
+struct ap_data {
+	size_t offset[RTE_TABLE_ACTIONS];
+	size_t total_size;
+};
+
+static size_t
+action_data_size(enum rte_table_action_type action,
+	struct ap_config *ap_config)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_MTR:
+		return mtr_data_size(&ap_config->mtr);
+	case RTE_TABLE_ACTION_ENCAP:
+		return encap_data_size(&ap_config->encap);
+	case RTE_TABLE_ACTION_NAT:
+		return nat_data_size(&ap_config->nat);
+	case RTE_TABLE_ACTION_TTL:
+		return ttl_data_size(&ap_config->ttl);
+	case RTE_TABLE_ACTION_STATS:
+		return stats_data_size(&ap_config->stats);
+	default:
+		return 0;
+	}
+}
+
+static void
+action_data_offset_set(struct ap_data *ap_data,
+	struct ap_config *ap_config)
+{
+	uint64_t action_mask = ap_config->action_mask;
+	size_t offset;
+	uint32_t action;
+
+	memset(ap_data->offset, 0, sizeof(ap_data->offset));
+
+	offset = 0;
+	for (action = 0; action < RTE_TABLE_ACTIONS; action++)
+		if (action_mask & (1LLU << action)) {
+			ap_data->offset[action] = offset;
+			offset += RTE_ALIGN_CEIL(action_data_size(
+				(enum rte_table_action_type) action,
+				ap_config), ACTION_DATA_ALIGN);
+		}
+
+	ap_data->total_size = offset;
+}
+
+struct rte_table_action_profile {
+	struct ap_config cfg;
+	struct ap_data data;
+	int frozen;
+};
+
+struct rte_table_action_profile *
+rte_table_action_profile_create(struct rte_table_action_common_config *common)
+{
+	struct rte_table_action_profile *ap;
+
+	/* Check input arguments */
+	if ((common == NULL) || (common->ip_offset & 0x1)) {
+		RTE_LOG(ERR, PIPELINE, "%s: Invalid common config\n",
+			__func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	ap = calloc(1, sizeof(struct rte_table_action_profile));
+	if (ap == NULL)
+		return NULL;
+
+	/* Initialization */
+	memcpy(&ap->cfg.common, common, sizeof(*common));
+
+	return ap;
+}
+
+int
+rte_table_action_profile_action_register(struct rte_table_action_profile *profile,
+	enum rte_table_action_type type,
+	void *action_config)
+{
+	int status;
+
+	/* Check input arguments */
+	if ((profile == NULL) ||
+		profile->frozen ||
+		(action_valid(type) == 0) ||
+		(profile->cfg.action_mask & (1LLU << type)) ||
+		((action_cfg_size(type) == 0) && action_config) ||
+		(action_cfg_size(type) && (action_config == NULL)))
+		return -EINVAL;
+
+	switch (type) {
+	case RTE_TABLE_ACTION_MTR:
+		status = mtr_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_ENCAP:
+		status = encap_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_NAT:
+		status = nat_cfg_check(action_config,
+			&profile->cfg.common);
+		break;
+
+	case RTE_TABLE_ACTION_STATS:
+		status = stats_cfg_check(action_config);
+		break;
+
+	default:
+		status = 0;
+		break;
+	}
+
+	if (status)
+		return status;
+
+	/* Action enable */
+	action_cfg_set(&profile->cfg, type, action_config);
+
+	return 0;
+}
+
+int
+rte_table_action_profile_freeze(struct rte_table_action_profile *profile)
+{
+	if ((profile == NULL) || profile->frozen)
+		return -EINVAL;
+
+	profile->cfg.action_mask |= 1LLU << RTE_TABLE_ACTION_FWD;
+	action_data_offset_set(&profile->data, &profile->cfg);
+	profile->frozen = 1;
+
+	return 0;
+}
+
+int
+rte_table_action_profile_free(struct rte_table_action_profile *profile)
+{
+	if (profile == NULL)
+		return 0;
+
+	free(profile);
+	return 0;
+}
+
+/*
+ * Action
+ */
+struct rte_table_action {
+	struct ap_config cfg;
+	struct ap_data data;
+	struct dscp_table_data dscp_table;
+};
+
+struct rte_table_action *
+rte_table_action_create(struct rte_table_action_profile *profile,
+	uint32_t socket_id)
+{
+	struct rte_table_action *action;
+
+	/* Check input arguments */
+	if ((profile == NULL) ||
+		(profile->frozen == 0))
+		return NULL;
+
+	/* Memory allocation */
+	action = rte_zmalloc_socket(NULL,
+		sizeof(struct rte_table_action),
+		RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (action == NULL)
+		return NULL;
+
+	/* Initialization */
+	memcpy(&action->cfg, &profile->cfg, sizeof(profile->cfg));
+	memcpy(&action->data, &profile->data, sizeof(profile->data));
+
+	return action;
+}
+
+static __rte_always_inline void *
+action_data_get(void *data,
+	struct rte_table_action *action,
+	enum rte_table_action_type type)
+{
+	size_t offset = action->data.offset[type];
+	struct rte_pipeline_table_entry *entry = data;
+
+	return &entry->action_data[offset];
+}
+
+int
+rte_table_action_apply(struct rte_table_action *action,
+	void *data,
+	enum rte_table_action_type type,
+	void *action_params)
+{
+	void *action_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		(data == NULL) ||
+		(action_valid(type) == 0) ||
+		((action->cfg.action_mask & (1LLU << type)) == 0) ||
+		(action_params == NULL))
+		return -EINVAL;
+
+	/* Data update */
+	action_data = action_data_get(data, action, type);
+
+	switch (type) {
+	case RTE_TABLE_ACTION_FWD:
+		return fwd_apply(data,
+			action_params);
+
+	case RTE_TABLE_ACTION_MTR:
+		return mtr_apply(action_data,
+			action_params,
+			&action->cfg.mtr);
+
+	case RTE_TABLE_ACTION_ENCAP:
+		return encap_apply(action_data,
+			action_params,
+			&action->cfg.encap,
+			&action->cfg.common);
+
+	case RTE_TABLE_ACTION_NAT:
+		return nat_apply(action_data,
+			action_params);
+
+	case RTE_TABLE_ACTION_TTL:
+		return ttl_apply(action_data,
+			action_params);
+
+	case RTE_TABLE_ACTION_STATS:
+		return stats_apply(action_data,
+			action_params);
+
+	default:
+		return -EINVAL;
+	}
+}
+
+int
+rte_table_action_dscp_table_update(struct rte_table_action *action,
+	uint64_t dscp_mask,
+	struct rte_table_action_dscp_table *table)
+{
+	uint32_t i;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_MTR)) == 0) ||
+		(dscp_mask == 0) ||
+		(table == NULL))
+		return -EINVAL;
+
+	for (i = 0; i < RTE_TABLE_ACTION_DSCP_TABLE_SIZE; i++) {
+		struct rte_table_action_dscp_table_entry *entry =
+			&table->entry[i];
+
+		if ((dscp_mask & (1LLU << i)) == 0)
+			continue;
+
+		if ((entry->tc_id >= action->cfg.mtr.n_tc) ||
+			(entry->color >= e_RTE_METER_COLORS))
+			return -EINVAL;
+	}
+
+	for (i = 0; i < RTE_TABLE_ACTION_DSCP_TABLE_SIZE; i++) {
+		struct dscp_table_entry_data *data =
+			&action->dscp_table.entry[i];
+		struct rte_table_action_dscp_table_entry *entry =
+			&table->entry[i];
+
+		if ((dscp_mask & (1LLU << i)) == 0)
+			continue;
+
+		data->tc_id = entry->tc_id;
+		data->color = entry->color;
+	}
+
+	return 0;
+}
+
+int
+rte_table_action_meter_read(struct rte_table_action *action,
+	void *data,
+	uint32_t tc_mask,
+	struct rte_table_action_mtr_counters *stats,
+	int clear)
+{
+	struct mtr_trtcm_data *mtr_data;
+	uint32_t i;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_MTR)) == 0) ||
+		(data == NULL) ||
+		(tc_mask > RTE_LEN2MASK(action->cfg.mtr.n_tc, uint32_t)))
+		return -EINVAL;
+
+	mtr_data = action_data_get(data, action, RTE_TABLE_ACTION_MTR);
+
+	/* Read */
+	if (stats) {
+		for (i = 0; i < RTE_TABLE_ACTION_TC_MAX; i++) {
+			struct rte_table_action_mtr_counters_tc *dst =
+				&stats->stats[i];
+			struct mtr_trtcm_data *src = &mtr_data[i];
+
+			if ((tc_mask & (1 << i)) == 0)
+				continue;
+
+			memcpy(dst->n_packets, src->stats,
+				sizeof(dst->n_packets));
+			dst->n_packets_drop = src->n_drop;
+		}
+
+		stats->tc_mask = tc_mask;
+	}
+
+	/* Clear */
+	if (clear)
+		for (i = 0; i < RTE_TABLE_ACTION_TC_MAX; i++) {
+			struct mtr_trtcm_data *src = &mtr_data[i];
+
+			if ((tc_mask & (1 << i)) == 0)
+				continue;
+
+			memset(src->stats, 0, sizeof(src->stats));
+			src->n_drop = 0;
+		}
+
+	return 0;
+}
+
+int
+rte_table_action_ttl_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_ttl_counters *stats,
+	int clear)
+{
+	struct ttl_data *ttl_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_TTL)) == 0) ||
+		(data == NULL))
+		return -EINVAL;
+
+	ttl_data = action_data_get(data, action, RTE_TABLE_ACTION_TTL);
+
+	/* Read */
+	if (stats)
+		stats->n_packets = ttl_data->n_packets;
+
+	/* Clear */
+	if (clear)
+		ttl_data->n_packets = 0;
+
+	return 0;
+}
+
+int
+rte_table_action_stats_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_stats_counters *stats,
+	int clear)
+{
+	struct stats_data *stats_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_STATS)) == 0) ||
+		(data == NULL))
+		return -EINVAL;
+
+	stats_data = action_data_get(data, action,
+		RTE_TABLE_ACTION_STATS);
+
+	/* Read */
+	if (stats) {
+		stats->n_packets = stats_data->n_packets;
+		stats->n_bytes = stats_data->n_bytes;
+		stats->n_packets_valid = action->cfg.stats.n_packets_enabled;
+		stats->n_bytes_valid = action->cfg.stats.n_bytes_enabled;
+	}
+
+	/* Clear */
+	if (clear) {
+		stats_data->n_packets = 0;
+		stats_data->n_bytes = 0;
+	}
+
+	return 0;
+}
+
+/*
+ * Per burst snapshot of the action configuration. Kept in local variables so
+ * that it is not reloaded from memory after every write into the packet.
+ */
+struct ah_ctx {
+	uint64_t action_mask;
+	uint64_t time;
+	struct rte_table_action *action;
+	uint32_t ip_offset;
+	uint32_t color_offset;
+	uint32_t mtr_offset;
+	uint32_t encap_offset;
+	uint32_t nat_offset;
+	uint32_t ttl_offset;
+	uint32_t stats_offset;
+	int ip_version;
+};
+
+static __rte_always_inline uint64_t
+pkt_work(struct rte_mbuf *mbuf,
+	struct rte_pipeline_table_entry *table_entry,
+	const struct ah_ctx *ctx)
+{
+	struct rte_table_action *action = ctx->action;
+	uint8_t *data = table_entry->action_data;
+	void *ip = RTE_MBUF_METADATA_UINT32_PTR(mbuf, ctx->ip_offset);
+	uint64_t action_mask = ctx->action_mask;
+	uint64_t drop_mask = 0;
+	uint32_t dscp;
+	uint16_t total_length;
+
+	if (ctx->ip_version) {
+		struct ipv4_hdr *hdr = ip;
+
+		dscp = hdr->type_of_service >> 2;
+		total_length = rte_be_to_cpu_16(hdr->total_length);
+	} else {
+		struct ipv6_hdr *hdr = ip;
+
+		dscp = (rte_be_to_cpu_32(hdr->vtc_flow) >> 22) & 0x3F;
+		total_length = rte_be_to_cpu_16(hdr->payload_len) +
+			sizeof(struct ipv6_hdr);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_MTR))
+		drop_mask |= pkt_work_mtr(mbuf,
+			(struct mtr_trtcm_data *) &data[ctx->mtr_offset],
+			&action->dscp_table,
+			ctx->color_offset,
+			ctx->time,
+			dscp,
+			total_length);
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_NAT))
+		pkt_work_nat(ip,
+			(struct nat_ipv4_data *) &data[ctx->nat_offset],
+			&action->cfg.nat);
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TTL)) {
+		struct ttl_data *ttl =
+			(struct ttl_data *) &data[ctx->ttl_offset];
+
+		if (ctx->ip_version)
+			drop_mask |= pkt_ipv4_work_ttl(ip, ttl,
+				&action->cfg.ttl);
+		else
+			drop_mask |= pkt_ipv6_work_ttl(ip, ttl,
+				&action->cfg.ttl);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_STATS))
+		pkt_work_stats((struct stats_data *) &data[ctx->stats_offset],
+			total_length);
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP))
+		pkt_work_encap(mbuf,
+			(struct encap_data *) &data[ctx->encap_offset],
+			ip);
+
+	return drop_mask;
+}
+
+static __rte_always_inline uint64_t
+pkt4_work(struct rte_mbuf **mbufs,
+	struct rte_pipeline_table_entry **table_entries,
+	const struct ah_ctx *ctx)
+{
+	uint64_t drop_mask0, drop_mask1, drop_mask2, drop_mask3;
+
+	drop_mask0 = pkt_work(mbufs[0], table_entries[0], ctx);
+	drop_mask1 = pkt_work(mbufs[1], table_entries[1], ctx);
+	drop_mask2 = pkt_work(mbufs[2], table_entries[2], ctx);
+	drop_mask3 = pkt_work(mbufs[3], table_entries[3], ctx);
+
+	return drop_mask0 |
+		(drop_mask1 << 1) |
+		(drop_mask2 << 2) |
+		(drop_mask3 << 3);
+}
+
+static __rte_always_inline void
+pkt4_prefetch(struct rte_mbuf **mbufs,
+	struct rte_pipeline_table_entry **table_entries,
+	uint32_t ip_offset)
+{
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[0], ip_offset));
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[1], ip_offset));
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[2], ip_offset));
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[3], ip_offset));
+
+	rte_prefetch0(table_entries[0]);
+	rte_prefetch0(table_entries[1]);
+	rte_prefetch0(table_entries[2]);
+	rte_prefetch0(table_entries[3]);
+}
+
+static __rte_always_inline int
+ah(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	struct rte_table_action *action)
+{
+	struct ap_config *cfg = &action->cfg;
+	struct ah_ctx ctx = {
+		.action_mask = cfg->action_mask,
+		.time = 0,
+		.action = action,
+		.ip_offset = cfg->common.ip_offset,
+		.color_offset = cfg->mtr.color_offset,
+		.mtr_offset = action->data.offset[RTE_TABLE_ACTION_MTR],
+		.encap_offset = action->data.offset[RTE_TABLE_ACTION_ENCAP],
+		.nat_offset = action->data.offset[RTE_TABLE_ACTION_NAT],
+		.ttl_offset = action->data.offset[RTE_TABLE_ACTION_TTL],
+		.stats_offset = action->data.offset[RTE_TABLE_ACTION_STATS],
+		.ip_version = cfg->common.ip_version,
+	};
+	uint64_t pkts_drop_mask = 0;
+
+	if (ctx.action_mask & (1LLU << RTE_TABLE_ACTION_MTR))
+		ctx.time = rte_rdtsc();
+
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		uint32_t i;
+
+		if (n_pkts >= 4)
+			pkt4_prefetch(pkts, entries, ctx.ip_offset);
+
+		for (i = 0; i < (n_pkts & (~0x3LLU)); i += 4) {
+			uint64_t drop_mask;
+
+			if (i + 8 <= n_pkts)
+				pkt4_prefetch(&pkts[i + 4], &entries[i + 4],
+					ctx.ip_offset);
+
+			drop_mask = pkt4_work(&pkts[i], &entries[i], &ctx);
+
+			pkts_drop_mask |= drop_mask << i;
+		}
+
+		for ( ; i < n_pkts; i++) {
+			uint64_t drop_mask;
+
+			drop_mask = pkt_work(pkts[i], entries[i], &ctx);
+
+			pkts_drop_mask |= drop_mask << i;
+		}
+	} else
+		for ( ; pkts_mask; ) {
+			uint32_t pos = __builtin_ctzll(pkts_mask);
+			uint64_t pkt_mask = 1LLU << pos;
+			uint64_t drop_mask;
+
+			drop_mask = pkt_work(pkts[pos], entries[pos], &ctx);
+
+			pkts_mask &= ~pkt_mask;
+			pkts_drop_mask |= drop_mask << pos;
+		}
+
+	if (pkts_drop_mask)
+		rte_pipeline_ah_packet_drop(p, pkts_drop_mask);
+
+	return 0;
+}
+
+static int
+ah_default(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	void *arg)
+{
+	struct rte_table_action *action = arg;
+
+	return ah(p, pkts, pkts_mask, entries, action);
+}
+
+static rte_pipeline_table_action_handler_hit
+ah_selector(struct rte_table_action *action)
+{
+	if (action->cfg.action_mask == (1LLU << RTE_TABLE_ACTION_FWD))
+		return NULL;
+
+	return ah_default;
+}
+
+int
+rte_table_action_table_params_get(struct rte_table_action *action,
+	struct rte_pipeline_table_params *params)
+{
+	rte_pipeline_table_action_handler_hit f_action_hit;
+	uint32_t total_size;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		(params == NULL))
+		return -EINVAL;
+
+	f_action_hit = ah_selector(action);
+	total_size = rte_align32pow2(action->data.total_size +
+		sizeof(struct rte_pipeline_table_entry));
+
+	/* Fill in params */
+	params->f_action_hit = f_action_hit;
+	params->f_action_miss = NULL;
+	params->arg_ah = (f_action_hit) ? action : NULL;
+	params->action_data_size = total_size -
+		sizeof(struct rte_pipeline_table_entry);
+
+	return 0;
+}
+
+int
+rte_table_action_free(struct rte_table_action *action)
+{
+	if (action == NULL)
+		return 0;
+
+	rte_free(action);
+
+	return 0;
+}
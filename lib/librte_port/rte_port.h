@@ -162,6 +162,51 @@ struct rte_port_out_stats {
 	uint64_t n_pkts_drop;
 };
 
+/** Number of buckets of the output port latency histogram */
+#define RTE_PORT_OUT_LATENCY_HIST_SIZE                     32
+
+/**
+ * Output port latency histogram
+ *
+ * Records the time (in TSC cycles) spent by each packet in the output port
+ * buffer, i.e. between being handed over to the port and being sent. Bucket
+ * *i* counts the packets with latency in the [2^i, 2^(i+1)) range (bucket 0
+ * also counts the packets sent without being buffered), while the last
+ * bucket also counts all the packets with higher latency.
+ */
+struct rte_port_out_latency {
+	/** Number of packets per latency bucket */
+	uint64_t n_pkts[RTE_PORT_OUT_LATENCY_HIST_SIZE];
+
+	/** Maximum latency (TSC cycles) */
+	uint64_t max;
+};
+
+/**
+ * Output port latency histogram update
+ *
+ * @param latency
+ *   Handle to latency histogram
+ * @param cycles
+ *   Latency (TSC cycles) of the current packets
+ * @param n_pkts
+ *   Number of packets with this latency
+ */
+static inline void
+rte_port_out_latency_update(struct rte_port_out_latency *latency,
+	uint64_t cycles,
+	uint32_t n_pkts)
+{
+	uint32_t bucket = 63 - __builtin_clzll(cycles | 1);
+
+	if (bucket >= RTE_PORT_OUT_LATENCY_HIST_SIZE)
+		bucket = RTE_PORT_OUT_LATENCY_HIST_SIZE - 1;
+
+	latency->n_pkts[bucket] += n_pkts;
+	if (cycles > latency->max)
+		latency->max = cycles;
+}
+
 /**
  * Output port create
  *
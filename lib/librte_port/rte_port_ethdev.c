@@ -33,6 +33,7 @@
 #include <string.h>
 #include <stdint.h>
 
+#include <rte_cycles.h>
 #include <rte_mbuf.h>
 #include <rte_ethdev.h>
 #include <rte_malloc.h>
@@ -157,6 +158,12 @@ struct rte_port_ethdev_writer {
 	uint64_t bsz_mask;
 	uint16_t queue_id;
 	uint8_t port_id;
+
+	/* Flush deadline and latency measurement */
+	uint32_t timed;
+	uint64_t tx_flush_cycles;
+	struct rte_port_out_latency *latency;
+	uint64_t tx_buf_tsc[2 * RTE_PORT_IN_BURST_SIZE_MAX];
 };
 
 static void *
@@ -189,15 +196,32 @@ rte_port_ethdev_writer_create(void *params, int socket_id)
 	port->tx_burst_sz = conf->tx_burst_sz;
 	port->tx_buf_count = 0;
 	port->bsz_mask = 1LLU << (conf->tx_burst_sz - 1);
+	port->tx_flush_cycles = conf->tx_flush_cycles;
+	port->latency = conf->latency;
+	port->timed = (conf->tx_flush_cycles != 0) || (conf->latency != NULL);
 
 	return port;
 }
 
+static inline void
+ethdev_writer_latency_update(struct rte_port_ethdev_writer *p)
+{
+	uint64_t tsc = rte_rdtsc();
+	uint32_t i;
+
+	for (i = 0; i < p->tx_buf_count; i++)
+		rte_port_out_latency_update(p->latency,
+			tsc - p->tx_buf_tsc[i], 1);
+}
+
 static inline void
 send_burst(struct rte_port_ethdev_writer *p)
 {
 	uint32_t nb_tx;
 
+	if (p->latency)
+		ethdev_writer_latency_update(p);
+
 	nb_tx = rte_eth_tx_burst(p->port_id, p->queue_id,
 			 p->tx_buf, p->tx_buf_count);
 
@@ -213,10 +237,18 @@ rte_port_ethdev_writer_tx(void *port, struct rte_mbuf *pkt)
 {
 	struct rte_port_ethdev_writer *p =
 		port;
+	uint64_t tsc = 0;
+
+	if (p->timed) {
+		tsc = rte_rdtsc();
+		p->tx_buf_tsc[p->tx_buf_count] = tsc;
+	}
 
 	p->tx_buf[p->tx_buf_count++] = pkt;
 	RTE_PORT_ETHDEV_WRITER_STATS_PKTS_IN_ADD(p, 1);
-	if (p->tx_buf_count >= p->tx_burst_sz)
+	if ((p->tx_buf_count >= p->tx_burst_sz) ||
+		(p->tx_flush_cycles &&
+		(tsc - p->tx_buf_tsc[0] >= p->tx_flush_cycles)))
 		send_burst(p);
 
 	return 0;
@@ -231,13 +263,23 @@ rte_port_ethdev_writer_tx_bulk(void *port,
 		port;
 	uint64_t bsz_mask = p->bsz_mask;
 	uint32_t tx_buf_count = p->tx_buf_count;
-	uint64_t expr = (pkts_mask & (pkts_mask + 1)) |
-			((pkts_mask & bsz_mask) ^ bsz_mask);
+	uint32_t first = __builtin_ctzll(pkts_mask | (1LLU << 63));
+	uint64_t mask = pkts_mask >> first;
+	uint64_t expr = (mask & (mask + 1)) | ((mask & bsz_mask) ^ bsz_mask);
+	uint64_t tsc = 0;
+
+	if (p->timed)
+		tsc = rte_rdtsc();
 
 	if (expr == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		/* Contiguous burst of at least tx_burst_sz packets: send it
+		 * straight from the input array, without buffering
+		 */
+		uint64_t n_pkts = __builtin_popcountll(mask);
 		uint32_t n_pkts_ok;
 
+		pkts += first;
+
 		if (tx_buf_count)
 			send_burst(p);
 
@@ -245,6 +287,9 @@ rte_port_ethdev_writer_tx_bulk(void *port,
 		n_pkts_ok = rte_eth_tx_burst(p->port_id, p->queue_id, pkts,
 			n_pkts);
 
+		if (p->latency)
+			rte_port_out_latency_update(p->latency, 0, n_pkts);
+
 		RTE_PORT_ETHDEV_WRITER_STATS_PKTS_DROP_ADD(p, n_pkts - n_pkts_ok);
 		for ( ; n_pkts_ok < n_pkts; n_pkts_ok++) {
 			struct rte_mbuf *pkt = pkts[n_pkts_ok];
@@ -257,13 +302,17 @@ rte_port_ethdev_writer_tx_bulk(void *port,
 			uint64_t pkt_mask = 1LLU << pkt_index;
 			struct rte_mbuf *pkt = pkts[pkt_index];
 
+			if (p->timed)
+				p->tx_buf_tsc[tx_buf_count] = tsc;
 			p->tx_buf[tx_buf_count++] = pkt;
 			RTE_PORT_ETHDEV_WRITER_STATS_PKTS_IN_ADD(p, 1);
 			pkts_mask &= ~pkt_mask;
 		}
 
 		p->tx_buf_count = tx_buf_count;
-		if (tx_buf_count >= p->tx_burst_sz)
+		if ((tx_buf_count >= p->tx_burst_sz) ||
+			(p->tx_flush_cycles &&
+			(tsc - p->tx_buf_tsc[0] >= p->tx_flush_cycles)))
 			send_burst(p);
 	}
 
@@ -74,6 +74,17 @@ struct rte_port_ethdev_writer_params {
 	/** Recommended burst size to NIC TX queue. The actual burst size can be
 	bigger or smaller than this value. */
 	uint32_t tx_burst_sz;
+
+	/** Maximum time (in TSC cycles) a packet can wait in the port buffer.
+	When exceeded, the buffer is sent on the next TX operation, even if it
+	holds less than tx_burst_sz packets; the application still has to flush
+	the port periodically to cover the periods with no traffic. Set to 0 to
+	only send the buffer when full or when flushed. */
+	uint64_t tx_flush_cycles;
+
+	/** Latency histogram updated by the port, owned by the application. Set
+	to NULL to disable the latency measurement. */
+	struct rte_port_out_latency *latency;
 };
 
 /** ethdev_writer port operations */
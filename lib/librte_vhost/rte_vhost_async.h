@@ -0,0 +1,284 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_VHOST_ASYNC_H_
+#define _RTE_VHOST_ASYNC_H_
+
+/**
+ * @file
+ * RTE vhost asynchronous enqueue
+ *
+ * The asynchronous enqueue path lets the vhost library hand the copies of
+ * packet data into guest buffers to a copy engine, instead of doing them
+ * inline on the calling core with rte_memcpy. Packets are first submitted
+ * with rte_vhost_submit_enqueue_burst(); they become visible to the guest,
+ * and are returned to the application, once the copy engine has reported
+ * them as done through rte_vhost_poll_enqueue_completed(). Packets are
+ * always completed in submission order on a given virtqueue.
+ *
+ * A copy engine is registered per virtqueue as a set of callbacks. A
+ * software engine offloading the copies to a dedicated CPU thread is
+ * provided as a reference implementation.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rte_mbuf;
+
+/**
+ * A contiguous copy to be done by a copy engine.
+ */
+struct rte_vhost_async_seg {
+	void *src;	/**< Source address (mbuf data) */
+	void *dst;	/**< Destination address (guest buffer) */
+	uint32_t len;	/**< Number of bytes to copy */
+};
+
+/**
+ * All the copies needed to enqueue one packet.
+ */
+struct rte_vhost_async_desc {
+	struct rte_vhost_async_seg *segs;	/**< Array of copies */
+	uint16_t nr_segs;			/**< Number of copies */
+};
+
+/**
+ * Copy engine callbacks.
+ */
+struct rte_vhost_async_channel_ops {
+	/**
+	 * Submit the copies of a burst of packets to the engine.
+	 *
+	 * The descriptor and segment arrays are only valid during the call.
+	 * The engine must complete the accepted packets in order.
+	 *
+	 * @param vid
+	 *  vhost device ID
+	 * @param queue_id
+	 *  virtio queue index
+	 * @param ctx
+	 *  Engine private context given at registration
+	 * @param descs
+	 *  Array of packets to copy
+	 * @param count
+	 *  Number of packets in the array
+	 * @return
+	 *  Number of packets accepted by the engine (the first ones of the
+	 *  array), negative value on error. The packets not accepted are
+	 *  copied by the vhost library itself.
+	 */
+	int32_t (*transfer_data)(int vid, uint16_t queue_id, void *ctx,
+			struct rte_vhost_async_desc *descs, uint16_t count);
+
+	/**
+	 * Check which of the packets previously submitted are done.
+	 *
+	 * @param vid
+	 *  vhost device ID
+	 * @param queue_id
+	 *  virtio queue index
+	 * @param ctx
+	 *  Engine private context given at registration
+	 * @param max_packets
+	 *  Maximum number of completions to report
+	 * @return
+	 *  Number of packets completed since the previous call, negative
+	 *  value on error.
+	 */
+	int32_t (*check_completed_copies)(int vid, uint16_t queue_id,
+			void *ctx, uint16_t max_packets);
+};
+
+/**
+ * Register a copy engine for the asynchronous enqueue path of a virtqueue.
+ *
+ * Should be called from the new_device() callback, as the resources
+ * attached to the virtqueue are released when the device is stopped.
+ * Once registered, rte_vhost_enqueue_burst() can no longer be used on
+ * this virtqueue.
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index, must be a guest RX (even) queue
+ * @param threshold
+ *  Packets shorter than this many bytes are copied by the CPU inline
+ * @param ops
+ *  Copy engine callbacks
+ * @param ctx
+ *  Engine private context passed back to the callbacks
+ * @return
+ *  0 on success, -1 on failure
+ */
+int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+		uint32_t threshold, struct rte_vhost_async_channel_ops *ops,
+		void *ctx);
+
+/**
+ * Unregister the copy engine of a virtqueue.
+ *
+ * It fails as long as packets are in flight: the application must call
+ * rte_vhost_poll_enqueue_completed() until they are all returned.
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @return
+ *  0 on success, -1 on failure
+ */
+int rte_vhost_async_channel_unregister(int vid, uint16_t queue_id);
+
+/**
+ * Submit a burst of packets to the guest RX virtqueue through the copy
+ * engine registered on it.
+ *
+ * The packets accepted are owned by the vhost library until they are
+ * returned by rte_vhost_poll_enqueue_completed(). Like
+ * rte_vhost_enqueue_burst(), this function is not thread safe for a given
+ * virtqueue, and must be called from the same thread as
+ * rte_vhost_poll_enqueue_completed().
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param pkts
+ *  Packets to enqueue
+ * @param count
+ *  Number of packets to enqueue
+ * @return
+ *  Number of packets accepted
+ */
+uint16_t rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * Make the packets whose copies are done visible to the guest, and
+ * return them to the application in submission order.
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param pkts
+ *  Array to store the completed packets
+ * @param count
+ *  Size of the array
+ * @return
+ *  Number of packets returned
+ */
+uint16_t rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * Number of packets submitted on a virtqueue and not yet returned by
+ * rte_vhost_poll_enqueue_completed().
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @return
+ *  Number of in-flight packets, -1 on error
+ */
+int rte_vhost_async_get_inflight(int vid, uint16_t queue_id);
+
+struct rte_vhost_async_cpu_engine;
+
+/**
+ * Create the reference software copy engine. It starts a thread doing the
+ * copies submitted by any number of virtqueues.
+ *
+ * @param name
+ *  Engine name
+ * @param cpu
+ *  CPU the engine thread is pinned to, or -1 for no affinity
+ * @param ring_size
+ *  Maximum number of packets queued to the engine, must be a power of 2
+ * @return
+ *  The engine on success, NULL on failure
+ */
+struct rte_vhost_async_cpu_engine *
+rte_vhost_async_cpu_engine_create(const char *name, int cpu,
+		uint32_t ring_size);
+
+/**
+ * Stop the thread of a software copy engine and release it. No virtqueue
+ * must still be registered on it.
+ *
+ * @param engine
+ *  Engine to release
+ */
+void rte_vhost_async_cpu_engine_free(struct rte_vhost_async_cpu_engine *engine);
+
+/**
+ * Register a software copy engine on a virtqueue.
+ * See rte_vhost_async_channel_register().
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param threshold
+ *  Packets shorter than this many bytes are copied by the CPU inline
+ * @param engine
+ *  Software copy engine
+ * @return
+ *  0 on success, -1 on failure
+ */
+int rte_vhost_async_cpu_channel_register(int vid, uint16_t queue_id,
+		uint32_t threshold, struct rte_vhost_async_cpu_engine *engine);
+
+/**
+ * Unregister a software copy engine from a virtqueue.
+ * See rte_vhost_async_channel_unregister().
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @return
+ *  0 on success, -1 on failure
+ */
+int rte_vhost_async_cpu_channel_unregister(int vid, uint16_t queue_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_VHOST_ASYNC_H_ */
@@ -40,12 +40,14 @@
 #include <numaif.h>
 #endif
 
+#include <rte_cycles.h>
 #include <rte_ethdev.h>
 #include <rte_log.h>
 #include <rte_string_fns.h>
 #include <rte_memory.h>
 #include <rte_malloc.h>
 #include <rte_vhost.h>
+#include <rte_vhost_async.h>
 
 #include "vhost.h"
 
@@ -82,6 +84,10 @@ cleanup_device(struct virtio_net *dev, int destroy)
 {
 	uint32_t i;
 
+	/* the copy engine must be done with the guest memory first */
+	for (i = 0; i < dev->nr_vring; i++)
+		vhost_free_async_mem(dev, i);
+
 	vhost_backend_cleanup(dev);
 
 	for (i = 0; i < dev->nr_vring; i++)
@@ -101,6 +107,7 @@ free_device(struct virtio_net *dev)
 		vq = dev->virtqueue[i];
 
 		rte_free(vq->shadow_used_ring);
+		vhost_free_async_mem(dev, i);
 
 		rte_free(vq);
 	}
@@ -129,11 +136,13 @@ init_vring_queue(struct vhost_virtqueue *vq)
 }
 
 static void
-reset_vring_queue(struct vhost_virtqueue *vq)
+reset_vring_queue(struct virtio_net *dev, uint32_t vring_idx)
 {
+	struct vhost_virtqueue *vq = dev->virtqueue[vring_idx];
 	int callfd;
 
 	callfd = vq->callfd;
+	vhost_free_async_mem(dev, vring_idx);
 	init_vring_queue(vq);
 	vq->callfd = callfd;
 }
@@ -173,7 +182,7 @@ reset_device(struct virtio_net *dev)
 	dev->flags = 0;
 
 	for (i = 0; i < dev->nr_vring; i++)
-		reset_vring_queue(dev->virtqueue[i]);
+		reset_vring_queue(dev, i);
 }
 
 /*
@@ -475,3 +484,202 @@ rte_vhost_log_used_vring(int vid, uint16_t vring_idx,
 
 	vhost_log_used_vring(dev, vq, offset, len);
 }
+
+/*
+ * Wait for the copy engine to complete the packets still in flight on a
+ * virtqueue, and free them. The used ring is left alone: the queue is being
+ * stopped, and the guest gets these buffers back from the last used index.
+ * Returns the number of packets the engine did not complete in time.
+ */
+static uint16_t
+async_drain(struct virtio_net *dev, uint16_t queue_id)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[queue_id];
+	struct async_inflight_info *info;
+	uint16_t i, start, n_async = 0;
+	uint64_t deadline;
+	int32_t n_cpl;
+
+	start = vq->async_pkts_idx - vq->async_pkts_inflight_n;
+	for (i = 0; i < vq->async_pkts_inflight_n; i++)
+		n_async += vq->async_pkts_info[(start + i) &
+					       (vq->size - 1)].async;
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (vq->async_cpl_pending < n_async) {
+		n_cpl = vq->async_ops.check_completed_copies(dev->vid,
+				queue_id, vq->async_ctx,
+				n_async - vq->async_cpl_pending);
+		if (n_cpl > 0) {
+			vq->async_cpl_pending += n_cpl;
+			continue;
+		}
+		if (rte_get_timer_cycles() > deadline)
+			return vq->async_pkts_inflight_n;
+		rte_pause();
+	}
+
+	for (i = 0; i < vq->async_pkts_inflight_n; i++) {
+		info = &vq->async_pkts_info[(start + i) & (vq->size - 1)];
+		rte_pktmbuf_free(info->mbuf);
+	}
+	vq->async_pkts_inflight_n = 0;
+	vq->async_cpl_pending = 0;
+
+	return 0;
+}
+
+/*
+ * Free the asynchronous enqueue state of a virtqueue. It is kept, and
+ * leaked, when the copy engine does not complete the packets in flight,
+ * since it may still access them.
+ */
+int
+vhost_free_async_mem(struct virtio_net *dev, uint16_t queue_id)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[queue_id];
+
+	if (vq->async_pkts_inflight_n && async_drain(dev, queue_id)) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) %u packets stuck in flight on vq %u.\n",
+			dev->vid, vq->async_pkts_inflight_n, queue_id);
+		return -1;
+	}
+
+	rte_free(vq->async_pkts_info);
+	rte_free(vq->async_descs_ring);
+	rte_free(vq->async_segs);
+	rte_free(vq->async_descs);
+	rte_free(vq->async_pkts_map);
+
+	vq->async_pkts_info = NULL;
+	vq->async_descs_ring = NULL;
+	vq->async_segs = NULL;
+	vq->async_descs = NULL;
+	vq->async_pkts_map = NULL;
+	vq->async_registered = 0;
+
+	return 0;
+}
+
+int
+rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+		uint32_t threshold, struct rte_vhost_async_channel_ops *ops,
+		void *ctx)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+
+	if (dev == NULL || ops == NULL)
+		return -1;
+
+	if (ops->transfer_data == NULL ||
+			ops->check_completed_copies == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) missing copy engine callback.\n", vid);
+		return -1;
+	}
+
+	if (queue_id >= dev->nr_vring || (queue_id & 1)) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) invalid virtqueue idx %u for async enqueue.\n",
+			vid, queue_id);
+		return -1;
+	}
+
+	vq = dev->virtqueue[queue_id];
+	if (vq->async_registered) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) virtqueue %u already has a copy engine.\n",
+			vid, queue_id);
+		return -1;
+	}
+
+	if (vq->size == 0 || (vq->size & (vq->size - 1))) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) virtqueue %u is not ready.\n", vid, queue_id);
+		return -1;
+	}
+
+	vq->async_pkts_info = rte_zmalloc(NULL,
+			vq->size * sizeof(struct async_inflight_info),
+			RTE_CACHE_LINE_SIZE);
+	vq->async_descs_ring = rte_zmalloc(NULL,
+			vq->size * sizeof(struct vring_used_elem),
+			RTE_CACHE_LINE_SIZE);
+	vq->async_segs = rte_malloc(NULL,
+			VHOST_ASYNC_SEGS_MAX * sizeof(struct rte_vhost_async_seg),
+			RTE_CACHE_LINE_SIZE);
+	vq->async_descs = rte_malloc(NULL,
+			VHOST_ASYNC_BURST_MAX *
+			sizeof(struct rte_vhost_async_desc),
+			RTE_CACHE_LINE_SIZE);
+	vq->async_pkts_map = rte_malloc(NULL,
+			VHOST_ASYNC_BURST_MAX * sizeof(uint16_t),
+			RTE_CACHE_LINE_SIZE);
+	if (!vq->async_pkts_info || !vq->async_descs_ring ||
+			!vq->async_segs || !vq->async_descs ||
+			!vq->async_pkts_map) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) failed to allocate async memory for vq %u.\n",
+			vid, queue_id);
+		vhost_free_async_mem(dev, queue_id);
+		return -1;
+	}
+
+	vq->async_ops = *ops;
+	vq->async_ctx = ctx;
+	vq->async_threshold = threshold;
+	vq->async_pkts_idx = 0;
+	vq->async_pkts_inflight_n = 0;
+	vq->async_cpl_pending = 0;
+	/*
+	 * The asynchronous path reserves buffers from last_avail_idx for
+	 * both the mergeable and non mergeable cases.
+	 */
+	vq->last_avail_idx = vq->last_used_idx;
+	vq->async_registered = 1;
+
+	return 0;
+}
+
+int
+rte_vhost_async_channel_unregister(int vid, uint16_t queue_id)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+
+	if (dev == NULL || queue_id >= dev->nr_vring)
+		return -1;
+
+	vq = dev->virtqueue[queue_id];
+	if (!vq->async_registered)
+		return 0;
+
+	if (vq->async_pkts_inflight_n) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) %u packets still in flight on vq %u.\n",
+			vid, vq->async_pkts_inflight_n, queue_id);
+		return -1;
+	}
+
+	vhost_free_async_mem(dev, queue_id);
+
+	return 0;
+}
+
+int
+rte_vhost_async_get_inflight(int vid, uint16_t queue_id)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+
+	if (dev == NULL || queue_id >= dev->nr_vring)
+		return -1;
+
+	vq = dev->virtqueue[queue_id];
+	if (!vq->async_registered)
+		return 0;
+
+	return vq->async_pkts_inflight_n;
+}
@@ -47,6 +47,7 @@
 #include <rte_ether.h>
 
 #include "rte_vhost.h"
+#include "rte_vhost_async.h"
 
 /* Used to indicate that the device is running on a data core */
 #define VIRTIO_DEV_RUNNING 1
@@ -81,6 +82,43 @@ struct zcopy_mbuf {
 };
 TAILQ_HEAD(zcopy_mbuf_list, zcopy_mbuf);
 
+/* Maximum number of copies built for one asynchronous enqueue burst */
+#define VHOST_ASYNC_SEGS_MAX	1024
+/* Maximum number of packets in one asynchronous enqueue burst */
+#define VHOST_ASYNC_BURST_MAX	32
+
+/*
+ * Guest memory region last used for address translation on a virtqueue.
+ * An empty (zeroed) entry never matches.
+ */
+struct vhost_gpa_cache {
+	uint64_t gpa_start;
+	uint64_t size;
+	uint64_t hva_offset;	/* host virtual - guest physical address */
+};
+
+/*
+ * A packet in flight in the asynchronous enqueue path, and the number of
+ * used ring entries it consumes.
+ */
+struct async_inflight_info {
+	struct rte_mbuf *mbuf;
+	uint16_t descs;
+	uint16_t async;		/* copied by the engine, not by the CPU */
+};
+
+/*
+ * Dirty page log bits are accumulated per virtqueue, one log word per
+ * entry, and written back to the shared log once per burst.
+ */
+#define VHOST_LOG_CACHE_NR 32
+#define VHOST_LOG_CACHE_LOOKUP 4
+
+struct log_cache_entry {
+	uint32_t offset;	/* in unsigned long words */
+	unsigned long val;
+};
+
 /**
  * Structure contains variables relevant to RX/TX virtqueues.
  */
@@ -114,6 +152,31 @@ struct vhost_virtqueue {
 
 	struct vring_used_elem  *shadow_used_ring;
 	uint16_t                shadow_used_idx;
+
+	struct vhost_gpa_cache	gpa_cache;
+
+	struct log_cache_entry	log_cache[VHOST_LOG_CACHE_NR];
+	uint16_t		log_cache_nb_elem;
+	/* log generation the cached entries belong to */
+	uint32_t		log_cache_gen;
+
+	/* asynchronous enqueue */
+	int			async_registered;
+	uint32_t		async_threshold;
+	struct rte_vhost_async_channel_ops async_ops;
+	void			*async_ctx;
+	/* in-flight packets, in submission order */
+	struct async_inflight_info *async_pkts_info;
+	uint16_t		async_pkts_idx;
+	uint16_t		async_pkts_inflight_n;
+	/* completions reported by the engine and not consumed yet */
+	uint16_t		async_cpl_pending;
+	/* used ring entries of in-flight packets, indexed like the used ring */
+	struct vring_used_elem	*async_descs_ring;
+	/* per burst scratch */
+	struct rte_vhost_async_seg *async_segs;
+	struct rte_vhost_async_desc *async_descs;
+	uint16_t		*async_pkts_map;
 } __rte_cache_aligned;
 
 /* Old kernels have no such macros defined */
@@ -139,6 +202,13 @@ struct vhost_virtqueue {
  #define VIRTIO_F_VERSION_1 32
 #endif
 
+/*
+ * Define in-order descriptor completion for older kernels
+ */
+#ifndef VIRTIO_F_IN_ORDER
+ #define VIRTIO_F_IN_ORDER 35
+#endif
+
 #define VHOST_USER_F_PROTOCOL_FEATURES	30
 
 /* Features supported by this builtin vhost-user net driver. */
@@ -148,6 +218,7 @@ struct vhost_virtqueue {
 				(1ULL << VIRTIO_NET_F_GUEST_ANNOUNCE) | \
 				(1ULL << VIRTIO_NET_F_MQ)      | \
 				(1ULL << VIRTIO_F_VERSION_1)   | \
+				(1ULL << VIRTIO_F_IN_ORDER)    | \
 				(1ULL << VHOST_F_LOG_ALL)      | \
 				(1ULL << VHOST_USER_F_PROTOCOL_FEATURES) | \
 				(1ULL << VIRTIO_NET_F_HOST_TSO4) | \
@@ -188,6 +259,8 @@ struct virtio_net {
 	uint64_t		log_size;
 	uint64_t		log_base;
 	uint64_t		log_addr;
+	/* bumped by the control thread on every new log base */
+	volatile uint32_t	log_gen;
 	struct ether_addr	mac;
 	uint16_t		mtu;
 
@@ -204,7 +277,7 @@ struct virtio_net {
 static __rte_always_inline void
 vhost_log_page(uint8_t *log_base, uint64_t page)
 {
-	log_base[page / 8] |= 1 << (page % 8);
+	__sync_fetch_and_or(&log_base[page / 8], (uint8_t)(1 << (page % 8)));
 }
 
 static __rte_always_inline void
@@ -236,6 +309,124 @@ vhost_log_used_vring(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	vhost_log_write(dev, vq->log_guest_addr + offset, len);
 }
 
+/*
+ * Write the dirty bits cached on the virtqueue to the log, skipping the
+ * words past the end of the log.
+ */
+static __rte_always_inline void
+vhost_log_cache_flush(struct virtio_net *dev, struct vhost_virtqueue *vq)
+{
+	unsigned long *log_base = (unsigned long *)(uintptr_t)dev->log_base;
+	uint64_t nb_words = dev->log_size / sizeof(unsigned long);
+	uint16_t i;
+
+	/* To make sure guest memory updates are committed before logging */
+	rte_smp_wmb();
+
+	for (i = 0; i < vq->log_cache_nb_elem; i++) {
+		if (unlikely(vq->log_cache[i].offset >= nb_words))
+			continue;
+		__sync_fetch_and_or(&log_base[vq->log_cache[i].offset],
+				    vq->log_cache[i].val);
+	}
+
+	vq->log_cache_nb_elem = 0;
+}
+
+/*
+ * The cached dirty bits are guest page bits, so they still have to be
+ * logged when the log base changed since they were cached: they are
+ * written to the new log at once. The cache belongs to the data path
+ * thread of the virtqueue, so the control thread only bumps the generation
+ * and never touches the cache itself.
+ */
+static __rte_always_inline void
+vhost_log_cache_check_gen(struct virtio_net *dev, struct vhost_virtqueue *vq)
+{
+	uint32_t gen = dev->log_gen;
+
+	if (unlikely(vq->log_cache_gen != gen)) {
+		vq->log_cache_gen = gen;
+		/* Pairs with the barrier before the generation update */
+		rte_smp_rmb();
+		if (vq->log_cache_nb_elem != 0 && dev->log_base)
+			vhost_log_cache_flush(dev, vq);
+	}
+}
+
+/*
+ * Write the dirty bits cached on the virtqueue to the log. It must be
+ * called after the logged guest memory updates, and before the used index
+ * making them visible to the guest is updated.
+ */
+static __rte_always_inline void
+vhost_log_cache_sync(struct virtio_net *dev, struct vhost_virtqueue *vq)
+{
+	if (likely(((dev->features & (1ULL << VHOST_F_LOG_ALL)) == 0) ||
+		   !dev->log_base || vq->log_cache_nb_elem == 0))
+		return;
+
+	vhost_log_cache_check_gen(dev, vq);
+	vhost_log_cache_flush(dev, vq);
+}
+
+static __rte_always_inline void
+vhost_log_cache_page(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		     uint64_t page)
+{
+	uint32_t bit_nr = page % (sizeof(unsigned long) << 3);
+	uint32_t offset = page / (sizeof(unsigned long) << 3);
+	int i, last;
+
+	/*
+	 * Only the most recent entries are looked up: the buffers of a burst
+	 * are mostly contiguous, and a duplicated entry is harmless.
+	 */
+	last = RTE_MAX((int)vq->log_cache_nb_elem - VHOST_LOG_CACHE_LOOKUP, 0);
+	for (i = vq->log_cache_nb_elem - 1; i >= last; i--) {
+		if (vq->log_cache[i].offset == offset) {
+			vq->log_cache[i].val |= 1UL << bit_nr;
+			return;
+		}
+	}
+
+	if (unlikely(vq->log_cache_nb_elem == VHOST_LOG_CACHE_NR))
+		vhost_log_cache_sync(dev, vq);
+
+	vq->log_cache[vq->log_cache_nb_elem].offset = offset;
+	vq->log_cache[vq->log_cache_nb_elem].val = 1UL << bit_nr;
+	vq->log_cache_nb_elem++;
+}
+
+static __rte_always_inline void
+vhost_log_cache_write(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		      uint64_t addr, uint64_t len)
+{
+	uint64_t page;
+
+	if (likely(((dev->features & (1ULL << VHOST_F_LOG_ALL)) == 0) ||
+		   !dev->log_base || !len))
+		return;
+
+	if (unlikely(dev->log_size <= ((addr + len - 1) / VHOST_LOG_PAGE / 8)))
+		return;
+
+	vhost_log_cache_check_gen(dev, vq);
+
+	page = addr / VHOST_LOG_PAGE;
+	while (page * VHOST_LOG_PAGE < addr + len) {
+		vhost_log_cache_page(dev, vq, page);
+		page += 1;
+	}
+}
+
+static __rte_always_inline void
+vhost_log_cache_used_vring(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			   uint64_t offset, uint64_t len)
+{
+	vhost_log_cache_write(dev, vq, vq->log_guest_addr + offset, len);
+}
+
 /* Macros for printing using RTE_LOG */
 #define RTE_LOGTYPE_VHOST_CONFIG RTE_LOGTYPE_USER1
 #define RTE_LOGTYPE_VHOST_DATA   RTE_LOGTYPE_USER1
@@ -291,6 +482,50 @@ gpa_to_hpa(struct virtio_net *dev, uint64_t gpa, uint64_t size)
 	return 0;
 }
 
+/*
+ * Look a guest physical address up in the memory regions, which are sorted
+ * by guest physical address, and remember the region found in the cache.
+ */
+static inline uint64_t
+gpa_to_vva_lookup(struct rte_vhost_memory *mem, struct vhost_gpa_cache *cache,
+		  uint64_t gpa)
+{
+	struct rte_vhost_mem_region *reg;
+	uint32_t lo = 0, hi = mem->nregions, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		reg = &mem->regions[mid];
+
+		if (gpa < reg->guest_phys_addr) {
+			hi = mid;
+		} else if (gpa - reg->guest_phys_addr >= reg->size) {
+			lo = mid + 1;
+		} else {
+			cache->gpa_start = reg->guest_phys_addr;
+			cache->size = reg->size;
+			cache->hva_offset = reg->host_user_addr -
+					    reg->guest_phys_addr;
+			return gpa + cache->hva_offset;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Convert guest physical address to host virtual address, trying the
+ * region last hit on this virtqueue first.
+ */
+static __rte_always_inline uint64_t
+gpa_to_vva(struct virtio_net *dev, struct vhost_virtqueue *vq, uint64_t gpa)
+{
+	if (likely(gpa - vq->gpa_cache.gpa_start < vq->gpa_cache.size))
+		return gpa + vq->gpa_cache.hva_offset;
+
+	return gpa_to_vva_lookup(dev->mem, &vq->gpa_cache, gpa);
+}
+
 struct virtio_net *get_device(int vid);
 
 int vhost_new_device(void);
@@ -299,6 +534,7 @@ void reset_device(struct virtio_net *dev);
 void vhost_destroy_device(int);
 
 int alloc_vring_queue(struct virtio_net *dev, uint32_t vring_idx);
+int vhost_free_async_mem(struct virtio_net *dev, uint16_t queue_id);
 
 void vhost_set_ifname(int, const char *if_name, unsigned int if_len);
 void vhost_enable_dequeue_zero_copy(int vid);
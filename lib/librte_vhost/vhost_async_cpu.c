@@ -0,0 +1,298 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Reference software copy engine for the vhost asynchronous enqueue path:
+ * the copies are done by a dedicated thread, fed through a ring shared by
+ * all the virtqueues registered on the engine.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_ring.h>
+#include <rte_lcore.h>
+#include <rte_vhost_async.h>
+
+#include "vhost.h"
+
+/* Maximum number of copies of a packet handled by the engine */
+#define CPU_ENGINE_JOB_SEGS	16
+#define CPU_ENGINE_BURST	32
+
+struct cpu_channel;
+
+/* The copies of one packet */
+struct cpu_job {
+	struct cpu_channel *chan;
+	uint16_t nr_segs;
+	struct rte_vhost_async_seg segs[CPU_ENGINE_JOB_SEGS];
+};
+
+/* Engine state attached to a virtqueue */
+struct cpu_channel {
+	struct rte_vhost_async_cpu_engine *engine;
+	struct cpu_job *jobs;
+	uint16_t job_mask;
+	/* updated by the virtqueue owner */
+	uint16_t nr_submitted;
+	uint16_t nr_polled;
+	/* updated by the engine thread */
+	volatile uint16_t nr_done __rte_cache_aligned;
+};
+
+struct rte_vhost_async_cpu_engine {
+	struct rte_ring *ring;
+	pthread_t tid;
+	volatile int quit;
+};
+
+static void *
+cpu_engine_thread(void *arg)
+{
+	struct rte_vhost_async_cpu_engine *engine = arg;
+	struct cpu_job *jobs[CPU_ENGINE_BURST];
+	unsigned int i, n;
+	uint16_t j;
+
+	while (!engine->quit) {
+		n = rte_ring_sc_dequeue_burst(engine->ring, (void **)jobs,
+				CPU_ENGINE_BURST, NULL);
+		if (n == 0) {
+			rte_pause();
+			continue;
+		}
+
+		for (i = 0; i < n; i++) {
+			for (j = 0; j < jobs[i]->nr_segs; j++)
+				rte_memcpy(jobs[i]->segs[j].dst,
+					jobs[i]->segs[j].src,
+					jobs[i]->segs[j].len);
+		}
+
+		/* the data must be written before the jobs are seen done */
+		rte_smp_wmb();
+
+		/* jobs of a channel are dequeued in order */
+		for (i = 0; i < n; i++)
+			jobs[i]->chan->nr_done++;
+	}
+
+	return NULL;
+}
+
+static int32_t
+cpu_transfer_data(int vid __rte_unused, uint16_t queue_id __rte_unused,
+		void *ctx, struct rte_vhost_async_desc *descs, uint16_t count)
+{
+	struct cpu_channel *chan = ctx;
+	struct cpu_job *jobs[VHOST_ASYNC_BURST_MAX];
+	struct cpu_job *job;
+	uint16_t i;
+
+	count = RTE_MIN(count, VHOST_ASYNC_BURST_MAX);
+	for (i = 0; i < count; i++) {
+		if (descs[i].nr_segs > CPU_ENGINE_JOB_SEGS)
+			break;
+
+		job = &chan->jobs[(uint16_t)(chan->nr_submitted + i) &
+				  chan->job_mask];
+		job->nr_segs = descs[i].nr_segs;
+		rte_memcpy(job->segs, descs[i].segs,
+			descs[i].nr_segs * sizeof(struct rte_vhost_async_seg));
+		jobs[i] = job;
+	}
+
+	if (i == 0)
+		return 0;
+
+	i = rte_ring_mp_enqueue_burst(chan->engine->ring, (void **)jobs, i,
+			NULL);
+	chan->nr_submitted += i;
+
+	return i;
+}
+
+static int32_t
+cpu_check_completed_copies(int vid __rte_unused,
+		uint16_t queue_id __rte_unused, void *ctx, uint16_t max_packets)
+{
+	struct cpu_channel *chan = ctx;
+	uint16_t n;
+
+	n = (uint16_t)(chan->nr_done - chan->nr_polled);
+	n = RTE_MIN(n, max_packets);
+	chan->nr_polled += n;
+
+	return n;
+}
+
+static struct rte_vhost_async_channel_ops cpu_channel_ops = {
+	.transfer_data = cpu_transfer_data,
+	.check_completed_copies = cpu_check_completed_copies,
+};
+
+struct rte_vhost_async_cpu_engine *
+rte_vhost_async_cpu_engine_create(const char *name, int cpu,
+		uint32_t ring_size)
+{
+	struct rte_vhost_async_cpu_engine *engine;
+	cpu_set_t cpuset;
+	int ret;
+
+	if (name == NULL || !rte_is_power_of_2(ring_size)) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"invalid copy engine parameters.\n");
+		return NULL;
+	}
+
+	engine = rte_zmalloc(name, sizeof(*engine), RTE_CACHE_LINE_SIZE);
+	if (engine == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"failed to allocate copy engine %s.\n", name);
+		return NULL;
+	}
+
+	engine->ring = rte_ring_create(name, ring_size, SOCKET_ID_ANY,
+			RING_F_SC_DEQ);
+	if (engine->ring == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"failed to create ring of copy engine %s.\n", name);
+		rte_free(engine);
+		return NULL;
+	}
+
+	ret = pthread_create(&engine->tid, NULL, cpu_engine_thread, engine);
+	if (ret != 0) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"failed to create thread of copy engine %s.\n", name);
+		rte_ring_free(engine->ring);
+		rte_free(engine);
+		return NULL;
+	}
+
+	if (cpu >= 0) {
+		CPU_ZERO(&cpuset);
+		CPU_SET(cpu, &cpuset);
+		ret = pthread_setaffinity_np(engine->tid, sizeof(cpuset),
+				&cpuset);
+		if (ret != 0)
+			RTE_LOG(WARNING, VHOST_CONFIG,
+				"failed to pin copy engine %s to cpu %d.\n",
+				name, cpu);
+	}
+
+	rte_thread_setname(engine->tid, name);
+
+	return engine;
+}
+
+void
+rte_vhost_async_cpu_engine_free(struct rte_vhost_async_cpu_engine *engine)
+{
+	if (engine == NULL)
+		return;
+
+	engine->quit = 1;
+	pthread_join(engine->tid, NULL);
+
+	rte_ring_free(engine->ring);
+	rte_free(engine);
+}
+
+int
+rte_vhost_async_cpu_channel_register(int vid, uint16_t queue_id,
+		uint32_t threshold, struct rte_vhost_async_cpu_engine *engine)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct cpu_channel *chan;
+
+	if (dev == NULL || engine == NULL || queue_id >= dev->nr_vring)
+		return -1;
+
+	chan = rte_zmalloc(NULL, sizeof(*chan), RTE_CACHE_LINE_SIZE);
+	if (chan == NULL)
+		return -1;
+
+	/* a channel never has more packets in flight than its ring size */
+	chan->jobs = rte_malloc(NULL,
+			dev->virtqueue[queue_id]->size * sizeof(struct cpu_job),
+			RTE_CACHE_LINE_SIZE);
+	if (chan->jobs == NULL) {
+		rte_free(chan);
+		return -1;
+	}
+	chan->job_mask = dev->virtqueue[queue_id]->size - 1;
+	chan->engine = engine;
+
+	if (rte_vhost_async_channel_register(vid, queue_id, threshold,
+				&cpu_channel_ops, chan) < 0) {
+		rte_free(chan->jobs);
+		rte_free(chan);
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+rte_vhost_async_cpu_channel_unregister(int vid, uint16_t queue_id)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	struct cpu_channel *chan;
+
+	if (dev == NULL || queue_id >= dev->nr_vring)
+		return -1;
+
+	vq = dev->virtqueue[queue_id];
+	if (!vq->async_registered || vq->async_ops.transfer_data !=
+			cpu_channel_ops.transfer_data)
+		return -1;
+
+	chan = vq->async_ctx;
+	if (rte_vhost_async_channel_unregister(vid, queue_id) < 0)
+		return -1;
+
+	rte_free(chan->jobs);
+	rte_free(chan);
+
+	return 0;
+}
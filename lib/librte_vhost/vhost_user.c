@@ -492,6 +492,17 @@ dump_guest_pages(struct virtio_net *dev)
 #define dump_guest_pages(dev)
 #endif
 
+static int
+mem_region_cmp(const void *a, const void *b)
+{
+	const struct rte_vhost_mem_region *ra = a;
+	const struct rte_vhost_mem_region *rb = b;
+
+	if (ra->guest_phys_addr < rb->guest_phys_addr)
+		return -1;
+	return ra->guest_phys_addr > rb->guest_phys_addr;
+}
+
 static int
 vhost_user_set_mem_table(struct virtio_net *dev, struct VhostUserMsg *pmsg)
 {
@@ -510,6 +521,11 @@ vhost_user_set_mem_table(struct virtio_net *dev, struct VhostUserMsg *pmsg)
 		dev->mem = NULL;
 	}
 
+	/* the translations cached by the virtqueues are no longer valid */
+	for (i = 0; i < dev->nr_vring; i++)
+		memset(&dev->virtqueue[i]->gpa_cache, 0,
+		       sizeof(struct vhost_gpa_cache));
+
 	dev->nr_guest_pages = 0;
 	if (!dev->guest_pages) {
 		dev->max_guest_pages = 8;
@@ -591,6 +607,10 @@ vhost_user_set_mem_table(struct virtio_net *dev, struct VhostUserMsg *pmsg)
 			mmap_offset);
 	}
 
+	/* sorted regions allow a binary search on the translation miss path */
+	qsort(dev->mem->regions, dev->mem->nregions,
+	      sizeof(struct rte_vhost_mem_region), mem_region_cmp);
+
 	dump_guest_pages(dev);
 
 	return 0;
@@ -724,6 +744,7 @@ vhost_user_get_vring_base(struct virtio_net *dev,
 		free_zmbufs(vq);
 	rte_free(vq->shadow_used_ring);
 	vq->shadow_used_ring = NULL;
+	vhost_free_async_mem(dev, state->index);
 
 	return 0;
 }
@@ -807,6 +828,13 @@ vhost_user_set_log_base(struct virtio_net *dev, struct VhostUserMsg *msg)
 	dev->log_base = dev->log_addr + off;
 	dev->log_size = size;
 
+	/*
+	 * The data path writes the dirty bits it cached to the new log when
+	 * it sees the new generation.
+	 */
+	rte_smp_wmb();
+	dev->log_gen++;
+
 	return 0;
 }
 
@@ -40,6 +40,7 @@
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_vhost.h>
+#include <rte_vhost_async.h>
 #include <rte_tcp.h>
 #include <rte_udp.h>
 #include <rte_sctp.h>
@@ -62,7 +63,7 @@ do_flush_shadow_used_ring(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	rte_memcpy(&vq->used->ring[to],
 			&vq->shadow_used_ring[from],
 			size * sizeof(struct vring_used_elem));
-	vhost_log_used_vring(dev, vq,
+	vhost_log_cache_used_vring(dev, vq,
 			offsetof(struct vring_used, ring[to]),
 			size * sizeof(struct vring_used_elem));
 }
@@ -88,6 +89,8 @@ flush_shadow_used_ring(struct virtio_net *dev, struct vhost_virtqueue *vq)
 	}
 	vq->last_used_idx += vq->shadow_used_idx;
 
+	vhost_log_cache_sync(dev, vq);
+
 	rte_smp_wmb();
 
 	*(volatile uint16_t *)&vq->used->idx += vq->shadow_used_idx;
@@ -154,8 +157,9 @@ virtio_enqueue_offload(struct rte_mbuf *m_buf, struct virtio_net_hdr *net_hdr)
 }
 
 static __rte_always_inline int
-copy_mbuf_to_desc(struct virtio_net *dev, struct vring_desc *descs,
-		  struct rte_mbuf *m, uint16_t desc_idx, uint32_t size)
+copy_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		  struct vring_desc *descs, struct rte_mbuf *m,
+		  uint16_t desc_idx, uint32_t size)
 {
 	uint32_t desc_avail, desc_offset;
 	uint32_t mbuf_avail, mbuf_offset;
@@ -166,7 +170,7 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vring_desc *descs,
 	uint16_t nr_desc = 1;
 
 	desc = &descs[desc_idx];
-	desc_addr = rte_vhost_gpa_to_vva(dev->mem, desc->addr);
+	desc_addr = gpa_to_vva(dev, vq, desc->addr);
 	/*
 	 * Checking of 'desc_addr' placed outside of 'unlikely' macro to avoid
 	 * performance issue with some versions of gcc (4.8.4 and 5.3.0) which
@@ -178,7 +182,7 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vring_desc *descs,
 	rte_prefetch0((void *)(uintptr_t)desc_addr);
 
 	virtio_enqueue_offload(m, (struct virtio_net_hdr *)(uintptr_t)desc_addr);
-	vhost_log_write(dev, desc->addr, dev->vhost_hlen);
+	vhost_log_cache_write(dev, vq, desc->addr, dev->vhost_hlen);
 	PRINT_PACKET(dev, (uintptr_t)desc_addr, dev->vhost_hlen, 0);
 
 	desc_offset = dev->vhost_hlen;
@@ -205,7 +209,7 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vring_desc *descs,
 				return -1;
 
 			desc = &descs[desc->next];
-			desc_addr = rte_vhost_gpa_to_vva(dev->mem, desc->addr);
+			desc_addr = gpa_to_vva(dev, vq, desc->addr);
 			if (unlikely(!desc_addr))
 				return -1;
 
@@ -217,7 +221,8 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vring_desc *descs,
 		rte_memcpy((void *)((uintptr_t)(desc_addr + desc_offset)),
 			rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
 			cpy_len);
-		vhost_log_write(dev, desc->addr + desc_offset, cpy_len);
+		vhost_log_cache_write(dev, vq, desc->addr + desc_offset,
+				      cpy_len);
 		PRINT_PACKET(dev, (uintptr_t)(desc_addr + desc_offset),
 			     cpy_len, 0);
 
@@ -278,7 +283,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 		vq->used->ring[used_idx].id = desc_indexes[i];
 		vq->used->ring[used_idx].len = pkts[i]->pkt_len +
 					       dev->vhost_hlen;
-		vhost_log_used_vring(dev, vq,
+		vhost_log_cache_used_vring(dev, vq,
 			offsetof(struct vring_used, ring[used_idx]),
 			sizeof(vq->used->ring[used_idx]));
 	}
@@ -290,8 +295,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 
 		if (vq->desc[desc_idx].flags & VRING_DESC_F_INDIRECT) {
 			descs = (struct vring_desc *)(uintptr_t)
-				rte_vhost_gpa_to_vva(dev->mem,
-					vq->desc[desc_idx].addr);
+				gpa_to_vva(dev, vq, vq->desc[desc_idx].addr);
 			if (unlikely(!descs)) {
 				count = i;
 				break;
@@ -304,11 +308,11 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 			sz = vq->size;
 		}
 
-		err = copy_mbuf_to_desc(dev, descs, pkts[i], desc_idx, sz);
+		err = copy_mbuf_to_desc(dev, vq, descs, pkts[i], desc_idx, sz);
 		if (unlikely(err)) {
 			used_idx = (start_idx + i) & (vq->size - 1);
 			vq->used->ring[used_idx].len = dev->vhost_hlen;
-			vhost_log_used_vring(dev, vq,
+			vhost_log_cache_used_vring(dev, vq,
 				offsetof(struct vring_used, ring[used_idx]),
 				sizeof(vq->used->ring[used_idx]));
 		}
@@ -317,6 +321,8 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 			rte_prefetch0(&vq->desc[desc_indexes[i+1]]);
 	}
 
+	vhost_log_cache_sync(dev, vq);
+
 	rte_smp_wmb();
 
 	*(volatile uint16_t *)&vq->used->idx += count;
@@ -350,7 +356,7 @@ fill_vec_buf(struct virtio_net *dev, struct vhost_virtqueue *vq,
 
 	if (vq->desc[idx].flags & VRING_DESC_F_INDIRECT) {
 		descs = (struct vring_desc *)(uintptr_t)
-			rte_vhost_gpa_to_vva(dev->mem, vq->desc[idx].addr);
+			gpa_to_vva(dev, vq, vq->desc[idx].addr);
 		if (unlikely(!descs))
 			return -1;
 
@@ -425,8 +431,9 @@ reserve_avail_buf_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 }
 
 static __rte_always_inline int
-copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct rte_mbuf *m,
-			    struct buf_vector *buf_vec, uint16_t num_buffers)
+copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			    struct rte_mbuf *m, struct buf_vector *buf_vec,
+			    uint16_t num_buffers)
 {
 	uint32_t vec_idx = 0;
 	uint64_t desc_addr;
@@ -439,7 +446,7 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct rte_mbuf *m,
 	if (unlikely(m == NULL))
 		return -1;
 
-	desc_addr = rte_vhost_gpa_to_vva(dev->mem, buf_vec[vec_idx].buf_addr);
+	desc_addr = gpa_to_vva(dev, vq, buf_vec[vec_idx].buf_addr);
 	if (buf_vec[vec_idx].buf_len < dev->vhost_hlen || !desc_addr)
 		return -1;
 
@@ -460,7 +467,7 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct rte_mbuf *m,
 		/* done with current desc buf, get the next one */
 		if (desc_avail == 0) {
 			vec_idx++;
-			desc_addr = rte_vhost_gpa_to_vva(dev->mem,
+			desc_addr = gpa_to_vva(dev, vq,
 					buf_vec[vec_idx].buf_addr);
 			if (unlikely(!desc_addr))
 				return -1;
@@ -487,7 +494,8 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct rte_mbuf *m,
 			virtio_enqueue_offload(hdr_mbuf, &hdr->hdr);
 			ASSIGN_UNLESS_EQUAL(hdr->num_buffers, num_buffers);
 
-			vhost_log_write(dev, hdr_phys_addr, dev->vhost_hlen);
+			vhost_log_cache_write(dev, vq, hdr_phys_addr,
+					      dev->vhost_hlen);
 			PRINT_PACKET(dev, (uintptr_t)hdr_addr,
 				     dev->vhost_hlen, 0);
 
@@ -498,7 +506,8 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct rte_mbuf *m,
 		rte_memcpy((void *)((uintptr_t)(desc_addr + desc_offset)),
 			rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
 			cpy_len);
-		vhost_log_write(dev, buf_vec[vec_idx].buf_addr + desc_offset,
+		vhost_log_cache_write(dev, vq,
+			buf_vec[vec_idx].buf_addr + desc_offset,
 			cpy_len);
 		PRINT_PACKET(dev, (uintptr_t)(desc_addr + desc_offset),
 			cpy_len, 0);
@@ -558,7 +567,7 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 			dev->vid, vq->last_avail_idx,
 			vq->last_avail_idx + num_buffers);
 
-		if (copy_mbuf_to_desc_mergeable(dev, pkts[pkt_idx],
+		if (copy_mbuf_to_desc_mergeable(dev, vq, pkts[pkt_idx],
 						buf_vec, num_buffers) < 0) {
 			vq->shadow_used_idx -= num_buffers;
 			break;
@@ -591,12 +600,414 @@ rte_vhost_enqueue_burst(int vid, uint16_t queue_id,
 	if (!dev)
 		return 0;
 
+	if (unlikely(queue_id < dev->nr_vring &&
+			dev->virtqueue[queue_id]->async_registered)) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%d) %s: virtqueue %d has an async copy engine.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
 	if (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF))
 		return virtio_dev_merge_rx(dev, queue_id, pkts, count);
 	else
 		return virtio_dev_rx(dev, queue_id, pkts, count);
 }
 
+/*
+ * Write the virtio header of a packet and either copy its data into the
+ * guest buffers, or, when segs is not NULL, describe these copies in segs.
+ * Returns -1 when the buffers are not usable, -2 when segs is too short.
+ * Nothing is logged here: the dirty pages are logged when the packet is
+ * completed, see async_log_used_elem().
+ */
+static __rte_always_inline int
+async_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		   struct rte_mbuf *m, struct buf_vector *buf_vec, uint32_t nr_vec,
+		   uint16_t num_buffers, struct rte_vhost_async_seg *segs,
+		   uint32_t *nr_segs, uint32_t max_segs)
+{
+	uint32_t vec_idx = 0;
+	uint64_t desc_addr;
+	uint32_t mbuf_offset, mbuf_avail;
+	uint32_t desc_offset, desc_avail;
+	uint32_t cpy_len;
+	struct virtio_net_hdr_mrg_rxbuf *hdr;
+
+	desc_addr = gpa_to_vva(dev, vq, buf_vec[0].buf_addr);
+	if (buf_vec[0].buf_len < dev->vhost_hlen || !desc_addr)
+		return -1;
+
+	hdr = (struct virtio_net_hdr_mrg_rxbuf *)(uintptr_t)desc_addr;
+	virtio_enqueue_offload(m, &hdr->hdr);
+	if (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF))
+		ASSIGN_UNLESS_EQUAL(hdr->num_buffers, num_buffers);
+	PRINT_PACKET(dev, (uintptr_t)desc_addr, dev->vhost_hlen, 0);
+
+	desc_avail  = buf_vec[0].buf_len - dev->vhost_hlen;
+	desc_offset = dev->vhost_hlen;
+
+	mbuf_avail  = rte_pktmbuf_data_len(m);
+	mbuf_offset = 0;
+	while (mbuf_avail != 0 || m->next != NULL) {
+		/* done with current desc buf, get the next one */
+		if (desc_avail == 0) {
+			if (unlikely(++vec_idx >= nr_vec))
+				return -1;
+			desc_addr = gpa_to_vva(dev, vq,
+					buf_vec[vec_idx].buf_addr);
+			if (unlikely(!desc_addr))
+				return -1;
+
+			desc_offset = 0;
+			desc_avail  = buf_vec[vec_idx].buf_len;
+		}
+
+		/* done with current mbuf, get the next one */
+		if (mbuf_avail == 0) {
+			m = m->next;
+
+			mbuf_offset = 0;
+			mbuf_avail  = rte_pktmbuf_data_len(m);
+		}
+
+		cpy_len = RTE_MIN(desc_avail, mbuf_avail);
+		if (segs) {
+			if (unlikely(*nr_segs >= max_segs))
+				return -2;
+			segs[*nr_segs].src =
+				rte_pktmbuf_mtod_offset(m, void *, mbuf_offset);
+			segs[*nr_segs].dst =
+				(void *)((uintptr_t)(desc_addr + desc_offset));
+			segs[*nr_segs].len = cpy_len;
+			(*nr_segs)++;
+		} else {
+			rte_memcpy((void *)((uintptr_t)(desc_addr +
+							desc_offset)),
+				rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
+				cpy_len);
+			PRINT_PACKET(dev, (uintptr_t)(desc_addr + desc_offset),
+				cpy_len, 0);
+		}
+
+		mbuf_avail  -= cpy_len;
+		mbuf_offset += cpy_len;
+		desc_avail  -= cpy_len;
+		desc_offset += cpy_len;
+	}
+
+	return 0;
+}
+
+static __rte_always_inline void
+async_copy_segs(struct rte_vhost_async_desc *desc)
+{
+	uint16_t i;
+
+	for (i = 0; i < desc->nr_segs; i++)
+		rte_memcpy(desc->segs[i].dst, desc->segs[i].src,
+			desc->segs[i].len);
+}
+
+/*
+ * Log the guest buffers of a used ring entry of the asynchronous path, by
+ * walking its descriptor chain up to the written length. The guest does not
+ * touch the descriptors until the entry is used.
+ */
+static __rte_always_inline void
+async_log_used_elem(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		    const struct vring_used_elem *elem)
+{
+	struct vring_desc *descs = vq->desc;
+	uint32_t idx = elem->id;
+	uint32_t len = elem->len;
+	uint32_t part_len, nr_descs = 0;
+
+	if (unlikely(idx >= vq->size))
+		return;
+
+	if (vq->desc[idx].flags & VRING_DESC_F_INDIRECT) {
+		descs = (struct vring_desc *)(uintptr_t)
+			gpa_to_vva(dev, vq, vq->desc[idx].addr);
+		if (unlikely(!descs))
+			return;
+
+		idx = 0;
+	}
+
+	while (len != 0) {
+		if (unlikely(idx >= vq->size || nr_descs++ >= vq->size))
+			return;
+
+		part_len = RTE_MIN(descs[idx].len, len);
+		vhost_log_cache_write(dev, vq, descs[idx].addr, part_len);
+		len -= part_len;
+
+		if ((descs[idx].flags & VRING_DESC_F_NEXT) == 0)
+			break;
+
+		idx = descs[idx].next;
+	}
+}
+
+/* store the used entries of the burst until the packets are completed */
+static __rte_always_inline void
+async_store_used_ring(struct vhost_virtqueue *vq, uint16_t start_idx)
+{
+	uint16_t idx = start_idx & (vq->size - 1);
+	uint16_t size;
+
+	if (idx + vq->shadow_used_idx <= vq->size) {
+		rte_memcpy(&vq->async_descs_ring[idx], vq->shadow_used_ring,
+			vq->shadow_used_idx * sizeof(struct vring_used_elem));
+	} else {
+		size = vq->size - idx;
+		rte_memcpy(&vq->async_descs_ring[idx], vq->shadow_used_ring,
+			size * sizeof(struct vring_used_elem));
+		rte_memcpy(&vq->async_descs_ring[0],
+			&vq->shadow_used_ring[size],
+			(vq->shadow_used_idx - size) *
+			sizeof(struct vring_used_elem));
+	}
+}
+
+uint16_t
+rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	struct rte_vhost_async_desc *descs;
+	uint16_t avail_head, start_idx;
+	uint16_t num_buffers, head_idx, len;
+	uint32_t pkt_idx, nr_vec, nr_segs, seg_start;
+	uint16_t n_async = 0;
+	int32_t n_xfer;
+	int mergeable, use_async, ret;
+
+	if (!dev)
+		return 0;
+
+	LOG_DEBUG(VHOST_DATA, "(%d) %s\n", dev->vid, __func__);
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->nr_vring))) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+	if (unlikely(vq->enabled == 0 || !vq->async_registered))
+		return 0;
+
+	count = RTE_MIN(count, VHOST_ASYNC_BURST_MAX);
+	count = RTE_MIN(count, vq->size - vq->async_pkts_inflight_n);
+	if (count == 0)
+		return 0;
+
+	mergeable = !!(dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF));
+	descs = vq->async_descs;
+	nr_segs = 0;
+
+	rte_prefetch0(&vq->avail->ring[vq->last_avail_idx & (vq->size - 1)]);
+
+	vq->shadow_used_idx = 0;
+	start_idx = vq->last_avail_idx;
+	avail_head = *((volatile uint16_t *)&vq->avail->idx);
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		struct async_inflight_info *info;
+		uint32_t pkt_len = pkts[pkt_idx]->pkt_len + dev->vhost_hlen;
+
+		if (mergeable) {
+			if (unlikely(reserve_avail_buf_mergeable(dev, vq,
+						pkt_len, buf_vec, &num_buffers,
+						avail_head) < 0)) {
+				vq->shadow_used_idx -= num_buffers;
+				break;
+			}
+			nr_vec = BUF_VECTOR_MAX;
+		} else {
+			if (unlikely(vq->last_avail_idx == avail_head))
+				break;
+			nr_vec = 0;
+			if (unlikely(fill_vec_buf(dev, vq, vq->last_avail_idx,
+						&nr_vec, buf_vec, &head_idx,
+						&len) < 0))
+				break;
+			num_buffers = 1;
+			update_shadow_used_ring(vq, head_idx, pkt_len);
+		}
+
+		/* small packets are not worth an offload */
+		use_async = pkts[pkt_idx]->pkt_len >= vq->async_threshold;
+
+		seg_start = nr_segs;
+		ret = async_mbuf_to_desc(dev, vq, pkts[pkt_idx], buf_vec, nr_vec,
+				num_buffers,
+				use_async ? vq->async_segs : NULL, &nr_segs,
+				VHOST_ASYNC_SEGS_MAX);
+		if (unlikely(ret == -2)) {
+			/* out of segments for this burst: copy it inline */
+			nr_segs = seg_start;
+			use_async = 0;
+			ret = async_mbuf_to_desc(dev, vq, pkts[pkt_idx], buf_vec,
+					nr_vec, num_buffers, NULL, &nr_segs, 0);
+		}
+		if (unlikely(ret < 0)) {
+			nr_segs = seg_start;
+			if (mergeable) {
+				vq->shadow_used_idx -= num_buffers;
+				break;
+			}
+			/* as in the synchronous path, only the header is sent */
+			vq->shadow_used_ring[vq->shadow_used_idx - 1].len =
+				dev->vhost_hlen;
+			use_async = 0;
+		}
+
+		if (use_async) {
+			descs[n_async].segs = &vq->async_segs[seg_start];
+			descs[n_async].nr_segs = nr_segs - seg_start;
+			vq->async_pkts_map[n_async] = pkt_idx;
+			n_async++;
+		}
+
+		info = &vq->async_pkts_info[(vq->async_pkts_idx + pkt_idx) &
+					    (vq->size - 1)];
+		info->mbuf = pkts[pkt_idx];
+		info->descs = num_buffers;
+		info->async = use_async;
+
+		vq->last_avail_idx += num_buffers;
+	}
+
+	if (unlikely(pkt_idx == 0))
+		return 0;
+
+	if (n_async) {
+		n_xfer = vq->async_ops.transfer_data(dev->vid, queue_id,
+				vq->async_ctx, descs, n_async);
+		if (unlikely(n_xfer < 0))
+			n_xfer = 0;
+
+		/* the engine did not take them all, copy the rest inline */
+		while (n_xfer < n_async) {
+			async_copy_segs(&descs[n_xfer]);
+			vq->async_pkts_info[(vq->async_pkts_idx +
+					vq->async_pkts_map[n_xfer]) &
+					(vq->size - 1)].async = 0;
+			n_xfer++;
+		}
+	}
+
+	async_store_used_ring(vq, start_idx);
+	vq->async_pkts_idx += pkt_idx;
+	vq->async_pkts_inflight_n += pkt_idx;
+
+	return pkt_idx;
+}
+
+uint16_t
+rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	struct async_inflight_info *info;
+	uint16_t start, used_idx, n_pkts, n_descs, size, i;
+	int32_t n_cpl;
+
+	if (!dev)
+		return 0;
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->nr_vring))) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+	if (unlikely(!vq->async_registered || vq->async_pkts_inflight_n == 0))
+		return 0;
+
+	n_cpl = vq->async_ops.check_completed_copies(dev->vid, queue_id,
+			vq->async_ctx,
+			vq->async_pkts_inflight_n - vq->async_cpl_pending);
+	if (n_cpl > 0)
+		vq->async_cpl_pending += n_cpl;
+
+	/* completions are in order: stop at the first packet not done */
+	start = vq->async_pkts_idx - vq->async_pkts_inflight_n;
+	n_descs = 0;
+	for (n_pkts = 0; n_pkts < count &&
+			n_pkts < vq->async_pkts_inflight_n; n_pkts++) {
+		info = &vq->async_pkts_info[(start + n_pkts) & (vq->size - 1)];
+		if (info->async) {
+			if (vq->async_cpl_pending == 0)
+				break;
+			vq->async_cpl_pending--;
+		}
+		pkts[n_pkts] = info->mbuf;
+		n_descs += info->descs;
+	}
+
+	if (n_pkts == 0)
+		return 0;
+
+	/* make the copies done by the engine visible before the used ring */
+	rte_smp_rmb();
+
+	/* the data of these packets is written now, log it */
+	if (unlikely(dev->features & (1ULL << VHOST_F_LOG_ALL))) {
+		for (i = 0; i < n_descs; i++)
+			async_log_used_elem(dev, vq, &vq->async_descs_ring[
+				(vq->last_used_idx + i) & (vq->size - 1)]);
+	}
+
+	used_idx = vq->last_used_idx & (vq->size - 1);
+	if (used_idx + n_descs <= vq->size) {
+		rte_memcpy(&vq->used->ring[used_idx],
+			&vq->async_descs_ring[used_idx],
+			n_descs * sizeof(struct vring_used_elem));
+		vhost_log_cache_used_vring(dev, vq,
+			offsetof(struct vring_used, ring[used_idx]),
+			n_descs * sizeof(struct vring_used_elem));
+	} else {
+		size = vq->size - used_idx;
+		rte_memcpy(&vq->used->ring[used_idx],
+			&vq->async_descs_ring[used_idx],
+			size * sizeof(struct vring_used_elem));
+		vhost_log_cache_used_vring(dev, vq,
+			offsetof(struct vring_used, ring[used_idx]),
+			size * sizeof(struct vring_used_elem));
+		rte_memcpy(&vq->used->ring[0], &vq->async_descs_ring[0],
+			(n_descs - size) * sizeof(struct vring_used_elem));
+		vhost_log_cache_used_vring(dev, vq,
+			offsetof(struct vring_used, ring[0]),
+			(n_descs - size) * sizeof(struct vring_used_elem));
+	}
+	vq->last_used_idx += n_descs;
+	vq->async_pkts_inflight_n -= n_pkts;
+
+	vhost_log_cache_sync(dev, vq);
+
+	rte_smp_wmb();
+
+	*(volatile uint16_t *)&vq->used->idx += n_descs;
+	vhost_log_used_vring(dev, vq, offsetof(struct vring_used, idx),
+		sizeof(vq->used->idx));
+
+	/* flush used->idx update before we read avail->flags. */
+	rte_mb();
+
+	/* Kick the guest if necessary. */
+	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT)
+			&& (vq->callfd >= 0))
+		eventfd_write(vq->callfd, (eventfd_t)1);
+
+	return n_pkts;
+}
+
 static inline bool
 virtio_net_with_host_offload(struct virtio_net *dev)
 {
@@ -750,8 +1161,9 @@ put_zmbuf(struct zcopy_mbuf *zmbuf)
 }
 
 static __rte_always_inline int
-copy_desc_to_mbuf(struct virtio_net *dev, struct vring_desc *descs,
-		  uint16_t max_desc, struct rte_mbuf *m, uint16_t desc_idx,
+copy_desc_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		  struct vring_desc *descs, uint16_t max_desc,
+		  struct rte_mbuf *m, uint16_t desc_idx,
 		  struct rte_mempool *mbuf_pool)
 {
 	struct vring_desc *desc;
@@ -769,7 +1181,7 @@ copy_desc_to_mbuf(struct virtio_net *dev, struct vring_desc *descs,
 			(desc->flags & VRING_DESC_F_INDIRECT))
 		return -1;
 
-	desc_addr = rte_vhost_gpa_to_vva(dev->mem, desc->addr);
+	desc_addr = gpa_to_vva(dev, vq, desc->addr);
 	if (unlikely(!desc_addr))
 		return -1;
 
@@ -789,7 +1201,7 @@ copy_desc_to_mbuf(struct virtio_net *dev, struct vring_desc *descs,
 		if (unlikely(desc->flags & VRING_DESC_F_INDIRECT))
 			return -1;
 
-		desc_addr = rte_vhost_gpa_to_vva(dev->mem, desc->addr);
+		desc_addr = gpa_to_vva(dev, vq, desc->addr);
 		if (unlikely(!desc_addr))
 			return -1;
 
@@ -853,7 +1265,7 @@ copy_desc_to_mbuf(struct virtio_net *dev, struct vring_desc *descs,
 			if (unlikely(desc->flags & VRING_DESC_F_INDIRECT))
 				return -1;
 
-			desc_addr = rte_vhost_gpa_to_vva(dev->mem, desc->addr);
+			desc_addr = gpa_to_vva(dev, vq, desc->addr);
 			if (unlikely(!desc_addr))
 				return -1;
 
@@ -905,7 +1317,7 @@ update_used_ring(struct virtio_net *dev, struct vhost_virtqueue *vq,
 {
 	vq->used->ring[used_idx].id  = desc_idx;
 	vq->used->ring[used_idx].len = 0;
-	vhost_log_used_vring(dev, vq,
+	vhost_log_cache_used_vring(dev, vq,
 			offsetof(struct vring_used, ring[used_idx]),
 			sizeof(vq->used->ring[used_idx]));
 }
@@ -917,6 +1329,8 @@ update_used_idx(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	if (unlikely(count == 0))
 		return;
 
+	vhost_log_cache_sync(dev, vq);
+
 	rte_smp_wmb();
 	rte_smp_rmb();
 
@@ -985,6 +1399,7 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	uint32_t i = 0;
 	uint16_t free_entries;
 	uint16_t avail_idx;
+	int in_order;
 
 	dev = get_device(vid);
 	if (!dev)
@@ -1000,6 +1415,8 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	if (unlikely(vq->enabled == 0))
 		return 0;
 
+	in_order = !!(dev->features & (1ULL << VIRTIO_F_IN_ORDER));
+
 	if (unlikely(dev->dequeue_zero_copy)) {
 		struct zcopy_mbuf *zmbuf, *next;
 		int nr_updated = 0;
@@ -1083,7 +1500,7 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 		used_idx  = (vq->last_used_idx  + i) & (vq->size - 1);
 		desc_indexes[i] = vq->avail->ring[avail_idx];
 
-		if (likely(dev->dequeue_zero_copy == 0))
+		if (likely(dev->dequeue_zero_copy == 0) && !in_order)
 			update_used_ring(dev, vq, used_idx, desc_indexes[i]);
 	}
 
@@ -1099,7 +1516,7 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 
 		if (vq->desc[desc_indexes[i]].flags & VRING_DESC_F_INDIRECT) {
 			desc = (struct vring_desc *)(uintptr_t)
-				rte_vhost_gpa_to_vva(dev->mem,
+				gpa_to_vva(dev, vq,
 					vq->desc[desc_indexes[i]].addr);
 			if (unlikely(!desc))
 				break;
@@ -1120,7 +1537,8 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 			break;
 		}
 
-		err = copy_desc_to_mbuf(dev, desc, sz, pkts[i], idx, mbuf_pool);
+		err = copy_desc_to_mbuf(dev, vq, desc, sz, pkts[i], idx,
+					mbuf_pool);
 		if (unlikely(err)) {
 			rte_pktmbuf_free(pkts[i]);
 			break;
@@ -1152,6 +1570,15 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	vq->last_avail_idx += i;
 
 	if (likely(dev->dequeue_zero_copy == 0)) {
+		/*
+		 * With in-order completion, the used entry of the last
+		 * chain implicitly completes all the chains before it.
+		 */
+		if (in_order && i > 0) {
+			used_idx = (vq->last_used_idx + i - 1) & (vq->size - 1);
+			update_used_ring(dev, vq, used_idx,
+					 desc_indexes[i - 1]);
+		}
 		vq->last_used_idx += i;
 		update_used_idx(dev, vq, i);
 	}
@@ -75,7 +75,15 @@
 
 struct app_params app;
 
-static const char usage[] = "\n";
+static const char usage[] =
+	"\n"
+	"    -p PORTMASK: hexadecimal bitmask of ports to use\n"
+	"    -f US: max time (microseconds) a packet can wait in the worker\n"
+	"        output port buffer before being sent (default: 0 = no limit)\n"
+	"    -l: print the TX rate and the worker output port latency\n"
+	"        every second\n"
+	"    --PIPELINE_TYPE: pipeline type (e.g. --stub, --lpm)\n"
+	"\n";
 
 void
 app_print_usage(void)
@@ -118,6 +126,25 @@ app_parse_port_mask(const char *arg)
 	return 0;
 }
 
+/* Worker output port flush deadline, in microseconds */
+static int
+app_parse_tx_flush(const char *arg)
+{
+	char *end = NULL;
+	uint64_t tx_flush_us;
+
+	if (arg[0] == '\0')
+		return -1;
+
+	tx_flush_us = strtoull(arg, &end, 10);
+	if ((end == NULL) || (*end != '\0'))
+		return -2;
+
+	app.tx_flush_cycles = (tx_flush_us * rte_get_tsc_hz()) / 1000000;
+
+	return 0;
+}
+
 struct {
 	const char *name;
 	uint32_t value;
@@ -220,7 +247,7 @@ app_parse_args(int argc, char **argv)
 	app.pipeline_type = e_APP_PIPELINE_HASH_KEY16_LRU;
 	pipeline_type_provided = 0;
 
-	while ((opt = getopt_long(argc, argvopt, "p:",
+	while ((opt = getopt_long(argc, argvopt, "p:f:l",
 			lgopts, &option_index)) != EOF) {
 		switch (opt) {
 		case 'p':
@@ -230,6 +257,17 @@ app_parse_args(int argc, char **argv)
 			}
 			break;
 
+		case 'f':
+			if (app_parse_tx_flush(optarg) < 0) {
+				app_print_usage();
+				return -1;
+			}
+			break;
+
+		case 'l':
+			app.latency_enabled = 1;
+			break;
+
 		case 0: /* long options */
 			if (!pipeline_type_provided) {
 				uint32_t i;
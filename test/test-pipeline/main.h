@@ -34,6 +34,8 @@
 #ifndef _MAIN_H_
 #define _MAIN_H_
 
+#include <rte_port.h>
+
 #ifndef APP_MBUF_ARRAY_SIZE
 #define APP_MBUF_ARRAY_SIZE 256
 #endif
@@ -85,6 +87,16 @@ struct app_params {
 
 	/* App behavior */
 	uint32_t pipeline_type;
+
+	/* Worker output ports: flush deadline and latency histograms */
+	uint64_t tx_flush_cycles;
+	uint32_t latency_enabled;
+	struct rte_port_out_latency latency[APP_MAX_PORTS];
+
+	/* Latency histograms of the last period, published by the worker */
+	volatile uint32_t latency_seq;
+	uint64_t latency_tsc;
+	struct rte_port_out_latency latency_snapshot[APP_MAX_PORTS];
 } __rte_cache_aligned;
 
 extern struct app_params app;
@@ -141,6 +153,10 @@ void app_main_loop_worker_pipeline_lpm(void);
 void app_main_loop_worker_pipeline_lpm_ipv6(void);
 
 void app_main_loop_tx(void);
+void app_latency_publish(void);
+
+#define APP_STATS_PERIOD_US 1000000
+#define APP_STATS_CHECK_MASK 0xFFFF
 
 #define APP_FLUSH 0
 #ifndef APP_FLUSH
@@ -88,6 +88,9 @@ app_main_loop_worker_pipeline_stub(void) {
 		struct rte_port_ring_writer_params port_ring_params = {
 			.ring = app.rings_tx[i],
 			.tx_burst_sz = app.burst_size_worker_write,
+			.tx_flush_cycles = app.tx_flush_cycles,
+			.latency = app.latency_enabled ?
+				&app.latency[i] : NULL,
 		};
 
 		struct rte_pipeline_port_out_params port_params = {
@@ -150,15 +153,15 @@ app_main_loop_worker_pipeline_stub(void) {
 		rte_panic("Pipeline consistency check failed\n");
 
 	/* Run-time */
-#if APP_FLUSH == 0
-	for ( ; ; )
-		rte_pipeline_run(p);
-#else
 	for (i = 0; ; i++) {
 		rte_pipeline_run(p);
 
+#if APP_FLUSH != 0
 		if ((i & APP_FLUSH) == 0)
 			rte_pipeline_flush(p);
-	}
 #endif
+
+		if ((i & APP_STATS_CHECK_MASK) == 0)
+			app_latency_publish();
+	}
 }
@@ -137,16 +137,117 @@ app_main_loop_worker(void) {
 	}
 }
 
+/* Latency (in microseconds) below which the given share of packets fall */
+static double
+app_latency_percentile(struct rte_port_out_latency *latency,
+	uint64_t n_pkts, double share)
+{
+	uint64_t n = 0;
+	uint32_t i;
+
+	for (i = 0; i < RTE_PORT_OUT_LATENCY_HIST_SIZE - 1; i++) {
+		n += latency->n_pkts[i];
+		if (n >= share * n_pkts)
+			break;
+	}
+
+	return (double) (2LLU << i) * 1000000 / rte_get_tsc_hz();
+}
+
+static void
+app_print_stats(uint64_t *n_pkts, uint64_t cycles)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < app.n_ports; i++) {
+		struct rte_port_out_latency latency;
+		double mpps = (double) n_pkts[i] * rte_get_tsc_hz() /
+			cycles / 1000000;
+		uint64_t n = 0;
+		uint32_t seq;
+
+		/* Copy the histogram of the last period published by the worker */
+		do {
+			seq = app.latency_seq;
+			rte_smp_rmb();
+			latency = app.latency_snapshot[i];
+			rte_smp_rmb();
+		} while ((seq & 1) || (seq != app.latency_seq));
+
+		for (j = 0; j < RTE_PORT_OUT_LATENCY_HIST_SIZE; j++)
+			n += latency.n_pkts[j];
+
+		printf("Port %u: %.3f Mpps", app.ports[i], mpps);
+		if (n)
+			printf(", worker TX latency (us): "
+				"p50 < %.2f, p99 < %.2f, max %.2f",
+				app_latency_percentile(&latency, n, 0.5),
+				app_latency_percentile(&latency, n, 0.99),
+				(double) latency.max * 1000000 /
+					rte_get_tsc_hz());
+		printf("\n");
+
+		n_pkts[i] = 0;
+	}
+}
+
+/*
+ * Called by the worker: once per stats period, move the latency histograms
+ * of its output ports to the snapshot read by the TX core. The live
+ * histograms are only ever written by the worker.
+ */
 void
-app_main_loop_tx(void) {
+app_latency_publish(void)
+{
+	uint64_t tsc, stats_period;
 	uint32_t i;
 
+	if (app.latency_enabled == 0)
+		return;
+
+	tsc = rte_rdtsc();
+	stats_period = (rte_get_tsc_hz() * APP_STATS_PERIOD_US) / 1000000;
+	if (tsc - app.latency_tsc < stats_period)
+		return;
+	app.latency_tsc = tsc;
+
+	app.latency_seq++;
+	rte_smp_wmb();
+
+	for (i = 0; i < app.n_ports; i++) {
+		app.latency_snapshot[i] = app.latency[i];
+		memset(&app.latency[i], 0, sizeof(app.latency[i]));
+	}
+
+	rte_smp_wmb();
+	app.latency_seq++;
+}
+
+void
+app_main_loop_tx(void) {
+	uint64_t n_pkts_tx[APP_MAX_PORTS];
+	uint64_t stats_period, stats_tsc;
+	uint32_t i, j;
+
 	RTE_LOG(INFO, USER1, "Core %u is doing TX\n", rte_lcore_id());
 
-	for (i = 0; ; i = ((i + 1) & (app.n_ports - 1))) {
+	memset(n_pkts_tx, 0, sizeof(n_pkts_tx));
+	stats_period = (rte_get_tsc_hz() * APP_STATS_PERIOD_US) / 1000000;
+	stats_tsc = rte_rdtsc();
+
+	for (i = 0, j = 0; ; i = ((i + 1) & (app.n_ports - 1)), j++) {
 		uint16_t n_mbufs, n_pkts;
 		int ret;
 
+		if (app.latency_enabled && ((j & APP_STATS_CHECK_MASK) == 0)) {
+			uint64_t tsc = rte_rdtsc();
+
+			if (tsc - stats_tsc >= stats_period) {
+				app_print_stats(n_pkts_tx, tsc - stats_tsc);
+				stats_tsc = tsc;
+			}
+		}
+
 		n_mbufs = app.mbuf_tx[i].n_mbufs;
 
 		ret = rte_ring_sc_dequeue_bulk(
@@ -170,6 +271,7 @@ app_main_loop_tx(void) {
 			0,
 			app.mbuf_tx[i].array,
 			n_mbufs);
+		n_pkts_tx[i] += n_pkts;
 
 		if (n_pkts < n_mbufs) {
 			uint16_t k;
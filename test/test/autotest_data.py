@@ -233,6 +233,12 @@ def per_sockets(num):
                 "Func":    default_autotest,
                 "Report":  None,
             },
+            {
+                "Name":    "Service cores autotest",
+                "Command": "service_autotest",
+                "Func":    default_autotest,
+                "Report":  None,
+            },
             {
                 "Name":    "Ring autotest",
                 "Command": "ring_autotest",
@@ -35,6 +35,7 @@
 
 #include <rte_hexdump.h>
 #include <rte_malloc.h>
+#include <rte_mbuf.h>
 #include <rte_memcpy.h>
 #include <rte_net_crc.h>
 
@@ -44,6 +45,9 @@
 #define CRC16_VEC_LEN1     12
 #define CRC16_VEC_LEN2     2
 #define LINE_LEN           75
+#define CRC_CMP_MAX_LEN    9000
+#define CRC_MBUF_POOL_SIZE 64
+#define CRC_MBUF_SIZE      (512 + RTE_PKTMBUF_HEADROOM)
 
 /* CRC test vector */
 static const uint8_t crc_vec[CRC_VEC_LEN] = {
@@ -76,6 +80,18 @@ static const uint32_t crc32_vec2_res = 0xefaae02f;
 static const uint32_t crc16_vec_res = 0x6bec;
 static const uint16_t crc16_vec1_res = 0x8cdd;
 static const uint16_t crc16_vec2_res = 0xec5b;
+/* CRC32C check value of "123456789" */
+static const uint32_t crc32c_check_res = 0xe3069283;
+
+static const struct {
+	enum rte_net_crc_alg alg;
+	const char *name;
+} crc_algs[] = {
+	{ RTE_NET_CRC_SCALAR, "scalar" },
+	{ RTE_NET_CRC_SSE42, "x86_64_SSE4.2" },
+	{ RTE_NET_CRC_NEON, "arm64_NEON" },
+	{ RTE_NET_CRC_AVX512, "x86_64_AVX512" },
+};
 
 static int
 crc_calc(const uint8_t *vec,
@@ -149,6 +165,14 @@ test_crc_calc(void)
 		goto fail;
 	}
 
+	/* 32-bit Castagnoli CRC: Test 7 */
+	type = RTE_NET_CRC32C;
+	result = crc_calc((const uint8_t *)"123456789", 9, type);
+	if (result != crc32c_check_res) {
+		error = -7;
+		goto fail;
+	}
+
 	rte_free(test_data);
 	return 0;
 
@@ -157,25 +181,147 @@ test_crc_calc(void)
 	return error;
 }
 
+/* compare the selected algorithm with the scalar one over many lengths */
+static int
+test_crc_cmp_scalar(enum rte_net_crc_alg alg)
+{
+	static const enum rte_net_crc_type types[] = {
+		RTE_NET_CRC16_CCITT, RTE_NET_CRC32_ETH, RTE_NET_CRC32C,
+	};
+	uint32_t i, len, ref, result;
+	uint8_t *test_data;
+	int error = 0;
+
+	test_data = rte_malloc(NULL, CRC_CMP_MAX_LEN, 0);
+	if (test_data == NULL)
+		return -1;
+
+	srand(CRC_CMP_MAX_LEN);
+	for (i = 0; i < CRC_CMP_MAX_LEN; i++)
+		test_data[i] = rand();
+
+	for (i = 0; i < RTE_DIM(types); i++) {
+		for (len = 0; len <= CRC_CMP_MAX_LEN;
+				len += (len < 1100) ? 1 : 79) {
+			rte_net_crc_set_alg(RTE_NET_CRC_SCALAR);
+			ref = rte_net_crc_calc(test_data, len, types[i]);
+			rte_net_crc_set_alg(alg);
+			result = rte_net_crc_calc(test_data, len, types[i]);
+			if (result != ref) {
+				printf("type %d len %u: 0x%x != 0x%x\n",
+					types[i], len, result, ref);
+				error = -1;
+				goto out;
+			}
+		}
+	}
+
+out:
+	rte_free(test_data);
+	return error;
+}
+
+/* compare CRCs over segmented mbufs with CRCs over contiguous data */
+static int
+test_crc_mbuf(void)
+{
+	static const uint16_t seg_lens[] = { 1, 17, 0, 63, 256, 3, 500, 64 };
+	struct rte_mempool *pool;
+	struct rte_mbuf *m = NULL, *seg;
+	uint8_t *flat = NULL, *p;
+	uint32_t i, j, pkt_len = 0, off, len, ref, result;
+	int error = 0;
+
+	pool = rte_mempool_lookup("test_crc_pool");
+	if (pool == NULL)
+		pool = rte_pktmbuf_pool_create("test_crc_pool",
+			CRC_MBUF_POOL_SIZE, 0, 0, CRC_MBUF_SIZE,
+			SOCKET_ID_ANY);
+	if (pool == NULL)
+		return -1;
+
+	flat = rte_malloc(NULL, CRC_MBUF_POOL_SIZE * CRC_MBUF_SIZE, 0);
+	if (flat == NULL)
+		return -1;
+
+	srand(RTE_DIM(seg_lens));
+	for (i = 0; i < RTE_DIM(seg_lens); i++) {
+		seg = rte_pktmbuf_alloc(pool);
+		if (seg == NULL) {
+			error = -1;
+			goto out;
+		}
+		p = (uint8_t *)rte_pktmbuf_append(seg, seg_lens[i]);
+		for (j = 0; j < seg_lens[i]; j++) {
+			p[j] = rand();
+			flat[pkt_len + j] = p[j];
+		}
+		pkt_len += seg_lens[i];
+		if (m == NULL)
+			m = seg;
+		else if (rte_pktmbuf_chain(m, seg) < 0) {
+			rte_pktmbuf_free(seg);
+			error = -1;
+			goto out;
+		}
+	}
+
+	for (i = RTE_NET_CRC16_CCITT; i < RTE_NET_CRC_REQS; i++) {
+		for (off = 0; off <= pkt_len; off += 7) {
+			for (len = 0; off + len <= pkt_len; len += 13) {
+				ref = rte_net_crc_calc(flat + off, len, i);
+				result = rte_net_crc_calc_mbuf(m, off, len, i);
+				if (result != ref) {
+					printf("type %u off %u len %u: "
+						"0x%x != 0x%x\n",
+						i, off, len, result, ref);
+					error = -2;
+					goto out;
+				}
+			}
+		}
+	}
+
+	/* out of range request */
+	if (rte_net_crc_calc_mbuf(m, 1, pkt_len, RTE_NET_CRC32_ETH) != 0)
+		error = -3;
+
+out:
+	rte_pktmbuf_free(m);
+	rte_free(flat);
+	return error;
+}
+
 static int
 test_crc(void)
 {
+	unsigned int i;
 	int ret;
-	/* set CRC scalar mode */
-	rte_net_crc_set_alg(RTE_NET_CRC_SCALAR);
 
-	ret = test_crc_calc();
-	if (ret < 0) {
-		printf("test_crc (scalar): failed (%d)\n", ret);
-		return ret;
-	}
-	/* set CRC sse4.2 mode */
-	rte_net_crc_set_alg(RTE_NET_CRC_SSE42);
+	for (i = 0; i < RTE_DIM(crc_algs); i++) {
+		/* unsupported algorithms fall back to a supported one */
+		rte_net_crc_set_alg(crc_algs[i].alg);
+
+		ret = test_crc_calc();
+		if (ret < 0) {
+			printf("test_crc (%s): failed (%d)\n",
+				crc_algs[i].name, ret);
+			return ret;
+		}
+
+		ret = test_crc_mbuf();
+		if (ret < 0) {
+			printf("test_crc_mbuf (%s): failed (%d)\n",
+				crc_algs[i].name, ret);
+			return ret;
+		}
 
-	ret = test_crc_calc();
-	if (ret < 0) {
-		printf("test_crc (x86_64_SSE4.2): failed (%d)\n", ret);
-		return ret;
+		ret = test_crc_cmp_scalar(crc_algs[i].alg);
+		if (ret < 0) {
+			printf("test_crc_cmp_scalar (%s): failed (%d)\n",
+				crc_algs[i].name, ret);
+			return ret;
+		}
 	}
 
 	return 0;
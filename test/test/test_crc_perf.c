@@ -0,0 +1,122 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_net_crc.h>
+
+#include "test.h"
+
+#define CRC_PERF_MAX_LEN       9000
+#define CRC_PERF_BYTES         (4 * 1024 * 1024)
+
+static const uint32_t crc_perf_lens[] = {
+	64, 128, 256, 512, 1024, 1518, 2048, 4096, 9000
+};
+
+/*
+ * rte_net_crc_set_alg() falls back to a supported algorithm, so on CPUs
+ * (or builds) without AVX-512 or NEON those rows show the fallback speed.
+ */
+static const struct {
+	enum rte_net_crc_alg alg;
+	const char *name;
+} crc_perf_algs[] = {
+	{ RTE_NET_CRC_SCALAR, "scalar" },
+	{ RTE_NET_CRC_SSE42, "sse42" },
+	{ RTE_NET_CRC_AVX512, "avx512" },
+	{ RTE_NET_CRC_NEON, "neon" },
+};
+
+static const struct {
+	enum rte_net_crc_type type;
+	const char *name;
+} crc_perf_types[] = {
+	{ RTE_NET_CRC16_CCITT, "crc16_ccitt" },
+	{ RTE_NET_CRC32_ETH, "crc32_eth" },
+	{ RTE_NET_CRC32C, "crc32c" },
+};
+
+static int
+test_crc_perf(void)
+{
+	unsigned int a, t, l, i, iter;
+	volatile uint32_t result = 0;
+	uint64_t start, cycles;
+	uint8_t *data;
+
+	data = rte_malloc(NULL, CRC_PERF_MAX_LEN, RTE_CACHE_LINE_SIZE);
+	if (data == NULL) {
+		printf("cannot allocate test data\n");
+		return -1;
+	}
+	for (i = 0; i < CRC_PERF_MAX_LEN; i++)
+		data[i] = rand();
+
+	printf("%-8s %-12s", "alg", "type");
+	for (l = 0; l < RTE_DIM(crc_perf_lens); l++)
+		printf(" %6u", crc_perf_lens[l]);
+	printf("  (bytes/cycle)\n");
+
+	for (a = 0; a < RTE_DIM(crc_perf_algs); a++) {
+		rte_net_crc_set_alg(crc_perf_algs[a].alg);
+		for (t = 0; t < RTE_DIM(crc_perf_types); t++) {
+			printf("%-8s %-12s", crc_perf_algs[a].name,
+				crc_perf_types[t].name);
+			for (l = 0; l < RTE_DIM(crc_perf_lens); l++) {
+				iter = CRC_PERF_BYTES / crc_perf_lens[l];
+
+				start = rte_rdtsc();
+				for (i = 0; i < iter; i++)
+					result += rte_net_crc_calc(data,
+						crc_perf_lens[l],
+						crc_perf_types[t].type);
+				cycles = rte_rdtsc() - start;
+
+				printf(" %6.2f", (double)iter *
+					crc_perf_lens[l] / cycles);
+			}
+			printf("\n");
+		}
+	}
+
+	rte_free(data);
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(crc_perf_autotest, test_crc_perf);
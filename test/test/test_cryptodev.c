@@ -35,6 +35,7 @@
 #include <rte_mbuf.h>
 #include <rte_malloc.h>
 #include <rte_memcpy.h>
+#include <rte_launch.h>
 
 #include <rte_crypto.h>
 #include <rte_cryptodev.h>
@@ -5115,6 +5116,116 @@ test_mb_AES_GCM_authenticated_encryption(const struct gcm_test_data *tdata)
 
 }
 
+/*
+ * Run a GCM vector through the synchronous CPU crypto API, splitting the
+ * payload over two buffers, then decrypt it back and check that a corrupted
+ * tag is reported.
+ */
+static int
+test_AES_GCM_cpu_crypto(const struct gcm_test_data *tdata)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct crypto_unittest_params *ut_params = &unittest_params;
+	uint8_t dev_id = ts_params->valid_devs[0];
+	uint8_t buf[tdata->plaintext.len + 1];
+	uint8_t iv[16], digest[16];
+	struct rte_crypto_vec data[2];
+	struct rte_crypto_sgl sgl = { .vec = data, .num = 2 };
+	void *iv_ptr = iv, *aad_ptr = tdata->aad.data, *digest_ptr = digest;
+	int32_t status;
+	struct rte_crypto_sym_vec vec = {
+		.sgl = &sgl,
+		.iv = &iv_ptr,
+		.aad = &aad_ptr,
+		.digest = &digest_ptr,
+		.status = &status,
+		.num = 1,
+	};
+	union rte_crypto_sym_ofs ofs = { .raw = 0 };
+	uint32_t split = tdata->plaintext.len / 3;
+
+	data[0].base = buf;
+	data[0].len = split;
+	data[1].base = buf + split;
+	data[1].len = tdata->plaintext.len - split;
+
+	/* Encrypt */
+	TEST_ASSERT_SUCCESS(create_gcm_session(dev_id,
+			RTE_CRYPTO_CIPHER_OP_ENCRYPT,
+			tdata->key.data, tdata->key.len,
+			tdata->aad.len, tdata->auth_tag.len,
+			RTE_CRYPTO_AUTH_OP_GENERATE),
+			"Failed to create encryption session");
+
+	memcpy(buf, tdata->plaintext.data, tdata->plaintext.len);
+	memcpy(iv, tdata->iv.data, tdata->iv.len);
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_sym_cpu_crypto_process(dev_id,
+			ut_params->sess, ofs, &vec), 1,
+			"CPU crypto encryption failed, status %d", status);
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(buf, tdata->ciphertext.data,
+			tdata->ciphertext.len,
+			"GCM Ciphertext data not as expected");
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(digest, tdata->auth_tag.data,
+			tdata->auth_tag.len,
+			"GCM Generated auth tag not as expected");
+
+	rte_cryptodev_sym_session_free(dev_id, ut_params->sess);
+	ut_params->sess = NULL;
+
+	/* Decrypt and verify */
+	TEST_ASSERT_SUCCESS(create_gcm_session(dev_id,
+			RTE_CRYPTO_CIPHER_OP_DECRYPT,
+			tdata->key.data, tdata->key.len,
+			tdata->aad.len, tdata->auth_tag.len,
+			RTE_CRYPTO_AUTH_OP_VERIFY),
+			"Failed to create decryption session");
+
+	memcpy(iv, tdata->iv.data, tdata->iv.len);
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_sym_cpu_crypto_process(dev_id,
+			ut_params->sess, ofs, &vec), 1,
+			"CPU crypto decryption failed, status %d", status);
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(buf, tdata->plaintext.data,
+			tdata->plaintext.len,
+			"GCM plaintext data not as expected");
+
+	/* A corrupted tag must be reported per packet */
+	memcpy(buf, tdata->ciphertext.data, tdata->ciphertext.len);
+	memcpy(iv, tdata->iv.data, tdata->iv.len);
+	digest[0] ^= 0xff;
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_sym_cpu_crypto_process(dev_id,
+			ut_params->sess, ofs, &vec), 0,
+			"Corrupted tag not detected");
+	TEST_ASSERT_EQUAL(status, EBADMSG, "Unexpected status %d", status);
+
+	return 0;
+}
+
+static int
+test_AES_GCM_cpu_crypto_all(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	const struct gcm_test_data *tdata[] = {
+		&gcm_test_case_2, &gcm_test_case_3, &gcm_test_case_4,
+		&gcm_test_case_5, &gcm_test_case_6, &gcm_test_case_7,
+		&gcm_test_case_256_2, &gcm_test_case_256_5,
+	};
+	struct rte_cryptodev_info info;
+	unsigned int i;
+
+	rte_cryptodev_info_get(ts_params->valid_devs[0], &info);
+	if (!(info.feature_flags & RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO))
+		return -ENOTSUP;
+
+	for (i = 0; i < RTE_DIM(tdata); i++)
+		TEST_ASSERT_SUCCESS(test_AES_GCM_cpu_crypto(tdata[i]),
+				"CPU crypto GCM test vector %u failed", i);
+
+	return 0;
+}
+
 static int
 test_mb_AES_GCM_authenticated_encryption_test_case_1(void)
 {
@@ -6738,6 +6849,108 @@ test_AES_GMAC_authentication_verify_test_case_4(void)
 	return test_AES_GMAC_authentication_verify(&gmac_test_case_4);
 }
 
+/*
+ * Run a GMAC vector through the synchronous CPU crypto API, splitting the
+ * authenticated data over two buffers, then verify the tag and check that
+ * the data is left untouched and a corrupted tag is reported.
+ */
+static int
+test_AES_GMAC_cpu_crypto(const struct gmac_test_data *tdata)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct crypto_unittest_params *ut_params = &unittest_params;
+	uint8_t dev_id = ts_params->valid_devs[0];
+	uint8_t buf[tdata->aad.len + 1];
+	uint8_t iv[16], digest[16];
+	struct rte_crypto_vec data[2];
+	struct rte_crypto_sgl sgl = { .vec = data, .num = 2 };
+	void *iv_ptr = iv, *aad_ptr = NULL, *digest_ptr = digest;
+	int32_t status;
+	struct rte_crypto_sym_vec vec = {
+		.sgl = &sgl,
+		.iv = &iv_ptr,
+		.aad = &aad_ptr,
+		.digest = &digest_ptr,
+		.status = &status,
+		.num = 1,
+	};
+	union rte_crypto_sym_ofs ofs = { .raw = 0 };
+	uint32_t split = tdata->aad.len / 3;
+
+	data[0].base = buf;
+	data[0].len = split;
+	data[1].base = buf + split;
+	data[1].len = tdata->aad.len - split;
+
+	/* Generate */
+	TEST_ASSERT_SUCCESS(create_gmac_session(dev_id,
+			RTE_CRYPTO_CIPHER_OP_ENCRYPT, tdata,
+			RTE_CRYPTO_AUTH_OP_GENERATE),
+			"Failed to create generate session");
+
+	memcpy(buf, tdata->aad.data, tdata->aad.len);
+	memcpy(iv, tdata->iv.data, tdata->iv.len);
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_sym_cpu_crypto_process(dev_id,
+			ut_params->sess, ofs, &vec), 1,
+			"CPU crypto GMAC generation failed, status %d", status);
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(buf, tdata->aad.data, tdata->aad.len,
+			"GMAC authenticated data was modified");
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(digest, tdata->gmac_tag.data,
+			tdata->gmac_tag.len,
+			"GMAC Generated auth tag not as expected");
+
+	rte_cryptodev_sym_session_free(dev_id, ut_params->sess);
+	ut_params->sess = NULL;
+
+	/* Verify */
+	TEST_ASSERT_SUCCESS(create_gmac_session(dev_id,
+			RTE_CRYPTO_CIPHER_OP_DECRYPT, tdata,
+			RTE_CRYPTO_AUTH_OP_VERIFY),
+			"Failed to create verify session");
+
+	memcpy(iv, tdata->iv.data, tdata->iv.len);
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_sym_cpu_crypto_process(dev_id,
+			ut_params->sess, ofs, &vec), 1,
+			"CPU crypto GMAC verification failed, status %d",
+			status);
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(buf, tdata->aad.data, tdata->aad.len,
+			"GMAC authenticated data was modified");
+
+	/* A corrupted tag must be reported per packet */
+	memcpy(iv, tdata->iv.data, tdata->iv.len);
+	digest[0] ^= 0xff;
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_sym_cpu_crypto_process(dev_id,
+			ut_params->sess, ofs, &vec), 0,
+			"Corrupted tag not detected");
+	TEST_ASSERT_EQUAL(status, EBADMSG, "Unexpected status %d", status);
+
+	return 0;
+}
+
+static int
+test_AES_GMAC_cpu_crypto_all(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	const struct gmac_test_data *tdata[] = {
+		&gmac_test_case_1, &gmac_test_case_2, &gmac_test_case_3,
+	};
+	struct rte_cryptodev_info info;
+	unsigned int i;
+
+	rte_cryptodev_info_get(ts_params->valid_devs[0], &info);
+	if (!(info.feature_flags & RTE_CRYPTODEV_FF_SYM_CPU_CRYPTO))
+		return -ENOTSUP;
+
+	for (i = 0; i < RTE_DIM(tdata); i++)
+		TEST_ASSERT_SUCCESS(test_AES_GMAC_cpu_crypto(tdata[i]),
+				"CPU crypto GMAC test vector %u failed", i);
+
+	return 0;
+}
+
 struct test_crypto_vector {
 	enum rte_crypto_cipher_algorithm crypto_algo;
 
@@ -7908,6 +8121,100 @@ test_scheduler_mode_op(void)
 	return 0;
 }
 
+static int
+test_scheduler_mode_multicore_op(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	uint8_t sched_id = ts_params->valid_devs[0];
+	unsigned int lcores[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	unsigned int lcore_id, nb_lcores = 0;
+	int ret;
+
+	/* one worker lcore per attached slave, as available */
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (nb_lcores == RTE_DIM(aesni_ids))
+			break;
+		if (rte_eal_get_lcore_state(lcore_id) == WAIT)
+			lcores[nb_lcores++] = lcore_id;
+	}
+
+	if (nb_lcores == 0) {
+		printf("No free slave lcore, multi-core mode not tested\n");
+		return TEST_SUCCESS;
+	}
+
+	TEST_ASSERT(rte_cryptodev_scheduler_worker_cores_set(sched_id,
+			lcores, RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES + 1) ==
+			-EINVAL, "Too many worker lcores accepted");
+
+	ret = rte_cryptodev_scheduler_worker_cores_set(sched_id, lcores,
+			nb_lcores);
+	TEST_ASSERT(ret == 0,
+		"Failed to set worker lcores of cdev %u", sched_id);
+	TEST_ASSERT(rte_cryptodev_scheduler_worker_cores_get(sched_id,
+			lcores) == (int)nb_lcores,
+			"Number of worker lcores not match");
+
+	ret = rte_cryptodev_scheduler_mode_set(sched_id,
+			CDEV_SCHED_MODE_MULTICORE);
+	TEST_ASSERT(ret == 0,
+		"Failed to set cdev %u to multi-core mode", sched_id);
+	TEST_ASSERT(rte_cryptodev_scheduler_mode_get(sched_id) ==
+			CDEV_SCHED_MODE_MULTICORE, "Scheduling Mode "
+					"not match");
+
+	return 0;
+}
+
+static volatile int sched_busy_release;
+
+static int
+test_scheduler_busy_lcore(__rte_unused void *arg)
+{
+	while (!sched_busy_release)
+		rte_pause();
+
+	return 0;
+}
+
+static int
+test_scheduler_multicore_start_fail(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	uint8_t sched_id = ts_params->valid_devs[0];
+	unsigned int lcores[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	int ret;
+
+	if (rte_cryptodev_scheduler_mode_get(sched_id) !=
+			CDEV_SCHED_MODE_MULTICORE) {
+		printf("Multi-core mode not set, start failure not tested\n");
+		return TEST_SUCCESS;
+	}
+
+	TEST_ASSERT(rte_cryptodev_scheduler_worker_cores_get(sched_id,
+			lcores) > 0, "No worker lcore");
+
+	/* ut_setup() started the device */
+	rte_cryptodev_stop(sched_id);
+
+	/* a busy worker lcore fails the start once the slaves are started */
+	sched_busy_release = 0;
+	TEST_ASSERT_SUCCESS(rte_eal_remote_launch(test_scheduler_busy_lcore,
+			NULL, lcores[0]),
+			"Cannot launch a job on lcore %u", lcores[0]);
+	ret = rte_cryptodev_start(sched_id);
+	sched_busy_release = 1;
+	rte_eal_wait_lcore(lcores[0]);
+	TEST_ASSERT(ret < 0, "Scheduler started with a busy worker lcore");
+
+	/* the slaves were stopped and detached again, so a retry works */
+	TEST_ASSERT_SUCCESS(rte_cryptodev_start(sched_id),
+			"Failed to start cdev %u after a failed start",
+			sched_id);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite cryptodev_scheduler_testsuite  = {
 	.suite_name = "Crypto Device Scheduler Unit Test Suite",
 	.setup = testsuite_setup,
@@ -7921,6 +8228,13 @@ static struct unit_test_suite cryptodev_scheduler_testsuite  = {
 				test_AES_cipheronly_scheduler_all),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 				test_authonly_scheduler_all),
+		TEST_CASE_ST(NULL, NULL, test_scheduler_mode_multicore_op),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_scheduler_multicore_start_fail),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_AES_chain_scheduler_all),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_AES_cipheronly_scheduler_all),
 		TEST_CASE_ST(NULL, NULL, test_scheduler_detach_slave_op),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
@@ -8181,6 +8495,14 @@ static struct unit_test_suite cryptodev_openssl_testsuite  = {
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_mb_AES_GCM_authenticated_encryption_test_case_7),
 
+		/** AES GCM synchronous CPU crypto */
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_AES_GCM_cpu_crypto_all),
+
+		/** AES GMAC synchronous CPU crypto */
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_AES_GMAC_cpu_crypto_all),
+
 		/** AES GCM Authenticated Decryption */
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_mb_AES_GCM_authenticated_decryption_test_case_1),
@@ -8258,6 +8580,10 @@ static struct unit_test_suite cryptodev_aesni_gcm_testsuite  = {
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_mb_AES_GCM_authenticated_encryption_test_case_7),
 
+		/** AES GCM synchronous CPU crypto */
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_AES_GCM_cpu_crypto_all),
+
 		/** AES GCM Authenticated Decryption */
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_mb_AES_GCM_authenticated_decryption_test_case_1),
@@ -0,0 +1,633 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_mbuf.h>
+#include <rte_dev.h>
+#include <rte_crypto.h>
+#include <rte_cryptodev.h>
+#include <rte_eventdev.h>
+#include <rte_event_crypto_adapter.h>
+
+#include "test.h"
+
+#define CA_TEST_EVDEV_NAME     "event_sw0"
+#define CA_TEST_ID             0
+#define CA_TEST_APP_PORT       0
+#define CA_TEST_POOL_SIZE      1023
+#define CA_TEST_MBUF_SIZE      (256 + RTE_PKTMBUF_HEADROOM)
+#define CA_TEST_QP_DESC        256
+#define CA_TEST_NB_SESSIONS    8
+#define CA_TEST_NUM_OPS        128
+#define CA_TEST_NUM_FLOWS      4
+#define CA_TEST_EV_BURST       16U
+#define CA_TEST_DATA_LEN       64
+#define CA_TEST_MAX_LOOPS      100000
+
+/* private data of the crypto ops */
+struct ca_test_op_priv {
+	union rte_event_crypto_metadata md;
+	uint8_t iv[16];
+};
+
+/* crypto devices the adapter is tested with */
+static const struct ca_test_dev {
+	const char *name;
+	enum rte_crypto_cipher_algorithm algo;
+} test_devs[] = {
+#ifdef RTE_LIBRTE_PMD_NULL_CRYPTO
+	{ RTE_STR(CRYPTODEV_NAME_NULL_PMD), RTE_CRYPTO_CIPHER_NULL },
+#endif
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+	{ RTE_STR(CRYPTODEV_NAME_OPENSSL_PMD), RTE_CRYPTO_CIPHER_AES_CBC },
+#endif
+};
+
+static const char * const mode_names[] = {
+	[RTE_EVENT_CRYPTO_ADAPTER_OP_NEW] = "OP_NEW",
+	[RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD] = "OP_FORWARD",
+};
+
+static struct rte_mempool *mbuf_pool;
+static struct rte_mempool *cop_pool;
+static uint8_t evdev;
+
+static uint8_t cipher_key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+static int
+pools_setup(void)
+{
+	mbuf_pool = rte_mempool_lookup("ca_test_mbuf_pool");
+	if (mbuf_pool == NULL)
+		mbuf_pool = rte_pktmbuf_pool_create("ca_test_mbuf_pool",
+			CA_TEST_POOL_SIZE, 0, 0, CA_TEST_MBUF_SIZE,
+			SOCKET_ID_ANY);
+	cop_pool = rte_mempool_lookup("ca_test_cop_pool");
+	if (cop_pool == NULL)
+		cop_pool = rte_crypto_op_pool_create("ca_test_cop_pool",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, CA_TEST_POOL_SIZE, 0,
+			sizeof(struct ca_test_op_priv), SOCKET_ID_ANY);
+	if (mbuf_pool == NULL || cop_pool == NULL) {
+		printf("Cannot create pools\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+cdev_setup(const char *name)
+{
+	struct rte_cryptodev_config conf = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_queue_pairs = 1,
+		.session_mp = {
+			.nb_objs = CA_TEST_NB_SESSIONS,
+			.cache_size = 0,
+		},
+	};
+	struct rte_cryptodev_qp_conf qp_conf = {
+		.nb_descriptors = CA_TEST_QP_DESC,
+	};
+	int dev_id;
+
+	dev_id = rte_cryptodev_get_dev_id(name);
+	if (dev_id >= 0)
+		rte_cryptodev_stop(dev_id);
+	else {
+		if (rte_vdev_init(name, NULL) != 0)
+			return -1;
+		dev_id = rte_cryptodev_get_dev_id(name);
+		if (dev_id < 0)
+			return -1;
+	}
+	if (rte_cryptodev_configure(dev_id, &conf) != 0 ||
+			rte_cryptodev_queue_pair_setup(dev_id, 0, &qp_conf,
+				SOCKET_ID_ANY) != 0 ||
+			rte_cryptodev_start(dev_id) != 0)
+		return -1;
+
+	return dev_id;
+}
+
+/*
+ * Configure the event device for a test in the given mode: the crypto
+ * completions are delivered to the last event queue, linked to the
+ * application port; in forward mode the requests go through queue 0,
+ * linked to the adapter port.
+ */
+static int
+evdev_setup(enum rte_event_crypto_adapter_mode mode, uint8_t cdev_id,
+	const struct rte_event *qp_ev)
+{
+	struct rte_event_dev_config conf = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 1,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	struct rte_event_queue_conf qconf = {
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+	};
+	struct rte_event_port_conf pconf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	uint8_t q, adapter_port;
+	int ret;
+
+	if (mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
+		conf.nb_event_queues = 2;
+
+	ret = rte_event_dev_configure(evdev, &conf);
+	TEST_ASSERT_SUCCESS(ret, "Failed to configure eventdev");
+	for (q = 0; q != conf.nb_event_queues; q++) {
+		ret = rte_event_queue_setup(evdev, q, &qconf);
+		TEST_ASSERT_SUCCESS(ret, "Failed to setup queue %u", q);
+	}
+	ret = rte_event_port_setup(evdev, CA_TEST_APP_PORT, &pconf);
+	TEST_ASSERT_SUCCESS(ret, "Failed to setup the application port");
+
+	ret = rte_event_crypto_adapter_create(CA_TEST_ID, evdev, &pconf, mode);
+	TEST_ASSERT_SUCCESS(ret, "Failed to create the crypto adapter");
+	ret = rte_event_crypto_adapter_queue_pair_add(CA_TEST_ID, cdev_id, -1,
+		qp_ev);
+	TEST_ASSERT_SUCCESS(ret, "Failed to add the queue pairs");
+
+	q = conf.nb_event_queues - 1;
+	ret = rte_event_port_link(evdev, CA_TEST_APP_PORT, &q, NULL, 1);
+	TEST_ASSERT_EQUAL(ret, 1, "Failed to link the application port");
+	if (mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD) {
+		ret = rte_event_crypto_adapter_event_port_get(CA_TEST_ID,
+			&adapter_port);
+		TEST_ASSERT_SUCCESS(ret, "Failed to get the adapter port");
+		q = 0;
+		ret = rte_event_port_link(evdev, adapter_port, &q, NULL, 1);
+		TEST_ASSERT_EQUAL(ret, 1, "Failed to link the adapter port");
+	}
+
+	ret = rte_event_dev_start(evdev);
+	TEST_ASSERT_SUCCESS(ret, "Failed to start eventdev");
+	ret = rte_event_crypto_adapter_start(CA_TEST_ID);
+	TEST_ASSERT_SUCCESS(ret, "Failed to start the crypto adapter");
+
+	return TEST_SUCCESS;
+}
+
+static void
+evdev_teardown(uint8_t cdev_id)
+{
+	rte_event_crypto_adapter_stop(CA_TEST_ID);
+	rte_event_crypto_adapter_queue_pair_del(CA_TEST_ID, cdev_id, -1);
+	rte_event_crypto_adapter_free(CA_TEST_ID);
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+}
+
+static void
+ops_free(struct rte_crypto_op *ops[], uint32_t num)
+{
+	uint32_t i;
+
+	for (i = 0; i != num; i++) {
+		if (ops[i] == NULL)
+			continue;
+		rte_pktmbuf_free(ops[i]->sym->m_src);
+		rte_crypto_op_free(ops[i]);
+		ops[i] = NULL;
+	}
+}
+
+/*
+ * Allocate crypto ops on one session, each over a zeroed packet and with
+ * its index in the first byte of its IV. With metadata, the op requests queue pair 0 of the crypto device and a
+ * response on flow (index % CA_TEST_NUM_FLOWS) of the given queue.
+ */
+static int
+ops_build(struct rte_crypto_op *ops[], uint32_t num,
+	struct rte_cryptodev_sym_session *sess, uint8_t cdev_id,
+	uint8_t resp_queue, int with_md)
+{
+	struct ca_test_op_priv *priv;
+	struct rte_crypto_op *op;
+	uint8_t *p;
+	uint32_t i;
+
+	memset(ops, 0, num * sizeof(ops[0]));
+	for (i = 0; i != num; i++) {
+		op = rte_crypto_op_alloc(cop_pool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+		if (op == NULL)
+			return -1;
+		ops[i] = op;
+
+		op->sym->m_src = rte_pktmbuf_alloc(mbuf_pool);
+		if (op->sym->m_src == NULL)
+			return -1;
+		p = (uint8_t *)rte_pktmbuf_append(op->sym->m_src,
+			CA_TEST_DATA_LEN);
+		memset(p, 0, CA_TEST_DATA_LEN);
+
+		rte_crypto_op_attach_sym_session(op, sess);
+		op->sym->cipher.data.offset = 0;
+		op->sym->cipher.data.length = CA_TEST_DATA_LEN;
+
+		priv = (struct ca_test_op_priv *)(op->sym + 1);
+		memset(priv, 0, sizeof(*priv));
+		priv->iv[0] = i;
+		op->sym->cipher.iv.data = priv->iv;
+		op->sym->cipher.iv.phys_addr = op->phys_addr +
+			(priv->iv - (uint8_t *)op);
+		op->sym->cipher.iv.length = sizeof(priv->iv);
+
+		if (!with_md)
+			continue;
+
+		priv->md.response_info.queue_id = resp_queue;
+		priv->md.response_info.sched_type = RTE_SCHED_TYPE_ATOMIC;
+		priv->md.response_info.flow_id = i % CA_TEST_NUM_FLOWS;
+		priv->md.response_info.sub_event_type = i & 0xff;
+		priv->md.request_info.cdev_id = cdev_id;
+		priv->md.request_info.queue_pair_id = 0;
+		op->opaque_data = &priv->md;
+	}
+
+	return 0;
+}
+
+/* run the event device and the adapter until num events are received */
+static uint32_t
+events_collect(struct rte_event ev[], uint32_t num)
+{
+	uint32_t loops, n = 0;
+
+	for (loops = 0; n != num && loops != CA_TEST_MAX_LOOPS; loops++) {
+		rte_event_schedule(evdev);
+		rte_event_crypto_adapter_run(CA_TEST_ID, 0);
+		rte_event_schedule(evdev);
+		n += rte_event_dequeue_burst(evdev, CA_TEST_APP_PORT, ev + n,
+			num - n, 0);
+	}
+
+	return n;
+}
+
+/*
+ * Check the received events carry the completed ops in order within each
+ * flow, with the response information of the ops (or the default event of
+ * the queue pair when ref is not NULL).
+ */
+static int
+events_check(struct rte_event ev[], uint32_t num, uint8_t resp_queue,
+	const struct rte_event *ref, int ciphered)
+{
+	static const uint8_t zero[16];
+	int32_t last[CA_TEST_NUM_FLOWS];
+	struct rte_crypto_op *op;
+	uint32_t i, idx, flow;
+	uint8_t *p;
+
+	for (i = 0; i != RTE_DIM(last); i++)
+		last[i] = -1;
+
+	for (i = 0; i != num; i++) {
+		op = ev[i].event_ptr;
+		TEST_ASSERT_NOT_NULL(op, "Event %u without crypto op", i);
+		TEST_ASSERT_EQUAL(op->status, RTE_CRYPTO_OP_STATUS_SUCCESS,
+			"Crypto op %u failed, status %d", i, op->status);
+		TEST_ASSERT_EQUAL(ev[i].event_type, RTE_EVENT_TYPE_CRYPTODEV,
+			"Wrong event type %u", ev[i].event_type);
+		TEST_ASSERT_EQUAL(ev[i].queue_id, resp_queue,
+			"Wrong event queue %u", ev[i].queue_id);
+
+		/* the ops are numbered in their IV, which isn't ciphered */
+		idx = ((struct ca_test_op_priv *)(op->sym + 1))->iv[0];
+		TEST_ASSERT(idx < CA_TEST_NUM_OPS, "Bad op index %u", idx);
+		p = rte_pktmbuf_mtod(op->sym->m_src, uint8_t *);
+		TEST_ASSERT_EQUAL((memcmp(p, zero, sizeof(zero)) != 0), ciphered,
+			"Op %u: data %sciphered", idx, ciphered ? "not " : "");
+
+		if (ref != NULL) {
+			TEST_ASSERT_EQUAL(ev[i].flow_id, ref->flow_id,
+				"Wrong flow %u", ev[i].flow_id);
+			TEST_ASSERT_EQUAL(ev[i].sub_event_type,
+				ref->sub_event_type, "Wrong sub event type");
+			continue;
+		}
+
+		flow = idx % CA_TEST_NUM_FLOWS;
+		TEST_ASSERT_EQUAL(ev[i].flow_id, flow,
+			"Op %u delivered on flow %u", idx, ev[i].flow_id);
+		TEST_ASSERT_EQUAL(ev[i].sub_event_type, (idx & 0xff),
+			"Op %u: wrong sub event type %u", idx,
+			ev[i].sub_event_type);
+		TEST_ASSERT(last[flow] < (int32_t)idx,
+			"Op %u after op %d on flow %u", idx, last[flow], flow);
+		last[flow] = idx;
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_crypto_adapter_mode(const struct ca_test_dev *tdev, uint8_t cdev_id,
+	enum rte_event_crypto_adapter_mode mode, int with_md)
+{
+	struct rte_crypto_op *ops[CA_TEST_NUM_OPS];
+	struct rte_event ev[CA_TEST_NUM_OPS];
+	struct rte_event_crypto_adapter_stats stats;
+	struct rte_cryptodev_sym_session *sess;
+	struct rte_crypto_sym_xform xform;
+	struct rte_event qp_ev;
+	uint8_t resp_queue;
+	uint32_t i, n;
+	int ret;
+
+	memset(&xform, 0, sizeof(xform));
+	xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	xform.cipher.algo = tdev->algo;
+	if (tdev->algo != RTE_CRYPTO_CIPHER_NULL) {
+		xform.cipher.key.data = cipher_key;
+		xform.cipher.key.length = sizeof(cipher_key);
+	}
+	sess = rte_cryptodev_sym_session_create(cdev_id, &xform);
+	TEST_ASSERT_NOT_NULL(sess, "Cannot create session");
+
+	/* default response of the ops without metadata */
+	memset(&qp_ev, 0, sizeof(qp_ev));
+	qp_ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	qp_ev.flow_id = 3;
+	qp_ev.sub_event_type = 0x5a;
+
+	resp_queue = mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD ? 1 : 0;
+	qp_ev.queue_id = resp_queue;
+
+	ret = evdev_setup(mode, cdev_id, with_md ? NULL : &qp_ev);
+	if (ret != TEST_SUCCESS) {
+		evdev_teardown(cdev_id);
+		rte_cryptodev_sym_session_free(cdev_id, sess);
+		return ret;
+	}
+
+	ret = ops_build(ops, RTE_DIM(ops), sess, cdev_id, resp_queue,
+		with_md);
+	if (ret != 0) {
+		printf("Cannot build crypto ops\n");
+		goto out;
+	}
+
+	if (mode == RTE_EVENT_CRYPTO_ADAPTER_OP_NEW) {
+		n = rte_cryptodev_enqueue_burst(cdev_id, 0, ops, RTE_DIM(ops));
+	} else {
+		for (i = 0; i != RTE_DIM(ops); i++) {
+			memset(&ev[i], 0, sizeof(ev[i]));
+			ev[i].queue_id = 0;
+			ev[i].op = RTE_EVENT_OP_NEW;
+			ev[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+			ev[i].flow_id = i % CA_TEST_NUM_FLOWS;
+			ev[i].event_type = RTE_EVENT_TYPE_CPU;
+			ev[i].event_ptr = ops[i];
+		}
+		/* the SW eventdev takes new events by credit quanta */
+		for (n = 0; n != RTE_DIM(ev); n += i) {
+			i = rte_event_enqueue_burst(evdev, CA_TEST_APP_PORT,
+				ev + n, RTE_MIN(RTE_DIM(ev) - n,
+				CA_TEST_EV_BURST));
+			if (i == 0)
+				break;
+		}
+	}
+	if (n != RTE_DIM(ops)) {
+		printf("Enqueued %u ops out of %zu\n", n, RTE_DIM(ops));
+		ret = -1;
+		goto out;
+	}
+
+	/* the ops now belong to the events */
+	memset(ops, 0, sizeof(ops));
+	n = events_collect(ev, RTE_DIM(ev));
+	for (i = 0; i != n; i++)
+		ops[i] = ev[i].event_ptr;
+	if (n != RTE_DIM(ev)) {
+		printf("Received %u events out of %zu\n", n, RTE_DIM(ev));
+		ret = -1;
+		goto out;
+	}
+
+	ret = events_check(ev, n, resp_queue, with_md ? NULL : &qp_ev,
+		tdev->algo != RTE_CRYPTO_CIPHER_NULL);
+	if (ret != TEST_SUCCESS)
+		goto out;
+
+	ret = rte_event_crypto_adapter_stats_get(CA_TEST_ID, &stats);
+	if (ret != 0 || stats.crypto_deq_count != n ||
+			stats.event_enq_count != n ||
+			stats.event_enq_fail_count != 0 ||
+			stats.crypto_enq_fail != 0 ||
+			(mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD &&
+			(stats.event_deq_count != n ||
+			stats.crypto_enq_count != n))) {
+		printf("Unexpected adapter stats: deq %" PRIu64
+			" enq %" PRIu64 " ev deq %" PRIu64 " ev enq %" PRIu64
+			"\n", stats.crypto_deq_count, stats.crypto_enq_count,
+			stats.event_deq_count, stats.event_enq_count);
+		ret = -1;
+		goto out;
+	}
+	rte_event_crypto_adapter_stats_reset(CA_TEST_ID);
+	rte_event_crypto_adapter_stats_get(CA_TEST_ID, &stats);
+	if (stats.crypto_deq_count != 0 || stats.event_enq_count != 0) {
+		printf("Adapter stats not reset\n");
+		ret = -1;
+	}
+
+out:
+	ops_free(ops, RTE_DIM(ops));
+	evdev_teardown(cdev_id);
+	rte_cryptodev_sym_session_free(cdev_id, sess);
+	return ret;
+}
+
+/* check the control path of the adapter */
+static int
+test_crypto_adapter_ctrl(uint8_t cdev_id)
+{
+	struct rte_event_port_conf pconf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	struct rte_event_dev_config conf = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 1,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	struct rte_event_crypto_adapter_stats stats;
+	uint32_t caps = ~0;
+	uint8_t port;
+	int ret;
+
+	ret = rte_event_crypto_adapter_caps_get(evdev, cdev_id, &caps);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get adapter caps");
+	TEST_ASSERT_EQUAL(caps, 0, "Unexpected caps 0x%x for SW eventdev",
+		caps);
+	TEST_ASSERT_FAIL(rte_event_crypto_adapter_caps_get(evdev,
+		RTE_CRYPTO_MAX_DEVS - 1, &caps), "Invalid cdev accepted");
+
+	ret = rte_event_dev_configure(evdev, &conf);
+	TEST_ASSERT_SUCCESS(ret, "Failed to configure eventdev");
+
+	TEST_ASSERT_FAIL(rte_event_crypto_adapter_create(
+		RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE, evdev, &pconf,
+		RTE_EVENT_CRYPTO_ADAPTER_OP_NEW), "Invalid id accepted");
+	TEST_ASSERT_FAIL(rte_event_crypto_adapter_create(CA_TEST_ID, evdev,
+		NULL, RTE_EVENT_CRYPTO_ADAPTER_OP_NEW),
+		"NULL port conf accepted");
+
+	ret = rte_event_crypto_adapter_create(CA_TEST_ID, evdev, &pconf,
+		RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD);
+	TEST_ASSERT_SUCCESS(ret, "Failed to create the crypto adapter");
+	TEST_ASSERT_EQUAL(rte_event_crypto_adapter_create(CA_TEST_ID, evdev,
+		&pconf, RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD), -EEXIST,
+		"Adapter created twice");
+	TEST_ASSERT_EQUAL(rte_event_crypto_adapter_event_port_get(CA_TEST_ID,
+		&port), -ESRCH, "Event port before any queue pair");
+	TEST_ASSERT_EQUAL(rte_event_crypto_adapter_run(CA_TEST_ID, 0),
+		-EAGAIN, "Adapter ran while stopped");
+
+	TEST_ASSERT_FAIL(rte_event_crypto_adapter_queue_pair_add(CA_TEST_ID,
+		cdev_id, 1, NULL), "Invalid queue pair accepted");
+	ret = rte_event_crypto_adapter_queue_pair_add(CA_TEST_ID, cdev_id, 0,
+		NULL);
+	TEST_ASSERT_SUCCESS(ret, "Failed to add queue pair");
+	ret = rte_event_crypto_adapter_event_port_get(CA_TEST_ID, &port);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get the adapter port");
+	TEST_ASSERT_EQUAL(port, 1, "Adapter port %u, expected 1", port);
+	TEST_ASSERT_EQUAL(rte_event_port_count(evdev), 2,
+		"Adapter port not added to the event device");
+	TEST_ASSERT_EQUAL(rte_event_crypto_adapter_free(CA_TEST_ID), -EBUSY,
+		"Adapter freed with queue pairs");
+
+	ret = rte_event_crypto_adapter_start(CA_TEST_ID);
+	TEST_ASSERT_SUCCESS(ret, "Failed to start the crypto adapter");
+	ret = rte_event_crypto_adapter_stats_get(CA_TEST_ID, &stats);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get adapter stats");
+	ret = rte_event_crypto_adapter_stop(CA_TEST_ID);
+	TEST_ASSERT_SUCCESS(ret, "Failed to stop the crypto adapter");
+
+	ret = rte_event_crypto_adapter_queue_pair_del(CA_TEST_ID, cdev_id, 0);
+	TEST_ASSERT_SUCCESS(ret, "Failed to delete queue pair");
+	ret = rte_event_crypto_adapter_free(CA_TEST_ID);
+	TEST_ASSERT_SUCCESS(ret, "Failed to free the crypto adapter");
+	TEST_ASSERT_FAIL(rte_event_crypto_adapter_free(CA_TEST_ID),
+		"Adapter freed twice");
+
+	rte_event_dev_close(evdev);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_event_crypto_adapter(void)
+{
+	uint32_t i, mode;
+	int dev_id, ret;
+
+	if (RTE_DIM(test_devs) == 0) {
+		printf("No crypto PMD to test the crypto adapter with\n");
+		return 0;
+	}
+
+	ret = rte_event_dev_get_dev_id(CA_TEST_EVDEV_NAME);
+	if (ret < 0) {
+		if (rte_vdev_init(CA_TEST_EVDEV_NAME, NULL) < 0) {
+			printf("Error creating eventdev\n");
+			return -1;
+		}
+		ret = rte_event_dev_get_dev_id(CA_TEST_EVDEV_NAME);
+		if (ret < 0) {
+			printf("Error finding newly created eventdev\n");
+			return -1;
+		}
+	}
+	evdev = ret;
+
+	if (pools_setup() != 0)
+		return -1;
+
+	for (i = 0; i != RTE_DIM(test_devs); i++) {
+		dev_id = cdev_setup(test_devs[i].name);
+		if (dev_id < 0) {
+			printf("Cannot set up %s\n", test_devs[i].name);
+			return -1;
+		}
+
+		if (i == 0 && test_crypto_adapter_ctrl(dev_id) != 0)
+			return -1;
+
+		for (mode = 0; mode != RTE_DIM(mode_names); mode++) {
+			printf("%s %s\n", test_devs[i].name, mode_names[mode]);
+			if (test_crypto_adapter_mode(&test_devs[i], dev_id,
+					mode, 1) != 0)
+				return -1;
+		}
+		printf("%s %s, queue pair event\n", test_devs[i].name,
+			mode_names[RTE_EVENT_CRYPTO_ADAPTER_OP_NEW]);
+		if (test_crypto_adapter_mode(&test_devs[i], dev_id,
+				RTE_EVENT_CRYPTO_ADAPTER_OP_NEW, 0) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(event_crypto_adapter_autotest,
+	test_event_crypto_adapter);
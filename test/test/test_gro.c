@@ -0,0 +1,427 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_gro.h>
+
+#include "test.h"
+
+#define GRO_POOL_SIZE            2047
+#define GRO_MBUF_SIZE            (2048 + RTE_PKTMBUF_HEADROOM)
+#define GRO_PAYLOAD_LEN          1000
+#define GRO_NB_FLOWS             2
+#define GRO_PKTS_PER_FLOW        20
+#define GRO_NB_PKTS              (GRO_NB_FLOWS * GRO_PKTS_PER_FLOW)
+#define GRO_PERF_BURST           32
+#define GRO_PERF_ITERATIONS      1000
+
+#define GRO_OUTER_IP_ID          0x100
+#define GRO_IP_ID                0x200
+#define GRO_TCP_SEQ              1000
+#define GRO_TCP_PSH              0x08
+#define GRO_TCP_ACK              0x10
+
+static struct rte_mempool *gro_pool;
+
+static uint8_t gro_buf[GRO_PKTS_PER_FLOW * GRO_PAYLOAD_LEN + 256];
+
+static inline uint8_t
+gro_payload_byte(uint16_t flow, uint32_t off)
+{
+	return (uint8_t)(off * 7 + flow + 3);
+}
+
+static void
+gro_ipv4_hdr_init(struct ipv4_hdr *ip, uint8_t proto, uint16_t id,
+	uint16_t total_length)
+{
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->total_length = rte_cpu_to_be_16(total_length);
+	ip->packet_id = rte_cpu_to_be_16(id);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+}
+
+/*
+ * Build the idx-th TCP segment of a flow, as received from the wire, in
+ * a single mbuf. The flow is identified by its TCP source port.
+ */
+static struct rte_mbuf *
+gro_pkt_build(int tunnel, uint16_t flow, uint32_t idx, uint32_t payload_len,
+	uint8_t tcp_flags)
+{
+	struct rte_mbuf *m;
+	struct ether_hdr *eth;
+	struct udp_hdr *udp;
+	struct vxlan_hdr *vxlan;
+	struct tcp_hdr *tcp;
+	uint16_t hdr_len, l3_len;
+	uint32_t off;
+	char *p;
+
+	m = rte_pktmbuf_alloc(gro_pool);
+	if (m == NULL)
+		return NULL;
+
+	hdr_len = sizeof(*eth) + sizeof(struct ipv4_hdr) + sizeof(*tcp);
+	if (tunnel)
+		hdr_len += sizeof(struct ipv4_hdr) + ETHER_VXLAN_HLEN +
+			sizeof(*eth);
+	p = rte_pktmbuf_append(m, hdr_len + payload_len);
+	if (p == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	eth = (struct ether_hdr *)p;
+	memset(eth, 0, sizeof(*eth));
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+	p += sizeof(*eth);
+	l3_len = hdr_len + payload_len - sizeof(*eth);
+
+	if (tunnel) {
+		gro_ipv4_hdr_init((struct ipv4_hdr *)p, IPPROTO_UDP,
+			GRO_OUTER_IP_ID + idx, l3_len);
+		p += sizeof(struct ipv4_hdr);
+		l3_len -= sizeof(struct ipv4_hdr);
+		udp = (struct udp_hdr *)p;
+		udp->src_port = rte_cpu_to_be_16(1234);
+		udp->dst_port = rte_cpu_to_be_16(4789);
+		udp->dgram_len = rte_cpu_to_be_16(l3_len);
+		udp->dgram_cksum = 0xbeef;
+		p += sizeof(*udp);
+		vxlan = (struct vxlan_hdr *)p;
+		vxlan->vx_flags = rte_cpu_to_be_32(0x08000000);
+		vxlan->vx_vni = rte_cpu_to_be_32(100 << 8);
+		p += sizeof(*vxlan);
+		l3_len -= ETHER_VXLAN_HLEN + sizeof(*eth);
+		eth = (struct ether_hdr *)p;
+		memset(eth, 0, sizeof(*eth));
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		p += sizeof(*eth);
+	}
+
+	gro_ipv4_hdr_init((struct ipv4_hdr *)p, IPPROTO_TCP, GRO_IP_ID + idx,
+		l3_len);
+	p += sizeof(struct ipv4_hdr);
+	tcp = (struct tcp_hdr *)p;
+	memset(tcp, 0, sizeof(*tcp));
+	tcp->src_port = rte_cpu_to_be_16(1000 + flow);
+	tcp->dst_port = rte_cpu_to_be_16(2000);
+	tcp->sent_seq = rte_cpu_to_be_32(GRO_TCP_SEQ + idx * payload_len);
+	tcp->recv_ack = rte_cpu_to_be_32(1);
+	tcp->data_off = (sizeof(*tcp) / 4) << 4;
+	tcp->tcp_flags = tcp_flags;
+	tcp->rx_win = rte_cpu_to_be_16(0xffff);
+	p += sizeof(*tcp);
+
+	for (off = idx * payload_len; off < (idx + 1) * payload_len;
+			off++, p++)
+		*p = gro_payload_byte(flow, off);
+
+	return m;
+}
+
+/* Check a packet made of nb_merged segments of a flow, starting at idx 0 */
+static int
+gro_merged_check(int tunnel, struct rte_mbuf *m, uint16_t flow,
+	uint32_t nb_merged)
+{
+	struct ipv4_hdr *outer_ip, *ip;
+	struct udp_hdr *udp;
+	struct tcp_hdr *tcp;
+	uint16_t l3_offset, hdr_len;
+	uint32_t len, i, off;
+	const void *p;
+
+	l3_offset = sizeof(struct ether_hdr);
+	if (tunnel)
+		l3_offset += sizeof(struct ipv4_hdr) + ETHER_VXLAN_HLEN +
+			sizeof(struct ether_hdr);
+	hdr_len = l3_offset + sizeof(struct ipv4_hdr) + sizeof(struct tcp_hdr);
+	len = hdr_len + nb_merged * GRO_PAYLOAD_LEN;
+
+	TEST_ASSERT_EQUAL(m->pkt_len, len, "Wrong merged length %u",
+		m->pkt_len);
+	TEST_ASSERT_EQUAL(m->nb_segs, nb_merged, "Wrong number of mbufs %u",
+		m->nb_segs);
+
+	p = rte_pktmbuf_read(m, 0, len, gro_buf);
+	if (p != gro_buf)
+		memcpy(gro_buf, p, len);
+
+	if (tunnel) {
+		outer_ip = (struct ipv4_hdr *)(gro_buf +
+			sizeof(struct ether_hdr));
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(outer_ip->total_length),
+			len - sizeof(struct ether_hdr),
+			"Wrong outer IPv4 total length");
+		TEST_ASSERT_EQUAL(rte_raw_cksum(outer_ip, sizeof(*outer_ip)),
+			0xffff, "Wrong outer IPv4 checksum");
+		udp = (struct udp_hdr *)(outer_ip + 1);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(udp->dgram_len),
+			len - sizeof(struct ether_hdr) -
+			sizeof(struct ipv4_hdr), "Wrong UDP length");
+		TEST_ASSERT_EQUAL(udp->dgram_cksum, 0,
+			"UDP checksum not reset");
+	}
+
+	ip = (struct ipv4_hdr *)(gro_buf + l3_offset);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length), len - l3_offset,
+		"Wrong IPv4 total length");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->packet_id), GRO_IP_ID,
+		"Wrong IPv4 ID");
+	TEST_ASSERT_EQUAL(rte_raw_cksum(ip, sizeof(*ip)), 0xffff,
+		"Wrong IPv4 checksum");
+
+	tcp = (struct tcp_hdr *)(ip + 1);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(tcp->src_port), 1000 + flow,
+		"Wrong flow");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(tcp->sent_seq), GRO_TCP_SEQ,
+		"Wrong TCP seq");
+
+	for (i = hdr_len, off = 0; i < len; i++, off++)
+		TEST_ASSERT_EQUAL(gro_buf[i], gro_payload_byte(flow, off),
+			"Wrong payload at offset %u", off);
+
+	return 0;
+}
+
+static int
+gro_free_check(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(gro_pool), GRO_POOL_SIZE,
+		"Mbufs leaked: %u available",
+		rte_mempool_avail_count(gro_pool));
+
+	return 0;
+}
+
+/*
+ * Merge the interleaved segments of two flows in a single burst, flow 0
+ * in order and flow 1 in reverse order.
+ */
+static int
+test_gro_burst(int tunnel, const struct rte_gro_param *param)
+{
+	struct rte_mbuf *pkts[GRO_NB_PKTS];
+	uint16_t nb_pkts;
+	uint32_t i;
+
+	for (i = 0; i < GRO_PKTS_PER_FLOW; i++) {
+		pkts[2 * i] = gro_pkt_build(tunnel, 0, i, GRO_PAYLOAD_LEN,
+			GRO_TCP_ACK);
+		pkts[2 * i + 1] = gro_pkt_build(tunnel, 1,
+			GRO_PKTS_PER_FLOW - 1 - i, GRO_PAYLOAD_LEN,
+			GRO_TCP_ACK);
+		TEST_ASSERT(pkts[2 * i] != NULL && pkts[2 * i + 1] != NULL,
+			"Cannot build packet");
+	}
+
+	nb_pkts = rte_gro_reassemble_burst(pkts, GRO_NB_PKTS, param);
+	TEST_ASSERT_EQUAL(nb_pkts, GRO_NB_FLOWS,
+		"Wrong number of merged packets: %u", nb_pkts);
+	for (i = 0; i < GRO_NB_FLOWS; i++)
+		if (gro_merged_check(tunnel, pkts[i], i, GRO_PKTS_PER_FLOW))
+			return -1;
+
+	return gro_free_check(pkts, nb_pkts);
+}
+
+/* Packets which cannot be merged are returned first, unmodified */
+static int
+test_gro_unprocessed(const struct rte_gro_param *param)
+{
+	struct rte_mbuf *pkts[4];
+	struct rte_mbuf *psh, *no_payload, *vxlan;
+	struct rte_gro_param tcp_param;
+	uint16_t nb_pkts;
+
+	pkts[0] = gro_pkt_build(0, 0, 0, GRO_PAYLOAD_LEN, GRO_TCP_ACK);
+	pkts[1] = gro_pkt_build(0, 0, 1, GRO_PAYLOAD_LEN,
+		GRO_TCP_ACK | GRO_TCP_PSH);
+	pkts[2] = gro_pkt_build(0, 1, 0, 0, GRO_TCP_ACK);
+	pkts[3] = gro_pkt_build(1, 0, 0, GRO_PAYLOAD_LEN, GRO_TCP_ACK);
+	TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL && pkts[2] != NULL &&
+		pkts[3] != NULL, "Cannot build packet");
+	psh = pkts[1];
+	no_payload = pkts[2];
+	vxlan = pkts[3];
+
+	/* the VxLAN packet is not processed when its type is disabled */
+	tcp_param = *param;
+	tcp_param.gro_types = RTE_GRO_TCP_IPV4;
+	nb_pkts = rte_gro_reassemble_burst(pkts, 4, &tcp_param);
+	TEST_ASSERT_EQUAL(nb_pkts, 4, "Wrong number of packets: %u", nb_pkts);
+	TEST_ASSERT(pkts[0] == psh && pkts[1] == no_payload &&
+		pkts[2] == vxlan, "Unprocessed packets not returned first");
+	TEST_ASSERT(psh->tx_offload == 0 && no_payload->tx_offload == 0,
+		"Header lengths of rejected packets modified");
+	if (gro_merged_check(0, pkts[3], 0, 1))
+		return -1;
+
+	return gro_free_check(pkts, nb_pkts);
+}
+
+/* Hold packets across bursts in a GRO context */
+static int
+test_gro_ctx(const struct rte_gro_param *param)
+{
+	struct rte_mbuf *pkts[GRO_PKTS_PER_FLOW];
+	uint16_t nb_pkts, i, j;
+	void *ctx;
+
+	ctx = rte_gro_ctx_create(param);
+	TEST_ASSERT_NOT_NULL(ctx, "Cannot create GRO context");
+
+	for (i = 0; i < GRO_PKTS_PER_FLOW; i += GRO_PKTS_PER_FLOW / 4) {
+		for (j = 0; j < GRO_PKTS_PER_FLOW / 4; j++) {
+			pkts[j] = gro_pkt_build(1, 0, i + j, GRO_PAYLOAD_LEN,
+				GRO_TCP_ACK);
+			TEST_ASSERT_NOT_NULL(pkts[j], "Cannot build packet");
+		}
+		nb_pkts = rte_gro_reassemble(pkts, j, ctx);
+		TEST_ASSERT_EQUAL(nb_pkts, 0, "Packets not held: %u", nb_pkts);
+	}
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 1,
+		"Wrong number of held packets");
+
+	nb_pkts = rte_gro_timeout_flush(ctx, rte_get_tsc_hz() * 3600,
+		param->gro_types, pkts, RTE_DIM(pkts));
+	TEST_ASSERT_EQUAL(nb_pkts, 0, "Packets flushed before timeout");
+
+	nb_pkts = rte_gro_timeout_flush(ctx, 0, param->gro_types, pkts,
+		RTE_DIM(pkts));
+	TEST_ASSERT_EQUAL(nb_pkts, 1, "Wrong number of flushed packets: %u",
+		nb_pkts);
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 0,
+		"Packets still held after flush");
+	if (gro_merged_check(1, pkts[0], 0, GRO_PKTS_PER_FLOW) ||
+			gro_free_check(pkts, nb_pkts))
+		return -1;
+
+	/* packets still held are freed with the context */
+	pkts[0] = gro_pkt_build(0, 0, 0, GRO_PAYLOAD_LEN, GRO_TCP_ACK);
+	TEST_ASSERT_NOT_NULL(pkts[0], "Cannot build packet");
+	nb_pkts = rte_gro_reassemble(pkts, 1, ctx);
+	TEST_ASSERT_EQUAL(nb_pkts, 0, "Packet not held: %u", nb_pkts);
+	rte_gro_ctx_destroy(ctx);
+
+	return gro_free_check(pkts, 0);
+}
+
+static int
+test_gro_perf(const struct rte_gro_param *param)
+{
+	struct rte_mbuf *pkts[GRO_PERF_BURST];
+	uint64_t start, cycles = 0;
+	uint16_t nb_pkts, j;
+	uint32_t i;
+
+	for (i = 0; i < GRO_PERF_ITERATIONS; i++) {
+		for (j = 0; j < GRO_PERF_BURST; j++) {
+			pkts[j] = gro_pkt_build(0, j % GRO_NB_FLOWS,
+				j / GRO_NB_FLOWS, GRO_PAYLOAD_LEN,
+				GRO_TCP_ACK);
+			TEST_ASSERT_NOT_NULL(pkts[j], "Cannot build packet");
+		}
+
+		start = rte_rdtsc();
+		nb_pkts = rte_gro_reassemble_burst(pkts, GRO_PERF_BURST,
+			param);
+		cycles += rte_rdtsc() - start;
+		TEST_ASSERT_EQUAL(nb_pkts, GRO_NB_FLOWS,
+			"Wrong number of merged packets: %u", nb_pkts);
+
+		for (j = 0; j < nb_pkts; j++)
+			rte_pktmbuf_free(pkts[j]);
+	}
+
+	printf("GRO TCP/IPv4 burst of %u packets: %.1f cycles/packet\n",
+		GRO_PERF_BURST,
+		(double)cycles / (GRO_PERF_ITERATIONS * GRO_PERF_BURST));
+
+	return gro_free_check(pkts, 0);
+}
+
+static int
+test_gro(void)
+{
+	struct rte_gro_param param;
+
+	gro_pool = rte_pktmbuf_pool_create("gro_pool", GRO_POOL_SIZE, 0, 0,
+		GRO_MBUF_SIZE, SOCKET_ID_ANY);
+	if (gro_pool == NULL) {
+		gro_pool = rte_mempool_lookup("gro_pool");
+		if (gro_pool == NULL) {
+			printf("Cannot create mbuf pool\n");
+			return -1;
+		}
+	}
+
+	memset(&param, 0, sizeof(param));
+	param.gro_types = RTE_GRO_TCP_IPV4 | RTE_GRO_IPV4_VXLAN_TCP_IPV4;
+	param.max_flow_num = 4;
+	param.max_item_per_flow = 32;
+	param.socket_id = rte_socket_id();
+
+	if (test_gro_burst(0, &param) || test_gro_burst(1, &param) ||
+			test_gro_unprocessed(&param) ||
+			test_gro_ctx(&param) || test_gro_perf(&param))
+		return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(gro_autotest, test_gro);
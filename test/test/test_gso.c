@@ -0,0 +1,506 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_gre.h>
+#include <rte_gso.h>
+
+#include "test.h"
+
+#define GSO_POOL_SIZE            2047
+#define GSO_MBUF_SIZE            (2048 + RTE_PKTMBUF_HEADROOM)
+#define GSO_IN_SEG_LEN           1000
+#define GSO_SEG_SIZE             (ETHER_MAX_LEN - ETHER_CRC_LEN)
+#define GSO_PAYLOAD_LEN          5000
+#define GSO_MAX_SEGS             64
+#define GSO_PERF_PAYLOAD_LEN     (64 * 1024 - 100)
+#define GSO_PERF_ITERATIONS      2000
+
+#define GSO_OUTER_IP_ID          0x100
+#define GSO_IP_ID                0x200
+#define GSO_TCP_SEQ              1000
+#define GSO_TCP_FIN              0x01
+#define GSO_TCP_PSH              0x08
+#define GSO_TCP_ACK              0x10
+#define GSO_TCP_CWR              0x80
+#define GSO_TCP_FLAGS            (GSO_TCP_CWR | GSO_TCP_ACK | \
+	GSO_TCP_PSH | GSO_TCP_FIN)
+
+enum gso_pkt_type {
+	GSO_PKT_TCP4,
+	GSO_PKT_VXLAN_TCP4,
+	GSO_PKT_GRE_TCP4,
+};
+
+static struct rte_mempool *gso_pool;
+
+static uint8_t gso_buf[GSO_PERF_PAYLOAD_LEN + 256];
+
+static inline uint8_t
+gso_payload_byte(uint32_t off)
+{
+	return (uint8_t)(off * 7 + 3);
+}
+
+static void
+gso_ipv4_hdr_init(struct ipv4_hdr *ip, uint8_t proto, uint16_t id)
+{
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->packet_id = rte_cpu_to_be_16(id);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+}
+
+/*
+ * Build a packet with all its headers in the first mbuf and its payload
+ * spread over several mbufs of at most GSO_IN_SEG_LEN bytes.
+ */
+static struct rte_mbuf *
+gso_pkt_build(enum gso_pkt_type type, uint32_t payload_len)
+{
+	struct rte_mbuf *m, *seg, *prev;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	struct vxlan_hdr *vxlan;
+	struct gre_hdr *gre;
+	struct tcp_hdr *tcp;
+	char *p;
+	uint32_t off, len;
+
+	m = rte_pktmbuf_alloc(gso_pool);
+	if (m == NULL)
+		return NULL;
+
+	p = rte_pktmbuf_mtod(m, char *);
+	eth = (struct ether_hdr *)p;
+	memset(eth, 0, sizeof(*eth));
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+	p += sizeof(*eth);
+
+	if (type == GSO_PKT_VXLAN_TCP4) {
+		gso_ipv4_hdr_init((struct ipv4_hdr *)p, IPPROTO_UDP,
+			GSO_OUTER_IP_ID);
+		p += sizeof(struct ipv4_hdr);
+		udp = (struct udp_hdr *)p;
+		udp->src_port = rte_cpu_to_be_16(1234);
+		udp->dst_port = rte_cpu_to_be_16(4789);
+		udp->dgram_cksum = 0xbeef;
+		p += sizeof(*udp);
+		vxlan = (struct vxlan_hdr *)p;
+		vxlan->vx_flags = rte_cpu_to_be_32(0x08000000);
+		vxlan->vx_vni = rte_cpu_to_be_32(100 << 8);
+		p += sizeof(*vxlan);
+		eth = (struct ether_hdr *)p;
+		memset(eth, 0, sizeof(*eth));
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		p += sizeof(*eth);
+		m->outer_l2_len = sizeof(struct ether_hdr);
+		m->outer_l3_len = sizeof(struct ipv4_hdr);
+		m->l2_len = ETHER_VXLAN_HLEN + sizeof(struct ether_hdr);
+		m->ol_flags = PKT_TX_TUNNEL_VXLAN | PKT_TX_OUTER_IPV4;
+	} else if (type == GSO_PKT_GRE_TCP4) {
+		gso_ipv4_hdr_init((struct ipv4_hdr *)p, IPPROTO_GRE,
+			GSO_OUTER_IP_ID);
+		p += sizeof(struct ipv4_hdr);
+		gre = (struct gre_hdr *)p;
+		memset(gre, 0, sizeof(*gre));
+		gre->proto = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		p += sizeof(*gre);
+		m->outer_l2_len = sizeof(struct ether_hdr);
+		m->outer_l3_len = sizeof(struct ipv4_hdr);
+		m->l2_len = sizeof(struct gre_hdr);
+		m->ol_flags = PKT_TX_TUNNEL_GRE | PKT_TX_OUTER_IPV4;
+	} else {
+		m->l2_len = sizeof(struct ether_hdr);
+		m->ol_flags = 0;
+	}
+
+	ip = (struct ipv4_hdr *)p;
+	gso_ipv4_hdr_init(ip, IPPROTO_TCP, GSO_IP_ID);
+	p += sizeof(*ip);
+	tcp = (struct tcp_hdr *)p;
+	memset(tcp, 0, sizeof(*tcp));
+	tcp->src_port = rte_cpu_to_be_16(1000);
+	tcp->dst_port = rte_cpu_to_be_16(2000);
+	tcp->sent_seq = rte_cpu_to_be_32(GSO_TCP_SEQ);
+	tcp->data_off = (sizeof(*tcp) / 4) << 4;
+	tcp->tcp_flags = GSO_TCP_FLAGS;
+	tcp->rx_win = rte_cpu_to_be_16(0xffff);
+	p += sizeof(*tcp);
+
+	m->l3_len = sizeof(*ip);
+	m->l4_len = sizeof(*tcp);
+	m->tso_segsz = GSO_SEG_SIZE;
+	m->ol_flags |= PKT_TX_IPV4 | PKT_TX_TCP_SEG;
+	m->data_len = p - rte_pktmbuf_mtod(m, char *);
+	m->pkt_len = m->data_len;
+
+	/* payload */
+	prev = m;
+	seg = m;
+	for (off = 0; off < payload_len; ) {
+		if (seg->data_len == GSO_IN_SEG_LEN) {
+			seg = rte_pktmbuf_alloc(gso_pool);
+			if (seg == NULL) {
+				rte_pktmbuf_free(m);
+				return NULL;
+			}
+			prev->next = seg;
+			prev = seg;
+			m->nb_segs++;
+		}
+		len = RTE_MIN(payload_len - off,
+			(uint32_t)(GSO_IN_SEG_LEN - seg->data_len));
+		p = rte_pktmbuf_mtod_offset(seg, char *, seg->data_len);
+		seg->data_len += len;
+		m->pkt_len += len;
+		for (; len > 0; len--, off++, p++)
+			*p = gso_payload_byte(off);
+	}
+
+	return m;
+}
+
+static int
+gso_ipv4_check(const struct ipv4_hdr *ip, uint16_t total_length, uint16_t id,
+	int cksum)
+{
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length), total_length,
+		"Wrong IPv4 total length");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->packet_id), id,
+		"Wrong IPv4 ID");
+	if (cksum)
+		TEST_ASSERT_EQUAL(rte_raw_cksum(ip, sizeof(*ip)), 0xffff,
+			"Wrong IPv4 checksum");
+	else
+		TEST_ASSERT_EQUAL(ip->hdr_checksum, 0,
+			"IPv4 checksum not left to the NIC");
+
+	return 0;
+}
+
+/* Check the output packets of a packet built by gso_pkt_build() */
+static int
+gso_segs_check(enum gso_pkt_type type, struct rte_mbuf **segs, int nb_segs,
+	uint32_t payload_len, uint64_t ol_flags, uint16_t ipid_delta)
+{
+	struct ipv4_hdr *outer_ip = NULL, *ip;
+	struct udp_hdr *udp;
+	struct tcp_hdr *tcp;
+	uint16_t l3_offset, hdr_len, unit, cksum, expected_len;
+	uint64_t seg_ol_flags = ol_flags & ~PKT_TX_TCP_SEG;
+	const void *p;
+	uint32_t off, i;
+	uint8_t flags;
+	int n;
+
+	if (type == GSO_PKT_TCP4)
+		l3_offset = sizeof(struct ether_hdr);
+	else if (type == GSO_PKT_VXLAN_TCP4)
+		l3_offset = sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) +
+			ETHER_VXLAN_HLEN + sizeof(struct ether_hdr);
+	else
+		l3_offset = sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) +
+			sizeof(struct gre_hdr);
+	hdr_len = l3_offset + sizeof(struct ipv4_hdr) + sizeof(struct tcp_hdr);
+	unit = GSO_SEG_SIZE - hdr_len;
+
+	TEST_ASSERT_EQUAL(nb_segs, (int)((payload_len + unit - 1) / unit),
+		"Wrong number of segments: %d", nb_segs);
+
+	off = 0;
+	for (n = 0; n < nb_segs; n++) {
+		expected_len = hdr_len + RTE_MIN(unit, payload_len - off);
+		TEST_ASSERT_EQUAL(segs[n]->pkt_len, expected_len,
+			"Segment %d: wrong length %u", n, segs[n]->pkt_len);
+		TEST_ASSERT_EQUAL(segs[n]->ol_flags, seg_ol_flags,
+			"Segment %d: wrong ol_flags", n);
+
+		/* linear copy of the segment */
+		p = rte_pktmbuf_read(segs[n], 0, expected_len, gso_buf);
+		if (p != gso_buf)
+			memcpy(gso_buf, p, expected_len);
+
+		if (type != GSO_PKT_TCP4) {
+			outer_ip = (struct ipv4_hdr *)(gso_buf +
+				sizeof(struct ether_hdr));
+			if (gso_ipv4_check(outer_ip,
+					expected_len - sizeof(struct ether_hdr),
+					GSO_OUTER_IP_ID + n * ipid_delta,
+					!(ol_flags & PKT_TX_OUTER_IP_CKSUM)))
+				return -1;
+		}
+		if (type == GSO_PKT_VXLAN_TCP4) {
+			udp = (struct udp_hdr *)(outer_ip + 1);
+			TEST_ASSERT_EQUAL(rte_be_to_cpu_16(udp->dgram_len),
+				expected_len - sizeof(struct ether_hdr) -
+				sizeof(struct ipv4_hdr),
+				"Segment %d: wrong UDP length", n);
+			TEST_ASSERT_EQUAL(udp->dgram_cksum, 0,
+				"Segment %d: UDP checksum not reset", n);
+		}
+
+		ip = (struct ipv4_hdr *)(gso_buf + l3_offset);
+		if (gso_ipv4_check(ip, expected_len - l3_offset,
+				GSO_IP_ID + n * ipid_delta,
+				!(ol_flags & PKT_TX_IP_CKSUM)))
+			return -1;
+
+		tcp = (struct tcp_hdr *)(ip + 1);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_32(tcp->sent_seq),
+			GSO_TCP_SEQ + off, "Segment %d: wrong TCP seq", n);
+		flags = GSO_TCP_FLAGS;
+		if (n != nb_segs - 1)
+			flags &= ~(GSO_TCP_PSH | GSO_TCP_FIN);
+		if (n != 0)
+			flags &= ~GSO_TCP_CWR;
+		TEST_ASSERT_EQUAL(tcp->tcp_flags, flags,
+			"Segment %d: wrong TCP flags %x", n, tcp->tcp_flags);
+
+		cksum = tcp->cksum;
+		tcp->cksum = 0;
+		if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM)
+			TEST_ASSERT_EQUAL(cksum, rte_ipv4_phdr_cksum(ip, 0),
+				"Segment %d: wrong TCP pseudo-header checksum",
+				n);
+		else
+			TEST_ASSERT_EQUAL(cksum, rte_ipv4_udptcp_cksum(ip, tcp),
+				"Segment %d: wrong TCP checksum", n);
+
+		for (i = hdr_len; i < expected_len; i++, off++)
+			TEST_ASSERT_EQUAL(gso_buf[i], gso_payload_byte(off),
+				"Segment %d: wrong payload at offset %u",
+				n, off);
+	}
+
+	return 0;
+}
+
+static int
+gso_free_check(struct rte_mbuf **segs, int nb_segs)
+{
+	int i;
+
+	for (i = 0; i < nb_segs; i++)
+		rte_pktmbuf_free(segs[i]);
+
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(gso_pool), GSO_POOL_SIZE,
+		"Mbufs leaked: %u available",
+		rte_mempool_avail_count(gso_pool));
+
+	return 0;
+}
+
+static int
+test_gso_type(enum gso_pkt_type type, const struct rte_gso_ctx *ctx,
+	uint64_t extra_ol_flags)
+{
+	struct rte_mbuf *segs[GSO_MAX_SEGS];
+	struct rte_mbuf *m;
+	uint64_t ol_flags;
+	int ret;
+
+	m = gso_pkt_build(type, GSO_PAYLOAD_LEN);
+	TEST_ASSERT_NOT_NULL(m, "Cannot build packet");
+	m->ol_flags |= extra_ol_flags;
+	ol_flags = m->ol_flags;
+
+	ret = rte_gso_segment(m, ctx, segs, RTE_DIM(segs));
+	TEST_ASSERT(ret > 1, "Segmentation failed: %d", ret);
+	if (gso_segs_check(type, segs, ret, GSO_PAYLOAD_LEN, ol_flags,
+			(ctx->flag & RTE_GSO_FLAG_IPID_FIXED) ? 0 : 1))
+		return -1;
+
+	return gso_free_check(segs, ret);
+}
+
+static int
+test_gso_errors(struct rte_gso_ctx *ctx)
+{
+	struct rte_mbuf *segs[GSO_MAX_SEGS];
+	struct rte_gso_ctx bad_ctx;
+	struct rte_mbuf *m;
+	struct gre_hdr *gre;
+	int ret;
+
+	/* small packet: returned as is */
+	m = gso_pkt_build(GSO_PKT_TCP4, 100);
+	TEST_ASSERT_NOT_NULL(m, "Cannot build packet");
+	ret = rte_gso_segment(m, ctx, segs, RTE_DIM(segs));
+	TEST_ASSERT(ret == 1 && segs[0] == m, "Small packet segmented");
+
+	/* packet without PKT_TX_TCP_SEG: returned as is */
+	rte_pktmbuf_free(m);
+	m = gso_pkt_build(GSO_PKT_TCP4, GSO_PAYLOAD_LEN);
+	TEST_ASSERT_NOT_NULL(m, "Cannot build packet");
+	m->ol_flags &= ~PKT_TX_TCP_SEG;
+	ret = rte_gso_segment(m, ctx, segs, RTE_DIM(segs));
+	TEST_ASSERT(ret == 1 && segs[0] == m, "Non TSO packet segmented");
+	m->ol_flags |= PKT_TX_TCP_SEG;
+
+	/* packet type not enabled in the context: returned as is */
+	bad_ctx = *ctx;
+	bad_ctx.gso_types = DEV_TX_OFFLOAD_VXLAN_TNL_TSO;
+	ret = rte_gso_segment(m, &bad_ctx, segs, RTE_DIM(segs));
+	TEST_ASSERT(ret == 1 && segs[0] == m, "Disabled type segmented");
+
+	/* invalid context */
+	bad_ctx = *ctx;
+	bad_ctx.gso_size = RTE_GSO_SEG_SIZE_MIN - 1;
+	ret = rte_gso_segment(m, &bad_ctx, segs, RTE_DIM(segs));
+	TEST_ASSERT_EQUAL(ret, -EINVAL, "Invalid GSO size accepted");
+
+	/* output array too small: the input packet is left untouched */
+	ret = rte_gso_segment(m, ctx, segs, 2);
+	TEST_ASSERT_EQUAL(ret, -EINVAL, "Too small output array accepted");
+	TEST_ASSERT_EQUAL(rte_mbuf_refcnt_read(m->next), 1,
+		"Input packet still referenced");
+	ret = rte_gso_segment(m, ctx, segs, RTE_DIM(segs));
+	TEST_ASSERT(ret > 1, "Segmentation after error failed: %d", ret);
+	if (gso_segs_check(GSO_PKT_TCP4, segs, ret, GSO_PAYLOAD_LEN,
+			PKT_TX_IPV4 | PKT_TX_TCP_SEG, 1))
+		return -1;
+	if (gso_free_check(segs, ret))
+		return -1;
+
+	/* GRE header with checksum */
+	m = gso_pkt_build(GSO_PKT_GRE_TCP4, GSO_PAYLOAD_LEN);
+	TEST_ASSERT_NOT_NULL(m, "Cannot build packet");
+	gre = rte_pktmbuf_mtod_offset(m, struct gre_hdr *,
+		m->outer_l2_len + m->outer_l3_len);
+	gre->c = 1;
+	ret = rte_gso_segment(m, ctx, segs, RTE_DIM(segs));
+	TEST_ASSERT_EQUAL(ret, -ENOTSUP, "GRE checksum accepted");
+	rte_pktmbuf_free(m);
+
+	return gso_free_check(segs, 0);
+}
+
+static int
+test_gso_perf(const struct rte_gso_ctx *ctx)
+{
+	struct rte_mbuf *segs[GSO_MAX_SEGS];
+	struct rte_mbuf *m, *seg;
+	uint64_t start, cycles = 0, nb_out = 0;
+	uint32_t i;
+	int ret, j;
+
+	m = gso_pkt_build(GSO_PKT_TCP4, GSO_PERF_PAYLOAD_LEN);
+	TEST_ASSERT_NOT_NULL(m, "Cannot build packet");
+
+	for (i = 0; i < GSO_PERF_ITERATIONS; i++) {
+		/* keep the input packet for the next iteration */
+		for (seg = m; seg != NULL; seg = seg->next)
+			rte_mbuf_refcnt_update(seg, 1);
+
+		start = rte_rdtsc();
+		ret = rte_gso_segment(m, ctx, segs, RTE_DIM(segs));
+		cycles += rte_rdtsc() - start;
+		TEST_ASSERT(ret > 1, "Segmentation failed: %d", ret);
+
+		nb_out += ret;
+		for (j = 0; j < ret; j++)
+			rte_pktmbuf_free(segs[j]);
+	}
+
+	printf("GSO TCP/IPv4 %u bytes: %.1f cycles/packet, "
+		"%.1f cycles/segment\n", m->pkt_len,
+		(double)cycles / GSO_PERF_ITERATIONS,
+		(double)cycles / nb_out);
+
+	rte_pktmbuf_free(m);
+	return gso_free_check(segs, 0);
+}
+
+static int
+test_gso(void)
+{
+	struct rte_gso_ctx ctx;
+	int ret = -1;
+
+	gso_pool = rte_pktmbuf_pool_create("gso_pool", GSO_POOL_SIZE, 0, 0,
+		GSO_MBUF_SIZE, SOCKET_ID_ANY);
+	if (gso_pool == NULL) {
+		gso_pool = rte_mempool_lookup("gso_pool");
+		if (gso_pool == NULL) {
+			printf("Cannot create mbuf pool\n");
+			return -1;
+		}
+	}
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.direct_pool = gso_pool;
+	ctx.indirect_pool = gso_pool;
+	ctx.gso_types = DEV_TX_OFFLOAD_TCP_TSO | DEV_TX_OFFLOAD_VXLAN_TNL_TSO |
+		DEV_TX_OFFLOAD_GRE_TNL_TSO;
+	ctx.gso_size = GSO_SEG_SIZE;
+
+	if (test_gso_type(GSO_PKT_TCP4, &ctx, 0) ||
+			test_gso_type(GSO_PKT_TCP4, &ctx,
+				PKT_TX_IP_CKSUM | PKT_TX_TCP_CKSUM) ||
+			test_gso_type(GSO_PKT_VXLAN_TCP4, &ctx, 0) ||
+			test_gso_type(GSO_PKT_VXLAN_TCP4, &ctx,
+				PKT_TX_OUTER_IP_CKSUM) ||
+			test_gso_type(GSO_PKT_GRE_TCP4, &ctx, 0))
+		goto out;
+
+	ctx.flag = RTE_GSO_FLAG_IPID_FIXED;
+	if (test_gso_type(GSO_PKT_VXLAN_TCP4, &ctx, 0))
+		goto out;
+	ctx.flag = 0;
+
+	if (test_gso_errors(&ctx) || test_gso_perf(&ctx))
+		goto out;
+
+	ret = 0;
+out:
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(gso_autotest, test_gso);
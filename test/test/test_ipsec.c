@@ -0,0 +1,979 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_esp.h>
+#include <rte_dev.h>
+#include <rte_crypto.h>
+#include <rte_cryptodev.h>
+#include <rte_ipsec.h>
+
+#include "test.h"
+
+#define IPSEC_POOL_SIZE          1023
+#define IPSEC_MBUF_SIZE          (2048 + RTE_PKTMBUF_HEADROOM)
+#define IPSEC_BURST              16
+#define IPSEC_QP_DESC            256
+#define IPSEC_NB_SESSIONS        32
+#define IPSEC_SPI                0x1234
+#define IPSEC_SALT               0x5a5a5a5a
+#define IPSEC_REPLAY_WIN_SZ      64
+#define IPSEC_REPLAY_PKTS        200
+#define IPSEC_MAX_PKT_LEN        1500
+#define IPSEC_PERF_BURST         32
+#define IPSEC_PERF_ITERATIONS    2000
+
+enum ipsec_test_algo {
+	IPSEC_TEST_NULL,
+	IPSEC_TEST_AES_CBC_SHA1,
+	IPSEC_TEST_AES_CTR_SHA256,
+	IPSEC_TEST_AES_GCM,
+};
+
+enum ipsec_test_mode {
+	IPSEC_TEST_TRANSPORT4,
+	IPSEC_TEST_TRANSPORT6,
+	IPSEC_TEST_TUNNEL4,
+	IPSEC_TEST_TUNNEL6,
+};
+
+static const char * const algo_names[] = {
+	[IPSEC_TEST_NULL] = "NULL",
+	[IPSEC_TEST_AES_CBC_SHA1] = "AES-CBC/SHA1-HMAC",
+	[IPSEC_TEST_AES_CTR_SHA256] = "AES-CTR/SHA256-HMAC",
+	[IPSEC_TEST_AES_GCM] = "AES-GCM",
+};
+
+static const char * const mode_names[] = {
+	[IPSEC_TEST_TRANSPORT4] = "transport IPv4",
+	[IPSEC_TEST_TRANSPORT6] = "transport IPv6",
+	[IPSEC_TEST_TUNNEL4] = "tunnel IPv4",
+	[IPSEC_TEST_TUNNEL6] = "tunnel IPv6",
+};
+
+/* crypto devices and the algorithms they are tested with */
+static const struct ipsec_test_dev {
+	const char *name;
+	uint32_t algos; /* bitmask of enum ipsec_test_algo */
+	int full_icv;   /* HMAC digests not truncated */
+} test_devs[] = {
+#ifdef RTE_LIBRTE_PMD_NULL_CRYPTO
+	{ RTE_STR(CRYPTODEV_NAME_NULL_PMD), 1 << IPSEC_TEST_NULL, 0 },
+#endif
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+	{ RTE_STR(CRYPTODEV_NAME_OPENSSL_PMD),
+		1 << IPSEC_TEST_AES_CBC_SHA1 | 1 << IPSEC_TEST_AES_CTR_SHA256 |
+		1 << IPSEC_TEST_AES_GCM, 1 },
+#endif
+#ifdef RTE_LIBRTE_PMD_AESNI_MB
+	{ RTE_STR(CRYPTODEV_NAME_AESNI_MB_PMD),
+		1 << IPSEC_TEST_AES_CBC_SHA1 | 1 << IPSEC_TEST_AES_CTR_SHA256, 0 },
+#endif
+#ifdef RTE_LIBRTE_PMD_AESNI_GCM
+	{ RTE_STR(CRYPTODEV_NAME_AESNI_GCM_PMD), 1 << IPSEC_TEST_AES_GCM, 0 },
+#endif
+};
+
+static struct rte_mempool *mbuf_pool;
+static struct rte_mempool *cop_pool;
+static int full_icv;
+
+static uint8_t cipher_key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+static uint8_t auth_key[32] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+	0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+};
+
+/* copies of the packets, to check them after a round trip */
+static uint8_t pkt_copy[IPSEC_BURST][IPSEC_MAX_PKT_LEN];
+static uint32_t pkt_copy_len[IPSEC_BURST];
+
+struct ipsec_test_sa {
+	struct rte_ipsec_sa *sa;
+	struct rte_cryptodev_sym_session *session;
+	struct rte_crypto_sym_xform xform[2];
+};
+
+static void
+ipv4_hdr_init(struct ipv4_hdr *ip, uint8_t proto, uint16_t len)
+{
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->total_length = rte_cpu_to_be_16(len);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(192, 168, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(192, 168, 0, 2));
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+}
+
+static void
+ipv6_hdr_init(struct ipv6_hdr *ip6, uint8_t proto, uint16_t len)
+{
+	memset(ip6, 0, sizeof(*ip6));
+	ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip6->payload_len = rte_cpu_to_be_16(len - sizeof(*ip6));
+	ip6->proto = proto;
+	ip6->hop_limits = 64;
+	ip6->src_addr[0] = 0xfe;
+	ip6->src_addr[15] = 1;
+	ip6->dst_addr[0] = 0xfe;
+	ip6->dst_addr[15] = 2;
+}
+
+/* build an IPv4 or IPv6 UDP packet */
+static struct rte_mbuf *
+pkt_build(int ipv6, uint32_t payload_len, uint8_t seed)
+{
+	struct rte_mbuf *m;
+	struct udp_hdr *udp;
+	uint32_t i, l3len, len;
+	uint8_t *p;
+
+	m = rte_pktmbuf_alloc(mbuf_pool);
+	if (m == NULL)
+		return NULL;
+
+	l3len = ipv6 ? sizeof(struct ipv6_hdr) : sizeof(struct ipv4_hdr);
+	len = l3len + sizeof(*udp) + payload_len;
+	p = (uint8_t *)rte_pktmbuf_append(m, len);
+	if (p == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	if (ipv6)
+		ipv6_hdr_init((struct ipv6_hdr *)p, IPPROTO_UDP, len);
+	else
+		ipv4_hdr_init((struct ipv4_hdr *)p, IPPROTO_UDP, len);
+
+	udp = (struct udp_hdr *)(p + l3len);
+	udp->src_port = rte_cpu_to_be_16(4500);
+	udp->dst_port = rte_cpu_to_be_16(4501);
+	udp->dgram_len = rte_cpu_to_be_16(sizeof(*udp) + payload_len);
+	udp->dgram_cksum = 0;
+
+	p = (uint8_t *)(udp + 1);
+	for (i = 0; i != payload_len; i++)
+		p[i] = (uint8_t)(i * 7 + seed);
+
+	return m;
+}
+
+static int
+pools_setup(void)
+{
+	mbuf_pool = rte_mempool_lookup("ipsec_mbuf_pool");
+	if (mbuf_pool == NULL)
+		mbuf_pool = rte_pktmbuf_pool_create("ipsec_mbuf_pool",
+			IPSEC_POOL_SIZE, 0, 0, IPSEC_MBUF_SIZE,
+			SOCKET_ID_ANY);
+	cop_pool = rte_mempool_lookup("ipsec_cop_pool");
+	if (cop_pool == NULL)
+		cop_pool = rte_crypto_op_pool_create("ipsec_cop_pool",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, IPSEC_POOL_SIZE, 0,
+			RTE_IPSEC_CRYPTO_PRIV_SIZE, SOCKET_ID_ANY);
+	if (mbuf_pool == NULL || cop_pool == NULL) {
+		printf("Cannot create pools\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+dev_setup(const char *name)
+{
+	struct rte_cryptodev_config conf = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_queue_pairs = 1,
+		.session_mp = {
+			.nb_objs = IPSEC_NB_SESSIONS,
+			.cache_size = 0,
+		},
+	};
+	struct rte_cryptodev_qp_conf qp_conf = {
+		.nb_descriptors = IPSEC_QP_DESC,
+	};
+	int dev_id;
+
+	dev_id = rte_cryptodev_get_dev_id(name);
+	if (dev_id >= 0)
+		rte_cryptodev_stop(dev_id);
+	else {
+		if (rte_vdev_init(name, NULL) != 0)
+			return -1;
+		dev_id = rte_cryptodev_get_dev_id(name);
+		if (dev_id < 0)
+			return -1;
+	}
+	if (rte_cryptodev_configure(dev_id, &conf) != 0 ||
+			rte_cryptodev_queue_pair_setup(dev_id, 0, &qp_conf,
+				SOCKET_ID_ANY) != 0 ||
+			rte_cryptodev_start(dev_id) != 0)
+		return -1;
+
+	return dev_id;
+}
+
+/* fill the crypto transform chain of an SA direction */
+static void
+xform_init(struct rte_crypto_sym_xform xf[2], enum ipsec_test_algo algo,
+	int outbound)
+{
+	struct rte_crypto_sym_xform *cxf, *axf;
+
+	memset(xf, 0, 2 * sizeof(*xf));
+
+	/* encrypt-then-MAC */
+	cxf = outbound ? &xf[0] : &xf[1];
+	axf = outbound ? &xf[1] : &xf[0];
+	xf[0].next = &xf[1];
+
+	cxf->type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cxf->cipher.op = outbound ? RTE_CRYPTO_CIPHER_OP_ENCRYPT :
+		RTE_CRYPTO_CIPHER_OP_DECRYPT;
+	axf->type = RTE_CRYPTO_SYM_XFORM_AUTH;
+	axf->auth.op = outbound ? RTE_CRYPTO_AUTH_OP_GENERATE :
+		RTE_CRYPTO_AUTH_OP_VERIFY;
+
+	switch (algo) {
+	case IPSEC_TEST_NULL:
+		cxf->cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+		axf->auth.algo = RTE_CRYPTO_AUTH_NULL;
+		break;
+	case IPSEC_TEST_AES_CBC_SHA1:
+		cxf->cipher.algo = RTE_CRYPTO_CIPHER_AES_CBC;
+		axf->auth.algo = RTE_CRYPTO_AUTH_SHA1_HMAC;
+		axf->auth.digest_length = full_icv ? 20 : 12;
+		break;
+	case IPSEC_TEST_AES_CTR_SHA256:
+		cxf->cipher.algo = RTE_CRYPTO_CIPHER_AES_CTR;
+		axf->auth.algo = RTE_CRYPTO_AUTH_SHA256_HMAC;
+		axf->auth.digest_length = full_icv ? 32 : 16;
+		break;
+	case IPSEC_TEST_AES_GCM:
+		cxf->cipher.algo = RTE_CRYPTO_CIPHER_AES_GCM;
+		axf->auth.algo = RTE_CRYPTO_AUTH_AES_GCM;
+		axf->auth.digest_length = 16;
+		axf->auth.add_auth_data_length = sizeof(struct esp_hdr);
+		break;
+	}
+
+	if (algo != IPSEC_TEST_NULL) {
+		cxf->cipher.key.data = cipher_key;
+		cxf->cipher.key.length = sizeof(cipher_key);
+	}
+	if (algo == IPSEC_TEST_AES_GCM) {
+		axf->auth.key.data = cipher_key;
+		axf->auth.key.length = sizeof(cipher_key);
+	} else if (algo != IPSEC_TEST_NULL) {
+		axf->auth.key.data = auth_key;
+		axf->auth.key.length = (algo == IPSEC_TEST_AES_CBC_SHA1) ?
+			20 : sizeof(auth_key);
+	}
+}
+
+static int
+sa_create(struct ipsec_test_sa *tsa, uint8_t dev_id,
+	enum ipsec_test_algo algo, enum ipsec_test_mode mode, int outbound,
+	uint32_t replay_win_sz)
+{
+	struct rte_ipsec_sa_prm prm;
+	struct ipv4_hdr tun4;
+	struct ipv6_hdr tun6;
+	int sz, rc;
+
+	xform_init(tsa->xform, algo, outbound);
+	tsa->session = rte_cryptodev_sym_session_create(dev_id, tsa->xform);
+	if (tsa->session == NULL)
+		return -1;
+
+	memset(&prm, 0, sizeof(prm));
+	prm.spi = IPSEC_SPI;
+	prm.salt = IPSEC_SALT;
+	prm.dir = outbound ? RTE_IPSEC_SA_DIR_OUTBOUND :
+		RTE_IPSEC_SA_DIR_INBOUND;
+	prm.replay_win_sz = replay_win_sz;
+	prm.xform = tsa->xform;
+	prm.session = tsa->session;
+
+	switch (mode) {
+	case IPSEC_TEST_TRANSPORT4:
+	case IPSEC_TEST_TRANSPORT6:
+		prm.mode = RTE_IPSEC_SA_MODE_TRANSPORT;
+		break;
+	case IPSEC_TEST_TUNNEL4:
+		prm.mode = RTE_IPSEC_SA_MODE_TUNNEL;
+		ipv4_hdr_init(&tun4, IPPROTO_ESP, 0);
+		tun4.src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+		tun4.dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+		prm.tun.hdr = &tun4;
+		prm.tun.hdr_len = sizeof(tun4);
+		break;
+	case IPSEC_TEST_TUNNEL6:
+		prm.mode = RTE_IPSEC_SA_MODE_TUNNEL;
+		ipv6_hdr_init(&tun6, IPPROTO_ESP, sizeof(tun6));
+		prm.tun.hdr = &tun6;
+		prm.tun.hdr_len = sizeof(tun6);
+		break;
+	}
+
+	sz = rte_ipsec_sa_size(&prm);
+	if (sz < 0) {
+		printf("Bad SA size %d\n", sz);
+		return -1;
+	}
+
+	tsa->sa = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (tsa->sa == NULL)
+		return -1;
+	rc = rte_ipsec_sa_init(tsa->sa, &prm, sz);
+	if (rc != 0) {
+		printf("Cannot init SA: %d\n", rc);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+sa_destroy(struct ipsec_test_sa *tsa, uint8_t dev_id)
+{
+	if (tsa->session != NULL)
+		rte_cryptodev_sym_session_free(dev_id, tsa->session);
+	tsa->session = NULL;
+	rte_free(tsa->sa);
+	tsa->sa = NULL;
+}
+
+/* run the crypto operations of a burst through a device */
+static int
+crypto_run(uint8_t dev_id, struct rte_crypto_op *cop[], uint16_t num)
+{
+	struct rte_crypto_op *out[IPSEC_PERF_BURST];
+	uint32_t retry;
+	uint16_t k;
+
+	if (rte_cryptodev_enqueue_burst(dev_id, 0, cop, num) != num)
+		return -1;
+
+	/* operations are dequeued in order */
+	for (k = 0, retry = 0; k != num && retry != 1000000; retry++)
+		k += rte_cryptodev_dequeue_burst(dev_id, 0, out + k, num - k);
+	if (k != num)
+		return -1;
+
+	memcpy(cop, out, num * sizeof(out[0]));
+
+	return 0;
+}
+
+/*
+ * Prepare, run and process a burst of one SA. Returns the number of good
+ * packets, the ones dropped at prepare time are counted in nb_drop.
+ */
+static int
+sa_run(struct rte_ipsec_sa *sa, uint8_t dev_id, struct rte_mbuf *mb[],
+	uint16_t num, uint16_t *nb_drop)
+{
+	struct rte_crypto_op *cop[IPSEC_PERF_BURST];
+	uint16_t k, n;
+
+	if (rte_crypto_op_bulk_alloc(cop_pool, RTE_CRYPTO_OP_TYPE_SYMMETRIC,
+			cop, num) != num)
+		return -1;
+
+	k = rte_ipsec_crypto_prepare(sa, mb, cop, num);
+	n = 0;
+	if (k != 0) {
+		if (crypto_run(dev_id, cop, k) != 0) {
+			printf("Crypto device error\n");
+			return -1;
+		}
+		n = rte_ipsec_process(sa, cop, mb, k);
+	}
+
+	rte_mempool_put_bulk(cop_pool, (void **)cop, num);
+	*nb_drop = num - k;
+	return n;
+}
+
+static void
+pkts_free(struct rte_mbuf *mb[], uint16_t num)
+{
+	uint16_t i;
+
+	for (i = 0; i != num; i++)
+		rte_pktmbuf_free(mb[i]);
+}
+
+/* check the ESP encapsulation of an outbound packet */
+static int
+esp_check(const struct rte_mbuf *m, enum ipsec_test_mode mode,
+	uint32_t sqn, uint32_t in_len, const uint8_t *in)
+{
+	const struct ipv4_hdr *ip4;
+	const struct ipv6_hdr *ip6;
+	const struct esp_hdr *esp;
+	uint32_t hlen;
+
+	ip4 = rte_pktmbuf_mtod(m, const struct ipv4_hdr *);
+	if ((ip4->version_ihl >> 4) == 4) {
+		TEST_ASSERT(mode != IPSEC_TEST_TRANSPORT6 &&
+			mode != IPSEC_TEST_TUNNEL6, "Bad outer IP version");
+		TEST_ASSERT_EQUAL(ip4->next_proto_id, IPPROTO_ESP,
+			"Bad IPv4 protocol");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip4->total_length),
+			m->pkt_len, "Bad IPv4 length");
+		TEST_ASSERT_EQUAL(rte_raw_cksum(ip4, sizeof(*ip4)), 0xffff,
+			"Bad IPv4 checksum");
+		hlen = sizeof(*ip4);
+	} else {
+		ip6 = (const struct ipv6_hdr *)ip4;
+		TEST_ASSERT(mode == IPSEC_TEST_TRANSPORT6 ||
+			mode == IPSEC_TEST_TUNNEL6, "Bad outer IP version");
+		TEST_ASSERT_EQUAL(ip6->proto, IPPROTO_ESP,
+			"Bad IPv6 next header");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip6->payload_len) +
+			sizeof(*ip6), m->pkt_len, "Bad IPv6 length");
+		hlen = sizeof(*ip6);
+	}
+
+	esp = rte_pktmbuf_mtod_offset(m, const struct esp_hdr *, hlen);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(esp->spi), IPSEC_SPI, "Bad SPI");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(esp->seq), sqn,
+		"Bad sequence number");
+	TEST_ASSERT(m->pkt_len > in_len, "Packet not encapsulated");
+
+	/* the NULL cipher leaves the UDP header readable */
+	if (in != NULL && (mode == IPSEC_TEST_TRANSPORT4 ||
+			mode == IPSEC_TEST_TRANSPORT6))
+		TEST_ASSERT_EQUAL(memcmp(esp + 1, in + hlen,
+			sizeof(struct udp_hdr)), 0, "Bad NULL cipher data");
+
+	return 0;
+}
+
+/*
+ * Encapsulate a burst of packets with an outbound SA, check the ESP
+ * packets, tamper the last one, then decapsulate them with the matching
+ * inbound SA and compare them to the original packets. The replayed
+ * packets must be dropped.
+ */
+static int
+test_ipsec_round_trip(uint8_t dev_id, enum ipsec_test_algo algo,
+	enum ipsec_test_mode mode)
+{
+	struct ipsec_test_sa out = { NULL }, in = { NULL };
+	struct rte_mbuf *mb[IPSEC_BURST], *rep[2];
+	uint8_t esp_copy[2][IPSEC_MAX_PKT_LEN];
+	uint32_t esp_len[2], i, nb_good;
+	uint16_t nb_drop;
+	int ipv6, rc, ret = -1;
+
+	ipv6 = (mode == IPSEC_TEST_TRANSPORT6);
+	memset(mb, 0, sizeof(mb));
+
+	if (sa_create(&out, dev_id, algo, mode, 1, 0) != 0 ||
+			sa_create(&in, dev_id, algo, mode, 0,
+				IPSEC_REPLAY_WIN_SZ) != 0) {
+		printf("Cannot create SAs\n");
+		goto out;
+	}
+
+	for (i = 0; i != IPSEC_BURST; i++) {
+		/* mix IPv4 and IPv6 inner packets in tunnel mode */
+		if (mode == IPSEC_TEST_TUNNEL4 || mode == IPSEC_TEST_TUNNEL6)
+			ipv6 = i & 1;
+		mb[i] = pkt_build(ipv6, i * 61 + 1, i);
+		if (mb[i] == NULL) {
+			printf("Cannot build packet\n");
+			goto out;
+		}
+		pkt_copy_len[i] = mb[i]->pkt_len;
+		memcpy(pkt_copy[i], rte_pktmbuf_mtod(mb[i], void *),
+			mb[i]->pkt_len);
+	}
+
+	/* outbound */
+	rc = sa_run(out.sa, dev_id, mb, IPSEC_BURST, &nb_drop);
+	if (rc != IPSEC_BURST) {
+		printf("Outbound processing failed: %d, errno %d\n", rc,
+			rte_errno);
+		goto out;
+	}
+	for (i = 0; i != IPSEC_BURST; i++) {
+		if (esp_check(mb[i], mode, i + 1, pkt_copy_len[i],
+				algo == IPSEC_TEST_NULL ? pkt_copy[i] : NULL))
+			goto out;
+		if (algo != IPSEC_TEST_NULL && memcmp(
+				rte_pktmbuf_mtod_offset(mb[i], void *,
+					mb[i]->pkt_len - pkt_copy_len[i]),
+				pkt_copy[i], pkt_copy_len[i]) == 0) {
+			printf("Packet %u not encrypted\n", i);
+			goto out;
+		}
+	}
+	if (rte_ipsec_sa_sqn(out.sa) != IPSEC_BURST) {
+		printf("Bad outbound sequence number\n");
+		goto out;
+	}
+
+	/* keep the first two ESP packets to replay them */
+	for (i = 0; i != RTE_DIM(esp_len); i++) {
+		esp_len[i] = mb[i]->pkt_len;
+		memcpy(esp_copy[i], rte_pktmbuf_mtod(mb[i], void *),
+			esp_len[i]);
+	}
+
+	/* corrupt the ICV of the last packet */
+	nb_good = IPSEC_BURST;
+	if (algo != IPSEC_TEST_NULL) {
+		*rte_pktmbuf_mtod_offset(mb[IPSEC_BURST - 1], uint8_t *,
+			mb[IPSEC_BURST - 1]->pkt_len - 1) ^= 0x80;
+		nb_good--;
+	}
+
+	/* inbound */
+	rc = sa_run(in.sa, dev_id, mb, IPSEC_BURST, &nb_drop);
+	if (rc != (int)nb_good) {
+		printf("Inbound processing failed: %d, errno %d\n", rc,
+			rte_errno);
+		goto out;
+	}
+	if (nb_good != IPSEC_BURST && rte_errno != EBADMSG) {
+		printf("Tampered packet not detected: errno %d\n", rte_errno);
+		goto out;
+	}
+	for (i = 0; i != nb_good; i++) {
+		if (mb[i]->pkt_len != pkt_copy_len[i] ||
+				memcmp(rte_pktmbuf_mtod(mb[i], void *),
+					pkt_copy[i], pkt_copy_len[i]) != 0) {
+			printf("Packet %u differs after decapsulation\n", i);
+			goto out;
+		}
+	}
+	if (rte_ipsec_sa_sqn(in.sa) != nb_good) {
+		printf("Bad inbound sequence number\n");
+		goto out;
+	}
+
+	/* replay */
+	for (i = 0; i != RTE_DIM(rep); i++) {
+		rep[i] = rte_pktmbuf_alloc(mbuf_pool);
+		if (rep[i] == NULL) {
+			pkts_free(rep, i);
+			goto out;
+		}
+		memcpy(rte_pktmbuf_append(rep[i], esp_len[i]), esp_copy[i],
+			esp_len[i]);
+	}
+	rc = sa_run(in.sa, dev_id, rep, RTE_DIM(rep), &nb_drop);
+	pkts_free(rep, RTE_DIM(rep));
+	if (rc != 0 || nb_drop != RTE_DIM(rep) || rte_errno != EACCES) {
+		printf("Replayed packets not dropped: %d\n", rc);
+		goto out;
+	}
+
+	ret = 0;
+out:
+	pkts_free(mb, IPSEC_BURST);
+	sa_destroy(&out, dev_id);
+	sa_destroy(&in, dev_id);
+	return ret;
+}
+
+/* send ESP packets of the given sequence numbers to an inbound SA */
+static int
+replay_send(struct rte_ipsec_sa *sa, uint8_t dev_id,
+	uint8_t esp[][IPSEC_MAX_PKT_LEN], const uint32_t *len,
+	uint32_t sqn, int expect)
+{
+	struct rte_mbuf *m;
+	uint16_t nb_drop;
+	int rc;
+
+	m = rte_pktmbuf_alloc(mbuf_pool);
+	TEST_ASSERT_NOT_NULL(m, "Cannot allocate mbuf");
+	memcpy(rte_pktmbuf_append(m, len[sqn - 1]), esp[sqn - 1],
+		len[sqn - 1]);
+
+	rc = sa_run(sa, dev_id, &m, 1, &nb_drop);
+	rte_pktmbuf_free(m);
+
+	TEST_ASSERT(expect ? rc == 1 : (rc == 0 && nb_drop == 1),
+		"Sequence number %u %s", sqn,
+		expect ? "dropped" : "accepted");
+	return 0;
+}
+
+/* check the anti-replay window with out of order packets */
+static int
+test_ipsec_replay_window(uint8_t dev_id)
+{
+	static uint8_t esp[IPSEC_REPLAY_PKTS][IPSEC_MAX_PKT_LEN];
+	static uint32_t len[IPSEC_REPLAY_PKTS];
+	struct ipsec_test_sa out = { NULL }, in = { NULL };
+	struct rte_mbuf *m;
+	uint16_t nb_drop;
+	uint32_t i;
+	int ret = -1;
+
+	if (sa_create(&out, dev_id, IPSEC_TEST_NULL,
+				IPSEC_TEST_TUNNEL4, 1, 0) != 0 ||
+			sa_create(&in, dev_id, IPSEC_TEST_NULL,
+				IPSEC_TEST_TUNNEL4, 0,
+				IPSEC_REPLAY_WIN_SZ) != 0)
+		goto out;
+
+	for (i = 0; i != IPSEC_REPLAY_PKTS; i++) {
+		m = pkt_build(0, 32, i);
+		if (m == NULL)
+			goto out;
+		if (sa_run(out.sa, dev_id, &m, 1, &nb_drop) != 1) {
+			rte_pktmbuf_free(m);
+			goto out;
+		}
+		len[i] = m->pkt_len;
+		memcpy(esp[i], rte_pktmbuf_mtod(m, void *), len[i]);
+		rte_pktmbuf_free(m);
+	}
+
+	if (replay_send(in.sa, dev_id, esp, len, 100, 1) ||
+			/* in the window */
+			replay_send(in.sa, dev_id, esp, len, 50, 1) ||
+			/* duplicate */
+			replay_send(in.sa, dev_id, esp, len, 50, 0) ||
+			replay_send(in.sa, dev_id, esp, len, 100, 0) ||
+			/* left of the window */
+			replay_send(in.sa, dev_id, esp, len, 36, 0) ||
+			/* last sequence number of the window */
+			replay_send(in.sa, dev_id, esp, len, 37, 1) ||
+			/* slide the window across several buckets */
+			replay_send(in.sa, dev_id, esp, len, 200, 1) ||
+			replay_send(in.sa, dev_id, esp, len, 137, 1) ||
+			replay_send(in.sa, dev_id, esp, len, 136, 0) ||
+			replay_send(in.sa, dev_id, esp, len, 199, 1) ||
+			replay_send(in.sa, dev_id, esp, len, 199, 0) ||
+			replay_send(in.sa, dev_id, esp, len, 100, 0))
+		goto out;
+
+	if (rte_ipsec_sa_sqn(in.sa) != IPSEC_REPLAY_PKTS) {
+		printf("Bad inbound sequence number\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	sa_destroy(&out, dev_id);
+	sa_destroy(&in, dev_id);
+	return ret;
+}
+
+/* check the SA parameters and the handling of the bad packets */
+static int
+test_ipsec_errors(uint8_t dev_id)
+{
+	struct ipsec_test_sa out = { NULL };
+	struct rte_ipsec_sa_prm prm;
+	struct rte_crypto_sym_xform xf[2];
+	struct rte_mbuf *mb[3] = { NULL }, *bad;
+	struct ipv4_hdr tun4;
+	uint16_t nb_drop;
+	int ret = -1, rc;
+
+	memset(&prm, 0, sizeof(prm));
+	xform_init(xf, IPSEC_TEST_AES_CBC_SHA1, 1);
+	prm.dir = RTE_IPSEC_SA_DIR_OUTBOUND;
+	prm.mode = RTE_IPSEC_SA_MODE_TRANSPORT;
+	prm.xform = xf;
+	prm.session = (struct rte_cryptodev_sym_session *)xf;
+
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) > 0, "Valid SA rejected");
+	TEST_ASSERT(rte_ipsec_sa_size(NULL) < 0, "NULL SA accepted");
+
+	/* MAC-then-encrypt */
+	xform_init(xf, IPSEC_TEST_AES_CBC_SHA1, 0);
+	xf[0].auth.op = RTE_CRYPTO_AUTH_OP_GENERATE;
+	xf[1].cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) < 0, "Bad chain order accepted");
+
+	/* wrong direction */
+	xform_init(xf, IPSEC_TEST_AES_CBC_SHA1, 0);
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) < 0, "Bad direction accepted");
+
+	/* unsupported algorithm */
+	xform_init(xf, IPSEC_TEST_AES_CBC_SHA1, 1);
+	xf[0].cipher.algo = RTE_CRYPTO_CIPHER_3DES_CBC;
+	TEST_ASSERT_EQUAL(rte_ipsec_sa_size(&prm), -ENOTSUP,
+		"Unsupported cipher accepted");
+
+	/* replay window too large */
+	xform_init(xf, IPSEC_TEST_AES_CBC_SHA1, 0);
+	prm.dir = RTE_IPSEC_SA_DIR_INBOUND;
+	prm.replay_win_sz = RTE_IPSEC_REPLAY_WIN_MAX_SZ + 1;
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) < 0, "Bad window accepted");
+	prm.replay_win_sz = RTE_IPSEC_REPLAY_WIN_MAX_SZ;
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) > 0, "Valid window rejected");
+
+	/* bad tunnel header */
+	xform_init(xf, IPSEC_TEST_AES_CBC_SHA1, 1);
+	prm.dir = RTE_IPSEC_SA_DIR_OUTBOUND;
+	prm.mode = RTE_IPSEC_SA_MODE_TUNNEL;
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) < 0, "No tunnel header accepted");
+	ipv4_hdr_init(&tun4, IPPROTO_ESP, 0);
+	prm.tun.hdr = &tun4;
+	prm.tun.hdr_len = sizeof(tun4) + 4;
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) < 0, "Bad tunnel header accepted");
+	prm.tun.hdr_len = sizeof(tun4);
+	TEST_ASSERT(rte_ipsec_sa_size(&prm) > 0, "Tunnel header rejected");
+
+	/* a packet without tailroom is moved at the end of the burst */
+	if (sa_create(&out, dev_id, IPSEC_TEST_NULL,
+			IPSEC_TEST_TRANSPORT4, 1, 0) != 0)
+		goto out;
+	mb[0] = pkt_build(0, IPSEC_MBUF_SIZE - RTE_PKTMBUF_HEADROOM -
+		sizeof(struct ipv4_hdr) - sizeof(struct udp_hdr), 0);
+	mb[1] = pkt_build(0, 100, 1);
+	mb[2] = pkt_build(1, 100, 2);
+	if (mb[0] == NULL || mb[1] == NULL || mb[2] == NULL)
+		goto out;
+	bad = mb[0];
+
+	rc = sa_run(out.sa, dev_id, mb, RTE_DIM(mb), &nb_drop);
+	if (rc != 2 || nb_drop != 1 || mb[2] != bad || rte_errno != ENOSPC) {
+		printf("Bad packet not reported: %d\n", rc);
+		goto out;
+	}
+	if (esp_check(mb[0], IPSEC_TEST_TRANSPORT4, 1, 0, NULL) != 0 ||
+			esp_check(mb[1], IPSEC_TEST_TRANSPORT6, 2, 0, NULL) != 0)
+		goto out;
+
+	ret = 0;
+out:
+	pkts_free(mb, RTE_DIM(mb));
+	sa_destroy(&out, dev_id);
+	return ret;
+}
+
+static int
+test_ipsec(void)
+{
+	uint32_t i, algo, mode;
+	int dev_id, null_dev = -1;
+
+	if (RTE_DIM(test_devs) == 0) {
+		printf("No crypto PMD to test IPsec with\n");
+		return 0;
+	}
+
+	if (pools_setup() != 0)
+		return -1;
+
+	for (i = 0; i != RTE_DIM(test_devs); i++) {
+		dev_id = dev_setup(test_devs[i].name);
+		if (dev_id < 0) {
+			printf("Cannot set up %s\n", test_devs[i].name);
+			return -1;
+		}
+		if (test_devs[i].algos & (1 << IPSEC_TEST_NULL))
+			null_dev = dev_id;
+		full_icv = test_devs[i].full_icv;
+
+		for (algo = 0; algo != RTE_DIM(algo_names); algo++) {
+			if (!(test_devs[i].algos & (1 << algo)))
+				continue;
+			for (mode = 0; mode != RTE_DIM(mode_names); mode++) {
+				printf("%s %s %s\n", test_devs[i].name,
+					algo_names[algo], mode_names[mode]);
+				if (test_ipsec_round_trip(dev_id, algo,
+						mode) != 0)
+					return -1;
+			}
+		}
+	}
+
+	full_icv = 0;
+	if (null_dev >= 0 && (test_ipsec_replay_window(null_dev) != 0 ||
+			test_ipsec_errors(null_dev) != 0))
+		return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(ipsec_autotest, test_ipsec);
+
+/*
+ * Measure the cost of the IPsec library, outside of the crypto device, to
+ * encapsulate and decapsulate bursts of packets of one SA pair.
+ */
+static int
+test_ipsec_perf_algo(uint8_t dev_id, enum ipsec_test_algo algo,
+	enum ipsec_test_mode mode, uint32_t payload_len)
+{
+	struct ipsec_test_sa out = { NULL }, in = { NULL };
+	struct rte_mbuf *mb[IPSEC_PERF_BURST];
+	struct rte_crypto_op *cop[IPSEC_PERF_BURST];
+	uint64_t start, cyc_prep[2] = { 0 }, cyc_proc[2] = { 0 };
+	uint64_t cyc_crypto = 0;
+	struct ipsec_test_sa *tsa;
+	uint32_t i, j, len;
+	uint16_t k, n;
+	int ipv6, ret = -1;
+
+	ipv6 = (mode == IPSEC_TEST_TRANSPORT6);
+	memset(mb, 0, sizeof(mb));
+
+	if (sa_create(&out, dev_id, algo, mode, 1, 0) != 0 ||
+			sa_create(&in, dev_id, algo, mode, 0,
+				IPSEC_REPLAY_WIN_SZ) != 0)
+		goto out;
+
+	for (i = 0; i != IPSEC_PERF_BURST; i++) {
+		mb[i] = pkt_build(ipv6, payload_len, i);
+		if (mb[i] == NULL)
+			goto out;
+	}
+	len = mb[0]->pkt_len;
+
+	for (i = 0; i != IPSEC_PERF_ITERATIONS; i++) {
+		/* outbound then inbound, the packets are back at the end */
+		for (j = 0; j != 2; j++) {
+			tsa = (j == 0) ? &out : &in;
+
+			if (rte_crypto_op_bulk_alloc(cop_pool,
+					RTE_CRYPTO_OP_TYPE_SYMMETRIC, cop,
+					IPSEC_PERF_BURST) != IPSEC_PERF_BURST)
+				goto out;
+
+			start = rte_rdtsc();
+			k = rte_ipsec_crypto_prepare(tsa->sa, mb, cop,
+				IPSEC_PERF_BURST);
+			cyc_prep[j] += rte_rdtsc() - start;
+
+			start = rte_rdtsc();
+			n = (crypto_run(dev_id, cop, k) == 0) ? k : 0;
+			cyc_crypto += rte_rdtsc() - start;
+
+			start = rte_rdtsc();
+			n = rte_ipsec_process(tsa->sa, cop, mb, n);
+			cyc_proc[j] += rte_rdtsc() - start;
+
+			rte_mempool_put_bulk(cop_pool, (void **)cop,
+				IPSEC_PERF_BURST);
+			if (k != IPSEC_PERF_BURST || n != IPSEC_PERF_BURST) {
+				printf("Processing failed: errno %d\n",
+					rte_errno);
+				goto out;
+			}
+		}
+
+		if (mb[0]->pkt_len != len) {
+			printf("Bad packet length after round trip\n");
+			goto out;
+		}
+	}
+
+	printf("%-20s %-15s %5u | %8.1f %8.1f | %8.1f %8.1f | %9.1f\n",
+		algo_names[algo], mode_names[mode], len,
+		(double)cyc_prep[0] / (IPSEC_PERF_ITERATIONS * IPSEC_PERF_BURST),
+		(double)cyc_proc[0] / (IPSEC_PERF_ITERATIONS * IPSEC_PERF_BURST),
+		(double)cyc_prep[1] / (IPSEC_PERF_ITERATIONS * IPSEC_PERF_BURST),
+		(double)cyc_proc[1] / (IPSEC_PERF_ITERATIONS * IPSEC_PERF_BURST),
+		(double)cyc_crypto / (2 * IPSEC_PERF_ITERATIONS *
+			IPSEC_PERF_BURST));
+
+	ret = 0;
+out:
+	pkts_free(mb, IPSEC_PERF_BURST);
+	sa_destroy(&out, dev_id);
+	sa_destroy(&in, dev_id);
+	return ret;
+}
+
+static int
+test_ipsec_perf(void)
+{
+	static const uint32_t payload_len[] = { 64, 512, 1400 };
+	uint32_t i, l, algo, mode;
+	int dev_id;
+
+	if (pools_setup() != 0)
+		return -1;
+
+	printf("Cycles per packet, burst of %u packets\n", IPSEC_PERF_BURST);
+	printf("%-20s %-15s %5s | %8s %8s | %8s %8s | %9s\n", "algorithm",
+		"mode", "len", "outb-prep", "outb-proc", "inb-prep",
+		"inb-proc", "crypto");
+
+	for (i = 0; i != RTE_DIM(test_devs); i++) {
+		dev_id = dev_setup(test_devs[i].name);
+		if (dev_id < 0) {
+			printf("Cannot set up %s\n", test_devs[i].name);
+			return -1;
+		}
+
+		printf("%s\n", test_devs[i].name);
+		full_icv = test_devs[i].full_icv;
+		for (algo = 0; algo != RTE_DIM(algo_names); algo++) {
+			if (!(test_devs[i].algos & (1 << algo)))
+				continue;
+			for (mode = 0; mode != RTE_DIM(mode_names); mode++)
+				for (l = 0; l != RTE_DIM(payload_len); l++)
+					if (test_ipsec_perf_algo(dev_id, algo,
+							mode, payload_len[l]))
+						return -1;
+		}
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(ipsec_perf_autotest, test_ipsec_perf);
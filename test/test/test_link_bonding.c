@@ -2936,6 +2936,60 @@ test_balance_l34_tx_burst_ipv6_toggle_udp_port(void)
 #define TEST_BAL_SLAVE_TX_FAIL_PACKETS_COUNT		(25)
 #define TEST_BAL_SLAVE_TX_FAIL_FAILING_SLAVE_IDX	(0)
 
+static int
+test_balance_rss_tx_burst(void)
+{
+	int i, burst_size, nb_tx;
+
+	struct rte_mbuf *pkts_burst[MAX_PKT_BURST];
+
+	struct rte_eth_stats port_stats;
+
+	TEST_ASSERT_SUCCESS(initialize_bonded_device_with_slaves(
+			BONDING_MODE_BALANCE, 0, 2, 1),
+			"Failed to initialize_bonded_device_with_slaves.");
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_policy_set(
+			test_params->bonded_port_id, BALANCE_XMIT_POLICY_RSS),
+			"Failed to set balance xmit policy.");
+
+	burst_size = 20;
+
+	/* Generate a burst of packets of the same flow but of distinct RSS
+	 * hashes, which must be used to balance them */
+	TEST_ASSERT_EQUAL(generate_test_burst(
+			pkts_burst, burst_size, 0, 1, 0, 0, 0),
+			burst_size, "failed to generate burst");
+
+	for (i = 0; i < burst_size; i++) {
+		pkts_burst[i]->hash.rss = i;
+		pkts_burst[i]->ol_flags |= PKT_RX_RSS_HASH;
+	}
+
+	nb_tx = rte_eth_tx_burst(test_params->bonded_port_id, 0, pkts_burst,
+			burst_size);
+	TEST_ASSERT_EQUAL(nb_tx, burst_size, "tx burst failed");
+
+	/* Verify bonded port tx stats */
+	rte_eth_stats_get(test_params->bonded_port_id, &port_stats);
+	TEST_ASSERT_EQUAL(port_stats.opackets, (uint64_t)nb_tx,
+			"Bonded Port (%d) opackets value (%u) not as expected (%d)",
+			test_params->bonded_port_id, (unsigned int)port_stats.opackets,
+			nb_tx);
+
+	/* Verify slave ports tx stats, odd hashes go to the second slave */
+	for (i = 0; i < test_params->bonded_slave_count; i++) {
+		rte_eth_stats_get(test_params->slave_port_ids[i], &port_stats);
+		TEST_ASSERT_EQUAL(port_stats.opackets, (uint64_t)nb_tx / 2,
+				"Slave Port (%d) opackets value (%u) not as expected (%d)",
+				test_params->slave_port_ids[i],
+				(unsigned int)port_stats.opackets, nb_tx / 2);
+	}
+
+	/* Clean up and remove slaves from bonded device */
+	return remove_slaves_and_stop_bonded_device();
+}
+
 static int
 test_balance_tx_burst_slave_tx_fail(void)
 {
@@ -4968,6 +5022,7 @@ static struct unit_test_suite link_bonding_test_suite  = {
 		TEST_CASE(test_balance_l34_tx_burst_ipv6_toggle_ip_addr),
 		TEST_CASE(test_balance_l34_tx_burst_vlan_ipv6_toggle_ip_addr),
 		TEST_CASE(test_balance_l34_tx_burst_ipv6_toggle_udp_port),
+		TEST_CASE(test_balance_rss_tx_burst),
 		TEST_CASE(test_balance_tx_burst_slave_tx_fail),
 		TEST_CASE(test_balance_rx_burst),
 		TEST_CASE(test_balance_verify_promiscuous_enable_disable),
@@ -46,6 +46,7 @@
 #include <rte_debug.h>
 #include <rte_ethdev.h>
 #include <rte_log.h>
+#include <rte_launch.h>
 #include <rte_lcore.h>
 #include <rte_memory.h>
 
@@ -75,7 +76,7 @@
 
 #define BONDED_DEV_NAME         ("unit_test_mode4_bond_dev")
 
-#define SLAVE_DEV_NAME_FMT      ("unit_test_mode4_slave_%d")
+#define SLAVE_DEV_NAME_FMT      ("ut_mode4_slave_%d")
 #define SLAVE_RX_QUEUE_FMT      ("unit_test_mode4_slave_%d_rx")
 #define SLAVE_TX_QUEUE_FMT      ("unit_test_mode4_slave_%d_tx")
 
@@ -447,10 +448,17 @@ test_setup(void)
 		}
 
 		if (port->port_id == INVALID_PORT_ID) {
+			/* The second queue pair, sharing the rings of the first
+			 * one, is used by the mode 4 dedicated queues */
+			struct rte_ring *rx_rings[] = {
+				port->rx_queue, port->rx_queue };
+			struct rte_ring *tx_rings[] = {
+				port->tx_queue, port->tx_queue };
+
 			retval = snprintf(name, RTE_DIM(name), SLAVE_DEV_NAME_FMT, i);
 			TEST_ASSERT(retval < (int)RTE_DIM(name) - 1, "Name too long");
-			retval = rte_eth_from_rings(name, &port->rx_queue, 1,
-					&port->tx_queue, 1, socket_id);
+			retval = rte_eth_from_rings(name, rx_rings, RTE_DIM(rx_rings),
+					tx_rings, RTE_DIM(tx_rings), socket_id);
 			TEST_ASSERT(retval >= 0,
 				"Failed to create ring ethdev '%s'\n", name);
 
@@ -1448,6 +1456,183 @@ test_mode4_ext_lacp(void)
 	return TEST_SUCCESS;
 }
 
+/* Free the packets left in the rings of the slaves */
+static void
+slaves_drain(void)
+{
+	struct slave_conf *slave;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	int retval;
+	uint8_t i;
+
+	FOR_EACH_PORT(i, slave) {
+		do {
+			retval = slave_get_pkts(slave, pkts, RTE_DIM(pkts));
+			if (retval > 0)
+				free_pkts(pkts, retval);
+		} while (retval > 0);
+
+		do {
+			retval = rte_ring_dequeue_burst(slave->rx_queue,
+					(void **)pkts, RTE_DIM(pkts), NULL);
+			if (retval > 0)
+				free_pkts(pkts, retval);
+		} while (retval > 0);
+	}
+}
+
+static int
+test_mode4_dedicated_queues(void)
+{
+	struct slave_conf *slave;
+	uint8_t all_slaves_done, i, j;
+	const unsigned delay = bond_get_update_timeout_ms();
+	int retval;
+
+	retval = initialize_bonded_device_with_slaves(TEST_LACP_SLAVE_COUT, 0);
+	TEST_ASSERT_SUCCESS(retval, "Failed to initialize bonded device");
+
+	TEST_ASSERT_EQUAL(rte_eth_bond_8023ad_dedicated_queues_enable(
+			test_params.bonded_port_id), -EBUSY,
+			"Dedicated queues enabled on a started bonded device");
+
+	rte_eth_dev_stop(test_params.bonded_port_id);
+	slaves_drain();
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_8023ad_dedicated_queues_enable(
+			test_params.bonded_port_id),
+			"Failed to enable dedicated queues");
+	TEST_ASSERT_SUCCESS(rte_eth_dev_start(test_params.bonded_port_id),
+			"Failed to start bonded device with dedicated queues");
+
+	/* The handshake must complete without calling the bonded device
+	 * bursts: the LACP frames are exchanged on the dedicated queues by the
+	 * mode 4 periodic callback. */
+	all_slaves_done = 0;
+	for (i = 0; i < 30 && all_slaves_done == 0; ++i) {
+		rte_delay_ms(delay);
+
+		all_slaves_done = 1;
+		FOR_EACH_SLAVE(j, slave) {
+			TEST_ASSERT(bond_handshake_reply(slave) >= 0,
+				"Failed to reply to slave %u", slave->port_id);
+
+			if (!bond_handshake_done(slave))
+				all_slaves_done = 0;
+		}
+	}
+
+	TEST_ASSERT_EQUAL(all_slaves_done, 1,
+		"Handshake failed with idle data path and dedicated queues");
+
+	/* Nothing polls the slaves once the bonded device is stopped */
+	rte_eth_dev_stop(test_params.bonded_port_id);
+	slaves_drain();
+
+	retval = remove_slaves_and_stop_bonded_device();
+	TEST_ASSERT_SUCCESS(retval, "Test cleanup failed.");
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_8023ad_dedicated_queues_disable(
+			test_params.bonded_port_id),
+			"Failed to disable dedicated queues");
+
+	slaves_drain();
+
+	return TEST_SUCCESS;
+}
+
+static volatile int traffic_running;
+
+/* Transmit and receive on the bonded device until traffic_running is
+ * cleared */
+static int
+bond_traffic_lcore(void *arg __rte_unused)
+{
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	struct ether_addr src_mac, dst_mac;
+	uint16_t nb_pkts;
+
+	ether_addr_copy(&parnter_mac_default, &src_mac);
+	rte_eth_macaddr_get(test_params.bonded_port_id, &dst_mac);
+
+	while (traffic_running) {
+		if (generate_packets(&src_mac, &dst_mac, DEF_PKT_BURST,
+				pkts) == DEF_PKT_BURST) {
+			nb_pkts = bond_tx(pkts, DEF_PKT_BURST);
+			free_pkts(&pkts[nb_pkts], DEF_PKT_BURST - nb_pkts);
+		}
+
+		nb_pkts = bond_rx(pkts, RTE_DIM(pkts));
+		free_pkts(pkts, nb_pkts);
+	}
+
+	return 0;
+}
+
+static int
+test_mode4_slave_remove_traffic(void)
+{
+	struct slave_conf *slave;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	unsigned int lcore_id;
+	uint8_t i;
+	int retval;
+
+	lcore_id = rte_get_next_lcore(rte_lcore_id(), 1, 0);
+	if (lcore_id >= RTE_MAX_LCORE) {
+		printf("### Not enough cores for %s test.\n", __func__);
+		return TEST_SUCCESS;
+	}
+
+	retval = initialize_bonded_device_with_slaves(TEST_TX_SLAVE_COUNT, 0);
+	TEST_ASSERT_SUCCESS(retval, "Failed to initialize bonded device");
+
+	retval = bond_handshake();
+	TEST_ASSERT_SUCCESS(retval, "Initial handshake failed");
+
+	traffic_running = 1;
+	TEST_ASSERT_SUCCESS(rte_eal_remote_launch(bond_traffic_lcore, NULL,
+			lcore_id), "Failed to launch traffic on lcore %u", lcore_id);
+
+	/* Remove all the slaves but one while the traffic runs. Once removed,
+	 * a slave must not be used by the bursts anymore. */
+	FOR_EACH_SLAVE(i, slave) {
+		if (i == TEST_TX_SLAVE_COUNT - 1)
+			break;
+
+		rte_delay_ms(10);
+		retval = remove_slave(slave);
+		if (retval != TEST_SUCCESS)
+			break;
+
+		do {
+			retval = slave_get_pkts(slave, pkts, RTE_DIM(pkts));
+			free_pkts(pkts, retval);
+		} while (retval > 0);
+
+		rte_delay_ms(10);
+		retval = slave_get_pkts(slave, pkts, RTE_DIM(pkts));
+		free_pkts(pkts, retval);
+		if (retval != 0) {
+			printf("Slave %u transmitted %d packets after its removal\n",
+				slave->port_id, retval);
+			retval = TEST_FAILED;
+			break;
+		}
+	}
+
+	traffic_running = 0;
+	rte_eal_wait_lcore(lcore_id);
+	TEST_ASSERT_SUCCESS(retval, "Slave removal under traffic failed");
+
+	retval = remove_slaves_and_stop_bonded_device();
+	TEST_ASSERT_SUCCESS(retval, "Test cleanup failed.");
+
+	slaves_drain();
+
+	return TEST_SUCCESS;
+}
+
 static int
 check_environment(void)
 {
@@ -1576,6 +1761,18 @@ test_mode4_ext_lacp_wrapper(void)
 	return test_mode4_executor(&test_mode4_ext_lacp);
 }
 
+static int
+test_mode4_dedicated_queues_wrapper(void)
+{
+	return test_mode4_executor(&test_mode4_dedicated_queues);
+}
+
+static int
+test_mode4_slave_remove_traffic_wrapper(void)
+{
+	return test_mode4_executor(&test_mode4_slave_remove_traffic);
+}
+
 static struct unit_test_suite link_bonding_mode4_test_suite  = {
 	.suite_name = "Link Bonding mode 4 Unit Test Suite",
 	.setup = test_setup,
@@ -1590,6 +1787,10 @@ static struct unit_test_suite link_bonding_mode4_test_suite  = {
 				test_mode4_ext_ctrl_wrapper),
 		TEST_CASE_NAMED("test_mode4_ext_lacp",
 				test_mode4_ext_lacp_wrapper),
+		TEST_CASE_NAMED("test_mode4_dedicated_queues",
+				test_mode4_dedicated_queues_wrapper),
+		TEST_CASE_NAMED("test_mode4_slave_remove_traffic",
+				test_mode4_slave_remove_traffic_wrapper),
 
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
@@ -56,8 +56,11 @@
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 #include <rte_cycles.h>
+#include <rte_errno.h>
 
 #include "test.h"
 
@@ -80,6 +83,13 @@
 
 #define MAGIC_DATA              0x42424242
 
+#define EXT_ARENA_CHUNK_LEN     MBUF_TEST_DATA_LEN
+#define EXT_ARENA_CHUNK_NUM     1024
+#define EXT_ARENA_ITERATIONS    16
+
+#define DYN_PERF_BURST          32
+#define DYN_PERF_ITERATIONS     10000
+
 #define MAKE_STRING(x)          # x
 
 static struct rte_mempool *pktmbuf_pool = NULL;
@@ -132,6 +142,18 @@ static unsigned refcnt_lcore[RTE_MAX_LCORE];
  *    - Clone a mbuf and verify the data
  *    - Clone the cloned mbuf and verify the data
  *    - Attach a mbuf to another that does not have the same priv_size.
+ *
+ * #. Test external buffers
+ *    - Attach an external buffer to a mbuf, clone it and check that the
+ *      buffer is freed with the last mbuf referencing it.
+ *    - Attach the chunks of a large arena to mbufs and compare the cost of
+ *      cloning them to the cost of copying their data.
+ *
+ * #. Test dynamic fields and flags
+ *    - Register, lookup and use dynamic fields and flags, and check the
+ *      errors on invalid or conflicting parameters.
+ *    - Compare the cost of updating a dynamic field to the cost of
+ *      updating the mbuf private area.
  */
 
 #define GOTO_FAIL(str, ...) do {					\
@@ -536,6 +558,429 @@ test_attach_from_different_pool(void)
 		rte_pktmbuf_free(clone2);
 	return -1;
 }
+
+static void
+ext_buf_free_cb(void *addr __rte_unused, void *opaque)
+{
+	uint16_t *freed = opaque;
+
+	(*freed)++;
+}
+
+/*
+ * Attach an external buffer to a mbuf, clone the mbuf and check that the
+ * free callback is called once, when the last mbuf is freed.
+ */
+static int
+test_pktmbuf_ext_shinfo_init_helper(void)
+{
+	struct rte_mbuf *m = NULL;
+	struct rte_mbuf *clone = NULL;
+	struct rte_mbuf_ext_shared_info *shinfo;
+	uint16_t buf_len = MBUF_DATA_SIZE;
+	uint16_t freed = 0;
+	char *ext_buf = NULL;
+	char *data;
+
+	ext_buf = rte_malloc("test_ext_buf", buf_len, 0);
+	if (ext_buf == NULL)
+		GOTO_FAIL("cannot allocate external buffer");
+
+	shinfo = rte_pktmbuf_ext_shinfo_init_helper(ext_buf, &buf_len,
+		ext_buf_free_cb, &freed);
+	if (shinfo == NULL)
+		GOTO_FAIL("cannot initialize shared data");
+	if ((char *)shinfo < ext_buf + buf_len ||
+			(char *)(shinfo + 1) > ext_buf + MBUF_DATA_SIZE)
+		GOTO_FAIL("shared data out of the external buffer");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 1)
+		GOTO_FAIL("invalid refcnt in shared data");
+
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+
+	rte_pktmbuf_attach_extbuf(m, ext_buf, rte_malloc_virt2phy(ext_buf),
+		buf_len, shinfo);
+	rte_pktmbuf_reset_headroom(m);
+	if (!RTE_MBUF_HAS_EXTBUF(m) || RTE_MBUF_DIRECT(m) ||
+			RTE_MBUF_INDIRECT(m))
+		GOTO_FAIL("bad flags after attach");
+	if (rte_pktmbuf_mtod(m, char *) != ext_buf + RTE_PKTMBUF_HEADROOM)
+		GOTO_FAIL("external buffer was not attached properly");
+
+	data = rte_pktmbuf_append(m, MBUF_TEST_DATA_LEN);
+	if (data == NULL)
+		GOTO_FAIL("cannot append data");
+	memset(data, 0xcc, MBUF_TEST_DATA_LEN);
+
+	/* the clone is attached to the external buffer, not to m */
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone data");
+	if (!RTE_MBUF_HAS_EXTBUF(clone) || RTE_MBUF_INDIRECT(clone))
+		GOTO_FAIL("clone not attached to the external buffer");
+	if (rte_pktmbuf_mtod(clone, char *) != data)
+		GOTO_FAIL("bad data pointer in clone");
+	if (rte_mbuf_refcnt_read(m) != 1)
+		GOTO_FAIL("invalid refcnt in m");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 2)
+		GOTO_FAIL("invalid refcnt in shared data after clone");
+
+	rte_pktmbuf_free(m);
+	m = NULL;
+	if (freed != 0)
+		GOTO_FAIL("external buffer freed while still in use");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 1)
+		GOTO_FAIL("invalid refcnt in shared data after free");
+	if (*rte_pktmbuf_mtod(clone, char *) != (char)0xcc)
+		GOTO_FAIL("invalid data in clone");
+
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	if (freed != 1)
+		GOTO_FAIL("external buffer not freed");
+
+	rte_free(ext_buf);
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	if (m)
+		rte_pktmbuf_free(m);
+	if (clone)
+		rte_pktmbuf_free(clone);
+	if (freed == 0)
+		rte_free(ext_buf);
+	return -1;
+}
+
+static void
+ext_arena_free_cb(void *addr __rte_unused, void *opaque)
+{
+	rte_free(opaque);
+}
+
+/*
+ * Build mbufs referencing the chunks of a large arena, sharing a single
+ * refcnt, and compare the cost of a zero-copy clone to the cost of copying
+ * the data into a mempool buffer.
+ */
+static int
+test_pktmbuf_ext_arena(void)
+{
+	struct rte_mbuf_ext_shared_info shinfo;
+	struct rte_mbuf *m = NULL, *clone;
+	uint64_t start, attach_cycles = 0, clone_cycles = 0, copy_cycles = 0;
+	phys_addr_t arena_physaddr;
+	char *arena, *data;
+	unsigned int i, n;
+
+	arena = rte_malloc("test_ext_arena",
+		EXT_ARENA_CHUNK_NUM * EXT_ARENA_CHUNK_LEN, RTE_CACHE_LINE_SIZE);
+	if (arena == NULL)
+		GOTO_FAIL("cannot allocate arena");
+	arena_physaddr = rte_malloc_virt2phy(arena);
+	memset(arena, 0x5a, EXT_ARENA_CHUNK_NUM * EXT_ARENA_CHUNK_LEN);
+
+	/* one reference for the arena itself, released at the end */
+	shinfo.free_cb = ext_arena_free_cb;
+	shinfo.fcb_opaque = arena;
+	rte_mbuf_ext_refcnt_set(&shinfo, 1);
+
+	for (n = 0; n < EXT_ARENA_ITERATIONS; n++) {
+		for (i = 0; i < EXT_ARENA_CHUNK_NUM; i++) {
+			start = rte_rdtsc();
+			m = rte_pktmbuf_alloc(pktmbuf_pool);
+			if (m == NULL)
+				GOTO_FAIL("cannot allocate mbuf");
+			rte_mbuf_ext_refcnt_update(&shinfo, 1);
+			rte_pktmbuf_attach_extbuf(m,
+				arena + i * EXT_ARENA_CHUNK_LEN,
+				arena_physaddr + i * EXT_ARENA_CHUNK_LEN,
+				EXT_ARENA_CHUNK_LEN, &shinfo);
+			m->data_len = EXT_ARENA_CHUNK_LEN;
+			m->pkt_len = EXT_ARENA_CHUNK_LEN;
+			attach_cycles += rte_rdtsc() - start;
+
+			start = rte_rdtsc();
+			clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+			if (clone == NULL)
+				GOTO_FAIL("cannot clone mbuf");
+			rte_pktmbuf_free(clone);
+			clone_cycles += rte_rdtsc() - start;
+
+			start = rte_rdtsc();
+			rte_pktmbuf_free(m);
+			attach_cycles += rte_rdtsc() - start;
+
+			start = rte_rdtsc();
+			m = rte_pktmbuf_alloc(pktmbuf_pool);
+			if (m == NULL)
+				GOTO_FAIL("cannot allocate mbuf");
+			data = rte_pktmbuf_append(m, EXT_ARENA_CHUNK_LEN);
+			if (data == NULL)
+				GOTO_FAIL("cannot append data");
+			rte_memcpy(data, arena + i * EXT_ARENA_CHUNK_LEN,
+				EXT_ARENA_CHUNK_LEN);
+			rte_pktmbuf_free(m);
+			copy_cycles += rte_rdtsc() - start;
+		}
+	}
+	m = NULL;
+
+	if (rte_mbuf_ext_refcnt_read(&shinfo) != 1)
+		GOTO_FAIL("invalid refcnt in arena shared data");
+
+	n = EXT_ARENA_ITERATIONS * EXT_ARENA_CHUNK_NUM;
+	printf("%u bytes chunks: attach+free %.1f cycles, clone+free %.1f "
+		"cycles, copy+free %.1f cycles\n", EXT_ARENA_CHUNK_LEN,
+		(double)attach_cycles / n, (double)clone_cycles / n,
+		(double)copy_cycles / n);
+
+	if (rte_mbuf_ext_refcnt_update(&shinfo, -1) != 0)
+		GOTO_FAIL("arena still referenced");
+	shinfo.free_cb(arena, shinfo.fcb_opaque);
+
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	if (m)
+		rte_pktmbuf_free(m);
+	return -1;
+}
+
+/*
+ * Compare the cost of updating a dynamic field to the cost of updating
+ * the same data in the private area of the mbufs.
+ */
+static int
+test_mbuf_dyn_perf(int offset)
+{
+	struct rte_mbuf *mbufs[DYN_PERF_BURST];
+	uint64_t start, dyn_cycles, priv_cycles;
+	unsigned int i, n;
+
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool2, mbufs, DYN_PERF_BURST) != 0)
+		GOTO_FAIL("cannot allocate mbufs");
+
+	for (i = 0; i < DYN_PERF_BURST; i++) {
+		*RTE_MBUF_DYNFIELD(mbufs[i], offset, uint64_t *) = 0;
+		*(uint64_t *)(mbufs[i] + 1) = 0;
+	}
+
+	start = rte_rdtsc();
+	for (n = 0; n < DYN_PERF_ITERATIONS; n++)
+		for (i = 0; i < DYN_PERF_BURST; i++)
+			*RTE_MBUF_DYNFIELD(mbufs[i], offset, uint64_t *) += n;
+	dyn_cycles = rte_rdtsc() - start;
+
+	start = rte_rdtsc();
+	for (n = 0; n < DYN_PERF_ITERATIONS; n++)
+		for (i = 0; i < DYN_PERF_BURST; i++)
+			*(uint64_t *)(mbufs[i] + 1) += n;
+	priv_cycles = rte_rdtsc() - start;
+
+	for (i = 0; i < DYN_PERF_BURST; i++) {
+		if (*RTE_MBUF_DYNFIELD(mbufs[i], offset, uint64_t *) !=
+				*(uint64_t *)(mbufs[i] + 1))
+			GOTO_FAIL("bad dynamic field content");
+		rte_pktmbuf_free(mbufs[i]);
+	}
+
+	printf("mbuf field update: dynamic field %.2f cycles, "
+		"private area %.2f cycles\n",
+		(double)dyn_cycles / (DYN_PERF_ITERATIONS * DYN_PERF_BURST),
+		(double)priv_cycles / (DYN_PERF_ITERATIONS * DYN_PERF_BURST));
+
+	return 0;
+
+fail:
+	return -1;
+}
+
+static int
+test_mbuf_dyn(void)
+{
+	const struct rte_mbuf_dynfield dynfield = {
+		.name = "test-dynfield",
+		.size = sizeof(uint64_t),
+		.align = __alignof__(uint64_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fixed = {
+		.name = "test-dynfield-fixed",
+		.size = sizeof(uint8_t),
+		.align = __alignof__(uint8_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag = {
+		.name = "test-dynflag",
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag_fixed = {
+		.name = "test-dynflag-fixed",
+		.flags = 0,
+	};
+	struct rte_mbuf_dynfield dynfield_fail, params;
+	struct rte_mbuf_dynflag dynflag_fail;
+	struct rte_mbuf *m = NULL;
+	size_t fixed_offset;
+	int offset, offset2, flag, flag2, ret, i;
+
+	printf("Test mbuf dynamic fields and flags\n");
+
+	offset = rte_mbuf_dynfield_register(&dynfield);
+	if (offset < 0)
+		GOTO_FAIL("failed to register dynamic field, offset=%d: %s",
+			offset, strerror(rte_errno));
+	if ((size_t)offset < offsetof(struct rte_mbuf, dynfield1) ||
+			offset % __alignof__(uint64_t) != 0 ||
+			offset + sizeof(uint64_t) > sizeof(struct rte_mbuf))
+		GOTO_FAIL("dynamic field at bad offset %d", offset);
+
+	ret = rte_mbuf_dynfield_register(&dynfield);
+	if (ret != offset)
+		GOTO_FAIL("failed to register dynamic field again, ret=%d: %s",
+			ret, strerror(rte_errno));
+
+	ret = rte_mbuf_dynfield_lookup(dynfield.name, &params);
+	if (ret != offset || params.size != dynfield.size)
+		GOTO_FAIL("failed to lookup dynamic field");
+	if (rte_mbuf_dynfield_lookup("test-dynfield-unknown", NULL) != -1 ||
+			rte_errno != ENOENT)
+		GOTO_FAIL("unknown dynamic field found");
+
+	/* place a field at a given offset, the first time only */
+	fixed_offset = offsetof(struct rte_mbuf, dynfield1) +
+		sizeof(((struct rte_mbuf *)0)->dynfield1) - 1;
+	offset2 = rte_mbuf_dynfield_register_offset(&dynfield_fixed,
+		fixed_offset);
+	if (offset2 != (int)fixed_offset)
+		GOTO_FAIL("failed to register dynamic field at offset %zu, "
+			"ret=%d: %s", fixed_offset, offset2,
+			strerror(rte_errno));
+	memcpy(&dynfield_fail, &dynfield_fixed, sizeof(dynfield_fail));
+	snprintf(dynfield_fail.name, sizeof(dynfield_fail.name),
+		"test-dynfield-busy");
+	if (rte_mbuf_dynfield_register_offset(&dynfield_fail,
+			fixed_offset) != -1 || rte_errno != EBUSY)
+		GOTO_FAIL("dynamic field registered at a used offset");
+	if (rte_mbuf_dynfield_register_offset(&dynfield_fail, 0) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic field registered on a static field");
+
+	/* invalid parameters */
+	memcpy(&dynfield_fail, &dynfield, sizeof(dynfield_fail));
+	dynfield_fail.size = 1;
+	if (rte_mbuf_dynfield_register(&dynfield_fail) != -1 ||
+			rte_errno != EEXIST)
+		GOTO_FAIL("dynamic field registered with another size");
+	dynfield_fail.size = 0;
+	snprintf(dynfield_fail.name, sizeof(dynfield_fail.name),
+		"test-dynfield-invalid");
+	if (rte_mbuf_dynfield_register(&dynfield_fail) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic field registered with size 0");
+	dynfield_fail.size = 1;
+	dynfield_fail.align = 3;
+	if (rte_mbuf_dynfield_register(&dynfield_fail) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic field registered with bad alignment");
+	dynfield_fail.align = 1;
+	dynfield_fail.flags = 1;
+	if (rte_mbuf_dynfield_register(&dynfield_fail) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic field registered with bad flags");
+	dynfield_fail.flags = 0;
+	memset(dynfield_fail.name, 'a', sizeof(dynfield_fail.name));
+	if (rte_mbuf_dynfield_register(&dynfield_fail) != -1 ||
+			rte_errno != ENAMETOOLONG)
+		GOTO_FAIL("dynamic field registered with a too long name");
+
+	/* dynamic flags */
+	flag = rte_mbuf_dynflag_register(&dynflag);
+	if (flag < 0)
+		GOTO_FAIL("failed to register dynamic flag, flag=%d: %s",
+			flag, strerror(rte_errno));
+	if (rte_mbuf_dynflag_register(&dynflag) != flag ||
+			rte_mbuf_dynflag_lookup(dynflag.name, NULL) != flag)
+		GOTO_FAIL("failed to lookup dynamic flag");
+	flag2 = rte_mbuf_dynflag_register_bitnum(&dynflag_fixed, 40);
+	if (flag2 != 40)
+		GOTO_FAIL("failed to register dynamic flag 40, ret=%d: %s",
+			flag2, strerror(rte_errno));
+	memcpy(&dynflag_fail, &dynflag_fixed, sizeof(dynflag_fail));
+	snprintf(dynflag_fail.name, sizeof(dynflag_fail.name),
+		"test-dynflag-busy");
+	if (rte_mbuf_dynflag_register_bitnum(&dynflag_fail, 40) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic flag registered on a used bit");
+	if (rte_mbuf_dynflag_register_bitnum(&dynflag_fail, 62) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic flag registered on a static flag");
+	if (rte_mbuf_dynflag_register_bitnum(&dynflag_fail, 64) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic flag registered on bit 64");
+
+	/* use them */
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	*RTE_MBUF_DYNFIELD(m, offset, uint64_t *) = MAGIC_DATA;
+	*RTE_MBUF_DYNFIELD(m, offset2, uint8_t *) = 0x5a;
+	m->ol_flags |= 1ULL << flag;
+	if (m->dynfield1[(offset - offsetof(struct rte_mbuf, dynfield1)) /
+			sizeof(uint64_t)] != MAGIC_DATA ||
+			*RTE_MBUF_DYNFIELD(m, offset2, uint8_t *) != 0x5a)
+		GOTO_FAIL("bad dynamic field content");
+	rte_pktmbuf_free(m);
+	m = NULL;
+
+	if (test_mbuf_dyn_perf(offset) < 0)
+		GOTO_FAIL("dynamic field perf test failed");
+
+	/* fill the remaining space and flags */
+	for (i = 0; ; i++) {
+		memcpy(&dynfield_fail, &dynfield, sizeof(dynfield_fail));
+		snprintf(dynfield_fail.name, sizeof(dynfield_fail.name),
+			"test-dynfield-fill-%d", i);
+		dynfield_fail.size = 1;
+		dynfield_fail.align = 1;
+		if (rte_mbuf_dynfield_register(&dynfield_fail) < 0)
+			break;
+		if (i >= (int)sizeof(struct rte_mbuf))
+			GOTO_FAIL("too many dynamic fields registered");
+	}
+	if (rte_errno != ENOENT)
+		GOTO_FAIL("bad error when mbuf is full: %s",
+			strerror(rte_errno));
+	for (i = 0; ; i++) {
+		snprintf(dynflag_fail.name, sizeof(dynflag_fail.name),
+			"test-dynflag-fill-%d", i);
+		if (rte_mbuf_dynflag_register(&dynflag_fail) < 0)
+			break;
+		if (i >= 64)
+			GOTO_FAIL("too many dynamic flags registered");
+	}
+	if (rte_errno != ENOENT)
+		GOTO_FAIL("bad error when flags are full: %s",
+			strerror(rte_errno));
+
+	/* registered fields are still found */
+	if (rte_mbuf_dynfield_register(&dynfield) != offset)
+		GOTO_FAIL("dynamic field lost");
+
+	rte_mbuf_dyn_dump(stdout);
+
+	return 0;
+
+fail:
+	if (m)
+		rte_pktmbuf_free(m);
+	return -1;
+}
 #undef GOTO_FAIL
 
 /*
@@ -1132,6 +1577,21 @@ test_mbuf(void)
 		return -1;
 	}
 
+	if (test_pktmbuf_ext_shinfo_init_helper() < 0) {
+		printf("test_pktmbuf_ext_shinfo_init_helper() failed\n");
+		return -1;
+	}
+
+	if (test_pktmbuf_ext_arena() < 0) {
+		printf("test_pktmbuf_ext_arena() failed\n");
+		return -1;
+	}
+
+	if (test_mbuf_dyn() < 0) {
+		printf("test_mbuf_dyn() failed\n");
+		return -1;
+	}
+
 	if (test_refcnt_mbuf()<0){
 		printf("test_refcnt_mbuf() failed \n");
 		return -1;
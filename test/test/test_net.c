@@ -0,0 +1,630 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_net.h>
+
+#include "test.h"
+
+#define NET_POOL_SIZE      255
+#define NET_MBUF_SIZE      (2048 + RTE_PKTMBUF_HEADROOM)
+#define NET_PKT_MAX        2048
+#define NET_PAYLOAD_LEN    100
+#define NET_SEG_PAYLOAD    1000
+#define NET_SPORT          1234
+#define NET_DPORT          5678
+#define NET_VXLAN_PORT     4789
+
+/* description of the test packets */
+#define NET_T_VLAN         0x001
+#define NET_T_QINQ         0x002
+#define NET_T_IPV6         0x004
+#define NET_T_IP6_EXT      0x008
+#define NET_T_IP4_OPT      0x010
+#define NET_T_UDP          0x020
+#define NET_T_VXLAN        0x040
+#define NET_T_GRE          0x080
+#define NET_T_TUNNEL       (NET_T_VXLAN | NET_T_GRE)
+
+/* index of the vxlan/ipv4/tcp packet in net_cases[] */
+#define NET_CASE_VXLAN     6
+
+struct net_test_case {
+	const char *name;
+	uint32_t flags;
+	uint32_t ptype;
+};
+
+/* header lengths expected in the mbuf, using the TX offload conventions */
+struct net_exp_lens {
+	uint8_t outer_l2_len;
+	uint8_t outer_l3_len;
+	uint8_t l2_len;
+	uint8_t l3_len;
+	uint8_t l4_len;
+};
+
+static const struct net_test_case net_cases[] = {
+	{ "ipv4/tcp", 0,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_TCP },
+	{ "vlan/ipv4/udp", NET_T_VLAN | NET_T_UDP,
+	  RTE_PTYPE_L2_ETHER_VLAN | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_UDP },
+	{ "qinq/ipv4/tcp", NET_T_QINQ,
+	  RTE_PTYPE_L2_ETHER_QINQ | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_TCP },
+	{ "ipv4 options/tcp", NET_T_IP4_OPT,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4_EXT | RTE_PTYPE_L4_TCP },
+	{ "ipv6/udp", NET_T_IPV6 | NET_T_UDP,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_UDP },
+	{ "vlan/ipv6 ext/tcp", NET_T_VLAN | NET_T_IPV6 | NET_T_IP6_EXT,
+	  RTE_PTYPE_L2_ETHER_VLAN | RTE_PTYPE_L3_IPV6_EXT |
+	  RTE_PTYPE_L4_TCP },
+	{ "vxlan/ipv4/tcp", NET_T_VXLAN,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_UDP |
+	  RTE_PTYPE_TUNNEL_VXLAN | RTE_PTYPE_INNER_L2_ETHER |
+	  RTE_PTYPE_INNER_L3_IPV4 | RTE_PTYPE_INNER_L4_TCP },
+	{ "vlan/vxlan/ipv6/udp", NET_T_VLAN | NET_T_VXLAN | NET_T_IPV6 |
+	  NET_T_UDP,
+	  RTE_PTYPE_L2_ETHER_VLAN | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_UDP |
+	  RTE_PTYPE_TUNNEL_VXLAN | RTE_PTYPE_INNER_L2_ETHER |
+	  RTE_PTYPE_INNER_L3_IPV6 | RTE_PTYPE_INNER_L4_UDP },
+	{ "gre/ipv4 options/udp", NET_T_GRE | NET_T_IP4_OPT | NET_T_UDP,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_TUNNEL_GRE |
+	  RTE_PTYPE_INNER_L3_IPV4_EXT | RTE_PTYPE_INNER_L4_UDP },
+	{ "gre/ipv6 ext/tcp", NET_T_GRE | NET_T_IPV6 | NET_T_IP6_EXT,
+	  RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_TUNNEL_GRE |
+	  RTE_PTYPE_INNER_L3_IPV6_EXT | RTE_PTYPE_INNER_L4_TCP },
+};
+
+#define NET_NB_CASES RTE_DIM(net_cases)
+
+static struct rte_mempool *net_pool;
+
+static uint8_t net_buf[NET_PKT_MAX];
+
+/* write an IP header, a TCP or UDP header and a payload with valid
+ * checksums, return the length of the written data */
+static uint16_t
+net_build_l3(uint8_t *p, uint32_t flags, uint16_t payload_len,
+	uint8_t *l3_len, uint8_t *l4_len)
+{
+	uint8_t l4_proto = (flags & NET_T_UDP) ? IPPROTO_UDP : IPPROTO_TCP;
+	uint16_t l4_hlen = (flags & NET_T_UDP) ? sizeof(struct udp_hdr) :
+		sizeof(struct tcp_hdr);
+	uint16_t l4len = l4_hlen + payload_len;
+	uint16_t hlen, cksum, i;
+	uint32_t sum;
+	uint8_t *l4;
+
+	if (flags & NET_T_IPV6) {
+		struct ipv6_hdr *ip6 = (struct ipv6_hdr *)p;
+		struct {
+			uint32_t len;
+			uint8_t zero[3];
+			uint8_t proto;
+		} ph;
+
+		hlen = sizeof(*ip6) + ((flags & NET_T_IP6_EXT) ? 8 : 0);
+		memset(p, 0, hlen);
+		ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip6->payload_len = rte_cpu_to_be_16(hlen - sizeof(*ip6) +
+			l4len);
+		ip6->hop_limits = 64;
+		for (i = 0; i < sizeof(ip6->src_addr); i++) {
+			ip6->src_addr[i] = i + 1;
+			ip6->dst_addr[i] = 0x20 + i;
+		}
+		if (flags & NET_T_IP6_EXT) {
+			/* hop-by-hop options header with a PadN option */
+			ip6->proto = IPPROTO_HOPOPTS;
+			p[sizeof(*ip6)] = l4_proto;
+			p[sizeof(*ip6) + 2] = 1;
+			p[sizeof(*ip6) + 3] = 4;
+		} else {
+			ip6->proto = l4_proto;
+		}
+
+		memset(&ph, 0, sizeof(ph));
+		ph.len = rte_cpu_to_be_32(l4len);
+		ph.proto = l4_proto;
+		sum = __rte_raw_cksum(ip6->src_addr,
+			sizeof(ip6->src_addr) + sizeof(ip6->dst_addr), 0);
+		sum = __rte_raw_cksum(&ph, sizeof(ph), sum);
+	} else {
+		struct ipv4_hdr *ip4 = (struct ipv4_hdr *)p;
+		struct {
+			uint32_t src;
+			uint32_t dst;
+			uint8_t zero;
+			uint8_t proto;
+			uint16_t len;
+		} ph;
+
+		hlen = sizeof(*ip4) + ((flags & NET_T_IP4_OPT) ? 4 : 0);
+		memset(p, 0, hlen);
+		ip4->version_ihl = 0x40 | (hlen / 4);
+		ip4->total_length = rte_cpu_to_be_16(hlen + l4len);
+		ip4->time_to_live = 64;
+		ip4->next_proto_id = l4_proto;
+		ip4->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+		ip4->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+		/* NOP options */
+		if (flags & NET_T_IP4_OPT)
+			memset(p + sizeof(*ip4), 1, 4);
+		ip4->hdr_checksum = (uint16_t)~rte_raw_cksum(p, hlen);
+
+		memset(&ph, 0, sizeof(ph));
+		ph.src = ip4->src_addr;
+		ph.dst = ip4->dst_addr;
+		ph.proto = l4_proto;
+		ph.len = rte_cpu_to_be_16(l4len);
+		sum = __rte_raw_cksum(&ph, sizeof(ph), 0);
+	}
+
+	l4 = p + hlen;
+	memset(l4, 0, l4_hlen);
+	if (flags & NET_T_UDP) {
+		struct udp_hdr *uh = (struct udp_hdr *)l4;
+
+		uh->src_port = rte_cpu_to_be_16(NET_SPORT);
+		uh->dst_port = rte_cpu_to_be_16(NET_DPORT);
+		uh->dgram_len = rte_cpu_to_be_16(l4len);
+	} else {
+		struct tcp_hdr *th = (struct tcp_hdr *)l4;
+
+		th->src_port = rte_cpu_to_be_16(NET_SPORT);
+		th->dst_port = rte_cpu_to_be_16(NET_DPORT);
+		th->sent_seq = rte_cpu_to_be_32(1000);
+		th->data_off = (sizeof(*th) / 4) << 4;
+		th->tcp_flags = 0x10;
+		th->rx_win = rte_cpu_to_be_16(8192);
+	}
+	for (i = 0; i < payload_len; i++)
+		l4[l4_hlen + i] = (uint8_t)(i * 13 + 7);
+
+	sum = __rte_raw_cksum(l4, l4len, sum);
+	cksum = (uint16_t)~__rte_raw_cksum_reduce(sum);
+	if (flags & NET_T_UDP) {
+		if (cksum == 0)
+			cksum = 0xffff;
+		((struct udp_hdr *)l4)->dgram_cksum = cksum;
+	} else {
+		((struct tcp_hdr *)l4)->cksum = cksum;
+	}
+
+	*l3_len = hlen;
+	*l4_len = l4_hlen;
+	return hlen + l4len;
+}
+
+/* build a test packet in buf, return its length */
+static uint16_t
+net_build_pkt(uint8_t *buf, uint32_t flags, uint16_t payload_len,
+	struct net_exp_lens *exp)
+{
+	struct ether_hdr *eh = (struct ether_hdr *)buf;
+	struct vlan_hdr *vh;
+	uint16_t l3_type, inner_type, off, len;
+	uint8_t l3_len, l4_len;
+
+	memset(eh, 0, sizeof(*eh));
+	eh->d_addr.addr_bytes[0] = 0x02;
+	eh->s_addr.addr_bytes[0] = 0x04;
+	off = sizeof(*eh);
+
+	inner_type = (flags & NET_T_IPV6) ? ETHER_TYPE_IPv6 : ETHER_TYPE_IPv4;
+	l3_type = (flags & NET_T_TUNNEL) ? ETHER_TYPE_IPv4 : inner_type;
+
+	if (flags & NET_T_QINQ) {
+		eh->ether_type = rte_cpu_to_be_16(ETHER_TYPE_QINQ);
+		vh = (struct vlan_hdr *)(buf + off);
+		vh->vlan_tci = rte_cpu_to_be_16(1);
+		vh->eth_proto = rte_cpu_to_be_16(ETHER_TYPE_VLAN);
+		vh++;
+		vh->vlan_tci = rte_cpu_to_be_16(2);
+		vh->eth_proto = rte_cpu_to_be_16(l3_type);
+		off += 2 * sizeof(*vh);
+	} else if (flags & NET_T_VLAN) {
+		eh->ether_type = rte_cpu_to_be_16(ETHER_TYPE_VLAN);
+		vh = (struct vlan_hdr *)(buf + off);
+		vh->vlan_tci = rte_cpu_to_be_16(1);
+		vh->eth_proto = rte_cpu_to_be_16(l3_type);
+		off += sizeof(*vh);
+	} else {
+		eh->ether_type = rte_cpu_to_be_16(l3_type);
+	}
+
+	memset(exp, 0, sizeof(*exp));
+	if ((flags & NET_T_TUNNEL) == 0) {
+		len = net_build_l3(buf + off, flags, payload_len, &l3_len,
+			&l4_len);
+		exp->l2_len = off;
+		exp->l3_len = l3_len;
+		exp->l4_len = l4_len;
+		return off + len;
+	} else {
+		struct ipv4_hdr *ip4 = (struct ipv4_hdr *)(buf + off);
+		uint16_t l4 = off + sizeof(*ip4);
+		uint16_t inner, proto;
+
+		if (flags & NET_T_VXLAN) {
+			struct udp_hdr *uh = (struct udp_hdr *)(buf + l4);
+			struct vxlan_hdr *vxh = (struct vxlan_hdr *)(uh + 1);
+			struct ether_hdr *ieh = (struct ether_hdr *)(vxh + 1);
+
+			memset(uh, 0, sizeof(*uh));
+			uh->src_port = rte_cpu_to_be_16(NET_SPORT);
+			uh->dst_port = rte_cpu_to_be_16(NET_VXLAN_PORT);
+			vxh->vx_flags = rte_cpu_to_be_32(0x08000000);
+			vxh->vx_vni = rte_cpu_to_be_32(100 << 8);
+			memset(ieh, 0, sizeof(*ieh));
+			ieh->ether_type = rte_cpu_to_be_16(inner_type);
+			inner = l4 + ETHER_VXLAN_HLEN + sizeof(*ieh);
+		} else {
+			/* GRE header without options */
+			proto = rte_cpu_to_be_16(inner_type);
+			memset(buf + l4, 0, 2);
+			memcpy(buf + l4 + 2, &proto, sizeof(proto));
+			inner = l4 + 4;
+		}
+
+		len = net_build_l3(buf + inner, flags, payload_len, &l3_len,
+			&l4_len);
+		len += inner - l4;
+		if (flags & NET_T_VXLAN)
+			((struct udp_hdr *)(buf + l4))->dgram_len =
+				rte_cpu_to_be_16(len);
+
+		memset(ip4, 0, sizeof(*ip4));
+		ip4->version_ihl = 0x45;
+		ip4->total_length = rte_cpu_to_be_16(sizeof(*ip4) + len);
+		ip4->time_to_live = 64;
+		ip4->next_proto_id = (flags & NET_T_VXLAN) ? IPPROTO_UDP :
+			IPPROTO_GRE;
+		ip4->src_addr = rte_cpu_to_be_32(IPv4(192, 168, 0, 1));
+		ip4->dst_addr = rte_cpu_to_be_32(IPv4(192, 168, 0, 2));
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+
+		exp->outer_l2_len = off;
+		exp->outer_l3_len = sizeof(*ip4);
+		exp->l2_len = inner - l4;
+		exp->l3_len = l3_len;
+		exp->l4_len = l4_len;
+		return l4 + len;
+	}
+}
+
+/* copy a packet into a chain of mbufs, the data of segment i being
+ * seg_lens[i] bytes long and the last segment holding the rest */
+static struct rte_mbuf *
+net_pkt_to_mbuf(const uint8_t *buf, uint16_t len, const uint16_t *seg_lens,
+	unsigned int nb_segs)
+{
+	struct rte_mbuf *head = NULL, *m;
+	uint16_t off = 0, seglen;
+	unsigned int i;
+
+	for (i = 0; off < len; i++) {
+		m = rte_pktmbuf_alloc(net_pool);
+		if (m == NULL)
+			goto fail;
+		seglen = len - off;
+		if (i < nb_segs && seg_lens[i] < seglen)
+			seglen = seg_lens[i];
+		memcpy(rte_pktmbuf_append(m, seglen), buf + off, seglen);
+		off += seglen;
+
+		if (head == NULL) {
+			head = m;
+		} else if (rte_pktmbuf_chain(head, m) < 0) {
+			rte_pktmbuf_free(m);
+			goto fail;
+		}
+	}
+	return head;
+
+fail:
+	rte_pktmbuf_free(head);
+	return NULL;
+}
+
+/* return a pointer on a byte of packet data */
+static uint8_t *
+net_pkt_byte(struct rte_mbuf *m, uint32_t off)
+{
+	while (off >= rte_pktmbuf_data_len(m)) {
+		off -= rte_pktmbuf_data_len(m);
+		m = m->next;
+	}
+	return rte_pktmbuf_mtod_offset(m, uint8_t *, off);
+}
+
+static int
+net_check_lens(const struct rte_mbuf *m, const struct net_exp_lens *exp,
+	const char *name)
+{
+	if (m->outer_l2_len != exp->outer_l2_len ||
+			m->outer_l3_len != exp->outer_l3_len ||
+			m->l2_len != exp->l2_len ||
+			m->l3_len != exp->l3_len ||
+			m->l4_len != exp->l4_len) {
+		printf("%s: bad lengths %u/%u/%u/%u/%u, expected "
+			"%u/%u/%u/%u/%u\n", name, m->outer_l2_len,
+			m->outer_l3_len, m->l2_len, m->l3_len, m->l4_len,
+			exp->outer_l2_len, exp->outer_l3_len, exp->l2_len,
+			exp->l3_len, exp->l4_len);
+		return -1;
+	}
+	return 0;
+}
+
+/* parse a burst made of all the test packets */
+static int
+test_net_ptype_burst(void)
+{
+	struct rte_mbuf *pkts[NET_NB_CASES];
+	struct net_exp_lens exp[NET_NB_CASES];
+	struct rte_mbuf *m;
+	uint32_t ptype;
+	uint16_t len;
+	unsigned int i;
+	int ret = -1;
+
+	memset(pkts, 0, sizeof(pkts));
+	for (i = 0; i < NET_NB_CASES; i++) {
+		len = net_build_pkt(net_buf, net_cases[i].flags,
+			NET_PAYLOAD_LEN, &exp[i]);
+		pkts[i] = net_pkt_to_mbuf(net_buf, len, NULL, 0);
+		if (pkts[i] == NULL) {
+			printf("cannot allocate mbuf\n");
+			goto out;
+		}
+	}
+
+	rte_net_get_ptype_burst(pkts, NET_NB_CASES, RTE_PTYPE_ALL_MASK);
+
+	for (i = 0; i < NET_NB_CASES; i++) {
+		ptype = rte_net_get_ptype(pkts[i], NULL, RTE_PTYPE_ALL_MASK);
+		if (pkts[i]->packet_type != net_cases[i].ptype ||
+				ptype != net_cases[i].ptype) {
+			printf("%s: bad packet type 0x%x (single 0x%x), "
+				"expected 0x%x\n", net_cases[i].name,
+				pkts[i]->packet_type, ptype,
+				net_cases[i].ptype);
+			goto out;
+		}
+		if (net_check_lens(pkts[i], &exp[i], net_cases[i].name) < 0)
+			goto out;
+	}
+
+	/* without the tunnel layer, VXLAN is plain UDP */
+	rte_net_get_ptype_burst(&pkts[NET_CASE_VXLAN], 1, RTE_PTYPE_L2_MASK |
+		RTE_PTYPE_L3_MASK | RTE_PTYPE_L4_MASK);
+	m = pkts[NET_CASE_VXLAN];
+	if (m->packet_type != (RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_UDP) ||
+			m->l4_len != sizeof(struct udp_hdr)) {
+		printf("bad VXLAN packet type 0x%x without tunnel layer\n",
+			m->packet_type);
+		goto out;
+	}
+
+	ret = 0;
+out:
+	for (i = 0; i < NET_NB_CASES; i++)
+		rte_pktmbuf_free(pkts[i]);
+	return ret;
+}
+
+/* parse and verify a packet, check the resulting checksum flags */
+static int
+net_verify_one(struct rte_mbuf *m, uint64_t exp_flags, const char *name,
+	const char *what)
+{
+	uint64_t mask = PKT_RX_IP_CKSUM_MASK | PKT_RX_L4_CKSUM_MASK |
+		PKT_RX_EIP_CKSUM_BAD;
+	uint16_t nb_bad, exp_bad;
+
+	exp_bad = ((exp_flags & PKT_RX_IP_CKSUM_MASK) == PKT_RX_IP_CKSUM_BAD ||
+		(exp_flags & PKT_RX_L4_CKSUM_MASK) == PKT_RX_L4_CKSUM_BAD ||
+		(exp_flags & PKT_RX_EIP_CKSUM_BAD)) ? 1 : 0;
+
+	/* stale flags must be overwritten */
+	m->ol_flags = PKT_RX_IP_CKSUM_NONE | PKT_RX_L4_CKSUM_NONE;
+	rte_net_get_ptype_burst(&m, 1, RTE_PTYPE_ALL_MASK);
+	nb_bad = rte_net_rx_cksum_verify_burst(&m, 1);
+	if ((m->ol_flags & mask) != exp_flags || nb_bad != exp_bad) {
+		printf("%s (%s): bad flags 0x%" PRIx64 " (%u bad), expected "
+			"0x%" PRIx64 "\n", name, what, m->ol_flags & mask,
+			nb_bad, exp_flags);
+		return -1;
+	}
+	return 0;
+}
+
+/* check good and corrupted checksums of all the test packets, using
+ * single and multi-segment mbufs */
+static int
+net_test_cksum(const uint16_t *seg_lens, unsigned int nb_segs,
+	uint16_t payload_len)
+{
+	const struct net_test_case *tc;
+	struct net_exp_lens exp;
+	struct rte_mbuf *m = NULL;
+	uint64_t ip_flag, l4_good;
+	uint32_t inner_l3_off, ttl_off, last;
+	uint16_t len;
+	unsigned int i;
+
+	for (i = 0; i < NET_NB_CASES; i++) {
+		tc = &net_cases[i];
+		len = net_build_pkt(net_buf, tc->flags, payload_len, &exp);
+		inner_l3_off = exp.outer_l2_len + exp.outer_l3_len +
+			exp.l2_len;
+		ttl_off = offsetof(struct ipv4_hdr, time_to_live);
+		ip_flag = (tc->flags & NET_T_IPV6) ? PKT_RX_IP_CKSUM_UNKNOWN :
+			PKT_RX_IP_CKSUM_GOOD;
+		l4_good = PKT_RX_L4_CKSUM_GOOD;
+
+		m = net_pkt_to_mbuf(net_buf, len, seg_lens, nb_segs);
+		if (m == NULL)
+			goto fail;
+		if (net_verify_one(m, ip_flag | l4_good, tc->name, "good") < 0)
+			goto fail;
+
+		/* the TTL is covered by the IPv4 header checksum only */
+		if ((tc->flags & NET_T_IPV6) == 0) {
+			(*net_pkt_byte(m, inner_l3_off + ttl_off))--;
+			if (net_verify_one(m, PKT_RX_IP_CKSUM_BAD | l4_good,
+					tc->name, "bad ip") < 0)
+				goto fail;
+			(*net_pkt_byte(m, inner_l3_off + ttl_off))++;
+		}
+
+		/* the last byte of payload is in the last segment */
+		last = rte_pktmbuf_pkt_len(m) - 1;
+		(*net_pkt_byte(m, last)) ^= 0x5a;
+		if (net_verify_one(m, ip_flag | PKT_RX_L4_CKSUM_BAD,
+				tc->name, "bad l4") < 0)
+			goto fail;
+		(*net_pkt_byte(m, last)) ^= 0x5a;
+
+		if (tc->flags & NET_T_TUNNEL) {
+			(*net_pkt_byte(m, exp.outer_l2_len + ttl_off))--;
+			if (net_verify_one(m, PKT_RX_EIP_CKSUM_BAD | ip_flag |
+					l4_good, tc->name, "bad outer ip") < 0)
+				goto fail;
+		}
+
+		rte_pktmbuf_free(m);
+		m = NULL;
+	}
+
+	return 0;
+
+fail:
+	rte_pktmbuf_free(m);
+	return -1;
+}
+
+static int
+test_net_cksum_verify(void)
+{
+	/* odd sized segments, one of them splitting the IP header */
+	static const uint16_t seg_lens1[] = { 61, 333, 1, 128 };
+	static const uint16_t seg_lens2[] = { 20, 7, 500 };
+	struct net_exp_lens exp;
+	struct rte_mbuf *m;
+	uint16_t len;
+	int ret;
+
+	if (net_test_cksum(NULL, 0, NET_PAYLOAD_LEN) < 0)
+		return -1;
+	if (net_test_cksum(NULL, 0, NET_PAYLOAD_LEN + 1) < 0)
+		return -1;
+	if (net_test_cksum(seg_lens1, RTE_DIM(seg_lens1),
+			NET_SEG_PAYLOAD) < 0)
+		return -1;
+	if (net_test_cksum(seg_lens2, RTE_DIM(seg_lens2),
+			NET_SEG_PAYLOAD + 1) < 0)
+		return -1;
+
+	/* a null UDP checksum over IPv4 is not verified */
+	len = net_build_pkt(net_buf, NET_T_UDP, NET_PAYLOAD_LEN, &exp);
+	((struct udp_hdr *)(net_buf + exp.l2_len + exp.l3_len))->dgram_cksum =
+		0;
+	m = net_pkt_to_mbuf(net_buf, len, NULL, 0);
+	TEST_ASSERT_NOT_NULL(m, "cannot allocate mbuf");
+	ret = net_verify_one(m, PKT_RX_IP_CKSUM_GOOD |
+		PKT_RX_L4_CKSUM_UNKNOWN, "ipv4/udp", "null cksum");
+	rte_pktmbuf_free(m);
+	if (ret < 0)
+		return -1;
+
+	/* but it is invalid over IPv6 */
+	len = net_build_pkt(net_buf, NET_T_IPV6 | NET_T_UDP, NET_PAYLOAD_LEN,
+		&exp);
+	((struct udp_hdr *)(net_buf + exp.l2_len + exp.l3_len))->dgram_cksum =
+		0;
+	m = net_pkt_to_mbuf(net_buf, len, NULL, 0);
+	TEST_ASSERT_NOT_NULL(m, "cannot allocate mbuf");
+	ret = net_verify_one(m, PKT_RX_L4_CKSUM_BAD, "ipv6/udp",
+		"null cksum");
+	rte_pktmbuf_free(m);
+
+	return ret;
+}
+
+static int
+test_net(void)
+{
+	int ret = -1;
+
+	net_pool = rte_pktmbuf_pool_create("test_net_pool", NET_POOL_SIZE,
+		0, 0, NET_MBUF_SIZE, SOCKET_ID_ANY);
+	if (net_pool == NULL) {
+		printf("cannot create mbuf pool\n");
+		return -1;
+	}
+
+	if (test_net_ptype_burst() < 0) {
+		printf("test_net_ptype_burst() failed\n");
+		goto out;
+	}
+	if (test_net_cksum_verify() < 0) {
+		printf("test_net_cksum_verify() failed\n");
+		goto out;
+	}
+	if (rte_mempool_avail_count(net_pool) != NET_POOL_SIZE) {
+		printf("mbuf leak\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	rte_mempool_free(net_pool);
+	net_pool = NULL;
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(net_autotest, test_net);
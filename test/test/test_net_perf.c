@@ -0,0 +1,262 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_net.h>
+
+#include "test.h"
+
+#define NET_PERF_POOL_SIZE     255
+#define NET_PERF_MBUF_SIZE     (2048 + RTE_PKTMBUF_HEADROOM)
+#define NET_PERF_BURST         32
+#define NET_PERF_ITERATIONS    10000
+
+static struct rte_mempool *net_perf_pool;
+
+static const uint16_t net_perf_payload_lens[] = { 18, 512, 1400 };
+
+/* build a TCP or UDP packet over IPv4 or IPv6 with an optional VLAN tag
+ * and valid checksums */
+static struct rte_mbuf *
+net_perf_build(unsigned int variant, uint16_t payload_len)
+{
+	int vlan = variant & 1, udp = variant & 2, ipv6 = variant & 4;
+	uint16_t l2_len, l3_len, l4_len, i;
+	struct ether_hdr *eh;
+	struct rte_mbuf *m;
+	uint8_t *p, *l4;
+
+	m = rte_pktmbuf_alloc(net_perf_pool);
+	if (m == NULL)
+		return NULL;
+
+	l2_len = sizeof(*eh) + (vlan ? sizeof(struct vlan_hdr) : 0);
+	l3_len = ipv6 ? sizeof(struct ipv6_hdr) : sizeof(struct ipv4_hdr);
+	l4_len = udp ? sizeof(struct udp_hdr) : sizeof(struct tcp_hdr);
+	p = (uint8_t *)rte_pktmbuf_append(m, l2_len + l3_len + l4_len +
+		payload_len);
+	if (p == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(p, 0, l2_len + l3_len + l4_len);
+
+	eh = (struct ether_hdr *)p;
+	eh->ether_type = rte_cpu_to_be_16(ipv6 ? ETHER_TYPE_IPv6 :
+		ETHER_TYPE_IPv4);
+	if (vlan) {
+		struct vlan_hdr *vh = (struct vlan_hdr *)(eh + 1);
+
+		vh->eth_proto = eh->ether_type;
+		vh->vlan_tci = rte_cpu_to_be_16(variant);
+		eh->ether_type = rte_cpu_to_be_16(ETHER_TYPE_VLAN);
+	}
+
+	l4 = p + l2_len + l3_len;
+	for (i = 0; i < payload_len; i++)
+		l4[l4_len + i] = (uint8_t)(i + variant);
+	if (udp) {
+		struct udp_hdr *uh = (struct udp_hdr *)l4;
+
+		uh->src_port = rte_cpu_to_be_16(1000 + variant);
+		uh->dst_port = rte_cpu_to_be_16(2000);
+		uh->dgram_len = rte_cpu_to_be_16(l4_len + payload_len);
+	} else {
+		struct tcp_hdr *th = (struct tcp_hdr *)l4;
+
+		th->src_port = rte_cpu_to_be_16(1000 + variant);
+		th->dst_port = rte_cpu_to_be_16(2000);
+		th->data_off = (sizeof(*th) / 4) << 4;
+	}
+
+	if (ipv6) {
+		struct ipv6_hdr *ip6 = (struct ipv6_hdr *)(p + l2_len);
+		uint16_t cksum;
+
+		ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip6->payload_len = rte_cpu_to_be_16(l4_len + payload_len);
+		ip6->proto = udp ? IPPROTO_UDP : IPPROTO_TCP;
+		ip6->hop_limits = 64;
+		ip6->src_addr[15] = 1;
+		ip6->dst_addr[15] = 2;
+		cksum = rte_ipv6_udptcp_cksum(ip6, l4);
+		if (udp)
+			((struct udp_hdr *)l4)->dgram_cksum = cksum;
+		else
+			((struct tcp_hdr *)l4)->cksum = cksum;
+	} else {
+		struct ipv4_hdr *ip4 = (struct ipv4_hdr *)(p + l2_len);
+		uint16_t cksum;
+
+		ip4->version_ihl = 0x45;
+		ip4->total_length = rte_cpu_to_be_16(l3_len + l4_len +
+			payload_len);
+		ip4->time_to_live = 64;
+		ip4->next_proto_id = udp ? IPPROTO_UDP : IPPROTO_TCP;
+		ip4->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+		ip4->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+		cksum = rte_ipv4_udptcp_cksum(ip4, l4);
+		if (udp)
+			((struct udp_hdr *)l4)->dgram_cksum = cksum;
+		else
+			((struct tcp_hdr *)l4)->cksum = cksum;
+	}
+
+	return m;
+}
+
+/* reference: per packet checksum verification with the rte_ip.h helpers */
+static unsigned int
+net_perf_cksum_scalar(struct rte_mbuf **pkts, unsigned int nb_pkts)
+{
+	unsigned int i, nb_bad = 0;
+	struct rte_mbuf *m;
+	void *l3, *l4;
+
+	for (i = 0; i < nb_pkts; i++) {
+		m = pkts[i];
+		l3 = rte_pktmbuf_mtod_offset(m, void *, m->l2_len);
+		l4 = (uint8_t *)l3 + m->l3_len;
+		if (RTE_ETH_IS_IPV4_HDR(m->packet_type)) {
+			if (rte_ipv4_cksum(l3) != 0xffff)
+				nb_bad++;
+			if (rte_ipv4_udptcp_cksum(l3, l4) != 0xffff)
+				nb_bad++;
+		} else if (rte_ipv6_udptcp_cksum(l3, l4) != 0xffff) {
+			nb_bad++;
+		}
+	}
+	return nb_bad;
+}
+
+static int
+net_perf_run(uint16_t payload_len)
+{
+	struct rte_mbuf *pkts[NET_PERF_BURST];
+	struct rte_net_hdr_lens hdr_lens;
+	uint64_t start, single = 0, burst = 0, scalar = 0, verify = 0;
+	unsigned int i, j, nb_bad = 0;
+	int ret = -1;
+
+	memset(pkts, 0, sizeof(pkts));
+	for (i = 0; i < NET_PERF_BURST; i++) {
+		pkts[i] = net_perf_build(i % 8, payload_len);
+		if (pkts[i] == NULL) {
+			printf("cannot build packet\n");
+			goto out;
+		}
+	}
+
+	for (j = 0; j < NET_PERF_ITERATIONS; j++) {
+		start = rte_rdtsc();
+		for (i = 0; i < NET_PERF_BURST; i++) {
+			pkts[i]->packet_type = rte_net_get_ptype(pkts[i],
+				&hdr_lens, RTE_PTYPE_ALL_MASK);
+			pkts[i]->l2_len = hdr_lens.l2_len;
+			pkts[i]->l3_len = hdr_lens.l3_len;
+			pkts[i]->l4_len = hdr_lens.l4_len;
+		}
+		single += rte_rdtsc() - start;
+
+		start = rte_rdtsc();
+		rte_net_get_ptype_burst(pkts, NET_PERF_BURST,
+			RTE_PTYPE_ALL_MASK);
+		burst += rte_rdtsc() - start;
+
+		start = rte_rdtsc();
+		nb_bad += net_perf_cksum_scalar(pkts, NET_PERF_BURST);
+		scalar += rte_rdtsc() - start;
+
+		start = rte_rdtsc();
+		nb_bad += rte_net_rx_cksum_verify_burst(pkts, NET_PERF_BURST);
+		verify += rte_rdtsc() - start;
+	}
+
+	if (nb_bad != 0) {
+		printf("%u bad checksums\n", nb_bad);
+		goto out;
+	}
+
+	printf("payload %4u: ptype single %5.1f burst %5.1f, "
+		"cksum scalar %6.1f burst %6.1f (cycles/pkt)\n",
+		payload_len,
+		(double)single / (NET_PERF_ITERATIONS * NET_PERF_BURST),
+		(double)burst / (NET_PERF_ITERATIONS * NET_PERF_BURST),
+		(double)scalar / (NET_PERF_ITERATIONS * NET_PERF_BURST),
+		(double)verify / (NET_PERF_ITERATIONS * NET_PERF_BURST));
+
+	ret = 0;
+out:
+	for (i = 0; i < NET_PERF_BURST; i++)
+		rte_pktmbuf_free(pkts[i]);
+	return ret;
+}
+
+static int
+test_net_perf(void)
+{
+	unsigned int i;
+	int ret = 0;
+
+	net_perf_pool = rte_pktmbuf_pool_create("test_net_perf_pool",
+		NET_PERF_POOL_SIZE, 0, 0, NET_PERF_MBUF_SIZE, SOCKET_ID_ANY);
+	if (net_perf_pool == NULL) {
+		printf("cannot create mbuf pool\n");
+		return -1;
+	}
+
+	for (i = 0; i < RTE_DIM(net_perf_payload_lens); i++) {
+		ret = net_perf_run(net_perf_payload_lens[i]);
+		if (ret < 0)
+			break;
+	}
+
+	rte_mempool_free(net_perf_pool);
+	net_perf_pool = NULL;
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(net_perf_autotest, test_net_perf);
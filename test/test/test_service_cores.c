@@ -0,0 +1,437 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_memory.h>
+#include <rte_service.h>
+#include <rte_service_component.h>
+
+#include "test.h"
+
+/*
+ * Service cores
+ * =============
+ *
+ * - Register dummy services and check their lookup, capabilities and
+ *   unregistration.
+ *
+ * - Give a slave lcore to the services and check it leaves the lcores
+ *   of the application.
+ *
+ * - Map a counting service to the service core and check it is run only
+ *   while both the service and the service core are running, and that the
+ *   statistics account for every call.
+ *
+ * - Map a service which is not multi-thread safe to two service cores and
+ *   check it is never run concurrently.
+ *
+ * The tests using service cores need one or two slave lcores, and are
+ * skipped otherwise.
+ */
+
+#define SERVICE_NAME "service_dummy"
+#define SERVICE_NAME_2 "service_dummy_2"
+#define SERVICE_DELAY_MS 100
+
+static rte_atomic64_t service_calls;
+static rte_atomic32_t service_concurrent;
+static volatile int service_overlap;
+
+/* Number of calls of the dummy services, unsigned like the statistics */
+static uint64_t
+service_calls_read(void)
+{
+	return rte_atomic64_read(&service_calls);
+}
+
+static int32_t
+dummy_cb(void *args)
+{
+	RTE_SET_USED(args);
+	rte_atomic64_inc(&service_calls);
+	return 0;
+}
+
+static int32_t
+dummy_unsafe_cb(void *args)
+{
+	RTE_SET_USED(args);
+	if (rte_atomic32_add_return(&service_concurrent, 1) != 1)
+		service_overlap = 1;
+	rte_delay_us(10);
+	rte_atomic64_inc(&service_calls);
+	rte_atomic32_dec(&service_concurrent);
+	return 0;
+}
+
+static int
+dummy_register(const char *name, rte_service_func cb, uint32_t capabilities,
+		uint32_t *id)
+{
+	struct rte_service_spec spec;
+
+	memset(&spec, 0, sizeof(spec));
+	snprintf(spec.name, sizeof(spec.name), "%s", name);
+	spec.callback = cb;
+	spec.capabilities = capabilities;
+	spec.socket_id = SOCKET_ID_ANY;
+
+	return rte_service_component_register(&spec, id);
+}
+
+/* get the n-th slave lcore available to the application */
+static unsigned int
+slave_lcore_get(unsigned int n)
+{
+	unsigned int lcore_id;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n-- == 0)
+			return lcore_id;
+	}
+
+	return RTE_MAX_LCORE;
+}
+
+static int
+testsuite_setup(void)
+{
+	rte_atomic64_init(&service_calls);
+	rte_atomic32_init(&service_concurrent);
+	return TEST_SUCCESS;
+}
+
+static void
+service_teardown(void)
+{
+	uint32_t lcores[RTE_MAX_LCORE];
+	int32_t i, n;
+	uint32_t id;
+
+	rte_service_lcore_reset_all();
+	n = rte_service_lcore_list(lcores, RTE_DIM(lcores));
+	for (i = 0; i < n; i++)
+		rte_service_lcore_del(lcores[i]);
+
+	if (rte_service_get_by_name(SERVICE_NAME, &id) == 0)
+		rte_service_component_unregister(id);
+	if (rte_service_get_by_name(SERVICE_NAME_2, &id) == 0)
+		rte_service_component_unregister(id);
+
+	rte_atomic64_clear(&service_calls);
+	service_overlap = 0;
+}
+
+static int
+test_service_register(void)
+{
+	struct rte_service_spec spec;
+	uint32_t count = rte_service_get_count();
+	uint32_t id, found;
+
+	memset(&spec, 0, sizeof(spec));
+	TEST_ASSERT_EQUAL(rte_service_component_register(NULL, &id), -EINVAL,
+		"Registered a NULL service");
+	TEST_ASSERT_EQUAL(rte_service_component_register(&spec, &id), -EINVAL,
+		"Registered a service without name");
+	snprintf(spec.name, sizeof(spec.name), SERVICE_NAME);
+	TEST_ASSERT_EQUAL(rte_service_component_register(&spec, &id), -EINVAL,
+		"Registered a service without callback");
+
+	TEST_ASSERT_SUCCESS(dummy_register(SERVICE_NAME, dummy_cb,
+			RTE_SERVICE_CAP_MT_SAFE, &id),
+		"Failed to register service");
+	TEST_ASSERT_EQUAL(dummy_register(SERVICE_NAME, dummy_cb, 0, NULL),
+		-EEXIST, "Registered a service twice");
+	TEST_ASSERT_EQUAL(rte_service_get_count(), count + 1,
+		"Wrong number of services");
+
+	TEST_ASSERT_SUCCESS(rte_service_get_by_name(SERVICE_NAME, &found),
+		"Failed to find service by name");
+	TEST_ASSERT_EQUAL(found, id, "Wrong service id found by name");
+	TEST_ASSERT_EQUAL(rte_service_get_by_name("no_such_service", &found),
+		-ENODEV, "Found a service which is not registered");
+	TEST_ASSERT_SUCCESS(strcmp(rte_service_get_name(id), SERVICE_NAME),
+		"Wrong service name");
+
+	TEST_ASSERT_EQUAL(rte_service_probe_capability(id,
+			RTE_SERVICE_CAP_MT_SAFE), 1,
+		"Service should be MT safe");
+	TEST_ASSERT_EQUAL(rte_service_runstate_get(id), 0,
+		"Service should be registered stopped");
+
+	TEST_ASSERT_SUCCESS(rte_service_component_unregister(id),
+		"Failed to unregister service");
+	TEST_ASSERT_EQUAL(rte_service_get_count(), count,
+		"Wrong number of services after unregister");
+	TEST_ASSERT_NULL(rte_service_get_name(id),
+		"Service name returned after unregister");
+	TEST_ASSERT_EQUAL(rte_service_component_unregister(id), -EINVAL,
+		"Unregistered a service twice");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_service_lcore_add_del(void)
+{
+	unsigned int lcore_id = slave_lcore_get(0);
+	unsigned int lcore_count = rte_lcore_count();
+	uint32_t lcores[RTE_MAX_LCORE];
+
+	if (lcore_id == RTE_MAX_LCORE) {
+		printf("Not enough lcores, skipping test\n");
+		return -ENOTSUP;
+	}
+
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(rte_get_master_lcore()),
+		-EINVAL, "Added the master lcore as service core");
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(RTE_MAX_LCORE), -EINVAL,
+		"Added an invalid lcore as service core");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcore_id),
+		"Failed to add service core");
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(lcore_id), -EALREADY,
+		"Added a service core twice");
+	TEST_ASSERT_EQUAL(rte_service_lcore_count(), 1,
+		"Wrong number of service cores");
+	TEST_ASSERT_EQUAL(rte_service_lcore_list(lcores, RTE_DIM(lcores)), 1,
+		"Wrong number of listed service cores");
+	TEST_ASSERT_EQUAL(lcores[0], lcore_id, "Wrong service core listed");
+	TEST_ASSERT_EQUAL(rte_service_lcore_list(lcores, 0), -ENOMEM,
+		"Listed service cores in a too small array");
+
+	TEST_ASSERT_EQUAL(rte_lcore_count(), lcore_count - 1,
+		"Service core still counted as application lcore");
+	TEST_ASSERT(!rte_lcore_is_enabled(lcore_id),
+		"Service core still enabled for the application");
+	TEST_ASSERT_EQUAL(rte_eal_lcore_role(lcore_id), ROLE_SERVICE,
+		"Wrong role of the service core");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_del(lcore_id),
+		"Failed to remove service core");
+	TEST_ASSERT_EQUAL(rte_service_lcore_del(lcore_id), -EINVAL,
+		"Removed a service core twice");
+	TEST_ASSERT_EQUAL(rte_lcore_count(), lcore_count,
+		"Lcore not given back to the application");
+	TEST_ASSERT(rte_lcore_is_enabled(lcore_id),
+		"Lcore not enabled back for the application");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_service_map_run(void)
+{
+	unsigned int lcore_id = slave_lcore_get(0);
+	struct rte_service_stats stats;
+	uint64_t calls;
+	uint32_t id;
+
+	if (lcore_id == RTE_MAX_LCORE) {
+		printf("Not enough lcores, skipping test\n");
+		return -ENOTSUP;
+	}
+
+	TEST_ASSERT_SUCCESS(dummy_register(SERVICE_NAME, dummy_cb,
+			RTE_SERVICE_CAP_MT_SAFE, &id),
+		"Failed to register service");
+	TEST_ASSERT_EQUAL(rte_service_map_lcore_set(id, lcore_id, 1), -EINVAL,
+		"Mapped a service to a regular lcore");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcore_id),
+		"Failed to add service core");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore_id, 1),
+		"Failed to map service");
+	TEST_ASSERT_EQUAL(rte_service_map_lcore_get(id, lcore_id), 1,
+		"Service not mapped");
+	TEST_ASSERT_EQUAL(rte_service_lcore_count_services(lcore_id), 1,
+		"Wrong number of services mapped");
+	TEST_ASSERT_SUCCESS(rte_service_set_stats_enable(id, 1),
+		"Failed to enable statistics");
+
+	/* the service is stopped: the service core does not run it */
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcore_id),
+		"Failed to start service core");
+	TEST_ASSERT_EQUAL(rte_service_lcore_start(lcore_id), -EALREADY,
+		"Started a service core twice");
+	rte_delay_ms(SERVICE_DELAY_MS);
+	TEST_ASSERT_EQUAL(service_calls_read(), 0,
+		"Stopped service was run");
+
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id, 1),
+		"Failed to start service");
+	rte_delay_ms(SERVICE_DELAY_MS);
+	TEST_ASSERT_EQUAL(rte_service_lcore_del(lcore_id), -EBUSY,
+		"Removed a running service core");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_stop(lcore_id),
+		"Failed to stop service core");
+	TEST_ASSERT_EQUAL(rte_service_lcore_stop(lcore_id), -EALREADY,
+		"Stopped a service core twice");
+
+	calls = service_calls_read();
+	TEST_ASSERT(calls > 0, "Running service was not run");
+	TEST_ASSERT_SUCCESS(rte_service_stats_get(id, &stats),
+		"Failed to get statistics");
+	TEST_ASSERT_EQUAL(stats.calls, calls,
+		"Statistics do not account for all the calls");
+	printf("Service run %"PRIu64" times in %u ms, %"PRIu64
+		" cycles per call\n", stats.calls, SERVICE_DELAY_MS,
+		stats.cycles / stats.calls);
+	rte_service_dump(stdout, UINT32_MAX);
+
+	/* the service core is stopped: the service is no longer run */
+	rte_delay_ms(SERVICE_DELAY_MS);
+	TEST_ASSERT_EQUAL(service_calls_read(), calls,
+		"Service run by a stopped service core");
+
+	/* unmapped services are not run */
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore_id, 0),
+		"Failed to unmap service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcore_id),
+		"Failed to restart service core");
+	rte_delay_ms(SERVICE_DELAY_MS);
+	TEST_ASSERT_EQUAL(service_calls_read(), calls,
+		"Unmapped service was run");
+
+	/* unregistration waits for the running callback */
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore_id, 1),
+		"Failed to map service");
+	rte_delay_ms(SERVICE_DELAY_MS);
+	TEST_ASSERT_SUCCESS(rte_service_component_unregister(id),
+		"Failed to unregister running service");
+	calls = service_calls_read();
+	rte_delay_ms(SERVICE_DELAY_MS);
+	TEST_ASSERT_EQUAL(service_calls_read(), calls,
+		"Unregistered service was run");
+	TEST_ASSERT_EQUAL(rte_service_lcore_count_services(lcore_id), 0,
+		"Unregistered service still mapped");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_service_app_lcore(void)
+{
+	uint32_t id;
+
+	TEST_ASSERT_SUCCESS(dummy_register(SERVICE_NAME, dummy_cb, 0, &id),
+		"Failed to register service");
+	TEST_ASSERT_EQUAL(rte_service_run_iter_on_app_lcore(id), -ENOEXEC,
+		"Ran a stopped service");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id, 1),
+		"Failed to start service");
+	TEST_ASSERT_SUCCESS(rte_service_run_iter_on_app_lcore(id),
+		"Failed to run service");
+	TEST_ASSERT_EQUAL(service_calls_read(), 1,
+		"Service callback not called");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_service_mt_unsafe(void)
+{
+	unsigned int lcore_0 = slave_lcore_get(0);
+	unsigned int lcore_1 = slave_lcore_get(1);
+	uint32_t id;
+
+	if (lcore_1 == RTE_MAX_LCORE) {
+		printf("Not enough lcores, skipping test\n");
+		return -ENOTSUP;
+	}
+
+	TEST_ASSERT_SUCCESS(dummy_register(SERVICE_NAME_2, dummy_unsafe_cb, 0,
+			&id), "Failed to register service");
+	TEST_ASSERT_EQUAL(rte_service_probe_capability(id,
+			RTE_SERVICE_CAP_MT_SAFE), 0,
+		"Service should not be MT safe");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcore_0),
+		"Failed to add service core");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcore_1),
+		"Failed to add service core");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore_0, 1),
+		"Failed to map service");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore_1, 1),
+		"Failed to map service");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id, 1),
+		"Failed to start service");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcore_0),
+		"Failed to start service core");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcore_1),
+		"Failed to start service core");
+	rte_delay_ms(SERVICE_DELAY_MS);
+	TEST_ASSERT_SUCCESS(rte_service_lcore_reset_all(),
+		"Failed to reset service cores");
+
+	TEST_ASSERT(service_calls_read() > 0,
+		"Running service was not run");
+	TEST_ASSERT(!service_overlap,
+		"Service which is not MT safe run concurrently");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite service_cores_testsuite = {
+	.suite_name = "Service cores unit test suite",
+	.setup = testsuite_setup,
+	.unit_test_cases = {
+		TEST_CASE_ST(NULL, service_teardown, test_service_register),
+		TEST_CASE_ST(NULL, service_teardown,
+			test_service_lcore_add_del),
+		TEST_CASE_ST(NULL, service_teardown, test_service_map_run),
+		TEST_CASE_ST(NULL, service_teardown, test_service_app_lcore),
+		TEST_CASE_ST(NULL, service_teardown, test_service_mt_unsafe),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_service_cores(void)
+{
+	return unit_test_suite_runner(&service_cores_testsuite);
+}
+
+REGISTER_TEST_COMMAND(service_autotest, test_service_cores);
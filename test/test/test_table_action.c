@@ -0,0 +1,670 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_meter.h>
+#include <rte_ring.h>
+#include <rte_port_ring.h>
+#include <rte_table_stub.h>
+#include <rte_pipeline.h>
+#include <rte_table_action.h>
+
+#include "test.h"
+
+#define TA_POOL_SIZE             1024
+#define TA_BURST_SIZE            64
+#define TA_PERF_ITERATIONS       20000
+#define TA_RING_SIZE             64
+#define TA_RING_BURST_SIZE       32
+
+#define TA_COLOR_OFFSET          (sizeof(struct rte_mbuf))
+#define TA_IP_OFFSET             (sizeof(struct rte_mbuf) + \
+	RTE_PKTMBUF_HEADROOM + sizeof(struct ether_hdr))
+
+#define TA_SRC_IP                IPv4(10, 0, 0, 1)
+#define TA_DST_IP                IPv4(10, 0, 0, 2)
+#define TA_NAT_IP                IPv4(192, 168, 1, 1)
+#define TA_SRC_PORT              1000
+#define TA_DST_PORT              2000
+#define TA_NAT_PORT              3000
+#define TA_PAYLOAD_LEN           64
+
+/* Rule data: pipeline table entry head followed by the action data */
+static uint8_t rule_data[512] __rte_cache_aligned;
+
+static struct rte_mempool *ta_pool;
+
+static struct rte_mbuf *
+ta_pkt_build(uint8_t ttl)
+{
+	struct rte_mbuf *m;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	uint16_t pkt_len = sizeof(*eth) + sizeof(*ip) + sizeof(*udp) +
+		TA_PAYLOAD_LEN;
+
+	m = rte_pktmbuf_alloc(ta_pool);
+	if (m == NULL)
+		return NULL;
+
+	eth = (struct ether_hdr *) rte_pktmbuf_append(m, pkt_len);
+	if (eth == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(eth, 0, pkt_len);
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+
+	ip = (struct ipv4_hdr *) &eth[1];
+	ip->version_ihl = 0x45;
+	ip->type_of_service = 0;
+	ip->total_length = rte_cpu_to_be_16(pkt_len - sizeof(*eth));
+	ip->time_to_live = ttl;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(TA_SRC_IP);
+	ip->dst_addr = rte_cpu_to_be_32(TA_DST_IP);
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+
+	udp = (struct udp_hdr *) &ip[1];
+	udp->src_port = rte_cpu_to_be_16(TA_SRC_PORT);
+	udp->dst_port = rte_cpu_to_be_16(TA_DST_PORT);
+	udp->dgram_len = rte_cpu_to_be_16(sizeof(*udp) + TA_PAYLOAD_LEN);
+	udp->dgram_cksum = rte_ipv4_udptcp_cksum(ip, udp);
+
+	return m;
+}
+
+static void
+ta_mtr_params_set(struct rte_table_action_mtr_params *mtr,
+	uint64_t rate)
+{
+	uint32_t i;
+
+	memset(mtr, 0, sizeof(*mtr));
+	mtr->tc_mask = 1;
+	mtr->mtr[0].meter.cir = rate;
+	mtr->mtr[0].meter.pir = rate;
+	mtr->mtr[0].meter.cbs = rate;
+	mtr->mtr[0].meter.pbs = rate;
+	for (i = 0; i < e_RTE_METER_COLORS; i++)
+		mtr->mtr[0].policer[i] =
+			(enum rte_table_action_policer) i;
+}
+
+static struct rte_table_action *
+ta_create(int nat, int ttl, int encap)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = TA_IP_OFFSET,
+	};
+	struct rte_table_action_mtr_config mtr = {
+		.n_tc = 1,
+		.color_offset = TA_COLOR_OFFSET,
+	};
+	struct rte_table_action_nat_config nat_cfg = {
+		.source_nat = 1,
+		.proto = IPPROTO_UDP,
+	};
+	struct rte_table_action_ttl_config ttl_cfg = {
+		.drop = 1,
+		.n_packets_enabled = 1,
+	};
+	struct rte_table_action_encap_config encap_cfg = {
+		.encap_mask = 1LLU << RTE_TABLE_ACTION_ENCAP_VLAN,
+	};
+	struct rte_table_action_stats_config stats = {
+		.n_packets_enabled = 1,
+		.n_bytes_enabled = 1,
+	};
+	struct rte_table_action_profile *ap;
+	struct rte_table_action *a = NULL;
+
+	ap = rte_table_action_profile_create(&common);
+	if (ap == NULL)
+		return NULL;
+
+	if (rte_table_action_profile_action_register(ap,
+		RTE_TABLE_ACTION_MTR, &mtr) ||
+		rte_table_action_profile_action_register(ap,
+		RTE_TABLE_ACTION_STATS, &stats))
+		goto exit;
+
+	if (nat && rte_table_action_profile_action_register(ap,
+		RTE_TABLE_ACTION_NAT, &nat_cfg))
+		goto exit;
+
+	if (ttl && rte_table_action_profile_action_register(ap,
+		RTE_TABLE_ACTION_TTL, &ttl_cfg))
+		goto exit;
+
+	if (encap && rte_table_action_profile_action_register(ap,
+		RTE_TABLE_ACTION_ENCAP, &encap_cfg))
+		goto exit;
+
+	/* Actions cannot be registered twice */
+	if (rte_table_action_profile_action_register(ap,
+		RTE_TABLE_ACTION_STATS, &stats) == 0)
+		goto exit;
+
+	if (rte_table_action_profile_freeze(ap))
+		goto exit;
+
+	a = rte_table_action_create(ap, SOCKET_ID_ANY);
+
+exit:
+	rte_table_action_profile_free(ap);
+	return a;
+}
+
+static int
+ta_rule_init(struct rte_table_action *a, int nat, int ttl, int encap)
+{
+	struct rte_table_action_fwd_params fwd = {
+		.action = RTE_PIPELINE_ACTION_PORT,
+		.id = 0,
+	};
+	struct rte_table_action_mtr_params mtr;
+	struct rte_table_action_nat_params nat_params = {
+		.ipv4 = TA_NAT_IP,
+		.port = TA_NAT_PORT,
+	};
+	struct rte_table_action_ttl_params ttl_params = {
+		.decrement = 1,
+	};
+	struct rte_table_action_encap_params encap_params;
+	struct rte_table_action_stats_params stats = { 0, 0 };
+	struct rte_table_action_dscp_table dscp_table;
+	uint32_t i;
+
+	memset(rule_data, 0, sizeof(rule_data));
+
+	memset(&dscp_table, 0, sizeof(dscp_table));
+	for (i = 0; i < RTE_TABLE_ACTION_DSCP_TABLE_SIZE; i++)
+		dscp_table.entry[i].color = e_RTE_METER_GREEN;
+
+	if (rte_table_action_dscp_table_update(a, UINT64_MAX, &dscp_table))
+		return -1;
+
+	/* Large enough rate for all the packets to be green */
+	ta_mtr_params_set(&mtr, UINT32_MAX);
+
+	memset(&encap_params, 0, sizeof(encap_params));
+	encap_params.type = RTE_TABLE_ACTION_ENCAP_VLAN;
+	encap_params.vlan.vlan.vid = 100;
+	encap_params.vlan.vlan.pcp = 3;
+
+	if (rte_table_action_apply(a, rule_data, RTE_TABLE_ACTION_FWD, &fwd) ||
+		rte_table_action_apply(a, rule_data,
+			RTE_TABLE_ACTION_MTR, &mtr) ||
+		rte_table_action_apply(a, rule_data,
+			RTE_TABLE_ACTION_STATS, &stats))
+		return -1;
+
+	if (nat && rte_table_action_apply(a, rule_data,
+		RTE_TABLE_ACTION_NAT, &nat_params))
+		return -1;
+
+	if (ttl && rte_table_action_apply(a, rule_data,
+		RTE_TABLE_ACTION_TTL, &ttl_params))
+		return -1;
+
+	if (encap && rte_table_action_apply(a, rule_data,
+		RTE_TABLE_ACTION_ENCAP, &encap_params))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Pipeline for the table miss case: ring input port -> stub table (every
+ * lookup misses) -> ring output port set by the default entry.
+ */
+struct ta_pipeline {
+	struct rte_pipeline *p;
+	struct rte_ring *ring_in;
+	struct rte_ring *ring_out;
+};
+
+static void
+ta_pipeline_free(struct ta_pipeline *tp)
+{
+	struct rte_mbuf *m;
+
+	rte_pipeline_free(tp->p);
+
+	if (tp->ring_in)
+		while (rte_ring_sc_dequeue(tp->ring_in, (void **) &m) == 0)
+			rte_pktmbuf_free(m);
+	if (tp->ring_out)
+		while (rte_ring_sc_dequeue(tp->ring_out, (void **) &m) == 0)
+			rte_pktmbuf_free(m);
+
+	rte_ring_free(tp->ring_in);
+	rte_ring_free(tp->ring_out);
+	memset(tp, 0, sizeof(*tp));
+}
+
+static int
+ta_pipeline_create(struct ta_pipeline *tp, struct rte_table_action *a)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "table_action_miss",
+		.socket_id = 0,
+		.offset_port_id = 0,
+	};
+	struct rte_port_ring_reader_params port_in_ring_params;
+	struct rte_port_ring_writer_params port_out_ring_params;
+	struct rte_pipeline_port_in_params port_in_params = {
+		.ops = &rte_port_ring_reader_ops,
+		.arg_create = &port_in_ring_params,
+		.burst_size = TA_RING_BURST_SIZE,
+	};
+	struct rte_pipeline_port_out_params port_out_params = {
+		.ops = &rte_port_ring_writer_ops,
+		.arg_create = &port_out_ring_params,
+	};
+	struct rte_pipeline_table_params table_params;
+	struct rte_pipeline_table_entry default_entry = {
+		.action = RTE_PIPELINE_ACTION_PORT,
+	};
+	struct rte_pipeline_table_entry *default_entry_ptr;
+	uint32_t port_in_id, table_id;
+
+	memset(tp, 0, sizeof(*tp));
+
+	tp->ring_in = rte_ring_create("ta_ring_in", TA_RING_SIZE, 0,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	tp->ring_out = rte_ring_create("ta_ring_out", TA_RING_SIZE, 0,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if ((tp->ring_in == NULL) || (tp->ring_out == NULL))
+		goto error;
+
+	tp->p = rte_pipeline_create(&pipeline_params);
+	if (tp->p == NULL)
+		goto error;
+
+	memset(&port_in_ring_params, 0, sizeof(port_in_ring_params));
+	memset(&port_out_ring_params, 0, sizeof(port_out_ring_params));
+	port_in_ring_params.ring = tp->ring_in;
+	port_out_ring_params.ring = tp->ring_out;
+	port_out_ring_params.tx_burst_sz = TA_RING_BURST_SIZE;
+
+	memset(&table_params, 0, sizeof(table_params));
+	if (rte_table_action_table_params_get(a, &table_params))
+		goto error;
+	table_params.ops = &rte_table_stub_ops;
+	table_params.arg_create = NULL;
+
+	if (rte_pipeline_port_in_create(tp->p, &port_in_params, &port_in_id) ||
+		rte_pipeline_port_out_create(tp->p, &port_out_params,
+			&default_entry.port_id) ||
+		rte_pipeline_table_create(tp->p, &table_params, &table_id) ||
+		rte_pipeline_port_in_connect_to_table(tp->p, port_in_id,
+			table_id) ||
+		rte_pipeline_table_default_entry_add(tp->p, table_id,
+			&default_entry, &default_entry_ptr) ||
+		rte_pipeline_port_in_enable(tp->p, port_in_id) ||
+		rte_pipeline_check(tp->p))
+		goto error;
+
+	return 0;
+
+error:
+	ta_pipeline_free(tp);
+	return -1;
+}
+
+/* Forwarded packet: NAT + TTL + stats + VLAN encap */
+static int
+ta_fwd_pkt_check(struct rte_mbuf *m)
+{
+	struct ether_hdr *eth = rte_pktmbuf_mtod(m, struct ether_hdr *);
+	struct vlan_hdr *vlan = (struct vlan_hdr *) &eth[1];
+	struct ipv4_hdr *ip = (struct ipv4_hdr *) &vlan[1];
+	struct udp_hdr *udp = (struct udp_hdr *) &ip[1];
+	uint16_t ip_cksum, udp_cksum;
+
+	TEST_ASSERT_EQUAL(eth->ether_type, rte_cpu_to_be_16(ETHER_TYPE_VLAN),
+		"VLAN encap failed");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(vlan->vlan_tci), ((3 << 13) | 100),
+		"wrong VLAN TCI");
+	TEST_ASSERT_EQUAL(vlan->eth_proto, rte_cpu_to_be_16(ETHER_TYPE_IPv4),
+		"wrong inner ether type");
+	TEST_ASSERT_EQUAL(m->pkt_len, sizeof(*eth) + sizeof(*vlan) +
+		sizeof(*ip) + sizeof(*udp) + TA_PAYLOAD_LEN,
+		"wrong packet length %u", m->pkt_len);
+	TEST_ASSERT_EQUAL(ip->time_to_live, 63, "TTL not decremented");
+	TEST_ASSERT_EQUAL(ip->src_addr, rte_cpu_to_be_32(TA_NAT_IP),
+		"NAT address not translated");
+	TEST_ASSERT_EQUAL(udp->src_port, rte_cpu_to_be_16(TA_NAT_PORT),
+		"NAT port not translated");
+	ip_cksum = ip->hdr_checksum;
+	ip->hdr_checksum = 0;
+	TEST_ASSERT_EQUAL(rte_ipv4_cksum(ip), ip_cksum,
+		"wrong IP checksum after update");
+	udp_cksum = udp->dgram_cksum;
+	udp->dgram_cksum = 0;
+	TEST_ASSERT_EQUAL(rte_ipv4_udptcp_cksum(ip, udp), udp_cksum,
+		"wrong UDP checksum after update");
+	TEST_ASSERT_EQUAL(*RTE_MBUF_METADATA_UINT32_PTR(m,
+		TA_COLOR_OFFSET), e_RTE_METER_GREEN, "wrong packet color");
+
+	return 0;
+}
+
+/* Missed packet: forwarded by the default entry, left unchanged */
+static int
+ta_miss_pkt_check(struct rte_mbuf *m)
+{
+	struct ether_hdr *eth = rte_pktmbuf_mtod(m, struct ether_hdr *);
+	struct ipv4_hdr *ip = (struct ipv4_hdr *) &eth[1];
+	struct udp_hdr *udp = (struct udp_hdr *) &ip[1];
+	uint16_t ip_cksum;
+
+	TEST_ASSERT_EQUAL(eth->ether_type, rte_cpu_to_be_16(ETHER_TYPE_IPv4),
+		"missed packet encapsulated");
+	TEST_ASSERT_EQUAL(m->pkt_len, sizeof(*eth) + sizeof(*ip) +
+		sizeof(*udp) + TA_PAYLOAD_LEN,
+		"wrong packet length %u", m->pkt_len);
+	TEST_ASSERT_EQUAL(ip->time_to_live, 64, "missed packet TTL changed");
+	TEST_ASSERT_EQUAL(ip->src_addr, rte_cpu_to_be_32(TA_SRC_IP),
+		"missed packet address translated");
+	TEST_ASSERT_EQUAL(udp->src_port, rte_cpu_to_be_16(TA_SRC_PORT),
+		"missed packet port translated");
+	ip_cksum = ip->hdr_checksum;
+	ip->hdr_checksum = 0;
+	TEST_ASSERT_EQUAL(rte_ipv4_cksum(ip), ip_cksum,
+		"wrong IP checksum of missed packet");
+
+	return 0;
+}
+
+static int
+ta_functional_run(struct ta_pipeline *tp, struct rte_table_action *a,
+	struct rte_mbuf **m)
+{
+	struct rte_pipeline_table_params params;
+	struct rte_pipeline_table_entry *entry =
+		(struct rte_pipeline_table_entry *) rule_data;
+	struct rte_pipeline_table_entry *entries[1] = { entry };
+	struct rte_table_action_stats_counters stats;
+	struct rte_table_action_mtr_counters mtr_stats;
+	struct rte_table_action_ttl_counters ttl_stats;
+	int status;
+
+	memset(&params, 0, sizeof(params));
+	status = rte_table_action_table_params_get(a, &params);
+	TEST_ASSERT_SUCCESS(status, "table params get failed");
+	TEST_ASSERT_NOT_NULL(params.f_action_hit, "no action handler");
+	TEST_ASSERT_NULL(params.f_action_miss, "lookup miss action handler");
+	TEST_ASSERT(params.action_data_size + sizeof(*entry) <=
+		sizeof(rule_data), "action data too big (%u bytes)",
+		params.action_data_size);
+
+	TEST_ASSERT_SUCCESS(ta_rule_init(a, 1, 1, 1), "rule init failed");
+	TEST_ASSERT_EQUAL(entry->action, RTE_PIPELINE_ACTION_PORT,
+		"fwd action not applied");
+
+	/* Table hit */
+	m[0] = ta_pkt_build(64);
+	TEST_ASSERT_NOT_NULL(m[0], "packet build failed");
+	params.f_action_hit(tp->p, m, 1LLU, entries, params.arg_ah);
+	TEST_ASSERT_SUCCESS(ta_fwd_pkt_check(m[0]), "wrong forwarded packet");
+	rte_pktmbuf_free(m[0]);
+	m[0] = NULL;
+
+	/* Table hit, dropped packet: TTL expires */
+	m[0] = ta_pkt_build(1);
+	TEST_ASSERT_NOT_NULL(m[0], "packet build failed");
+	params.f_action_hit(tp->p, m, 1LLU, entries, params.arg_ah);
+	rte_pktmbuf_free(m[0]);
+	m[0] = NULL;
+
+	/* Table miss: the packet goes through the pipeline unchanged */
+	m[0] = ta_pkt_build(64);
+	TEST_ASSERT_NOT_NULL(m[0], "packet build failed");
+	TEST_ASSERT_SUCCESS(rte_ring_sp_enqueue(tp->ring_in, m[0]),
+		"packet enqueue failed");
+	m[0] = NULL;
+	rte_pipeline_run(tp->p);
+	rte_pipeline_flush(tp->p);
+	TEST_ASSERT_SUCCESS(rte_ring_sc_dequeue(tp->ring_out, (void **) m),
+		"missed packet not forwarded");
+	TEST_ASSERT_SUCCESS(ta_miss_pkt_check(m[0]), "wrong missed packet");
+	rte_pktmbuf_free(m[0]);
+	m[0] = NULL;
+
+	/* Only the table hits are counted by the rule */
+	TEST_ASSERT_SUCCESS(rte_table_action_stats_read(a, rule_data,
+		&stats, 1), "stats read failed");
+	TEST_ASSERT_EQUAL(stats.n_packets, 2, "wrong packet count");
+	TEST_ASSERT_EQUAL(stats.n_bytes, 2 * (sizeof(struct ipv4_hdr) +
+		sizeof(struct udp_hdr) + TA_PAYLOAD_LEN), "wrong byte count");
+
+	TEST_ASSERT_SUCCESS(rte_table_action_ttl_read(a, rule_data,
+		&ttl_stats, 1), "TTL read failed");
+	TEST_ASSERT_EQUAL(ttl_stats.n_packets, 1, "wrong TTL drop count");
+
+	TEST_ASSERT_SUCCESS(rte_table_action_meter_read(a, rule_data, 1,
+		&mtr_stats, 1), "meter read failed");
+	TEST_ASSERT_EQUAL(mtr_stats.stats[0].n_packets[e_RTE_METER_GREEN], 2,
+		"wrong green packet count");
+
+	TEST_ASSERT_SUCCESS(rte_table_action_stats_read(a, rule_data,
+		&stats, 0), "stats read failed");
+	TEST_ASSERT_EQUAL(stats.n_packets, 0, "stats not cleared");
+
+	return 0;
+}
+
+static int
+test_table_action_functional(void)
+{
+	struct ta_pipeline tp;
+	struct rte_table_action *a;
+	struct rte_mbuf *m[1] = { NULL };
+	int status;
+
+	a = ta_create(1, 1, 1);
+	TEST_ASSERT_NOT_NULL(a, "table action create failed");
+
+	if (ta_pipeline_create(&tp, a)) {
+		rte_table_action_free(a);
+		TEST_ASSERT(0, "pipeline create failed");
+	}
+
+	status = ta_functional_run(&tp, a, m);
+
+	rte_pktmbuf_free(m[0]);
+	ta_pipeline_free(&tp);
+	rte_table_action_free(a);
+
+	return status;
+}
+
+/*
+ * Hand-coded meter + policer + stats action handler, as implemented by the
+ * flow actions pipeline of the ip_pipeline application, used as baseline.
+ */
+struct ta_legacy_entry {
+	struct rte_pipeline_table_entry head;
+	struct rte_meter_trtcm meter;
+	enum rte_meter_color policer[e_RTE_METER_COLORS];
+	uint64_t n_pkts[e_RTE_METER_COLORS];
+	uint64_t n_bytes;
+};
+
+static int
+ta_legacy_ah(struct rte_pipeline *p __rte_unused,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	void *arg __rte_unused)
+{
+	uint64_t time = rte_rdtsc();
+
+	for ( ; pkts_mask; ) {
+		uint32_t pos = __builtin_ctzll(pkts_mask);
+		struct rte_mbuf *pkt = pkts[pos];
+		struct ta_legacy_entry *e =
+			(struct ta_legacy_entry *) entries[pos];
+		struct ipv4_hdr *ip = (struct ipv4_hdr *)
+			RTE_MBUF_METADATA_UINT32_PTR(pkt, TA_IP_OFFSET);
+		uint32_t *pkt_color =
+			RTE_MBUF_METADATA_UINT32_PTR(pkt, TA_COLOR_OFFSET);
+		uint32_t total_length = rte_bswap16(ip->total_length);
+		enum rte_meter_color color;
+
+		color = rte_meter_trtcm_color_aware_check(&e->meter,
+			time, total_length, e_RTE_METER_GREEN);
+		color = e->policer[color];
+		e->n_pkts[color]++;
+		e->n_bytes += total_length;
+		*pkt_color = color;
+
+		pkts_mask &= ~(1LLU << pos);
+	}
+
+	return 0;
+}
+
+static int
+test_table_action_perf(struct rte_pipeline *p)
+{
+	struct rte_pipeline_table_params params;
+	struct rte_pipeline_table_entry *entries[TA_BURST_SIZE];
+	struct rte_mbuf *pkts[TA_BURST_SIZE] = {NULL};
+	struct ta_legacy_entry legacy;
+	struct rte_meter_trtcm_params meter = {
+		.cir = UINT32_MAX,
+		.pir = UINT32_MAX,
+		.cbs = UINT32_MAX,
+		.pbs = UINT32_MAX,
+	};
+	struct rte_table_action *a;
+	uint64_t start, lib_cycles, legacy_cycles;
+	uint32_t i;
+	int status = -1;
+
+	a = ta_create(0, 0, 0);
+	TEST_ASSERT_NOT_NULL(a, "table action create failed");
+	if (rte_table_action_table_params_get(a, &params) ||
+		ta_rule_init(a, 0, 0, 0))
+		goto exit;
+
+	memset(&legacy, 0, sizeof(legacy));
+	rte_meter_trtcm_config(&legacy.meter, &meter);
+	for (i = 0; i < e_RTE_METER_COLORS; i++)
+		legacy.policer[i] = (enum rte_meter_color) i;
+
+	for (i = 0; i < TA_BURST_SIZE; i++) {
+		pkts[i] = ta_pkt_build(64);
+		if (pkts[i] == NULL)
+			goto exit;
+	}
+
+	for (i = 0; i < TA_BURST_SIZE; i++)
+		entries[i] = (struct rte_pipeline_table_entry *) rule_data;
+	start = rte_rdtsc();
+	for (i = 0; i < TA_PERF_ITERATIONS; i++)
+		params.f_action_hit(p, pkts, UINT64_MAX, entries,
+			params.arg_ah);
+	lib_cycles = rte_rdtsc() - start;
+
+	for (i = 0; i < TA_BURST_SIZE; i++)
+		entries[i] = &legacy.head;
+	start = rte_rdtsc();
+	for (i = 0; i < TA_PERF_ITERATIONS; i++)
+		ta_legacy_ah(p, pkts, UINT64_MAX, entries, NULL);
+	legacy_cycles = rte_rdtsc() - start;
+
+	printf("Meter + stats, burst of %u packets:\n", TA_BURST_SIZE);
+	printf("  table action library: %.2f cycles/pkt\n",
+		(double) lib_cycles / (TA_PERF_ITERATIONS * TA_BURST_SIZE));
+	printf("  hand-coded handler:   %.2f cycles/pkt\n",
+		(double) legacy_cycles /
+		(TA_PERF_ITERATIONS * TA_BURST_SIZE));
+
+	status = 0;
+
+exit:
+	for (i = 0; i < TA_BURST_SIZE; i++)
+		rte_pktmbuf_free(pkts[i]);
+	rte_table_action_free(a);
+	return status;
+}
+
+static int
+test_table_action(void)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "table_action_test",
+		.socket_id = 0,
+		.offset_port_id = 0,
+	};
+	struct rte_pipeline *p;
+	int status;
+
+	ta_pool = rte_mempool_lookup("table_action_pool");
+	if (ta_pool == NULL)
+		ta_pool = rte_pktmbuf_pool_create("table_action_pool",
+			TA_POOL_SIZE, 32, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			SOCKET_ID_ANY);
+	TEST_ASSERT_NOT_NULL(ta_pool, "mbuf pool create failed");
+
+	status = test_table_action_functional();
+	if (status != 0)
+		return status;
+
+	p = rte_pipeline_create(&pipeline_params);
+	TEST_ASSERT_NOT_NULL(p, "pipeline create failed");
+
+	status = test_table_action_perf(p);
+
+	rte_pipeline_free(p);
+
+	return status;
+}
+
+REGISTER_TEST_COMMAND(table_action_autotest, test_table_action);
@@ -31,6 +31,8 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <rte_cycles.h>
+
 #include "test_table_ports.h"
 #include "test_table.h"
 
@@ -111,8 +113,11 @@ test_port_ring_writer(void)
 {
 	int status, i;
 	struct rte_port_ring_writer_params port_ring_writer_params;
+	struct rte_port_out_latency latency;
 	void *port;
 
+	memset(&port_ring_writer_params, 0, sizeof(port_ring_writer_params));
+
 	/* Invalid params */
 	port = rte_port_ring_writer_ops.f_create(NULL, 0);
 	if (port != NULL)
@@ -216,5 +221,62 @@ test_port_ring_writer(void)
 	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
 		rte_pktmbuf_free(res_mbuf[i]);
 
+	rte_port_ring_writer_ops.f_free(port);
+
+	/* -- Flush deadline and latency histogram -- */
+	memset(&latency, 0, sizeof(latency));
+	port_ring_writer_params.ring = RING_TX;
+	port_ring_writer_params.tx_burst_sz = RTE_PORT_IN_BURST_SIZE_MAX / 2;
+	port_ring_writer_params.tx_flush_cycles = rte_get_tsc_hz() / 1000;
+	port_ring_writer_params.latency = &latency;
+	port = rte_port_ring_writer_ops.f_create(&port_ring_writer_params, 0);
+	if (port == NULL)
+		return -10;
+
+	/* Packet buffered until the deadline expires */
+	mbuf[0] = rte_pktmbuf_alloc(pool);
+	rte_port_ring_writer_ops.f_tx(port, mbuf[0]);
+	if (rte_ring_count(RING_TX) != 0)
+		return -11;
+
+	rte_delay_ms(2);
+	mbuf[1] = rte_pktmbuf_alloc(pool);
+	rte_port_ring_writer_ops.f_tx_bulk(port, &mbuf[0], 2);
+	received_pkts = rte_ring_sc_dequeue_burst(RING_TX, (void **)res_mbuf,
+		RTE_PORT_IN_BURST_SIZE_MAX, NULL);
+	if (received_pkts != 2)
+		return -12;
+
+	for (i = 0; i < received_pkts; i++)
+		rte_pktmbuf_free(res_mbuf[i]);
+
+	for (i = 0, expected_pkts = 0; i < RTE_PORT_OUT_LATENCY_HIST_SIZE; i++)
+		expected_pkts += latency.n_pkts[i];
+	if ((expected_pkts != 2) ||
+		(latency.max < port_ring_writer_params.tx_flush_cycles))
+		return -13;
+
+	/* Contiguous burst not starting at packet 0 is sent unbuffered */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		mbuf[i] = rte_pktmbuf_alloc(pool);
+	rte_port_ring_writer_ops.f_tx_bulk(port, mbuf,
+		RTE_LEN2MASK(RTE_PORT_IN_BURST_SIZE_MAX, uint64_t) &
+		~RTE_LEN2MASK(RTE_PORT_IN_BURST_SIZE_MAX / 2, uint64_t));
+
+	expected_pkts = RTE_PORT_IN_BURST_SIZE_MAX / 2;
+	received_pkts = rte_ring_sc_dequeue_burst(RING_TX, (void **)res_mbuf,
+		RTE_PORT_IN_BURST_SIZE_MAX, NULL);
+	if ((received_pkts != expected_pkts) ||
+		(res_mbuf[0] != mbuf[RTE_PORT_IN_BURST_SIZE_MAX / 2]) ||
+		(latency.n_pkts[0] < (uint64_t) expected_pkts))
+		return -14;
+
+	for (i = 0; i < received_pkts; i++)
+		rte_pktmbuf_free(res_mbuf[i]);
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX / 2; i++)
+		rte_pktmbuf_free(mbuf[i]);
+
+	rte_port_ring_writer_ops.f_free(port);
+
 	return 0;
 }
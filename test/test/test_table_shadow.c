@@ -0,0 +1,731 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_ring.h>
+#include <rte_hash_crc.h>
+#include <rte_mbuf.h>
+#include <rte_port_ring.h>
+#include <rte_table_hash.h>
+#include <rte_table_acl.h>
+#include <rte_ip.h>
+#include <rte_pipeline.h>
+
+#include "test.h"
+
+#define TS_POOL_SIZE             1024
+#define TS_N_PKTS                256
+#define TS_RING_SIZE             512
+#define TS_BURST_SIZE            32
+#define TS_KEY_OFFSET            (sizeof(struct rte_mbuf))
+
+#define TS_N_ENTRIES_SMALL       1024
+#define TS_N_ENTRIES_RELOAD      (1 << 20)
+#define TS_BULK_SIZE             64
+
+/*
+ * Pipeline under test: ring input port -> 8-byte key hash table (or ACL
+ * table) -> ring output port. Table hit sends the packet to the output port,
+ * table miss drops it.
+ */
+union ts_table_params {
+	struct rte_table_hash_key8_ext_params hash;
+	struct rte_table_acl_params acl;
+};
+
+struct ts_pipeline {
+	struct rte_pipeline *p;
+	struct rte_ring *ring_in;
+	struct rte_ring *ring_out;
+	/* Create parameters of the table and of its shadow copy */
+	union ts_table_params table_params;
+	union ts_table_params table_params_shadow;
+	uint32_t table_id;
+	uint32_t port_out_id;
+};
+
+/* Data path latency statistics */
+struct ts_run_stats {
+	uint64_t n_runs;
+	uint64_t n_pkts;
+	uint64_t cycles_total;
+	uint64_t cycles_max;
+};
+
+static struct rte_mempool *ts_pool;
+
+static uint64_t
+ts_hash(void *key, __rte_unused uint32_t key_size, uint64_t seed)
+{
+	return rte_hash_crc_8byte(*((uint64_t *) key), (uint32_t) seed);
+}
+
+static void
+ts_pipeline_free(struct ts_pipeline *tp)
+{
+	struct rte_mbuf *m;
+
+	rte_pipeline_free(tp->p);
+
+	if (tp->ring_in)
+		while (rte_ring_sc_dequeue(tp->ring_in, (void **) &m) == 0)
+			rte_pktmbuf_free(m);
+	if (tp->ring_out)
+		while (rte_ring_sc_dequeue(tp->ring_out, (void **) &m) == 0)
+			rte_pktmbuf_free(m);
+
+	rte_ring_free(tp->ring_in);
+	rte_ring_free(tp->ring_out);
+	memset(tp, 0, sizeof(*tp));
+}
+
+static int
+ts_pipeline_create_table(struct ts_pipeline *tp, struct rte_table_ops *ops,
+	const union ts_table_params *params,
+	const union ts_table_params *params_shadow)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "table_shadow",
+		.socket_id = 0,
+	};
+	struct rte_port_ring_reader_params port_in_ring_params;
+	struct rte_port_ring_writer_params port_out_ring_params;
+	struct rte_pipeline_port_in_params port_in_params = {
+		.ops = &rte_port_ring_reader_ops,
+		.arg_create = &port_in_ring_params,
+		.burst_size = TS_BURST_SIZE,
+	};
+	struct rte_pipeline_port_out_params port_out_params = {
+		.ops = &rte_port_ring_writer_ops,
+		.arg_create = &port_out_ring_params,
+	};
+	struct rte_pipeline_table_params table_params = {
+		.ops = ops,
+		.arg_create = &tp->table_params,
+	};
+	struct rte_pipeline_table_entry default_entry = {
+		.action = RTE_PIPELINE_ACTION_DROP,
+	};
+	struct rte_pipeline_table_entry *default_entry_ptr;
+	uint32_t port_in_id;
+
+	memset(tp, 0, sizeof(*tp));
+	tp->table_params = *params;
+	tp->table_params_shadow = *params_shadow;
+
+	tp->ring_in = rte_ring_create("ts_ring_in", TS_RING_SIZE, 0,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	tp->ring_out = rte_ring_create("ts_ring_out", TS_RING_SIZE, 0,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if ((tp->ring_in == NULL) || (tp->ring_out == NULL))
+		goto error;
+
+	tp->p = rte_pipeline_create(&pipeline_params);
+	if (tp->p == NULL)
+		goto error;
+
+	memset(&port_in_ring_params, 0, sizeof(port_in_ring_params));
+	memset(&port_out_ring_params, 0, sizeof(port_out_ring_params));
+	port_in_ring_params.ring = tp->ring_in;
+	port_out_ring_params.ring = tp->ring_out;
+	port_out_ring_params.tx_burst_sz = TS_BURST_SIZE;
+
+	if (rte_pipeline_port_in_create(tp->p, &port_in_params, &port_in_id) ||
+		rte_pipeline_port_out_create(tp->p, &port_out_params,
+			&tp->port_out_id) ||
+		rte_pipeline_table_create(tp->p, &table_params,
+			&tp->table_id) ||
+		rte_pipeline_port_in_connect_to_table(tp->p, port_in_id,
+			tp->table_id) ||
+		rte_pipeline_table_default_entry_add(tp->p, tp->table_id,
+			&default_entry, &default_entry_ptr) ||
+		rte_pipeline_port_in_enable(tp->p, port_in_id) ||
+		rte_pipeline_check(tp->p))
+		goto error;
+
+	return 0;
+
+error:
+	ts_pipeline_free(tp);
+	return -1;
+}
+
+static int
+ts_pipeline_create(struct ts_pipeline *tp, uint32_t n_entries)
+{
+	union ts_table_params params;
+
+	/* Keep the load factor of the 4-key buckets at 50% */
+	memset(&params, 0, sizeof(params));
+	params.hash.n_entries = 2 * n_entries;
+	params.hash.n_entries_ext = n_entries / 4;
+	params.hash.f_hash = ts_hash;
+	params.hash.seed = 0;
+	params.hash.key_offset = TS_KEY_OFFSET;
+	params.hash.key_mask = NULL;
+
+	return ts_pipeline_create_table(tp, &rte_table_hash_key8_ext_dosig_ops,
+		&params, &params);
+}
+
+static int
+ts_pkts_send(struct ts_pipeline *tp, const uint64_t *keys, uint32_t n_keys)
+{
+	uint32_t i;
+
+	for (i = 0; i < n_keys; i++) {
+		struct rte_mbuf *m = rte_pktmbuf_alloc(ts_pool);
+
+		if (m == NULL)
+			return -1;
+
+		*RTE_MBUF_METADATA_UINT64_PTR(m, TS_KEY_OFFSET) = keys[i];
+		if (rte_ring_sp_enqueue(tp->ring_in, m) != 0) {
+			rte_pktmbuf_free(m);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* Run the pipeline and return the keys of the packets sent out */
+static uint32_t
+ts_pkts_recv(struct ts_pipeline *tp, uint64_t *keys, uint32_t n_keys_max)
+{
+	struct rte_mbuf *m;
+	uint32_t n = 0;
+
+	rte_pipeline_run(tp->p);
+	rte_pipeline_flush(tp->p);
+
+	while (rte_ring_sc_dequeue(tp->ring_out, (void **) &m) == 0) {
+		if (n < n_keys_max)
+			keys[n] = *RTE_MBUF_METADATA_UINT64_PTR(m,
+				TS_KEY_OFFSET);
+		n++;
+		rte_pktmbuf_free(m);
+	}
+
+	return n;
+}
+
+static int
+test_table_shadow_functional(void)
+{
+	struct ts_pipeline tp;
+	struct rte_pipeline_table_entry entry_fwd, entry_drop;
+	struct rte_pipeline_table_entry *entries[2], *entries_ptr[2];
+	uint64_t key_vals[2] = {1, 2}, out[4];
+	void *keys[2] = {&key_vals[0], &key_vals[1]};
+	int key_found[2];
+	int status;
+
+	TEST_ASSERT_SUCCESS(ts_pipeline_create(&tp, TS_N_ENTRIES_SMALL),
+		"Pipeline creation failed");
+
+	memset(&entry_fwd, 0, sizeof(entry_fwd));
+	entry_fwd.action = RTE_PIPELINE_ACTION_PORT;
+	entry_fwd.port_id = tp.port_out_id;
+	memset(&entry_drop, 0, sizeof(entry_drop));
+	entry_drop.action = RTE_PIPELINE_ACTION_DROP;
+
+	/* Shadow operations are rejected until the shadow copy exists */
+	entries[0] = &entry_fwd;
+	status = rte_pipeline_table_shadow_entry_add_bulk(tp.p, tp.table_id,
+		&keys[1], entries, 1, key_found, entries_ptr);
+	TEST_ASSERT(status == -EINVAL, "Shadow add without shadow copy");
+
+	/* Active copy: key 1 forwarded. The hash table has no bulk add, so
+	 * this also covers the single entry add fallback.
+	 */
+	status = rte_pipeline_table_entry_add_bulk(tp.p, tp.table_id,
+		&keys[0], entries, 1, key_found, entries_ptr);
+	TEST_ASSERT_SUCCESS(status, "Bulk add to active table failed");
+
+	/* Shadow copy: key 2 forwarded, key 1 dropped */
+	TEST_ASSERT(rte_pipeline_table_shadow_create(tp.p, tp.table_id,
+		&tp.table_params) == -EINVAL,
+		"Shadow created with the active copy parameters");
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_create(tp.p,
+		tp.table_id, &tp.table_params_shadow), "Shadow create failed");
+	TEST_ASSERT(rte_pipeline_table_shadow_create(tp.p, tp.table_id,
+		&tp.table_params_shadow) == -EEXIST, "Shadow created twice");
+
+	entries[0] = &entry_drop;
+	entries[1] = &entry_fwd;
+	status = rte_pipeline_table_shadow_entry_add_bulk(tp.p, tp.table_id,
+		keys, entries, 2, key_found, entries_ptr);
+	TEST_ASSERT_SUCCESS(status, "Bulk add to shadow table failed");
+	TEST_ASSERT(!key_found[0] && !key_found[1],
+		"Keys found in empty shadow table");
+
+	/* The data path still uses the active copy */
+	TEST_ASSERT_SUCCESS(ts_pkts_send(&tp, key_vals, 2), "Send failed");
+	TEST_ASSERT(ts_pkts_recv(&tp, out, RTE_DIM(out)) == 1 && out[0] == 1,
+		"Wrong output before swap");
+
+	/* Swap request, completed by the next pipeline run */
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_swap(tp.p, tp.table_id),
+		"Swap request failed");
+	TEST_ASSERT(rte_pipeline_table_shadow_swap_pending(tp.p,
+		tp.table_id) == 1, "Swap not pending");
+	TEST_ASSERT(rte_pipeline_table_shadow_swap(tp.p, tp.table_id) ==
+		-EBUSY, "Second swap request accepted");
+	status = rte_pipeline_table_shadow_entry_delete_bulk(tp.p,
+		tp.table_id, keys, 2, key_found, NULL);
+	TEST_ASSERT(status == -EBUSY, "Shadow update during pending swap");
+	TEST_ASSERT(rte_pipeline_table_shadow_reset(tp.p, tp.table_id) ==
+		-EBUSY, "Shadow reset during pending swap");
+
+	TEST_ASSERT_SUCCESS(ts_pkts_send(&tp, key_vals, 2), "Send failed");
+	TEST_ASSERT(ts_pkts_recv(&tp, out, RTE_DIM(out)) == 1 && out[0] == 2,
+		"Wrong output after swap");
+	TEST_ASSERT(rte_pipeline_table_shadow_swap_pending(tp.p,
+		tp.table_id) == 0, "Swap still pending");
+
+	/* The previous active copy is now the shadow copy */
+	status = rte_pipeline_table_shadow_entry_delete_bulk(tp.p,
+		tp.table_id, keys, 2, key_found, NULL);
+	TEST_ASSERT_SUCCESS(status, "Shadow delete failed");
+	TEST_ASSERT(key_found[0] && !key_found[1], "Wrong shadow contents");
+
+	/* Swap back to the (now empty) previous copy: everything dropped */
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_reset(tp.p,
+		tp.table_id), "Shadow reset failed");
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_swap(tp.p, tp.table_id),
+		"Swap request failed");
+	TEST_ASSERT_SUCCESS(ts_pkts_send(&tp, key_vals, 2), "Send failed");
+	TEST_ASSERT(ts_pkts_recv(&tp, out, RTE_DIM(out)) == 0,
+		"Wrong output after reset and swap");
+
+	ts_pipeline_free(&tp);
+	return 0;
+}
+
+/*
+ * Named table: the shadow copy of an ACL table needs its own name, which
+ * stays with that copy across swaps. The ACL rules match the IP protocol
+ * and the destination IP address at the start of the packet data.
+ */
+#define TS_ACL_PROTO             IPPROTO_UDP
+
+struct ts_acl_key {
+	uint8_t proto;
+	uint8_t pad[3];
+	uint32_t ip_dst;
+};
+
+enum {
+	TS_ACL_FIELD_PROTO,
+	TS_ACL_FIELD_IP_DST,
+	TS_ACL_N_FIELDS
+};
+
+static const struct rte_acl_field_def ts_acl_fields[TS_ACL_N_FIELDS] = {
+	{
+		.type = RTE_ACL_FIELD_TYPE_BITMASK,
+		.size = sizeof(uint8_t),
+		.field_index = TS_ACL_FIELD_PROTO,
+		.input_index = TS_ACL_FIELD_PROTO,
+		.offset = offsetof(struct ts_acl_key, proto),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = TS_ACL_FIELD_IP_DST,
+		.input_index = TS_ACL_FIELD_IP_DST,
+		.offset = offsetof(struct ts_acl_key, ip_dst),
+	},
+};
+
+static int
+ts_acl_pkt_send(struct ts_pipeline *tp, uint32_t ip)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(ts_pool);
+	struct ts_acl_key *key;
+
+	if (m == NULL)
+		return -1;
+
+	key = (struct ts_acl_key *) rte_pktmbuf_append(m, sizeof(*key));
+	if (key == NULL) {
+		rte_pktmbuf_free(m);
+		return -1;
+	}
+	memset(key, 0, sizeof(*key));
+	key->proto = TS_ACL_PROTO;
+	key->ip_dst = rte_cpu_to_be_32(ip);
+
+	if (rte_ring_sp_enqueue(tp->ring_in, m) != 0) {
+		rte_pktmbuf_free(m);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Add a rule for the /8 network of *ip* to the shadow copy */
+static int
+ts_acl_rule_add(struct ts_pipeline *tp, uint32_t ip,
+	struct rte_pipeline_table_entry *entry)
+{
+	struct rte_table_acl_rule_add_params rule;
+	void *keys[1] = {&rule};
+	struct rte_pipeline_table_entry *entries[1] = {entry};
+	/* The ACL table bulk add rejects NULL entry pointers */
+	struct rte_pipeline_table_entry *entries_ptr[1] = {entry};
+	int key_found[1];
+
+	memset(&rule, 0, sizeof(rule));
+	rule.priority = 0;
+	rule.field_value[TS_ACL_FIELD_PROTO].value.u8 = TS_ACL_PROTO;
+	rule.field_value[TS_ACL_FIELD_PROTO].mask_range.u8 = 0xff;
+	rule.field_value[TS_ACL_FIELD_IP_DST].value.u32 = ip;
+	rule.field_value[TS_ACL_FIELD_IP_DST].mask_range.u32 = 8;
+
+	return rte_pipeline_table_shadow_entry_add_bulk(tp->p, tp->table_id,
+		keys, entries, 1, key_found, entries_ptr);
+}
+
+static int
+ts_acl_run(struct ts_pipeline *tp)
+{
+	struct rte_pipeline_table_entry entry_fwd;
+
+	memset(&entry_fwd, 0, sizeof(entry_fwd));
+	entry_fwd.action = RTE_PIPELINE_ACTION_PORT;
+	entry_fwd.port_id = tp->port_out_id;
+
+	/* Same name as the active copy */
+	TEST_ASSERT(rte_pipeline_table_shadow_create(tp->p, tp->table_id,
+		&tp->table_params) == -EINVAL,
+		"Shadow created with the active copy parameters");
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_create(tp->p,
+		tp->table_id, &tp->table_params_shadow),
+		"Shadow create failed");
+
+	/* Shadow copy: 10.0.0.0/8 forwarded */
+	TEST_ASSERT_SUCCESS(ts_acl_rule_add(tp, IPv4(10, 0, 0, 0),
+		&entry_fwd), "Shadow rule add failed");
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_swap(tp->p,
+		tp->table_id), "Swap request failed");
+	TEST_ASSERT_SUCCESS(ts_acl_pkt_send(tp, IPv4(10, 1, 1, 1)),
+		"Send failed");
+	TEST_ASSERT(ts_pkts_recv(tp, NULL, 0) == 1,
+		"Rule not used after swap");
+
+	/* The previously active copy is recreated with its own name */
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_reset(tp->p,
+		tp->table_id), "Shadow reset after swap failed");
+	TEST_ASSERT_SUCCESS(ts_acl_rule_add(tp, IPv4(11, 0, 0, 0),
+		&entry_fwd), "Shadow rule add failed");
+
+	/* The shadow copy updates do not reach the active copy */
+	TEST_ASSERT_SUCCESS(ts_acl_pkt_send(tp, IPv4(11, 1, 1, 1)),
+		"Send failed");
+	TEST_ASSERT(ts_pkts_recv(tp, NULL, 0) == 0,
+		"Shadow rule used before swap");
+	TEST_ASSERT_SUCCESS(ts_acl_pkt_send(tp, IPv4(10, 1, 1, 1)),
+		"Send failed");
+	TEST_ASSERT(ts_pkts_recv(tp, NULL, 0) == 1,
+		"Active rule lost by shadow update");
+
+	TEST_ASSERT_SUCCESS(rte_pipeline_table_shadow_swap(tp->p,
+		tp->table_id), "Swap request failed");
+	TEST_ASSERT_SUCCESS(ts_acl_pkt_send(tp, IPv4(10, 1, 1, 1)),
+		"Send failed");
+	TEST_ASSERT(ts_pkts_recv(tp, NULL, 0) == 0,
+		"Old rule used after swap");
+	TEST_ASSERT_SUCCESS(ts_acl_pkt_send(tp, IPv4(11, 1, 1, 1)),
+		"Send failed");
+	TEST_ASSERT(ts_pkts_recv(tp, NULL, 0) == 1,
+		"New rule not used after swap");
+
+	return 0;
+}
+
+static int
+test_table_shadow_acl(void)
+{
+	union ts_table_params params, params_shadow;
+	struct ts_pipeline tp;
+	int status;
+
+	memset(&params, 0, sizeof(params));
+	params.acl.name = "ts_acl";
+	params.acl.n_rules = 16;
+	params.acl.n_rule_fields = RTE_DIM(ts_acl_fields);
+	memcpy(params.acl.field_format, ts_acl_fields,
+		sizeof(ts_acl_fields));
+	params_shadow = params;
+	params_shadow.acl.name = "ts_acl_shadow";
+
+	TEST_ASSERT_SUCCESS(ts_pipeline_create_table(&tp, &rte_table_acl_ops,
+		&params, &params_shadow), "Pipeline creation failed");
+
+	status = ts_acl_run(&tp);
+
+	ts_pipeline_free(&tp);
+	return status;
+}
+
+/*
+ * Table reload benchmark
+ *
+ * The data path keeps looping TS_N_PKTS packets through the pipeline (hitting
+ * keys spread over the whole table) while the control path reloads all the
+ * TS_N_ENTRIES_RELOAD table entries, either in place through the regular bulk
+ * add or into the shadow copy followed by a swap. When a second lcore is
+ * available the data path runs there, otherwise the control path runs one
+ * pipeline iteration after each bulk of updates.
+ */
+struct ts_dp {
+	struct ts_pipeline *tp;
+	struct ts_run_stats stats;
+	volatile int stop;
+};
+
+static inline void
+ts_dp_iteration(struct ts_dp *dp)
+{
+	struct ts_pipeline *tp = dp->tp;
+	struct rte_mbuf *pkts[TS_BURST_SIZE];
+	uint64_t t0, t1;
+	uint32_t n;
+
+	t0 = rte_rdtsc();
+	rte_pipeline_run(tp->p);
+	rte_pipeline_flush(tp->p);
+	t1 = rte_rdtsc();
+
+	dp->stats.n_runs++;
+	dp->stats.cycles_total += t1 - t0;
+	if (t1 - t0 > dp->stats.cycles_max)
+		dp->stats.cycles_max = t1 - t0;
+
+	/* Loop the packets back to the input port */
+	n = rte_ring_sc_dequeue_burst(tp->ring_out, (void **) pkts,
+		TS_BURST_SIZE, NULL);
+	dp->stats.n_pkts += n;
+	rte_ring_sp_enqueue_burst(tp->ring_in, (void **) pkts, n, NULL);
+}
+
+static int
+ts_dp_main(void *arg)
+{
+	struct ts_dp *dp = arg;
+
+	while (dp->stop == 0)
+		ts_dp_iteration(dp);
+
+	return 0;
+}
+
+static int
+ts_reload(struct ts_pipeline *tp, struct ts_dp *dp, int shadow, int worker,
+	uint64_t *cycles_update, uint64_t *cycles_swap)
+{
+	struct rte_pipeline_table_entry entry, *entries[TS_BULK_SIZE];
+	struct rte_pipeline_table_entry *entries_ptr[TS_BULK_SIZE];
+	uint64_t key_vals[TS_BULK_SIZE];
+	void *keys[TS_BULK_SIZE];
+	int key_found[TS_BULK_SIZE];
+	uint64_t t0, t1;
+	uint32_t i, j;
+	int status;
+
+	memset(&entry, 0, sizeof(entry));
+	entry.action = RTE_PIPELINE_ACTION_PORT;
+	entry.port_id = tp->port_out_id;
+	for (j = 0; j < TS_BULK_SIZE; j++) {
+		entries[j] = &entry;
+		keys[j] = &key_vals[j];
+	}
+
+	if (shadow) {
+		status = rte_pipeline_table_shadow_reset(tp->p, tp->table_id);
+		if (status)
+			return status;
+	}
+
+	t0 = rte_rdtsc();
+	for (i = 0; i < TS_N_ENTRIES_RELOAD; i += TS_BULK_SIZE) {
+		for (j = 0; j < TS_BULK_SIZE; j++)
+			key_vals[j] = i + j + 1;
+
+		if (shadow)
+			status = rte_pipeline_table_shadow_entry_add_bulk(
+				tp->p, tp->table_id, keys, entries,
+				TS_BULK_SIZE, key_found, entries_ptr);
+		else
+			status = rte_pipeline_table_entry_add_bulk(tp->p,
+				tp->table_id, keys, entries, TS_BULK_SIZE,
+				key_found, entries_ptr);
+		if (status)
+			return status;
+
+		if (!worker)
+			ts_dp_iteration(dp);
+	}
+	t1 = rte_rdtsc();
+	*cycles_update = t1 - t0;
+	*cycles_swap = 0;
+
+	if (shadow) {
+		status = rte_pipeline_table_shadow_swap(tp->p, tp->table_id);
+		if (status)
+			return status;
+
+		while (rte_pipeline_table_shadow_swap_pending(tp->p,
+			tp->table_id) == 1)
+			if (!worker)
+				ts_dp_iteration(dp);
+			else
+				rte_pause();
+
+		*cycles_swap = rte_rdtsc() - t1;
+	}
+
+	return 0;
+}
+
+static int
+test_table_shadow_perf(void)
+{
+	static const char * const mode_name[] = {"in place", "shadow"};
+	struct ts_pipeline tp;
+	struct ts_dp dp;
+	uint64_t key_vals[TS_N_PKTS];
+	unsigned int worker_lcore;
+	int mode, status = 0;
+	uint32_t i;
+
+	TEST_ASSERT_SUCCESS(ts_pipeline_create(&tp, TS_N_ENTRIES_RELOAD),
+		"Pipeline creation failed");
+	status = rte_pipeline_table_shadow_create(tp.p, tp.table_id,
+		&tp.table_params_shadow);
+	if (status) {
+		ts_pipeline_free(&tp);
+		TEST_ASSERT_SUCCESS(status, "Shadow create failed");
+	}
+
+	worker_lcore = rte_get_next_lcore(rte_lcore_id(), 1, 0);
+
+	printf("Reload of %u table entries, bulk size %u, data path on %s:\n",
+		TS_N_ENTRIES_RELOAD, TS_BULK_SIZE,
+		(worker_lcore < RTE_MAX_LCORE) ? "worker lcore" :
+		"control lcore (interleaved)");
+
+	/* Populate the table once, then reload it in each mode */
+	for (mode = -1; mode <= 1; mode++) {
+		uint64_t cycles_update, cycles_swap;
+		int worker = (worker_lcore < RTE_MAX_LCORE) && (mode >= 0);
+
+		memset(&dp, 0, sizeof(dp));
+		dp.tp = &tp;
+
+		if (worker)
+			rte_eal_remote_launch(ts_dp_main, &dp, worker_lcore);
+
+		status = ts_reload(&tp, &dp, (mode == 1), worker,
+			&cycles_update, &cycles_swap);
+
+		if (worker) {
+			dp.stop = 1;
+			rte_eal_wait_lcore(worker_lcore);
+		}
+
+		if (status)
+			break;
+
+		/* Table populated: start the packet loop */
+		if (mode < 0) {
+			for (i = 0; i < TS_N_PKTS; i++)
+				key_vals[i] = i * (TS_N_ENTRIES_RELOAD /
+					TS_N_PKTS) + 1;
+			status = ts_pkts_send(&tp, key_vals, TS_N_PKTS);
+			if (status)
+				break;
+			continue;
+		}
+
+		printf("  %-8s: update %.1f cycles/entry, swap %" PRIu64
+			" cycles, pipeline run avg %.1f max %" PRIu64
+			" cycles (%" PRIu64 " runs, %" PRIu64 " pkts)\n",
+			mode_name[mode],
+			(double) cycles_update / TS_N_ENTRIES_RELOAD,
+			cycles_swap,
+			dp.stats.n_runs ?
+				(double) dp.stats.cycles_total / dp.stats.n_runs : 0,
+			dp.stats.cycles_max,
+			dp.stats.n_runs,
+			dp.stats.n_pkts);
+	}
+
+	ts_pipeline_free(&tp);
+	TEST_ASSERT_SUCCESS(status, "Table reload failed");
+
+	return 0;
+}
+
+static int
+test_table_shadow(void)
+{
+	int status;
+
+	ts_pool = rte_pktmbuf_pool_create("table_shadow_pool", TS_POOL_SIZE,
+		32, 0, RTE_MBUF_DEFAULT_BUF_SIZE, 0);
+	if (ts_pool == NULL) {
+		ts_pool = rte_mempool_lookup("table_shadow_pool");
+		TEST_ASSERT_NOT_NULL(ts_pool, "Mempool creation failed");
+	}
+
+	status = test_table_shadow_functional();
+	if (status == 0)
+		status = test_table_shadow_acl();
+	if (status == 0)
+		status = test_table_shadow_perf();
+
+	return status;
+}
+
+REGISTER_TEST_COMMAND(table_shadow_autotest, test_table_shadow);
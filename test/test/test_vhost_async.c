@@ -0,0 +1,430 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+#include <rte_vhost_async.h>
+
+#include "../../lib/librte_vhost/vhost.h"
+
+#include "test.h"
+
+/*
+ * Guest memory is a single region at guest physical address 0, holding the
+ * descriptor table, the avail and used rings and one buffer per descriptor.
+ */
+#define ASYNC_TEST_RING_SIZE	256
+#define ASYNC_TEST_DESC_GPA	0
+#define ASYNC_TEST_AVAIL_GPA	4096
+#define ASYNC_TEST_USED_GPA	8192
+#define ASYNC_TEST_BUF_GPA	16384
+#define ASYNC_TEST_BUF_SIZE	2048
+#define ASYNC_TEST_MEM_SIZE	(1 << 20)
+#define ASYNC_TEST_LOG_SIZE	(ASYNC_TEST_MEM_SIZE / VHOST_LOG_PAGE / 8)
+#define ASYNC_TEST_THRESHOLD	256
+#define ASYNC_TEST_MAX_JOBS	64
+#define ASYNC_TEST_MAX_SEGS	8
+
+/* A copy engine doing its copies only when told to, in any order */
+struct fake_job {
+	struct rte_vhost_async_seg segs[ASYNC_TEST_MAX_SEGS];
+	uint16_t nr_segs;
+	int done;
+};
+
+struct fake_engine {
+	struct fake_job jobs[ASYNC_TEST_MAX_JOBS];
+	uint16_t nr_submitted;
+	/* jobs reported completed, always a prefix of the submitted ones */
+	uint16_t nr_reported;
+	/* copy everything when polled */
+	int auto_complete;
+};
+
+static struct fake_engine fake_engine;
+
+static void
+fake_engine_run(struct fake_engine *engine, uint16_t job)
+{
+	struct fake_job *j = &engine->jobs[job];
+	uint16_t i;
+
+	for (i = 0; i < j->nr_segs; i++)
+		rte_memcpy(j->segs[i].dst, j->segs[i].src, j->segs[i].len);
+	j->done = 1;
+}
+
+static int32_t
+fake_transfer_data(int vid __rte_unused, uint16_t queue_id __rte_unused,
+		void *ctx, struct rte_vhost_async_desc *descs, uint16_t count)
+{
+	struct fake_engine *engine = ctx;
+	struct fake_job *job;
+	uint16_t i;
+
+	for (i = 0; i < count; i++) {
+		if (engine->nr_submitted == ASYNC_TEST_MAX_JOBS ||
+				descs[i].nr_segs > ASYNC_TEST_MAX_SEGS)
+			break;
+
+		job = &engine->jobs[engine->nr_submitted++];
+		memcpy(job->segs, descs[i].segs,
+			descs[i].nr_segs * sizeof(struct rte_vhost_async_seg));
+		job->nr_segs = descs[i].nr_segs;
+		job->done = 0;
+	}
+
+	return i;
+}
+
+/* the jobs may be done in any order, but are reported in order */
+static int32_t
+fake_check_completed_copies(int vid __rte_unused,
+		uint16_t queue_id __rte_unused, void *ctx, uint16_t max_packets)
+{
+	struct fake_engine *engine = ctx;
+	uint16_t n = 0;
+
+	while (n < max_packets && engine->nr_reported < engine->nr_submitted) {
+		if (engine->auto_complete)
+			fake_engine_run(engine, engine->nr_reported);
+		if (!engine->jobs[engine->nr_reported].done)
+			break;
+		engine->nr_reported++;
+		n++;
+	}
+
+	return n;
+}
+
+static struct rte_vhost_async_channel_ops fake_engine_ops = {
+	.transfer_data = fake_transfer_data,
+	.check_completed_copies = fake_check_completed_copies,
+};
+
+struct async_test_ctx {
+	int vid;
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	uint8_t *guest_mem;
+	uint8_t *log;
+	struct rte_mempool *pool;
+};
+
+static int
+async_test_setup(struct async_test_ctx *ctx)
+{
+	struct vring_desc *desc;
+	struct vring_avail *avail;
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	uint32_t i;
+
+	memset(ctx, 0, sizeof(*ctx));
+	memset(&fake_engine, 0, sizeof(fake_engine));
+
+	ctx->pool = rte_pktmbuf_pool_create("vhost_async_test", 511, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	ctx->guest_mem = rte_zmalloc(NULL, ASYNC_TEST_MEM_SIZE, 4096);
+	ctx->log = rte_zmalloc(NULL, ASYNC_TEST_LOG_SIZE, 0);
+	if (ctx->pool == NULL || ctx->guest_mem == NULL || ctx->log == NULL)
+		return -1;
+
+	ctx->vid = vhost_new_device();
+	if (ctx->vid < 0)
+		return -1;
+	dev = ctx->dev = get_device(ctx->vid);
+	if (alloc_vring_queue(dev, 0) < 0)
+		return -1;
+	vq = ctx->vq = dev->virtqueue[0];
+
+	dev->mem = rte_zmalloc(NULL, sizeof(struct rte_vhost_memory) +
+			sizeof(struct rte_vhost_mem_region), 0);
+	if (dev->mem == NULL)
+		return -1;
+	dev->mem->nregions = 1;
+	dev->mem->regions[0].guest_phys_addr = 0;
+	dev->mem->regions[0].size = ASYNC_TEST_MEM_SIZE;
+	dev->mem->regions[0].host_user_addr =
+		(uint64_t)(uintptr_t)ctx->guest_mem;
+	dev->vhost_hlen = sizeof(struct virtio_net_hdr);
+	dev->log_size = ASYNC_TEST_LOG_SIZE;
+
+	vq->size = ASYNC_TEST_RING_SIZE;
+	vq->desc = (struct vring_desc *)(ctx->guest_mem + ASYNC_TEST_DESC_GPA);
+	vq->avail = (struct vring_avail *)(ctx->guest_mem +
+			ASYNC_TEST_AVAIL_GPA);
+	vq->used = (struct vring_used *)(ctx->guest_mem + ASYNC_TEST_USED_GPA);
+	vq->log_guest_addr = ASYNC_TEST_USED_GPA;
+	vq->callfd = VIRTIO_INVALID_EVENTFD;
+	vq->shadow_used_ring = rte_malloc(NULL,
+			vq->size * sizeof(struct vring_used_elem), 0);
+	if (vq->shadow_used_ring == NULL)
+		return -1;
+
+	/* the guest posts all its buffers, and wants no interrupt */
+	desc = vq->desc;
+	avail = vq->avail;
+	for (i = 0; i < vq->size; i++) {
+		desc[i].addr = ASYNC_TEST_BUF_GPA + i * ASYNC_TEST_BUF_SIZE;
+		desc[i].len = ASYNC_TEST_BUF_SIZE;
+		desc[i].flags = VRING_DESC_F_WRITE;
+		avail->ring[i] = i;
+	}
+	avail->flags = VRING_AVAIL_F_NO_INTERRUPT;
+	avail->idx = vq->size;
+
+	return rte_vhost_async_channel_register(ctx->vid, 0,
+			ASYNC_TEST_THRESHOLD, &fake_engine_ops, &fake_engine);
+}
+
+static void
+async_test_teardown(struct async_test_ctx *ctx)
+{
+	if (ctx->dev != NULL) {
+		if (ctx->vq != NULL) {
+			fake_engine.auto_complete = 1;
+			vhost_free_async_mem(ctx->dev, 0);
+			rte_free(ctx->vq->shadow_used_ring);
+			rte_free(ctx->vq);
+		}
+		rte_free(ctx->dev->mem);
+		rte_free(ctx->dev);
+		vhost_devices[ctx->vid] = NULL;
+	}
+	rte_free(ctx->log);
+	rte_free(ctx->guest_mem);
+	rte_mempool_free(ctx->pool);
+}
+
+static struct rte_mbuf *
+async_test_pkt(struct async_test_ctx *ctx, uint16_t len, uint8_t seed)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(ctx->pool);
+	uint8_t *data;
+	uint16_t i;
+
+	if (m == NULL)
+		return NULL;
+
+	data = (uint8_t *)rte_pktmbuf_append(m, len);
+	for (i = 0; i < len; i++)
+		data[i] = (uint8_t)(seed + i);
+
+	return m;
+}
+
+static int
+async_test_log_bit(struct async_test_ctx *ctx, uint64_t gpa)
+{
+	uint64_t page = gpa / VHOST_LOG_PAGE;
+
+	return !!(ctx->log[page / 8] & (1 << (page % 8)));
+}
+
+/*
+ * Packets copied by the engine and by the CPU are mixed in one burst, and
+ * the engine does its copies in reverse order: no packet may be handed to
+ * the guest before all the packets submitted before it are done, and the
+ * dirty pages must only be logged then.
+ */
+static int
+test_vhost_async_out_of_order(void)
+{
+	static const uint16_t len[] = { 1000, 64, 1500, 128 };
+	struct async_test_ctx ctx;
+	struct rte_mbuf *pkts[RTE_DIM(len)], *done[RTE_DIM(len)];
+	struct vring_used *used;
+	uint8_t *buf;
+	uint16_t i, n;
+	int ret = -1;
+
+	if (async_test_setup(&ctx) < 0) {
+		printf("cannot set up the vhost device\n");
+		goto out;
+	}
+	used = ctx.vq->used;
+
+	ctx.dev->features = 1ULL << VHOST_F_LOG_ALL;
+	ctx.dev->log_base = (uint64_t)(uintptr_t)ctx.log;
+
+	for (i = 0; i < RTE_DIM(len); i++) {
+		pkts[i] = async_test_pkt(&ctx, len[i], i);
+		if (pkts[i] == NULL) {
+			printf("cannot allocate packet %u\n", i);
+			goto out;
+		}
+	}
+
+	n = rte_vhost_submit_enqueue_burst(ctx.vid, 0, pkts, RTE_DIM(len));
+	if (n != RTE_DIM(len) || fake_engine.nr_submitted != 2) {
+		printf("submitted %u packets, %u to the engine\n", n,
+			fake_engine.nr_submitted);
+		goto out;
+	}
+	if (async_test_log_bit(&ctx, ASYNC_TEST_BUF_GPA)) {
+		printf("dirty page logged before the packet is completed\n");
+		goto out;
+	}
+
+	/* the second engine packet is done first: nothing is completed */
+	fake_engine_run(&fake_engine, 1);
+	n = rte_vhost_poll_enqueue_completed(ctx.vid, 0, done, RTE_DIM(len));
+	if (n != 0 || used->idx != 0 ||
+			rte_vhost_async_get_inflight(ctx.vid, 0) != 4) {
+		printf("%u packets completed before the first one\n", n);
+		goto out;
+	}
+	if (rte_vhost_async_channel_unregister(ctx.vid, 0) == 0) {
+		printf("copy engine unregistered with packets in flight\n");
+		goto out;
+	}
+
+	/* then the first one: all four are completed, in order */
+	fake_engine_run(&fake_engine, 0);
+	n = rte_vhost_poll_enqueue_completed(ctx.vid, 0, done, RTE_DIM(len));
+	if (n != RTE_DIM(len) || used->idx != RTE_DIM(len)) {
+		printf("%u packets completed, used index %u\n", n, used->idx);
+		goto out;
+	}
+
+	for (i = 0; i < RTE_DIM(len); i++) {
+		if (done[i] != pkts[i] || used->ring[i].id != i ||
+				used->ring[i].len !=
+				len[i] + ctx.dev->vhost_hlen) {
+			printf("used entry %u not as expected\n", i);
+			goto out;
+		}
+
+		buf = ctx.guest_mem + ASYNC_TEST_BUF_GPA +
+			i * ASYNC_TEST_BUF_SIZE + ctx.dev->vhost_hlen;
+		if (memcmp(buf, rte_pktmbuf_mtod(pkts[i], void *), len[i])) {
+			printf("guest data of packet %u not as expected\n", i);
+			goto out;
+		}
+
+		if (!async_test_log_bit(&ctx, ASYNC_TEST_BUF_GPA +
+					i * ASYNC_TEST_BUF_SIZE)) {
+			printf("page of packet %u not logged\n", i);
+			goto out;
+		}
+	}
+	if (!async_test_log_bit(&ctx, ASYNC_TEST_USED_GPA)) {
+		printf("used ring page not logged\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	for (i = 0; ret == 0 && i < RTE_DIM(len); i++)
+		rte_pktmbuf_free(pkts[i]);
+	async_test_teardown(&ctx);
+	return ret;
+}
+
+/*
+ * Stopping a queue waits for the packets in flight and frees them, or keeps
+ * the asynchronous state when the engine never completes them.
+ */
+static int
+test_vhost_async_drain(void)
+{
+	struct async_test_ctx ctx;
+	struct rte_mbuf *pkts[2];
+	unsigned int avail;
+	uint16_t i;
+	int ret = -1;
+
+	if (async_test_setup(&ctx) < 0) {
+		printf("cannot set up the vhost device\n");
+		goto out;
+	}
+	avail = rte_mempool_avail_count(ctx.pool);
+
+	for (i = 0; i < RTE_DIM(pkts); i++) {
+		pkts[i] = async_test_pkt(&ctx, 1024, i);
+		if (pkts[i] == NULL) {
+			printf("cannot allocate packet %u\n", i);
+			goto out;
+		}
+	}
+
+	if (rte_vhost_submit_enqueue_burst(ctx.vid, 0, pkts,
+				RTE_DIM(pkts)) != RTE_DIM(pkts)) {
+		printf("cannot submit packets\n");
+		goto out;
+	}
+
+	/* a stuck engine: the state is kept, the packets are not freed */
+	if (vhost_free_async_mem(ctx.dev, 0) == 0 ||
+			!ctx.vq->async_registered ||
+			rte_mempool_avail_count(ctx.pool) !=
+			avail - RTE_DIM(pkts)) {
+		printf("async state freed with packets in flight\n");
+		goto out;
+	}
+
+	/* a working one: the packets are waited for and freed */
+	fake_engine.auto_complete = 1;
+	if (vhost_free_async_mem(ctx.dev, 0) != 0 ||
+			ctx.vq->async_registered ||
+			rte_mempool_avail_count(ctx.pool) != avail) {
+		printf("async state not freed after draining\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	async_test_teardown(&ctx);
+	return ret;
+}
+
+static int
+test_vhost_async(void)
+{
+	if (test_vhost_async_out_of_order() < 0)
+		return -1;
+
+	if (test_vhost_async_drain() < 0)
+		return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(vhost_async_autotest, test_vhost_async);
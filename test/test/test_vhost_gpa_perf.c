@@ -0,0 +1,197 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+
+#include "../../lib/librte_vhost/vhost.h"
+
+#include "test.h"
+
+#define GPA_PERF_MAX_REGIONS	8
+#define GPA_PERF_REGION_SIZE	(1ULL << 30)
+/* guest physical hole between two regions */
+#define GPA_PERF_REGION_GAP	(1ULL << 28)
+/* descriptors of a burst usually share a region */
+#define GPA_PERF_RUN_LEN	32
+#define GPA_PERF_NB_ADDRS	4096
+#define GPA_PERF_ITERATIONS	1000
+
+static const uint32_t gpa_perf_nb_regions[] = { 1, 2, 4, 8 };
+
+static uint64_t gpa_perf_addrs[GPA_PERF_NB_ADDRS];
+
+/* regions are given in reverse order, like a hotplugged memory layout */
+static void
+gpa_perf_fill_regions(struct rte_vhost_memory *mem, uint32_t nb_regions)
+{
+	struct rte_vhost_mem_region *reg;
+	uint32_t i;
+
+	mem->nregions = nb_regions;
+	for (i = 0; i < nb_regions; i++) {
+		reg = &mem->regions[nb_regions - 1 - i];
+		reg->guest_phys_addr = i * (GPA_PERF_REGION_SIZE +
+					    GPA_PERF_REGION_GAP);
+		reg->size = GPA_PERF_REGION_SIZE;
+		reg->host_user_addr = 0x7f0000000000ULL + i * 0x100000000ULL;
+	}
+}
+
+static void
+gpa_perf_fill_addrs(uint32_t nb_regions)
+{
+	uint64_t base = 0;
+	uint32_t i;
+
+	for (i = 0; i < GPA_PERF_NB_ADDRS; i++) {
+		if (i % GPA_PERF_RUN_LEN == 0)
+			base = (rte_rand() % nb_regions) *
+				(GPA_PERF_REGION_SIZE + GPA_PERF_REGION_GAP);
+		gpa_perf_addrs[i] = base + rte_rand() % GPA_PERF_REGION_SIZE;
+	}
+}
+
+static int
+mem_region_cmp(const void *a, const void *b)
+{
+	const struct rte_vhost_mem_region *ra = a;
+	const struct rte_vhost_mem_region *rb = b;
+
+	if (ra->guest_phys_addr < rb->guest_phys_addr)
+		return -1;
+	return ra->guest_phys_addr > rb->guest_phys_addr;
+}
+
+static int
+gpa_perf_run(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	     uint32_t nb_regions)
+{
+	struct rte_vhost_memory *mem = dev->mem;
+	struct vhost_gpa_cache cache;
+	uint64_t start, linear = 0, search = 0, cached = 0;
+	uint64_t sum_linear = 0, sum_search = 0, sum_cached = 0;
+	unsigned int i, j;
+
+	gpa_perf_fill_regions(mem, nb_regions);
+	gpa_perf_fill_addrs(nb_regions);
+
+	/* reference: linear scan of the unsorted table */
+	for (j = 0; j < GPA_PERF_ITERATIONS; j++) {
+		start = rte_rdtsc();
+		for (i = 0; i < GPA_PERF_NB_ADDRS; i++)
+			sum_linear += rte_vhost_gpa_to_vva(mem,
+					gpa_perf_addrs[i]);
+		linear += rte_rdtsc() - start;
+	}
+
+	/* the vhost library sorts the table on VHOST_USER_SET_MEM_TABLE */
+	qsort(mem->regions, mem->nregions,
+	      sizeof(struct rte_vhost_mem_region), mem_region_cmp);
+
+	for (j = 0; j < GPA_PERF_ITERATIONS; j++) {
+		start = rte_rdtsc();
+		for (i = 0; i < GPA_PERF_NB_ADDRS; i++)
+			sum_search += gpa_to_vva_lookup(mem, &cache,
+					gpa_perf_addrs[i]);
+		search += rte_rdtsc() - start;
+	}
+
+	memset(&vq->gpa_cache, 0, sizeof(vq->gpa_cache));
+	for (j = 0; j < GPA_PERF_ITERATIONS; j++) {
+		start = rte_rdtsc();
+		for (i = 0; i < GPA_PERF_NB_ADDRS; i++)
+			sum_cached += gpa_to_vva(dev, vq, gpa_perf_addrs[i]);
+		cached += rte_rdtsc() - start;
+	}
+
+	if (sum_linear != sum_search || sum_linear != sum_cached) {
+		printf("translation mismatch with %u regions\n", nb_regions);
+		return -1;
+	}
+
+	/* a hole in the guest physical space is not translated */
+	if (nb_regions > 1 && gpa_to_vva(dev, vq, GPA_PERF_REGION_SIZE) != 0) {
+		printf("address in a hole translated\n");
+		return -1;
+	}
+
+	printf("%u regions: linear %5.1f, sorted %5.1f, "
+		"cached %5.1f (cycles/translation)\n",
+		nb_regions,
+		(double)linear / (GPA_PERF_ITERATIONS * GPA_PERF_NB_ADDRS),
+		(double)search / (GPA_PERF_ITERATIONS * GPA_PERF_NB_ADDRS),
+		(double)cached / (GPA_PERF_ITERATIONS * GPA_PERF_NB_ADDRS));
+
+	return 0;
+}
+
+static int
+test_vhost_gpa_perf(void)
+{
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	unsigned int i;
+	int ret = -1;
+
+	dev = rte_zmalloc(NULL, sizeof(*dev), 0);
+	vq = rte_zmalloc(NULL, sizeof(*vq), 0);
+	if (dev == NULL || vq == NULL)
+		goto out;
+
+	dev->mem = rte_zmalloc(NULL, sizeof(struct rte_vhost_memory) +
+		GPA_PERF_MAX_REGIONS * sizeof(struct rte_vhost_mem_region), 0);
+	if (dev->mem == NULL)
+		goto out;
+
+	for (i = 0; i < RTE_DIM(gpa_perf_nb_regions); i++) {
+		ret = gpa_perf_run(dev, vq, gpa_perf_nb_regions[i]);
+		if (ret < 0)
+			break;
+	}
+
+out:
+	if (dev != NULL)
+		rte_free(dev->mem);
+	rte_free(dev);
+	rte_free(vq);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(vhost_gpa_perf_autotest, test_vhost_gpa_perf);
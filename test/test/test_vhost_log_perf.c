@@ -0,0 +1,268 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+
+#include "../../lib/librte_vhost/vhost.h"
+
+#include "test.h"
+
+/* guest memory covered by the dirty log */
+#define LOG_PERF_GUEST_SIZE	(1ULL << 30)
+#define LOG_PERF_LOG_SIZE	(LOG_PERF_GUEST_SIZE / VHOST_LOG_PAGE / 8)
+/* guest Rx buffers, as posted by a virtio-net driver from its pool */
+#define LOG_PERF_NB_BUFS	4096
+#define LOG_PERF_BUF_SIZE	2048
+#define LOG_PERF_HDR_LEN	12
+#define LOG_PERF_BURST		32
+#define LOG_PERF_ITERATIONS	20000
+#define LOG_PERF_USED_RING	(LOG_PERF_GUEST_SIZE - (1 << 20))
+
+static const uint32_t log_perf_pkt_len[] = { 64, 1518 };
+
+static uint64_t log_perf_bufs[LOG_PERF_NB_BUFS];
+
+/*
+ * Buffers are either taken in turn from a contiguous pool, or scattered
+ * all over the guest memory, which is the worst case for the cache.
+ */
+static void
+log_perf_fill_bufs(int scattered)
+{
+	uint64_t nb_slots = (LOG_PERF_USED_RING - LOG_PERF_BUF_SIZE) /
+		LOG_PERF_BUF_SIZE;
+	uint32_t i;
+
+	for (i = 0; i < LOG_PERF_NB_BUFS; i++)
+		log_perf_bufs[i] = scattered ?
+			(rte_rand() % nb_slots) * LOG_PERF_BUF_SIZE :
+			(1 << 20) + (uint64_t)i * LOG_PERF_BUF_SIZE;
+}
+
+/* what the enqueue path logs for a burst, one page at a time */
+static uint64_t
+log_perf_direct(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		uint32_t pkt_len)
+{
+	uint64_t start, cycles = 0;
+	uint32_t i, j, buf = 0;
+
+	for (j = 0; j < LOG_PERF_ITERATIONS; j++) {
+		start = rte_rdtsc();
+		for (i = 0; i < LOG_PERF_BURST; i++) {
+			uint64_t addr = log_perf_bufs[buf];
+
+			vhost_log_write(dev, addr, LOG_PERF_HDR_LEN);
+			vhost_log_write(dev, addr + LOG_PERF_HDR_LEN, pkt_len);
+			vhost_log_used_vring(dev, vq,
+				offsetof(struct vring_used, ring[buf & 255]),
+				sizeof(struct vring_used_elem));
+			buf = (buf + 1) % LOG_PERF_NB_BUFS;
+		}
+		vhost_log_used_vring(dev, vq, offsetof(struct vring_used, idx),
+			sizeof(uint16_t));
+		cycles += rte_rdtsc() - start;
+	}
+
+	return cycles;
+}
+
+/* the same burst, accumulated on the virtqueue and flushed once */
+static uint64_t
+log_perf_cached(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		uint32_t pkt_len)
+{
+	uint64_t start, cycles = 0;
+	uint32_t i, j, buf = 0;
+
+	for (j = 0; j < LOG_PERF_ITERATIONS; j++) {
+		start = rte_rdtsc();
+		for (i = 0; i < LOG_PERF_BURST; i++) {
+			uint64_t addr = log_perf_bufs[buf];
+
+			vhost_log_cache_write(dev, vq, addr, LOG_PERF_HDR_LEN);
+			vhost_log_cache_write(dev, vq, addr + LOG_PERF_HDR_LEN,
+				pkt_len);
+			vhost_log_cache_used_vring(dev, vq,
+				offsetof(struct vring_used, ring[buf & 255]),
+				sizeof(struct vring_used_elem));
+			buf = (buf + 1) % LOG_PERF_NB_BUFS;
+		}
+		vhost_log_cache_sync(dev, vq);
+		vhost_log_used_vring(dev, vq, offsetof(struct vring_used, idx),
+			sizeof(uint16_t));
+		cycles += rte_rdtsc() - start;
+	}
+
+	return cycles;
+}
+
+static int
+log_perf_run(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	     uint8_t *log_direct, uint8_t *log_cached, int scattered)
+{
+	uint64_t direct, cached;
+	unsigned int i;
+
+	log_perf_fill_bufs(scattered);
+
+	for (i = 0; i < RTE_DIM(log_perf_pkt_len); i++) {
+		memset(log_direct, 0, LOG_PERF_LOG_SIZE);
+		memset(log_cached, 0, LOG_PERF_LOG_SIZE);
+
+		dev->log_base = (uint64_t)(uintptr_t)log_direct;
+		direct = log_perf_direct(dev, vq, log_perf_pkt_len[i]);
+
+		dev->log_base = (uint64_t)(uintptr_t)log_cached;
+		cached = log_perf_cached(dev, vq, log_perf_pkt_len[i]);
+
+		if (vq->log_cache_nb_elem != 0 ||
+				memcmp(log_direct, log_cached,
+				       LOG_PERF_LOG_SIZE) != 0) {
+			printf("dirty log mismatch with %u bytes packets\n",
+				log_perf_pkt_len[i]);
+			return -1;
+		}
+
+		printf("%s buffers, %4u bytes: direct %6.1f, cached %6.1f "
+			"(cycles/packet)\n",
+			scattered ? "scattered" : "pooled", log_perf_pkt_len[i],
+			(double)direct / (LOG_PERF_ITERATIONS * LOG_PERF_BURST),
+			(double)cached / (LOG_PERF_ITERATIONS * LOG_PERF_BURST));
+	}
+
+	return 0;
+}
+
+static int
+log_page_is_set(const uint8_t *log, uint64_t page)
+{
+	return (log[page / 8] & (1 << (page % 8))) != 0;
+}
+
+/*
+ * The log base changes in the middle of a burst: the dirty bits already
+ * cached go to the new log, up to its end, and none to the previous one.
+ */
+static int
+log_gen_check(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	      uint8_t *log_old, uint8_t *log_new)
+{
+	uint64_t last_page = LOG_PERF_LOG_SIZE * 8 - 1;
+	uint64_t mid_page = last_page / 4;
+	unsigned int i;
+
+	memset(log_old, 0, LOG_PERF_LOG_SIZE);
+	memset(log_new, 0, LOG_PERF_LOG_SIZE);
+	dev->log_base = (uint64_t)(uintptr_t)log_old;
+
+	vhost_log_cache_write(dev, vq, 0, 1);
+	vhost_log_cache_write(dev, vq, mid_page * VHOST_LOG_PAGE, 1);
+	vhost_log_cache_write(dev, vq, last_page * VHOST_LOG_PAGE, 1);
+
+	/* new log, only covering the first half of the guest memory */
+	dev->log_base = (uint64_t)(uintptr_t)log_new;
+	dev->log_size = LOG_PERF_LOG_SIZE / 2;
+	rte_smp_wmb();
+	dev->log_gen++;
+
+	vhost_log_cache_write(dev, vq, VHOST_LOG_PAGE, 1);
+	vhost_log_cache_sync(dev, vq);
+
+	dev->log_size = LOG_PERF_LOG_SIZE;
+
+	for (i = 0; i < LOG_PERF_LOG_SIZE; i++) {
+		if (log_old[i] != 0) {
+			printf("dirty bits written to the previous log\n");
+			return -1;
+		}
+	}
+
+	if (!log_page_is_set(log_new, 0) || !log_page_is_set(log_new, 1) ||
+			!log_page_is_set(log_new, mid_page)) {
+		printf("cached dirty bits lost on log base change\n");
+		return -1;
+	}
+
+	for (i = LOG_PERF_LOG_SIZE / 2; i < LOG_PERF_LOG_SIZE; i++) {
+		if (log_new[i] != 0) {
+			printf("dirty bits written past the end of the log\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_vhost_log_perf(void)
+{
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	uint8_t *log_direct, *log_cached;
+	int ret = -1;
+
+	dev = rte_zmalloc(NULL, sizeof(*dev), 0);
+	vq = rte_zmalloc(NULL, sizeof(*vq), 0);
+	log_direct = rte_zmalloc(NULL, LOG_PERF_LOG_SIZE, 0);
+	log_cached = rte_zmalloc(NULL, LOG_PERF_LOG_SIZE, 0);
+	if (dev == NULL || vq == NULL || log_direct == NULL ||
+			log_cached == NULL)
+		goto out;
+
+	dev->features = 1ULL << VHOST_F_LOG_ALL;
+	dev->log_size = LOG_PERF_LOG_SIZE;
+	vq->log_guest_addr = LOG_PERF_USED_RING;
+
+	ret = log_gen_check(dev, vq, log_direct, log_cached);
+	if (ret == 0)
+		ret = log_perf_run(dev, vq, log_direct, log_cached, 0);
+	if (ret == 0)
+		ret = log_perf_run(dev, vq, log_direct, log_cached, 1);
+
+out:
+	rte_free(log_cached);
+	rte_free(log_direct);
+	rte_free(dev);
+	rte_free(vq);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(vhost_log_perf_autotest, test_vhost_log_perf);